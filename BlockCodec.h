@@ -0,0 +1,227 @@
+/* Copyright (C) 2014-2026 Stefan-Mihai MOGA
+This file is part of IntelliPort application developed by Stefan-Mihai MOGA.
+IntelliPort is an alternative Windows version to the famous HyperTerminal!
+
+IntelliPort is free software: you can redistribute it and/or modify it
+under the terms of the GNU General Public License as published by the Open
+Source Initiative, either version 3 of the License, or any later version.
+
+IntelliPort is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+IntelliPort. If not, see <http://www.opensource.org/licenses/gpl-3.0.html>*/
+
+// BlockCodec.h : fast LZ77 block compressor for in-memory pages
+//
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+/**
+ * @brief Fast LZ77 block codec in the style of LZ4.
+ *
+ * Compresses a whole block at once with a single-probe hash table, trading
+ * ratio for speed: terminal output (repeated prefixes, time stamps, UTF-16
+ * with zero high bytes) typically shrinks 3 to 10 times at several hundred
+ * MB/s. A block is a sequence of (literals, match) pairs, each introduced by a
+ * token byte holding a 4-bit literal length and a 4-bit match length, with
+ * 255-byte length extensions and a 16-bit little-endian match offset; the last
+ * pair has literals only. The format carries no header: the caller keeps the
+ * uncompressed size. Decompress() validates every length, so a corrupt block
+ * is reported instead of overrunning a buffer.
+ */
+class CBlockCodec
+{
+public:
+	static constexpr size_t BLOCK_CODEC_MIN_MATCH = 4;
+	static constexpr size_t BLOCK_CODEC_MAX_OFFSET = 0xFFFF;
+	static constexpr int BLOCK_CODEC_HASH_BITS = 12;
+
+	/**
+	 * @brief Compresses a block.
+	 *
+	 * @param pSource Bytes to compress.
+	 * @param nLength Number of bytes to compress.
+	 * @param vecOutput Receives the compressed block; its capacity is reused.
+	 * @return Size of the compressed block.
+	 */
+	static size_t Compress(const uint8_t* pSource, size_t nLength, std::vector<uint8_t>& vecOutput)
+	{
+		vecOutput.resize(GetMaxCompressedSize(nLength));
+		uint8_t* pOutput = vecOutput.data();
+		uint32_t pTable[size_t(1) << BLOCK_CODEC_HASH_BITS];
+		memset(pTable, 0xFF, sizeof(pTable));
+
+		size_t nAnchor = 0;
+		size_t nIndex = 0;
+		while (nIndex + BLOCK_CODEC_MIN_MATCH <= nLength)
+		{
+			const uint32_t nSequence = Read32(pSource + nIndex);
+			const uint32_t nHash = (nSequence * 2654435761u) >> (32 - BLOCK_CODEC_HASH_BITS);
+			const uint32_t nCandidate = pTable[nHash];
+			pTable[nHash] = static_cast<uint32_t>(nIndex);
+			if ((nCandidate == UINT32_MAX) || (nIndex - nCandidate > BLOCK_CODEC_MAX_OFFSET) ||
+				(Read32(pSource + nCandidate) != nSequence))
+			{
+				// Skip faster through data that does not compress
+				nIndex += 1 + ((nIndex - nAnchor) >> 6);
+				continue;
+			}
+
+			size_t nMatch = BLOCK_CODEC_MIN_MATCH;
+			while ((nIndex + nMatch < nLength) && (pSource[nCandidate + nMatch] == pSource[nIndex + nMatch]))
+			{
+				nMatch++;
+			}
+			pOutput = WriteSequence(pOutput, pSource + nAnchor, nIndex - nAnchor, nIndex - nCandidate, nMatch);
+			nIndex += nMatch;
+			nAnchor = nIndex;
+		}
+		pOutput = WriteSequence(pOutput, pSource + nAnchor, nLength - nAnchor, 0, 0);
+
+		vecOutput.resize(static_cast<size_t>(pOutput - vecOutput.data()));
+		return vecOutput.size();
+	}
+
+	/**
+	 * @brief Decompresses a block produced by Compress().
+	 *
+	 * @param pSource Compressed block.
+	 * @param nSourceLength Size of the compressed block.
+	 * @param pOutput Buffer receiving the original bytes.
+	 * @param nOutputLength Original size of the block.
+	 * @return true if the block decoded to exactly nOutputLength bytes.
+	 */
+	static bool Decompress(const uint8_t* pSource, size_t nSourceLength, uint8_t* pOutput, size_t nOutputLength)
+	{
+		const uint8_t* pInput = pSource;
+		const uint8_t* pInputEnd = pSource + nSourceLength;
+		size_t nWritten = 0;
+		while (pInput < pInputEnd)
+		{
+			const uint8_t nToken = *pInput++;
+			size_t nLiterals = nToken >> 4;
+			if (!ReadLength(pInput, pInputEnd, nLiterals) ||
+				(nLiterals > static_cast<size_t>(pInputEnd - pInput)) || (nLiterals > nOutputLength - nWritten))
+			{
+				return false;
+			}
+			memcpy(pOutput + nWritten, pInput, nLiterals);
+			pInput += nLiterals;
+			nWritten += nLiterals;
+			if (pInput == pInputEnd)
+			{
+				break; // the last sequence has no match
+			}
+
+			if (pInputEnd - pInput < 2)
+			{
+				return false;
+			}
+			const size_t nOffset = pInput[0] | (static_cast<size_t>(pInput[1]) << 8);
+			pInput += 2;
+			size_t nMatch = nToken & 0x0F;
+			if (!ReadLength(pInput, pInputEnd, nMatch))
+			{
+				return false;
+			}
+			nMatch += BLOCK_CODEC_MIN_MATCH;
+			if ((nOffset == 0) || (nOffset > nWritten) || (nMatch > nOutputLength - nWritten))
+			{
+				return false;
+			}
+			const uint8_t* pMatch = pOutput + nWritten - nOffset;
+			uint8_t* pTarget = pOutput + nWritten;
+			if (nOffset >= nMatch)
+			{
+				memcpy(pTarget, pMatch, nMatch);
+			}
+			else
+			{
+				// Byte by byte: the match overlaps the bytes it produces
+				for (size_t nByte = 0; nByte < nMatch; nByte++)
+				{
+					pTarget[nByte] = pMatch[nByte];
+				}
+			}
+			nWritten += nMatch;
+		}
+		return nWritten == nOutputLength;
+	}
+
+	/**
+	 * @brief Returns the largest size Compress() can produce for nLength bytes.
+	 */
+	static size_t GetMaxCompressedSize(size_t nLength)
+	{
+		return nLength + nLength / 255 + 16;
+	}
+
+protected:
+	static uint32_t Read32(const uint8_t* pData)
+	{
+		uint32_t nValue;
+		memcpy(&nValue, pData, sizeof(nValue));
+		return nValue;
+	}
+
+	static uint8_t* WriteLength(uint8_t* pOutput, size_t nLength)
+	{
+		for (; nLength >= 255; nLength -= 255)
+		{
+			*pOutput++ = 255;
+		}
+		*pOutput++ = static_cast<uint8_t>(nLength);
+		return pOutput;
+	}
+
+	static uint8_t* WriteSequence(uint8_t* pOutput, const uint8_t* pLiterals, size_t nLiterals, size_t nOffset, size_t nMatch)
+	{
+		const size_t nMatchCode = (nMatch != 0) ? nMatch - BLOCK_CODEC_MIN_MATCH : 0;
+		uint8_t* pToken = pOutput++;
+		*pToken = static_cast<uint8_t>(((nLiterals < 15) ? nLiterals : 15) << 4);
+		if (nLiterals >= 15)
+		{
+			pOutput = WriteLength(pOutput, nLiterals - 15);
+		}
+		memcpy(pOutput, pLiterals, nLiterals);
+		pOutput += nLiterals;
+		if (nMatch == 0)
+		{
+			return pOutput;
+		}
+		*pOutput++ = static_cast<uint8_t>(nOffset);
+		*pOutput++ = static_cast<uint8_t>(nOffset >> 8);
+		*pToken |= static_cast<uint8_t>((nMatchCode < 15) ? nMatchCode : 15);
+		if (nMatchCode >= 15)
+		{
+			pOutput = WriteLength(pOutput, nMatchCode - 15);
+		}
+		return pOutput;
+	}
+
+	static bool ReadLength(const uint8_t*& pInput, const uint8_t* pInputEnd, size_t& nLength)
+	{
+		if (nLength != 15)
+		{
+			return true;
+		}
+		uint8_t nByte = 0;
+		do
+		{
+			if (pInput == pInputEnd)
+			{
+				return false;
+			}
+			nByte = *pInput++;
+			nLength += nByte;
+		} while (nByte == 255);
+		return true;
+	}
+};
@@ -0,0 +1,773 @@
+/* Copyright (C) 2014-2026 Stefan-Mihai MOGA
+This file is part of IntelliPort application developed by Stefan-Mihai MOGA.
+IntelliPort is an alternative Windows version to the famous HyperTerminal!
+
+IntelliPort is free software: you can redistribute it and/or modify it
+under the terms of the GNU General Public License as published by the Open
+Source Initiative, either version 3 of the License, or any later version.
+
+IntelliPort is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+IntelliPort. If not, see <http://www.opensource.org/licenses/gpl-3.0.html>*/
+
+// CaptureFile.h : timestamped binary capture of a session, with a sparse time index
+//
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+/*
+ * Capture file layout (all integers little-endian):
+ *
+ *   CCaptureFileHeader                       32 bytes
+ *   { CCaptureRecord, nLength raw bytes }*   16 bytes + payload each
+ *
+ * Records are appended in timestamp order. A record cut short by a crash is
+ * ignored by the reader. The index is a separate file, the capture path with
+ * ".idx" appended:
+ *
+ *   CCaptureIndexHeader                      16 bytes
+ *   CCaptureIndexEntry*                      16 bytes each
+ *
+ * It holds the timestamp and offset of the first record starting after every
+ * CAPTURE_INDEX_INTERVAL bytes of the capture, so a 10 GB capture has about
+ * 10000 entries and any instant is found by a binary search followed by a scan
+ * of at most one interval. The index is written after the records it points
+ * to; the reader rebuilds whatever part of it is missing.
+ */
+
+#ifdef _WIN32
+typedef wchar_t CaptureChar;
+#define CAPTURE_INDEX_SUFFIX L".idx"
+#else
+typedef char CaptureChar;
+#define CAPTURE_INDEX_SUFFIX ".idx"
+#endif
+
+static constexpr char CAPTURE_FILE_MAGIC[8] = { 'I', 'P', 'C', 'A', 'P', 'T', 'U', 'R' };
+static constexpr char CAPTURE_INDEX_MAGIC[8] = { 'I', 'P', 'C', 'A', 'P', 'I', 'D', 'X' };
+static constexpr uint32_t CAPTURE_VERSION = 1;
+
+enum CaptureDirection : uint8_t
+{
+	CAPTURE_RECEIVED = 0,
+	CAPTURE_SENT = 1,
+};
+
+struct CCaptureFileHeader
+{
+	char pMagic[8];
+	uint32_t nVersion;
+	uint32_t nHeaderSize;     // offset of the first record
+	uint64_t nWallClock;      // nanoseconds since 1970-01-01 UTC when the capture started
+	uint64_t nReserved;
+};
+
+struct CCaptureRecord
+{
+	uint64_t nTimestamp;      // monotonic nanoseconds since the capture started
+	uint32_t nLength;         // raw bytes following the record
+	uint16_t nSource;         // 0 for the connection, the client number for a TCP server session
+	uint8_t nDirection;       // a CaptureDirection value
+	uint8_t nReserved;
+};
+
+struct CCaptureIndexHeader
+{
+	char pMagic[8];
+	uint32_t nVersion;
+	uint32_t nReserved;
+};
+
+struct CCaptureIndexEntry
+{
+	uint64_t nTimestamp;
+	uint64_t nOffset;         // of a record in the capture file
+};
+
+static_assert(sizeof(CCaptureFileHeader) == 32, "capture file header layout");
+static_assert(sizeof(CCaptureRecord) == 16, "capture record layout");
+static_assert(sizeof(CCaptureIndexHeader) == 16, "capture index header layout");
+static_assert(sizeof(CCaptureIndexEntry) == 16, "capture index entry layout");
+
+static constexpr uint64_t CAPTURE_INDEX_INTERVAL = 0x100000; // capture bytes per index entry
+
+/**
+ * @brief File written sequentially or read at explicit offsets.
+ */
+class CCaptureStream
+{
+public:
+	CCaptureStream()
+	{
+#ifdef _WIN32
+		m_hFile = INVALID_HANDLE_VALUE;
+#else
+		m_nFd = -1;
+#endif
+	}
+
+	~CCaptureStream()
+	{
+		Close();
+	}
+
+	CCaptureStream(const CCaptureStream&) = delete;
+	CCaptureStream& operator=(const CCaptureStream&) = delete;
+
+	/**
+	 * @brief Creates (or truncates) a file for writing; readers may open it meanwhile.
+	 */
+	bool Create(const CaptureChar* lpszPath)
+	{
+		Close();
+#ifdef _WIN32
+		m_hFile = CreateFileW(lpszPath, GENERIC_WRITE, FILE_SHARE_READ, nullptr, CREATE_ALWAYS,
+			FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+#else
+		m_nFd = open(lpszPath, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+#endif
+		return IsOpen();
+	}
+
+	/**
+	 * @brief Opens an existing file for reading, also while it is being written.
+	 */
+	bool OpenRead(const CaptureChar* lpszPath)
+	{
+		Close();
+#ifdef _WIN32
+		m_hFile = CreateFileW(lpszPath, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr, OPEN_EXISTING,
+			FILE_ATTRIBUTE_NORMAL, nullptr);
+#else
+		m_nFd = open(lpszPath, O_RDONLY | O_CLOEXEC);
+#endif
+		return IsOpen();
+	}
+
+	void Close()
+	{
+#ifdef _WIN32
+		if (m_hFile != INVALID_HANDLE_VALUE)
+		{
+			CloseHandle(m_hFile);
+			m_hFile = INVALID_HANDLE_VALUE;
+		}
+#else
+		if (m_nFd >= 0)
+		{
+			close(m_nFd);
+			m_nFd = -1;
+		}
+#endif
+	}
+
+	bool IsOpen() const
+	{
+#ifdef _WIN32
+		return (m_hFile != INVALID_HANDLE_VALUE);
+#else
+		return (m_nFd >= 0);
+#endif
+	}
+
+	/**
+	 * @brief Appends bytes at the current end of the file.
+	 */
+	bool Write(const void* pData, size_t nLength)
+	{
+		const char* pInput = static_cast<const char*>(pData);
+		while (nLength > 0)
+		{
+#ifdef _WIN32
+			DWORD dwWritten = 0;
+			const DWORD dwLength = (nLength > 0x40000000) ? 0x40000000 : static_cast<DWORD>(nLength);
+			if (!WriteFile(m_hFile, pInput, dwLength, &dwWritten, nullptr) || (dwWritten == 0))
+			{
+				return false;
+			}
+			const size_t nWritten = dwWritten;
+#else
+			const ssize_t nWritten = write(m_nFd, pInput, nLength);
+			if (nWritten <= 0)
+			{
+				return false;
+			}
+#endif
+			pInput += nWritten;
+			nLength -= nWritten;
+		}
+		return true;
+	}
+
+	/**
+	 * @brief Reads up to nLength bytes at nOffset.
+	 * @return Number of bytes read; fewer than asked at the end of the file.
+	 */
+	size_t Read(uint64_t nOffset, void* pData, size_t nLength)
+	{
+		char* pOutput = static_cast<char*>(pData);
+		size_t nTotal = 0;
+		while (nTotal < nLength)
+		{
+#ifdef _WIN32
+			OVERLAPPED overlapped = { 0, };
+			overlapped.Offset = static_cast<DWORD>(nOffset);
+			overlapped.OffsetHigh = static_cast<DWORD>(nOffset >> 32);
+			DWORD dwRead = 0;
+			const size_t nLeft = nLength - nTotal;
+			const DWORD dwLength = (nLeft > 0x40000000) ? 0x40000000 : static_cast<DWORD>(nLeft);
+			if (!ReadFile(m_hFile, pOutput + nTotal, dwLength, &dwRead, &overlapped) || (dwRead == 0))
+			{
+				break;
+			}
+			const size_t nRead = dwRead;
+#else
+			const ssize_t nRead = pread(m_nFd, pOutput + nTotal, nLength - nTotal, static_cast<off_t>(nOffset));
+			if (nRead <= 0)
+			{
+				break;
+			}
+#endif
+			nTotal += nRead;
+			nOffset += nRead;
+		}
+		return nTotal;
+	}
+
+	uint64_t GetSize() const
+	{
+#ifdef _WIN32
+		LARGE_INTEGER nSize = { 0, };
+		return GetFileSizeEx(m_hFile, &nSize) ? static_cast<uint64_t>(nSize.QuadPart) : 0;
+#else
+		struct stat status;
+		return (fstat(m_nFd, &status) == 0) ? static_cast<uint64_t>(status.st_size) : 0;
+#endif
+	}
+
+protected:
+#ifdef _WIN32
+	HANDLE m_hFile;
+#else
+	int m_nFd;
+#endif
+};
+
+/**
+ * @brief Counters kept by CCaptureWriter.
+ */
+struct CCaptureStats
+{
+	uint64_t nRecords;        // records written to disk
+	uint64_t nBytesWritten;   // size of the capture file
+	uint64_t nRecordsDropped; // lost because the disk fell behind or failed
+};
+
+/**
+ * @brief Appends the traffic of a session to a capture file.
+ *
+ * Append() may be called from any thread: it stamps the bytes with the
+ * monotonic clock and copies them into the pending batch under a lock, so the
+ * reading threads never wait for the disk. The timestamp is taken under the
+ * same lock, so records reach the file in timestamp order. A writer thread
+ * writes the batch once CAPTURE_BATCH_SIZE bytes are pending or
+ * CAPTURE_FLUSH_INTERVAL milliseconds have passed, and extends the index as it
+ * goes. If more than CAPTURE_MAX_PENDING bytes wait for the disk, further
+ * records are dropped and counted rather than stalling the connection.
+ */
+class CCaptureWriter
+{
+public:
+	static constexpr size_t CAPTURE_BATCH_SIZE = 0x100000;
+	static constexpr size_t CAPTURE_MAX_PENDING = 0x4000000;
+	static constexpr int CAPTURE_FLUSH_INTERVAL = 100;
+
+	CCaptureWriter() : m_bOpen(false), m_bStop(false), m_nStartTime(), m_nFileSize(0), m_nNextIndex(0),
+		m_nRecords(0), m_nBytesWritten(0), m_nRecordsDropped(0)
+	{
+	}
+
+	~CCaptureWriter()
+	{
+		Close();
+	}
+
+	CCaptureWriter(const CCaptureWriter&) = delete;
+	CCaptureWriter& operator=(const CCaptureWriter&) = delete;
+
+	/**
+	 * @brief Creates the capture file and its index, and starts the writer thread.
+	 */
+	bool Open(const CaptureChar* lpszPath)
+	{
+		Close();
+		const std::basic_string<CaptureChar> strIndexPath = std::basic_string<CaptureChar>(lpszPath) + CAPTURE_INDEX_SUFFIX;
+		if (!m_pFile.Create(lpszPath) || !m_pIndexFile.Create(strIndexPath.c_str()))
+		{
+			m_pFile.Close();
+			m_pIndexFile.Close();
+			return false;
+		}
+
+		m_nStartTime = std::chrono::steady_clock::now();
+		CCaptureFileHeader header = {};
+		memcpy(header.pMagic, CAPTURE_FILE_MAGIC, sizeof(header.pMagic));
+		header.nVersion = CAPTURE_VERSION;
+		header.nHeaderSize = sizeof(header);
+		header.nWallClock = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+			std::chrono::system_clock::now().time_since_epoch()).count());
+		CCaptureIndexHeader indexHeader = {};
+		memcpy(indexHeader.pMagic, CAPTURE_INDEX_MAGIC, sizeof(indexHeader.pMagic));
+		indexHeader.nVersion = CAPTURE_VERSION;
+		if (!m_pFile.Write(&header, sizeof(header)) || !m_pIndexFile.Write(&indexHeader, sizeof(indexHeader)))
+		{
+			m_pFile.Close();
+			m_pIndexFile.Close();
+			return false;
+		}
+
+		m_nFileSize = sizeof(header);
+		m_nNextIndex = sizeof(header);
+		m_nRecords = 0;
+		m_nBytesWritten = sizeof(header);
+		m_nRecordsDropped = 0;
+		m_vecPending.clear();
+		m_vecPending.reserve(CAPTURE_BATCH_SIZE * 2);
+		m_bStop = false;
+		m_bOpen.store(true, std::memory_order_release);
+		m_pThread = std::thread(&CCaptureWriter::Run, this);
+		return true;
+	}
+
+	/**
+	 * @brief Writes what is pending, stops the writer thread and closes the files.
+	 */
+	void Close()
+	{
+		if (!m_pThread.joinable())
+		{
+			return;
+		}
+		{
+			std::lock_guard<std::mutex> lock(m_pLock);
+			m_bOpen.store(false, std::memory_order_relaxed);
+			m_bStop = true;
+		}
+		m_pWake.notify_one();
+		m_pThread.join();
+		m_pFile.Close();
+		m_pIndexFile.Close();
+	}
+
+	bool IsOpen() const
+	{
+		return m_bOpen.load(std::memory_order_acquire);
+	}
+
+	/**
+	 * @brief Records bytes received or sent. Does nothing while no capture is open.
+	 *
+	 * @param nDirection CAPTURE_RECEIVED or CAPTURE_SENT.
+	 * @param nSource 0 for the connection, or the number of a TCP server client.
+	 * @param pData The raw bytes.
+	 * @param nLength Number of bytes (at most 4 GB per record).
+	 */
+	void Append(CaptureDirection nDirection, uint16_t nSource, const void* pData, size_t nLength)
+	{
+		if (!m_bOpen.load(std::memory_order_acquire) || (nLength == 0))
+		{
+			return;
+		}
+		std::unique_lock<std::mutex> lock(m_pLock);
+		if (!m_bOpen.load(std::memory_order_relaxed))
+		{
+			return;
+		}
+		if (m_vecPending.size() + sizeof(CCaptureRecord) + nLength > CAPTURE_MAX_PENDING)
+		{
+			m_nRecordsDropped.fetch_add(1, std::memory_order_relaxed);
+			return;
+		}
+
+		CCaptureRecord record = {};
+		record.nTimestamp = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+			std::chrono::steady_clock::now() - m_nStartTime).count());
+		record.nLength = static_cast<uint32_t>(nLength);
+		record.nSource = nSource;
+		record.nDirection = nDirection;
+		const size_t nPosition = m_vecPending.size();
+		m_vecPending.resize(nPosition + sizeof(record) + nLength);
+		memcpy(m_vecPending.data() + nPosition, &record, sizeof(record));
+		memcpy(m_vecPending.data() + nPosition + sizeof(record), pData, nLength);
+		const bool bFull = (m_vecPending.size() >= CAPTURE_BATCH_SIZE);
+		lock.unlock();
+		if (bFull)
+		{
+			m_pWake.notify_one();
+		}
+	}
+
+	/**
+	 * @brief Returns a snapshot of the counters. Safe to call from any thread.
+	 */
+	CCaptureStats GetStats() const
+	{
+		CCaptureStats stats;
+		stats.nRecords = m_nRecords.load(std::memory_order_relaxed);
+		stats.nBytesWritten = m_nBytesWritten.load(std::memory_order_relaxed);
+		stats.nRecordsDropped = m_nRecordsDropped.load(std::memory_order_relaxed);
+		return stats;
+	}
+
+protected:
+	void Run()
+	{
+		std::unique_lock<std::mutex> lock(m_pLock);
+		for (;;)
+		{
+			m_pWake.wait_for(lock, std::chrono::milliseconds(CAPTURE_FLUSH_INTERVAL),
+				[this]() { return m_bStop || (m_vecPending.size() >= CAPTURE_BATCH_SIZE); });
+			const bool bStop = m_bStop;
+			m_vecWriting.swap(m_vecPending);
+			lock.unlock();
+
+			if (!m_vecWriting.empty())
+			{
+				WriteBatch();
+				m_vecWriting.clear();
+			}
+			if (bStop)
+			{
+				return;
+			}
+			lock.lock();
+		}
+	}
+
+	/**
+	 * @brief Writes one batch of records, then the index entries pointing into it.
+	 */
+	void WriteBatch()
+	{
+		uint64_t nCount = 0;
+		m_vecIndex.clear();
+		for (size_t nPosition = 0; nPosition < m_vecWriting.size(); nCount++)
+		{
+			CCaptureRecord record;
+			memcpy(&record, m_vecWriting.data() + nPosition, sizeof(record));
+			const uint64_t nOffset = m_nFileSize + nPosition;
+			if (nOffset >= m_nNextIndex)
+			{
+				m_vecIndex.push_back(CCaptureIndexEntry{ record.nTimestamp, nOffset });
+				m_nNextIndex = nOffset + CAPTURE_INDEX_INTERVAL;
+			}
+			nPosition += sizeof(record) + record.nLength;
+		}
+
+		if (!m_pFile.Write(m_vecWriting.data(), m_vecWriting.size()))
+		{
+			// Disk full or gone: the capture cannot continue
+			m_nRecordsDropped.fetch_add(nCount, std::memory_order_relaxed);
+			m_bOpen.store(false, std::memory_order_release);
+			return;
+		}
+		m_nFileSize += m_vecWriting.size();
+		if (!m_vecIndex.empty())
+		{
+			// A lost index entry only makes the reader scan a little more
+			m_pIndexFile.Write(m_vecIndex.data(), m_vecIndex.size() * sizeof(CCaptureIndexEntry));
+		}
+		m_nRecords.fetch_add(nCount, std::memory_order_relaxed);
+		m_nBytesWritten.store(m_nFileSize, std::memory_order_relaxed);
+	}
+
+	CCaptureStream m_pFile;
+	CCaptureStream m_pIndexFile;
+	std::thread m_pThread;
+	std::mutex m_pLock;
+	std::condition_variable m_pWake;
+	std::atomic<bool> m_bOpen;
+	bool m_bStop;             // guarded by m_pLock
+	std::chrono::steady_clock::time_point m_nStartTime;
+	std::vector<char> m_vecPending; // guarded by m_pLock
+	// Writer thread
+	std::vector<char> m_vecWriting;
+	std::vector<CCaptureIndexEntry> m_vecIndex;
+	uint64_t m_nFileSize;
+	uint64_t m_nNextIndex;
+	// Counters
+	std::atomic<uint64_t> m_nRecords;
+	std::atomic<uint64_t> m_nBytesWritten;
+	std::atomic<uint64_t> m_nRecordsDropped;
+};
+
+/**
+ * @brief Reads a capture file in order, or from any instant.
+ *
+ * Open() loads the index and scans the records it does not cover (the tail of
+ * a capture still being written, or all of a capture whose index was lost),
+ * so Seek() costs a binary search and the scan of at most one index interval.
+ * Records are read through a CAPTURE_READ_SIZE buffer.
+ */
+class CCaptureReader
+{
+public:
+	static constexpr size_t CAPTURE_READ_SIZE = 0x100000;
+
+	CCaptureReader() : m_nWallClock(0), m_nDataOffset(0), m_nSize(0), m_nLastTimestamp(0),
+		m_nBufferOffset(0), m_nBufferLength(0)
+	{
+	}
+
+	CCaptureReader(const CCaptureReader&) = delete;
+	CCaptureReader& operator=(const CCaptureReader&) = delete;
+
+	/**
+	 * @brief Opens a capture file and prepares its index.
+	 * @return false if the file cannot be read or is not a capture file.
+	 */
+	bool Open(const CaptureChar* lpszPath)
+	{
+		Close();
+		CCaptureFileHeader header = {};
+		if (!m_pFile.OpenRead(lpszPath) || (m_pFile.Read(0, &header, sizeof(header)) != sizeof(header)) ||
+			(memcmp(header.pMagic, CAPTURE_FILE_MAGIC, sizeof(header.pMagic)) != 0) ||
+			(header.nVersion != CAPTURE_VERSION) || (header.nHeaderSize < sizeof(header)))
+		{
+			Close();
+			return false;
+		}
+		m_nWallClock = header.nWallClock;
+		m_nDataOffset = header.nHeaderSize;
+		m_nSize = m_pFile.GetSize();
+
+		// Keep the entries of the index that are consistent with this file
+		CCaptureStream pIndexFile;
+		const std::basic_string<CaptureChar> strIndexPath = std::basic_string<CaptureChar>(lpszPath) + CAPTURE_INDEX_SUFFIX;
+		CCaptureIndexHeader indexHeader = {};
+		if (pIndexFile.OpenRead(strIndexPath.c_str()) &&
+			(pIndexFile.Read(0, &indexHeader, sizeof(indexHeader)) == sizeof(indexHeader)) &&
+			(memcmp(indexHeader.pMagic, CAPTURE_INDEX_MAGIC, sizeof(indexHeader.pMagic)) == 0) &&
+			(indexHeader.nVersion == CAPTURE_VERSION))
+		{
+			const uint64_t nEntries = (pIndexFile.GetSize() - sizeof(indexHeader)) / sizeof(CCaptureIndexEntry);
+			m_vecIndex.resize(static_cast<size_t>(nEntries));
+			m_vecIndex.resize(pIndexFile.Read(sizeof(indexHeader), m_vecIndex.data(), m_vecIndex.size() * sizeof(CCaptureIndexEntry)) / sizeof(CCaptureIndexEntry));
+			for (size_t nEntry = 0; nEntry < m_vecIndex.size(); nEntry++)
+			{
+				const CCaptureIndexEntry& entry = m_vecIndex[nEntry];
+				if ((entry.nOffset < m_nDataOffset) || (entry.nOffset + sizeof(CCaptureRecord) > m_nSize) ||
+					((nEntry > 0) && ((entry.nOffset <= m_vecIndex[nEntry - 1].nOffset) || (entry.nTimestamp < m_vecIndex[nEntry - 1].nTimestamp))))
+				{
+					m_vecIndex.resize(nEntry);
+					break;
+				}
+			}
+		}
+
+		// Index the rest of the file, and find where its last complete record ends
+		uint64_t nOffset = m_vecIndex.empty() ? m_nDataOffset : m_vecIndex.back().nOffset;
+		uint64_t nNextIndex = m_vecIndex.empty() ? m_nDataOffset : nOffset + CAPTURE_INDEX_INTERVAL;
+		CCaptureRecord record;
+		while (const char* pRecord = Fetch(nOffset, sizeof(record)))
+		{
+			memcpy(&record, pRecord, sizeof(record));
+			const uint64_t nEnd = nOffset + sizeof(record) + record.nLength;
+			if ((nEnd > m_nSize) || (record.nTimestamp < m_nLastTimestamp))
+			{
+				break; // cut short by a crash, or not a record
+			}
+			if (nOffset >= nNextIndex)
+			{
+				m_vecIndex.push_back(CCaptureIndexEntry{ record.nTimestamp, nOffset });
+				nNextIndex = nOffset + CAPTURE_INDEX_INTERVAL;
+			}
+			m_nLastTimestamp = record.nTimestamp;
+			nOffset = nEnd;
+		}
+		m_nSize = nOffset;
+		return true;
+	}
+
+	void Close()
+	{
+		m_pFile.Close();
+		m_vecIndex.clear();
+		m_vecBuffer.clear();
+		m_nWallClock = 0;
+		m_nDataOffset = 0;
+		m_nSize = 0;
+		m_nLastTimestamp = 0;
+		m_nBufferOffset = 0;
+		m_nBufferLength = 0;
+	}
+
+	bool IsOpen() const
+	{
+		return m_pFile.IsOpen();
+	}
+
+	/**
+	 * @brief Returns the wall clock time the capture started, in nanoseconds since 1970-01-01 UTC.
+	 */
+	uint64_t GetWallClock() const
+	{
+		return m_nWallClock;
+	}
+
+	/**
+	 * @brief Returns the offset of the first record.
+	 */
+	uint64_t GetDataOffset() const
+	{
+		return m_nDataOffset;
+	}
+
+	/**
+	 * @brief Returns the offset just past the last complete record.
+	 */
+	uint64_t GetSize() const
+	{
+		return m_nSize;
+	}
+
+	/**
+	 * @brief Returns the timestamp of the last record.
+	 */
+	uint64_t GetLastTimestamp() const
+	{
+		return m_nLastTimestamp;
+	}
+
+	/**
+	 * @brief Returns the number of index entries.
+	 */
+	size_t GetIndexSize() const
+	{
+		return m_vecIndex.size();
+	}
+
+	/**
+	 * @brief Finds the first record stamped at or after an instant.
+	 *
+	 * @param nTimestamp Nanoseconds since the capture started.
+	 * @return Offset of that record, or GetSize() if every record is older.
+	 */
+	uint64_t Seek(uint64_t nTimestamp)
+	{
+		// Start from the last indexed record older than the instant
+		const auto pEntry = std::lower_bound(m_vecIndex.begin(), m_vecIndex.end(), nTimestamp,
+			[](const CCaptureIndexEntry& entry, uint64_t nValue) { return entry.nTimestamp < nValue; });
+		uint64_t nOffset = (pEntry == m_vecIndex.begin()) ? m_nDataOffset : (pEntry - 1)->nOffset;
+		CCaptureRecord record;
+		while (nOffset < m_nSize)
+		{
+			const char* pRecord = Fetch(nOffset, sizeof(record));
+			if (pRecord == nullptr)
+			{
+				return m_nSize;
+			}
+			memcpy(&record, pRecord, sizeof(record));
+			if (record.nTimestamp >= nTimestamp)
+			{
+				return nOffset;
+			}
+			nOffset += sizeof(record) + record.nLength;
+		}
+		return m_nSize;
+	}
+
+	/**
+	 * @brief Reads the record at nOffset and moves nOffset to the next one.
+	 *
+	 * @param nOffset Offset of a record, from GetDataOffset(), Seek() or a previous call.
+	 * @param record Receives the record header.
+	 * @param vecData Receives the raw bytes; its capacity is reused.
+	 * @return false at the end of the capture or on a read error.
+	 */
+	bool ReadRecord(uint64_t& nOffset, CCaptureRecord& record, std::vector<char>& vecData)
+	{
+		if (nOffset + sizeof(record) > m_nSize)
+		{
+			return false;
+		}
+		const char* pRecord = Fetch(nOffset, sizeof(record));
+		if (pRecord == nullptr)
+		{
+			return false;
+		}
+		memcpy(&record, pRecord, sizeof(record));
+		const uint64_t nDataOffset = nOffset + sizeof(record);
+		if (nDataOffset + record.nLength > m_nSize)
+		{
+			return false;
+		}
+		vecData.resize(record.nLength);
+		if (record.nLength <= CAPTURE_READ_SIZE)
+		{
+			const char* pData = Fetch(nDataOffset, record.nLength);
+			if (pData == nullptr)
+			{
+				return false;
+			}
+			memcpy(vecData.data(), pData, record.nLength);
+		}
+		else if (m_pFile.Read(nDataOffset, vecData.data(), record.nLength) != record.nLength)
+		{
+			return false;
+		}
+		nOffset = nDataOffset + record.nLength;
+		return true;
+	}
+
+protected:
+	/**
+	 * @brief Returns nLength bytes at nOffset from the read buffer, refilling it if needed.
+	 * @return nullptr if the file ends first.
+	 */
+	const char* Fetch(uint64_t nOffset, size_t nLength)
+	{
+		if ((nOffset < m_nBufferOffset) || (nOffset + nLength > m_nBufferOffset + m_nBufferLength))
+		{
+			m_vecBuffer.resize(CAPTURE_READ_SIZE);
+			m_nBufferOffset = nOffset;
+			m_nBufferLength = m_pFile.Read(nOffset, m_vecBuffer.data(), m_vecBuffer.size());
+			if (nLength > m_nBufferLength)
+			{
+				return nullptr;
+			}
+		}
+		return m_vecBuffer.data() + (nOffset - m_nBufferOffset);
+	}
+
+	CCaptureStream m_pFile;
+	std::vector<CCaptureIndexEntry> m_vecIndex;
+	uint64_t m_nWallClock;
+	uint64_t m_nDataOffset;
+	uint64_t m_nSize;
+	uint64_t m_nLastTimestamp;
+	std::vector<char> m_vecBuffer;
+	uint64_t m_nBufferOffset;
+	size_t m_nBufferLength;
+};
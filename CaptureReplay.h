@@ -0,0 +1,234 @@
+/* Copyright (C) 2014-2026 Stefan-Mihai MOGA
+This file is part of IntelliPort application developed by Stefan-Mihai MOGA.
+IntelliPort is an alternative Windows version to the famous HyperTerminal!
+
+IntelliPort is free software: you can redistribute it and/or modify it
+under the terms of the GNU General Public License as published by the Open
+Source Initiative, either version 3 of the License, or any later version.
+
+IntelliPort is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+IntelliPort. If not, see <http://www.opensource.org/licenses/gpl-3.0.html>*/
+
+// CaptureReplay.h : replays a capture file through a transport with precise pacing
+//
+
+#pragma once
+
+#include "CaptureFile.h"
+#include "LatencyHistogram.h"
+#include "PrecisionTimer.h"
+#include <functional>
+
+/**
+ * @brief Statistics of a replay, all times in nanoseconds unless noted.
+ */
+struct CCaptureReplayStats
+{
+	uint64_t nRecords;              // records sent
+	uint64_t nBytes;                // bytes sent
+	uint64_t nElapsed;              // since the first record was sent
+	uint64_t nCaptureDuration;      // capture time covered by the records sent
+	CLatencyHistogram pTimingError; // lateness of each send against its schedule, in microseconds
+	bool bFailed;                   // the transport refused a write
+};
+
+/**
+ * @brief Sends the records of a capture file through a transport.
+ *
+ * The engine runs on its own thread and hands each record's bytes to a send
+ * function, so any transport can be used: IntelliPort passes one built on
+ * CSerialPort::Write, CWSocket::Send or CWSocket::SendTo, and a test can pass
+ * one writing to a pty or a loopback socket. Three timing modes are offered:
+ * - REPLAY_ORIGINAL: each record is sent at its original offset from the first.
+ * - REPLAY_SCALED: the same schedule, run dSpeed times faster (or slower).
+ * - REPLAY_MAX_SPEED: records are sent back to back.
+ *
+ * Every send is scheduled against the start of the replay rather than the
+ * previous send, so waiting errors do not accumulate, and is waited for with
+ * a CPrecisionTimer. Each send's lateness is recorded in a histogram, so the
+ * engine reports the rate it achieved together with its timing error.
+ */
+class CCaptureReplay
+{
+public:
+	enum ReplayTiming
+	{
+		REPLAY_ORIGINAL = 0,
+		REPLAY_SCALED = 1,
+		REPLAY_MAX_SPEED = 2,
+	};
+
+	/**
+	 * @brief Sends one record's bytes; returns false to stop the replay on a transport error.
+	 */
+	typedef std::function<bool(const char* pData, size_t nLength)> SendFunction;
+
+	static constexpr int REPLAY_DIRECTION_ALL = -1;
+
+	CCaptureReplay() : m_bStop(false), m_bRunning(false), m_nTiming(REPLAY_ORIGINAL), m_dSpeed(1.0),
+		m_nDirection(CAPTURE_RECEIVED), m_nStartOffset(0), m_nStats()
+	{
+	}
+
+	~CCaptureReplay()
+	{
+		Stop();
+	}
+
+	CCaptureReplay(const CCaptureReplay&) = delete;
+	CCaptureReplay& operator=(const CCaptureReplay&) = delete;
+
+	/**
+	 * @brief Opens a capture file and starts replaying it on the engine's thread.
+	 *
+	 * @param lpszPath The capture file.
+	 * @param nTiming One of the ReplayTiming values.
+	 * @param dSpeed Speed factor for REPLAY_SCALED (2.0 replays twice as fast).
+	 * @param nDirection Records to send: CAPTURE_RECEIVED, CAPTURE_SENT or REPLAY_DIRECTION_ALL.
+	 * @param nStartTime Capture time to start from, in nanoseconds (found through the index).
+	 * @param pfnSend Called on the engine's thread for every record.
+	 * @param pfnFinished Called on the engine's thread when the replay ends, also after Stop().
+	 * @return false if the capture file cannot be opened.
+	 */
+	bool Start(const CaptureChar* lpszPath, ReplayTiming nTiming, double dSpeed, int nDirection, uint64_t nStartTime,
+		SendFunction pfnSend, std::function<void()> pfnFinished)
+	{
+		Stop();
+		if (!m_pReader.Open(lpszPath))
+		{
+			return false;
+		}
+		m_nTiming = nTiming;
+		m_dSpeed = ((nTiming == REPLAY_SCALED) && (dSpeed > 0.0)) ? dSpeed : 1.0;
+		m_nDirection = nDirection;
+		m_nStartOffset = m_pReader.Seek(nStartTime);
+		m_pfnSend = std::move(pfnSend);
+		m_pfnFinished = std::move(pfnFinished);
+		{
+			std::lock_guard<std::mutex> lock(m_pStatsLock);
+			m_nStats = CCaptureReplayStats();
+		}
+		m_bStop = false;
+		m_bRunning = true;
+		m_pThread = std::thread(&CCaptureReplay::Run, this);
+		return true;
+	}
+
+	/**
+	 * @brief Stops the replay and waits for the engine's thread to end.
+	 */
+	void Stop()
+	{
+		if (m_pThread.joinable())
+		{
+			m_bStop = true;
+			m_pThread.join();
+		}
+		m_pReader.Close();
+	}
+
+	/**
+	 * @brief Returns true once Stop() was called; a send function waiting for
+	 * the connection polls this to give up.
+	 */
+	bool IsStopping() const
+	{
+		return m_bStop.load(std::memory_order_relaxed);
+	}
+
+	/**
+	 * @brief Returns true until the last record was sent, the replay failed or was stopped.
+	 */
+	bool IsRunning() const
+	{
+		return m_bRunning.load(std::memory_order_acquire);
+	}
+
+	/**
+	 * @brief Returns a snapshot of the statistics. Safe to call from any thread.
+	 */
+	CCaptureReplayStats GetStats()
+	{
+		std::lock_guard<std::mutex> lock(m_pStatsLock);
+		return m_nStats;
+	}
+
+protected:
+	void Run()
+	{
+		CCaptureRecord record;
+		std::vector<char> vecData;
+		uint64_t nOffset = m_nStartOffset;
+		uint64_t nFirstTimestamp = 0;
+		std::chrono::steady_clock::time_point tStart;
+		bool bFirst = true;
+		while (!m_bStop.load(std::memory_order_relaxed) && m_pReader.ReadRecord(nOffset, record, vecData))
+		{
+			if ((m_nDirection != REPLAY_DIRECTION_ALL) && (record.nDirection != m_nDirection))
+			{
+				continue;
+			}
+			if (bFirst)
+			{
+				bFirst = false;
+				nFirstTimestamp = record.nTimestamp;
+				tStart = std::chrono::steady_clock::now();
+			}
+
+			const uint64_t nCaptureTime = record.nTimestamp - nFirstTimestamp;
+			uint64_t nLateness = 0;
+			if (m_nTiming != REPLAY_MAX_SPEED)
+			{
+				const std::chrono::steady_clock::time_point tDeadline = tStart +
+					std::chrono::nanoseconds(static_cast<int64_t>(static_cast<double>(nCaptureTime) / m_dSpeed));
+				if (!m_pTimer.WaitUntil(tDeadline, m_bStop))
+				{
+					break;
+				}
+				nLateness = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+					std::chrono::steady_clock::now() - tDeadline).count());
+			}
+
+			const bool bSent = m_pfnSend(vecData.data(), vecData.size());
+			const uint64_t nElapsed = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+				std::chrono::steady_clock::now() - tStart).count());
+			std::lock_guard<std::mutex> lock(m_pStatsLock);
+			if (!bSent)
+			{
+				m_nStats.bFailed = true;
+				break;
+			}
+			m_nStats.nRecords++;
+			m_nStats.nBytes += vecData.size();
+			m_nStats.nElapsed = nElapsed;
+			m_nStats.nCaptureDuration = nCaptureTime;
+			if (m_nTiming != REPLAY_MAX_SPEED)
+			{
+				m_nStats.pTimingError.Record(nLateness / 1000);
+			}
+		}
+		m_bRunning.store(false, std::memory_order_release);
+		if (m_pfnFinished)
+		{
+			m_pfnFinished();
+		}
+	}
+
+	CCaptureReader m_pReader;
+	std::thread m_pThread;
+	std::atomic<bool> m_bStop;
+	std::atomic<bool> m_bRunning;
+	ReplayTiming m_nTiming;
+	double m_dSpeed;
+	int m_nDirection;
+	uint64_t m_nStartOffset;
+	SendFunction m_pfnSend;
+	std::function<void()> m_pfnFinished;
+	CPrecisionTimer m_pTimer;
+	std::mutex m_pStatsLock;
+	CCaptureReplayStats m_nStats;
+};
@@ -83,6 +83,7 @@ void CConfigureDlg::DoDataExchange(CDataExchange* pDX)
 	DDX_Control(pDX, IDC_PARITY, m_pParity);
 	DDX_Control(pDX, IDC_STOP_BITS, m_pStopBits);
 	DDX_Control(pDX, IDC_FLOW_CONTROL, m_pFlowControl);
+	DDX_Control(pDX, IDC_LOW_LATENCY, m_pLowLatency);
 
 	// Map network socket configuration controls
 	DDX_Control(pDX, IDC_SOCKET_TYPE, m_pSocketType);
@@ -391,6 +392,9 @@ BOOL CConfigureDlg::OnInitDialog()
 			m_pFlowControl.SetCurSel(0);  // Default to no flow control
 		}
 
+	// Initialize serial port latency profile check box
+	m_pLowLatency.SetCheck(theApp.m_bLowLatency ? BST_CHECKED : BST_UNCHECKED);
+
 	// Initialize socket type combo box (Server or Client)
 	m_pSocketType.ResetContent();
 	m_pSocketType.AddString(_T("Server"));
@@ -651,6 +655,9 @@ void CConfigureDlg::OnOK()
 		}
 	}
 
+	// Save serial port latency profile
+	theApp.m_bLowLatency = (m_pLowLatency.GetCheck() == BST_CHECKED);
+
 	// Save socket type (Server or Client)
 	theApp.m_nSocketType = m_pSocketType.GetCurSel();
 
@@ -700,6 +707,7 @@ void CConfigureDlg::OnSelchangeConnection()
 	m_pParity.EnableWindow(m_pConnection.GetCurSel() == 0);
 	m_pStopBits.EnableWindow(m_pConnection.GetCurSel() == 0);
 	m_pFlowControl.EnableWindow(m_pConnection.GetCurSel() == 0);
+	m_pLowLatency.EnableWindow(m_pConnection.GetCurSel() == 0);
 
 	// Enable socket type only for TCP/UDP connections (index != 0)
 	m_pSocketType.EnableWindow(m_pConnection.GetCurSel() != 0);
@@ -42,6 +42,7 @@ protected:
 	CComboBox m_pParity;
 	CComboBox m_pStopBits;
 	CComboBox m_pFlowControl;
+	CButton m_pLowLatency;
 	CComboBox m_pSocketType;
 	CIPAddressCtrl m_pServerIP;
 	CEdit m_pServerPort;
@@ -0,0 +1,323 @@
+/* Copyright (C) 2014-2026 Stefan-Mihai MOGA
+This file is part of IntelliPort application developed by Stefan-Mihai MOGA.
+IntelliPort is an alternative Windows version to the famous HyperTerminal!
+
+IntelliPort is free software: you can redistribute it and/or modify it
+under the terms of the GNU General Public License as published by the Open
+Source Initiative, either version 3 of the License, or any later version.
+
+IntelliPort is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+IntelliPort. If not, see <http://www.opensource.org/licenses/gpl-3.0.html>*/
+
+// DatagramQueue.h : single-producer/single-consumer queue of whole datagrams with their metadata
+//
+
+#pragma once
+
+#include "CaptureFile.h"
+#include "DatagramReceiver.h"
+#include "TrafficGenerator.h"
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+/**
+ * @brief A datagram handed to the consumer by CDatagramQueue::Peek(), valid until Consume().
+ */
+struct CDatagramEntry
+{
+	const char* pData;
+	uint32_t nLength;
+	uint32_t nEndpoint;             // CEndpointTable id of the sender
+	uint64_t nTimestamp;            // CLatencyClock time of arrival, in nanoseconds
+	bool bTruncated;
+};
+
+/**
+ * @brief Counters of a CDatagramQueue since Reset().
+ */
+struct CDatagramQueueStats
+{
+	uint64_t nDatagrams;            // datagrams queued
+	uint64_t nBytes;                // payload bytes queued
+	uint64_t nDropped;              // datagrams refused because the queue was full
+	uint64_t nDroppedBytes;
+	uint64_t nTruncated;            // datagrams queued without their tail
+	uint64_t nHighWaterMark;        // most bytes of the slab in use at once
+};
+
+/**
+ * @brief Keeps UDP datagrams whole, with their sender and arrival time, on their way to the display.
+ *
+ * The socket thread pushes each datagram as one record into a contiguous slab
+ * allocated by Create(): a 24-byte header (length, endpoint id, timestamp,
+ * flags, record size) followed by the payload, padded to 8 bytes. Records
+ * never wrap: one that does not fit before the end of the slab is preceded by
+ * a padding record and starts again at the beginning. The UI thread takes
+ * batches of records with Peek(), which describes them in place, and hands
+ * the space back with Consume(). Nothing is allocated per datagram on either
+ * side, and neither side takes a lock.
+ *
+ * A datagram that finds no room is dropped whole and counted, so a burst never
+ * blocks the socket thread and the display never shows half a datagram.
+ *
+ * Like CReceiveBuffer, the queue records every datagram offered to a capture
+ * file (SetCapture) and scans it for test frames (SetTrafficChecker) before
+ * it decides whether there is room. The capture source of each record is the
+ * sender's endpoint id.
+ */
+class CDatagramQueue
+{
+public:
+	static constexpr uint32_t DATAGRAM_PADDING = 1;   // header flag: skip to the next record
+	static constexpr uint32_t DATAGRAM_TRUNCATED = 2; // header flag: the datagram lost its tail
+
+	CDatagramQueue() : m_nCapacity(0), m_nWrite(0), m_nRead(0), m_nPeekEnd(0), m_pCapture(nullptr),
+		m_pTrafficChecker(nullptr), m_nHighWaterMark(0)
+	{
+		ResetStats();
+	}
+
+	CDatagramQueue(const CDatagramQueue&) = delete;
+	CDatagramQueue& operator=(const CDatagramQueue&) = delete;
+
+	/**
+	 * @brief Allocates the slab. Call while neither side is running.
+	 * @param nCapacity Slab size in bytes, rounded down to 8; must hold a record of the largest datagram.
+	 */
+	bool Create(size_t nCapacity)
+	{
+		nCapacity &= ~static_cast<size_t>(7);
+		if (nCapacity < GetRecordSize(static_cast<uint32_t>(CDatagramReceiver::DATAGRAM_SLOT_SIZE)) * 2)
+		{
+			return false;
+		}
+		m_vecSlab.assign(nCapacity, 0);
+		m_nCapacity = nCapacity;
+		Reset();
+		return true;
+	}
+
+	void Destroy()
+	{
+		std::vector<char>().swap(m_vecSlab);
+		m_nCapacity = 0;
+		Reset();
+	}
+
+	/**
+	 * @brief Discards all datagrams and counters. Call while neither side is running.
+	 */
+	void Reset()
+	{
+		m_nWrite.store(0, std::memory_order_relaxed);
+		m_nRead.store(0, std::memory_order_relaxed);
+		m_nPeekEnd = 0;
+		ResetStats();
+	}
+
+	/**
+	 * @brief Records the datagrams offered to a capture file. Call while neither side is running.
+	 */
+	void SetCapture(CCaptureWriter* pCapture)
+	{
+		m_pCapture = pCapture;
+	}
+
+	/**
+	 * @brief Scans the datagrams offered for test frames. May be called while the producer runs.
+	 */
+	void SetTrafficChecker(CTrafficChecker* pTrafficChecker)
+	{
+		m_pTrafficChecker.store(pTrafficChecker, std::memory_order_release);
+	}
+
+	/**
+	 * @brief Queues a datagram. Producer side.
+	 * @return false if it was dropped for lack of room.
+	 */
+	bool Push(const CReceivedDatagram& pDatagram)
+	{
+		if (m_pCapture != nullptr)
+		{
+			m_pCapture->Append(CAPTURE_RECEIVED, static_cast<uint16_t>(pDatagram.nEndpoint), pDatagram.pData, pDatagram.nLength);
+		}
+		CTrafficChecker* pTrafficChecker = m_pTrafficChecker.load(std::memory_order_acquire);
+		if (pTrafficChecker != nullptr)
+		{
+			pTrafficChecker->Feed(pDatagram.pData, pDatagram.nLength);
+		}
+
+		if (m_nCapacity == 0)
+		{
+			Drop(pDatagram.nLength);
+			return false;
+		}
+		const size_t nSize = GetRecordSize(pDatagram.nLength);
+		const uint64_t nWrite = m_nWrite.load(std::memory_order_relaxed);
+		size_t nOffset = static_cast<size_t>(nWrite % m_nCapacity);
+		const size_t nTail = m_nCapacity - nOffset;
+		const size_t nNeeded = (nTail < nSize) ? (nTail + nSize) : nSize;
+		const uint64_t nUsed = nWrite - m_nRead.load(std::memory_order_acquire);
+		if (m_nCapacity - nUsed < nNeeded)
+		{
+			Drop(pDatagram.nLength);
+			return false;
+		}
+
+		if (nTail < nSize)
+		{
+			// Too little room left before the end: pad to it (a tail shorter
+			// than a header is skipped by the consumer without one)
+			if (nTail >= sizeof(CDatagramHeader))
+			{
+				CDatagramHeader pPadding = {};
+				pPadding.nFlags = DATAGRAM_PADDING;
+				pPadding.nSize = static_cast<uint32_t>(nTail);
+				memcpy(m_vecSlab.data() + nOffset, &pPadding, sizeof(pPadding));
+			}
+			nOffset = 0;
+		}
+		CDatagramHeader pHeader;
+		pHeader.nLength = pDatagram.nLength;
+		pHeader.nEndpoint = pDatagram.nEndpoint;
+		pHeader.nTimestamp = pDatagram.nTimestamp;
+		pHeader.nFlags = pDatagram.bTruncated ? DATAGRAM_TRUNCATED : 0;
+		pHeader.nSize = static_cast<uint32_t>(nSize);
+		memcpy(m_vecSlab.data() + nOffset, &pHeader, sizeof(pHeader));
+		memcpy(m_vecSlab.data() + nOffset + sizeof(pHeader), pDatagram.pData, pDatagram.nLength);
+		m_nWrite.store(nWrite + nNeeded, std::memory_order_release);
+
+		m_nDatagrams.fetch_add(1, std::memory_order_relaxed);
+		m_nBytes.fetch_add(pDatagram.nLength, std::memory_order_relaxed);
+		if (pDatagram.bTruncated)
+		{
+			m_nTruncated.fetch_add(1, std::memory_order_relaxed);
+		}
+		if (nUsed + nNeeded > m_nHighWaterMark.load(std::memory_order_relaxed))
+		{
+			m_nHighWaterMark.store(nUsed + nNeeded, std::memory_order_relaxed);
+		}
+		return true;
+	}
+
+	/**
+	 * @brief Describes up to nMax queued datagrams, oldest first. Consumer side.
+	 *
+	 * The datagrams stay in the slab until Consume(); a second Peek() without
+	 * Consume() returns the same ones.
+	 *
+	 * @return The number of entries filled.
+	 */
+	int Peek(CDatagramEntry* pEntries, int nMax)
+	{
+		uint64_t nRead = m_nRead.load(std::memory_order_relaxed);
+		const uint64_t nWrite = m_nWrite.load(std::memory_order_acquire);
+		int nCount = 0;
+		while ((nCount < nMax) && (nRead < nWrite))
+		{
+			const size_t nOffset = static_cast<size_t>(nRead % m_nCapacity);
+			if (m_nCapacity - nOffset < sizeof(CDatagramHeader))
+			{
+				nRead += m_nCapacity - nOffset;
+				continue;
+			}
+			CDatagramHeader pHeader;
+			memcpy(&pHeader, m_vecSlab.data() + nOffset, sizeof(pHeader));
+			nRead += pHeader.nSize;
+			if ((pHeader.nFlags & DATAGRAM_PADDING) != 0)
+			{
+				continue;
+			}
+			CDatagramEntry& pEntry = pEntries[nCount++];
+			pEntry.pData = m_vecSlab.data() + nOffset + sizeof(pHeader);
+			pEntry.nLength = pHeader.nLength;
+			pEntry.nEndpoint = pHeader.nEndpoint;
+			pEntry.nTimestamp = pHeader.nTimestamp;
+			pEntry.bTruncated = ((pHeader.nFlags & DATAGRAM_TRUNCATED) != 0);
+		}
+		m_nPeekEnd = nRead;
+		return nCount;
+	}
+
+	/**
+	 * @brief Hands the space of the datagrams from the last Peek() back to the producer.
+	 */
+	void Consume()
+	{
+		m_nRead.store(m_nPeekEnd, std::memory_order_release);
+	}
+
+	/**
+	 * @brief Returns true if no datagram is waiting. Consumer side.
+	 */
+	bool IsEmpty() const
+	{
+		return m_nRead.load(std::memory_order_relaxed) == m_nWrite.load(std::memory_order_acquire);
+	}
+
+	/**
+	 * @brief Returns a snapshot of the counters. Safe to call from any thread.
+	 */
+	CDatagramQueueStats GetStats() const
+	{
+		CDatagramQueueStats stats;
+		stats.nDatagrams = m_nDatagrams.load(std::memory_order_relaxed);
+		stats.nBytes = m_nBytes.load(std::memory_order_relaxed);
+		stats.nDropped = m_nDropped.load(std::memory_order_relaxed);
+		stats.nDroppedBytes = m_nDroppedBytes.load(std::memory_order_relaxed);
+		stats.nTruncated = m_nTruncated.load(std::memory_order_relaxed);
+		stats.nHighWaterMark = m_nHighWaterMark.load(std::memory_order_relaxed);
+		return stats;
+	}
+
+protected:
+	struct CDatagramHeader
+	{
+		uint32_t nLength;
+		uint32_t nEndpoint;
+		uint64_t nTimestamp;
+		uint32_t nFlags;
+		uint32_t nSize;             // header, payload and padding
+	};
+
+	static size_t GetRecordSize(uint32_t nLength)
+	{
+		return (sizeof(CDatagramHeader) + nLength + 7) & ~static_cast<size_t>(7);
+	}
+
+	void Drop(uint32_t nLength)
+	{
+		m_nDropped.fetch_add(1, std::memory_order_relaxed);
+		m_nDroppedBytes.fetch_add(nLength, std::memory_order_relaxed);
+	}
+
+	void ResetStats()
+	{
+		m_nDatagrams = 0;
+		m_nBytes = 0;
+		m_nDropped = 0;
+		m_nDroppedBytes = 0;
+		m_nTruncated = 0;
+		m_nHighWaterMark = 0;
+	}
+
+	std::vector<char> m_vecSlab;
+	size_t m_nCapacity;
+	std::atomic<uint64_t> m_nWrite;         // producer position, bytes since Reset()
+	std::atomic<uint64_t> m_nRead;          // consumer position
+	uint64_t m_nPeekEnd;                    // consumer position after the last Peek()
+	CCaptureWriter* m_pCapture;
+	std::atomic<CTrafficChecker*> m_pTrafficChecker;
+	std::atomic<uint64_t> m_nDatagrams;
+	std::atomic<uint64_t> m_nBytes;
+	std::atomic<uint64_t> m_nDropped;
+	std::atomic<uint64_t> m_nDroppedBytes;
+	std::atomic<uint64_t> m_nTruncated;
+	std::atomic<uint64_t> m_nHighWaterMark;
+};
@@ -0,0 +1,485 @@
+/* Copyright (C) 2014-2026 Stefan-Mihai MOGA
+This file is part of IntelliPort application developed by Stefan-Mihai MOGA.
+IntelliPort is an alternative Windows version to the famous HyperTerminal!
+
+IntelliPort is free software: you can redistribute it and/or modify it
+under the terms of the GNU General Public License as published by the Open
+Source Initiative, either version 3 of the License, or any later version.
+
+IntelliPort is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+IntelliPort. If not, see <http://www.opensource.org/licenses/gpl-3.0.html>*/
+
+// DatagramReceiver.h : batched UDP receive into preallocated slabs with interned source addresses
+//
+
+#pragma once
+
+#include "LatencyHistogram.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#ifdef _WIN32
+#include <ws2tcpip.h>
+#include <mswsock.h>
+#include <mstcpip.h>
+#else
+#include <cerrno>
+#include <ctime>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#endif
+
+/**
+ * @brief Gives each source address a small id, so a datagram carries 4 bytes instead of a sockaddr or a string.
+ *
+ * Ids start at 1 and are never reused until Reset(); ENDPOINT_UNKNOWN is
+ * returned once ENDPOINT_TABLE_SIZE addresses are known. Intern() is called
+ * by the receiving thread only and allocates nothing: addresses are kept in a
+ * preallocated array indexed through an open-addressing hash, and a datagram
+ * from the same sender as the previous one is matched without hashing. An
+ * entry never changes once published, so GetAddress() may be called from any
+ * thread for ids it has seen. Reset() only while no thread uses the table.
+ */
+class CEndpointTable
+{
+public:
+	static constexpr uint32_t ENDPOINT_UNKNOWN = 0;
+	static constexpr uint32_t ENDPOINT_TABLE_SIZE = 4096;     // addresses kept
+	static constexpr uint32_t ENDPOINT_HASH_SIZE = 8192;      // power of two, twice the table
+
+	CEndpointTable() : m_vecEntries(ENDPOINT_TABLE_SIZE), m_vecHash(ENDPOINT_HASH_SIZE, ENDPOINT_UNKNOWN),
+		m_nCount(0), m_nLast(ENDPOINT_UNKNOWN)
+	{
+	}
+
+	CEndpointTable(const CEndpointTable&) = delete;
+	CEndpointTable& operator=(const CEndpointTable&) = delete;
+
+	/**
+	 * @brief Forgets every address.
+	 */
+	void Reset()
+	{
+		std::fill(m_vecHash.begin(), m_vecHash.end(), ENDPOINT_UNKNOWN);
+		m_nCount.store(0, std::memory_order_release);
+		m_nLast = ENDPOINT_UNKNOWN;
+	}
+
+	/**
+	 * @brief Returns the id of a source address, adding it when new.
+	 * @return The id, or ENDPOINT_UNKNOWN for an unsupported family or a full table.
+	 */
+	uint32_t Intern(const sockaddr* pAddress, int nLength)
+	{
+		uint8_t pKey[ENDPOINT_KEY_SIZE];
+		if (!MakeKey(pAddress, nLength, pKey))
+		{
+			return ENDPOINT_UNKNOWN;
+		}
+		if ((m_nLast != ENDPOINT_UNKNOWN) && (memcmp(m_vecEntries[m_nLast - 1].pKey, pKey, ENDPOINT_KEY_SIZE) == 0))
+		{
+			return m_nLast;
+		}
+
+		// FNV-1a
+		uint32_t nHash = 2166136261u;
+		for (size_t nIndex = 0; nIndex < ENDPOINT_KEY_SIZE; nIndex++)
+		{
+			nHash = (nHash ^ pKey[nIndex]) * 16777619u;
+		}
+		for (uint32_t nSlot = nHash & (ENDPOINT_HASH_SIZE - 1); ; nSlot = (nSlot + 1) & (ENDPOINT_HASH_SIZE - 1))
+		{
+			const uint32_t nId = m_vecHash[nSlot];
+			if (nId == ENDPOINT_UNKNOWN)
+			{
+				const uint32_t nCount = m_nCount.load(std::memory_order_relaxed);
+				if (nCount == ENDPOINT_TABLE_SIZE)
+				{
+					return ENDPOINT_UNKNOWN;
+				}
+				CEndpointEntry& pEntry = m_vecEntries[nCount];
+				memcpy(pEntry.pKey, pKey, ENDPOINT_KEY_SIZE);
+				memset(&pEntry.pAddress, 0, sizeof(pEntry.pAddress));
+				memcpy(&pEntry.pAddress, pAddress, nLength);
+				pEntry.nLength = nLength;
+				m_vecHash[nSlot] = nCount + 1;
+				m_nCount.store(nCount + 1, std::memory_order_release); // publishes the entry
+				m_nLast = nCount + 1;
+				return m_nLast;
+			}
+			if (memcmp(m_vecEntries[nId - 1].pKey, pKey, ENDPOINT_KEY_SIZE) == 0)
+			{
+				m_nLast = nId;
+				return nId;
+			}
+		}
+	}
+
+	/**
+	 * @brief Copies the address of an id. Safe to call from any thread.
+	 * @return false for ENDPOINT_UNKNOWN or an id not published yet.
+	 */
+	bool GetAddress(uint32_t nId, sockaddr_storage& pAddress, int& nLength) const
+	{
+		if ((nId == ENDPOINT_UNKNOWN) || (nId > m_nCount.load(std::memory_order_acquire)))
+		{
+			return false;
+		}
+		pAddress = m_vecEntries[nId - 1].pAddress;
+		nLength = m_vecEntries[nId - 1].nLength;
+		return true;
+	}
+
+	/**
+	 * @brief Returns the number of addresses known.
+	 */
+	uint32_t GetCount() const
+	{
+		return m_nCount.load(std::memory_order_acquire);
+	}
+
+protected:
+	// Family, port and address (with the scope of an IPv6 one), the fields which tell senders apart
+	static constexpr size_t ENDPOINT_KEY_SIZE = 24;
+
+	struct CEndpointEntry
+	{
+		uint8_t pKey[ENDPOINT_KEY_SIZE];
+		sockaddr_storage pAddress;
+		int nLength;
+	};
+
+	static bool MakeKey(const sockaddr* pAddress, int nLength, uint8_t* pKey)
+	{
+		memset(pKey, 0, ENDPOINT_KEY_SIZE);
+		if ((pAddress->sa_family == AF_INET) && (nLength >= static_cast<int>(sizeof(sockaddr_in))))
+		{
+			const sockaddr_in* pAddress4 = reinterpret_cast<const sockaddr_in*>(pAddress);
+			pKey[0] = 4;
+			memcpy(pKey + 2, &pAddress4->sin_port, 2);
+			memcpy(pKey + 4, &pAddress4->sin_addr, 4);
+			return true;
+		}
+		if ((pAddress->sa_family == AF_INET6) && (nLength >= static_cast<int>(sizeof(sockaddr_in6))))
+		{
+			const sockaddr_in6* pAddress6 = reinterpret_cast<const sockaddr_in6*>(pAddress);
+			pKey[0] = 6;
+			memcpy(pKey + 2, &pAddress6->sin6_port, 2);
+			memcpy(pKey + 4, &pAddress6->sin6_addr, 16);
+			memcpy(pKey + 20, &pAddress6->sin6_scope_id, 4);
+			return true;
+		}
+		return false;
+	}
+
+	std::vector<CEndpointEntry> m_vecEntries;
+	std::vector<uint32_t> m_vecHash;        // ids, ENDPOINT_UNKNOWN for a free slot
+	std::atomic<uint32_t> m_nCount;
+	uint32_t m_nLast;                       // id of the previous sender
+};
+
+/**
+ * @brief A datagram in the receiver's slab, valid until the next Receive().
+ */
+struct CReceivedDatagram
+{
+	const char* pData;
+	uint32_t nLength;
+	uint32_t nEndpoint;             // CEndpointTable id of the sender
+	uint64_t nTimestamp;            // CLatencyClock time of arrival, in nanoseconds
+	const sockaddr* pSource;        // raw address of the sender
+	int nSourceLength;
+	bool bTruncated;                // longer than DATAGRAM_SLOT_SIZE, the rest was discarded
+};
+
+/**
+ * @brief Counters of a CDatagramReceiver since it was created.
+ */
+struct CDatagramReceiverStats
+{
+	uint64_t nDatagrams;
+	uint64_t nBytes;
+	uint64_t nBatches;              // Receive() calls which returned datagrams
+	uint64_t nTruncated;
+	bool bKernelTimestamps;         // arrival times come from the network stack
+};
+
+/**
+ * @brief Receives UDP datagrams in batches without allocating or formatting anything.
+ *
+ * Every buffer is allocated once, by the constructor: a slab of
+ * DATAGRAM_RECEIVE_BATCH slots of DATAGRAM_SLOT_SIZE bytes (enough for any
+ * UDP datagram), one sockaddr_storage and one control buffer per slot. Each
+ * Receive() fills as many slots as there are datagrams waiting and describes
+ * them with CReceivedDatagram entries: the payload in place, its length, the
+ * raw source address and its CEndpointTable id, and the arrival time.
+ * Datagram boundaries are kept, one slot each.
+ *
+ * Linux: a single recvmmsg call per batch, non-blocking. Arrival times come
+ * from SO_TIMESTAMPNS, moved from the realtime to the CLatencyClock timebase;
+ * the kernel turns timestamping on shortly after the first Attach() of the
+ * process, so the datagrams of that moment carry the time they were read.
+ *
+ * Windows: there is no batch receive for a regular socket, so WSARecvMsg is
+ * called for each datagram while FIONREAD reports one waiting (the socket
+ * stays blocking, as it is also used to send). Arrival times come from
+ * SIO_TIMESTAMPING (Windows 10 2004 and later) as QueryPerformanceCounter
+ * ticks, the CLatencyClock timebase.
+ *
+ * Without kernel timestamps, every datagram of a batch gets the time the
+ * batch was received. One thread only.
+ */
+class CDatagramReceiver
+{
+public:
+	static constexpr int DATAGRAM_RECEIVE_BATCH = 64;
+	static constexpr size_t DATAGRAM_SLOT_SIZE = 0x10000;
+	static constexpr size_t DATAGRAM_CONTROL_SIZE = 64;
+
+#ifdef _WIN32
+	typedef SOCKET Socket;
+#else
+	typedef int Socket;
+#endif
+
+	CDatagramReceiver() : m_vecSlab(DATAGRAM_RECEIVE_BATCH * DATAGRAM_SLOT_SIZE),
+		m_vecSources(DATAGRAM_RECEIVE_BATCH), m_vecControl(DATAGRAM_RECEIVE_BATCH * DATAGRAM_CONTROL_SIZE),
+		m_vecDatagrams(DATAGRAM_RECEIVE_BATCH), m_nStats()
+	{
+#ifdef _WIN32
+		m_pfnWSARecvMsg = nullptr;
+		LARGE_INTEGER nFrequency;
+		QueryPerformanceFrequency(&nFrequency);
+		m_nFrequency = static_cast<uint64_t>(nFrequency.QuadPart);
+#else
+		m_vecBuffers.resize(DATAGRAM_RECEIVE_BATCH);
+		m_vecMessages.resize(DATAGRAM_RECEIVE_BATCH);
+		for (int nIndex = 0; nIndex < DATAGRAM_RECEIVE_BATCH; nIndex++)
+		{
+			m_vecBuffers[nIndex].iov_base = m_vecSlab.data() + nIndex * DATAGRAM_SLOT_SIZE;
+			m_vecBuffers[nIndex].iov_len = DATAGRAM_SLOT_SIZE;
+			msghdr& pMessage = m_vecMessages[nIndex].msg_hdr;
+			pMessage.msg_name = &m_vecSources[nIndex];
+			pMessage.msg_iov = &m_vecBuffers[nIndex];
+			pMessage.msg_iovlen = 1;
+			pMessage.msg_control = m_vecControl.data() + nIndex * DATAGRAM_CONTROL_SIZE;
+		}
+#endif
+	}
+
+	CDatagramReceiver(const CDatagramReceiver&) = delete;
+	CDatagramReceiver& operator=(const CDatagramReceiver&) = delete;
+
+	/**
+	 * @brief Prepares a socket: asks for kernel arrival times (and, on Windows, finds WSARecvMsg).
+	 * @return true if the socket will report kernel arrival times.
+	 */
+	bool Attach(Socket hSocket)
+	{
+		m_nStats.bKernelTimestamps = false;
+#ifdef _WIN32
+		GUID guidRecvMsg = WSAID_WSARECVMSG;
+		DWORD dwBytes = 0;
+		if (WSAIoctl(hSocket, SIO_GET_EXTENSION_FUNCTION_POINTER, &guidRecvMsg, sizeof(guidRecvMsg),
+			&m_pfnWSARecvMsg, sizeof(m_pfnWSARecvMsg), &dwBytes, nullptr, nullptr) == SOCKET_ERROR)
+		{
+			m_pfnWSARecvMsg = nullptr;
+		}
+#ifdef SIO_TIMESTAMPING
+		TIMESTAMPING_CONFIG config = {};
+		config.Flags = TIMESTAMPING_FLAG_RX;
+		m_nStats.bKernelTimestamps = (m_pfnWSARecvMsg != nullptr) &&
+			(WSAIoctl(hSocket, SIO_TIMESTAMPING, &config, sizeof(config), nullptr, 0, &dwBytes, nullptr, nullptr) == 0);
+#endif
+#else
+		const int nEnable = 1;
+		m_nStats.bKernelTimestamps = (setsockopt(hSocket, SOL_SOCKET, SO_TIMESTAMPNS, &nEnable, sizeof(nEnable)) == 0);
+#endif
+		return m_nStats.bKernelTimestamps;
+	}
+
+	/**
+	 * @brief Receives the datagrams waiting, up to DATAGRAM_RECEIVE_BATCH, without blocking.
+	 * @return The number of datagrams received (see GetDatagram), 0 if none
+	 *     was waiting, -1 on an error (see WSAGetLastError / errno).
+	 */
+	int Receive(Socket hSocket, CEndpointTable& pEndpoints)
+	{
+		int nCount = 0;
+#ifdef _WIN32
+		for (; nCount < DATAGRAM_RECEIVE_BATCH; nCount++)
+		{
+			u_long nWaiting = 0;
+			if ((nCount > 0) && ((ioctlsocket(hSocket, FIONREAD, &nWaiting) == SOCKET_ERROR) || (nWaiting == 0)))
+			{
+				break;
+			}
+			WSABUF pBuffer;
+			pBuffer.buf = m_vecSlab.data() + nCount * DATAGRAM_SLOT_SIZE;
+			pBuffer.len = static_cast<ULONG>(DATAGRAM_SLOT_SIZE);
+			WSAMSG pMessage = {};
+			pMessage.name = reinterpret_cast<LPSOCKADDR>(&m_vecSources[nCount]);
+			pMessage.namelen = sizeof(sockaddr_storage);
+			pMessage.lpBuffers = &pBuffer;
+			pMessage.dwBufferCount = 1;
+			pMessage.Control.buf = m_vecControl.data() + nCount * DATAGRAM_CONTROL_SIZE;
+			pMessage.Control.len = static_cast<ULONG>(DATAGRAM_CONTROL_SIZE);
+			DWORD dwReceived = 0;
+			bool bTruncated = false;
+			int nResult = 0;
+			if (m_pfnWSARecvMsg != nullptr)
+			{
+				nResult = m_pfnWSARecvMsg(hSocket, &pMessage, &dwReceived, nullptr, nullptr);
+			}
+			else
+			{
+				pMessage.Control.len = 0;
+				nResult = recvfrom(hSocket, pBuffer.buf, static_cast<int>(pBuffer.len), 0, pMessage.name, &pMessage.namelen);
+				dwReceived = static_cast<DWORD>((nResult == SOCKET_ERROR) ? 0 : nResult);
+			}
+			if (nResult == SOCKET_ERROR)
+			{
+				if (WSAGetLastError() != WSAEMSGSIZE)
+				{
+					if (nCount == 0)
+					{
+						return (WSAGetLastError() == WSAEWOULDBLOCK) ? 0 : -1;
+					}
+					break;
+				}
+				bTruncated = true;
+				dwReceived = static_cast<DWORD>(DATAGRAM_SLOT_SIZE);
+			}
+			uint64_t nTimestamp = 0;
+#ifdef SIO_TIMESTAMPING
+			if (pMessage.Control.len != 0)
+			{
+				for (WSACMSGHDR* pHeader = WSA_CMSG_FIRSTHDR(&pMessage); pHeader != nullptr; pHeader = WSA_CMSG_NXTHDR(&pMessage, pHeader))
+				{
+					if ((pHeader->cmsg_level == SOL_SOCKET) && (pHeader->cmsg_type == SO_TIMESTAMP))
+					{
+						UINT64 nTicks = 0;
+						memcpy(&nTicks, WSA_CMSG_DATA(pHeader), sizeof(nTicks));
+						// The same conversion as std::chrono::steady_clock
+						nTimestamp = (nTicks / m_nFrequency) * 1000000000 + (nTicks % m_nFrequency) * 1000000000 / m_nFrequency;
+					}
+				}
+			}
+#endif
+			Describe(nCount, static_cast<uint32_t>(dwReceived), pMessage.namelen, bTruncated, nTimestamp, pEndpoints);
+		}
+#else
+		for (int nIndex = 0; nIndex < DATAGRAM_RECEIVE_BATCH; nIndex++)
+		{
+			m_vecMessages[nIndex].msg_hdr.msg_namelen = sizeof(sockaddr_storage);
+			m_vecMessages[nIndex].msg_hdr.msg_controllen = DATAGRAM_CONTROL_SIZE;
+		}
+		do
+		{
+			nCount = recvmmsg(hSocket, m_vecMessages.data(), DATAGRAM_RECEIVE_BATCH, MSG_DONTWAIT, nullptr);
+		}
+		while ((nCount < 0) && (errno == EINTR));
+		if (nCount <= 0)
+		{
+			return ((nCount < 0) && (errno != EAGAIN) && (errno != EWOULDBLOCK)) ? -1 : 0;
+		}
+		// SO_TIMESTAMPNS reports CLOCK_REALTIME; move it to the monotonic CLatencyClock
+		int64_t nRealtimeOffset = 0;
+		if (m_nStats.bKernelTimestamps)
+		{
+			timespec tRealtime;
+			clock_gettime(CLOCK_REALTIME, &tRealtime);
+			nRealtimeOffset = static_cast<int64_t>(tRealtime.tv_sec) * 1000000000 + tRealtime.tv_nsec -
+				std::chrono::duration_cast<std::chrono::nanoseconds>(CLatencyClock::now().time_since_epoch()).count();
+		}
+		for (int nIndex = 0; nIndex < nCount; nIndex++)
+		{
+			msghdr& pMessage = m_vecMessages[nIndex].msg_hdr;
+			uint64_t nTimestamp = 0;
+			for (cmsghdr* pHeader = CMSG_FIRSTHDR(&pMessage); pHeader != nullptr; pHeader = CMSG_NXTHDR(&pMessage, pHeader))
+			{
+				if ((pHeader->cmsg_level == SOL_SOCKET) && (pHeader->cmsg_type == SCM_TIMESTAMPNS))
+				{
+					timespec tArrival;
+					memcpy(&tArrival, CMSG_DATA(pHeader), sizeof(tArrival));
+					nTimestamp = static_cast<uint64_t>(static_cast<int64_t>(tArrival.tv_sec) * 1000000000 + tArrival.tv_nsec - nRealtimeOffset);
+				}
+			}
+			Describe(nIndex, m_vecMessages[nIndex].msg_len, static_cast<int>(pMessage.msg_namelen),
+				(pMessage.msg_flags & MSG_TRUNC) != 0, nTimestamp, pEndpoints);
+		}
+#endif
+		if (nCount > 0)
+		{
+			// Datagrams without a kernel time get the time of the batch
+			const uint64_t nNow = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+				CLatencyClock::now().time_since_epoch()).count());
+			for (int nIndex = 0; nIndex < nCount; nIndex++)
+			{
+				if (m_vecDatagrams[nIndex].nTimestamp == 0)
+				{
+					m_vecDatagrams[nIndex].nTimestamp = nNow;
+				}
+			}
+			m_nStats.nBatches++;
+			m_nStats.nDatagrams += nCount;
+		}
+		return nCount;
+	}
+
+	/**
+	 * @brief Returns a datagram of the last Receive().
+	 */
+	const CReceivedDatagram& GetDatagram(int nIndex) const
+	{
+		return m_vecDatagrams[nIndex];
+	}
+
+	/**
+	 * @brief Returns the counters. Receiving thread only.
+	 */
+	const CDatagramReceiverStats& GetStats() const
+	{
+		return m_nStats;
+	}
+
+protected:
+	void Describe(int nIndex, uint32_t nLength, int nSourceLength, bool bTruncated, uint64_t nTimestamp, CEndpointTable& pEndpoints)
+	{
+		CReceivedDatagram& pDatagram = m_vecDatagrams[nIndex];
+		pDatagram.pData = m_vecSlab.data() + nIndex * DATAGRAM_SLOT_SIZE;
+		pDatagram.nLength = nLength;
+		pDatagram.pSource = reinterpret_cast<const sockaddr*>(&m_vecSources[nIndex]);
+		pDatagram.nSourceLength = nSourceLength;
+		pDatagram.nEndpoint = pEndpoints.Intern(pDatagram.pSource, nSourceLength);
+		pDatagram.nTimestamp = nTimestamp;
+		pDatagram.bTruncated = bTruncated;
+		m_nStats.nBytes += nLength;
+		if (bTruncated)
+		{
+			m_nStats.nTruncated++;
+		}
+	}
+
+	std::vector<char> m_vecSlab;
+	std::vector<sockaddr_storage> m_vecSources;
+	std::vector<char> m_vecControl;
+	std::vector<CReceivedDatagram> m_vecDatagrams;
+#ifdef _WIN32
+	LPFN_WSARECVMSG m_pfnWSARecvMsg;
+	uint64_t m_nFrequency;
+#else
+	std::vector<iovec> m_vecBuffers;
+	std::vector<mmsghdr> m_vecMessages;
+#endif
+	CDatagramReceiverStats m_nStats;
+};
@@ -0,0 +1,122 @@
+/* Copyright (C) 2014-2026 Stefan-Mihai MOGA
+This file is part of IntelliPort application developed by Stefan-Mihai MOGA.
+IntelliPort is an alternative Windows version to the famous HyperTerminal!
+
+IntelliPort is free software: you can redistribute it and/or modify it
+under the terms of the GNU General Public License as published by the Open
+Source Initiative, either version 3 of the License, or any later version.
+
+IntelliPort is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+IntelliPort. If not, see <http://www.opensource.org/licenses/gpl-3.0.html>*/
+
+// DelimiterScanner.h : vectorized search for the first of up to three delimiters
+//
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define DELIMITER_SCANNER_AVX2
+#endif
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#include <emmintrin.h>
+#define DELIMITER_SCANNER_SSE2
+#endif
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+/**
+ * @brief Returns the index of the lowest set bit of a non-zero mask.
+ */
+inline unsigned int DelimiterScannerLowestBit(uint32_t nMask)
+{
+#if defined(_MSC_VER)
+	unsigned long nIndex = 0;
+	_BitScanForward(&nIndex, nMask);
+	return static_cast<unsigned int>(nIndex);
+#else
+	return static_cast<unsigned int>(__builtin_ctz(nMask));
+#endif
+}
+
+/**
+ * @brief Finds the first byte equal to any of three delimiters.
+ *
+ * Compares 32 bytes per step with AVX2 or 16 bytes per step with SSE2, depending
+ * on the instruction set the compiler targets, and finishes the tail with scalar
+ * code. Pass the same character more than once to search for fewer delimiters.
+ *
+ * @param pData Pointer to the bytes to search.
+ * @param nLength Number of bytes to search.
+ * @param chFirst First delimiter (e.g. '\n').
+ * @param chSecond Second delimiter (e.g. '\r').
+ * @param chThird Third delimiter (e.g. a protocol frame delimiter).
+ * @return Index of the first delimiter found, or nLength if there is none.
+ */
+inline size_t FindFirstDelimiter(const char* pData, size_t nLength, char chFirst, char chSecond, char chThird)
+{
+	size_t nIndex = 0;
+
+	// A single delimiter is what memchr is tuned for
+	if ((chFirst == chSecond) && (chFirst == chThird))
+	{
+		const void* pFound = memchr(pData, chFirst, nLength);
+		return (pFound != nullptr) ? static_cast<size_t>(static_cast<const char*>(pFound) - pData) : nLength;
+	}
+
+#if defined(DELIMITER_SCANNER_AVX2)
+	const __m256i vFirst32 = _mm256_set1_epi8(chFirst);
+	const __m256i vSecond32 = _mm256_set1_epi8(chSecond);
+	const __m256i vThird32 = _mm256_set1_epi8(chThird);
+	for (; nIndex + 32 <= nLength; nIndex += 32)
+	{
+		const __m256i vData = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pData + nIndex));
+		const __m256i vMatch = _mm256_or_si256(_mm256_or_si256(
+			_mm256_cmpeq_epi8(vData, vFirst32), _mm256_cmpeq_epi8(vData, vSecond32)),
+			_mm256_cmpeq_epi8(vData, vThird32));
+		const uint32_t nMask = static_cast<uint32_t>(_mm256_movemask_epi8(vMatch));
+		if (nMask != 0)
+		{
+			return nIndex + DelimiterScannerLowestBit(nMask);
+		}
+	}
+#endif
+
+#if defined(DELIMITER_SCANNER_SSE2)
+	const __m128i vFirst = _mm_set1_epi8(chFirst);
+	const __m128i vSecond = _mm_set1_epi8(chSecond);
+	const __m128i vThird = _mm_set1_epi8(chThird);
+	for (; nIndex + 16 <= nLength; nIndex += 16)
+	{
+		const __m128i vData = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pData + nIndex));
+		const __m128i vMatch = _mm_or_si128(_mm_or_si128(
+			_mm_cmpeq_epi8(vData, vFirst), _mm_cmpeq_epi8(vData, vSecond)),
+			_mm_cmpeq_epi8(vData, vThird));
+		const uint32_t nMask = static_cast<uint32_t>(_mm_movemask_epi8(vMatch));
+		if (nMask != 0)
+		{
+			return nIndex + DelimiterScannerLowestBit(nMask);
+		}
+	}
+#endif
+
+	// Scalar fallback, also used for the tail of the vector loops
+	for (; nIndex < nLength; nIndex++)
+	{
+		const char chData = pData[nIndex];
+		if ((chData == chFirst) || (chData == chSecond) || (chData == chThird))
+		{
+			return nIndex;
+		}
+	}
+	return nLength;
+}
@@ -35,15 +35,31 @@ IntelliPort. If not, see <http://www.opensource.org/licenses/gpl-3.0.html>*/
  * @throws std::runtime_error If the conversion fails.
  */
 std::wstring utf8_to_wstring(const std::string& string)
+{
+	return utf8_to_wstring(string.data(), (int)string.size());
+}
+
+/**
+ * @brief Converts a UTF-8 encoded buffer to a wide string (UTF-16).
+ * 
+ * Works directly on the caller's memory (e.g. a span of the ring buffer),
+ * so no intermediate std::string copy is needed.
+ * 
+ * @param text Pointer to the UTF-8 encoded bytes (need not be null-terminated).
+ * @param length Number of bytes to convert.
+ * @return A wide string (std::wstring) representation of the input.
+ * @throws std::runtime_error If the conversion fails.
+ */
+std::wstring utf8_to_wstring(const char* text, int length)
 {
 	// Handle empty string case early
-	if (string.empty())
+	if ((text == nullptr) || (length <= 0))
 	{
 		return L"";
 	}
 
 	// First call to get the required buffer size
-	const auto size_needed = MultiByteToWideChar(CP_UTF8, 0, string.data(), (int)string.size(), nullptr, 0);
+	const auto size_needed = MultiByteToWideChar(CP_UTF8, 0, text, length, nullptr, 0);
 	if (size_needed <= 0)
 	{
 		throw std::runtime_error("MultiByteToWideChar() failed: " + std::to_string(size_needed));
@@ -51,7 +67,7 @@ std::wstring utf8_to_wstring(const std::string& string)
 
 	// Allocate buffer and perform the actual conversion
 	std::wstring result(size_needed, 0);
-	MultiByteToWideChar(CP_UTF8, 0, string.data(), (int)string.size(), result.data(), size_needed);
+	MultiByteToWideChar(CP_UTF8, 0, text, length, result.data(), size_needed);
 	return result;
 }
 
@@ -133,6 +149,7 @@ CIntelliPortApp::CIntelliPortApp()
 	m_nParity = 0;        // Serial port parity setting
 	m_nStopBits = 0;      // Serial port stop bits
 	m_nFlowControl = 0;   // Serial port flow control
+	m_bLowLatency = false; // Serial port latency profile
 	m_nSocketType = 0;    // Network socket type
 	m_nServerPort = 0;    // Server port number
 	m_nClientPort = 0;    // Client port number
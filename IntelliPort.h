@@ -24,6 +24,7 @@ IntelliPort. If not, see <http://www.opensource.org/licenses/gpl-3.0.html>*/
 #include "resource.h"       // main symbols
 
 std::wstring utf8_to_wstring(const std::string& str);
+std::wstring utf8_to_wstring(const char* text, int length);
 std::string wstring_to_utf8(const std::wstring& str);
 
 // CIntelliPortApp:
@@ -40,6 +41,7 @@ public:
 	int m_nParity;
 	int m_nStopBits;
 	int m_nFlowControl;
+	bool m_bLowLatency;
 	int m_nSocketType;
 	CString m_strServerIP;
 	int m_nServerPort;
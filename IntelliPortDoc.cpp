@@ -25,6 +25,9 @@ IntelliPort. If not, see <http://www.opensource.org/licenses/gpl-3.0.html>*/
 
 #include "IntelliPortDoc.h"
 #include "MainFrame.h"
+#include "Messages.h"
+#include "Transcode.h"
+#include "Utf8Writer.h"
 #include <propkey.h>
 
 #ifdef _DEBUG
@@ -168,6 +171,14 @@ CIntelliPortDoc::CIntelliPortDoc()
 	// Will be detected when loading files
 	m_BOM = BOM::Unknown;
 
+	// Line endings stored in the scrollback: CRLF (default), LF or raw
+	m_pLineEnding.SetMode((CLineEndingNormalizer<wchar_t>::LineEndingMode) std::clamp(theApp.GetInt(_T("LineEndings"), 0), 0, 2));
+
+	// Scrollback caps: oldest text is dropped beyond this many lines or megabytes (0 = no cap)
+	m_pScrollback.SetLimits(
+		(uint64_t) std::clamp(theApp.GetInt(_T("ScrollbackMaxLines"), 1000000), 0, INT_MAX),
+		(uint64_t) std::clamp(theApp.GetInt(_T("ScrollbackMaxMB"), 256), 0, 0x100000) << 20);
+
 	// Create terminal font with Consolas typeface (monospace font)
 	VERIFY(m_fontTerminal.CreateFont(
 		-MulDiv(10, GetDeviceCaps(::GetDC(nullptr), LOGPIXELSY), 72), // nHeight - 10pt font size
@@ -204,10 +215,7 @@ CIntelliPortDoc::~CIntelliPortDoc()
  * 
  * Initializes the document for terminal display:
  * - Calls base class to perform standard initialization
- * - Clears any existing text in the view
- * - Sets the terminal font (Consolas) for the edit control
- * - Makes the edit control read-only (terminal output)
- * - Removes text length limit for unlimited terminal output
+ * - Clears the scrollback and redraws the view
  * 
  * This method is called when:
  * - The application starts (initial document in SDI)
@@ -222,80 +230,242 @@ BOOL CIntelliPortDoc::OnNewDocument()
 	if (!CDocument::OnNewDocument())
 		return FALSE;
 
-	// Clear existing text from the view (important for SDI document reuse)
-	if (!m_viewList.IsEmpty())
+	// DeleteContents() has cleared the text (important for SDI document reuse)
+	UpdateAllViews(nullptr);
+
+	return TRUE;
+}
+
+/**
+ * @brief Releases the text before the document is reused by New or Open.
+ * 
+ * Stops indexing and unmaps the opened file, and clears the scrollback.
+ */
+void CIntelliPortDoc::DeleteContents()
+{
+	m_pMappedFile.Close();
+	m_pScrollback.Clear();
+	m_pLineEnding.Reset();
+	CDocument::DeleteContents();
+}
+
+/**
+ * @brief Saves the document, also over the file it was opened from.
+ * 
+ * A mapped file cannot be replaced, so saving over it writes a temporary file
+ * next to it first, then unmaps the original and moves the new file in place.
+ * The saved file is mapped again and the scrollback, now part of it, cleared.
+ * If the move fails the original file is mapped again and nothing is lost.
+ * 
+ * @param lpszPathName Full path of the file to save.
+ * @return TRUE if the document was saved.
+ */
+BOOL CIntelliPortDoc::OnSaveDocument(LPCTSTR lpszPathName)
+{
+	if (!m_pMappedFile.IsOpen() || (GetPathName().CompareNoCase(lpszPathName) != 0))
 	{
-		reinterpret_cast<CEditView*>(m_viewList.GetHead())->SetWindowText(nullptr);
+		return CDocument::OnSaveDocument(lpszPathName);
 	}
 
-	// Configure edit control for terminal display
-	// Set monospace font for better alignment and readability
-	reinterpret_cast<CEditView*>(m_viewList.GetHead())->GetEditCtrl().SetFont(&m_fontTerminal);
-	// Make read-only to prevent user editing of terminal output
-	reinterpret_cast<CEditView*>(m_viewList.GetHead())->GetEditCtrl().SetReadOnly(TRUE);
-	// Remove text length limit (default is 32KB) for unlimited terminal output
-	reinterpret_cast<CEditView*>(m_viewList.GetHead())->GetEditCtrl().LimitText(-1);
+	const CString strTempName = CString(lpszPathName) + _T(".tmp");
+	if (!CDocument::OnSaveDocument(strTempName))
+	{
+		return FALSE;
+	}
+	m_pMappedFile.Close();
+	const BOOL bMoved = MoveFileEx(strTempName, lpszPathName, MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH);
+	if (bMoved)
+	{
+		m_pScrollback.Clear();
+		m_pLineEnding.Reset();
+
+		// Serialize() reported the temporary file name
+		CString strFormat, strMessage;
+		VERIFY(strFormat.LoadString(IDS_FILE_HAS_BEEN_SAVED));
+		strMessage.Format(strFormat, lpszPathName);
+		CMainFrame* pMainFrame = (CMainFrame*) AfxGetMainWnd();
+		ASSERT_VALID(pMainFrame);
+		pMainFrame->SetStatusBarText(strMessage);
+	}
+	else
+	{
+		DeleteFile(strTempName);
+		ReportSaveLoadException(lpszPathName, nullptr, TRUE, AFX_IDP_FAILED_TO_SAVE_DOC);
+	}
 
-	return TRUE;
+	CFile pFile;
+	if (pFile.Open(lpszPathName, CFile::modeRead | CFile::shareDenyWrite))
+	{
+		OpenMappedFile(&pFile);
+		pFile.Close();
+	}
+	UpdateAllViews(nullptr);
+	return bMoved;
 }
 
 /**
- * @brief Adds text to the terminal view with line ending normalization.
+ * @brief Returns the number of lines shown: those of the opened file, then the scrollback.
+ */
+uint64_t CIntelliPortDoc::GetLineCount() const
+{
+	const uint64_t nFirstScrollbackLine = GetFirstScrollbackLine();
+	if ((nFirstScrollbackLine != 0) && (m_pScrollback.GetLength() == 0))
+	{
+		return nFirstScrollbackLine;
+	}
+	return nFirstScrollbackLine + m_pScrollback.GetLineCount();
+}
+
+/**
+ * @brief Copies one line, without its line ending, from the opened file or the scrollback.
  * 
- * Performs the following operations:
- * 1. Normalizes all line endings to Windows standard (CRLF)
- * 2. Appends text to the end of the edit control
- * 3. Resets text selection
+ * @param nLine Zero-based line number.
+ * @param strLine String receiving the line; its capacity is reused.
+ * @param nMaxLength Most characters to copy, e.g. what fits in the window.
+ * @return Length of the whole line, which may exceed the characters copied.
+ */
+uint64_t CIntelliPortDoc::GetLine(uint64_t nLine, std::wstring& strLine, size_t nMaxLength) const
+{
+	const uint64_t nFirstScrollbackLine = GetFirstScrollbackLine();
+	if (nLine < nFirstScrollbackLine)
+	{
+		return m_pMappedFile.GetLine(nLine, strLine, nMaxLength);
+	}
+	return m_pScrollback.GetLine(nLine - nFirstScrollbackLine, strLine, nMaxLength);
+}
+
+/**
+ * @brief Returns the length of the longest line, used for horizontal scrolling.
+ */
+uint64_t CIntelliPortDoc::GetMaxLineLength() const
+{
+	return std::max(m_pMappedFile.GetMaxLineLength(), m_pScrollback.GetMaxLineLength());
+}
+
+/**
+ * @brief Returns the line number of the first scrollback line, after the opened file.
+ */
+uint64_t CIntelliPortDoc::GetFirstScrollbackLine() const
+{
+	return m_pMappedFile.IsOpen() ? m_pMappedFile.GetLineCount() : 0;
+}
+
+/**
+ * @brief Returns true if there is any text to show.
+ */
+bool CIntelliPortDoc::HasText() const
+{
+	return m_pMappedFile.IsOpen() || (m_pScrollback.GetLength() > 0);
+}
+
+/**
+ * @brief Maps a file and starts indexing its lines in the background.
  * 
- * Line ending normalization process:
- * - First: CRLF → LF (collapse existing Windows line endings)
- * - Then: CR → LF (convert Mac-style line endings)
- * - Finally: LF → CRLF (convert all to Windows standard)
+ * Detects the encoding from the Byte Order Mark, like the reading path of
+ * Serialize(), and falls back to UTF-8. The main frame is notified with
+ * MSG_FILE_INDEXED as more lines become reachable.
  * 
- * This ensures consistent display regardless of source line ending format
- * (Unix/Linux LF, Classic Mac CR, or Windows CRLF).
+ * @param pFile Open file; it can be closed afterwards.
+ * @return false if the file could not be mapped (empty, or too large for a 32-bit process).
+ */
+bool CIntelliPortDoc::OpenMappedFile(CFile* pFile)
+{
+	if ((pFile->m_hFile == CFile::hFileNull) || !m_pMappedFile.Open(pFile->m_hFile))
+	{
+		return false;
+	}
+
+	const BYTE* pData = m_pMappedFile.GetData();
+	const size_t nFileSize = m_pMappedFile.GetSize();
+	CMappedTextFile::TextEncoding nEncoding = CMappedTextFile::MAPPED_TEXT_UTF8;
+	size_t nSkip = 0;
+	// Statistical analysis of the first 64 KB is enough to recognize UTF-16 text
+	int nUniTest = IS_TEXT_UNICODE_STATISTICS;
+	const int nTestLength = static_cast<int>(std::min<size_t>(nFileSize, 0x10000) & ~size_t(1));
+	m_BOM = BOM::Unknown;
+	if ((nFileSize > 1) && ((nFileSize % 2) == 0) && (pData[0] == 0xFE) && (pData[1] == 0xFF))
+	{
+		m_BOM = BOM::UTF16BE;
+		nEncoding = CMappedTextFile::MAPPED_TEXT_UTF16BE;
+		nSkip = 2;
+	}
+	else if ((nFileSize > 1) && ((nFileSize % 2) == 0) && (pData[0] == 0xFF) && (pData[1] == 0xFE))
+	{
+		m_BOM = BOM::UTF16LE;
+		nEncoding = CMappedTextFile::MAPPED_TEXT_UTF16LE;
+		nSkip = 2;
+	}
+	else if ((nFileSize > 2) && (pData[0] == 0xEF) && (pData[1] == 0xBB) && (pData[2] == 0xBF))
+	{
+		m_BOM = BOM::UTF8;
+		nSkip = 3;
+	}
+	else if ((nFileSize > 1) && ((nFileSize % 2) == 0) && (pData[0] != 0) && (pData[1] == 0) && IsTextUnicode(pData, nTestLength, &nUniTest))
+	{
+		m_BOM = BOM::UTF16LE_NOBOM;
+		nEncoding = CMappedTextFile::MAPPED_TEXT_UTF16LE;
+	}
+
+	// The main window may not be registered yet when a file is opened from the command line
+	POSITION pos = GetFirstViewPosition();
+	CView* pView = (pos != nullptr) ? GetNextView(pos) : nullptr;
+	const HWND hFrameWnd = (pView != nullptr) ? pView->GetTopLevelFrame()->GetSafeHwnd() : AfxGetMainWnd()->GetSafeHwnd();
+	m_pMappedFile.StartIndexing(nEncoding, nSkip, [hFrameWnd]()
+	{
+		::PostMessage(hFrameWnd, MSG_FILE_INDEXED, 0, 0);
+	});
+	return true;
+}
+
+/**
+ * @brief Adds text to the terminal view with line ending normalization.
  * 
  * @param strText The text to add to the terminal display.
- * @return true if text was successfully added, false if view list is empty.
+ * @return true if text was successfully added.
  */
 bool CIntelliPortDoc::AddText(CString strText)
 {
-	// Check if view exists
-	if (!m_viewList.IsEmpty())
+	return AddText(strText.GetString(), strText.GetLength());
+}
+
+/**
+ * @brief Adds text to the terminal view with line ending normalization.
+ * 
+ * Performs the following operations:
+ * 1. Normalizes line endings to the configured style (CRLF by default) in one pass
+ * 2. Appends the text to the end of the scrollback
+ * 3. Lets the views scroll and repaint what became visible
+ * 
+ * This ensures consistent display regardless of source line ending format
+ * (Unix/Linux LF, Classic Mac CR, or Windows CRLF). A CRLF split between two
+ * calls is kept as a single line ending. Appending costs the same however much
+ * text the session already holds.
+ * 
+ * @param pText The text to add (need not be null-terminated).
+ * @param nLength Number of characters to add.
+ * @return true if text was successfully added.
+ */
+bool CIntelliPortDoc::AddText(LPCWSTR pText, int nLength)
+{
+	if (nLength <= 0)
 	{
-		// Get the first (and only in SDI) view
-		CEditView* pEditView = reinterpret_cast<CEditView*>(m_viewList.GetHead());
-		if (pEditView != nullptr)
-		{
-			// Normalize line endings to Windows standard (CRLF)
-			// Step 1: CRLF → LF (avoid double conversion)
-			strText.Replace(CRLF, LF);
-			// Step 2: CR → LF (Mac-style line endings)
-			strText.Replace(CR, LF);
-			// Step 3: LF → CRLF (all line endings now standardized)
-			strText.Replace(LF, CRLF);
-
-			// Append text to end of edit control
-			CEdit& pEdit = pEditView->GetEditCtrl();
-			// Get current text length to find insertion point
-			int outLength = pEdit.GetWindowTextLength();
-			// Move cursor/selection to end
-			pEdit.SetSel(outLength, outLength);
-			// Insert text at cursor (TRUE = can undo)
-			pEdit.ReplaceSel(strText, TRUE);
-			// Clear selection (SetSel(-1, 0) deselects all)
-			pEdit.SetSel(-1, 0);
-			return true;
-		}
+		return true;
 	}
-	return false;
+	// Normalize line endings into a buffer reused by every call
+	m_strDisplay.clear();
+	m_pLineEnding.Normalize(pText, nLength, m_strDisplay);
+	m_pScrollback.Append(m_strDisplay.data(), m_strDisplay.size());
+	UpdateAllViews(nullptr, HINT_TEXT_APPENDED);
+	return true;
 }
 
 /**
  * @brief Handles document serialization for loading and saving files.
  * 
  * Loading (ar.IsLoading()):
- * - Reads entire file into memory
+ * - Maps the file into memory and indexes its lines in the background
+ *   (see OpenMappedFile()); lines are converted only when shown
+ * - If the file cannot be mapped, reads entire file into memory
  * - Detects text encoding by examining Byte Order Mark (BOM):
  *   * UTF-16BE: 0xFE 0xFF
  *   * UTF-16LE: 0xFF 0xFE
@@ -307,9 +477,11 @@ bool CIntelliPortDoc::AddText(CString strText)
  * 
  * Saving (!ar.IsLoading()):
  * - Writes UTF-8 BOM (0xEF 0xBB 0xBF) at file start
- * - Gets current text from edit control
- * - Converts from Unicode to UTF-8
- * - Writes UTF-8 encoded content to file
+ * - Writes the opened file, converted to UTF-8 block by block
+ * - Writes the received text segment by segment from the scrollback pages
+ * - All output goes through one 4 MB buffer (CUtf8Writer), so saving needs
+ *   the same memory however large the session is
+ * - Shows the progress in the status bar
  * 
  * After load/save, updates status bar with success message.
  * 
@@ -317,9 +489,14 @@ bool CIntelliPortDoc::AddText(CString strText)
  */
 void CIntelliPortDoc::Serialize(CArchive& ar)
 {
-	if (ar.IsLoading())
+	if (ar.IsLoading() && OpenMappedFile(ar.GetFile()))
+	{
+		// ===== LOADING: Lines are read from the mapped file as they are shown =====
+	}
+	else if (ar.IsLoading())
 	{
-		// ===== LOADING: Read file and detect encoding =====
+		// ===== LOADING (file cannot be mapped): Read file and detect encoding =====
+		m_pLineEnding.Reset();
 #pragma warning(suppress: 26429)
 		CFile* pFile{ ar.GetFile() };
 		ASSERT(pFile != nullptr);
@@ -381,58 +558,30 @@ void CIntelliPortDoc::Serialize(CArchive& ar)
 					}
 				}
 
-				// ===== Convert detected encoding to UTF-8 =====
-				const char* pLoadData{ nullptr };
-				int nBytesToLoad{ 0 };
-				CStringA sUTF8Data;
+				// ===== Add the text in the detected encoding =====
+#pragma warning(suppress: 26481 26490)
+				LPWSTR pUTF16Data = reinterpret_cast<LPWSTR>(byBuffer.data() + nSkip);
+				const int nUTF16CharsRead = (nBytesRead - nSkip) / 2;
 
-				// Handle UTF-16 Little Endian (with or without BOM)
+				// Handle UTF-16 Little Endian (with or without BOM): already the native wide format
 				if ((m_BOM == BOM::UTF16LE_NOBOM) || (m_BOM == BOM::UTF16LE))
 				{
-					// Handle conversion from UTF-16LE to UTF-8
-#pragma warning(suppress: 26481 26490)
-					sUTF8Data = W2UTF8(reinterpret_cast<const wchar_t*>(byBuffer.data() + nSkip), (nBytesRead - nSkip) / 2);
-					pLoadData = sUTF8Data;
-					nBytesToLoad = sUTF8Data.GetLength();
-									}
-									// Handle UTF-16 Big Endian
-									else if (m_BOM == BOM::UTF16BE)
-									{
-										// UTF-16BE requires byte swapping to convert to Little Endian
-										// Windows APIs expect Little Endian UTF-16
-				#pragma warning(suppress: 26429 26481)
-										// Point to first character after BOM
-										BYTE* p = byBuffer.data() + nSkip;
-										// Calculate number of UTF-16 characters (2 bytes each)
-										const int nUTF16CharsRead = (nBytesRead - nSkip) / 2;
-										// Swap bytes for each character (Big Endian → Little Endian)
-										for (int i = 0; i < nUTF16CharsRead; i++)
-										{
-											// Temporary storage for byte swap
-											const BYTE t{ *p };
-				#pragma warning(suppress: 26481)
-											*p = p[1];      // Move low byte to high position
-				#pragma warning(suppress: 26481)
-											p[1] = t;       // Move high byte to low position
-				#pragma warning(suppress: 26481)
-											p += 2;         // Advance to next character
-										}
-#pragma warning(suppress: 26481 26490)
-					sUTF8Data = W2UTF8(reinterpret_cast<const wchar_t*>(byBuffer.data() + nSkip), (nBytesRead - nSkip) / 2);
-					pLoadData = sUTF8Data;
-					nBytesToLoad = sUTF8Data.GetLength();
+					AddText(pUTF16Data, nUTF16CharsRead);
+				}
+				// Handle UTF-16 Big Endian
+				else if (m_BOM == BOM::UTF16BE)
+				{
+					// Swap bytes in place (Big Endian → Little Endian), 8 characters per step
+					SwapUtf16Bytes(reinterpret_cast<const uint16_t*>(pUTF16Data), nUTF16CharsRead, reinterpret_cast<uint16_t*>(pUTF16Data));
+					AddText(pUTF16Data, nUTF16CharsRead);
 				}
 				else
 				{
-					// Assume UTF-8 or ASCII encoding - use data as-is
+					// Assume UTF-8 or ASCII encoding: convert to wide string and add to the terminal view
 #pragma warning(suppress: 26481 26490)
-					pLoadData = reinterpret_cast<const char*>(byBuffer.data()) + nSkip;
-					nBytesToLoad = nBytesRead - nSkip;
+					const std::wstring strText(utf8_to_wstring(reinterpret_cast<const char*>(byBuffer.data()) + nSkip, nBytesRead - nSkip));
+					AddText(strText.data(), static_cast<int>(strText.size()));
 				}
-				
-				ASSERT(pLoadData != nullptr);
-				// Convert UTF-8 to wide string and add to the terminal view
-				AddText(utf8_to_wstring(pLoadData).c_str());
 			}
 		} while (nBytesRead);
 	}
@@ -442,29 +591,100 @@ void CIntelliPortDoc::Serialize(CArchive& ar)
 #pragma warning(suppress: 26429)
 		CFile* pFile{ ar.GetFile() };
 		ASSERT(pFile != nullptr);
+		CUtf8Writer pWriter([pFile](const uint8_t* pData, size_t nLength)
+		{
+			pFile->Write(pData, static_cast<UINT>(nLength));
+		});
+
+		// Report the progress in the status bar whenever the percentage changes
+		CMainFrame* pMainFrame = (CMainFrame*) AfxGetMainWnd();
+		ASSERT_VALID(pMainFrame);
+		CString strProgressFormat, strProgress;
+		VERIFY(strProgressFormat.LoadString(IDS_SAVING_FILE));
+		const uint64_t nTotal = (m_pMappedFile.IsOpen() ? m_pMappedFile.GetTextSize() : 0) +
+			m_pScrollback.GetLength() * sizeof(wchar_t);
+		uint64_t nDone = 0;
+		int nPercent = -1;
+		auto pfnProgress = [&](uint64_t nBytes)
+		{
+			nDone += nBytes;
+			const int nNewPercent = (nTotal != 0) ? static_cast<int>(nDone * 100 / nTotal) : 100;
+			if (nNewPercent != nPercent)
+			{
+				nPercent = nNewPercent;
+				strProgress.Format(strProgressFormat, static_cast<LPCWSTR>(ar.m_strFileName), nPercent);
+				pMainFrame->SetStatusBarText(strProgress);
+			}
+		};
+		pfnProgress(0);
+
+		// Write UTF-8 BOM (0xEF 0xBB 0xBF) to mark file as UTF-8
+		// This helps text editors recognize the encoding
+		pWriter.WriteBytes("\xEF\xBB\xBF", 3);
+
+		// Write the opened file first, converted to UTF-8 one block at a time
+		if (m_pMappedFile.IsOpen())
+		{
+			const BYTE* pText = m_pMappedFile.GetText();
+			const size_t nTextSize = m_pMappedFile.GetTextSize();
+			const size_t nBlockSize = CUtf8Writer::UTF8_WRITER_BUFFER_SIZE;
+			if (m_pMappedFile.GetEncoding() == CMappedTextFile::MAPPED_TEXT_UTF8)
+			{
+				// Well-formed UTF-8 is copied as it is; otherwise invalid bytes become U+FFFD
+				const bool bValid = (ValidateUtf8(reinterpret_cast<const char*>(pText), nTextSize) == nTextSize);
+				CUtf8Decoder pDecoder;
+				std::wstring strDecoded;
+				for (size_t nOffset = 0; nOffset < nTextSize; nOffset += nBlockSize)
+				{
+					const size_t nCount = std::min(nBlockSize, nTextSize - nOffset);
+					if (bValid)
+					{
+						pWriter.WriteBytes(pText + nOffset, nCount);
+					}
+					else
+					{
+						strDecoded.clear();
+						pDecoder.Decode(reinterpret_cast<const char*>(pText + nOffset), nCount, strDecoded);
+						if (nOffset + nCount == nTextSize)
+						{
+							pDecoder.Flush(strDecoded);
+						}
+						pWriter.WriteUtf16(reinterpret_cast<const uint16_t*>(strDecoded.data()), strDecoded.size());
+					}
+					pfnProgress(nCount);
+				}
+			}
+			else
+			{
+				// The writer keeps surrogate pairs together across blocks
+				const bool bBigEndian = (m_pMappedFile.GetEncoding() == CMappedTextFile::MAPPED_TEXT_UTF16BE);
+				const uint16_t* pUnits = reinterpret_cast<const uint16_t*>(pText);
+				const size_t nUnits = nTextSize / 2;
+				for (size_t nIndex = 0; nIndex < nUnits; nIndex += nBlockSize)
+				{
+					const size_t nCount = std::min(nBlockSize, nUnits - nIndex);
+					pWriter.WriteUtf16(pUnits + nIndex, nCount, bBigEndian);
+					pfnProgress(nCount * 2);
+				}
+			}
+			// The received text starts on a line of its own, as in the view
+			if ((m_pScrollback.GetLength() > 0) && !m_pMappedFile.EndsWithLineBreak())
+			{
+				pWriter.WriteBytes("\r\n", 2);
+			}
+		}
 
-		ASSERT(!m_viewList.IsEmpty());
-		// Get the edit view to retrieve content
-		CEditView* pEditView = reinterpret_cast<CEditView*>(m_viewList.GetHead());
-		if (pEditView != nullptr)
+		// Convert the received text from Unicode (UTF-16) to UTF-8 one scrollback page at a time
+		uint64_t nOffset = 0;
+		const wchar_t* pSegment = nullptr;
+		for (size_t nSegment = m_pScrollback.GetSegment(0, pSegment); nSegment > 0;
+			nSegment = m_pScrollback.GetSegment(nOffset, pSegment))
 		{
-			// Write UTF-8 BOM (0xEF 0xBB 0xBF) to mark file as UTF-8
-			// This helps text editors recognize the encoding
-			pFile->Write("\xEF\xBB\xBF", 3);
-
-			// Get all text from the edit control
-			CStringW strBuffer;
-			pEditView->GetEditCtrl().GetWindowText(strBuffer);
-			const std::wstring strRawText(strBuffer);
-
-			// Convert from Unicode (UTF-16) to UTF-8
-			CStringA strOutput(wstring_to_utf8(strRawText).c_str());
-			UINT nLength = strOutput.GetLength();
-
-			// Write UTF-8 encoded bytes to file
-			pFile->Write(strOutput.GetBuffer(nLength), nLength);
-			strOutput.ReleaseBuffer();
+			pWriter.WriteUtf16(reinterpret_cast<const uint16_t*>(pSegment), nSegment);
+			nOffset += nSegment;
+			pfnProgress(nSegment * sizeof(wchar_t));
 		}
+		pWriter.Finish();
 	}
 
 	// ===== Update status bar with success message =====
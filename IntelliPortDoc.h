@@ -18,6 +18,9 @@ IntelliPort. If not, see <http://www.opensource.org/licenses/gpl-3.0.html>*/
 
 #pragma once
 
+#include "MappedTextFile.h"
+#include "ScrollbackBuffer.h"
+
 class CIntelliPortDoc : public CDocument
 {
 	//Enums
@@ -38,14 +41,32 @@ protected: // create from serialization only
 public:
 	CFont m_fontTerminal;
 	BOM m_BOM; //The BOM which applies to this view
+	CMappedTextFile m_pMappedFile; // opened file, shown before the scrollback
+	CScrollbackBuffer m_pScrollback; // text received since the document was created or opened
+	CLineEndingNormalizer<wchar_t> m_pLineEnding;
+	std::wstring m_strDisplay; // normalized text appended to the scrollback
+
+	// UpdateAllViews() hint: text was appended to the end of the scrollback
+	static constexpr LPARAM HINT_TEXT_APPENDED = 1;
+	// UpdateAllViews() hint: more lines of the opened file have been indexed
+	static constexpr LPARAM HINT_FILE_INDEXED = 2;
 
 // Operations
 public:
+	uint64_t GetLineCount() const;
+	uint64_t GetLine(uint64_t nLine, std::wstring& strLine, size_t nMaxLength = SIZE_MAX) const;
+	uint64_t GetMaxLineLength() const;
+	uint64_t GetFirstScrollbackLine() const;
+	bool HasText() const;
+	bool OpenMappedFile(CFile* pFile);
 
 // Overrides
 public:
 	virtual BOOL OnNewDocument();
+	virtual BOOL OnSaveDocument(LPCTSTR lpszPathName);
+	virtual void DeleteContents();
 	bool AddText(CString strText);
+	bool AddText(LPCWSTR pText, int nLength);
 	virtual void Serialize(CArchive& ar);
 #ifdef SHARED_HANDLERS
 	virtual void InitializeSearchContent();
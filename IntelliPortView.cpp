@@ -34,79 +34,622 @@ IntelliPort. If not, see <http://www.opensource.org/licenses/gpl-3.0.html>*/
  * @class CIntelliPortView
  * @brief View class for displaying terminal output in IntelliPort.
  * 
- * This class extends CEditView to provide a text display area for:
- * - Displaying received data from serial port or network socket
- * - Showing formatted text with proper line endings
- * - Providing context menu for text operations (copy, select all)
- * - Supporting printing and print preview functionality
- * - Word-wrapping text without horizontal scrolling
+ * This class draws the document's scrollback directly to provide:
+ * - Display of received data from serial port or network socket
+ * - Rendering of the visible lines only, so cost does not grow with session size
+ * - Automatic scrolling to new text while the last line is visible
+ * - Mouse selection with copy and select all (the output is read-only)
+ * - Printing and print preview of the whole scrollback
  * 
- * The view uses an edit control as the underlying text display mechanism,
- * allowing users to select and copy text but not edit it during active connections.
+ * Unlike an edit control, appending text never copies or re-lays out what is
+ * already shown, so the view stays responsive after millions of lines.
  */
 
 // Enable dynamic creation of this view class
-IMPLEMENT_DYNCREATE(CIntelliPortView, CEditView)
+IMPLEMENT_DYNCREATE(CIntelliPortView, CView)
 
 // Message map - connects Windows messages and commands to handler functions
-BEGIN_MESSAGE_MAP(CIntelliPortView, CEditView)
+BEGIN_MESSAGE_MAP(CIntelliPortView, CView)
 	// Standard printing commands
-	ON_COMMAND(ID_FILE_PRINT, &CEditView::OnFilePrint)
-	ON_COMMAND(ID_FILE_PRINT_DIRECT, &CEditView::OnFilePrint)
+	ON_COMMAND(ID_FILE_PRINT, &CView::OnFilePrint)
+	ON_COMMAND(ID_FILE_PRINT_DIRECT, &CView::OnFilePrint)
 	ON_COMMAND(ID_FILE_PRINT_PREVIEW, &CIntelliPortView::OnFilePrintPreview)
 	// Context menu handling
 	ON_WM_CONTEXTMENU()
 	ON_WM_RBUTTONUP()
+	// Scrolling and selection
+	ON_WM_ERASEBKGND()
+	ON_WM_SIZE()
+	ON_WM_VSCROLL()
+	ON_WM_HSCROLL()
+	ON_WM_MOUSEWHEEL()
+	ON_WM_LBUTTONDOWN()
+	ON_WM_LBUTTONUP()
+	ON_WM_MOUSEMOVE()
+	ON_WM_SETCURSOR()
+	ON_WM_KEYDOWN()
+	// Edit commands (the terminal output is read-only)
+	ON_COMMAND(ID_EDIT_COPY, &CIntelliPortView::OnEditCopy)
+	ON_UPDATE_COMMAND_UI(ID_EDIT_COPY, &CIntelliPortView::OnUpdateEditCopy)
+	ON_COMMAND(ID_EDIT_SELECT_ALL, &CIntelliPortView::OnEditSelectAll)
+	ON_UPDATE_COMMAND_UI(ID_EDIT_SELECT_ALL, &CIntelliPortView::OnUpdateEditSelectAll)
+	ON_UPDATE_COMMAND_UI(ID_EDIT_CUT, &CIntelliPortView::OnUpdateEditReadOnly)
+	ON_UPDATE_COMMAND_UI(ID_EDIT_PASTE, &CIntelliPortView::OnUpdateEditReadOnly)
 END_MESSAGE_MAP()
 
 /**
  * @brief Constructor for CIntelliPortView.
  * 
- * Initializes the view component for displaying terminal output.
- * The base class CEditView handles the creation and initialization
- * of the underlying edit control.
+ * Starts at the top of an empty scrollback, following new text.
+ * Font metrics are measured once the window exists.
  */
 CIntelliPortView::CIntelliPortView()
 {
-	// Constructor body is empty - initialization is handled by base class
+	m_nTopLine = 0;
+	m_nLeftColumn = 0;
+	m_bFollowTail = true;
+	m_nDiscardedLines = 0;
+	m_nCharWidth = 8;
+	m_nLineHeight = 16;
+	m_nVisibleLines = 1;
+	m_nVisibleColumns = 1;
+	m_posAnchor = { 0, 0 };
+	m_posCaret = { 0, 0 };
+	m_bSelecting = false;
+	m_nPrintLineHeight = 1;
+	m_nPrintLinesPerPage = 1;
 }
 
 /**
  * @brief Destructor for CIntelliPortView.
- * 
- * Cleans up any resources allocated by the view.
- * The base class CEditView handles cleanup of the edit control.
  */
 CIntelliPortView::~CIntelliPortView()
 {
-	// Destructor body is empty - cleanup is handled by base class
 }
 
 /**
  * @brief Called before the window is created to modify window styles.
  * 
- * Customizes the edit control behavior:
- * - Disables horizontal scrolling (ES_AUTOHSCROLL flag removed)
- * - Removes horizontal scroll bar (WS_HSCROLL style removed)
- * - Enables automatic word-wrapping to fit text within window width
- * 
- * This ensures all terminal output is visible without requiring
- * horizontal scrolling, making it easier to read long lines of text.
+ * Adds both scroll bars: the vertical one moves through the scrollback
+ * line by line and the horizontal one shows lines wider than the window.
  * 
  * @param cs Reference to CREATESTRUCT containing window creation parameters.
  * @return TRUE if the window should be created, FALSE to prevent creation.
  */
 BOOL CIntelliPortView::PreCreateWindow(CREATESTRUCT& cs)
 {
-	// Call base class to perform standard initialization
-	BOOL bPreCreated = CEditView::PreCreateWindow(cs);
+	cs.style |= WS_VSCROLL | WS_HSCROLL;
+	return CView::PreCreateWindow(cs);
+}
+
+/**
+ * @brief Measures the terminal font once the view is attached to its document.
+ */
+void CIntelliPortView::OnInitialUpdate()
+{
+	UpdateMetrics();
+	CView::OnInitialUpdate();
+}
+
+/**
+ * @brief Called by the document when its text changes.
+ * 
+ * HINT_TEXT_APPENDED only extends the scroll range and, while the last line
+ * is visible, scrolls to the new end; lines dropped by the scrollback caps
+ * shift the top line and the selection so they stay on the same text.
+ * HINT_FILE_INDEXED only extends the scroll range over more lines of the
+ * opened file. Any other hint means the text was replaced, so the view returns
+ * to the top and drops its selection.
+ */
+void CIntelliPortView::OnUpdate(CView* /* pSender */, LPARAM lHint, CObject* /* pHint */)
+{
+	const CIntelliPortDoc* pDocument = GetDocument();
+	const uint64_t nDiscardedLines = pDocument->m_pScrollback.GetDiscardedLines();
+	if (lHint == CIntelliPortDoc::HINT_FILE_INDEXED)
+	{
+		// More lines of the opened file can be reached: only the scroll range changes
+		UpdateScrollBars();
+		Invalidate(FALSE);
+		return;
+	}
+	if (lHint != CIntelliPortDoc::HINT_TEXT_APPENDED)
+	{
+		m_nTopLine = 0;
+		m_nLeftColumn = 0;
+		m_bFollowTail = !pDocument->m_pMappedFile.IsOpen(); // an opened file is shown from its start
+		m_posAnchor = m_posCaret = { 0, 0 };
+	}
+	else if (nDiscardedLines != m_nDiscardedLines)
+	{
+		// Line numbers of the scrollback moved down as its oldest text was dropped: keep the same text in view
+		const uint64_t nFirst = pDocument->GetFirstScrollbackLine();
+		const uint64_t nShift = nDiscardedLines - m_nDiscardedLines;
+		for (CTextPosition* pPosition : { &m_posAnchor, &m_posCaret })
+		{
+			if (pPosition->nLine >= nFirst)
+			{
+				*pPosition = (pPosition->nLine - nFirst >= nShift) ? CTextPosition{ pPosition->nLine - nShift, pPosition->nColumn } : CTextPosition{ nFirst, 0 };
+			}
+		}
+		if (m_nTopLine >= nFirst)
+		{
+			m_nTopLine = (m_nTopLine - nFirst >= nShift) ? m_nTopLine - nShift : nFirst;
+		}
+	}
+	m_nDiscardedLines = nDiscardedLines;
+	if (m_bFollowTail)
+	{
+		m_nTopLine = GetLastTopLine();
+	}
+	UpdateScrollBars();
+	Invalidate(FALSE);
+}
+
+/**
+ * @brief Draws the visible lines of the scrollback.
+ * 
+ * Paints into an off-screen bitmap first, so scrolling and fast output do not flicker.
+ * 
+ * @param pDC Pointer to the device context of the view.
+ */
+void CIntelliPortView::OnDraw(CDC* pDC)
+{
+	CRect rectClient;
+	GetClientRect(&rectClient);
+
+	CDC dcMemory;
+	CBitmap pBitmap;
+	VERIFY(dcMemory.CreateCompatibleDC(pDC));
+	VERIFY(pBitmap.CreateCompatibleBitmap(pDC, rectClient.Width(), rectClient.Height()));
+	CBitmap* pOldBitmap = dcMemory.SelectObject(&pBitmap);
+	CFont* pOldFont = dcMemory.SelectObject(&GetDocument()->m_fontTerminal);
+
+	dcMemory.FillSolidRect(&rectClient, GetSysColor(COLOR_WINDOW));
+	// Include the partly visible line at the bottom
+	DrawLines(&dcMemory, rectClient, m_nTopLine, m_nVisibleLines + 1, m_nLeftColumn, m_nCharWidth, m_nLineHeight);
+	pDC->BitBlt(0, 0, rectClient.Width(), rectClient.Height(), &dcMemory, 0, 0, SRCCOPY);
+
+	dcMemory.SelectObject(pOldFont);
+	dcMemory.SelectObject(pOldBitmap);
+}
+
+/**
+ * @brief Draws a run of lines with the selection highlighted.
+ * 
+ * @param pDC Device context with the terminal font selected.
+ * @param rectClip Area to draw into; the first line starts at its top left corner.
+ * @param nFirstLine Scrollback line drawn first.
+ * @param nLineCount Number of lines to draw.
+ * @param nLeftColumn First column drawn on each line.
+ * @param nCharWidth Width of a character cell.
+ * @param nLineHeight Height of a line.
+ */
+void CIntelliPortView::DrawLines(CDC* pDC, const CRect& rectClip, uint64_t nFirstLine, int nLineCount, uint64_t nLeftColumn, int nCharWidth, int nLineHeight)
+{
+	const CIntelliPortDoc* pDocument = GetDocument();
+	const size_t nColumnCount = static_cast<size_t>(rectClip.Width() / nCharWidth) + 1;
+	CTextPosition posStart, posEnd;
+	const bool bSelection = !pDC->IsPrinting() && GetSelection(posStart, posEnd);
+
+	pDC->SetBkMode(TRANSPARENT);
+	for (int nIndex = 0; nIndex < nLineCount; nIndex++)
+	{
+		const uint64_t nLine = nFirstLine + nIndex;
+		if (nLine >= pDocument->GetLineCount())
+		{
+			break;
+		}
+		const int y = rectClip.top + nIndex * nLineHeight;
+		// Fetch only the part of the line that can be seen
+		const uint64_t nLineLength = pDocument->GetLine(nLine, m_strLine, static_cast<size_t>(nLeftColumn) + nColumnCount);
+		if (m_strLine.size() > nLeftColumn)
+		{
+			pDC->SetTextColor(GetSysColor(COLOR_WINDOWTEXT));
+			pDC->TextOut(rectClip.left, y, m_strLine.data() + nLeftColumn, static_cast<int>(m_strLine.size() - nLeftColumn));
+		}
+
+		if (bSelection && (nLine >= posStart.nLine) && (nLine <= posEnd.nLine))
+		{
+			// A selected line ending is shown as one highlighted cell
+			uint64_t nFrom = (nLine == posStart.nLine) ? posStart.nColumn : 0;
+			uint64_t nTo = (nLine == posEnd.nLine) ? posEnd.nColumn : nLineLength + 1;
+			nFrom = std::max(nFrom, nLeftColumn);
+			nTo = std::min<uint64_t>(nTo, nLeftColumn + nColumnCount);
+			if (nFrom < nTo)
+			{
+				CRect rectSelection(rectClip.left + static_cast<int>(nFrom - nLeftColumn) * nCharWidth, y,
+					rectClip.left + static_cast<int>(nTo - nLeftColumn) * nCharWidth, y + nLineHeight);
+				const uint64_t nTextEnd = std::min<uint64_t>(nTo, m_strLine.size());
+				const int nTextLength = (nTextEnd > nFrom) ? static_cast<int>(nTextEnd - nFrom) : 0;
+				pDC->SetBkColor(GetSysColor(COLOR_HIGHLIGHT));
+				pDC->SetTextColor(GetSysColor(COLOR_HIGHLIGHTTEXT));
+				pDC->ExtTextOut(rectSelection.left, y, ETO_OPAQUE | ETO_CLIPPED, &rectSelection,
+					m_strLine.data() + nFrom, nTextLength, nullptr);
+			}
+		}
+	}
+}
+
+/**
+ * @brief Measures the terminal font and the number of lines and columns that fit.
+ */
+void CIntelliPortView::UpdateMetrics()
+{
+	if (m_pDocument == nullptr)
+	{
+		return;
+	}
+	CClientDC dc(this);
+	CFont* pOldFont = dc.SelectObject(&GetDocument()->m_fontTerminal);
+	TEXTMETRIC tm = { 0, };
+	dc.GetTextMetrics(&tm);
+	dc.SelectObject(pOldFont);
+	m_nCharWidth = std::max<int>(1, tm.tmAveCharWidth);
+	m_nLineHeight = std::max<int>(1, tm.tmHeight + tm.tmExternalLeading);
+
+	CRect rectClient;
+	GetClientRect(&rectClient);
+	m_nVisibleLines = std::max(1, rectClient.Height() / m_nLineHeight);
+	m_nVisibleColumns = std::max(1, rectClient.Width() / m_nCharWidth);
+}
+
+/**
+ * @brief Returns the top line that shows the end of the scrollback.
+ */
+uint64_t CIntelliPortView::GetLastTopLine() const
+{
+	const uint64_t nLineCount = GetDocument()->GetLineCount();
+	return (nLineCount > static_cast<uint64_t>(m_nVisibleLines)) ? nLineCount - m_nVisibleLines : 0;
+}
+
+/**
+ * @brief Sets the range, page and position of both scroll bars.
+ * 
+ * Scroll bar units are lines and columns, so the range stays within an int
+ * even for a scrollback of hundreds of millions of lines.
+ */
+void CIntelliPortView::UpdateScrollBars()
+{
+	const CIntelliPortDoc* pDocument = GetDocument();
+
+	SCROLLINFO si = { sizeof(SCROLLINFO), SIF_RANGE | SIF_PAGE | SIF_POS, 0, };
+	si.nMax = static_cast<int>(std::min<uint64_t>(pDocument->GetLineCount() - 1, INT_MAX));
+	si.nPage = static_cast<UINT>(m_nVisibleLines);
+	si.nPos = static_cast<int>(std::min<uint64_t>(m_nTopLine, INT_MAX));
+	SetScrollInfo(SB_VERT, &si, TRUE);
 
-	// Remove horizontal scroll styles to enable word-wrapping
-	// ES_AUTOHSCROLL = automatically scroll horizontally when typing
-	// WS_HSCROLL = horizontal scroll bar
-	cs.style &= ~(ES_AUTOHSCROLL|WS_HSCROLL);
+	si.nMax = static_cast<int>(std::min<uint64_t>(pDocument->GetMaxLineLength(), INT_MAX));
+	si.nPage = static_cast<UINT>(m_nVisibleColumns);
+	si.nPos = static_cast<int>(std::min<uint64_t>(m_nLeftColumn, INT_MAX));
+	SetScrollInfo(SB_HORZ, &si, TRUE);
+}
+
+/**
+ * @brief Scrolls vertically; reaching the end resumes following new text.
+ * @param nTopLine Line to show at the top, clamped to the scrollback.
+ */
+void CIntelliPortView::ScrollToLine(int64_t nTopLine)
+{
+	const uint64_t nLastTopLine = GetLastTopLine();
+	const uint64_t nLine = (nTopLine < 0) ? 0 : std::min<uint64_t>(nTopLine, nLastTopLine);
+	m_bFollowTail = (nLine == nLastTopLine);
+	if (nLine != m_nTopLine)
+	{
+		m_nTopLine = nLine;
+		SetScrollPos(SB_VERT, static_cast<int>(std::min<uint64_t>(m_nTopLine, INT_MAX)), TRUE);
+		Invalidate(FALSE);
+	}
+}
 
-	return bPreCreated;
+/**
+ * @brief Scrolls horizontally.
+ * @param nLeftColumn Column to show at the left, clamped to the longest line.
+ */
+void CIntelliPortView::ScrollToColumn(int64_t nLeftColumn)
+{
+	const uint64_t nMaxLineLength = GetDocument()->GetMaxLineLength();
+	const uint64_t nLastColumn = (nMaxLineLength > static_cast<uint64_t>(m_nVisibleColumns)) ? nMaxLineLength - m_nVisibleColumns + 1 : 0;
+	const uint64_t nColumn = (nLeftColumn < 0) ? 0 : std::min<uint64_t>(nLeftColumn, nLastColumn);
+	if (nColumn != m_nLeftColumn)
+	{
+		m_nLeftColumn = nColumn;
+		SetScrollPos(SB_HORZ, static_cast<int>(std::min<uint64_t>(m_nLeftColumn, INT_MAX)), TRUE);
+		Invalidate(FALSE);
+	}
+}
+
+/**
+ * @brief Converts a point in client coordinates to the nearest character position.
+ */
+CIntelliPortView::CTextPosition CIntelliPortView::HitTest(CPoint point) const
+{
+	const CIntelliPortDoc* pDocument = GetDocument();
+	CTextPosition pos = { 0, 0 };
+	const int64_t nLine = static_cast<int64_t>(m_nTopLine) + ((point.y < 0) ? -1 : point.y / m_nLineHeight);
+	pos.nLine = (nLine < 0) ? 0 : std::min<uint64_t>(nLine, pDocument->GetLineCount() - 1);
+	const int64_t nColumn = static_cast<int64_t>(m_nLeftColumn) + ((point.x < 0) ? 0 : (point.x + m_nCharWidth / 2) / m_nCharWidth);
+	std::wstring strEmpty;
+	pos.nColumn = std::min<uint64_t>(nColumn, pDocument->GetLine(pos.nLine, strEmpty, 0));
+	return pos;
+}
+
+/**
+ * @brief Returns the selection with its start before its end.
+ * @return true if some text is selected.
+ */
+bool CIntelliPortView::GetSelection(CTextPosition& posStart, CTextPosition& posEnd) const
+{
+	const bool bForward = (m_posAnchor.nLine < m_posCaret.nLine) ||
+		((m_posAnchor.nLine == m_posCaret.nLine) && (m_posAnchor.nColumn <= m_posCaret.nColumn));
+	posStart = bForward ? m_posAnchor : m_posCaret;
+	posEnd = bForward ? m_posCaret : m_posAnchor;
+	return (posStart.nLine != posEnd.nLine) || (posStart.nColumn != posEnd.nColumn);
+}
+
+/**
+ * @brief Suppresses background erasing; OnDraw paints every pixel.
+ */
+BOOL CIntelliPortView::OnEraseBkgnd(CDC* /* pDC */)
+{
+	return TRUE;
+}
+
+/**
+ * @brief Recomputes the visible lines and columns when the view is resized.
+ */
+void CIntelliPortView::OnSize(UINT nType, int cx, int cy)
+{
+	CView::OnSize(nType, cx, cy);
+	if (m_pDocument == nullptr)
+	{
+		return;
+	}
+	UpdateMetrics();
+	m_nTopLine = m_bFollowTail ? GetLastTopLine() : std::min(m_nTopLine, GetLastTopLine());
+	UpdateScrollBars();
+	Invalidate(FALSE);
+}
+
+/**
+ * @brief Handles the vertical scroll bar.
+ */
+void CIntelliPortView::OnVScroll(UINT nSBCode, UINT /* nPos */, CScrollBar* /* pScrollBar */)
+{
+	const int64_t nTopLine = static_cast<int64_t>(m_nTopLine);
+	SCROLLINFO si = { sizeof(SCROLLINFO), SIF_TRACKPOS, 0, };
+	switch (nSBCode)
+	{
+		case SB_LINEUP: ScrollToLine(nTopLine - 1); break;
+		case SB_LINEDOWN: ScrollToLine(nTopLine + 1); break;
+		case SB_PAGEUP: ScrollToLine(nTopLine - m_nVisibleLines); break;
+		case SB_PAGEDOWN: ScrollToLine(nTopLine + m_nVisibleLines); break;
+		case SB_TOP: ScrollToLine(0); break;
+		case SB_BOTTOM: ScrollToLine(INT64_MAX); break;
+		case SB_THUMBTRACK:
+		case SB_THUMBPOSITION:
+			// The 32-bit track position, not the 16-bit nPos parameter
+			GetScrollInfo(SB_VERT, &si, SIF_TRACKPOS);
+			ScrollToLine(si.nTrackPos);
+			break;
+	}
+}
+
+/**
+ * @brief Handles the horizontal scroll bar.
+ */
+void CIntelliPortView::OnHScroll(UINT nSBCode, UINT /* nPos */, CScrollBar* /* pScrollBar */)
+{
+	const int64_t nLeftColumn = static_cast<int64_t>(m_nLeftColumn);
+	SCROLLINFO si = { sizeof(SCROLLINFO), SIF_TRACKPOS, 0, };
+	switch (nSBCode)
+	{
+		case SB_LINELEFT: ScrollToColumn(nLeftColumn - 1); break;
+		case SB_LINERIGHT: ScrollToColumn(nLeftColumn + 1); break;
+		case SB_PAGELEFT: ScrollToColumn(nLeftColumn - m_nVisibleColumns); break;
+		case SB_PAGERIGHT: ScrollToColumn(nLeftColumn + m_nVisibleColumns); break;
+		case SB_LEFT: ScrollToColumn(0); break;
+		case SB_RIGHT: ScrollToColumn(INT64_MAX); break;
+		case SB_THUMBTRACK:
+		case SB_THUMBPOSITION:
+			GetScrollInfo(SB_HORZ, &si, SIF_TRACKPOS);
+			ScrollToColumn(si.nTrackPos);
+			break;
+	}
+}
+
+/**
+ * @brief Scrolls by the user's wheel setting (3 lines per notch by default).
+ */
+BOOL CIntelliPortView::OnMouseWheel(UINT /* nFlags */, short zDelta, CPoint /* pt */)
+{
+	UINT nWheelLines = 3;
+	SystemParametersInfo(SPI_GETWHEELSCROLLLINES, 0, &nWheelLines, 0);
+	const int64_t nLines = (nWheelLines == WHEEL_PAGESCROLL) ? m_nVisibleLines : nWheelLines;
+	ScrollToLine(static_cast<int64_t>(m_nTopLine) - (zDelta / WHEEL_DELTA) * nLines);
+	return TRUE;
+}
+
+/**
+ * @brief Starts a selection; with Shift held the current selection is extended.
+ */
+void CIntelliPortView::OnLButtonDown(UINT nFlags, CPoint point)
+{
+	SetFocus();
+	SetCapture();
+	m_posCaret = HitTest(point);
+	if ((nFlags & MK_SHIFT) == 0)
+	{
+		m_posAnchor = m_posCaret;
+	}
+	m_bSelecting = true;
+	Invalidate(FALSE);
+}
+
+/**
+ * @brief Ends a mouse selection.
+ */
+void CIntelliPortView::OnLButtonUp(UINT /* nFlags */, CPoint /* point */)
+{
+	if (m_bSelecting)
+	{
+		m_bSelecting = false;
+		ReleaseCapture();
+	}
+}
+
+/**
+ * @brief Extends a mouse selection, scrolling when the mouse leaves the window.
+ */
+void CIntelliPortView::OnMouseMove(UINT /* nFlags */, CPoint point)
+{
+	if (!m_bSelecting)
+	{
+		return;
+	}
+	CRect rectClient;
+	GetClientRect(&rectClient);
+	if (point.y < 0)
+	{
+		ScrollToLine(static_cast<int64_t>(m_nTopLine) - 1);
+	}
+	else if (point.y >= rectClient.bottom)
+	{
+		ScrollToLine(static_cast<int64_t>(m_nTopLine) + 1);
+	}
+	m_posCaret = HitTest(point);
+	Invalidate(FALSE);
+}
+
+/**
+ * @brief Shows the text cursor over the terminal output.
+ */
+BOOL CIntelliPortView::OnSetCursor(CWnd* pWnd, UINT nHitTest, UINT message)
+{
+	if (nHitTest == HTCLIENT)
+	{
+		SetCursor(AfxGetApp()->LoadStandardCursor(IDC_IBEAM));
+		return TRUE;
+	}
+	return CView::OnSetCursor(pWnd, nHitTest, message);
+}
+
+/**
+ * @brief Scrolls with the arrow, page, Home and End keys.
+ */
+void CIntelliPortView::OnKeyDown(UINT nChar, UINT nRepCnt, UINT nFlags)
+{
+	const bool bControl = (GetKeyState(VK_CONTROL) < 0);
+	const int64_t nTopLine = static_cast<int64_t>(m_nTopLine);
+	const int64_t nLeftColumn = static_cast<int64_t>(m_nLeftColumn);
+	switch (nChar)
+	{
+		case VK_UP: ScrollToLine(nTopLine - 1); break;
+		case VK_DOWN: ScrollToLine(nTopLine + 1); break;
+		case VK_PRIOR: ScrollToLine(nTopLine - m_nVisibleLines); break;
+		case VK_NEXT: ScrollToLine(nTopLine + m_nVisibleLines); break;
+		case VK_LEFT: ScrollToColumn(nLeftColumn - 1); break;
+		case VK_RIGHT: ScrollToColumn(nLeftColumn + 1); break;
+		case VK_HOME: bControl ? ScrollToLine(0) : ScrollToColumn(0); break;
+		case VK_END: bControl ? ScrollToLine(INT64_MAX) : ScrollToColumn(INT64_MAX); break;
+		default: CView::OnKeyDown(nChar, nRepCnt, nFlags); break;
+	}
+}
+
+/**
+ * @brief Copies the selected text to the clipboard with CRLF line endings.
+ */
+void CIntelliPortView::OnEditCopy()
+{
+	CTextPosition posStart, posEnd;
+	if (!GetSelection(posStart, posEnd))
+	{
+		return;
+	}
+	// Gather the selected part of every line; the opened file and the scrollback number lines alike
+	const CIntelliPortDoc* pDocument = GetDocument();
+	std::wstring strSelection, strLine;
+	for (uint64_t nLine = posStart.nLine; nLine <= posEnd.nLine; nLine++)
+	{
+		pDocument->GetLine(nLine, strLine);
+		const size_t nFrom = (nLine == posStart.nLine) ? static_cast<size_t>(std::min<uint64_t>(posStart.nColumn, strLine.size())) : 0;
+		const size_t nTo = (nLine == posEnd.nLine) ? static_cast<size_t>(std::min<uint64_t>(posEnd.nColumn, strLine.size())) : strLine.size();
+		if (nTo > nFrom)
+		{
+			strSelection.append(strLine, nFrom, nTo - nFrom);
+		}
+		if (nLine != posEnd.nLine)
+		{
+			strSelection.push_back(L'\n');
+		}
+	}
+
+	// Lines may still hold lone CRs in raw mode; the clipboard expects CRLF
+	CLineEndingNormalizer<wchar_t> pLineEnding;
+	std::wstring strText;
+	pLineEnding.Normalize(strSelection.data(), strSelection.size(), strText);
+
+	if (!OpenClipboard())
+	{
+		return;
+	}
+	EmptyClipboard();
+	HGLOBAL hMemory = GlobalAlloc(GMEM_MOVEABLE, (strText.size() + 1) * sizeof(wchar_t));
+	if (hMemory != nullptr)
+	{
+		wchar_t* pMemory = static_cast<wchar_t*>(GlobalLock(hMemory));
+		if (pMemory != nullptr)
+		{
+			memcpy(pMemory, strText.c_str(), (strText.size() + 1) * sizeof(wchar_t));
+			GlobalUnlock(hMemory);
+			if (SetClipboardData(CF_UNICODETEXT, hMemory) == nullptr)
+			{
+				GlobalFree(hMemory);
+			}
+		}
+		else
+		{
+			GlobalFree(hMemory);
+		}
+	}
+	CloseClipboard();
+}
+
+/**
+ * @brief Enables Copy while some text is selected.
+ */
+void CIntelliPortView::OnUpdateEditCopy(CCmdUI* pCmdUI)
+{
+	CTextPosition posStart, posEnd;
+	pCmdUI->Enable(GetSelection(posStart, posEnd));
+}
+
+/**
+ * @brief Selects the whole scrollback.
+ */
+void CIntelliPortView::OnEditSelectAll()
+{
+	const CIntelliPortDoc* pDocument = GetDocument();
+	const uint64_t nLastLine = pDocument->GetLineCount() - 1;
+	std::wstring strEmpty;
+	m_posAnchor = { 0, 0 };
+	m_posCaret = { nLastLine, pDocument->GetLine(nLastLine, strEmpty, 0) };
+	Invalidate(FALSE);
+}
+
+/**
+ * @brief Enables Select All while there is text.
+ */
+void CIntelliPortView::OnUpdateEditSelectAll(CCmdUI* pCmdUI)
+{
+	pCmdUI->Enable(GetDocument()->HasText());
+}
+
+/**
+ * @brief Disables Cut and Paste: the terminal output cannot be edited.
+ */
+void CIntelliPortView::OnUpdateEditReadOnly(CCmdUI* pCmdUI)
+{
+	pCmdUI->Enable(FALSE);
 }
 
 /**
@@ -140,42 +683,69 @@ void CIntelliPortView::OnFilePrintPreview()
  */
 BOOL CIntelliPortView::OnPreparePrinting(CPrintInfo* pInfo)
 {
-	// Use default CEditView preparation (shows print dialog)
-	return CEditView::OnPreparePrinting(pInfo);
+	// Show the print dialog
+	return DoPreparePrinting(pInfo);
 }
 
 /**
  * @brief Called by the framework when printing begins.
  * 
- * Performs initialization tasks required before the first page is printed:
- * - Allocates GDI resources for printing
- * - Calculates page layout and line spacing
- * - Prepares text formatting for the printer device context
+ * Scales the terminal font to the printer resolution and works out how many
+ * lines fit on a page, which gives the number of pages to print.
  * 
  * @param pDC Pointer to the printer device context.
  * @param pInfo Pointer to CPrintInfo structure containing print job information.
  */
 void CIntelliPortView::OnBeginPrinting(CDC* pDC, CPrintInfo* pInfo)
 {
-	// Delegate to base class for standard initialization
-	CEditView::OnBeginPrinting(pDC, pInfo);
+	LOGFONT lf = { 0, };
+	GetDocument()->m_fontTerminal.GetLogFont(&lf);
+	lf.lfHeight = -MulDiv(10, pDC->GetDeviceCaps(LOGPIXELSY), 72);
+	VERIFY(m_fontPrinter.CreateFontIndirect(&lf));
+
+	CFont* pOldFont = pDC->SelectObject(&m_fontPrinter);
+	TEXTMETRIC tm = { 0, };
+	pDC->GetTextMetrics(&tm);
+	pDC->SelectObject(pOldFont);
+	m_nPrintLineHeight = std::max<int>(1, tm.tmHeight + tm.tmExternalLeading);
+
+	// Half an inch margin at the top and at the bottom of every page
+	const int nPageHeight = pDC->GetDeviceCaps(VERTRES) - pDC->GetDeviceCaps(LOGPIXELSY);
+	m_nPrintLinesPerPage = std::max(1, nPageHeight / m_nPrintLineHeight);
+	const uint64_t nLineCount = GetDocument()->GetLineCount();
+	pInfo->SetMaxPage(static_cast<UINT>(std::max<uint64_t>(1, (nLineCount + m_nPrintLinesPerPage - 1) / m_nPrintLinesPerPage)));
+}
+
+/**
+ * @brief Prints one page of the scrollback.
+ * 
+ * @param pDC Pointer to the printer device context.
+ * @param pInfo Pointer to CPrintInfo structure with the page to print.
+ */
+void CIntelliPortView::OnPrint(CDC* pDC, CPrintInfo* pInfo)
+{
+	CFont* pOldFont = pDC->SelectObject(&m_fontPrinter);
+	TEXTMETRIC tm = { 0, };
+	pDC->GetTextMetrics(&tm);
+
+	CRect rectPage(pInfo->m_rectDraw);
+	rectPage.DeflateRect(pDC->GetDeviceCaps(LOGPIXELSX) / 2, pDC->GetDeviceCaps(LOGPIXELSY) / 2);
+	const uint64_t nFirstLine = static_cast<uint64_t>(pInfo->m_nCurPage - 1) * m_nPrintLinesPerPage;
+	DrawLines(pDC, rectPage, nFirstLine, m_nPrintLinesPerPage, 0, std::max<int>(1, tm.tmAveCharWidth), m_nPrintLineHeight);
+	pDC->SelectObject(pOldFont);
 }
 
 /**
  * @brief Called by the framework when printing ends.
  * 
- * Performs cleanup tasks after the last page is printed:
- * - Releases GDI resources allocated during printing
- * - Cleans up temporary print-related data structures
- * - Restores view state after printing completes
+ * Releases the printer font created by OnBeginPrinting.
  * 
  * @param pDC Pointer to the printer device context.
  * @param pInfo Pointer to CPrintInfo structure containing print job information.
  */
-void CIntelliPortView::OnEndPrinting(CDC* pDC, CPrintInfo* pInfo)
+void CIntelliPortView::OnEndPrinting(CDC* /* pDC */, CPrintInfo* /* pInfo */)
 {
-	// Delegate to base class for standard cleanup
-	CEditView::OnEndPrinting(pDC, pInfo);
+	m_fontPrinter.DeleteObject();
 }
 
 /**
@@ -202,7 +772,7 @@ void CIntelliPortView::OnRButtonUp(UINT /* nFlags */, CPoint point)
  * Shows the edit popup menu (IDR_POPUP_EDIT) with standard editing commands:
  * - Copy: Copy selected text to clipboard
  * - Select All: Select all text in the view
- * - Other standard edit operations
+ * - Cut and Paste are shown disabled (the output is read-only)
  * 
  * The menu is positioned at the provided screen coordinates and is
  * right-aligned for proper display near screen edges.
@@ -236,7 +806,7 @@ void CIntelliPortView::OnContextMenu(CWnd* /* pWnd */, CPoint point)
 void CIntelliPortView::AssertValid() const
 {
 	// Validate base class state first
-	CEditView::AssertValid();
+	CView::AssertValid();
 }
 
 /**
@@ -251,7 +821,7 @@ void CIntelliPortView::AssertValid() const
 void CIntelliPortView::Dump(CDumpContext& dc) const
 {
 	// Dump base class information first
-	CEditView::Dump(dc);
+	CView::Dump(dc);
 }
 
 /**
@@ -18,7 +18,7 @@ IntelliPort. If not, see <http://www.opensource.org/licenses/gpl-3.0.html>*/
 
 #pragma once
 
-class CIntelliPortView : public CEditView
+class CIntelliPortView : public CView
 {
 protected: // create from serialization only
 	CIntelliPortView();
@@ -33,11 +33,15 @@ public:
 
 // Overrides
 public:
+	virtual void OnDraw(CDC* pDC);
 	virtual BOOL PreCreateWindow(CREATESTRUCT& cs);
+	virtual void OnInitialUpdate();
 protected:
+	virtual void OnUpdate(CView* pSender, LPARAM lHint, CObject* pHint);
 	virtual BOOL OnPreparePrinting(CPrintInfo* pInfo);
 	virtual void OnBeginPrinting(CDC* pDC, CPrintInfo* pInfo);
 	virtual void OnEndPrinting(CDC* pDC, CPrintInfo* pInfo);
+	virtual void OnPrint(CDC* pDC, CPrintInfo* pInfo);
 
 // Implementation
 public:
@@ -48,12 +52,60 @@ public:
 #endif
 
 protected:
+	/**
+	 * @brief A character position in the scrollback: line and column.
+	 */
+	struct CTextPosition
+	{
+		uint64_t nLine;
+		uint64_t nColumn;
+	};
+
+	void UpdateMetrics();
+	void UpdateScrollBars();
+	void ScrollToLine(int64_t nTopLine);
+	void ScrollToColumn(int64_t nLeftColumn);
+	uint64_t GetLastTopLine() const;
+	CTextPosition HitTest(CPoint point) const;
+	bool GetSelection(CTextPosition& posStart, CTextPosition& posEnd) const;
+	void DrawLines(CDC* pDC, const CRect& rectClip, uint64_t nFirstLine, int nLineCount, uint64_t nLeftColumn, int nCharWidth, int nLineHeight);
+
+	uint64_t m_nTopLine;       // first line shown at the top of the window
+	uint64_t m_nLeftColumn;    // first column shown at the left of the window
+	bool m_bFollowTail;        // keep the last line visible as text arrives
+	uint64_t m_nDiscardedLines; // lines dropped from the scrollback when last updated
+	int m_nCharWidth;          // cell size of the terminal font, in pixels
+	int m_nLineHeight;
+	int m_nVisibleLines;       // whole lines that fit in the client area
+	int m_nVisibleColumns;
+	CTextPosition m_posAnchor; // where the selection started
+	CTextPosition m_posCaret;  // where the selection ends
+	bool m_bSelecting;
+	std::wstring m_strLine;    // reused for every line drawn
+	CFont m_fontPrinter;       // terminal font scaled for the printer
+	int m_nPrintLineHeight;
+	int m_nPrintLinesPerPage;
 
 // Generated message map functions
 protected:
 	afx_msg void OnFilePrintPreview();
 	afx_msg void OnRButtonUp(UINT nFlags, CPoint point);
 	afx_msg void OnContextMenu(CWnd* pWnd, CPoint point);
+	afx_msg BOOL OnEraseBkgnd(CDC* pDC);
+	afx_msg void OnSize(UINT nType, int cx, int cy);
+	afx_msg void OnVScroll(UINT nSBCode, UINT nPos, CScrollBar* pScrollBar);
+	afx_msg void OnHScroll(UINT nSBCode, UINT nPos, CScrollBar* pScrollBar);
+	afx_msg BOOL OnMouseWheel(UINT nFlags, short zDelta, CPoint pt);
+	afx_msg void OnLButtonDown(UINT nFlags, CPoint point);
+	afx_msg void OnLButtonUp(UINT nFlags, CPoint point);
+	afx_msg void OnMouseMove(UINT nFlags, CPoint point);
+	afx_msg BOOL OnSetCursor(CWnd* pWnd, UINT nHitTest, UINT message);
+	afx_msg void OnKeyDown(UINT nChar, UINT nRepCnt, UINT nFlags);
+	afx_msg void OnEditCopy();
+	afx_msg void OnUpdateEditCopy(CCmdUI* pCmdUI);
+	afx_msg void OnEditSelectAll();
+	afx_msg void OnUpdateEditSelectAll(CCmdUI* pCmdUI);
+	afx_msg void OnUpdateEditReadOnly(CCmdUI* pCmdUI);
 	DECLARE_MESSAGE_MAP()
 };
 
@@ -0,0 +1,211 @@
+/* Copyright (C) 2014-2026 Stefan-Mihai MOGA
+This file is part of IntelliPort application developed by Stefan-Mihai MOGA.
+IntelliPort is an alternative Windows version to the famous HyperTerminal!
+
+IntelliPort is free software: you can redistribute it and/or modify it
+under the terms of the GNU General Public License as published by the Open
+Source Initiative, either version 3 of the License, or any later version.
+
+IntelliPort is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+IntelliPort. If not, see <http://www.opensource.org/licenses/gpl-3.0.html>*/
+
+// LatencyHistogram.h : arrival time stamps and a byte-arrival-to-display latency histogram
+//
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+typedef std::chrono::steady_clock CLatencyClock;
+
+/**
+ * @brief Histogram of latencies with power-of-two microsecond buckets.
+ *
+ * Bucket 0 counts latencies below 1 us and bucket N counts latencies in
+ * [2^(N-1), 2^N) us, so percentiles are reported as the bucket's upper bound.
+ * Not thread safe: record and query from the same thread.
+ */
+class CLatencyHistogram
+{
+public:
+	static constexpr int LATENCY_HISTOGRAM_BUCKETS = 32;
+
+	CLatencyHistogram()
+	{
+		Reset();
+	}
+
+	/**
+	 * @brief Clears all samples.
+	 */
+	void Reset()
+	{
+		for (int nBucket = 0; nBucket < LATENCY_HISTOGRAM_BUCKETS; nBucket++)
+		{
+			m_nBuckets[nBucket] = 0;
+		}
+		m_nCount = 0;
+		m_nMinimum = UINT64_MAX;
+		m_nMaximum = 0;
+	}
+
+	/**
+	 * @brief Adds one sample.
+	 * @param nMicroseconds Latency of the sample in microseconds.
+	 */
+	void Record(uint64_t nMicroseconds)
+	{
+		int nBucket = 0;
+		while ((nBucket < LATENCY_HISTOGRAM_BUCKETS - 1) && (nMicroseconds >> nBucket) != 0)
+		{
+			nBucket++;
+		}
+		m_nBuckets[nBucket]++;
+		m_nCount++;
+		if (nMicroseconds < m_nMinimum)
+		{
+			m_nMinimum = nMicroseconds;
+		}
+		if (nMicroseconds > m_nMaximum)
+		{
+			m_nMaximum = nMicroseconds;
+		}
+	}
+
+	/**
+	 * @brief Returns the number of samples recorded since the last Reset().
+	 */
+	uint64_t GetCount() const
+	{
+		return m_nCount;
+	}
+
+	uint64_t GetMinimum() const
+	{
+		return (m_nCount != 0) ? m_nMinimum : 0;
+	}
+
+	uint64_t GetMaximum() const
+	{
+		return m_nMaximum;
+	}
+
+	/**
+	 * @brief Returns an upper bound of the given percentile, in microseconds.
+	 * @param nPercent Percentile to report, from 0 to 100.
+	 * @return The bucket bound, clamped to the largest sample, or 0 when empty.
+	 */
+	uint64_t GetPercentile(double nPercent) const
+	{
+		if (m_nCount == 0)
+		{
+			return 0;
+		}
+		uint64_t nRank = static_cast<uint64_t>((nPercent / 100.0) * static_cast<double>(m_nCount) + 0.5);
+		if (nRank < 1)
+		{
+			nRank = 1;
+		}
+		uint64_t nSeen = 0;
+		for (int nBucket = 0; nBucket < LATENCY_HISTOGRAM_BUCKETS; nBucket++)
+		{
+			nSeen += m_nBuckets[nBucket];
+			if (nSeen >= nRank)
+			{
+				const uint64_t nBound = (nBucket == 0) ? 1 : (uint64_t(1) << nBucket);
+				return (nBound < m_nMaximum) ? nBound : m_nMaximum;
+			}
+		}
+		return m_nMaximum;
+	}
+
+protected:
+	uint64_t m_nBuckets[LATENCY_HISTOGRAM_BUCKETS];
+	uint64_t m_nCount;
+	uint64_t m_nMinimum;
+	uint64_t m_nMaximum;
+};
+
+/**
+ * @brief Single-producer/single-consumer queue of chunk arrival stamps.
+ *
+ * The reader thread pushes the stream position just past each chunk it committed
+ * to the ring buffer, together with the time it arrived; the UI thread pops the
+ * stamps whose bytes it has displayed and feeds the elapsed time to a histogram.
+ * When the queue is full a stamp is dropped, which only loses a sample.
+ */
+class CArrivalStampQueue
+{
+public:
+	static constexpr size_t ARRIVAL_STAMP_QUEUE_SIZE = 256; // power of two
+
+	struct CArrivalStamp
+	{
+		size_t nPosition;
+		CLatencyClock::time_point tArrival;
+	};
+
+	CArrivalStampQueue() : m_nHead(0), m_nTail(0)
+	{
+	}
+
+	/**
+	 * @brief Records the arrival of the bytes before nPosition. Producer side.
+	 * @return true if stored, false if the queue was full.
+	 */
+	bool Push(size_t nPosition, CLatencyClock::time_point tArrival)
+	{
+		const size_t nTail = m_nTail.load(std::memory_order_relaxed);
+		if (nTail - m_nHead.load(std::memory_order_acquire) >= ARRIVAL_STAMP_QUEUE_SIZE)
+		{
+			return false;
+		}
+		CArrivalStamp& pStamp = m_pStamps[nTail & (ARRIVAL_STAMP_QUEUE_SIZE - 1)];
+		pStamp.nPosition = nPosition;
+		pStamp.tArrival = tArrival;
+		m_nTail.store(nTail + 1, std::memory_order_release);
+		return true;
+	}
+
+	/**
+	 * @brief Records the latency of every chunk fully consumed up to nPosition. Consumer side.
+	 * @param nPosition Stream position of the oldest byte not yet displayed.
+	 * @param tNow Time the bytes were displayed.
+	 * @param pHistogram Histogram receiving one sample per chunk.
+	 */
+	void Complete(size_t nPosition, CLatencyClock::time_point tNow, CLatencyHistogram& pHistogram)
+	{
+		size_t nHead = m_nHead.load(std::memory_order_relaxed);
+		const size_t nTail = m_nTail.load(std::memory_order_acquire);
+		for (; nHead != nTail; nHead++)
+		{
+			const CArrivalStamp& pStamp = m_pStamps[nHead & (ARRIVAL_STAMP_QUEUE_SIZE - 1)];
+			if (pStamp.nPosition > nPosition)
+			{
+				break;
+			}
+			pHistogram.Record(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(tNow - pStamp.tArrival).count()));
+		}
+		m_nHead.store(nHead, std::memory_order_release);
+	}
+
+	/**
+	 * @brief Discards all stamps. Consumer side.
+	 */
+	void Clear()
+	{
+		m_nHead.store(m_nTail.load(std::memory_order_acquire), std::memory_order_release);
+	}
+
+protected:
+	std::atomic<size_t> m_nHead;
+	std::atomic<size_t> m_nTail;
+	CArrivalStamp m_pStamps[ARRIVAL_STAMP_QUEUE_SIZE];
+};
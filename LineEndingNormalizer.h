@@ -0,0 +1,209 @@
+/* Copyright (C) 2014-2026 Stefan-Mihai MOGA
+This file is part of IntelliPort application developed by Stefan-Mihai MOGA.
+IntelliPort is an alternative Windows version to the famous HyperTerminal!
+
+IntelliPort is free software: you can redistribute it and/or modify it
+under the terms of the GNU General Public License as published by the Open
+Source Initiative, either version 3 of the License, or any later version.
+
+IntelliPort is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+IntelliPort. If not, see <http://www.opensource.org/licenses/gpl-3.0.html>*/
+
+// LineEndingNormalizer.h : single-pass streaming line ending conversion
+//
+
+#pragma once
+
+#include "DelimiterScanner.h"
+#include <cstddef>
+#include <cstring>
+#include <string>
+
+/**
+ * @brief Finds the first CR or LF in a wide character buffer.
+ *
+ * Compares 16 bytes per step with SSE2: 8 characters where wchar_t is 16 bits
+ * wide (Windows), 4 where it is 32 bits wide.
+ *
+ * @return Index of the first line ending character, or nLength if there is none.
+ */
+inline size_t FindLineEnding(const wchar_t* pData, size_t nLength)
+{
+	size_t nIndex = 0;
+#if defined(DELIMITER_SCANNER_SSE2)
+	if (sizeof(wchar_t) == 2)
+	{
+		const __m128i vCR = _mm_set1_epi16('\r');
+		const __m128i vLF = _mm_set1_epi16('\n');
+		for (; nIndex + 8 <= nLength; nIndex += 8)
+		{
+			const __m128i vData = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pData + nIndex));
+			const __m128i vMatch = _mm_or_si128(_mm_cmpeq_epi16(vData, vCR), _mm_cmpeq_epi16(vData, vLF));
+			const uint32_t nMask = static_cast<uint32_t>(_mm_movemask_epi8(vMatch));
+			if (nMask != 0)
+			{
+				return nIndex + DelimiterScannerLowestBit(nMask) / 2;
+			}
+		}
+	}
+	else
+	{
+		const __m128i vCR = _mm_set1_epi32('\r');
+		const __m128i vLF = _mm_set1_epi32('\n');
+		for (; nIndex + 4 <= nLength; nIndex += 4)
+		{
+			const __m128i vData = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pData + nIndex));
+			const __m128i vMatch = _mm_or_si128(_mm_cmpeq_epi32(vData, vCR), _mm_cmpeq_epi32(vData, vLF));
+			const uint32_t nMask = static_cast<uint32_t>(_mm_movemask_epi8(vMatch));
+			if (nMask != 0)
+			{
+				return nIndex + DelimiterScannerLowestBit(nMask) / 4;
+			}
+		}
+	}
+#endif
+	for (; nIndex < nLength; nIndex++)
+	{
+		if ((pData[nIndex] == L'\r') || (pData[nIndex] == L'\n'))
+		{
+			return nIndex;
+		}
+	}
+	return nLength;
+}
+
+/**
+ * @brief Finds the first CR or LF in a byte buffer.
+ */
+inline size_t FindLineEnding(const char* pData, size_t nLength)
+{
+	return FindFirstDelimiter(pData, nLength, '\r', '\n', '\n');
+}
+
+/**
+ * @brief Streaming line ending normalizer.
+ *
+ * Converts CRLF, lone CR and lone LF to the line ending of the selected mode
+ * in one pass: runs of text without line endings are located with a vector
+ * scan and copied in bulk. A CR at the end of a chunk is converted at once and
+ * remembered, so an LF arriving at the start of the next chunk is recognized
+ * as the second half of the same CRLF instead of starting another line.
+ */
+template <typename TChar>
+class CLineEndingNormalizer
+{
+public:
+	enum LineEndingMode
+	{
+		LINE_ENDING_CRLF = 0, // every line ending becomes CRLF (edit control display)
+		LINE_ENDING_LF = 1,   // every line ending becomes LF
+		LINE_ENDING_RAW = 2,  // text is passed through unchanged
+	};
+
+	CLineEndingNormalizer() : m_nMode(LINE_ENDING_CRLF), m_bAfterCR(false)
+	{
+	}
+
+	void SetMode(LineEndingMode nMode)
+	{
+		m_nMode = nMode;
+		m_bAfterCR = false;
+	}
+
+	LineEndingMode GetMode() const
+	{
+		return m_nMode;
+	}
+
+	/**
+	 * @brief Forgets a CR seen at the end of the previous chunk.
+	 */
+	void Reset()
+	{
+		m_bAfterCR = false;
+	}
+
+	/**
+	 * @brief Returns the most characters Normalize() can append for nLength characters.
+	 */
+	static size_t GetMaxOutput(size_t nLength)
+	{
+		return 2 * nLength;
+	}
+
+	/**
+	 * @brief Normalizes a chunk of text and appends it to strOutput.
+	 *
+	 * @param pData Pointer to the text (need not be null-terminated).
+	 * @param nLength Number of characters to convert.
+	 * @param strOutput String receiving the converted text; its capacity is reused.
+	 * @return Number of characters appended.
+	 */
+	size_t Normalize(const TChar* pData, size_t nLength, std::basic_string<TChar>& strOutput)
+	{
+		const size_t nStart = strOutput.size();
+		strOutput.resize(nStart + GetMaxOutput(nLength));
+		const size_t nCount = Normalize(pData, nLength, &strOutput[nStart]);
+		strOutput.resize(nStart + nCount);
+		return nCount;
+	}
+
+	/**
+	 * @brief Normalizes a chunk of text into a caller-provided buffer.
+	 *
+	 * @param pData Pointer to the text.
+	 * @param nLength Number of characters to convert.
+	 * @param pOutput Buffer of at least GetMaxOutput(nLength) characters.
+	 * @return Number of characters written.
+	 */
+	size_t Normalize(const TChar* pData, size_t nLength, TChar* pOutput)
+	{
+		if (m_nMode == LINE_ENDING_RAW)
+		{
+			memcpy(pOutput, pData, nLength * sizeof(TChar));
+			return nLength;
+		}
+
+		TChar* pTarget = pOutput;
+		size_t nIndex = 0;
+		while (nIndex < nLength)
+		{
+			// Copy the run up to the next line ending in bulk
+			const size_t nRun = FindLineEnding(pData + nIndex, nLength - nIndex);
+			if (nRun > 0)
+			{
+				memcpy(pTarget, pData + nIndex, nRun * sizeof(TChar));
+				pTarget += nRun;
+				nIndex += nRun;
+				m_bAfterCR = false;
+				if (nIndex == nLength)
+				{
+					break;
+				}
+			}
+
+			const TChar chEnding = pData[nIndex++];
+			if ((chEnding == '\n') && m_bAfterCR)
+			{
+				// Second half of a CRLF whose CR was already converted
+				m_bAfterCR = false;
+				continue;
+			}
+			m_bAfterCR = (chEnding == '\r');
+			if (m_nMode == LINE_ENDING_CRLF)
+			{
+				*pTarget++ = '\r';
+			}
+			*pTarget++ = '\n';
+		}
+		return static_cast<size_t>(pTarget - pOutput);
+	}
+
+protected:
+	LineEndingMode m_nMode;
+	bool m_bAfterCR; // the last character seen was a CR
+};
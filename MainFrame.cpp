@@ -19,10 +19,12 @@ IntelliPort. If not, see <http://www.opensource.org/licenses/gpl-3.0.html>*/
 #include "stdafx.h"
 #include "IntelliPort.h"
 #include "MainFrame.h"
+#include "IntelliPortDoc.h"
 #include "ConfigureDlg.h"
 #include "InputDlg.h"
 #include "WebBrowserDlg.h"
 #include "CheckForUpdatesDlg.h"
+#include "Messages.h"
 
 #ifdef _DEBUG
 #define new DEBUG_NEW
@@ -68,11 +70,19 @@ BEGIN_MESSAGE_MAP(CMainFrame, CFrameWndEx)
 	ON_COMMAND(ID_OPEN_SERIAL_PORT, &CMainFrame::OnOpenSerialPort)
 	ON_COMMAND(ID_CLOSE_SERIAL_PORT, &CMainFrame::OnCloseSerialPort)
 	ON_COMMAND(ID_SEND_RECEIVE, &CMainFrame::OnSendReceive)
+	ON_COMMAND(ID_REPLAY_CAPTURE, &CMainFrame::OnReplayCapture)
+	ON_COMMAND(ID_TRAFFIC_TEST, &CMainFrame::OnTrafficTest)
 	ON_UPDATE_COMMAND_UI(ID_CONFIG_SERIAL_PORT, &CMainFrame::OnUpdateConfigureSerialPort)
 	ON_UPDATE_COMMAND_UI(ID_OPEN_SERIAL_PORT, &CMainFrame::OnUpdateOpenSerialPort)
 	ON_UPDATE_COMMAND_UI(ID_CLOSE_SERIAL_PORT, &CMainFrame::OnUpdateCloseSerialPort)
 	ON_UPDATE_COMMAND_UI(ID_SEND_RECEIVE, &CMainFrame::OnUpdateSendReceive)
+	ON_UPDATE_COMMAND_UI(ID_REPLAY_CAPTURE, &CMainFrame::OnUpdateReplayCapture)
+	ON_UPDATE_COMMAND_UI(ID_TRAFFIC_TEST, &CMainFrame::OnUpdateTrafficTest)
 	ON_WM_TIMER()
+	ON_MESSAGE(MSG_RING_BUFFER_DATA, &CMainFrame::OnRingBufferData)
+	ON_MESSAGE(MSG_FILE_INDEXED, &CMainFrame::OnFileIndexed)
+	ON_MESSAGE(MSG_REPLAY_FINISHED, &CMainFrame::OnReplayFinished)
+	ON_MESSAGE(MSG_CAPTION_BAR_TEXT, &CMainFrame::OnCaptionBarText)
 	ON_WM_DESTROY()
 	ON_COMMAND(IDC_TWITTER, &CMainFrame::OnTwitter)
 	ON_COMMAND(IDC_LINKEDIN, &CMainFrame::OnLinkedin)
@@ -91,6 +101,8 @@ END_MESSAGE_MAP()
  * Initializes the main frame window and all member variables:
  * - Loads application visual style from settings
  * - Creates ring buffer for data communication (64KB)
+ * - Creates the UDP datagram queue (DatagramQueueKB, default 4 MB)
+ * - Loads the display frame rate cap from settings (MaxFrameRate, default 60)
  * - Initializes threading variables to null/false
  * - Sets default connection parameters (invalid state until configured)
  * - Initializes default network settings (localhost:8080)
@@ -103,8 +115,15 @@ CMainFrame::CMainFrame()
 	// Initialize time tracking for caption bar auto-hide
 	m_pCurrentDateTime = CTime::GetCurrentTime();
 	
-	// Create ring buffer for data communication (64KB)
-	m_pRingBuffer.Create(0x10000);
+	// Create ring buffer for data communication (64KB), mapped twice back to back
+	// where the OS supports it so received data never wraps around
+	m_pReceiveBuffer.Create(0x10000, true);
+	// What to do when data arrives faster than it is displayed (block by default)
+	m_pReceiveBuffer.SetPolicy(
+		(CReceiveBuffer::OverflowPolicy) std::clamp(theApp.GetInt(_T("OverflowPolicy"), CReceiveBuffer::OVERFLOW_BLOCK), 0, 3),
+		(uint64_t) std::clamp(theApp.GetInt(_T("SpillLimitMB"), 1024), 1, 0x100000) << 20);
+	// Whole UDP datagrams wait for the display here (4 MB by default)
+	m_pDatagramQueue.Create(static_cast<size_t>(std::clamp(theApp.GetInt(_T("DatagramQueueKB"), 4096), 256, 0x40000)) << 10);
 	
 	// Initialize threading variables
 	m_nThreadRunning = false;
@@ -113,6 +132,14 @@ CMainFrame::CMainFrame()
 	m_nSerialPortThreadID = 0;
 	m_nSocketTreadID = 0;
 	m_nTimerID = 0;
+	m_bTrafficTest = false;
+
+	// Initialize the event-driven display of incoming data
+	m_nDrainTimerID = 0;
+	m_bDataPending = false;
+	m_nLastDrainTick = 0;
+	m_nMaxFrameRate = std::clamp<UINT>(theApp.GetInt(_T("MaxFrameRate"), 60), 1, 1000);
+	m_nLatencyShown = 0;
 
 	// Initialize serial port configuration to invalid state
 	theApp.m_nBaudRate = -1;
@@ -141,8 +168,9 @@ CMainFrame::~CMainFrame()
 {
 	// Close any open serial port or socket connection
 	OnCloseSerialPort();
-	// Destroy the ring buffer
-	m_pRingBuffer.Destroy();
+	// Destroy the ring buffer and its spill file
+	m_pReceiveBuffer.Destroy();
+	m_pDatagramQueue.Destroy();
 }
 
 /**
@@ -154,7 +182,7 @@ CMainFrame::~CMainFrame()
  * - Creates the status bar with a single pane
  * - Creates the caption bar for notifications
  * - Creates the incoming connection dialog (for TCP server mode)
- * - Starts a 10ms timer for ring buffer checking
+ * - Starts a 1 second timer for auto-hiding the caption bar
  * 
  * @param lpCreateStruct Pointer to CREATESTRUCT containing window creation parameters.
  * @return 0 on success, -1 if creation fails.
@@ -195,6 +223,12 @@ int CMainFrame::OnCreate(LPCREATESTRUCT lpCreateStruct)
 		ID_STATUSBAR_PANE1, strTitlePane, TRUE, NULL,
 		_T("012345678901234567890123456789012345678901234567890123456789")), strTitlePane);
 
+	// Add a right-aligned pane showing the byte-arrival-to-display latency
+	VERIFY(strTitlePane.LoadString(IDS_STATUS_PANE2));
+	m_wndStatusBar.AddExtendedElement(new CMFCRibbonStatusBarPane(
+		ID_STATUSBAR_PANE2, _T(""), TRUE, NULL,
+		_T("p50 0000.0 ms  p99 0000.0 ms  dropped 000000000 B  spilled 0000000000 B  peak 00000 B")), strTitlePane);
+
 	// Load and display initial status message
 	VERIFY(strTitlePane.LoadString(IDS_LOG_HISTORY_CLEARED));
 	SetStatusBarText(strTitlePane);
@@ -206,12 +240,10 @@ int CMainFrame::OnCreate(LPCREATESTRUCT lpCreateStruct)
 		return -1;
 	}
 
-	// Create the "waiting for connection" dialog (hidden initially)
-	VERIFY(m_dlgIncoming.Create(CIncomingDlg::IDD, this));
-
-	// Start a timer that fires every 10 milliseconds
-	// Timer is used to check ring buffer for incoming data
-	m_nTimerID = SetTimer(1, 10, NULL);
+	// Start a timer that fires every second to auto-hide the caption bar and
+	// refresh the latency pane (incoming data is signalled by the reading
+	// threads, see NotifyDataReady)
+	m_nTimerID = SetTimer(1, 1000, NULL);
 
 	return 0;
 }
@@ -278,13 +310,22 @@ bool CMainFrame::CreateCaptionBar()
  * @brief Handles the WM_DESTROY message during window destruction.
  * 
  * Performs cleanup before the window is destroyed:
- * - Kills the timer used for ring buffer checking
+ * - Kills the caption bar timer and any pending display timer
  * - Calls base class OnDestroy for standard cleanup
  */
 void CMainFrame::OnDestroy()
 {
-	// Kill the timer
+	// Kill the timers
 	VERIFY(KillTimer(m_nTimerID));
+	if (m_nDrainTimerID != 0)
+	{
+		KillTimer(m_nDrainTimerID);
+		m_nDrainTimerID = 0;
+	}
+	// The worker threads write through the connection members: end them first
+	m_pCaptureReplay.Stop();
+	m_pTrafficGenerator.Stop();
+	m_pWriteQueue.Stop(false);
 
 	CFrameWndEx::OnDestroy();
 }
@@ -292,15 +333,12 @@ void CMainFrame::OnDestroy()
 /**
  * @brief Handles the WM_TIMER message for periodic processing.
  * 
- * Called every 10 milliseconds to:
- * - Check the ring buffer for incoming data from serial port or socket
- * - Convert UTF-8 data to Unicode and display in the edit view
- * - Auto-hide the caption bar after 10 seconds of display
- * 
- * The ring buffer is accessed with mutex locking to ensure thread safety
- * between the UI thread and background reading threads.
+ * The caption bar timer fires every second, auto-hides the caption bar
+ * after 10 seconds of display and refreshes the latency pane. The display
+ * timer is a one-shot timer armed by OnRingBufferData when incoming data
+ * arrives faster than the frame rate cap.
  * 
- * @param nIDEvent Timer identifier (must match m_nTimerID).
+ * @param nIDEvent Timer identifier (m_nTimerID or m_nDrainTimerID).
  */
 void CMainFrame::OnTimer(UINT_PTR nIDEvent)
 {
@@ -314,33 +352,420 @@ void CMainFrame::OnTimer(UINT_PTR nIDEvent)
 		{
 			HideMessageBar();
 		}
-
-		// Read incoming data from ring buffer (up to 4KB)
-		char pBuffer[0x1000] = { 0, };
-		// Lock mutex to prevent conflicts with reading threads
-		m_pMutualAccess.lock();
-		// Check how much data is available in the ring buffer
-		const int nLength = m_pRingBuffer.GetMaxReadSize();
-		if (nLength > 0)
+		UpdateLatencyPane();
+		if (m_bTrafficTest)
 		{
-			// Read binary data from ring buffer into local buffer
-			m_pRingBuffer.ReadBinary(pBuffer, nLength);
-			// Null-terminate the buffer for string safety
-			pBuffer[nLength] = '\0';
-
-			// Convert UTF-8 encoded data to Unicode (wide string)
-			const std::string strRawText(pBuffer);
-			CString strBuffer(utf8_to_wstring(strRawText).c_str());
-			// Display the text in the edit view
-			AddText(strBuffer);
+			UpdateTrafficStatus();
 		}
-		// Release mutex lock
-		m_pMutualAccess.unlock();
+	}
+	else if ((m_nDrainTimerID != 0) && (nIDEvent == m_nDrainTimerID))
+	{
+		// One-shot: the next frame is due, show what has arrived meanwhile
+		KillTimer(m_nDrainTimerID);
+		m_nDrainTimerID = 0;
+		DrainRingBuffer();
 	}
 
 	CFrameWndEx::OnTimer(nIDEvent);
 }
 
+/**
+ * @brief Signals the UI thread that new data is in the ring buffer.
+ * 
+ * Called by the reading threads after each write. Only the first call since the
+ * last wakeup posts MSG_RING_BUFFER_DATA; later ones find the pending flag set,
+ * so a burst of reads costs a single message and an idle port costs nothing.
+ * Each call also stamps the chunk with its arrival time for the latency pane.
+ */
+void CMainFrame::NotifyDataReady()
+{
+	m_pArrivalStamps.Push(m_pReceiveBuffer.GetTotalWritten(), CLatencyClock::now());
+	PostDataReady();
+}
+
+/**
+ * @brief Wakes the UI thread without stamping an arrival time.
+ * 
+ * Used for the datagram queue, whose records carry their own arrival times.
+ */
+void CMainFrame::PostDataReady()
+{
+	if (!m_bDataPending.exchange(true, std::memory_order_acq_rel))
+	{
+		if (!::PostMessage(GetSafeHwnd(), MSG_RING_BUFFER_DATA, 0, 0))
+		{
+			// Message queue full or window gone: let the next write try again
+			m_bDataPending.store(false, std::memory_order_release);
+		}
+	}
+}
+
+/**
+ * @brief Handles MSG_RING_BUFFER_DATA posted by the reading threads.
+ * 
+ * Displays the incoming data right away, unless the previous frame was shown
+ * less than 1/MaxFrameRate seconds ago. In that case a one-shot timer is armed
+ * for the remainder of the frame, so repaints stay bounded under heavy load.
+ * 
+ * @param wParam Not used.
+ * @param lParam Not used.
+ * @return Always 0.
+ */
+LRESULT CMainFrame::OnRingBufferData(WPARAM /*wParam*/, LPARAM /*lParam*/)
+{
+	// Clear the flag first, so data written from now on posts a new message
+	m_bDataPending.store(false, std::memory_order_release);
+
+	if (m_nDrainTimerID != 0)
+	{
+		// A frame is already scheduled and will pick this data up
+		return 0;
+	}
+
+	const ULONGLONG nFrameInterval = 1000 / m_nMaxFrameRate;
+	const ULONGLONG nElapsed = GetTickCount64() - m_nLastDrainTick;
+	if (nElapsed >= nFrameInterval)
+	{
+		DrainRingBuffer();
+	}
+	else
+	{
+		m_nDrainTimerID = SetTimer(2, (UINT)(nFrameInterval - nElapsed), NULL);
+	}
+	return 0;
+}
+
+/**
+ * @brief Handles MSG_FILE_INDEXED posted while an opened file is being indexed.
+ * 
+ * Lets the view extend its scroll range over the lines indexed so far.
+ * 
+ * @param wParam Not used.
+ * @param lParam Not used.
+ * @return Always 0.
+ */
+LRESULT CMainFrame::OnFileIndexed(WPARAM /*wParam*/, LPARAM /*lParam*/)
+{
+	CIntelliPortDoc* pDocument = reinterpret_cast<CIntelliPortDoc*>(GetActiveDocument());
+	if (pDocument != nullptr)
+	{
+		pDocument->UpdateAllViews(nullptr, CIntelliPortDoc::HINT_FILE_INDEXED);
+	}
+	return 0;
+}
+
+/**
+ * @brief Displays the data held in the ring buffer and its spill segment.
+ * 
+ * Decodes UTF-8 data straight from the ring buffer storage (and the spill
+ * segment's stage) and appends it to the document's scrollback in one pass.
+ * The decoder carries a character split across the end of the ring storage or
+ * across two wakeups over to the next call. At most RECEIVE_DRAIN_LIMIT bytes
+ * are shown per frame, so a large spilled backlog cannot stall the UI; when
+ * more is left the UI thread is woken again, also after the sender went quiet.
+ * The ring buffer is a lock-free single-producer/single-consumer queue, so the
+ * reading threads never block.
+ */
+void CMainFrame::DrainRingBuffer()
+{
+	static constexpr size_t RECEIVE_DRAIN_LIMIT = 0x100000;
+	m_nLastDrainTick = GetTickCount64();
+
+	// Decode incoming data straight out of the ring buffer storage
+	const size_t nTotalRead = m_pReceiveBuffer.GetTotalRead();
+	m_strDecoded.clear();
+	const bool bMore = m_pReceiveBuffer.Drain(RECEIVE_DRAIN_LIMIT, [this](const char* pData, int nLength)
+	{
+		if (!m_bTrafficTest) // test frames are checked as they arrive, not displayed
+		{
+			m_pUtf8Decoder.Decode(pData, nLength, m_strDecoded);
+		}
+	});
+	if (m_pReceiveBuffer.GetTotalRead() != nTotalRead)
+	{
+		// Append the text to the scrollback; the view repaints what became visible
+		if (!m_strDecoded.empty())
+		{
+			AddText(m_strDecoded.data(), static_cast<int>(m_strDecoded.size()));
+		}
+		// Every chunk consumed in full has now been displayed
+		m_pArrivalStamps.Complete(m_pReceiveBuffer.GetTotalRead(), CLatencyClock::now(), m_pLatencyHistogram);
+	}
+	if (bMore)
+	{
+		PostDataReady(); // the rest in the next frame
+	}
+
+	DrainDatagramQueue();
+}
+
+/**
+ * @brief Displays the UDP datagrams waiting in the datagram queue, one line each.
+ * 
+ * Every line starts with the datagram's metadata, then holds its text:
+ * "[hh:mm:ss.uuuuuu address:port length B] text". The arrival time is the
+ * one reported by the network stack, in local time; line endings inside a
+ * datagram are shown as control pictures so it stays on one line, and each
+ * datagram is decoded on its own, with a decoder apart from the stream's (a
+ * character split at the end of a datagram is shown as U+FFFD). The datagrams
+ * are taken in batches straight from the queue's slab, and at most
+ * DATAGRAM_DRAIN_LIMIT per frame, so a flood cannot stall the UI; the rest
+ * waits for the next frame. The time from arrival to display of each one goes
+ * to the latency pane.
+ */
+void CMainFrame::DrainDatagramQueue()
+{
+	static constexpr int DATAGRAM_DRAIN_BATCH = 256;
+	static constexpr int DATAGRAM_DRAIN_LIMIT = 4096;
+	CDatagramEntry pEntries[DATAGRAM_DRAIN_BATCH];
+	int nCount = m_pDatagramQueue.Peek(pEntries, DATAGRAM_DRAIN_BATCH);
+	if (nCount == 0)
+	{
+		m_pDatagramQueue.Consume(); // padding records, if any
+		return;
+	}
+
+	// Arrival times are CLatencyClock nanoseconds: find local time in 100 ns units once per frame
+	const uint64_t nNow = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+		CLatencyClock::now().time_since_epoch()).count());
+	FILETIME ftUniversal, ftLocal;
+	GetSystemTimePreciseAsFileTime(&ftUniversal);
+	FileTimeToLocalFileTime(&ftUniversal, &ftLocal);
+	const uint64_t nLocalOffset = ((static_cast<uint64_t>(ftLocal.dwHighDateTime) << 32) | ftLocal.dwLowDateTime) - nNow / 100;
+
+	m_strDecoded.clear();
+	int nDisplayed = 0;
+	while (nCount > 0)
+	{
+		for (int nIndex = 0; nIndex < nCount; nIndex++)
+		{
+			const CDatagramEntry& pEntry = pEntries[nIndex];
+			if (!m_bTrafficTest) // test frames are checked as they arrive, not displayed
+			{
+				const uint64_t nLocalTime = pEntry.nTimestamp / 100 + nLocalOffset;
+				const uint64_t nSecond = (nLocalTime / 10000000) % 86400;
+				wchar_t lpszHeader[0x80] = { 0, };
+				const int nHeaderLength = swprintf_s(lpszHeader, L"[%02u:%02u:%02u.%06u %s %u B%s] ",
+					static_cast<unsigned>(nSecond / 3600), static_cast<unsigned>((nSecond / 60) % 60), static_cast<unsigned>(nSecond % 60),
+					static_cast<unsigned>((nLocalTime / 10) % 1000000), static_cast<LPCWSTR>(GetEndpointName(pEntry.nEndpoint)),
+					pEntry.nLength, pEntry.bTruncated ? L" truncated" : L"");
+				m_strDecoded.append(lpszHeader, (nHeaderLength > 0) ? nHeaderLength : 0);
+				const size_t nStart = m_strDecoded.size();
+				m_pDatagramDecoder.Reset();
+				m_pDatagramDecoder.Decode(pEntry.pData, pEntry.nLength, m_strDecoded);
+				m_pDatagramDecoder.Flush(m_strDecoded);
+				std::replace(m_strDecoded.begin() + nStart, m_strDecoded.end(), L'\r', L'\x240D');
+				std::replace(m_strDecoded.begin() + nStart, m_strDecoded.end(), L'\n', L'\x240A');
+				m_strDecoded.append(L"\r\n", 2);
+			}
+			if (nNow > pEntry.nTimestamp)
+			{
+				m_pLatencyHistogram.Record((nNow - pEntry.nTimestamp) / 1000);
+			}
+		}
+		m_pDatagramQueue.Consume();
+		nDisplayed += nCount;
+		nCount = (nDisplayed < DATAGRAM_DRAIN_LIMIT) ? m_pDatagramQueue.Peek(pEntries, DATAGRAM_DRAIN_BATCH) : 0;
+	}
+	if (!m_strDecoded.empty())
+	{
+		AddText(m_strDecoded.data(), static_cast<int>(m_strDecoded.size()));
+	}
+	if (!m_pDatagramQueue.IsEmpty())
+	{
+		PostDataReady(); // the rest in the next frame
+	}
+}
+
+/**
+ * @brief Returns "address:port" of a datagram sender, formatted on first use.
+ * 
+ * @param nEndpoint The sender's CEndpointTable id.
+ * @return The text, or "?" for a sender that could not be interned.
+ */
+const CString& CMainFrame::GetEndpointName(uint32_t nEndpoint)
+{
+	if (nEndpoint >= m_vecEndpointNames.size())
+	{
+		m_vecEndpointNames.resize(nEndpoint + 1);
+	}
+	CString& strName = m_vecEndpointNames[nEndpoint];
+	if (strName.IsEmpty())
+	{
+		sockaddr_storage pAddress;
+		int nLength = 0;
+		strName = _T("?");
+		if (m_pEndpoints.GetAddress(nEndpoint, pAddress, nLength))
+		{
+			try
+			{
+				UINT nPort = 0;
+				const CString strAddress = CWSocket::AddressToString(reinterpret_cast<const SOCKADDR*>(&pAddress), nLength, NI_NUMERICHOST, &nPort);
+				strName.Format((pAddress.ss_family == AF_INET6) ? _T("[%s]:%u") : _T("%s:%u"), static_cast<LPCTSTR>(strAddress), nPort);
+			}
+			catch (CWSocketException* pException)
+			{
+				pException->Delete();
+			}
+		}
+	}
+	return strName;
+}
+
+/**
+ * @brief Called by the reading threads while the receive buffer has no room.
+ * 
+ * Wakes the UI thread so it drains the buffer (or discards the oldest bytes,
+ * depending on the overflow policy) and gives it a moment to do so. Nothing
+ * was written since the last stamp, so no arrival time is taken on a retry.
+ * 
+ * @return true to keep waiting, false once the connection is being closed.
+ */
+bool CMainFrame::WaitForReceiveBuffer()
+{
+	PostDataReady();
+	Sleep(1);
+	return m_nThreadRunning;
+}
+
+/**
+ * @brief Displays what is left from the previous connection and clears the
+ * receive buffer, its spill file and all statistics. Called before a new
+ * connection starts its reading thread.
+ */
+void CMainFrame::ResetReceiveBuffer()
+{
+	DrainRingBuffer();
+	m_pReceiveBuffer.Reset();
+	m_pDatagramQueue.Reset();
+	m_pEndpoints.Reset();
+	m_vecEndpointNames.clear();
+	m_pUtf8Decoder.Reset();
+	m_pDatagramDecoder.Reset();
+	CIntelliPortDoc* pDocument = reinterpret_cast<CIntelliPortDoc*>(GetActiveDocument());
+	if (pDocument != nullptr)
+	{
+		pDocument->m_pLineEnding.Reset();
+	}
+	m_pArrivalStamps.Clear();
+	m_pLatencyHistogram.Reset();
+	m_nLatencyShown = UINT64_MAX;
+}
+
+/**
+ * @brief Starts recording the new connection to a capture file.
+ * 
+ * Does nothing unless the CaptureFolder setting names a folder. The capture is
+ * written to IntelliPort-<date>-<time>.ipcap in that folder, with its index
+ * next to it, and holds every byte received and sent with its time, direction
+ * and source (see CaptureFile.h). Called before the reading thread starts.
+ */
+void CMainFrame::StartCapture()
+{
+	m_pReceiveBuffer.SetCapture(nullptr);
+	m_pDatagramQueue.SetCapture(nullptr);
+	m_pCapture.Close();
+	CString strPath = theApp.GetString(_T("CaptureFolder"), _T(""));
+	if (strPath.IsEmpty())
+	{
+		return;
+	}
+	if (strPath.Right(1) != _T("\\"))
+	{
+		strPath += _T("\\");
+	}
+	strPath += CTime::GetCurrentTime().Format(_T("IntelliPort-%Y%m%d-%H%M%S.ipcap"));
+
+	CString strFormat, strMessage;
+	if (m_pCapture.Open(strPath))
+	{
+		// A TCP server records each client's bytes itself, before its lines are tagged
+		m_pReceiveBuffer.SetCapture(m_pTcpServer.IsOpen() ? nullptr : &m_pCapture);
+		m_pDatagramQueue.SetCapture(&m_pCapture);
+		VERIFY(strFormat.LoadString(IDS_CAPTURE_STARTED));
+	}
+	else
+	{
+		VERIFY(strFormat.LoadString(IDS_CAPTURE_FAILED));
+	}
+	strMessage.Format(strFormat, static_cast<LPCWSTR>(strPath));
+	SetStatusBarText(strMessage);
+}
+
+/**
+ * @brief Shows the byte-arrival-to-display latency in the second status bar pane.
+ * 
+ * Reports the median and the 99th percentile of the time between a chunk being
+ * committed by a reading thread and its text being appended to the view, since
+ * the connection was opened, followed by the receive buffer overflow counters
+ * once bytes have been dropped or spilled to disk, and by the write queue
+ * counters (depth, bytes in flight, enqueue-to-written latency) once data has
+ * been sent. The pane is only repainted when new samples exist.
+ */
+void CMainFrame::UpdateLatencyPane()
+{
+	const CReceiveBufferStats stats = m_pReceiveBuffer.GetStats();
+	const uint64_t nOverflow = stats.nBytesDropped + stats.nBytesSpilled;
+	const CWriteQueueStats pWriteStats = m_pWriteQueue.GetStats();
+	const uint64_t nWriteActivity = pWriteStats.nWrites + pWriteStats.nRejected + pWriteStats.nBytesQueued + pWriteStats.nBytesInFlight;
+	const CDatagramQueueStats pDatagramStats = m_pDatagramQueue.GetStats();
+	const uint64_t nDatagramActivity = pDatagramStats.nDatagrams + pDatagramStats.nDropped;
+	if ((m_wndStatusBar.GetSafeHwnd() == nullptr) || (m_pLatencyHistogram.GetCount() + nOverflow + nWriteActivity + nDatagramActivity == m_nLatencyShown))
+	{
+		return;
+	}
+	m_nLatencyShown = m_pLatencyHistogram.GetCount() + nOverflow + nWriteActivity + nDatagramActivity;
+
+	CString strLatency;
+	if (m_pLatencyHistogram.GetCount() != 0)
+	{
+		strLatency.Format(_T("p50 %.1f ms  p99 %.1f ms"),
+			m_pLatencyHistogram.GetPercentile(50) / 1000.0,
+			m_pLatencyHistogram.GetPercentile(99) / 1000.0);
+	}
+	if (nOverflow != 0)
+	{
+		CString strOverflow;
+		strOverflow.Format(_T("  dropped %I64u B  spilled %I64u B  peak %I64u B"),
+			stats.nBytesDropped, stats.nBytesSpilled, stats.nHighWaterMark);
+		strLatency += strOverflow;
+	}
+	if (nWriteActivity != 0)
+	{
+		CString strWrite;
+		strWrite.Format(_T("  TX queued %I64u (%I64u B)  in flight %I64u B  write p50 %.1f ms  p99 %.1f ms"),
+			pWriteStats.nDepth, pWriteStats.nBytesQueued, pWriteStats.nBytesInFlight,
+			pWriteStats.pWriteLatency.GetPercentile(50) / 1000.0,
+			pWriteStats.pWriteLatency.GetPercentile(99) / 1000.0);
+		if (pWriteStats.nRejected + pWriteStats.nDiscarded != 0)
+		{
+			CString strRefused;
+			strRefused.Format(_T("  refused %I64u  discarded %I64u"), pWriteStats.nRejected, pWriteStats.nDiscarded);
+			strWrite += strRefused;
+		}
+		strLatency += strWrite;
+	}
+	if (nDatagramActivity != 0)
+	{
+		CString strDatagrams;
+		strDatagrams.Format(_T("  UDP %I64u datagrams from %u senders"), pDatagramStats.nDatagrams, m_pEndpoints.GetCount());
+		if (pDatagramStats.nDropped + pDatagramStats.nTruncated != 0)
+		{
+			CString strLost;
+			strLost.Format(_T("  dropped %I64u  truncated %I64u"), pDatagramStats.nDropped, pDatagramStats.nTruncated);
+			strDatagrams += strLost;
+		}
+		strLatency += strDatagrams;
+	}
+	CMFCRibbonBaseElement* pElement = m_wndStatusBar.FindByID(ID_STATUSBAR_PANE2);
+	if (pElement != nullptr)
+	{
+		pElement->SetText(strLatency);
+		m_wndStatusBar.RecalcLayout();
+		m_wndStatusBar.Invalidate();
+	}
+}
+
 /**
  * @brief Sets the text displayed in the status bar.
  * 
@@ -391,6 +816,45 @@ bool CMainFrame::SetCaptionBarText(const CString& strMessage)
 	return false;
 }
 
+/**
+ * @brief Shows a message in the caption bar from a worker thread.
+ * 
+ * SetCaptionBarText() sends messages to the caption bar and the frame, so a
+ * worker thread calling it waits for the UI thread, which may itself be
+ * waiting for that worker to end: a deadlock. This posts a copy of the message
+ * instead; OnCaptionBarText() shows it on the UI thread.
+ * 
+ * @param strMessage The message to display in the caption bar.
+ * @param bError true to also play the error sound.
+ */
+void CMainFrame::PostCaptionBarText(const CString& strMessage, bool bError)
+{
+	CString* pMessage = new CString(strMessage);
+	if (!::PostMessage(GetSafeHwnd(), MSG_CAPTION_BAR_TEXT, bError ? 1 : 0, reinterpret_cast<LPARAM>(pMessage)))
+	{
+		delete pMessage; // the window is gone
+	}
+}
+
+/**
+ * @brief Handles MSG_CAPTION_BAR_TEXT posted by PostCaptionBarText().
+ * 
+ * @param wParam Nonzero to play the error sound.
+ * @param lParam The CString to display, allocated by the poster and freed here.
+ * @return Always 0.
+ */
+LRESULT CMainFrame::OnCaptionBarText(WPARAM wParam, LPARAM lParam)
+{
+	CString* pMessage = reinterpret_cast<CString*>(lParam);
+	SetCaptionBarText(*pMessage);
+	delete pMessage;
+	if (wParam != 0)
+	{
+		MessageBeep(MB_ICONERROR);
+	}
+	return 0;
+}
+
 /**
  * @brief Hides the caption bar.
  * 
@@ -412,39 +876,30 @@ bool CMainFrame::HideMessageBar()
 }
 
 /**
- * @brief Adds text to the active view's edit control.
- * 
- * Appends text to the end of the edit control with proper line ending normalization:
- * - Converts all line endings to CRLF (Windows standard)
- * - Handles CRLF, CR, and LF input formats
- * - Appends to the end of existing text
- * - Maintains cursor position at the end
+ * @brief Adds text to the terminal view.
  * 
  * @param strText The text to add to the view.
- * @return true if successful (always returns true).
+ * @return true if successful, false if there is no document.
  */
 bool CMainFrame::AddText(CString strText)
 {
-	// Normalize line endings to Windows standard (CRLF)
-	// Step 1: Convert CRLF (\r\n) to LF (\n) to avoid double conversion
-	strText.Replace(CRLF, LF);
-	// Step 2: Convert any remaining CR (\r) to LF (\n)
-	strText.Replace(CR, LF);
-	// Step 3: Convert all LF (\n) to CRLF (\r\n) for Windows
-	strText.Replace(LF, CRLF);
-
-	// Get reference to the edit control in the active view
-	CEdit& pEdit = reinterpret_cast<CEditView*>(GetActiveView())->GetEditCtrl();
-	// Get current text length to find end position
-	int outLength = pEdit.GetWindowTextLength();
-	// Move cursor to the end of existing text
-	pEdit.SetSel(outLength, outLength);
-	// Insert new text at cursor position (with undo support)
-	pEdit.ReplaceSel(strText, TRUE);
-	// Reset selection (deselect text)
-	pEdit.SetSel(-1, 0);
+	return AddText(strText.GetString(), strText.GetLength());
+}
 
-	return true;
+/**
+ * @brief Adds text to the terminal view.
+ * 
+ * The document normalizes the line endings, appends the text to its
+ * scrollback and lets the view scroll to the end and repaint.
+ * 
+ * @param pText The text to add to the view (need not be null-terminated).
+ * @param nLength Number of characters to add.
+ * @return true if successful, false if there is no document.
+ */
+bool CMainFrame::AddText(LPCWSTR pText, int nLength)
+{
+	CIntelliPortDoc* pDocument = reinterpret_cast<CIntelliPortDoc*>(GetActiveDocument());
+	return (pDocument != nullptr) && pDocument->AddText(pText, nLength);
 }
 
 // CMainFrame diagnostics
@@ -583,12 +1038,12 @@ void CMainFrame::OnConfigureSerialPort()
  * Creates and opens the appropriate connection type:
  * 
  * Serial Port (Connection Type 0):
- * - Opens the COM port with configured parameters
+ * - Opens the COM port in overlapped mode with configured parameters
  * - Starts SerialPortThreadFunc in a background thread
  * 
  * TCP Socket (Connection Type 1):
  * - Client mode: Connects to the configured server
- * - Server mode: Binds, listens, and accepts incoming connection
+ * - Server mode: Binds and listens; the socket thread accepts any number of clients
  * - Starts SocketThreadFunc in a background thread
  * 
  * UDP Socket (Connection Type 2):
@@ -607,31 +1062,50 @@ void CMainFrame::OnOpenSerialPort()
 		{
 			case 0: // Serial Port Connection
 			{
-				// Windows requires \\.\COMx format for COM ports >= 10
-				CString strFullPortName;
-				strFullPortName.Format(_T("\\\\.\\%s"), static_cast<LPCWSTR>(theApp.m_strSerialName));
-
-				// Open the serial port with all configured parameters
-				// FALSE = non-overlapped (synchronous) mode
-				m_pSerialPort.Open(
-					strFullPortName,
-					theApp.m_nBaudRate,                             // Baud rate (e.g., 9600, 115200)
-					(CSerialPort::Parity) theApp.m_nParity,         // Parity (None, Odd, Even)
-					(BYTE)theApp.m_nDataBits,                       // Data bits (7 or 8)
-					(CSerialPort::StopBits) theApp.m_nStopBits,     // Stop bits (1, 1.5, or 2)
-					(CSerialPort::FlowControl) theApp.m_nFlowControl, // Flow control
-					FALSE);
-
-				if (m_pSerialPort.IsOpen())
+				// Open the serial port with all configured parameters; the transport
+				// opens it in overlapped mode, as needed by the event-driven reader
+				CSerialTransportSettings pSettings;
+				pSettings.nBaudRate = theApp.m_nBaudRate;                 // Baud rate (e.g., 9600, 115200)
+				pSettings.nDataBits = (unsigned char)theApp.m_nDataBits;  // Data bits (7 or 8)
+				pSettings.nParity = theApp.m_nParity;                     // Parity (None, Odd, Even)
+				pSettings.nStopBits = theApp.m_nStopBits;                 // Stop bits (1, 1.5, or 2)
+				pSettings.nFlowControl = theApp.m_nFlowControl;           // Flow control
+				if (!m_pSerialTransport.Open(CT2A(theApp.m_strSerialName, CP_UTF8), pSettings))
+				{
+					CSerialPort::ThrowSerialException(m_pSerialTransport.GetLastErrorCode());
+				}
+
+				if (m_pSerialTransport.IsOpen())
 				{
+					// Hand the port to the reader engine used by the background thread
+					m_pSerialReader.Attach(m_pSerialTransport);
+					// Favor time-to-first-byte or throughput, as configured: the reads are
+					// sized and timed for it, and the driver is asked not to batch bytes
+					m_pSerialReader.SetLatencyProfile(theApp.m_bLowLatency, theApp.m_nBaudRate);
+					const bool bLowLatencyRefused = !m_pSerialTransport.SetLowLatency(theApp.m_bLowLatency) && theApp.m_bLowLatency;
+					// Measure the latency and overflow of this connection only
+					ResetReceiveBuffer();
+					// Record the session if a capture folder is configured
+					StartCapture();
+					// Send from the writer thread from now on
+					StartWriteQueue();
 					// Set flag to keep thread running
 					m_nThreadRunning = true;
 					// Create background thread to read incoming data
 					m_hSerialPortThread = CreateThread(nullptr, 0, SerialPortThreadFunc, this, 0, &m_nSerialPortThreadID);
 
-					// Show success message in caption bar
-					VERIFY(strFormat.LoadString(IDS_SERIAL_PORT_OPENED));
-					strMessage.Format(strFormat, static_cast<LPCWSTR>(theApp.m_strSerialName));
+					// Show success message in caption bar, or that the port runs without the low latency mode
+					if (bLowLatencyRefused)
+					{
+						VERIFY(strFormat.LoadString(IDS_LOW_LATENCY_FAILED));
+						strMessage.Format(strFormat, static_cast<LPCWSTR>(theApp.m_strSerialName), m_pSerialTransport.GetLastErrorCode());
+						MessageBeep(MB_ICONWARNING);
+					}
+					else
+					{
+						VERIFY(strFormat.LoadString(IDS_SERIAL_PORT_OPENED));
+						strMessage.Format(strFormat, static_cast<LPCWSTR>(theApp.m_strSerialName));
+					}
 					SetCaptionBarText(strMessage);
 				}
 				break;
@@ -654,24 +1128,13 @@ void CMainFrame::OnOpenSerialPort()
 					}
 					else // TCP Server
 					{
-						// Set up TCP server to accept incoming connections
-						// Bind to specified local IP address and port
-						m_pSocket.SetBindAddress(strClientIP);
-						// Create socket with SOCK_STREAM (TCP) type
-						m_pSocket.CreateAndBind(nClientPort, SOCK_STREAM, AF_INET);
-
-						// Display "waiting for connection" dialog
-						m_dlgIncoming.ShowWindow(SW_SHOW);
-						m_dlgIncoming.CenterWindow(this);
-						m_dlgIncoming.Invalidate();
-						m_dlgIncoming.UpdateWindow();
-
-						// Listen for incoming connections (backlog = 5)
-						m_pSocket.Listen();
-						// Block until a client connects (stores in m_pIncomming)
-						m_pSocket.Accept(m_pIncomming);
-						// Hide the waiting dialog
-						m_dlgIncoming.ShowWindow(SW_HIDE);
+						// Listen on the local IP address and port; clients are
+						// accepted by the socket thread, any number at a time
+						m_pTcpServer.Open(strClientIP, nClientPort);
+
+						// For a TCP server, use client IP/port for display
+						strServerIP = strClientIP;
+						nServerPort = nClientPort;
 					}
 				}
 				else // UDP Socket
@@ -681,14 +1144,39 @@ void CMainFrame::OnOpenSerialPort()
 					m_pSocket.SetBindAddress(strClientIP);
 					// Create socket with SOCK_DGRAM (UDP) type
 					m_pSocket.CreateAndBind(nClientPort, SOCK_DGRAM, AF_INET);
+					// Look the destination up once rather than for every datagram;
+					// again after UdpResolveSeconds, in case its address changes
+					const uint32_t nTimeToLive = static_cast<uint32_t>(std::clamp(theApp.GetInt(_T("UdpResolveSeconds"), 60), 0, 86400));
+					const int nError = m_pServerEndpoint.Resolve(strServerIP, nServerPort, AF_INET, nTimeToLive);
+					if (nError != 0)
+					{
+						m_pSocket.Close();
+						CWSocket::ThrowWSocketException(nError);
+					}
 
 					// For UDP, use client IP/port for display
 					strServerIP = strClientIP;
 					nServerPort = nClientPort;
 				}
 
-				if (m_pSocket.IsCreated())
+				if (m_pSocket.IsCreated() || m_pTcpServer.IsOpen())
 				{
+					// The reactor must exist before OnCloseSerialPort may stop it
+					if (!m_pSocketReactor.Create())
+					{
+						CWSocket::ThrowWSocketException();
+					}
+					if (m_pTcpServer.IsOpen() && !m_pTcpServer.Attach(this, m_pSocketReactor))
+					{
+						m_pTcpServer.Close();
+						CWSocket::ThrowWSocketException();
+					}
+					// Measure the latency and overflow of this connection only
+					ResetReceiveBuffer();
+					// Record the session if a capture folder is configured
+					StartCapture();
+					// Send from the writer thread from now on
+					StartWriteQueue();
 					// Set flag to keep thread running
 					m_nThreadRunning = true;
 					// Create background thread to read incoming data
@@ -731,7 +1219,10 @@ void CMainFrame::OnOpenSerialPort()
  * 
  * Performs graceful shutdown of the connection:
  * - Sets m_nThreadRunning to false to signal thread termination
+ * - Stops the serial reader, cancelling its pending overlapped I/O
+ * - Stops the socket reactor, waking the socket thread at once
  * - Waits for all background threads to complete (INFINITE timeout)
+ * - Closes the session capture file, if any
  * - Closes serial port or socket resources
  * - Displays confirmation message in caption bar
  * 
@@ -740,11 +1231,27 @@ void CMainFrame::OnOpenSerialPort()
  */
 void CMainFrame::OnCloseSerialPort()
 {
+	// The replay and the traffic test write through the connection: stop them first
+	m_pCaptureReplay.Stop();
+	StopTrafficTest();
+	// Write what is still queued, unless the connection does not take it at once
+	m_pWriteQueue.Stop(true);
+
 	// Signal threads to stop running
 	if (m_nThreadRunning)
 	{
 		// Set flag to false - threads will check this and exit
 		m_nThreadRunning = false;
+		// The serial thread blocks on port events rather than polling the flag
+		if (m_hSerialPortThread != nullptr)
+		{
+			m_pSerialReader.Stop();
+		}
+		// The socket thread sleeps in the socket reactor: wake it up
+		if (m_hSocketThread != nullptr)
+		{
+			m_pSocketReactor.Stop();
+		}
 		DWORD nThreadCount = 0;
 		HANDLE hThreadArray[2] = { 0, 0 };
 
@@ -765,6 +1272,10 @@ void CMainFrame::OnCloseSerialPort()
 			WaitForMultipleObjects(nThreadCount, hThreadArray, TRUE, INFINITE);
 		}
 	}
+	// The reading threads have stopped: write out the rest of the capture
+	m_pReceiveBuffer.SetCapture(nullptr);
+	m_pDatagramQueue.SetCapture(nullptr);
+	m_pCapture.Close();
 
 	try
 	{
@@ -773,7 +1284,7 @@ void CMainFrame::OnCloseSerialPort()
 		{
 			case 0: // Serial Port
 			{
-				if (!m_pSerialPort.IsOpen())
+				if (!m_pSerialTransport.IsOpen())
 				{
 					VERIFY(strFormat.LoadString(IDS_SERIAL_PORT_CLOSED));
 					strMessage.Format(strFormat, static_cast<LPCWSTR>(theApp.m_strSerialName));
@@ -789,9 +1300,9 @@ void CMainFrame::OnCloseSerialPort()
 				CString strClientIP = theApp.m_strClientIP;
 				UINT nClientPort = theApp.m_nClientPort;
 
-				if (!m_pSocket.IsCreated())
+				if (!m_pSocket.IsCreated() && !m_pTcpServer.IsOpen())
 				{
-					if (theApp.m_nConnection == 2) // UDP Socket
+					if ((theApp.m_nConnection == 2) || (theApp.m_nSocketType != 1)) // UDP Socket or TCP Server
 					{
 						strServerIP = strClientIP;
 						nServerPort = nClientPort;
@@ -827,23 +1338,19 @@ void CMainFrame::OnCloseSerialPort()
 }
 
 /**
- * @brief Displays the input dialog and sends data through the active connection.
+ * @brief Displays the input dialog and queues the data for the active connection.
  * 
  * Shows a modal input dialog for the user to enter data to send:
  * - Converts Unicode input to UTF-8 for transmission
- * - Sends data through the appropriate connection type:
- *   * Serial Port: Uses CSerialPort::Write()
- *   * TCP Client: Uses CWSocket::Send()
- *   * TCP Server: Uses incoming socket Send()
- *   * UDP: Uses CWSocket::SendTo() with configured server address
+ * - Hands the bytes to the write queue and returns at once; the writer thread
+ *   sends them through the connection (see WriteQueued())
  * 
- * Uses mutex locking to prevent conflicts with reading thread.
+ * The window never waits for a slow device or a full TCP window: when too much
+ * is already waiting, the queue refuses the data and the caption bar says so.
  * Plays a beep sound on success or error.
- * Displays error messages in caption bar if transmission fails.
  */
 void CMainFrame::OnSendReceive()
 {
-	int nLength = 0;
 	// Show input dialog for user to enter data
 	CInputDlg dlgInput(this);
 	if (dlgInput.DoModal() == IDOK)
@@ -851,128 +1358,327 @@ void CMainFrame::OnSendReceive()
 		// Convert Unicode (UTF-16) to UTF-8 for transmission
 		// Most serial/network protocols use UTF-8 encoding
 		const std::wstring strRawText(dlgInput.m_strSendData);
-		CStringA pBuffer(wstring_to_utf8(strRawText).c_str());
-		nLength = pBuffer.GetLength();
+		const std::string pBuffer(wstring_to_utf8(strRawText));
 
-		if (nLength > 0)
+		if (!pBuffer.empty())
 		{
-			switch (theApp.m_nConnection)
+			CString strMessage;
+			switch (m_pWriteQueue.Enqueue(pBuffer.data(), pBuffer.size()))
 			{
-				case 0: // Serial Port
+				case WRITE_QUEUED:
 				{
-					// Lock mutex to prevent conflicts with reading thread
-					m_pMutualAccess.lock();
-					try
-					{
-						// Write data to serial port
-						m_pSerialPort.Write(pBuffer.GetBuffer(nLength), nLength);
-						pBuffer.ReleaseBuffer();
-					}
-					catch (CSerialException& pException)
-					{
-						const int nErrorLength = 0x100;
-						TCHAR lpszErrorMessage[nErrorLength] = { 0, };
-						pException.GetErrorMessage2(lpszErrorMessage, nErrorLength);
-						TRACE(_T("%s\n"), lpszErrorMessage);
-						SetCaptionBarText(lpszErrorMessage);
-						m_nThreadRunning = false;
-						MessageBeep(MB_ICONERROR);
-					}
-					// Release mutex lock
-					m_pMutualAccess.unlock();
 					// Play success sound
 					MessageBeep(MB_OK);
 					break;
 				}
-				case 1: // TCP Socket
-				case 2: // UDP Socket
+				case WRITE_QUEUE_FULL: // back-pressure: the connection has not caught up
 				{
-					CString strServerIP = theApp.m_strServerIP;
-					const UINT nServerPort = theApp.m_nServerPort;
+					VERIFY(strMessage.LoadString(IDS_WRITE_QUEUE_FULL));
+					SetCaptionBarText(strMessage);
+					MessageBeep(MB_ICONERROR);
+					break;
+				}
+				default: // no connection, or a write failed
+				{
+					MessageBeep(MB_ICONERROR);
+					break;
+				}
+			}
+		}
+	}
+}
+
+/**
+ * @brief Starts the writer thread of the write queue for the new connection.
+ * 
+ * UDP keeps one datagram per send; the other connections coalesce small sends.
+ * The WriteQueueKB setting bounds the bytes waiting (4 MB by default).
+ */
+void CMainFrame::StartWriteQueue()
+{
+	const size_t nCapacity = static_cast<size_t>(std::clamp(theApp.GetInt(_T("WriteQueueKB"), 4096), 64, 0x100000)) << 10;
+	m_pWriteQueue.Start([this](const CWriteSpan* pSpans, int nCount) { return WriteQueued(pSpans, nCount); },
+		(theApp.m_nConnection == 2), nCapacity);
+}
 
-					if (theApp.m_nConnection == 1) // TCP Socket
+/**
+ * @brief Sends a batch of queued bytes through the active connection.
+ * 
+ * Called on the write queue's thread with up to WRITE_QUEUE_MAX_GATHER spans:
+ * - Serial Port: ISerialTransport::WriteGather() of all spans, which hands
+ *   every span to the driver before waiting for the first
+ * - TCP Client: one gather WSASend for all spans (see WriteGather())
+ * - TCP Server: CTcpServer::Broadcast() of each span, which only queues the
+ *   bytes for every client and never blocks
+ * - UDP: CWSocket::SendToMany() of all spans, one datagram each, to the
+ *   destination looked up when the socket was created
+ * 
+ * Runs on the writer thread only, which is the single writer of the active
+ * connection, so no lock is taken. Records the sent bytes in the session
+ * capture, if one is open. A write stuck on the device is cancelled when the
+ * queue is being stopped.
+ * 
+ * @param pSpans The bytes to send.
+ * @param nCount Number of spans.
+ * @return true if every byte was sent; false closes the queue.
+ */
+bool CMainFrame::WriteQueued(const CWriteSpan* pSpans, int nCount)
+{
+	try
+	{
+		switch (theApp.m_nConnection)
+		{
+			case 0: // Serial Port
+			{
+				CSerialTransportSpan pBuffers[CWriteQueue::WRITE_QUEUE_MAX_GATHER];
+				for (int nIndex = 0; nIndex < nCount; nIndex++)
+				{
+					pBuffers[nIndex].pData = pSpans[nIndex].pData;
+					pBuffers[nIndex].nLength = pSpans[nIndex].nLength;
+				}
+				// A write stuck on the device is cancelled once the queue is being stopped
+				if (!m_pSerialTransport.WriteGather(pBuffers, nCount, [this]() { return !m_pWriteQueue.IsStopping(); }))
+				{
+					if (m_pWriteQueue.IsStopping())
 					{
-						if (theApp.m_nSocketType == 1) // TCP Client
-						{
-							if (m_pSocket.IsWritable(1000))
-							{
-								m_pMutualAccess.lock();
-								try
-								{
-									m_pSocket.Send(pBuffer.GetBuffer(nLength), nLength, 0);
-									pBuffer.ReleaseBuffer();
-								}
-								catch (CWSocketException* pException)
-								{
-									const int nErrorLength = 0x100;
-									TCHAR lpszErrorMessage[nErrorLength] = { 0, };
-									pException->GetErrorMessage(lpszErrorMessage, nErrorLength);
-									TRACE(_T("%s\n"), lpszErrorMessage);
-									pException->Delete();
-									SetCaptionBarText(lpszErrorMessage);
-									m_nThreadRunning = false;
-									MessageBeep(MB_ICONERROR);
-								}
-								m_pMutualAccess.unlock();
-								MessageBeep(MB_OK);
-							}
-						}
-						else // TCP Server
-						{
-							if (m_pIncomming.IsWritable(1000))
-							{
-								m_pMutualAccess.lock();
-								try
-								{
-									m_pIncomming.Send(pBuffer.GetBuffer(nLength), nLength, 0);
-									pBuffer.ReleaseBuffer();
-								}
-								catch (CWSocketException* pException)
-								{
-									const int nErrorLength = 0x100;
-									TCHAR lpszErrorMessage[nErrorLength] = { 0, };
-									pException->GetErrorMessage(lpszErrorMessage, nErrorLength);
-									TRACE(_T("%s\n"), lpszErrorMessage);
-									pException->Delete();
-									SetCaptionBarText(lpszErrorMessage);
-									m_nThreadRunning = false;
-									MessageBeep(MB_ICONERROR);
-								}
-								m_pMutualAccess.unlock();
-								MessageBeep(MB_OK);
-							}
-						}
+						return false;
 					}
-					else // UDP Socket
+					CSerialPort::ThrowSerialException(m_pSerialTransport.GetLastErrorCode());
+				}
+				break;
+			}
+			case 1: // TCP Socket
+			case 2: // UDP Socket
+			{
+				if ((theApp.m_nConnection == 1) && (theApp.m_nSocketType != 1)) // TCP Server
+				{
+					// Queue for every connected client; the server records what it broadcasts itself
+					for (int nIndex = 0; nIndex < nCount; nIndex++)
+					{
+						m_pTcpServer.Broadcast(pSpans[nIndex].pData, static_cast<size_t>(pSpans[nIndex].nLength));
+					}
+					return true;
+				}
+				if (theApp.m_nConnection == 1) // TCP Client
+				{
+					if (!WriteGather(m_pSocket, pSpans, nCount, [this]() { return !m_pWriteQueue.IsStopping(); }))
 					{
-						if (m_pSocket.IsWritable(1000))
+						if (m_pWriteQueue.IsStopping())
 						{
-							m_pMutualAccess.lock();
-							try
-							{
-								m_pSocket.SendTo(pBuffer.GetBuffer(nLength), nLength, nServerPort, strServerIP, 0);
-								pBuffer.ReleaseBuffer();
-							}
-							catch (CWSocketException* pException)
-							{
-								const int nErrorLength = 0x100;
-								TCHAR lpszErrorMessage[nErrorLength] = { 0, };
-								pException->GetErrorMessage(lpszErrorMessage, nErrorLength);
-								TRACE(_T("%s\n"), lpszErrorMessage);
-								pException->Delete();
-								SetCaptionBarText(lpszErrorMessage);
-								m_nThreadRunning = false;
-								MessageBeep(MB_ICONERROR);
-							}
-							m_pMutualAccess.unlock();
-							MessageBeep(MB_OK);
+							return false;
 						}
+						CWSocket::ThrowWSocketException();
 					}
-					break;
 				}
+				else // UDP Socket
+				{
+					CUdpDatagram pDatagrams[CWriteQueue::WRITE_QUEUE_MAX_GATHER];
+					for (int nIndex = 0; nIndex < nCount; nIndex++)
+					{
+						pDatagrams[nIndex].pData = pSpans[nIndex].pData;
+						pDatagrams[nIndex].nLength = pSpans[nIndex].nLength;
+					}
+					m_pSocket.SendToMany(pDatagrams, nCount, m_pServerEndpoint, 0);
+				}
+				break;
 			}
 		}
+		for (int nIndex = 0; nIndex < nCount; nIndex++)
+		{
+			m_pCapture.Append(CAPTURE_SENT, 0, pSpans[nIndex].pData, pSpans[nIndex].nLength);
+		}
+		return true;
+	}
+	catch (CSerialException& pException)
+	{
+		const int nErrorLength = 0x100;
+		TCHAR lpszErrorMessage[nErrorLength] = { 0, };
+		pException.GetErrorMessage2(lpszErrorMessage, nErrorLength);
+		TRACE(_T("%s\n"), lpszErrorMessage);
+		PostCaptionBarText(lpszErrorMessage, true);
+	}
+	catch (CWSocketException* pException)
+	{
+		const int nErrorLength = 0x100;
+		TCHAR lpszErrorMessage[nErrorLength] = { 0, };
+		pException->GetErrorMessage(lpszErrorMessage, nErrorLength);
+		TRACE(_T("%s\n"), lpszErrorMessage);
+		pException->Delete();
+		PostCaptionBarText(lpszErrorMessage, true);
+	}
+	return false;
+}
+
+/**
+ * @brief Replays a capture file through the active connection, or stops the running replay.
+ * 
+ * Asks for a capture file (see CaptureFile.h) and hands it to the replay engine,
+ * which queues its records from its own thread through SendBytes(). The engine
+ * is tuned by three settings:
+ * - ReplayTiming: 0 = original timing, 1 = scaled timing, 2 = as fast as possible
+ * - ReplaySpeedPercent: speed of the scaled timing (200 = twice as fast)
+ * - ReplayDirection: 0 = received bytes, 1 = sent bytes, -1 = both
+ * 
+ * MSG_REPLAY_FINISHED reports the result when the engine ends.
+ */
+void CMainFrame::OnReplayCapture()
+{
+	if (m_pCaptureReplay.IsRunning())
+	{
+		m_pCaptureReplay.Stop();
+		return;
+	}
+
+	CFileDialog dlgFile(TRUE, _T("ipcap"), nullptr, OFN_FILEMUSTEXIST | OFN_HIDEREADONLY,
+		_T("Capture Files (*.ipcap)|*.ipcap|All Files (*.*)|*.*||"), this);
+	if (dlgFile.DoModal() != IDOK)
+	{
+		return;
+	}
+	const CString strPath = dlgFile.GetPathName();
+	const int nTiming = std::clamp(theApp.GetInt(_T("ReplayTiming"), CCaptureReplay::REPLAY_ORIGINAL),
+		static_cast<int>(CCaptureReplay::REPLAY_ORIGINAL), static_cast<int>(CCaptureReplay::REPLAY_MAX_SPEED));
+	const int nSpeedPercent = std::clamp(theApp.GetInt(_T("ReplaySpeedPercent"), 100), 1, 100000);
+	const int nDirection = std::clamp(theApp.GetInt(_T("ReplayDirection"), CAPTURE_RECEIVED),
+		CCaptureReplay::REPLAY_DIRECTION_ALL, static_cast<int>(CAPTURE_SENT));
+
+	const HWND hWnd = GetSafeHwnd();
+	CString strFormat, strMessage;
+	if (m_pCaptureReplay.Start(strPath, static_cast<CCaptureReplay::ReplayTiming>(nTiming), nSpeedPercent / 100.0, nDirection, 0,
+		[this](const char* pData, size_t nLength) { return SendBytes(pData, nLength, [this]() { return !m_pCaptureReplay.IsStopping(); }); },
+		[hWnd]() { ::PostMessage(hWnd, MSG_REPLAY_FINISHED, 0, 0); }))
+	{
+		VERIFY(strFormat.LoadString(IDS_REPLAY_STARTED));
 	}
+	else
+	{
+		VERIFY(strFormat.LoadString(IDS_REPLAY_FAILED));
+	}
+	strMessage.Format(strFormat, static_cast<LPCWSTR>(strPath));
+	SetStatusBarText(strMessage);
+}
+
+/**
+ * @brief Queues bytes from a worker thread for the active connection.
+ * 
+ * Called on the replay engine's and the traffic generator's threads. The bytes
+ * go through the write queue like OnSendReceive()'s, so the writer thread sends
+ * and records them; nothing here waits for the device or the socket. While the
+ * queue is full the call waits for room, and gives up as soon as pfnContinue
+ * returns false, so the replay or the test can always be stopped. A failed
+ * write closes the queue, which ends the replay or the test.
+ * 
+ * @param pData The bytes to send.
+ * @param nLength Number of bytes.
+ * @param pfnContinue Returns false when the caller is being stopped.
+ * @return true if the bytes were queued.
+ */
+bool CMainFrame::SendBytes(const char* pData, size_t nLength, const std::function<bool()>& pfnContinue)
+{
+	return (m_pWriteQueue.EnqueueWait(pData, nLength, pfnContinue) == WRITE_QUEUED);
+}
+
+/**
+ * @brief Starts or stops the traffic test.
+ * 
+ * The test sends sequence-numbered, checksummed frames (see TrafficGenerator.h)
+ * queued from the generator's thread through SendBytes(), and scans everything received
+ * for frames, its own echoed back or another instance's. Received data is not
+ * displayed meanwhile. The status bar reports throughput, loss, reordering,
+ * duplication and latency every second and when the test is stopped. The test
+ * is tuned by three settings:
+ * - TrafficFrameRate: frames per second, 0 = as fast as the connection takes them
+ * - TrafficPayloadSize: payload bytes per frame (frames add 36 bytes)
+ * - TrafficFrameCount: frames to send, 0 = until the test is stopped
+ */
+void CMainFrame::OnTrafficTest()
+{
+	if (m_bTrafficTest)
+	{
+		StopTrafficTest();
+		return;
+	}
+
+	const int nFrameRate = std::clamp(theApp.GetInt(_T("TrafficFrameRate"), 1000), 0, 1000000);
+	const int nPayloadSize = std::clamp(theApp.GetInt(_T("TrafficPayloadSize"), 64), 0, static_cast<int>(TRAFFIC_MAX_PAYLOAD));
+	const int nFrameCount = std::max(theApp.GetInt(_T("TrafficFrameCount"), 0), 0);
+
+	// A new session id for every run, so a late frame of the previous run is told apart
+	std::random_device pRandom;
+	uint32_t nSession = 0;
+	while (nSession == 0)
+	{
+		nSession = pRandom();
+	}
+	m_pTrafficChecker.Reset(nSession);
+	m_pReceiveBuffer.SetTrafficChecker(&m_pTrafficChecker);
+	m_pDatagramQueue.SetTrafficChecker(&m_pTrafficChecker);
+	m_bTrafficTest = true;
+	m_pTrafficGenerator.Start(nSession, nPayloadSize, nFrameRate, nFrameCount, (theApp.m_nConnection == 2),
+		[this](const char* pData, size_t nLength) { return SendBytes(pData, nLength, [this]() { return !m_pTrafficGenerator.IsStopping(); }); }, nullptr);
+	UpdateTrafficStatus();
+}
+
+/**
+ * @brief Stops the traffic test, if running, and shows its final statistics.
+ */
+void CMainFrame::StopTrafficTest()
+{
+	if (m_bTrafficTest)
+	{
+		m_pTrafficGenerator.Stop();
+		m_pReceiveBuffer.SetTrafficChecker(nullptr);
+		m_pDatagramQueue.SetTrafficChecker(nullptr);
+		UpdateTrafficStatus();
+		m_bTrafficTest = false;
+	}
+}
+
+/**
+ * @brief Shows the traffic test statistics in the status bar.
+ * 
+ * The latency is the round-trip time when this instance's frames come back
+ * (an echo or a loopback plug), otherwise the one-way time, which is only
+ * meaningful when the sender runs on the same machine.
+ */
+void CMainFrame::UpdateTrafficStatus()
+{
+	const CTrafficGeneratorStats pSent = m_pTrafficGenerator.GetStats();
+	const CTrafficCheckerStats pReceived = m_pTrafficChecker.GetStats();
+	const CLatencyHistogram& pLatency = (pReceived.pRoundTrip.GetCount() != 0) ? pReceived.pRoundTrip : pReceived.pOneWay;
+	const double dSentRate = (pSent.nElapsed != 0) ? (pSent.nBytes / 1024.0 / (pSent.nElapsed / 1e9)) : 0.0;
+	const double dReceivedRate = (pReceived.nElapsed != 0) ? (pReceived.nBytes / 1024.0 / (pReceived.nElapsed / 1e9)) : 0.0;
+	CString strFormat, strMessage;
+	VERIFY(strFormat.LoadString(IDS_TRAFFIC_STATUS));
+	strMessage.Format(strFormat, pSent.nFrames, dSentRate, pReceived.nFrames, dReceivedRate,
+		pReceived.nLost, pReceived.nReordered, pReceived.nDuplicates, pReceived.nCorrupt,
+		pLatency.GetPercentile(50), pLatency.GetPercentile(99));
+	SetStatusBarText(strMessage);
+}
+
+/**
+ * @brief Handles MSG_REPLAY_FINISHED posted when the replay engine ends.
+ * 
+ * Shows what the replay achieved in the status bar: records and bytes sent,
+ * the elapsed time and rate, and the lateness of the sends against the
+ * capture's timing (not measured when replaying as fast as possible).
+ * 
+ * @param wParam Not used.
+ * @param lParam Not used.
+ * @return Always 0.
+ */
+LRESULT CMainFrame::OnReplayFinished(WPARAM /*wParam*/, LPARAM /*lParam*/)
+{
+	m_pCaptureReplay.Stop();
+	const CCaptureReplayStats pStats = m_pCaptureReplay.GetStats();
+	const double dSeconds = pStats.nElapsed / 1e9;
+	const double dRate = (dSeconds > 0.0) ? (pStats.nBytes / 1024.0 / dSeconds) : 0.0;
+	CString strFormat, strMessage;
+	VERIFY(strFormat.LoadString(IDS_REPLAY_FINISHED));
+	strMessage.Format(strFormat, pStats.nRecords, pStats.nBytes, dSeconds, dRate,
+		pStats.pTimingError.GetPercentile(50), pStats.pTimingError.GetPercentile(99), pStats.pTimingError.GetMaximum());
+	SetStatusBarText(strMessage);
+	return 0;
 }
 
 /**
@@ -985,7 +1691,7 @@ void CMainFrame::OnSendReceive()
  */
 void CMainFrame::OnUpdateConfigureSerialPort(CCmdUI* pCmdUI)
 {
-	pCmdUI->Enable(!m_pSerialPort.IsOpen() && !m_pSocket.IsCreated());
+	pCmdUI->Enable(!m_pSerialTransport.IsOpen() && !m_pSocket.IsCreated() && !m_pTcpServer.IsOpen());
 }
 
 /**
@@ -998,7 +1704,7 @@ void CMainFrame::OnUpdateConfigureSerialPort(CCmdUI* pCmdUI)
  */
 void CMainFrame::OnUpdateOpenSerialPort(CCmdUI* pCmdUI)
 {
-	pCmdUI->Enable(!m_pSerialPort.IsOpen() && !m_pSocket.IsCreated());
+	pCmdUI->Enable(!m_pSerialTransport.IsOpen() && !m_pSocket.IsCreated() && !m_pTcpServer.IsOpen());
 }
 
 /**
@@ -1011,7 +1717,7 @@ void CMainFrame::OnUpdateOpenSerialPort(CCmdUI* pCmdUI)
  */
 void CMainFrame::OnUpdateCloseSerialPort(CCmdUI* pCmdUI)
 {
-	pCmdUI->Enable(m_pSerialPort.IsOpen() || m_pSocket.IsCreated());
+	pCmdUI->Enable(m_pSerialTransport.IsOpen() || m_pSocket.IsCreated() || m_pTcpServer.IsOpen());
 }
 
 /**
@@ -1024,17 +1730,46 @@ void CMainFrame::OnUpdateCloseSerialPort(CCmdUI* pCmdUI)
  */
 void CMainFrame::OnUpdateSendReceive(CCmdUI* pCmdUI)
 {
-	pCmdUI->Enable(m_pSerialPort.IsOpen() || m_pSocket.IsCreated());
+	pCmdUI->Enable(m_pSerialTransport.IsOpen() || m_pSocket.IsCreated() || m_pTcpServer.IsOpen());
+}
+
+/**
+ * @brief Updates the UI state for the replay command.
+ * 
+ * Enables the replay menu item only when a connection is active, and checks
+ * it while a replay is running (choosing it again stops the replay).
+ * 
+ * @param pCmdUI Pointer to the CCmdUI object representing the menu item.
+ */
+void CMainFrame::OnUpdateReplayCapture(CCmdUI* pCmdUI)
+{
+	pCmdUI->Enable(m_pSerialTransport.IsOpen() || m_pSocket.IsCreated() || m_pTcpServer.IsOpen());
+	pCmdUI->SetCheck(m_pCaptureReplay.IsRunning());
+}
+
+/**
+ * @brief Updates the UI state for the traffic test command.
+ * 
+ * Enables the traffic test menu item only when a connection is active, and
+ * checks it while the test is running (choosing it again stops the test).
+ * 
+ * @param pCmdUI Pointer to the CCmdUI object representing the menu item.
+ */
+void CMainFrame::OnUpdateTrafficTest(CCmdUI* pCmdUI)
+{
+	pCmdUI->Enable(m_pSerialTransport.IsOpen() || m_pSocket.IsCreated() || m_pTcpServer.IsOpen());
+	pCmdUI->SetCheck(m_bTrafficTest);
 }
 
 /**
  * @brief Background thread function for reading data from the serial port.
  * 
- * Runs continuously while m_nThreadRunning is true:
- * - Checks serial port status to see if data is available (cbInQue)
- * - Reads available data into a local buffer (up to 4KB)
- * - Writes data to the ring buffer with mutex protection
- * - Handles CSerialException errors by displaying message and breaking loop
+ * Runs the CSerialReader engine until OnCloseSerialPort stops it:
+ * - Blocks on EV_RXCHAR while the port is idle (no polling, no CPU use)
+ * - Keeps several overlapped reads in flight while data is flowing
+ * - Writes data to the lock-free ring buffer (this thread is its only producer)
+ * - Notifies the UI thread that new data is available
+ * - Displays the error message if the port fails
  * 
  * Thread cleanup:
  * - Closes the serial port
@@ -1046,83 +1781,148 @@ void CMainFrame::OnUpdateSendReceive(CCmdUI* pCmdUI)
  */
 DWORD WINAPI SerialPortThreadFunc(LPVOID pParam)
 {
-	int nLength = 0;
-	COMSTAT status = { 0, };
-	char pBuffer[0x1000] = { 0, }; // 4KB buffer for reading
 	// Cast parameter to CMainFrame pointer
 	CMainFrame* pMainFrame = (CMainFrame*) pParam;
 	// Get references to shared resources
-	CRingBuffer& pRingBuffer = pMainFrame->m_pRingBuffer;
-	CSerialPort& pSerialPort = pMainFrame->m_pSerialPort;
-	std::mutex& pMutualAccess = pMainFrame->m_pMutualAccess;
+	CReceiveBuffer& pReceiveBuffer = pMainFrame->m_pReceiveBuffer;
+	CSerialTransport& pSerialTransport = pMainFrame->m_pSerialTransport;
+
+	// Block on port events until CMainFrame::OnCloseSerialPort stops the reader.
+	// No lock needed: this thread is the ring buffer's only producer
+	const DWORD dwError = pMainFrame->m_pSerialReader.Run(pReceiveBuffer,
+		[pMainFrame]() { pMainFrame->NotifyDataReady(); });
+	if (dwError != 0)
+	{
+		// Handle errors and notify user
+		const int nErrorLength = 0x100;
+		TCHAR lpszErrorMessage[nErrorLength] = { 0, };
+		CSerialException pException(dwError);
+		pException.GetErrorMessage2(lpszErrorMessage, nErrorLength);
+		TRACE(_T("%s\n"), lpszErrorMessage);
+		pMainFrame->PostCaptionBarText(lpszErrorMessage, true);
+	}
 
-	// Main reading loop - continues until thread is stopped
-	while (pMainFrame->m_nThreadRunning)
+	// Cleanup before thread exits
+	pSerialTransport.Close();
+	pMainFrame->m_nThreadRunning = false;
+	pMainFrame->m_hSerialPortThread = nullptr;
+	return 0;
+}
+
+/**
+ * @brief Receives whatever is waiting on a readable stream socket into the ring buffer.
+ * 
+ * Called by the socket reactor on the socket thread. Data is received directly
+ * into the free space of the lock-free ring buffer when the contiguous free
+ * space can hold a full-size chunk; otherwise it goes through a local buffer
+ * and the receive buffer's overflow policy decides whether to wait for room,
+ * drop bytes or spill them to disk.
+ * 
+ * @param pMainFrame The main frame owning the ring buffer.
+ * @param pSocket The readable socket.
+ * @return true to keep receiving, false when the peer closed or an error occurred.
+ */
+static bool ReceiveSocketData(CMainFrame* pMainFrame, CWSocket& pSocket)
+{
+	CReceiveBuffer& pReceiveBuffer = pMainFrame->m_pReceiveBuffer;
+	CRingBufferSpan pSpans[2];
+	char pBuffer[0x1000]; // 4KB fallback buffer
+
+	pReceiveBuffer.PrepareWrite(pSpans);
+	const bool bCopied = (pSpans[0].nLength < (int) sizeof(pBuffer));
+	char* pTarget = bCopied ? pBuffer : pSpans[0].pData;
+
+	int nLength = 0;
+	try
 	{
-		try
+		// TCP: read from the server connection
+		nLength = pSocket.Receive(pTarget, bCopied ? (int) sizeof(pBuffer) : pSpans[0].nLength, 0);
+		if (nLength == 0)
 		{
-			// Query serial port status to check for incoming data
-			memset(&status, 0, sizeof(status));
-			pSerialPort.GetStatus(status);
-			// cbInQue = number of bytes in input buffer
-			if (status.cbInQue > 0)
-			{
-				// Read available data from serial port
-				memset(pBuffer, 0, sizeof(pBuffer));
-				nLength = pSerialPort.Read(pBuffer, sizeof(pBuffer));
-			}
+			return false; // connection closed by the peer
 		}
-		catch (CSerialException& pException)
+	}
+	catch (CWSocketException* pException)
+	{
+		// Handle errors and notify user
+		const int nErrorLength = 0x100;
+		TCHAR lpszErrorMessage[nErrorLength] = { 0, };
+		pException->GetErrorMessage(lpszErrorMessage, nErrorLength);
+		TRACE(_T("%s\n"), lpszErrorMessage);
+		pException->Delete();
+		pMainFrame->PostCaptionBarText(lpszErrorMessage, true);
+		return false;
+	}
+
+	// If data was received, make it visible to the UI thread
+	if (nLength > 0)
+	{
+		// No lock needed: this thread is the ring buffer's only producer
+		if (bCopied)
 		{
-			// Handle errors and notify user
-			const int nErrorLength = 0x100;
-			TCHAR lpszErrorMessage[nErrorLength] = { 0, };
-			pException.GetErrorMessage2(lpszErrorMessage, nErrorLength);
-			TRACE(_T("%s\n"), lpszErrorMessage);
-			pMainFrame->SetCaptionBarText(lpszErrorMessage);
-			MessageBeep(MB_ICONERROR);
-			// Break out of loop on error
-			break;
+			pReceiveBuffer.Write(pBuffer, nLength, [pMainFrame]() { return pMainFrame->WaitForReceiveBuffer(); });
 		}
-
-		// If data was read, write it to the ring buffer
-		if (nLength > 0)
+		else
 		{
-			// Lock mutex to prevent conflicts with UI thread
-			pMutualAccess.lock();
-			pRingBuffer.WriteBinary(pBuffer, nLength);
-			pMutualAccess.unlock();
-			// Reset length for next iteration
-			nLength = 0;
+			pReceiveBuffer.CommitWrite(nLength);
 		}
+		// Wake the UI thread (coalesced with any notification still pending)
+		pMainFrame->NotifyDataReady();
 	}
+	return true;
+}
 
-	// Cleanup before thread exits
-	pSerialPort.Close();
-	pMainFrame->m_nThreadRunning = false;
-	pMainFrame->m_hSerialPortThread = nullptr;
-	return 0;
+/**
+ * @brief Receives the datagrams waiting on the UDP socket into the datagram queue.
+ * 
+ * Called by the socket reactor on the socket thread. A batch of datagrams is
+ * received at once into the preallocated slab of CDatagramReceiver, with the
+ * raw address of each sender and its CEndpointTable id, so no string is built
+ * and nothing is allocated per datagram. Each one is then queued whole, with
+ * its sender and arrival time, for DrainDatagramQueue() to display; one that
+ * finds the queue full is dropped and counted.
+ * 
+ * @param pMainFrame The main frame owning the ring buffer.
+ * @param pSocket The readable socket.
+ * @return true to keep receiving, false when a socket error occurred.
+ */
+static bool ReceiveDatagrams(CMainFrame* pMainFrame, CWSocket& pSocket)
+{
+	CDatagramReceiver& pDatagramReceiver = pMainFrame->m_pDatagramReceiver;
+	const int nCount = pDatagramReceiver.Receive(pSocket, pMainFrame->m_pEndpoints);
+	if (nCount < 0)
+	{
+		CWSocketException pException(WSAGetLastError());
+		const int nErrorLength = 0x100;
+		TCHAR lpszErrorMessage[nErrorLength] = { 0, };
+		pException.GetErrorMessage(lpszErrorMessage, nErrorLength);
+		TRACE(_T("%s\n"), lpszErrorMessage);
+		pMainFrame->PostCaptionBarText(lpszErrorMessage, true);
+		return false;
+	}
+
+	// No lock needed: this thread is the datagram queue's only producer
+	for (int nIndex = 0; nIndex < nCount; nIndex++)
+	{
+		pMainFrame->m_pDatagramQueue.Push(pDatagramReceiver.GetDatagram(nIndex));
+	}
+	if (nCount > 0)
+	{
+		pMainFrame->PostDataReady();
+	}
+	return true;
 }
 
 /**
  * @brief Background thread function for reading data from the socket.
  * 
- * Runs continuously while m_nThreadRunning is true:
- * 
- * TCP Client Mode:
- * - Checks if socket is readable with 1 second timeout
- * - Receives data from the connected server
- * 
- * TCP Server Mode:
- * - Checks if incoming connection socket is readable
- * - Receives data from the connected client
- * 
- * UDP Mode:
- * - Checks if socket is readable
- * - Receives datagram and source address
- * 
- * All received data is written to the ring buffer with mutex protection.
- * Handles CWSocketException errors by displaying message and breaking loop.
+ * Registers the connected socket (TCP client) or the bound socket (UDP) with
+ * the socket reactor and runs it; a TCP server has already registered its
+ * listening socket, and registers each client it accepts. The thread sleeps
+ * in a single kernel wait until data arrives, instead of making a select()
+ * call with a 1 second timeout before every receive, and returns at once when
+ * OnCloseSerialPort stops the reactor. A TCP client or UDP thread also ends
+ * when the peer closes the connection or a socket error occurs.
  * 
  * Thread cleanup:
  * - Closes all socket handles
@@ -1134,88 +1934,48 @@ DWORD WINAPI SerialPortThreadFunc(LPVOID pParam)
  */
 DWORD WINAPI SocketThreadFunc(LPVOID pParam)
 {
-	int nLength = 0;
-	char pBuffer[0x1000] = { 0, }; // 4KB buffer for reading
 	// Cast parameter to CMainFrame pointer
 	CMainFrame* pMainFrame = (CMainFrame*) pParam;
 	// Get references to shared resources
-	CRingBuffer& pRingBuffer = pMainFrame->m_pRingBuffer;
+	CSocketReactor& pReactor = pMainFrame->m_pSocketReactor;
 	CWSocket& pSocket = pMainFrame->m_pSocket;
-	CWSocket& pIncomming = pMainFrame->m_pIncomming;
-	std::mutex& pMutualAccess = pMainFrame->m_pMutualAccess;
+	CTcpServer& pTcpServer = pMainFrame->m_pTcpServer;
 	// Cache connection type to avoid repeated global access
-	bool bIsTCP = (theApp.m_nConnection == 1);
-	bool bIsClient = (theApp.m_nSocketType == 1);
+	const bool bIsTCP = (theApp.m_nConnection == 1);
 
-	// Variables for UDP source address
-	CString strServerIP = theApp.m_strServerIP;
-	UINT nServerPort = theApp.m_nServerPort;
-
-	// Main reading loop - continues until thread is stopped
-	while (pMainFrame->m_nThreadRunning)
+	if (pSocket.IsCreated())
 	{
-		try
+		if (!bIsTCP)
 		{
-			if (bIsTCP)
-			{
-				if (bIsClient)
-				{
-					// TCP Client: Read from server connection
-					// IsReadible checks if data is available (1 second timeout)
-					if (pSocket.IsReadible(1000))
-					{
-						memset(pBuffer, 0, sizeof(pBuffer));
-						nLength = pSocket.Receive(pBuffer, sizeof(pBuffer), 0);
-					}
-				}
-				else
-				{
-					// TCP Server: Read from accepted client connection
-					if (pIncomming.IsReadible(1000))
-					{
-						memset(pBuffer, 0, sizeof(pBuffer));
-						nLength = pIncomming.Receive(pBuffer, sizeof(pBuffer), 0);
-					}
-				}
-			}
-			else
-			{
-				// UDP: Read datagram (also returns sender's address)
-				if (pSocket.IsReadible(1000))
-				{
-					memset(pBuffer, 0, sizeof(pBuffer));
-					nLength = pSocket.ReceiveFrom(pBuffer, sizeof(pBuffer), strServerIP, nServerPort, 0);
-				}
-			}
+			// Ask for kernel arrival times
+			pMainFrame->m_pDatagramReceiver.Attach(pSocket);
 		}
-		catch (CWSocketException* pException)
+		pReactor.Add(pSocket, [pMainFrame, &pReactor, &pSocket, bIsTCP]()
 		{
-			// Handle errors and notify user
-			const int nErrorLength = 0x100;
-			TCHAR lpszErrorMessage[nErrorLength] = { 0, };
-			pException->GetErrorMessage(lpszErrorMessage, nErrorLength);
-			TRACE(_T("%s\n"), lpszErrorMessage);
-			pException->Delete();
-			pMainFrame->SetCaptionBarText(lpszErrorMessage);
-			MessageBeep(MB_ICONERROR);
-			// Break out of loop on error
-			break;
-		}
+			if (bIsTCP ? ReceiveSocketData(pMainFrame, pSocket) : ReceiveDatagrams(pMainFrame, pSocket))
+			{
+				return true;
+			}
+			// Nothing left to wait for: end the thread
+			pReactor.Stop();
+			return false;
+		});
+	}
 
-		// If data was received, write it to the ring buffer
-		if (nLength > 0)
-		{
-			// Lock mutex to prevent conflicts with UI thread
-			pMutualAccess.lock();
-			pRingBuffer.WriteBinary(pBuffer, nLength);
-			pMutualAccess.unlock();
-			// Reset length for next iteration
-			nLength = 0;
-		}
+	const DWORD dwError = pReactor.Run();
+	if (dwError != 0)
+	{
+		CWSocketException pException(static_cast<int>(dwError));
+		const int nErrorLength = 0x100;
+		TCHAR lpszErrorMessage[nErrorLength] = { 0, };
+		pException.GetErrorMessage(lpszErrorMessage, nErrorLength);
+		TRACE(_T("%s\n"), lpszErrorMessage);
+		pMainFrame->PostCaptionBarText(lpszErrorMessage, true);
 	}
 
 	// Cleanup before thread exits
-	pIncomming.Close();
+	pReactor.Destroy();
+	pTcpServer.Close();
 	pSocket.Close();
 	pMainFrame->m_nThreadRunning = false;
 	pMainFrame->m_hSocketThread = nullptr;
@@ -18,11 +18,19 @@ IntelliPort. If not, see <http://www.opensource.org/licenses/gpl-3.0.html>*/
 
 #pragma once
 
-#include "SerialPort.h"
+#include "SerialTransport.h"
 #include "SocMFC.h"
-#include "RingBuffer.h"
-#include "IncomingDlg.h"
-#include <mutex>
+#include "ReceiveBuffer.h"
+#include "SerialReader.h"
+#include "SocketReactor.h"
+#include "TcpServer.h"
+#include "DatagramQueue.h"
+#include "CaptureReplay.h"
+#include "TrafficGenerator.h"
+#include "WriteQueue.h"
+#include "LatencyHistogram.h"
+#include "Utf8Decoder.h"
+#include <atomic>
 
 class CMainFrame : public CFrameWndEx
 {
@@ -47,8 +55,24 @@ public:
 	virtual ~CMainFrame();
 	bool SetStatusBarText(const CString& strMessage);
 	bool SetCaptionBarText(const CString& strMessage);
+	void PostCaptionBarText(const CString& strMessage, bool bError);
 	bool HideMessageBar();
 	bool AddText(CString strText);
+	bool AddText(LPCWSTR pText, int nLength);
+	void NotifyDataReady();
+	void PostDataReady();
+	void DrainRingBuffer();
+	void DrainDatagramQueue();
+	const CString& GetEndpointName(uint32_t nEndpoint);
+	void UpdateLatencyPane();
+	bool WaitForReceiveBuffer();
+	void ResetReceiveBuffer();
+	void StartCapture();
+	void StartWriteQueue();
+	bool WriteQueued(const CWriteSpan* pSpans, int nCount);
+	bool SendBytes(const char* pData, size_t nLength, const std::function<bool()>& pfnContinue);
+	void StopTrafficTest();
+	void UpdateTrafficStatus();
 
 #ifdef _DEBUG
 	virtual void AssertValid() const;
@@ -61,15 +85,36 @@ protected:  // control bar embedded members
 	CMFCToolBarImages m_PanelImages;
 	CMFCRibbonStatusBar m_wndStatusBar;
 	CMFCCaptionBar m_wndCaptionBar;
-	CIncomingDlg m_dlgIncoming;
 public:
-	std::mutex m_pMutualAccess;
-	CRingBuffer m_pRingBuffer;
-	CSerialPort m_pSerialPort;
+	CReceiveBuffer m_pReceiveBuffer;
+	CCaptureWriter m_pCapture;
+	CWriteQueue m_pWriteQueue;
+	CCaptureReplay m_pCaptureReplay;
+	CTrafficGenerator m_pTrafficGenerator;
+	CTrafficChecker m_pTrafficChecker;
+	bool m_bTrafficTest;
+	CSerialTransport m_pSerialTransport;
+	CSerialReader m_pSerialReader;
 	CWSocket m_pSocket;
-	CWSocket m_pIncomming;
+	CUdpEndpoint m_pServerEndpoint; // UDP destination, looked up when the socket is created
+	CDatagramReceiver m_pDatagramReceiver;
+	CEndpointTable m_pEndpoints; // senders of the datagrams received
+	CDatagramQueue m_pDatagramQueue;
+	std::vector<CString> m_vecEndpointNames; // "address:port" of each endpoint id, formatted once
+	CTcpServer m_pTcpServer;
+	CSocketReactor m_pSocketReactor;
 	CTime m_pCurrentDateTime;
 	UINT_PTR m_nTimerID;
+	UINT_PTR m_nDrainTimerID;
+	std::atomic<bool> m_bDataPending;
+	ULONGLONG m_nLastDrainTick;
+	UINT m_nMaxFrameRate;
+	CArrivalStampQueue m_pArrivalStamps;
+	CLatencyHistogram m_pLatencyHistogram;
+	CUtf8Decoder m_pUtf8Decoder;
+	CUtf8Decoder m_pDatagramDecoder; // datagrams only: a partial character of the stream is not mixed in
+	std::wstring m_strDecoded; // reused by every frame, so decoding does not allocate
+	uint64_t m_nLatencyShown;
 	bool m_nThreadRunning;
 	HANDLE m_hSerialPortThread;
 	HANDLE m_hSocketThread;
@@ -81,6 +126,10 @@ protected:
 	afx_msg int OnCreate(LPCREATESTRUCT lpCreateStruct);
 	afx_msg void OnDestroy();
 	afx_msg void OnTimer(UINT_PTR nIDEvent);
+	afx_msg LRESULT OnRingBufferData(WPARAM wParam, LPARAM lParam);
+	afx_msg LRESULT OnFileIndexed(WPARAM wParam, LPARAM lParam);
+	afx_msg LRESULT OnReplayFinished(WPARAM wParam, LPARAM lParam);
+	afx_msg LRESULT OnCaptionBarText(WPARAM wParam, LPARAM lParam);
 	afx_msg void OnViewCaptionBar();
 	afx_msg void OnUpdateViewCaptionBar(CCmdUI* pCmdUI);
 	afx_msg void OnOptions();
@@ -92,10 +141,14 @@ protected:
 	afx_msg void OnOpenSerialPort();
 	afx_msg void OnCloseSerialPort();
 	afx_msg void OnSendReceive();
+	afx_msg void OnReplayCapture();
+	afx_msg void OnTrafficTest();
 	afx_msg void OnUpdateConfigureSerialPort(CCmdUI* pCmdUI);
 	afx_msg void OnUpdateOpenSerialPort(CCmdUI* pCmdUI);
 	afx_msg void OnUpdateCloseSerialPort(CCmdUI* pCmdUI);
 	afx_msg void OnUpdateSendReceive(CCmdUI* pCmdUI);
+	afx_msg void OnUpdateReplayCapture(CCmdUI* pCmdUI);
+	afx_msg void OnUpdateTrafficTest(CCmdUI* pCmdUI);
 	afx_msg void OnTwitter();
 	afx_msg void OnLinkedin();
 	afx_msg void OnFacebook();
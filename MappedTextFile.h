@@ -0,0 +1,540 @@
+/* Copyright (C) 2014-2026 Stefan-Mihai MOGA
+This file is part of IntelliPort application developed by Stefan-Mihai MOGA.
+IntelliPort is an alternative Windows version to the famous HyperTerminal!
+
+IntelliPort is free software: you can redistribute it and/or modify it
+under the terms of the GNU General Public License as published by the Open
+Source Initiative, either version 3 of the License, or any later version.
+
+IntelliPort is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+IntelliPort. If not, see <http://www.opensource.org/licenses/gpl-3.0.html>*/
+
+// MappedTextFile.h : memory-mapped text file with a background line index
+//
+
+#pragma once
+
+#include "Transcode.h"
+#include "Utf8Decoder.h"
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifndef _WIN32
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+/**
+ * @brief Read-only view of a large text file, shown without loading it.
+ *
+ * The file is mapped into memory, so opening it costs nothing and the OS
+ * pages the text in as it is read. The line index is built in the background
+ * by a pool of threads, each scanning MAPPED_TEXT_CHUNK_SIZE bytes at a time
+ * with the vectorized delimiter search. Chunks are handed out in file order,
+ * so the indexed part grows from the start of the file: the first screen can
+ * be shown at once and the rest becomes reachable as the index grows. Like
+ * CScrollbackBuffer, the index keeps the start of every
+ * MAPPED_TEXT_INDEX_STRIDE-th line only.
+ *
+ * The text is kept in its file encoding (UTF-8, UTF-16LE or UTF-16BE) and only
+ * the lines asked for are converted to wide characters. Lines end with LF; a
+ * CR before it is dropped, and a line break at the very end of the file does
+ * not start another line. Queries come from one thread (the UI); the progress
+ * callback is invoked on an indexing thread.
+ */
+class CMappedTextFile
+{
+public:
+	enum TextEncoding
+	{
+		MAPPED_TEXT_UTF8 = 0,
+		MAPPED_TEXT_UTF16LE = 1,
+		MAPPED_TEXT_UTF16BE = 2,
+	};
+
+#ifdef _WIN32
+	typedef HANDLE FileHandle;
+#else
+	typedef int FileHandle;
+#endif
+
+	static constexpr size_t MAPPED_TEXT_CHUNK_SIZE = 0x1000000; // bytes indexed per task
+	static constexpr uint64_t MAPPED_TEXT_INDEX_STRIDE = 64;    // lines per checkpoint
+	static constexpr size_t MAPPED_TEXT_MAX_THREADS = 8;
+
+	CMappedTextFile() : m_pMapping(nullptr), m_nMappingSize(0), m_pText(nullptr), m_nTextSize(0),
+		m_nEncoding(MAPPED_TEXT_UTF8), m_nNextChunk(0), m_nIndexedChunks(0), m_nIndexedLines(0),
+		m_nMaxLineLength(0), m_nLastBreakEnd(0), m_nMaxGap(0), m_bStop(false)
+	{
+	}
+
+	CMappedTextFile(const CMappedTextFile&) = delete;
+	CMappedTextFile& operator=(const CMappedTextFile&) = delete;
+
+	~CMappedTextFile()
+	{
+		Close();
+	}
+
+	/**
+	 * @brief Maps a whole file into memory.
+	 *
+	 * @param hFile Open file; it can be closed afterwards, the mapping keeps it alive.
+	 * @return false if the file is empty or could not be mapped (e.g. too large
+	 * for the address space of a 32-bit process).
+	 */
+	bool Open(FileHandle hFile)
+	{
+		Close();
+#ifdef _WIN32
+		LARGE_INTEGER nFileSize = { 0, };
+		if (!GetFileSizeEx(hFile, &nFileSize) || (nFileSize.QuadPart <= 0) ||
+			(static_cast<uint64_t>(nFileSize.QuadPart) > SIZE_MAX))
+		{
+			return false;
+		}
+		HANDLE hMapping = CreateFileMapping(hFile, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		if (hMapping == nullptr)
+		{
+			return false;
+		}
+		void* pMapping = MapViewOfFile(hMapping, FILE_MAP_READ, 0, 0, 0);
+		CloseHandle(hMapping); // the view keeps the mapping alive
+		if (pMapping == nullptr)
+		{
+			return false;
+		}
+		m_nMappingSize = static_cast<size_t>(nFileSize.QuadPart);
+#else
+		struct stat pStat;
+		if ((fstat(hFile, &pStat) != 0) || (pStat.st_size <= 0))
+		{
+			return false;
+		}
+		void* pMapping = mmap(nullptr, static_cast<size_t>(pStat.st_size), PROT_READ, MAP_SHARED, hFile, 0);
+		if (pMapping == MAP_FAILED)
+		{
+			return false;
+		}
+		madvise(pMapping, static_cast<size_t>(pStat.st_size), MADV_SEQUENTIAL);
+		m_nMappingSize = static_cast<size_t>(pStat.st_size);
+#endif
+		m_pMapping = static_cast<const uint8_t*>(pMapping);
+		m_pText = m_pMapping;
+		m_nTextSize = m_nMappingSize;
+		return true;
+	}
+
+	/**
+	 * @brief Stops indexing and unmaps the file.
+	 */
+	void Close()
+	{
+		m_bStop.store(true, std::memory_order_release);
+		for (std::thread& pThread : m_vecThreads)
+		{
+			pThread.join();
+		}
+		m_vecThreads.clear();
+		if (m_pMapping != nullptr)
+		{
+#ifdef _WIN32
+			UnmapViewOfFile(m_pMapping);
+#else
+			munmap(const_cast<uint8_t*>(m_pMapping), m_nMappingSize);
+#endif
+		}
+		m_pMapping = m_pText = nullptr;
+		m_nMappingSize = m_nTextSize = 0;
+		m_vecChunks.clear();
+		m_nNextChunk = 0;
+		m_nIndexedChunks = 0;
+		m_nIndexedLines = 0;
+		m_nMaxLineLength = 0;
+		m_nLastBreakEnd = 0;
+		m_nMaxGap = 0;
+		m_bStop.store(false, std::memory_order_release);
+	}
+
+	bool IsOpen() const
+	{
+		return m_pMapping != nullptr;
+	}
+
+	/**
+	 * @brief Returns the whole file as mapped, e.g. for detecting its encoding.
+	 */
+	const uint8_t* GetData() const
+	{
+		return m_pMapping;
+	}
+
+	size_t GetSize() const
+	{
+		return m_nMappingSize;
+	}
+
+	/**
+	 * @brief Returns the text after the byte order mark, in the file encoding.
+	 */
+	const uint8_t* GetText() const
+	{
+		return m_pText;
+	}
+
+	size_t GetTextSize() const
+	{
+		return m_nTextSize;
+	}
+
+	TextEncoding GetEncoding() const
+	{
+		return m_nEncoding;
+	}
+
+	/**
+	 * @brief Starts building the line index in the background.
+	 *
+	 * @param nEncoding Encoding of the text.
+	 * @param nSkip Size of the byte order mark to skip.
+	 * @param pfnProgress Called on an indexing thread each time more lines become
+	 * reachable, the last time when the index is complete.
+	 */
+	void StartIndexing(TextEncoding nEncoding, size_t nSkip, std::function<void()> pfnProgress)
+	{
+		m_nEncoding = nEncoding;
+		m_pText = m_pMapping + std::min(nSkip, m_nMappingSize);
+		m_nTextSize = m_nMappingSize - std::min(nSkip, m_nMappingSize);
+		if (nEncoding != MAPPED_TEXT_UTF8)
+		{
+			m_nTextSize &= ~size_t(1); // an odd trailing byte is not a character
+		}
+		m_pfnProgress = std::move(pfnProgress);
+		m_vecChunks.resize((m_nTextSize + MAPPED_TEXT_CHUNK_SIZE - 1) / MAPPED_TEXT_CHUNK_SIZE);
+		const size_t nThreads = std::clamp<size_t>(std::thread::hardware_concurrency(), 1, MAPPED_TEXT_MAX_THREADS);
+		for (size_t nThread = 0; nThread < std::min(nThreads, m_vecChunks.size()); nThread++)
+		{
+			m_vecThreads.emplace_back(&CMappedTextFile::IndexChunks, this);
+		}
+	}
+
+	/**
+	 * @brief Returns true once every line has been indexed.
+	 */
+	bool IsIndexed() const
+	{
+		return m_nIndexedChunks.load(std::memory_order_acquire) == m_vecChunks.size();
+	}
+
+	/**
+	 * @brief Returns the number of lines reachable so far; the total once indexed.
+	 */
+	uint64_t GetLineCount() const
+	{
+		if (m_nTextSize == 0)
+		{
+			return 1;
+		}
+		const uint64_t nLines = m_nIndexedLines.load(std::memory_order_acquire);
+		// A line break at the very end of the file does not start another line
+		return ((nLines > 0) && IsIndexed() && EndsWithLineBreak()) ? nLines : nLines + 1;
+	}
+
+	/**
+	 * @brief Returns true if the text ends with LF.
+	 */
+	bool EndsWithLineBreak() const
+	{
+		return (m_nTextSize >= GetUnitSize()) && IsBreakAt(m_nTextSize - GetUnitSize());
+	}
+
+	/**
+	 * @brief Returns the length of the longest line indexed so far, in file code units.
+	 */
+	uint64_t GetMaxLineLength() const
+	{
+		return m_nMaxLineLength.load(std::memory_order_acquire);
+	}
+
+	/**
+	 * @brief Converts one line, without its line ending, into strLine.
+	 *
+	 * Only the characters that can be shown are converted, so a huge line costs
+	 * no more than a short one.
+	 *
+	 * @param nLine Zero-based line number.
+	 * @param strLine String receiving the line; its capacity is reused.
+	 * @param nMaxLength Most characters to convert.
+	 * @return Length of the whole line. For a UTF-8 line longer than 64 KB that
+	 * was not converted to its end, the remaining bytes are counted as characters.
+	 */
+	uint64_t GetLine(uint64_t nLine, std::wstring& strLine, size_t nMaxLength = SIZE_MAX) const
+	{
+		strLine.clear();
+		if (nLine >= GetLineCount())
+		{
+			return 0;
+		}
+		const size_t nUnit = GetUnitSize();
+		const size_t nStart = FindLineStart(nLine);
+		size_t nEnd = FindNextBreak(nStart);
+		nEnd = (nEnd <= m_nTextSize) ? nEnd - nUnit : m_nTextSize;
+		if ((nEnd - nStart >= nUnit) && IsUnitAt(nEnd - nUnit, '\r'))
+		{
+			nEnd -= nUnit;
+		}
+
+		if (m_nEncoding != MAPPED_TEXT_UTF8)
+		{
+			const size_t nLength = (nEnd - nStart) / 2;
+			const size_t nCopy = std::min(nLength, nMaxLength);
+			strLine.resize(nCopy);
+			WidenUtf16(m_pText + nStart, nCopy, m_nEncoding == MAPPED_TEXT_UTF16BE, &strLine[0]);
+			return nLength;
+		}
+
+		// Three bytes per character are enough for the characters that can be shown
+		size_t nBytes = nEnd - nStart;
+		if ((nMaxLength < (SIZE_MAX - 3) / 3) && (nBytes > std::max<size_t>(3 * nMaxLength + 3, 0x10000)))
+		{
+			nBytes = 3 * nMaxLength + 3;
+		}
+		CUtf8Decoder pDecoder;
+		pDecoder.Decode(reinterpret_cast<const char*>(m_pText + nStart), nBytes, strLine);
+		const uint64_t nLength = strLine.size() + (nEnd - nStart - nBytes);
+		if (strLine.size() > nMaxLength)
+		{
+			strLine.resize(nMaxLength);
+		}
+		return nLength;
+	}
+
+	/**
+	 * @brief Converts UTF-16 code units in file byte order to wide characters.
+	 */
+	static void WidenUtf16(const uint8_t* pData, size_t nLength, bool bBigEndian, wchar_t* pOutput)
+	{
+		if (sizeof(wchar_t) == 2)
+		{
+			if (bBigEndian)
+			{
+				SwapUtf16Bytes(reinterpret_cast<const uint16_t*>(pData), nLength, reinterpret_cast<uint16_t*>(pOutput));
+			}
+			else
+			{
+				memcpy(pOutput, pData, nLength * 2);
+			}
+			return;
+		}
+		const int nHigh = bBigEndian ? 0 : 1;
+		for (size_t nIndex = 0; nIndex < nLength; nIndex++)
+		{
+			pOutput[nIndex] = static_cast<wchar_t>((pData[2 * nIndex + nHigh] << 8) | pData[2 * nIndex + 1 - nHigh]);
+		}
+	}
+
+protected:
+	/**
+	 * @brief Index of one chunk, written by the thread that scanned it.
+	 */
+	struct CIndexChunk
+	{
+		std::vector<size_t> vecCheckpoints; // just past every MAPPED_TEXT_INDEX_STRIDE-th LF of the chunk
+		uint64_t nLineBreaks = 0;
+		uint64_t nFirstLine = 0;            // LFs before the chunk, set when it joins the indexed part
+		size_t nFirstBreak = SIZE_MAX;      // offset of the first LF
+		size_t nLastBreak = 0;              // offset of the last LF
+		uint64_t nMaxGap = 0;               // longest line between two LFs of the chunk, in bytes
+		bool bDone = false;
+	};
+
+	size_t GetUnitSize() const
+	{
+		return (m_nEncoding == MAPPED_TEXT_UTF8) ? 1 : 2;
+	}
+
+	bool IsUnitAt(size_t nOffset, uint8_t nChar) const
+	{
+		switch (m_nEncoding)
+		{
+			case MAPPED_TEXT_UTF16LE: return (m_pText[nOffset] == nChar) && (m_pText[nOffset + 1] == 0);
+			case MAPPED_TEXT_UTF16BE: return (m_pText[nOffset] == 0) && (m_pText[nOffset + 1] == nChar);
+			default: return m_pText[nOffset] == nChar;
+		}
+	}
+
+	bool IsBreakAt(size_t nOffset) const
+	{
+		return IsUnitAt(nOffset, '\n');
+	}
+
+	/**
+	 * @brief Returns the offset just past the next LF at or after nOffset, or past the end.
+	 */
+	size_t FindNextBreak(size_t nOffset, size_t nEnd = SIZE_MAX) const
+	{
+		nEnd = std::min(nEnd, m_nTextSize);
+		while (nOffset < nEnd)
+		{
+			const char* pData = reinterpret_cast<const char*>(m_pText);
+			const size_t nIndex = nOffset + FindFirstDelimiter(pData + nOffset, nEnd - nOffset, '\n', '\n', '\n');
+			if (nIndex >= nEnd)
+			{
+				break;
+			}
+			if (m_nEncoding == MAPPED_TEXT_UTF8)
+			{
+				return nIndex + 1;
+			}
+			// In UTF-16 the LF byte must be the right half of a 0x000A code unit
+			const size_t nUnit = nIndex & ~size_t(1);
+			if ((nUnit + 1 < m_nTextSize) && IsBreakAt(nUnit))
+			{
+				return nUnit + 2;
+			}
+			nOffset = nIndex + 1;
+		}
+		return m_nTextSize + 1;
+	}
+
+	/**
+	 * @brief Returns the offset of the first byte of a line within the indexed part.
+	 */
+	size_t FindLineStart(uint64_t nLine) const
+	{
+		if (nLine == 0)
+		{
+			return 0;
+		}
+		// Chunk holding the nLine-th LF: the last one with fewer LFs before it
+		const size_t nChunks = m_nIndexedChunks.load(std::memory_order_acquire);
+		size_t nLow = 0, nHigh = nChunks;
+		while (nHigh - nLow > 1)
+		{
+			const size_t nMiddle = (nLow + nHigh) / 2;
+			if (m_vecChunks[nMiddle].nFirstLine < nLine)
+			{
+				nLow = nMiddle;
+			}
+			else
+			{
+				nHigh = nMiddle;
+			}
+		}
+		const CIndexChunk& pChunk = m_vecChunks[nLow];
+		const uint64_t nBreak = nLine - pChunk.nFirstLine; // LFs to pass within the chunk
+		const uint64_t nCheckpoint = nBreak / MAPPED_TEXT_INDEX_STRIDE;
+		size_t nOffset = (nCheckpoint == 0) ? nLow * MAPPED_TEXT_CHUNK_SIZE : pChunk.vecCheckpoints[static_cast<size_t>(nCheckpoint - 1)];
+		for (uint64_t nIndex = nCheckpoint * MAPPED_TEXT_INDEX_STRIDE; nIndex < nBreak; nIndex++)
+		{
+			nOffset = FindNextBreak(nOffset);
+		}
+		return std::min(nOffset, m_nTextSize);
+	}
+
+	/**
+	 * @brief Indexing thread: scans chunks in file order until none is left.
+	 */
+	void IndexChunks()
+	{
+		for (;;)
+		{
+			const size_t nChunk = m_nNextChunk.fetch_add(1, std::memory_order_relaxed);
+			if ((nChunk >= m_vecChunks.size()) || m_bStop.load(std::memory_order_acquire))
+			{
+				return;
+			}
+			CIndexChunk& pChunk = m_vecChunks[nChunk];
+			const size_t nStart = nChunk * MAPPED_TEXT_CHUNK_SIZE;
+			const size_t nEnd = std::min(nStart + MAPPED_TEXT_CHUNK_SIZE, m_nTextSize);
+			size_t nPrevious = nStart;
+			for (size_t nOffset = FindNextBreak(nStart, nEnd); nOffset <= nEnd; nOffset = FindNextBreak(nOffset, nEnd))
+			{
+				if (pChunk.nFirstBreak == SIZE_MAX)
+				{
+					pChunk.nFirstBreak = nOffset - GetUnitSize();
+				}
+				else
+				{
+					pChunk.nMaxGap = std::max<uint64_t>(pChunk.nMaxGap, nOffset - GetUnitSize() - nPrevious);
+				}
+				pChunk.nLastBreak = nOffset - GetUnitSize();
+				nPrevious = nOffset;
+				if ((++pChunk.nLineBreaks % MAPPED_TEXT_INDEX_STRIDE) == 0)
+				{
+					pChunk.vecCheckpoints.push_back(nOffset);
+				}
+			}
+			PublishChunk(nChunk);
+		}
+	}
+
+	/**
+	 * @brief Marks a chunk as scanned and extends the indexed part over finished chunks.
+	 */
+	void PublishChunk(size_t nChunk)
+	{
+		bool bProgress = false;
+		{
+			std::lock_guard<std::mutex> pLock(m_pIndexLock);
+			m_vecChunks[nChunk].bDone = true;
+			size_t nIndexed = m_nIndexedChunks.load(std::memory_order_relaxed);
+			uint64_t nLines = m_nIndexedLines.load(std::memory_order_relaxed);
+			uint64_t nMaxLength = m_nMaxGap;
+			for (; (nIndexed < m_vecChunks.size()) && m_vecChunks[nIndexed].bDone; nIndexed++)
+			{
+				CIndexChunk& pChunk = m_vecChunks[nIndexed];
+				pChunk.nFirstLine = nLines;
+				nLines += pChunk.nLineBreaks;
+				if (pChunk.nLineBreaks != 0)
+				{
+					// The line running into this chunk ends at its first LF
+					nMaxLength = std::max<uint64_t>({ nMaxLength, pChunk.nMaxGap, pChunk.nFirstBreak - m_nLastBreakEnd });
+					m_nLastBreakEnd = pChunk.nLastBreak + GetUnitSize();
+				}
+				bProgress = true;
+			}
+			if (nIndexed == m_vecChunks.size())
+			{
+				nMaxLength = std::max<uint64_t>(nMaxLength, m_nTextSize - m_nLastBreakEnd);
+			}
+			m_nMaxGap = nMaxLength;
+			m_nMaxLineLength.store(nMaxLength / GetUnitSize(), std::memory_order_release);
+			m_nIndexedLines.store(nLines, std::memory_order_release);
+			m_nIndexedChunks.store(nIndexed, std::memory_order_release);
+		}
+		if (bProgress && m_pfnProgress)
+		{
+			m_pfnProgress();
+		}
+	}
+
+	const uint8_t* m_pMapping;
+	size_t m_nMappingSize;
+	const uint8_t* m_pText;           // text after the byte order mark
+	size_t m_nTextSize;
+	TextEncoding m_nEncoding;
+	std::vector<CIndexChunk> m_vecChunks;
+	std::atomic<size_t> m_nNextChunk;     // next chunk to scan
+	std::atomic<size_t> m_nIndexedChunks; // leading chunks whose lines are reachable
+	std::atomic<uint64_t> m_nIndexedLines; // LFs in the indexed chunks
+	std::atomic<uint64_t> m_nMaxLineLength;
+	size_t m_nLastBreakEnd;               // just past the last LF of the indexed chunks
+	uint64_t m_nMaxGap;                   // longest line of the indexed chunks, in bytes
+	std::mutex m_pIndexLock;
+	std::atomic<bool> m_bStop;
+	std::function<void()> m_pfnProgress;
+	std::vector<std::thread> m_vecThreads;
+};
@@ -16,4 +16,8 @@ IntelliPort. If not, see <http://www.opensource.org/licenses/gpl-3.0.html>*/
 #pragma once
 
 static constexpr UINT MSG_NAVIGATE = WM_APP + 123;
-static constexpr UINT MSG_RUN_ASYNC_CALLBACK = WM_APP + 124;
\ No newline at end of file
+static constexpr UINT MSG_RUN_ASYNC_CALLBACK = WM_APP + 124;
+static constexpr UINT MSG_RING_BUFFER_DATA = WM_APP + 125;
+static constexpr UINT MSG_FILE_INDEXED = WM_APP + 126;
+static constexpr UINT MSG_REPLAY_FINISHED = WM_APP + 127;
+static constexpr UINT MSG_CAPTION_BAR_TEXT = WM_APP + 128;
@@ -0,0 +1,144 @@
+/* Copyright (C) 2014-2026 Stefan-Mihai MOGA
+This file is part of IntelliPort application developed by Stefan-Mihai MOGA.
+IntelliPort is an alternative Windows version to the famous HyperTerminal!
+
+IntelliPort is free software: you can redistribute it and/or modify it
+under the terms of the GNU General Public License as published by the Open
+Source Initiative, either version 3 of the License, or any later version.
+
+IntelliPort is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+IntelliPort. If not, see <http://www.opensource.org/licenses/gpl-3.0.html>*/
+
+// PrecisionTimer.h : waits until a deadline with sub-millisecond precision
+//
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <thread>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#include <emmintrin.h>
+#define PRECISION_TIMER_PAUSE() _mm_pause()
+#else
+#define PRECISION_TIMER_PAUSE() std::this_thread::yield()
+#endif
+
+#ifndef _WIN32
+#include <time.h>
+#endif
+
+#ifndef CREATE_WAITABLE_TIMER_HIGH_RESOLUTION
+#define CREATE_WAITABLE_TIMER_HIGH_RESOLUTION 0x00000002
+#endif
+
+/**
+ * @brief Sleeps, then spins, until a deadline on the steady clock.
+ *
+ * The wait sleeps on a high-resolution timer (a high-resolution waitable timer
+ * on Windows, clock_nanosleep elsewhere) until m_nSpinTime before the deadline
+ * and spins on the monotonic clock for the rest, so the deadline is met to a
+ * few microseconds at the cost of a short busy wait. Sleeps are cut into
+ * PRECISION_TIMER_MAX_SLEEP slices, so a stop flag is seen quickly.
+ * One instance per thread.
+ */
+class CPrecisionTimer
+{
+public:
+	static constexpr int64_t PRECISION_TIMER_MAX_SLEEP = 20000000; // ns
+
+	CPrecisionTimer()
+	{
+#ifdef _WIN32
+		// The high-resolution timer (Windows 10 1803 and later) wakes within about
+		// half a millisecond; the classic one only within a scheduler tick
+		m_hTimer = CreateWaitableTimerExW(nullptr, nullptr, CREATE_WAITABLE_TIMER_HIGH_RESOLUTION, TIMER_ALL_ACCESS);
+		m_nSpinTime = 1000000;
+		if (m_hTimer == nullptr)
+		{
+			m_hTimer = CreateWaitableTimer(nullptr, TRUE, nullptr);
+			m_nSpinTime = 16000000;
+		}
+#else
+		m_nSpinTime = 100000;
+#endif
+	}
+
+	~CPrecisionTimer()
+	{
+#ifdef _WIN32
+		if (m_hTimer != nullptr)
+		{
+			CloseHandle(m_hTimer);
+		}
+#endif
+	}
+
+	CPrecisionTimer(const CPrecisionTimer&) = delete;
+	CPrecisionTimer& operator=(const CPrecisionTimer&) = delete;
+
+	/**
+	 * @brief Waits until the deadline.
+	 * @param tDeadline The instant to wait for.
+	 * @param bStop Checked between sleeps.
+	 * @return false if bStop was set meanwhile.
+	 */
+	bool WaitUntil(std::chrono::steady_clock::time_point tDeadline, const std::atomic<bool>& bStop)
+	{
+		for (;;)
+		{
+			if (bStop.load(std::memory_order_relaxed))
+			{
+				return false;
+			}
+			const int64_t nLeft = std::chrono::duration_cast<std::chrono::nanoseconds>(tDeadline - std::chrono::steady_clock::now()).count();
+			if (nLeft <= 0)
+			{
+				return true;
+			}
+			if (nLeft <= m_nSpinTime)
+			{
+				while (std::chrono::steady_clock::now() < tDeadline)
+				{
+					PRECISION_TIMER_PAUSE();
+				}
+				return true;
+			}
+			SleepFor(std::min<int64_t>(nLeft - m_nSpinTime, PRECISION_TIMER_MAX_SLEEP));
+		}
+	}
+
+protected:
+	void SleepFor(int64_t nNanoseconds)
+	{
+#ifdef _WIN32
+		LARGE_INTEGER nDueTime;
+		nDueTime.QuadPart = -(nNanoseconds / 100); // relative, in 100 ns units
+		if ((m_hTimer != nullptr) && SetWaitableTimer(m_hTimer, &nDueTime, 0, nullptr, nullptr, FALSE))
+		{
+			WaitForSingleObject(m_hTimer, INFINITE);
+		}
+		else
+		{
+			::Sleep(static_cast<DWORD>(nNanoseconds / 1000000));
+		}
+#else
+		timespec tDelay;
+		tDelay.tv_sec = static_cast<time_t>(nNanoseconds / 1000000000);
+		tDelay.tv_nsec = static_cast<long>(nNanoseconds % 1000000000);
+		clock_nanosleep(CLOCK_MONOTONIC, 0, &tDelay, nullptr);
+#endif
+	}
+
+	int64_t m_nSpinTime;            // ns before a deadline spent spinning rather than sleeping
+#ifdef _WIN32
+	HANDLE m_hTimer;
+#endif
+};
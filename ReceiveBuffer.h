@@ -0,0 +1,742 @@
+/* Copyright (C) 2014-2026 Stefan-Mihai MOGA
+This file is part of IntelliPort application developed by Stefan-Mihai MOGA.
+IntelliPort is an alternative Windows version to the famous HyperTerminal!
+
+IntelliPort is free software: you can redistribute it and/or modify it
+under the terms of the GNU General Public License as published by the Open
+Source Initiative, either version 3 of the License, or any later version.
+
+IntelliPort is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+IntelliPort. If not, see <http://www.opensource.org/licenses/gpl-3.0.html>*/
+
+// ReceiveBuffer.h : receive ring buffer with overflow policies and a disk spill segment
+//
+
+#pragma once
+
+#include "CaptureFile.h"
+#include "TrafficGenerator.h"
+#include "RingBuffer.h"
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+
+#ifndef _WIN32
+#include <cstdlib>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+/**
+ * @brief Temporary file read and written at explicit offsets.
+ *
+ * Positional I/O lets the producer append while the consumer reads, without a
+ * shared file pointer. The file is deleted when closed.
+ */
+class CSpillFile
+{
+public:
+	CSpillFile()
+	{
+#ifdef _WIN32
+		m_hFile = INVALID_HANDLE_VALUE;
+#else
+		m_nFd = -1;
+#endif
+	}
+
+	~CSpillFile()
+	{
+		Close();
+	}
+
+	CSpillFile(const CSpillFile&) = delete;
+	CSpillFile& operator=(const CSpillFile&) = delete;
+
+	bool Open()
+	{
+		Close();
+#ifdef _WIN32
+		TCHAR lpszTempPath[MAX_PATH] = { 0, };
+		TCHAR lpszTempFile[MAX_PATH] = { 0, };
+		if ((GetTempPath(MAX_PATH, lpszTempPath) == 0) || (GetTempFileName(lpszTempPath, _T("IPS"), 0, lpszTempFile) == 0))
+		{
+			return false;
+		}
+		m_hFile = CreateFile(lpszTempFile, GENERIC_READ | GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS,
+			FILE_ATTRIBUTE_TEMPORARY | FILE_FLAG_DELETE_ON_CLOSE, nullptr);
+		return (m_hFile != INVALID_HANDLE_VALUE);
+#else
+		char lpszTempFile[] = "/tmp/IntelliPortSpillXXXXXX";
+		m_nFd = mkstemp(lpszTempFile);
+		if (m_nFd < 0)
+		{
+			return false;
+		}
+		unlink(lpszTempFile);
+		return true;
+#endif
+	}
+
+	void Close()
+	{
+#ifdef _WIN32
+		if (m_hFile != INVALID_HANDLE_VALUE)
+		{
+			CloseHandle(m_hFile);
+			m_hFile = INVALID_HANDLE_VALUE;
+		}
+#else
+		if (m_nFd >= 0)
+		{
+			close(m_nFd);
+			m_nFd = -1;
+		}
+#endif
+	}
+
+	bool IsOpen() const
+	{
+#ifdef _WIN32
+		return (m_hFile != INVALID_HANDLE_VALUE);
+#else
+		return (m_nFd >= 0);
+#endif
+	}
+
+	bool Write(uint64_t nOffset, const char* pData, size_t nLength)
+	{
+		while (nLength > 0)
+		{
+#ifdef _WIN32
+			OVERLAPPED overlapped = { 0, };
+			overlapped.Offset = static_cast<DWORD>(nOffset);
+			overlapped.OffsetHigh = static_cast<DWORD>(nOffset >> 32);
+			DWORD dwWritten = 0;
+			const DWORD dwLength = (nLength > 0x40000000) ? 0x40000000 : static_cast<DWORD>(nLength);
+			if (!WriteFile(m_hFile, pData, dwLength, &dwWritten, &overlapped) || (dwWritten == 0))
+			{
+				return false;
+			}
+			const size_t nWritten = dwWritten;
+#else
+			const ssize_t nWritten = pwrite(m_nFd, pData, nLength, static_cast<off_t>(nOffset));
+			if (nWritten <= 0)
+			{
+				return false;
+			}
+#endif
+			pData += nWritten;
+			nLength -= nWritten;
+			nOffset += nWritten;
+		}
+		return true;
+	}
+
+	bool Read(uint64_t nOffset, char* pData, size_t nLength)
+	{
+		while (nLength > 0)
+		{
+#ifdef _WIN32
+			OVERLAPPED overlapped = { 0, };
+			overlapped.Offset = static_cast<DWORD>(nOffset);
+			overlapped.OffsetHigh = static_cast<DWORD>(nOffset >> 32);
+			DWORD dwRead = 0;
+			const DWORD dwLength = (nLength > 0x40000000) ? 0x40000000 : static_cast<DWORD>(nLength);
+			if (!ReadFile(m_hFile, pData, dwLength, &dwRead, &overlapped) || (dwRead == 0))
+			{
+				return false;
+			}
+			const size_t nRead = dwRead;
+#else
+			const ssize_t nRead = pread(m_nFd, pData, nLength, static_cast<off_t>(nOffset));
+			if (nRead <= 0)
+			{
+				return false;
+			}
+#endif
+			pData += nRead;
+			nLength -= nRead;
+			nOffset += nRead;
+		}
+		return true;
+	}
+
+	bool Truncate()
+	{
+#ifdef _WIN32
+		LARGE_INTEGER nZero = { 0, };
+		return SetFilePointerEx(m_hFile, nZero, nullptr, FILE_BEGIN) && SetEndOfFile(m_hFile);
+#else
+		return (ftruncate(m_nFd, 0) == 0);
+#endif
+	}
+
+protected:
+#ifdef _WIN32
+	HANDLE m_hFile;
+#else
+	int m_nFd;
+#endif
+};
+
+/**
+ * @brief Counters kept by CReceiveBuffer, all in bytes.
+ */
+struct CReceiveBufferStats
+{
+	uint64_t nBytesReceived;  // offered by the producer
+	uint64_t nBytesDropped;   // lost to DropNewest, DropOldest or a full spill segment
+	uint64_t nBytesSpilled;   // written to the spill segment
+	uint64_t nHighWaterMark;  // largest ring buffer fill level seen by the producer
+};
+
+/**
+ * @brief Single-producer/single-consumer receive buffer with an overflow policy.
+ *
+ * Wraps a CRingBuffer and decides what happens when a burst arrives faster than
+ * the consumer drains it:
+ * - OVERFLOW_BLOCK: the producer waits for room. A reader that stops reading
+ *   lets the driver buffer fill, so the configured serial handshake (RTS/CTS,
+ *   DTR/DSR or XON/XOFF) or the TCP window holds the sender back.
+ * - OVERFLOW_DROP_NEWEST: bytes that do not fit are discarded.
+ * - OVERFLOW_DROP_OLDEST: the consumer is asked to discard the oldest unread
+ *   bytes to make room; the producer waits until it has done so.
+ * - OVERFLOW_SPILL: bytes that do not fit are appended to a temporary file.
+ *   While the spill segment holds data, new bytes go there too, so the order is
+ *   kept; the consumer reads the segment after the ring buffer and the producer
+ *   returns to the ring buffer once the segment has been drained. The segment
+ *   only grows until Reset(), and is capped by the spill limit.
+ *
+ * Every policy keeps exact counters (see CReceiveBufferStats). Consumer-side
+ * PeekReadable/Consume present the ring buffer and the spill segment as one
+ * stream, so the consumer code does not depend on the policy.
+ *
+ * With SetCapture(), every byte the producer offers is also recorded to a
+ * capture file, before the policy decides whether it is kept. With
+ * SetTrafficChecker(), it is also scanned for test frames as it arrives.
+ */
+class CReceiveBuffer
+{
+public:
+	enum OverflowPolicy
+	{
+		OVERFLOW_BLOCK = 0,
+		OVERFLOW_DROP_NEWEST = 1,
+		OVERFLOW_DROP_OLDEST = 2,
+		OVERFLOW_SPILL = 3,
+	};
+
+	static constexpr size_t RECEIVE_BUFFER_STAGE_SIZE = 0x10000;
+
+	CReceiveBuffer()
+	{
+		m_nPolicy = OVERFLOW_BLOCK;
+		m_nSpillLimit = UINT64_MAX;
+		m_bSpilling = false;
+		m_nTotalWritten = 0;
+		m_nSpillWrite = 0;
+		m_nDiscardTo = 0;
+		m_nTotalRead = 0;
+		m_nSpillRead = 0;
+		m_nStagePos = 0;
+		m_nStageLength = 0;
+		m_nPeekRingLength = 0;
+		m_pCapture = nullptr;
+		m_nCaptureSource = 0;
+		m_pTrafficChecker = nullptr;
+		m_pPrepared[0] = m_pPrepared[1] = CRingBufferSpan{ nullptr, 0 };
+		ResetStats();
+	}
+
+	CReceiveBuffer(const CReceiveBuffer&) = delete;
+	CReceiveBuffer& operator=(const CReceiveBuffer&) = delete;
+
+	/**
+	 * @brief Creates the ring buffer; see CRingBuffer::Create.
+	 */
+	bool Create(int nSize, bool bMirrored = false)
+	{
+		return m_pRingBuffer.Create(nSize, bMirrored);
+	}
+
+	void Destroy()
+	{
+		m_pSpillFile.Close();
+		m_pStage.reset();
+		m_pRingBuffer.Destroy();
+	}
+
+	/**
+	 * @brief Selects the overflow policy. Call while neither side is running.
+	 * @param nPolicy One of the OverflowPolicy values.
+	 * @param nSpillLimit Most bytes OVERFLOW_SPILL may write to disk until Reset().
+	 */
+	void SetPolicy(OverflowPolicy nPolicy, uint64_t nSpillLimit = UINT64_MAX)
+	{
+		m_nPolicy = nPolicy;
+		m_nSpillLimit = nSpillLimit;
+	}
+
+	OverflowPolicy GetPolicy() const
+	{
+		return m_nPolicy;
+	}
+
+	/**
+	 * @brief Records the producer's bytes to a capture file. Call while neither side is running.
+	 * @param pCapture The capture writer, or nullptr to stop recording.
+	 * @param nSource Source id stored with every record.
+	 */
+	void SetCapture(CCaptureWriter* pCapture, uint16_t nSource = 0)
+	{
+		m_pCapture = pCapture;
+		m_nCaptureSource = nSource;
+	}
+
+	/**
+	 * @brief Scans the producer's bytes for test frames. May be called while the producer runs.
+	 * @param pTrafficChecker The checker, or nullptr to stop scanning.
+	 */
+	void SetTrafficChecker(CTrafficChecker* pTrafficChecker)
+	{
+		m_pTrafficChecker.store(pTrafficChecker, std::memory_order_release);
+	}
+
+	/**
+	 * @brief Discards all data and counters. Call while neither side is running.
+	 */
+	void Reset()
+	{
+		CRingBufferSpan pSpans[2];
+		m_pRingBuffer.Consume(m_pRingBuffer.PeekReadable(pSpans));
+		if (m_pSpillFile.IsOpen())
+		{
+			m_pSpillFile.Truncate();
+		}
+		m_bSpilling = false;
+		m_nSpillWrite.store(0, std::memory_order_relaxed);
+		m_nSpillRead.store(0, std::memory_order_relaxed);
+		m_nDiscardTo.store(m_pRingBuffer.GetTotalRead(), std::memory_order_relaxed);
+		m_nStagePos = 0;
+		m_nStageLength = 0;
+		m_nPeekRingLength = 0;
+		m_nTotalWritten.store(0, std::memory_order_relaxed);
+		m_nTotalRead.store(0, std::memory_order_release);
+		ResetStats();
+	}
+
+	/**
+	 * @brief Returns a snapshot of the counters. Safe to call from any thread.
+	 */
+	CReceiveBufferStats GetStats() const
+	{
+		CReceiveBufferStats stats;
+		stats.nBytesReceived = m_nBytesReceived.load(std::memory_order_relaxed);
+		stats.nBytesDropped = m_nBytesDropped.load(std::memory_order_relaxed);
+		stats.nBytesSpilled = m_nBytesSpilled.load(std::memory_order_relaxed);
+		stats.nHighWaterMark = m_nHighWaterMark.load(std::memory_order_relaxed);
+		return stats;
+	}
+
+	/**
+	 * @brief Returns the ring buffer capacity in bytes.
+	 */
+	int GetCapacity()
+	{
+		return m_pRingBuffer.GetMaxReadSize() + m_pRingBuffer.GetMaxWriteSize();
+	}
+
+	// Producer side
+
+	/**
+	 * @brief Hands out free ring buffer space for a zero-copy receive.
+	 *
+	 * Returns 0 while the spill segment holds data, because new bytes must then
+	 * be appended behind it: the producer should receive into its own buffer and
+	 * call Write() instead.
+	 */
+	int PrepareWrite(CRingBufferSpan pSpans[2])
+	{
+		if (m_bSpilling && !SpillDrained())
+		{
+			pSpans[0] = pSpans[1] = CRingBufferSpan{ nullptr, 0 };
+			return 0;
+		}
+		m_bSpilling = false;
+		const int nLength = m_pRingBuffer.PrepareWrite(pSpans);
+		m_pPrepared[0] = pSpans[0];
+		m_pPrepared[1] = pSpans[1];
+		return nLength;
+	}
+
+	/**
+	 * @brief Publishes nLength bytes received into the space from PrepareWrite().
+	 */
+	void CommitWrite(int nLength)
+	{
+		if (m_pCapture != nullptr)
+		{
+			const int nFirst = (nLength < m_pPrepared[0].nLength) ? nLength : m_pPrepared[0].nLength;
+			m_pCapture->Append(CAPTURE_RECEIVED, m_nCaptureSource, m_pPrepared[0].pData, nFirst);
+			m_pCapture->Append(CAPTURE_RECEIVED, m_nCaptureSource, m_pPrepared[1].pData, nLength - nFirst);
+		}
+		CTrafficChecker* pTrafficChecker = m_pTrafficChecker.load(std::memory_order_acquire);
+		if (pTrafficChecker != nullptr)
+		{
+			const int nFirst = (nLength < m_pPrepared[0].nLength) ? nLength : m_pPrepared[0].nLength;
+			pTrafficChecker->Feed(m_pPrepared[0].pData, nFirst);
+			pTrafficChecker->Feed(m_pPrepared[1].pData, nLength - nFirst);
+		}
+		m_pRingBuffer.CommitWrite(nLength);
+		m_nBytesReceived.fetch_add(nLength, std::memory_order_relaxed);
+		m_nTotalWritten.store(m_nTotalWritten.load(std::memory_order_relaxed) + nLength, std::memory_order_release);
+		UpdateHighWaterMark();
+	}
+
+	/**
+	 * @brief Copies bytes in, applying the overflow policy when they do not fit.
+	 *
+	 * @param pData Bytes to store.
+	 * @param nLength Number of bytes to store.
+	 * @param pfnWait Called while waiting for the consumer (OVERFLOW_BLOCK and
+	 *     OVERFLOW_DROP_OLDEST); it should wake the consumer, sleep briefly and
+	 *     return false to give up, in which case the remaining bytes are dropped.
+	 * @return true if every byte was stored, false if some were dropped.
+	 */
+	bool Write(const char* pData, int nLength, const std::function<bool()>& pfnWait)
+	{
+		if (m_pCapture != nullptr)
+		{
+			m_pCapture->Append(CAPTURE_RECEIVED, m_nCaptureSource, pData, nLength);
+		}
+		CTrafficChecker* pTrafficChecker = m_pTrafficChecker.load(std::memory_order_acquire);
+		if (pTrafficChecker != nullptr)
+		{
+			pTrafficChecker->Feed(pData, nLength);
+		}
+		m_nBytesReceived.fetch_add(nLength, std::memory_order_relaxed);
+		if (m_bSpilling)
+		{
+			if (!SpillDrained())
+			{
+				return Spill(pData, nLength);
+			}
+			m_bSpilling = false;
+		}
+
+		int nWritten = WritePartial(pData, nLength);
+		if (nWritten == nLength)
+		{
+			return true;
+		}
+		pData += nWritten;
+		nLength -= nWritten;
+
+		switch ((m_nPolicy == OVERFLOW_SPILL) && !OpenSpill() ? OVERFLOW_BLOCK : m_nPolicy)
+		{
+			case OVERFLOW_DROP_NEWEST:
+			{
+				Drop(nLength);
+				return false;
+			}
+			case OVERFLOW_DROP_OLDEST:
+			{
+				// Only the newest capacity's worth of a huge chunk can be kept
+				const int nCapacity = GetCapacity();
+				if (nLength > nCapacity)
+				{
+					Drop(nLength - nCapacity);
+					pData += nLength - nCapacity;
+					nLength = nCapacity;
+				}
+				while (nLength > 0)
+				{
+					const int nFree = m_pRingBuffer.GetMaxWriteSize();
+					if (nFree < nLength)
+					{
+						// Ask the consumer to discard just enough of the oldest bytes
+						const size_t nTarget = m_pRingBuffer.GetTotalRead() + (nLength - nFree);
+						size_t nCurrent = m_nDiscardTo.load(std::memory_order_relaxed);
+						if (nTarget > nCurrent)
+						{
+							m_nDiscardTo.store(nTarget, std::memory_order_release);
+						}
+						if (!pfnWait())
+						{
+							Drop(nLength);
+							return false;
+						}
+					}
+					nWritten = WritePartial(pData, nLength);
+					pData += nWritten;
+					nLength -= nWritten;
+				}
+				return true;
+			}
+			case OVERFLOW_SPILL:
+			{
+				m_bSpilling = true;
+				return Spill(pData, nLength);
+			}
+			default: // OVERFLOW_BLOCK
+			{
+				while (nLength > 0)
+				{
+					if (!pfnWait())
+					{
+						Drop(nLength);
+						return false;
+					}
+					nWritten = WritePartial(pData, nLength);
+					pData += nWritten;
+					nLength -= nWritten;
+				}
+				return true;
+			}
+		}
+	}
+
+	/**
+	 * @brief Returns the stream position just past the newest byte stored.
+	 */
+	size_t GetTotalWritten() const
+	{
+		return m_nTotalWritten.load(std::memory_order_acquire);
+	}
+
+	// Consumer side
+
+	/**
+	 * @brief Returns up to two spans of readable data, oldest first.
+	 *
+	 * The first span is ring buffer data; the second may continue with data
+	 * from the spill segment. Also carries out a pending OVERFLOW_DROP_OLDEST
+	 * discard request.
+	 *
+	 * @return Total number of readable bytes in the spans.
+	 */
+	int PeekReadable(CRingBufferSpan pSpans[2])
+	{
+		ApplyDiscard();
+
+		// Load the spill position first: ring data it depends on is then visible too
+		const uint64_t nSpillWrite = m_nSpillWrite.load(std::memory_order_acquire);
+		int nTotal = m_pRingBuffer.PeekReadable(pSpans);
+		m_nPeekRingLength = nTotal;
+		const uint64_t nSpillRead = m_nSpillRead.load(std::memory_order_relaxed);
+		if (nSpillRead == nSpillWrite)
+		{
+			return nTotal;
+		}
+
+		// Bring the next part of the spill segment into memory, also when only the
+		// start of a multi-byte character is left, so it can be decoded whole
+		const uint64_t nStageEnd = m_nStagePos + m_nStageLength;
+		if ((nSpillRead >= nStageEnd) || ((nStageEnd - nSpillRead < 4) && (nStageEnd < nSpillWrite)))
+		{
+			if (m_pStage == nullptr)
+			{
+				m_pStage.reset(new char[RECEIVE_BUFFER_STAGE_SIZE]);
+			}
+			const uint64_t nAvailable = nSpillWrite - nSpillRead;
+			m_nStagePos = nSpillRead;
+			m_nStageLength = (nAvailable < RECEIVE_BUFFER_STAGE_SIZE) ? static_cast<size_t>(nAvailable) : RECEIVE_BUFFER_STAGE_SIZE;
+			if (!m_pSpillFile.Read(m_nStagePos, m_pStage.get(), m_nStageLength))
+			{
+				// The segment cannot be read back: account for it as lost
+				m_nBytesDropped.fetch_add(nAvailable, std::memory_order_relaxed);
+				m_nStageLength = 0;
+				m_nSpillRead.store(nSpillWrite, std::memory_order_release);
+				return nTotal;
+			}
+		}
+		const size_t nOffset = static_cast<size_t>(nSpillRead - m_nStagePos);
+		const CRingBufferSpan stage = { m_pStage.get() + nOffset, static_cast<int>(m_nStageLength - nOffset) };
+		if (nTotal == 0)
+		{
+			pSpans[0] = stage;
+			pSpans[1] = CRingBufferSpan{ nullptr, 0 };
+			return stage.nLength;
+		}
+		if (pSpans[1].nLength == 0)
+		{
+			pSpans[1] = stage;
+			nTotal += stage.nLength;
+		}
+		return nTotal;
+	}
+
+	/**
+	 * @brief Releases nLength bytes from the front of the spans from PeekReadable().
+	 */
+	void Consume(int nLength)
+	{
+		const int nRingLength = (nLength < m_nPeekRingLength) ? nLength : m_nPeekRingLength;
+		m_pRingBuffer.Consume(nRingLength);
+		m_nPeekRingLength -= nRingLength;
+		if (nLength > nRingLength)
+		{
+			m_nSpillRead.store(m_nSpillRead.load(std::memory_order_relaxed) + (nLength - nRingLength), std::memory_order_release);
+		}
+		m_nTotalRead.store(m_nTotalRead.load(std::memory_order_relaxed) + nLength, std::memory_order_release);
+	}
+
+	/**
+	 * @brief Hands the readable bytes to pfnRead, oldest first, and consumes them.
+	 *
+	 * Goes on with PeekReadable/Consume until nothing is readable or nLimit bytes
+	 * were read, so a spill segment larger than the stage is read in one call,
+	 * one stage at a time.
+	 *
+	 * @param nLimit Most bytes to read; the last span may go past it.
+	 * @param pfnRead Called for every span, which is valid only during the call.
+	 * @return true if bytes are still readable, so the consumer must call again.
+	 */
+	bool Drain(size_t nLimit, const std::function<void(const char*, int)>& pfnRead)
+	{
+		size_t nRead = 0;
+		while (nRead < nLimit)
+		{
+			CRingBufferSpan pSpans[2];
+			const int nLength = PeekReadable(pSpans);
+			if (nLength == 0)
+			{
+				return false;
+			}
+			for (const CRingBufferSpan& span : pSpans)
+			{
+				if (span.nLength > 0)
+				{
+					pfnRead(span.pData, span.nLength);
+				}
+			}
+			Consume(nLength);
+			nRead += nLength;
+		}
+		return (GetTotalRead() != GetTotalWritten());
+	}
+
+	/**
+	 * @brief Returns the stream position of the oldest byte not yet consumed.
+	 */
+	size_t GetTotalRead() const
+	{
+		return m_nTotalRead.load(std::memory_order_acquire);
+	}
+
+protected:
+	void ResetStats()
+	{
+		m_nBytesReceived = 0;
+		m_nBytesDropped = 0;
+		m_nBytesSpilled = 0;
+		m_nHighWaterMark = 0;
+	}
+
+	bool SpillDrained() const
+	{
+		return (m_nSpillRead.load(std::memory_order_acquire) == m_nSpillWrite.load(std::memory_order_relaxed));
+	}
+
+	bool OpenSpill()
+	{
+		return m_pSpillFile.IsOpen() || m_pSpillFile.Open();
+	}
+
+	int WritePartial(const char* pData, int nLength)
+	{
+		const int nFree = m_pRingBuffer.GetMaxWriteSize();
+		const int nChunk = (nLength < nFree) ? nLength : nFree;
+		if ((nChunk > 0) && m_pRingBuffer.WriteBinary(pData, nChunk))
+		{
+			m_nTotalWritten.store(m_nTotalWritten.load(std::memory_order_relaxed) + nChunk, std::memory_order_release);
+			UpdateHighWaterMark();
+			return nChunk;
+		}
+		return 0;
+	}
+
+	bool Spill(const char* pData, int nLength)
+	{
+		const uint64_t nSpillWrite = m_nSpillWrite.load(std::memory_order_relaxed);
+		const uint64_t nRoom = (m_nSpillLimit > nSpillWrite) ? (m_nSpillLimit - nSpillWrite) : 0;
+		const int nChunk = (static_cast<uint64_t>(nLength) < nRoom) ? nLength : static_cast<int>(nRoom);
+		if ((nChunk > 0) && m_pSpillFile.Write(nSpillWrite, pData, nChunk))
+		{
+			m_nBytesSpilled.fetch_add(nChunk, std::memory_order_relaxed);
+			m_nSpillWrite.store(nSpillWrite + nChunk, std::memory_order_release);
+			m_nTotalWritten.store(m_nTotalWritten.load(std::memory_order_relaxed) + nChunk, std::memory_order_release);
+			if (nChunk == nLength)
+			{
+				return true;
+			}
+			Drop(nLength - nChunk);
+			return false;
+		}
+		Drop(nLength);
+		return false;
+	}
+
+	void Drop(int nLength)
+	{
+		m_nBytesDropped.fetch_add(nLength, std::memory_order_relaxed);
+	}
+
+	void UpdateHighWaterMark()
+	{
+		const uint64_t nLevel = static_cast<uint64_t>(m_pRingBuffer.GetTotalWritten() - m_pRingBuffer.GetTotalRead());
+		if (nLevel > m_nHighWaterMark.load(std::memory_order_relaxed))
+		{
+			m_nHighWaterMark.store(nLevel, std::memory_order_relaxed);
+		}
+	}
+
+	void ApplyDiscard()
+	{
+		const size_t nTarget = m_nDiscardTo.load(std::memory_order_acquire);
+		const size_t nRead = m_pRingBuffer.GetTotalRead();
+		if (nTarget > nRead)
+		{
+			const int nReadable = m_pRingBuffer.GetMaxReadSize();
+			const int nDiscard = (nTarget - nRead < static_cast<size_t>(nReadable)) ? static_cast<int>(nTarget - nRead) : nReadable;
+			m_pRingBuffer.Consume(nDiscard);
+			m_nBytesDropped.fetch_add(nDiscard, std::memory_order_relaxed);
+			m_nTotalRead.store(m_nTotalRead.load(std::memory_order_relaxed) + nDiscard, std::memory_order_release);
+		}
+	}
+
+	CRingBuffer m_pRingBuffer;
+	CSpillFile m_pSpillFile;
+	OverflowPolicy m_nPolicy;
+	uint64_t m_nSpillLimit;
+	CCaptureWriter* m_pCapture;
+	uint16_t m_nCaptureSource;
+	std::atomic<CTrafficChecker*> m_pTrafficChecker;
+
+	// Producer side
+	bool m_bSpilling;
+	CRingBufferSpan m_pPrepared[2]; // spans handed out by the last PrepareWrite()
+	std::atomic<size_t> m_nTotalWritten;
+	std::atomic<uint64_t> m_nSpillWrite;
+	std::atomic<size_t> m_nDiscardTo;
+
+	// Consumer side
+	std::atomic<size_t> m_nTotalRead;
+	std::atomic<uint64_t> m_nSpillRead;
+	std::unique_ptr<char[]> m_pStage;
+	uint64_t m_nStagePos;
+	size_t m_nStageLength;
+	int m_nPeekRingLength;
+
+	// Counters
+	std::atomic<uint64_t> m_nBytesReceived;
+	std::atomic<uint64_t> m_nBytesDropped;
+	std::atomic<uint64_t> m_nBytesSpilled;
+	std::atomic<uint64_t> m_nHighWaterMark;
+};
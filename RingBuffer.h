@@ -31,6 +31,23 @@
 // History:
 //     Dec 23 2001 - Initial creation.
 //     May 15 2002 - Posted to CodeProject.com.
+//     Oct 17 2026 - Lock-free single-producer/single-consumer indices
+//                   with power-of-two capacity, so the reader thread
+//                   and the UI thread no longer share a mutex.
+//                 - PrepareWrite/CommitWrite and PeekReadable/Consume
+//                   hand out the ring storage itself, so callers can
+//                   read from a device straight into the buffer and
+//                   decode straight out of it without extra copies.
+//                 - Optional mirrored storage: the same pages are mapped
+//                   twice back to back, so every readable or writable
+//                   region is one contiguous pointer range. Falls back
+//                   to the plain heap buffer where unsupported.
+//                 - FindChar and ReadTextLine use a vectorized scanner
+//                   over the readable spans. ReadTextLine also ends a
+//                   line at a lone CR or at a configurable frame
+//                   delimiter, and resumes scanning where it left off.
+//                 - GetTotalWritten/GetTotalRead expose the stream
+//                   positions, so callers can stamp chunks on arrival.
 //
 // Sample Usage:
 //
@@ -93,21 +110,66 @@
 #pragma once
 #endif // _MSC_VER > 1000
 
+#include <atomic>
+#include <cstddef>
+#include <cstring>
+#include <string>
+
+#include "DelimiterScanner.h"
+
+#if !defined(_WIN32) && defined(__linux__)
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
 ///////////////////////////////////////////////////////////////////////////////
 // Stardust Namespace
 ///////////////////////////////////////////////////////////////////////////////
 
-class CRingBuffer  
+// Size of a cache line, used to keep the producer and consumer indices apart.
+#define RINGBUFFER_CACHE_LINE_SIZE 64
+
+///////////////////////////////////////////////////////////////////////////////
+// CRingBufferSpan - a contiguous region of the ring buffer storage.
+// Because the ring wraps, any readable or writable area is described by at
+// most two spans; the second one is empty unless the area wraps around.
+///////////////////////////////////////////////////////////////////////////////
+
+struct CRingBufferSpan
+{
+	char * pData; // start of the region inside the ring buffer
+	int nLength;  // size of the region (in bytes)
+};
+
+class CRingBuffer
 {
 protected:
 	///////////////////////////////////////////////////////////////////
 	// Protected Member Variables
 	//
+	// The read and write pointers are free running counters; the slot of
+	// a counter is (counter & m_nBufMask). Only the producer thread
+	// stores m_nWritePtr and only the consumer thread stores m_nReadPtr,
+	// so no lock is needed as long as there is one thread on each side.
+	// The padding keeps each side's hot variables on its own cache line.
+	//
 	char * m_pBuf;
 	char * m_pTmpBuf; // dupe buf for working so no alloc/free while running.
-	int m_nBufSize;   // the size of the ring buffer
-	int m_iReadPtr;   // the read pointer
-	int m_iWritePtr;  // the write pointer
+	size_t m_nBufSize; // the size of the ring buffer (power of two)
+	size_t m_nBufMask; // m_nBufSize - 1
+	size_t m_nViewSize; // contiguous bytes mapped at m_pBuf (2 * m_nBufSize when mirrored)
+	bool m_bMirrored; // storage is mapped twice back to back
+	char m_padding0[RINGBUFFER_CACHE_LINE_SIZE];
+
+	std::atomic<size_t> m_nWritePtr; // the write pointer (producer owned)
+	size_t m_nCachedReadPtr;         // producer's last view of m_nReadPtr
+	char m_padding1[RINGBUFFER_CACHE_LINE_SIZE - sizeof(std::atomic<size_t>) - sizeof(size_t)];
+
+	std::atomic<size_t> m_nReadPtr;  // the read pointer (consumer owned)
+	size_t m_nCachedWritePtr;        // consumer's last view of m_nWritePtr
+	size_t m_nScanPtr;               // ReadTextLine found no line end before this counter
+	char m_chFrameDelimiter;         // extra line terminator besides CR and LF
+	char m_padding2[RINGBUFFER_CACHE_LINE_SIZE - sizeof(std::atomic<size_t>) - 2 * sizeof(size_t) - sizeof(char)];
 
 public:
 	///////////////////////////////////////////////////////////////////
@@ -118,8 +180,15 @@ public:
 		m_pBuf = nullptr;
 		m_pTmpBuf = nullptr;
 		m_nBufSize = 0;
-		m_iReadPtr = 0;
-		m_iWritePtr = 0;
+		m_nBufMask = 0;
+		m_nViewSize = 0;
+		m_bMirrored = false;
+		m_chFrameDelimiter = '\n';
+		m_nWritePtr.store(0, std::memory_order_relaxed);
+		m_nCachedReadPtr = 0;
+		m_nReadPtr.store(0, std::memory_order_relaxed);
+		m_nCachedWritePtr = 0;
+		m_nScanPtr = 0;
 	}
 
 	///////////////////////////////////////////////////////////////////
@@ -134,24 +203,44 @@ public:
 	// Method: Create
 	// Purpose: Initializes the ring buffer for use.
 	// Parameters:
-	//     [in] iBufSize -- maximum size of the ring buffer
-	// Return Value: TRUE if successful, otherwise FALSE.
+	//     [in] iBufSize -- maximum size of the ring buffer, rounded up
+	//         to the next power of two.
+	//     [in] bMirrored -- map the storage twice back to back, so that
+	//         readable and writable regions never wrap. The size is then
+	//         also rounded up to the allocation granularity. If the
+	//         platform cannot do it, a plain buffer is used instead.
+	// Return Value: true if successful, otherwise false.
 	//
-	BOOL Create( int iBufSize )
+	bool Create( int iBufSize, bool bMirrored = false )
 	{
-		BOOL bResult = FALSE;
+		bool bResult = false;
 		{
-			m_pBuf = new char[ iBufSize ];
+			Destroy();
+
+			size_t nBufSize = 1;
+			while( nBufSize < static_cast<size_t>( iBufSize ) )
+				nBufSize <<= 1;
+
+			if( bMirrored )
+				m_bMirrored = CreateMirrored( nBufSize );
+
+			if( !m_bMirrored )
+			{
+				m_pBuf = new char[ nBufSize ];
+				m_nViewSize = nBufSize;
+			}
 			if( m_pBuf )
 			{
-				m_nBufSize = iBufSize;
-				ZeroMemory( m_pBuf, m_nBufSize );
+				m_nBufSize = nBufSize;
+				m_nBufMask = nBufSize - 1;
+				memset( m_pBuf, 0, m_nBufSize );
 
-				m_pTmpBuf = new char[ iBufSize ];
+				// one extra byte for the terminator added by ReadTextLine
+				m_pTmpBuf = new char[ nBufSize + 1 ];
 				if( m_pTmpBuf )
 				{
-					ZeroMemory( m_pTmpBuf, m_nBufSize );
-					bResult = TRUE;
+					memset( m_pTmpBuf, 0, m_nBufSize + 1 );
+					bResult = true;
 				}
 			}
 		}
@@ -161,104 +250,175 @@ public:
 	///////////////////////////////////////////////////////////////////
 	// Method: Destroy
 	// Purpose: Cleans up ring buffer by freeing memory and resetting
-	//     member variables to original state.
+	//     member variables to original state. Must not be called while
+	//     a producer or consumer thread is still using the buffer.
 	// Parameters: (None)
 	// Return Value: (None)
 	//
 	void Destroy()
 	{
-		if( m_pBuf )
-			delete m_pBuf;
+		if( m_bMirrored )
+			DestroyMirrored();
+		else if( m_pBuf )
+			delete[] m_pBuf;
 
 		if( m_pTmpBuf )
-			delete m_pTmpBuf;
+			delete[] m_pTmpBuf;
 
 		m_pBuf = nullptr;
 		m_pTmpBuf = nullptr;
 		m_nBufSize = 0;
-		m_iReadPtr = 0;
-		m_iWritePtr = 0;
+		m_nBufMask = 0;
+		m_nViewSize = 0;
+		m_bMirrored = false;
+		m_nWritePtr.store(0, std::memory_order_relaxed);
+		m_nCachedReadPtr = 0;
+		m_nReadPtr.store(0, std::memory_order_relaxed);
+		m_nCachedWritePtr = 0;
+		m_nScanPtr = 0;
+	}
+
+	///////////////////////////////////////////////////////////////////
+	// Method: GetBufferSize
+	// Purpose: Returns the capacity of the ring buffer.
+	// Parameters: (None)
+	// Return Value: Capacity (in bytes) of the ring buffer.
+	//
+	int GetBufferSize() const
+	{
+		return static_cast<int>( m_nBufSize );
+	}
+
+	///////////////////////////////////////////////////////////////////
+	// Method: IsMirrored
+	// Purpose: Tells whether the storage is mapped twice back to back,
+	//     in which case every span returned by PrepareWrite and
+	//     PeekReadable is contiguous (the second span is always empty).
+	// Parameters: (None)
+	// Return Value: true if the storage is mirrored, otherwise false.
+	//
+	bool IsMirrored() const
+	{
+		return m_bMirrored;
+	}
+
+	///////////////////////////////////////////////////////////////////
+	// Method: SetFrameDelimiter
+	// Purpose: Sets an extra character that ends a line for
+	//     ReadTextLine, besides LF and CR (e.g. '\0' or ETX for framed
+	//     protocols). Consumer side.
+	// Parameters:
+	//     [in] chDelimiter - The frame delimiter ('\n' for none).
+	// Return Value: (None)
+	//
+	void SetFrameDelimiter( char chDelimiter )
+	{
+		m_chFrameDelimiter = chDelimiter;
+		// data already scanned may contain the new delimiter
+		m_nScanPtr = m_nReadPtr.load( std::memory_order_relaxed );
+	}
+
+	///////////////////////////////////////////////////////////////////
+	// Method: GetFrameDelimiter
+	// Purpose: Returns the extra line terminator used by ReadTextLine.
+	// Parameters: (None)
+	// Return Value: The frame delimiter.
+	//
+	char GetFrameDelimiter() const
+	{
+		return m_chFrameDelimiter;
 	}
 
 	///////////////////////////////////////////////////////////////////
 	// Method: GetMaxReadSize
 	// Purpose: Returns the amount of data (in bytes) available for
-	//     reading from the buffer.
+	//     reading from the buffer. Consumer side.
 	// Parameters: (None)
 	// Return Value: Amount of data (in bytes) available for reading.
 	//
 	int GetMaxReadSize()
 	{
-		int iBytes = 0;
-		if ( m_pBuf )
-		{
-			if ( m_iReadPtr <= m_iWritePtr )
-				iBytes = m_iWritePtr - m_iReadPtr;
-
-			else if ( m_iReadPtr > m_iWritePtr )
-				iBytes = (m_nBufSize - m_iReadPtr) + m_iWritePtr;
-		}
-		return iBytes;
+		m_nCachedWritePtr = m_nWritePtr.load( std::memory_order_acquire );
+		return static_cast<int>( m_nCachedWritePtr - m_nReadPtr.load( std::memory_order_relaxed ) );
 	}
 
 	///////////////////////////////////////////////////////////////////
 	// Method: GetMaxWriteSize
 	// Purpose: Returns the amount of space (in bytes) available for
-	//     writing into the buffer.
+	//     writing into the buffer. Producer side.
 	// Parameters: (None)
 	// Return Value: Amount of space (in bytes) available for writing.
 	//
 	int GetMaxWriteSize()
 	{
-		int iBytes = 0;
-		if ( m_pBuf )
-		{
-			// not all the buffer is for our use. 1 bytes has to be kept as EOF marker.
-			// otherwise we cant tell if (m_iReadPtr == m_iWritePtr) is full or empty
-			if ( m_iWritePtr < m_iReadPtr )
-				iBytes = m_iReadPtr - m_iWritePtr - 1;
+		m_nCachedReadPtr = m_nReadPtr.load( std::memory_order_acquire );
+		return static_cast<int>( m_nBufSize - ( m_nWritePtr.load( std::memory_order_relaxed ) - m_nCachedReadPtr ) );
+	}
 
-			if ( m_iWritePtr >= m_iReadPtr )
-				iBytes = (m_nBufSize - m_iWritePtr) + m_iReadPtr - 1;
-		}
-		return iBytes;
+	///////////////////////////////////////////////////////////////////
+	// Method: GetTotalWritten
+	// Purpose: Returns the number of bytes committed since Create,
+	//     i.e. the stream position just past the newest byte. Safe
+	//     to call from either side.
+	// Parameters: (None)
+	// Return Value: Total number of bytes written.
+	//
+	size_t GetTotalWritten() const
+	{
+		return m_nWritePtr.load( std::memory_order_acquire );
+	}
+
+	///////////////////////////////////////////////////////////////////
+	// Method: GetTotalRead
+	// Purpose: Returns the number of bytes consumed since Create,
+	//     i.e. the stream position of the oldest unread byte. Safe
+	//     to call from either side.
+	// Parameters: (None)
+	// Return Value: Total number of bytes read.
+	//
+	size_t GetTotalRead() const
+	{
+		return m_nReadPtr.load( std::memory_order_acquire );
 	}
 
 	///////////////////////////////////////////////////////////////////
 	// Method: ReadBinary
 	// Purpose: Reads (and extracts) data from the ring buffer.
+	//     Consumer side.
 	// Parameters:
 	//     [in/out] pBuf - Pointer to where read data will be stored.
 	//     [in] nBufLen - Size of the data to be read (in bytes).
-	// Return Value: TRUE upon success, otherwise FALSE.
-	// 
-	BOOL ReadBinary( char * pBuf, int nBufLen )
+	// Return Value: true upon success, otherwise false.
+	//
+	bool ReadBinary( char * pBuf, int nBufLen )
 	{
-		BOOL bResult = FALSE;
+		bool bResult = false;
 		{
-			if ( nBufLen <= GetMaxReadSize() )
+			const size_t nReadPtr = m_nReadPtr.load( std::memory_order_relaxed );
+			const size_t nLength = static_cast<size_t>( nBufLen );
+
+			// only reload the shared write pointer when the cached one is not enough
+			if ( nLength > m_nCachedWritePtr - nReadPtr )
+				m_nCachedWritePtr = m_nWritePtr.load( std::memory_order_acquire );
+
+			if ( nLength <= m_nCachedWritePtr - nReadPtr )
 			{
-				// easy case, no wrapping
-				if ( m_iReadPtr + nBufLen < m_nBufSize )
-				{
-					CopyMemory( pBuf, &m_pBuf[m_iReadPtr], nBufLen );
-					m_iReadPtr += nBufLen;
-				}
-				else // harder case, buffer wraps
-				{
-					int iFirstChunkSize = m_nBufSize - m_iReadPtr;
-					int iSecondChunkSize = nBufLen - iFirstChunkSize;
+				const size_t iOffset = nReadPtr & m_nBufMask;
+				const size_t iFirstChunkSize = ( nLength < m_nViewSize - iOffset ) ? nLength : m_nViewSize - iOffset;
 
-					CopyMemory( pBuf, &m_pBuf[m_iReadPtr], iFirstChunkSize );
-					CopyMemory( &pBuf[iFirstChunkSize], &m_pBuf[0], iSecondChunkSize );
+				memcpy( pBuf, &m_pBuf[iOffset], iFirstChunkSize );
+				// harder case, buffer wraps
+				if ( iFirstChunkSize < nLength )
+					memcpy( &pBuf[iFirstChunkSize], &m_pBuf[0], nLength - iFirstChunkSize );
 
-					m_iReadPtr = iSecondChunkSize;
-				}
-				bResult = TRUE;
+				m_nReadPtr.store( nReadPtr + nLength, std::memory_order_release );
+				bResult = true;
 			}
 			else
 			{
+#ifdef TRACE
 				TRACE(_T("%s, buffer underflow! max size: %d. trying to read: %d\n"), __FUNCTION__, GetMaxReadSize(), nBufLen);
+#endif
 			}
 		}
 		return bResult;
@@ -266,86 +426,145 @@ public:
 
 	///////////////////////////////////////////////////////////////////
 	// Method: WriteBinary
-	// Purpose: Writes binary data into the ring buffer.
+	// Purpose: Writes binary data into the ring buffer. Producer side.
 	// Parameters:
 	//     [in] pBuf - Pointer to the data to write.
 	//     [in] nBufLen - Size of the data to write (in bytes).
-	// Return Value: TRUE upon success, otherwise FALSE.
-	// 
-	BOOL WriteBinary( char * pBuf, int nBufLen )
+	// Return Value: true upon success, otherwise false.
+	//
+	bool WriteBinary( const char * pBuf, int nBufLen )
 	{
-		BOOL bResult = FALSE;
+		bool bResult = false;
 		{
-			if ( nBufLen <= GetMaxWriteSize() )
+			const size_t nWritePtr = m_nWritePtr.load( std::memory_order_relaxed );
+			const size_t nLength = static_cast<size_t>( nBufLen );
+
+			// only reload the shared read pointer when the cached one is not enough
+			if ( nLength > m_nBufSize - ( nWritePtr - m_nCachedReadPtr ) )
+				m_nCachedReadPtr = m_nReadPtr.load( std::memory_order_acquire );
+
+			if ( nLength <= m_nBufSize - ( nWritePtr - m_nCachedReadPtr ) )
 			{
-				// easy case, no wrapping
-				if ( m_iWritePtr + nBufLen < m_nBufSize )
-				{
-					CopyMemory( &m_pBuf[m_iWritePtr], pBuf, nBufLen );
-					m_iWritePtr += nBufLen;
-				}
-				else // harder case we need to wrap
-				{
-					int iFirstChunkSize = m_nBufSize - m_iWritePtr;
-					int iSecondChunkSize = nBufLen - iFirstChunkSize;
+				const size_t iOffset = nWritePtr & m_nBufMask;
+				const size_t iFirstChunkSize = ( nLength < m_nViewSize - iOffset ) ? nLength : m_nViewSize - iOffset;
 
-					CopyMemory( &m_pBuf[m_iWritePtr], pBuf, iFirstChunkSize );
-					CopyMemory( &m_pBuf[0], &pBuf[iFirstChunkSize], iSecondChunkSize );
+				memcpy( &m_pBuf[iOffset], pBuf, iFirstChunkSize );
+				// harder case we need to wrap
+				if ( iFirstChunkSize < nLength )
+					memcpy( &m_pBuf[0], &pBuf[iFirstChunkSize], nLength - iFirstChunkSize );
 
-					m_iWritePtr = iSecondChunkSize;
-				}
-				bResult = TRUE;
+				m_nWritePtr.store( nWritePtr + nLength, std::memory_order_release );
+				bResult = true;
 			}
 			else
 			{
+#ifdef TRACE
 				TRACE(_T("%s, buffer overflow! max size: %d. trying to write: %d\n"), __FUNCTION__, GetMaxWriteSize(), nBufLen);
+#endif
 			}
 		}
 		return bResult;
 	}
 
+	///////////////////////////////////////////////////////////////////
+	// Method: PrepareWrite
+	// Purpose: Returns the free space of the ring buffer as up to two
+	//     contiguous spans, so the producer can fill it in place (for
+	//     example by passing pSpans[0].pData to a Read/Receive call).
+	//     Nothing becomes visible to the consumer until CommitWrite.
+	//     Producer side.
+	// Parameters:
+	//     [out] pSpans - Array of two spans receiving the free regions.
+	// Return Value: Total free space (in bytes) described by the spans.
+	//
+	int PrepareWrite( CRingBufferSpan pSpans[2] )
+	{
+		const size_t nWritePtr = m_nWritePtr.load( std::memory_order_relaxed );
+		m_nCachedReadPtr = m_nReadPtr.load( std::memory_order_acquire );
+
+		const size_t nFree = m_nBufSize - ( nWritePtr - m_nCachedReadPtr );
+		const size_t iOffset = nWritePtr & m_nBufMask;
+		const size_t nFirstChunkSize = ( nFree < m_nViewSize - iOffset ) ? nFree : m_nViewSize - iOffset;
+
+		pSpans[0].pData = m_pBuf + iOffset;
+		pSpans[0].nLength = static_cast<int>( nFirstChunkSize );
+		pSpans[1].pData = m_pBuf;
+		pSpans[1].nLength = static_cast<int>( nFree - nFirstChunkSize );
+		return static_cast<int>( nFree );
+	}
+
+	///////////////////////////////////////////////////////////////////
+	// Method: CommitWrite
+	// Purpose: Publishes bytes written into the spans returned by
+	//     PrepareWrite. Producer side.
+	// Parameters:
+	//     [in] nBufLen - Number of bytes written (in bytes), not more
+	//         than the total returned by PrepareWrite.
+	// Return Value: (None)
+	//
+	void CommitWrite( int nBufLen )
+	{
+		const size_t nWritePtr = m_nWritePtr.load( std::memory_order_relaxed );
+		m_nWritePtr.store( nWritePtr + static_cast<size_t>( nBufLen ), std::memory_order_release );
+	}
+
+	///////////////////////////////////////////////////////////////////
+	// Method: PeekReadable
+	// Purpose: Returns the readable data of the ring buffer as up to
+	//     two contiguous spans, without extracting it. The data stays
+	//     valid until it is released with Consume. Consumer side.
+	// Parameters:
+	//     [out] pSpans - Array of two spans receiving the data regions.
+	// Return Value: Total amount of data (in bytes) in the spans.
+	//
+	int PeekReadable( CRingBufferSpan pSpans[2] )
+	{
+		const size_t nReadPtr = m_nReadPtr.load( std::memory_order_relaxed );
+		m_nCachedWritePtr = m_nWritePtr.load( std::memory_order_acquire );
+
+		const size_t nUsed = m_nCachedWritePtr - nReadPtr;
+		const size_t iOffset = nReadPtr & m_nBufMask;
+		const size_t nFirstChunkSize = ( nUsed < m_nViewSize - iOffset ) ? nUsed : m_nViewSize - iOffset;
+
+		pSpans[0].pData = m_pBuf + iOffset;
+		pSpans[0].nLength = static_cast<int>( nFirstChunkSize );
+		pSpans[1].pData = m_pBuf;
+		pSpans[1].nLength = static_cast<int>( nUsed - nFirstChunkSize );
+		return static_cast<int>( nUsed );
+	}
+
+	///////////////////////////////////////////////////////////////////
+	// Method: Consume
+	// Purpose: Releases data returned by PeekReadable, making its space
+	//     available to the producer again. Consumer side.
+	// Parameters:
+	//     [in] nBufLen - Number of bytes consumed (in bytes), not more
+	//         than the total returned by PeekReadable.
+	// Return Value: (None)
+	//
+	void Consume( int nBufLen )
+	{
+		const size_t nReadPtr = m_nReadPtr.load( std::memory_order_relaxed );
+		m_nReadPtr.store( nReadPtr + static_cast<size_t>( nBufLen ), std::memory_order_release );
+	}
+
 	///////////////////////////////////////////////////////////////////
 	// Method: PeekChar
 	// Purpose: Peeks at a character at the given position in the ring
-	//     buffer, without extracting it.
+	//     buffer, without extracting it. Consumer side.
 	// Parameters:
 	//     [in] iPos - Index of the character to peek (zero-based).
 	//     [out] ch - The character peeked.
-	// Return Value: TRUE upon success, otherwise FALSE.
-	// 
-	BOOL PeekChar( int iPos, char & ch )
+	// Return Value: true upon success, otherwise false.
+	//
+	bool PeekChar( int iPos, char & ch )
 	{
-		BOOL bResult = FALSE;
+		bool bResult = false;
 		{
-			if( iPos < GetMaxReadSize() )
+			if( iPos >= 0 && iPos < GetMaxReadSize() )
 			{
-				if( m_iWritePtr > m_iReadPtr )
-				{
-					// easy case, buffer doesn't wrap
-					ch = m_pBuf[ m_iReadPtr+iPos ];
-					bResult = TRUE;
-				}
-				else if( m_iWritePtr == m_iReadPtr )
-				{
-					// nothing in the buffer
-				}
-				else if( m_iWritePtr < m_iReadPtr )
-				{
-					// harder case, buffer wraps
-
-					if( m_iReadPtr + iPos < m_nBufSize )
-					{
-						// pos was in first chunk
-						ch = m_pBuf[ m_iReadPtr + iPos ];
-						bResult = TRUE;
-					}
-					else
-					{
-						// pos is in second chunk
-						ch = m_pBuf[ iPos - (m_nBufSize-m_iReadPtr) ];
-						bResult = TRUE;
-					}
-				}
+				ch = m_pBuf[ ( m_nReadPtr.load( std::memory_order_relaxed ) + iPos ) & m_nBufMask ];
+				bResult = true;
 			}
 		}
 		return bResult;
@@ -354,30 +573,72 @@ public:
 	///////////////////////////////////////////////////////////////////
 	// Method: FindChar
 	// Purpose: Determines if the specified character is in the ring
-	//     buffer, and if so, returns the index position.
+	//     buffer, and if so, returns the index position. Consumer side.
 	// Parameters:
 	//     [in] chLookFor - Character to look for in the ring buffer.
 	//     [out] riPos - The index position of the character, if found.
-	// Return Value: TRUE upon success, otherwise FALSE.
-	// 
-	BOOL FindChar( char chLookFor, int & riPos )
+	// Return Value: true upon success, otherwise false.
+	//
+	bool FindChar( char chLookFor, int & riPos )
 	{
-		BOOL bResult = FALSE;
+		bool bResult = false;
 		{
-			int iSize = GetMaxReadSize();
+			const size_t nSize = static_cast<size_t>( GetMaxReadSize() );
+			const size_t nFound = FindDelimiter( 0, nSize, chLookFor, chLookFor, chLookFor );
+			if( nFound < nSize )
+			{
+				riPos = static_cast<int>( nFound );
+				bResult = true;
+			}
+		}
+		return bResult;
+	}
 
-			for( int i = 0; i < iSize; i++ )
+	///////////////////////////////////////////////////////////////////
+	// Method: FindLineEnd
+	// Purpose: Determines if a complete line is in the ring buffer. A
+	//     line ends with LF, CR LF, a lone CR or the frame delimiter.
+	//     A CR at the very end of the data is not a line end yet, as
+	//     its LF may still be on the way. Scanning resumes after the
+	//     data that was searched by the previous call. Consumer side.
+	// Parameters:
+	//     [out] riSize - Size of the line (in bytes), terminator included.
+	// Return Value: true if a complete line is available, otherwise false.
+	//
+	bool FindLineEnd( int & riSize )
+	{
+		bool bResult = false;
+		{
+			const size_t nReadPtr = m_nReadPtr.load( std::memory_order_relaxed );
+			const size_t nSize = static_cast<size_t>( GetMaxReadSize() );
+
+			// resume where the last unsuccessful scan stopped (a counter
+			// behind the read pointer wraps to a huge value and is ignored)
+			size_t nStart = m_nScanPtr - nReadPtr;
+			if( nStart > nSize )
+				nStart = 0;
+
+			const size_t nFound = FindDelimiter( nStart, nSize, '\n', '\r', m_chFrameDelimiter );
+			if( nFound == nSize )
 			{
-				char ch;
-				if( PeekChar( i, ch ) )
-				{
-					if( ch == chLookFor )
-					{
-						riPos = i;
-						bResult = TRUE;
-						break;
-					}
-				}
+				m_nScanPtr = nReadPtr + nSize;
+			}
+			else if( m_pBuf[ ( nReadPtr + nFound ) & m_nBufMask ] != '\r' || m_chFrameDelimiter == '\r' )
+			{
+				riSize = static_cast<int>( nFound + 1 );
+				bResult = true;
+			}
+			else if( nFound + 1 < nSize )
+			{
+				// swallow the LF of a CR LF pair
+				const bool bCRLF = m_pBuf[ ( nReadPtr + nFound + 1 ) & m_nBufMask ] == '\n';
+				riSize = static_cast<int>( nFound + ( bCRLF ? 2 : 1 ) );
+				bResult = true;
+			}
+			else
+			{
+				// look at the trailing CR again once more data arrives
+				m_nScanPtr = nReadPtr + nFound;
 			}
 		}
 		return bResult;
@@ -386,29 +647,199 @@ public:
 	///////////////////////////////////////////////////////////////////
 	// Method: ReadTextLine
 	// Purpose: Reads a line of text from the buffer, if available.
+	//     See FindLineEnd for what ends a line. Consumer side.
 	// Parameters:
 	//     [out] strLine - The line of text.
-	// Return Value: TRUE upon success, otherwise FALSE.
-	// 
-	BOOL ReadTextLine( CString & strLine )
+	// Return Value: true upon success, otherwise false.
+	//
+	bool ReadTextLine( std::string & strLine )
+	{
+		bool bResult = false;
+		{
+			int iSize = 0;
+			if( FindLineEnd(iSize) )
+			{
+
+				if( ReadBinary( m_pTmpBuf, iSize ) )
+				{
+					strLine.assign( m_pTmpBuf, iSize );
+					bResult = true;
+				}
+			}
+		}
+		return bResult;
+	}
+
+#ifdef _MFC_VER
+	bool ReadTextLine( CString & strLine )
 	{
-		BOOL bResult = FALSE;
+		bool bResult = false;
 		{
-			int iPos = 0;
-			if( FindChar('\n',iPos) )
+			int iSize = 0;
+			if( FindLineEnd(iSize) )
 			{
-				int iSize = iPos+1;
 
 				if( ReadBinary( m_pTmpBuf, iSize ) )
 				{
 					m_pTmpBuf[ iSize ] = '\0';
 					strLine = m_pTmpBuf;
-					bResult = TRUE;
+					bResult = true;
 				}
 			}
 		}
 		return bResult;
 	}
+#endif // _MFC_VER
+
+protected:
+	///////////////////////////////////////////////////////////////////
+	// Method: FindDelimiter
+	// Purpose: Searches the readable data for the first of up to three
+	//     delimiters, span by span, with the vectorized scanner.
+	// Parameters:
+	//     [in] nStart - Index of the first byte to search (zero-based).
+	//     [in] nSize - Amount of readable data (in bytes).
+	//     [in] chFirst, chSecond, chThird - Characters to look for.
+	// Return Value: Index of the first delimiter, or nSize if none.
+	//
+	size_t FindDelimiter( size_t nStart, size_t nSize, char chFirst, char chSecond, char chThird ) const
+	{
+		const size_t iOffset = ( m_nReadPtr.load( std::memory_order_relaxed ) + nStart ) & m_nBufMask;
+		const size_t nLength = nSize - nStart;
+		const size_t nFirstChunkSize = ( nLength < m_nViewSize - iOffset ) ? nLength : m_nViewSize - iOffset;
+
+		size_t nFound = FindFirstDelimiter( &m_pBuf[iOffset], nFirstChunkSize, chFirst, chSecond, chThird );
+		// harder case, buffer wraps
+		if( nFound == nFirstChunkSize && nFirstChunkSize < nLength )
+			nFound += FindFirstDelimiter( &m_pBuf[0], nLength - nFirstChunkSize, chFirst, chSecond, chThird );
+		return nStart + nFound;
+	}
+
+	///////////////////////////////////////////////////////////////////
+	// Method: CreateMirrored
+	// Purpose: Maps one shared memory object twice at adjacent virtual
+	//     addresses, so byte m_pBuf[i + nBufSize] aliases m_pBuf[i].
+	// Parameters:
+	//     [in/out] nBufSize - Size of the ring buffer (power of two);
+	//         rounded up to the allocation granularity on success.
+	// Return Value: true if successful, otherwise false.
+	//
+	bool CreateMirrored( size_t & nBufSize )
+	{
+#if defined(_WIN32)
+		// VirtualAlloc2 and MapViewOfFile3 need Windows 10 version 1803,
+		// so resolve them at run time and fall back on older systems.
+		typedef PVOID (WINAPI *PFN_VIRTUALALLOC2)( HANDLE, PVOID, SIZE_T, ULONG, ULONG, MEM_EXTENDED_PARAMETER *, ULONG );
+		typedef PVOID (WINAPI *PFN_MAPVIEWOFFILE3)( HANDLE, HANDLE, PVOID, ULONG64, SIZE_T, ULONG, ULONG, MEM_EXTENDED_PARAMETER *, ULONG );
+		const HMODULE hKernelBase = GetModuleHandle( _T("kernelbase.dll") );
+		if( hKernelBase == nullptr )
+			return false;
+		const PFN_VIRTUALALLOC2 pfnVirtualAlloc2 = reinterpret_cast<PFN_VIRTUALALLOC2>( GetProcAddress( hKernelBase, "VirtualAlloc2" ) );
+		const PFN_MAPVIEWOFFILE3 pfnMapViewOfFile3 = reinterpret_cast<PFN_MAPVIEWOFFILE3>( GetProcAddress( hKernelBase, "MapViewOfFile3" ) );
+		if( pfnVirtualAlloc2 == nullptr || pfnMapViewOfFile3 == nullptr )
+			return false;
+
+		SYSTEM_INFO sysInfo = { 0, };
+		GetSystemInfo( &sysInfo );
+		while( nBufSize < sysInfo.dwAllocationGranularity )
+			nBufSize <<= 1;
+
+		const HANDLE hSection = CreateFileMapping( INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE,
+			static_cast<DWORD>( static_cast<ULONG64>( nBufSize ) >> 32 ), static_cast<DWORD>( nBufSize ), nullptr );
+		if( hSection == nullptr )
+			return false;
+
+		// reserve both halves as one placeholder, then split it in two
+		char * pPlaceholder = static_cast<char *>( pfnVirtualAlloc2( nullptr, nullptr, 2 * nBufSize,
+			MEM_RESERVE | MEM_RESERVE_PLACEHOLDER, PAGE_NOACCESS, nullptr, 0 ) );
+		if( pPlaceholder == nullptr )
+		{
+			CloseHandle( hSection );
+			return false;
+		}
+		VirtualFree( pPlaceholder, nBufSize, MEM_RELEASE | MEM_PRESERVE_PLACEHOLDER );
+
+		void * pView1 = pfnMapViewOfFile3( hSection, nullptr, pPlaceholder, 0, nBufSize,
+			MEM_REPLACE_PLACEHOLDER, PAGE_READWRITE, nullptr, 0 );
+		void * pView2 = pfnMapViewOfFile3( hSection, nullptr, pPlaceholder + nBufSize, 0, nBufSize,
+			MEM_REPLACE_PLACEHOLDER, PAGE_READWRITE, nullptr, 0 );
+		// the views keep the section alive
+		CloseHandle( hSection );
+
+		if( pView1 == nullptr || pView2 == nullptr )
+		{
+			if( pView1 != nullptr )
+				UnmapViewOfFile( pView1 );
+			else
+				VirtualFree( pPlaceholder, 0, MEM_RELEASE );
+			if( pView2 != nullptr )
+				UnmapViewOfFile( pView2 );
+			else
+				VirtualFree( pPlaceholder + nBufSize, 0, MEM_RELEASE );
+			return false;
+		}
+
+		m_pBuf = pPlaceholder;
+		m_nViewSize = 2 * nBufSize;
+		return true;
+#elif defined(__linux__)
+		const size_t nPageSize = static_cast<size_t>( sysconf( _SC_PAGESIZE ) );
+		while( nBufSize < nPageSize )
+			nBufSize <<= 1;
+
+		const int nFd = memfd_create( "CRingBuffer", MFD_CLOEXEC );
+		if( nFd < 0 )
+			return false;
+		if( ftruncate( nFd, static_cast<off_t>( nBufSize ) ) != 0 )
+		{
+			close( nFd );
+			return false;
+		}
+
+		// reserve the whole range first, then map the object over both halves
+		char * pBase = static_cast<char *>( mmap( nullptr, 2 * nBufSize, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0 ) );
+		if( pBase == MAP_FAILED )
+		{
+			close( nFd );
+			return false;
+		}
+		const bool bMapped =
+			mmap( pBase, nBufSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, nFd, 0 ) != MAP_FAILED &&
+			mmap( pBase + nBufSize, nBufSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, nFd, 0 ) != MAP_FAILED;
+		// the mappings keep the memory object alive
+		close( nFd );
+
+		if( !bMapped )
+		{
+			munmap( pBase, 2 * nBufSize );
+			return false;
+		}
+
+		m_pBuf = pBase;
+		m_nViewSize = 2 * nBufSize;
+		return true;
+#else
+		(void) nBufSize;
+		return false;
+#endif
+	}
+
+	///////////////////////////////////////////////////////////////////
+	// Method: DestroyMirrored
+	// Purpose: Unmaps the storage set up by CreateMirrored.
+	// Parameters: (None)
+	// Return Value: (None)
+	//
+	void DestroyMirrored()
+	{
+#if defined(_WIN32)
+		UnmapViewOfFile( m_pBuf );
+		UnmapViewOfFile( m_pBuf + m_nBufSize );
+#elif defined(__linux__)
+		munmap( m_pBuf, m_nViewSize );
+#endif
+		m_bMirrored = false;
+	}
 };
 
 #endif//__RingBuffer_h
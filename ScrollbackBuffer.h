@@ -0,0 +1,506 @@
+/* Copyright (C) 2014-2026 Stefan-Mihai MOGA
+This file is part of IntelliPort application developed by Stefan-Mihai MOGA.
+IntelliPort is an alternative Windows version to the famous HyperTerminal!
+
+IntelliPort is free software: you can redistribute it and/or modify it
+under the terms of the GNU General Public License as published by the Open
+Source Initiative, either version 3 of the License, or any later version.
+
+IntelliPort is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+IntelliPort. If not, see <http://www.opensource.org/licenses/gpl-3.0.html>*/
+
+// ScrollbackBuffer.h : bounded, paged terminal text store with a sparse line index
+//
+
+#pragma once
+
+#include "BlockCodec.h"
+#include "LineEndingNormalizer.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Memory-bounded store for the terminal's scrollback text.
+ *
+ * Text is kept in fixed-size pages, so appending never moves what is already
+ * stored and costs O(1) amortized per character regardless of session size.
+ * Lines end with LF (a CR before it is kept and left to the renderer). The line
+ * index records the start offset of every SCROLLBACK_INDEX_STRIDE-th line only;
+ * a line is located by jumping to its checkpoint and scanning at most that many
+ * lines forward with a vectorized search, which keeps the index at well under
+ * one byte per line (100 million lines need about 12 MB).
+ *
+ * SetLimits() caps the text by lines and by bytes. When a cap is exceeded the
+ * oldest page is dropped as a whole, in O(1), so the store stays within one
+ * page of its caps; the line that straddled the dropped page starts mid-line.
+ * Pages older than the SCROLLBACK_HOT_PAGES most recent ones are compressed
+ * with CBlockCodec and decompressed into a small cache when they are read
+ * again, e.g. when scrolled into view.
+ *
+ * Lines and offsets are numbered from the oldest text still held, so they shift
+ * down when pages are dropped; GetDiscardedLines() tells by how much.
+ * Not thread safe: append and query from the same thread.
+ */
+class CScrollbackBuffer
+{
+public:
+	static constexpr size_t SCROLLBACK_PAGE_SIZE = 0x10000;  // characters per page
+	static constexpr uint64_t SCROLLBACK_INDEX_STRIDE = 64;  // lines per checkpoint
+	static constexpr size_t SCROLLBACK_HOT_PAGES = 4;        // newest pages kept uncompressed
+	static constexpr size_t SCROLLBACK_CACHE_PAGES = 4;      // decompressed cold pages kept
+
+	CScrollbackBuffer() : m_nMaxLines(0), m_nMaxBytes(0), m_nCacheClock(0)
+	{
+		Clear();
+	}
+
+	CScrollbackBuffer(const CScrollbackBuffer&) = delete;
+	CScrollbackBuffer& operator=(const CScrollbackBuffer&) = delete;
+
+	/**
+	 * @brief Removes all text and releases the pages.
+	 */
+	void Clear()
+	{
+		m_vecPages.clear();
+		m_vecCheckpoints.assign(1, 0);
+		m_nFirstPage = 0;
+		m_nFirstCheckpoint = 0;
+		m_nFirstLine = 0;
+		m_nLength = 0;
+		m_nLineCount = 1;
+		m_nLastLineStart = 0;
+		m_nMaxLineLength = 0;
+		m_nCompressedBytes = 0;
+		for (CScrollbackCacheEntry& pEntry : m_pCache)
+		{
+			pEntry.nPage = UINT64_MAX;
+		}
+	}
+
+	/**
+	 * @brief Caps the text held; the oldest pages are dropped to stay within the caps.
+	 *
+	 * @param nMaxLines Most lines to keep, or 0 for no line cap.
+	 * @param nMaxBytes Most bytes of (uncompressed) text to keep, or 0 for no byte cap.
+	 */
+	void SetLimits(uint64_t nMaxLines, uint64_t nMaxBytes)
+	{
+		m_nMaxLines = nMaxLines;
+		m_nMaxBytes = nMaxBytes;
+		EnforceLimits();
+	}
+
+	/**
+	 * @brief Appends text; every LF starts a new line.
+	 *
+	 * @param pText Pointer to the text (need not be null-terminated).
+	 * @param nLength Number of characters to append.
+	 */
+	void Append(const wchar_t* pText, size_t nLength)
+	{
+		while (nLength > 0)
+		{
+			const size_t nOffset = static_cast<size_t>(m_nLength % SCROLLBACK_PAGE_SIZE);
+			if (nOffset == 0)
+			{
+				StartPage();
+			}
+			const size_t nCount = (nLength < SCROLLBACK_PAGE_SIZE - nOffset) ? nLength : (SCROLLBACK_PAGE_SIZE - nOffset);
+			CScrollbackPage& pPage = m_vecPages.back();
+			memcpy(pPage.pText.get() + nOffset, pText, nCount * sizeof(wchar_t));
+			IndexLines(pPage, nOffset, nCount);
+			m_nLength += nCount;
+			pText += nCount;
+			nLength -= nCount;
+		}
+		UpdateMaxLineLength(m_nLength - m_nLastLineStart);
+		EnforceLimits();
+	}
+
+	/**
+	 * @brief Returns the number of characters held.
+	 */
+	uint64_t GetLength() const
+	{
+		return m_nLength - GetFirstOffset();
+	}
+
+	/**
+	 * @brief Returns the number of lines held, counting the unterminated last line.
+	 */
+	uint64_t GetLineCount() const
+	{
+		return m_nLineCount - m_nFirstLine;
+	}
+
+	/**
+	 * @brief Returns how many lines have been dropped by the caps since Clear().
+	 */
+	uint64_t GetDiscardedLines() const
+	{
+		return m_nFirstLine;
+	}
+
+	/**
+	 * @brief Returns the length of the longest line seen, used for horizontal scrolling.
+	 */
+	uint64_t GetMaxLineLength() const
+	{
+		return m_nMaxLineLength;
+	}
+
+	/**
+	 * @brief Returns the offset of the first character of a line.
+	 * @param nLine Zero-based line number; values past the end give GetLength().
+	 */
+	uint64_t GetLineStart(uint64_t nLine) const
+	{
+		if (nLine >= GetLineCount())
+		{
+			return GetLength();
+		}
+		return FindLineStart(m_nFirstLine + nLine) - GetFirstOffset();
+	}
+
+	/**
+	 * @brief Copies one line, without its line ending, into strLine.
+	 *
+	 * @param nLine Zero-based line number.
+	 * @param strLine String receiving the line; its capacity is reused.
+	 * @param nMaxLength Most characters to copy, e.g. what fits in the window.
+	 * @return Length of the whole line, which may exceed the characters copied.
+	 */
+	uint64_t GetLine(uint64_t nLine, std::wstring& strLine, size_t nMaxLength = SIZE_MAX) const
+	{
+		strLine.clear();
+		if (nLine >= GetLineCount())
+		{
+			return 0;
+		}
+		const uint64_t nStart = FindLineStart(m_nFirstLine + nLine);
+		uint64_t nEnd = (nLine == GetLineCount() - 1) ? m_nLength : FindNextLine(nStart) - 1;
+		if ((nEnd > nStart) && (GetChar(nEnd - 1) == L'\r'))
+		{
+			nEnd--;
+		}
+		const uint64_t nLength = nEnd - nStart;
+		const size_t nCopy = (nLength < nMaxLength) ? static_cast<size_t>(nLength) : nMaxLength;
+		strLine.resize(nCopy);
+		GetText(nStart - GetFirstOffset(), nCopy, &strLine[0]);
+		return nLength;
+	}
+
+	/**
+	 * @brief Copies a range of stored characters.
+	 *
+	 * @param nOffset Offset of the first character.
+	 * @param nLength Number of characters to copy.
+	 * @param pOutput Buffer of at least nLength characters.
+	 * @return Number of characters copied (less than nLength at the end of the text).
+	 */
+	size_t GetText(uint64_t nOffset, size_t nLength, wchar_t* pOutput) const
+	{
+		const uint64_t nHeld = GetLength();
+		if (nOffset >= nHeld)
+		{
+			return 0;
+		}
+		if (nLength > nHeld - nOffset)
+		{
+			nLength = static_cast<size_t>(nHeld - nOffset);
+		}
+		size_t nCopied = 0;
+		while (nCopied < nLength)
+		{
+			const wchar_t* pSegment = nullptr;
+			const size_t nSegment = GetSegment(nOffset + nCopied, pSegment);
+			const size_t nCount = (nSegment < nLength - nCopied) ? nSegment : (nLength - nCopied);
+			memcpy(pOutput + nCopied, pSegment, nCount * sizeof(wchar_t));
+			nCopied += nCount;
+		}
+		return nCopied;
+	}
+
+	/**
+	 * @brief Returns the contiguous run of stored text starting at nOffset.
+	 *
+	 * Lets callers stream the text (e.g. to a file) without copying it. The run
+	 * of a compressed page stays valid until SCROLLBACK_CACHE_PAGES other pages
+	 * have been read.
+	 *
+	 * @param nOffset Offset of the first character.
+	 * @param pSegment Receives a pointer to the run.
+	 * @return Length of the run, or 0 at the end of the text.
+	 */
+	size_t GetSegment(uint64_t nOffset, const wchar_t*& pSegment) const
+	{
+		return GetSegmentAt(GetFirstOffset() + nOffset, pSegment);
+	}
+
+	/**
+	 * @brief Returns the memory held by the pages, the cache and the line index, in bytes.
+	 */
+	uint64_t GetMemoryUsage() const
+	{
+		uint64_t nUsage = m_nCompressedBytes + static_cast<uint64_t>(m_vecCheckpoints.size()) * sizeof(uint64_t);
+		for (const CScrollbackPage& pPage : m_vecPages)
+		{
+			nUsage += (pPage.pText != nullptr) ? SCROLLBACK_PAGE_SIZE * sizeof(wchar_t) : 0;
+		}
+		for (const CScrollbackCacheEntry& pEntry : m_pCache)
+		{
+			nUsage += (pEntry.pText != nullptr) ? SCROLLBACK_PAGE_SIZE * sizeof(wchar_t) : 0;
+		}
+		return nUsage;
+	}
+
+protected:
+	struct CScrollbackPage
+	{
+		std::unique_ptr<wchar_t[]> pText;    // null while the page is compressed
+		std::vector<uint8_t> vecCompressed;
+		uint64_t nLineBreaks = 0;            // LFs stored in this page
+	};
+
+	struct CScrollbackCacheEntry
+	{
+		uint64_t nPage = UINT64_MAX;         // absolute page number held
+		uint64_t nLastUse = 0;
+		std::unique_ptr<wchar_t[]> pText;
+	};
+
+	// Internally offsets and line numbers count from Clear(), not from the oldest text held
+	uint64_t GetFirstOffset() const
+	{
+		return m_nFirstPage * SCROLLBACK_PAGE_SIZE;
+	}
+
+	wchar_t GetChar(uint64_t nOffset) const
+	{
+		const wchar_t* pSegment = nullptr;
+		GetSegmentAt(nOffset, pSegment);
+		return *pSegment;
+	}
+
+	size_t GetSegmentAt(uint64_t nOffset, const wchar_t*& pSegment) const
+	{
+		if ((nOffset >= m_nLength) || (nOffset < GetFirstOffset()))
+		{
+			pSegment = nullptr;
+			return 0;
+		}
+		const uint64_t nPage = nOffset / SCROLLBACK_PAGE_SIZE;
+		const size_t nInPage = static_cast<size_t>(nOffset % SCROLLBACK_PAGE_SIZE);
+		pSegment = GetPageText(nPage) + nInPage;
+		const uint64_t nRemaining = m_nLength - nOffset;
+		return (nRemaining < SCROLLBACK_PAGE_SIZE - nInPage) ? static_cast<size_t>(nRemaining) : (SCROLLBACK_PAGE_SIZE - nInPage);
+	}
+
+	/**
+	 * @brief Returns the text of a page, decompressing a cold page into the cache.
+	 */
+	const wchar_t* GetPageText(uint64_t nPage) const
+	{
+		const CScrollbackPage& pPage = m_vecPages[static_cast<size_t>(nPage - m_nFirstPage)];
+		if (pPage.pText != nullptr)
+		{
+			return pPage.pText.get();
+		}
+
+		CScrollbackCacheEntry* pOldest = &m_pCache[0];
+		for (CScrollbackCacheEntry& pEntry : m_pCache)
+		{
+			if (pEntry.nPage == nPage)
+			{
+				pEntry.nLastUse = ++m_nCacheClock;
+				return pEntry.pText.get();
+			}
+			if (pEntry.nLastUse < pOldest->nLastUse)
+			{
+				pOldest = &pEntry;
+			}
+		}
+		if (pOldest->pText == nullptr)
+		{
+			pOldest->pText.reset(new wchar_t[SCROLLBACK_PAGE_SIZE]);
+		}
+		if (!CBlockCodec::Decompress(pPage.vecCompressed.data(), pPage.vecCompressed.size(),
+			reinterpret_cast<uint8_t*>(pOldest->pText.get()), SCROLLBACK_PAGE_SIZE * sizeof(wchar_t)))
+		{
+			// Cannot happen unless memory was corrupted: show replacement characters
+			std::fill(pOldest->pText.get(), pOldest->pText.get() + SCROLLBACK_PAGE_SIZE, L'\xFFFD');
+		}
+		pOldest->nPage = nPage;
+		pOldest->nLastUse = ++m_nCacheClock;
+		return pOldest->pText.get();
+	}
+
+	/**
+	 * @brief Adds an empty page for appending and compresses the page that became cold.
+	 */
+	void StartPage()
+	{
+		m_vecPages.emplace_back();
+		m_vecPages.back().pText.reset(new wchar_t[SCROLLBACK_PAGE_SIZE]);
+		if (m_vecPages.size() <= SCROLLBACK_HOT_PAGES)
+		{
+			return;
+		}
+		CScrollbackPage& pCold = m_vecPages[m_vecPages.size() - 1 - SCROLLBACK_HOT_PAGES];
+		if (pCold.pText == nullptr)
+		{
+			return;
+		}
+		const size_t nRawSize = SCROLLBACK_PAGE_SIZE * sizeof(wchar_t);
+		CBlockCodec::Compress(reinterpret_cast<const uint8_t*>(pCold.pText.get()), nRawSize, m_vecScratch);
+		if (m_vecScratch.size() < nRawSize)
+		{
+			pCold.vecCompressed.assign(m_vecScratch.begin(), m_vecScratch.end());
+			pCold.vecCompressed.shrink_to_fit();
+			m_nCompressedBytes += pCold.vecCompressed.size();
+			pCold.pText.reset();
+		}
+	}
+
+	/**
+	 * @brief Drops the oldest pages while the text exceeds a cap; the newest page stays.
+	 */
+	void EnforceLimits()
+	{
+		while ((m_vecPages.size() > 1) &&
+			(((m_nMaxLines != 0) && (GetLineCount() > m_nMaxLines)) ||
+			((m_nMaxBytes != 0) && (GetLength() * sizeof(wchar_t) > m_nMaxBytes))))
+		{
+			CScrollbackPage& pPage = m_vecPages.front();
+			m_nFirstLine += pPage.nLineBreaks;
+			m_nCompressedBytes -= pPage.vecCompressed.size();
+			m_vecPages.pop_front();
+			m_nFirstPage++;
+
+			// Checkpoints of dropped lines are no longer needed
+			while (!m_vecCheckpoints.empty() && (m_vecCheckpoints.front() < GetFirstOffset()))
+			{
+				m_vecCheckpoints.pop_front();
+				m_nFirstCheckpoint++;
+			}
+			if (m_nLastLineStart < GetFirstOffset())
+			{
+				m_nLastLineStart = GetFirstOffset();
+			}
+		}
+	}
+
+	/**
+	 * @brief Returns the offset of the first character held of a line, by absolute line number.
+	 */
+	uint64_t FindLineStart(uint64_t nLine) const
+	{
+		if (nLine == m_nLineCount - 1)
+		{
+			return m_nLastLineStart;
+		}
+		// The oldest line held may have lost its beginning with a dropped page
+		uint64_t nCheckpoint = nLine / SCROLLBACK_INDEX_STRIDE;
+		uint64_t nOffset = GetFirstOffset();
+		uint64_t nFrom = m_nFirstLine;
+		if (nCheckpoint >= m_nFirstCheckpoint)
+		{
+			nOffset = m_vecCheckpoints[static_cast<size_t>(nCheckpoint - m_nFirstCheckpoint)];
+			nFrom = nCheckpoint * SCROLLBACK_INDEX_STRIDE;
+		}
+		for (; nFrom < nLine; nFrom++)
+		{
+			nOffset = FindNextLine(nOffset);
+		}
+		return nOffset;
+	}
+
+	/**
+	 * @brief Returns the offset just past the LF ending the line that contains nOffset.
+	 */
+	uint64_t FindNextLine(uint64_t nOffset) const
+	{
+		const wchar_t* pSegment = nullptr;
+		for (size_t nSegment = GetSegmentAt(nOffset, pSegment); nSegment > 0; nSegment = GetSegmentAt(nOffset, pSegment))
+		{
+			size_t nIndex = FindLineEnding(pSegment, nSegment);
+			while ((nIndex < nSegment) && (pSegment[nIndex] != L'\n'))
+			{
+				// A CR on its own does not end a line
+				nIndex++;
+				nIndex += FindLineEnding(pSegment + nIndex, nSegment - nIndex);
+			}
+			if (nIndex < nSegment)
+			{
+				return nOffset + nIndex + 1;
+			}
+			nOffset += nSegment;
+		}
+		return m_nLength;
+	}
+
+	/**
+	 * @brief Counts the lines started in freshly appended text and records checkpoints.
+	 */
+	void IndexLines(CScrollbackPage& pPage, size_t nStart, size_t nLength)
+	{
+		const wchar_t* pText = pPage.pText.get();
+		const uint64_t nBase = m_nLength - nStart;
+		const size_t nEnd = nStart + nLength;
+		size_t nIndex = nStart;
+		for (;;)
+		{
+			nIndex += FindLineEnding(pText + nIndex, nEnd - nIndex);
+			if (nIndex >= nEnd)
+			{
+				break;
+			}
+			if (pText[nIndex++] != L'\n')
+			{
+				continue;
+			}
+			pPage.nLineBreaks++;
+			UpdateMaxLineLength(nBase + nIndex - 1 - m_nLastLineStart);
+			m_nLastLineStart = nBase + nIndex;
+			if ((m_nLineCount++ % SCROLLBACK_INDEX_STRIDE) == 0)
+			{
+				m_vecCheckpoints.push_back(m_nLastLineStart);
+			}
+		}
+	}
+
+	void UpdateMaxLineLength(uint64_t nLength)
+	{
+		if (nLength > m_nMaxLineLength)
+		{
+			m_nMaxLineLength = nLength;
+		}
+	}
+
+	std::deque<CScrollbackPage> m_vecPages;
+	std::deque<uint64_t> m_vecCheckpoints;  // start of lines 0, STRIDE, 2 * STRIDE, ... still held
+	uint64_t m_nFirstPage;                  // number of pages dropped
+	uint64_t m_nFirstCheckpoint;            // number of checkpoints dropped
+	uint64_t m_nFirstLine;                  // number of lines dropped
+	uint64_t m_nLength;                     // characters appended since Clear()
+	uint64_t m_nLineCount;                  // lines started since Clear()
+	uint64_t m_nLastLineStart;
+	uint64_t m_nMaxLineLength;
+	uint64_t m_nMaxLines;
+	uint64_t m_nMaxBytes;
+	uint64_t m_nCompressedBytes;
+	std::vector<uint8_t> m_vecScratch;      // compression output, reused
+	mutable CScrollbackCacheEntry m_pCache[SCROLLBACK_CACHE_PAGES];
+	mutable uint64_t m_nCacheClock;
+};
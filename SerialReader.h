@@ -0,0 +1,496 @@
+/* Copyright (C) 2014-2026 Stefan-Mihai MOGA
+This file is part of IntelliPort application developed by Stefan-Mihai MOGA.
+IntelliPort is an alternative Windows version to the famous HyperTerminal!
+
+IntelliPort is free software: you can redistribute it and/or modify it
+under the terms of the GNU General Public License as published by the Open
+Source Initiative, either version 3 of the License, or any later version.
+
+IntelliPort is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+IntelliPort. If not, see <http://www.opensource.org/licenses/gpl-3.0.html>*/
+
+// SerialReader.h : event-driven serial port reader feeding a CReceiveBuffer
+//
+
+#pragma once
+
+#include "ReceiveBuffer.h"
+#include "SerialTransport.h"
+#include <functional>
+
+#ifndef _WIN32
+#include <cerrno>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+#endif
+
+/**
+ * @brief Event-driven serial port reader.
+ *
+ * Moves incoming bytes from a serial port into a CReceiveBuffer without polling,
+ * so an idle port costs no CPU time. Run() executes the read loop on the calling
+ * thread; Stop() may be called from any other thread to make Run() return.
+ *
+ * Windows: the port must be opened in overlapped mode. While data is flowing,
+ * SERIAL_READER_SLOTS overlapped reads are kept in flight, so the driver always
+ * has a buffer to complete into. The reads go into the slots' own buffers, not
+ * into the ring buffer: a read queued behind another cannot know where its
+ * bytes belong until the earlier ones complete, and most complete short. Each read returns as soon as at least one byte
+ * arrived, or empty after SERIAL_READER_IDLE_TIMEOUT milliseconds. Once a read
+ * comes back empty no more reads are queued; when all have completed, the reader
+ * blocks in WaitCommEvent(EV_RXCHAR) until the next byte arrives. Stop() signals
+ * an event and cancels the pending I/O with CancelIoEx.
+ *
+ * Linux: the reader waits with poll() on the transport's file descriptor and
+ * on an eventfd used by Stop(), and reads through the transport straight into
+ * the ring buffer storage unless the receive buffer is spilling to disk.
+ *
+ * SetLatencyProfile() trades throughput for time-to-first-byte: the low latency
+ * profile completes every read on the first received byte and keeps reads about
+ * one millisecond of line time long, while the default profile lets the driver
+ * gather bytes until the line has been quiet for a few character times.
+ */
+class CSerialReader
+{
+public:
+#ifdef _WIN32
+	typedef DWORD ErrorCode;
+	static constexpr int SERIAL_READER_SLOTS = 4;
+#else
+	typedef int ErrorCode;
+	typedef unsigned int DWORD;
+	static constexpr DWORD MAXDWORD = 0xFFFFFFFF;
+#endif
+	static constexpr DWORD SERIAL_READER_SLOT_SIZE = 0x1000;
+	static constexpr DWORD SERIAL_READER_IDLE_TIMEOUT = 50;
+
+	CSerialReader()
+	{
+#ifdef _WIN32
+		m_pSerialPort = nullptr;
+		m_hStopEvent = CreateEvent(nullptr, TRUE, FALSE, nullptr);
+		m_hWaitEvent = CreateEvent(nullptr, TRUE, FALSE, nullptr);
+		for (int nSlot = 0; nSlot < SERIAL_READER_SLOTS; nSlot++)
+		{
+			m_pSlots[nSlot].hEvent = CreateEvent(nullptr, TRUE, FALSE, nullptr);
+		}
+#else
+		m_pTransport = nullptr;
+		m_nStopFd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+#endif
+		m_bLowLatency = false;
+		m_nReadSize = SERIAL_READER_SLOT_SIZE;
+		m_nIntervalTimeout = MAXDWORD;
+	}
+
+	~CSerialReader()
+	{
+#ifdef _WIN32
+		CloseHandle(m_hStopEvent);
+		CloseHandle(m_hWaitEvent);
+		for (int nSlot = 0; nSlot < SERIAL_READER_SLOTS; nSlot++)
+		{
+			CloseHandle(m_pSlots[nSlot].hEvent);
+		}
+#else
+		if (m_nStopFd >= 0)
+		{
+			close(m_nStopFd);
+		}
+#endif
+	}
+
+	CSerialReader(const CSerialReader&) = delete;
+	CSerialReader& operator=(const CSerialReader&) = delete;
+
+	/**
+	 * @brief Selects the serial port to read from and arms it for a new Run().
+	 * @param pTransport An open serial transport; it may be written to by another thread meanwhile.
+	 */
+	void Attach(CSerialTransport& pTransport)
+	{
+#ifdef _WIN32
+		// The reads are overlapped operations on the port the transport opened
+		m_pSerialPort = &pTransport.GetPort();
+		ResetEvent(m_hStopEvent);
+#else
+		// Reads only follow poll(), so they must return at once
+		m_pTransport = &pTransport;
+		m_pTransport->SetReadLatency(0, 0);
+		// Discard a stop request left over from a previous session
+		eventfd_t nValue = 0;
+		eventfd_read(m_nStopFd, &nValue);
+#endif
+	}
+
+	/**
+	 * @brief Selects how reads are sized and timed. Call before Run().
+	 *
+	 * Bit time is taken as ten bits per character (8N1 with start and stop bits).
+	 * Batching inside the driver is set apart, with ISerialTransport::SetLowLatency.
+	 *
+	 * @param bLowLatency true to favor time-to-first-byte, false to favor throughput.
+	 * @param nBaudRate Line speed used to size the reads.
+	 */
+	void SetLatencyProfile(bool bLowLatency, DWORD nBaudRate)
+	{
+		const DWORD nCharsPerSecond = (nBaudRate >= 10) ? (nBaudRate / 10) : 1;
+		m_bLowLatency = bLowLatency;
+		if (bLowLatency)
+		{
+			// About one millisecond worth of characters, so no read sits on a full buffer
+			m_nReadSize = Clamp(nCharsPerSecond / 1000, SERIAL_READER_MIN_READ_SIZE, SERIAL_READER_SLOT_SIZE);
+			m_nIntervalTimeout = MAXDWORD;
+		}
+		else
+		{
+			// About 50 milliseconds worth of characters, completed after a gap of 10 characters
+			m_nReadSize = Clamp(nCharsPerSecond / 20, SERIAL_READER_MIN_READ_SIZE, SERIAL_READER_SLOT_SIZE);
+			m_nIntervalTimeout = Clamp((10 * 1000 + nCharsPerSecond - 1) / nCharsPerSecond, 1, SERIAL_READER_IDLE_TIMEOUT);
+		}
+	}
+
+	/**
+	 * @brief Returns true if the low latency profile is selected.
+	 */
+	bool IsLowLatency() const
+	{
+		return m_bLowLatency;
+	}
+
+	/**
+	 * @brief Returns the number of bytes requested by each read.
+	 */
+	DWORD GetReadSize() const
+	{
+		return m_nReadSize;
+	}
+
+	/**
+	 * @brief Asks a running Run() to return. Safe to call from any thread.
+	 */
+	void Stop()
+	{
+#ifdef _WIN32
+		SetEvent(m_hStopEvent);
+		if (m_pSerialPort != nullptr && m_pSerialPort->IsOpen())
+		{
+			// Wake the reader out of WaitCommEvent and any pending ReadFile
+			m_pSerialPort->CancelIoEx();
+		}
+#else
+		eventfd_write(m_nStopFd, 1);
+#endif
+	}
+
+	/**
+	 * @brief Reads from the serial port into the receive buffer until stopped.
+	 *
+	 * The caller's thread must be the receive buffer's only producer. When the
+	 * buffer is full its overflow policy decides whether the reader waits for
+	 * room (letting the driver's handshake throttle the sender), drops bytes or
+	 * spills them to disk.
+	 *
+	 * @param pReceiveBuffer Receive buffer getting the incoming data.
+	 * @param pfnDataReady Called after each chunk is committed to the receive buffer.
+	 * @return 0 when stopped by Stop(), otherwise the OS error that ended the loop.
+	 */
+	ErrorCode Run(CReceiveBuffer& pReceiveBuffer, const std::function<void()>& pfnDataReady)
+	{
+#ifdef _WIN32
+		ATLASSERT(m_pSerialPort != nullptr);
+		CSerialPort2& pSerialPort = *m_pSerialPort;
+
+		// Low latency: a read completes once a byte arrived, or empty after the idle timeout.
+		// Otherwise it completes when the line goes quiet, when full, or at the idle timeout.
+		COMMTIMEOUTS timeouts = { 0, };
+		timeouts.ReadIntervalTimeout = m_nIntervalTimeout;
+		timeouts.ReadTotalTimeoutMultiplier = m_bLowLatency ? MAXDWORD : 0;
+		timeouts.ReadTotalTimeoutConstant = SERIAL_READER_IDLE_TIMEOUT;
+		if (!pSerialPort.SetTimeouts(timeouts) || !pSerialPort.SetMask(EV_RXCHAR | EV_ERR))
+		{
+			return GetLastError();
+		}
+
+		DWORD dwError = 0;
+		int nHead = 0;   // oldest pending read
+		int nQueued = 0; // reads in flight, starting at nHead
+		bool bStreaming = true;
+		while (dwError == 0)
+		{
+			// Keep the pipeline full while data is flowing
+			while (bStreaming && (nQueued < SERIAL_READER_SLOTS))
+			{
+				if (!QueueRead((nHead + nQueued) % SERIAL_READER_SLOTS, dwError))
+				{
+					break;
+				}
+				nQueued++;
+			}
+			if (dwError != 0)
+			{
+				break;
+			}
+
+			if (nQueued == 0)
+			{
+				// Idle: block until the driver reports a received character
+				if (!WaitForData(dwError))
+				{
+					break;
+				}
+				bStreaming = true;
+				continue;
+			}
+
+			// Reads complete in the order they were queued
+			CSerialReaderSlot& pSlot = m_pSlots[nHead];
+			const HANDLE hWaitArray[2] = { m_hStopEvent, pSlot.hEvent };
+			if (WaitForMultipleObjects(2, hWaitArray, FALSE, INFINITE) != WAIT_OBJECT_0 + 1)
+			{
+				break;
+			}
+			DWORD dwBytesRead = 0;
+			if (!pSerialPort.GetOverlappedResult(pSlot.overlapped, dwBytesRead, FALSE))
+			{
+				dwError = GetLastError();
+				if (dwError == ERROR_OPERATION_ABORTED)
+				{
+					dwError = 0; // cancelled by Stop()
+				}
+			}
+			pSlot.bPending = false;
+			nHead = (nHead + 1) % SERIAL_READER_SLOTS;
+			nQueued--;
+
+			if (dwBytesRead > 0)
+			{
+				if (!CommitSlot(pReceiveBuffer, pSlot.pBuffer, dwBytesRead, pfnDataReady))
+				{
+					break;
+				}
+				pfnDataReady();
+			}
+			else
+			{
+				// Timed out empty: let the queued reads drain, then wait for EV_RXCHAR
+				bStreaming = false;
+			}
+		}
+
+		// The kernel may still write into the slot buffers: cancel and wait
+		pSerialPort.CancelIoEx();
+		for (int nSlot = 0; nSlot < SERIAL_READER_SLOTS; nSlot++)
+		{
+			if (m_pSlots[nSlot].bPending)
+			{
+				DWORD dwBytesRead = 0;
+				pSerialPort.GetOverlappedResult(m_pSlots[nSlot].overlapped, dwBytesRead, TRUE);
+				m_pSlots[nSlot].bPending = false;
+			}
+		}
+		if (m_bWaitPending)
+		{
+			DWORD dwBytes = 0;
+			pSerialPort.GetOverlappedResult(m_waitOverlapped, dwBytes, TRUE);
+			m_bWaitPending = false;
+		}
+		return dwError;
+#else
+		pollfd pPollArray[2] = { { m_pTransport->GetFd(), POLLIN, 0 }, { m_nStopFd, POLLIN, 0 } };
+		for (;;)
+		{
+			if (poll(pPollArray, 2, -1) < 0)
+			{
+				if (errno == EINTR)
+				{
+					continue;
+				}
+				return errno;
+			}
+			if (pPollArray[1].revents != 0)
+			{
+				return 0; // stopped by Stop()
+			}
+			if ((pPollArray[0].revents & (POLLERR | POLLNVAL)) != 0)
+			{
+				return EIO;
+			}
+
+			// Read straight into the free space of the ring buffer; when it is full
+			// or spilling, read into a local buffer and let the overflow policy decide
+			CRingBufferSpan pSpans[2];
+			char pBuffer[SERIAL_READER_SLOT_SIZE];
+			const bool bCopied = (pReceiveBuffer.PrepareWrite(pSpans) == 0);
+			char* pTarget = bCopied ? pBuffer : pSpans[0].pData;
+			const DWORD nSpace = bCopied ? SERIAL_READER_SLOT_SIZE : static_cast<DWORD>(pSpans[0].nLength);
+			const int nLength = m_pTransport->Read(pTarget, static_cast<int>((nSpace < m_nReadSize) ? nSpace : m_nReadSize));
+			if (nLength > 0)
+			{
+				if (!bCopied)
+				{
+					pReceiveBuffer.CommitWrite(static_cast<int>(nLength));
+				}
+				else
+				{
+					pReceiveBuffer.Write(pBuffer, static_cast<int>(nLength), [&]()
+					{
+						pfnDataReady();
+						return poll(&pPollArray[1], 1, 1) == 0;
+					});
+					if (pPollArray[1].revents != 0)
+					{
+						return 0; // stopped by Stop() while waiting for room
+					}
+				}
+				pfnDataReady();
+			}
+			else if (nLength < 0)
+			{
+				return static_cast<ErrorCode>(m_pTransport->GetLastErrorCode());
+			}
+			else if ((pPollArray[0].revents & POLLHUP) != 0)
+			{
+				return EIO; // device hung up and nothing is left to read
+			}
+		}
+#endif
+	}
+
+protected:
+	static constexpr DWORD SERIAL_READER_MIN_READ_SIZE = 32;
+
+	static DWORD Clamp(DWORD nValue, DWORD nMin, DWORD nMax)
+	{
+		return (nValue < nMin) ? nMin : ((nValue > nMax) ? nMax : nValue);
+	}
+
+#ifdef _WIN32
+	struct CSerialReaderSlot
+	{
+		OVERLAPPED overlapped;
+		HANDLE hEvent;
+		bool bPending;
+		char pBuffer[SERIAL_READER_SLOT_SIZE];
+	};
+
+	/**
+	 * @brief Queues an overlapped read into the given slot.
+	 * @return true if the read is in flight (or already complete), false on error.
+	 */
+	bool QueueRead(int nSlot, DWORD& dwError)
+	{
+		CSerialReaderSlot& pSlot = m_pSlots[nSlot];
+		memset(&pSlot.overlapped, 0, sizeof(pSlot.overlapped));
+		pSlot.overlapped.hEvent = pSlot.hEvent;
+		ResetEvent(pSlot.hEvent);
+		if (!m_pSerialPort->Read(pSlot.pBuffer, m_nReadSize, pSlot.overlapped, nullptr))
+		{
+			const DWORD dwLastError = GetLastError();
+			if (dwLastError != ERROR_IO_PENDING)
+			{
+				dwError = dwLastError;
+				return false;
+			}
+		}
+		// A synchronous completion also signals the event, so both cases are collected alike
+		pSlot.bPending = true;
+		return true;
+	}
+
+	/**
+	 * @brief Blocks in WaitCommEvent until a character is received or Stop() is called.
+	 * @return true if data may be available, false if stopped or on error.
+	 */
+	bool WaitForData(DWORD& dwError)
+	{
+		// Bytes that arrived while the last reads were draining need no wait
+		COMSTAT status = { 0, };
+		if (m_pSerialPort->GetStatus(status) && (status.cbInQue > 0))
+		{
+			return true;
+		}
+
+		DWORD dwMask = 0;
+		memset(&m_waitOverlapped, 0, sizeof(m_waitOverlapped));
+		m_waitOverlapped.hEvent = m_hWaitEvent;
+		ResetEvent(m_hWaitEvent);
+		if (!m_pSerialPort->WaitEvent(dwMask, m_waitOverlapped))
+		{
+			const DWORD dwLastError = GetLastError();
+			if (dwLastError != ERROR_IO_PENDING)
+			{
+				dwError = dwLastError;
+				return false;
+			}
+			m_bWaitPending = true;
+			const HANDLE hWaitArray[2] = { m_hStopEvent, m_hWaitEvent };
+			if (WaitForMultipleObjects(2, hWaitArray, FALSE, INFINITE) != WAIT_OBJECT_0 + 1)
+			{
+				return false;
+			}
+			DWORD dwBytes = 0;
+			m_bWaitPending = false;
+			if (!m_pSerialPort->GetOverlappedResult(m_waitOverlapped, dwBytes, FALSE))
+			{
+				dwError = GetLastError();
+				if (dwError == ERROR_OPERATION_ABORTED)
+				{
+					dwError = 0; // cancelled by Stop()
+				}
+				return false;
+			}
+		}
+		if ((dwMask & EV_ERR) != 0)
+		{
+			// Framing, overrun or parity error: clear it so reception continues
+			DWORD dwErrors = 0;
+			m_pSerialPort->ClearError(dwErrors);
+		}
+		return true;
+	}
+
+	/**
+	 * @brief Copies a completed read into the receive buffer, applying its overflow policy.
+	 *
+	 * This is the one copy the Linux reader avoids by reading straight into
+	 * PrepareWrite() space. Overlapped reads queued into consecutive ring space
+	 * would leave a gap after every short read, which CommitWrite() cannot skip;
+	 * closing it means moving the later reads' bytes, a copy again. A single read
+	 * into the ring would save the copy but leave the driver without a buffer
+	 * between a completion and the next read. At serial rates the copy of at most
+	 * SERIAL_READER_SLOT_SIZE bytes costs far less than that gap.
+	 *
+	 * @return true on success, false if Stop() was called while waiting for room.
+	 */
+	bool CommitSlot(CReceiveBuffer& pReceiveBuffer, const char* pBuffer, DWORD dwLength, const std::function<void()>& pfnDataReady)
+	{
+		bool bStopped = false;
+		pReceiveBuffer.Write(pBuffer, static_cast<int>(dwLength), [&]()
+		{
+			pfnDataReady();
+			bStopped = (WaitForSingleObject(m_hStopEvent, 1) == WAIT_OBJECT_0);
+			return !bStopped;
+		});
+		return !bStopped;
+	}
+
+	CSerialPort2* m_pSerialPort;
+	HANDLE m_hStopEvent;
+	HANDLE m_hWaitEvent;
+	OVERLAPPED m_waitOverlapped = { 0, };
+	bool m_bWaitPending = false;
+	CSerialReaderSlot m_pSlots[SERIAL_READER_SLOTS] = {};
+#else
+	CTermiosSerialTransport* m_pTransport;
+	int m_nStopFd;
+#endif
+	bool m_bLowLatency;
+	DWORD m_nReadSize;
+	DWORD m_nIntervalTimeout;
+};
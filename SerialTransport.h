@@ -0,0 +1,651 @@
+/* Copyright (C) 2014-2026 Stefan-Mihai MOGA
+This file is part of IntelliPort application developed by Stefan-Mihai MOGA.
+IntelliPort is an alternative Windows version to the famous HyperTerminal!
+
+IntelliPort is free software: you can redistribute it and/or modify it
+under the terms of the GNU General Public License as published by the Open
+Source Initiative, either version 3 of the License, or any later version.
+
+IntelliPort is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+IntelliPort. If not, see <http://www.opensource.org/licenses/gpl-3.0.html>*/
+
+// SerialTransport.h : platform independent serial port interface
+//
+
+#pragma once
+
+#include <cstddef>
+#include <functional>
+
+#ifdef _WIN32
+#include "SerialPort.h"
+#else
+#include <asm/termbits.h> // struct termios2 and BOTHER (do not mix with <termios.h>)
+#include <cerrno>
+#include <fcntl.h>
+#include <linux/serial.h> // struct serial_struct and ASYNC_LOW_LATENCY
+#include <poll.h>
+#include <sys/ioctl.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#endif
+
+/**
+ * @brief Line settings of a serial port.
+ *
+ * Parity, stop bits and flow control use the same values as the CSerialPort2
+ * enumerations (and as the settings stored by CConfigureDlg).
+ */
+struct CSerialTransportSettings
+{
+	unsigned long nBaudRate = 9600; // any rate the driver supports, not only the standard ones
+	unsigned char nDataBits = 8;    // 5 to 8
+	int nParity = 0;                // 0 = none, 1 = odd, 2 = even, 3 = mark, 4 = space
+	int nStopBits = 0;              // 0 = one, 1 = one and a half, 2 = two
+	int nFlowControl = 0;           // 0 = none, 1..4 = hardware (CTS/RTS etc.), 5 = XON/XOFF
+};
+
+/**
+ * @brief One buffer handed to ISerialTransport::WriteGather().
+ */
+struct CSerialTransportSpan
+{
+	const char* pData;
+	size_t nLength;
+};
+
+/**
+ * @brief Abstract serial port, so the I/O pipeline does not depend on Win32.
+ *
+ * Read and Write return the number of bytes transferred, or -1 on failure;
+ * GetLastErrorCode then returns the OS error (GetLastError or errno).
+ */
+class ISerialTransport
+{
+public:
+	/**
+	 * @brief Buffers WriteGather() hands to the driver before waiting for the first.
+	 */
+	static constexpr int SERIAL_TRANSPORT_MAX_GATHER = 64;
+
+	virtual ~ISerialTransport() = default;
+
+	/**
+	 * @brief Opens and configures the port.
+	 * @param pszPort Port name in UTF-8 (e.g. "COM3" or "/dev/ttyUSB0").
+	 * @param settings Line settings to apply.
+	 * @return true on success, otherwise false.
+	 */
+	virtual bool Open(const char* pszPort, const CSerialTransportSettings& settings) = 0;
+	virtual void Close() = 0;
+	virtual bool IsOpen() const = 0;
+
+	/**
+	 * @brief Reads up to nLength bytes; how long it waits is set by SetReadLatency.
+	 */
+	virtual int Read(void* pBuffer, int nLength) = 0;
+	/**
+	 * @brief Writes nLength bytes, blocking until the driver has accepted them.
+	 */
+	virtual int Write(const void* pBuffer, int nLength) = 0;
+	/**
+	 * @brief Writes several buffers in order, without waiting between them.
+	 *
+	 * While the driver takes no more, waits in 100 ms steps and asks pfnContinue
+	 * whether to keep waiting; once it returns false the pending writes are
+	 * cancelled. May run while another thread reads through a CSerialReader,
+	 * but not at the same time as another write.
+	 *
+	 * @return true if every byte was written; otherwise see GetLastErrorCode
+	 * (ERROR_OPERATION_ABORTED or ECANCELED when pfnContinue gave up).
+	 */
+	virtual bool WriteGather(const CSerialTransportSpan* pSpans, int nCount, const std::function<bool()>& pfnContinue) = 0;
+
+	/**
+	 * @brief Tunes when a Read returns.
+	 * @param nMinBytes Read waits for at least this many bytes (0 = return at once).
+	 * @param nIntervalMs Read returns once the line has been silent this long after a byte.
+	 * @return true on success, otherwise false.
+	 */
+	virtual bool SetReadLatency(int nMinBytes, int nIntervalMs) = 0;
+	/**
+	 * @brief Asks the driver to hand over received bytes without batching them.
+	 * @return true if the request was applied or the platform has no such mode.
+	 */
+	virtual bool SetLowLatency(bool bLowLatency) = 0;
+
+	/**
+	 * @brief Returns the number of received bytes waiting to be read, or -1 on error.
+	 */
+	virtual int GetInQueue() = 0;
+	/**
+	 * @brief Returns the number of bytes waiting to be transmitted, or -1 on error.
+	 */
+	virtual int GetOutQueue() = 0;
+	/**
+	 * @brief Discards both the receive and transmit queues.
+	 */
+	virtual bool Purge() = 0;
+
+	virtual unsigned long GetLastErrorCode() const = 0;
+};
+
+#ifdef _WIN32
+
+/**
+ * @brief ISerialTransport on top of the existing CSerialPort2 class.
+ *
+ * The port is opened in overlapped mode, so the same handle can also be served
+ * by CSerialReader; Read and Write wait for their own overlapped operation.
+ */
+class CWin32SerialTransport : public ISerialTransport
+{
+public:
+	CWin32SerialTransport()
+	{
+		m_hEvent = CreateEvent(nullptr, TRUE, FALSE, nullptr);
+		m_dwLastError = 0;
+	}
+
+	virtual ~CWin32SerialTransport()
+	{
+		Close();
+		CloseHandle(m_hEvent);
+	}
+
+	virtual bool Open(const char* pszPort, const CSerialTransportSettings& settings) override
+	{
+		CString strFullPortName;
+		strFullPortName.Format(_T("\\\\.\\%s"), static_cast<LPCTSTR>(CA2T(pszPort, CP_UTF8)));
+		if (!m_pSerialPort.Open(strFullPortName, settings.nBaudRate,
+			(CSerialPort2::Parity) settings.nParity, settings.nDataBits,
+			(CSerialPort2::StopBits) settings.nStopBits,
+			(CSerialPort2::FlowControl) settings.nFlowControl, TRUE))
+		{
+			m_dwLastError = GetLastError();
+			return false;
+		}
+		return SetReadLatency(1, 0);
+	}
+
+	virtual void Close() override
+	{
+		m_pSerialPort.Close();
+	}
+
+	virtual bool IsOpen() const override
+	{
+		return m_pSerialPort.IsOpen() != FALSE;
+	}
+
+	virtual int Read(void* pBuffer, int nLength) override
+	{
+		OVERLAPPED overlapped = { 0, };
+		overlapped.hEvent = m_hEvent;
+		DWORD dwBytesRead = 0;
+		if (!m_pSerialPort.Read(pBuffer, nLength, overlapped, &dwBytesRead) && !WaitForResult(overlapped, dwBytesRead))
+		{
+			return -1;
+		}
+		return static_cast<int>(dwBytesRead);
+	}
+
+	virtual int Write(const void* pBuffer, int nLength) override
+	{
+		const CSerialTransportSpan pSpan = { static_cast<const char*>(pBuffer), static_cast<size_t>(nLength) };
+		return WriteGather(&pSpan, 1, []() { return true; }) ? nLength : -1;
+	}
+
+	virtual bool WriteGather(const CSerialTransportSpan* pSpans, int nCount, const std::function<bool()>& pfnContinue) override
+	{
+		OVERLAPPED pOverlapped[SERIAL_TRANSPORT_MAX_GATHER];
+		DWORD dwError = 0;
+		while ((nCount > 0) && (dwError == 0))
+		{
+			const int nBatch = (nCount < SERIAL_TRANSPORT_MAX_GATHER) ? nCount : SERIAL_TRANSPORT_MAX_GATHER;
+			int nIssued = 0;
+			for (; nIssued < nBatch; nIssued++)
+			{
+				if ((m_pWriteEvents[nIssued].m_h == nullptr) && !m_pWriteEvents[nIssued].Create(nullptr, TRUE, FALSE, nullptr))
+				{
+					dwError = GetLastError();
+					break;
+				}
+				m_pWriteEvents[nIssued].Reset();
+				memset(&pOverlapped[nIssued], 0, sizeof(OVERLAPPED));
+				pOverlapped[nIssued].hEvent = m_pWriteEvents[nIssued];
+				if (!m_pSerialPort.Write(pSpans[nIssued].pData, static_cast<DWORD>(pSpans[nIssued].nLength), pOverlapped[nIssued]) &&
+					(GetLastError() != ERROR_IO_PENDING))
+				{
+					dwError = GetLastError();
+					break;
+				}
+			}
+			// Every write issued must end before its buffer goes
+			for (int nIndex = 0; nIndex < nIssued; nIndex++)
+			{
+				while (WaitForSingleObject(m_pWriteEvents[nIndex], 100) == WAIT_TIMEOUT)
+				{
+					if (!pfnContinue())
+					{
+						m_pSerialPort.CancelIo(); // the writes of this thread, not the reader's
+					}
+				}
+				DWORD dwBytesWritten = 0;
+				if (!m_pSerialPort.GetOverlappedResult(pOverlapped[nIndex], dwBytesWritten, TRUE) && (dwError == 0))
+				{
+					dwError = GetLastError();
+				}
+			}
+			pSpans += nBatch;
+			nCount -= nBatch;
+		}
+		if (dwError != 0)
+		{
+			m_dwLastError = dwError;
+			return false;
+		}
+		return true;
+	}
+
+	virtual bool SetReadLatency(int nMinBytes, int nIntervalMs) override
+	{
+		// Win32 has no byte count threshold: nMinBytes == 0 means "return at once",
+		// otherwise wait for the first byte and then for nIntervalMs of silence
+		COMMTIMEOUTS timeouts = { 0, };
+		if (nMinBytes == 0)
+		{
+			timeouts.ReadIntervalTimeout = MAXDWORD;
+		}
+		else
+		{
+			timeouts.ReadIntervalTimeout = (nIntervalMs > 0) ? nIntervalMs : MAXDWORD;
+			timeouts.ReadTotalTimeoutMultiplier = (nIntervalMs > 0) ? 0 : MAXDWORD;
+			timeouts.ReadTotalTimeoutConstant = (nIntervalMs > 0) ? 0 : MAXDWORD - 1;
+		}
+		return Check(m_pSerialPort.SetTimeouts(timeouts));
+	}
+
+	virtual bool SetLowLatency(bool /*bLowLatency*/) override
+	{
+		// No generic Win32 equivalent; USB adapters expose latency timers in their own INF settings
+		return true;
+	}
+
+	virtual int GetInQueue() override
+	{
+		COMSTAT status = { 0, };
+		return Check(m_pSerialPort.GetStatus(status)) ? static_cast<int>(status.cbInQue) : -1;
+	}
+
+	virtual int GetOutQueue() override
+	{
+		COMSTAT status = { 0, };
+		return Check(m_pSerialPort.GetStatus(status)) ? static_cast<int>(status.cbOutQue) : -1;
+	}
+
+	virtual bool Purge() override
+	{
+		return Check(m_pSerialPort.Purge(PURGE_RXCLEAR | PURGE_TXCLEAR));
+	}
+
+	virtual unsigned long GetLastErrorCode() const override
+	{
+		return m_dwLastError;
+	}
+
+	/**
+	 * @brief Gives access to the wrapped port (e.g. for CSerialReader::Attach).
+	 */
+	CSerialPort2& GetPort()
+	{
+		return m_pSerialPort;
+	}
+
+protected:
+	bool Check(BOOL bSuccess)
+	{
+		if (!bSuccess)
+		{
+			m_dwLastError = GetLastError();
+		}
+		return bSuccess != FALSE;
+	}
+
+	bool WaitForResult(OVERLAPPED& overlapped, DWORD& dwBytesTransferred)
+	{
+		if (GetLastError() != ERROR_IO_PENDING)
+		{
+			m_dwLastError = GetLastError();
+			return false;
+		}
+		return Check(m_pSerialPort.GetOverlappedResult(overlapped, dwBytesTransferred, TRUE));
+	}
+
+	CSerialPort2 m_pSerialPort;
+	HANDLE m_hEvent;
+	ATL::CEvent m_pWriteEvents[SERIAL_TRANSPORT_MAX_GATHER]; // created on first use, one per write in flight
+	DWORD m_dwLastError;
+};
+
+#else
+
+/**
+ * @brief ISerialTransport for Linux termios devices (including pseudo terminals).
+ *
+ * Uses termios2 with BOTHER, so any baud rate the driver accepts can be set,
+ * and VMIN/VTIME for read latency. The descriptor is non-blocking, so a write
+ * can give up while the transmit queue is full; Read waits with poll() unless
+ * SetReadLatency asked for no minimum. The descriptor is exposed for poll/epoll
+ * based readers such as CSerialReader.
+ */
+class CTermiosSerialTransport : public ISerialTransport
+{
+public:
+	CTermiosSerialTransport()
+	{
+		m_nFd = -1;
+		m_nMinBytes = 1;
+		m_nLastError = 0;
+	}
+
+	virtual ~CTermiosSerialTransport()
+	{
+		Close();
+	}
+
+	virtual bool Open(const char* pszPort, const CSerialTransportSettings& settings) override
+	{
+		Close();
+		m_nFd = open(pszPort, O_RDWR | O_NOCTTY | O_CLOEXEC | O_NONBLOCK);
+		if (m_nFd < 0)
+		{
+			m_nLastError = errno;
+			return false;
+		}
+		if (!Configure(settings))
+		{
+			const int nError = m_nLastError;
+			Close();
+			m_nLastError = nError;
+			return false;
+		}
+		return true;
+	}
+
+	/**
+	 * @brief Takes ownership of an already open descriptor and configures it.
+	 */
+	bool Attach(int nFd, const CSerialTransportSettings& settings)
+	{
+		Close();
+		m_nFd = nFd;
+		const int nFlags = fcntl(nFd, F_GETFL);
+		if (!Check(nFlags) || !Check(fcntl(nFd, F_SETFL, nFlags | O_NONBLOCK)))
+		{
+			return false;
+		}
+		return Configure(settings);
+	}
+
+	virtual void Close() override
+	{
+		if (m_nFd >= 0)
+		{
+			close(m_nFd);
+			m_nFd = -1;
+		}
+	}
+
+	virtual bool IsOpen() const override
+	{
+		return m_nFd >= 0;
+	}
+
+	virtual int Read(void* pBuffer, int nLength) override
+	{
+		for (;;)
+		{
+			const ssize_t nResult = read(m_nFd, pBuffer, nLength);
+			if (nResult >= 0)
+			{
+				return static_cast<int>(nResult);
+			}
+			if ((errno == EAGAIN) || (errno == EWOULDBLOCK))
+			{
+				if (m_nMinBytes == 0)
+				{
+					return 0; // nothing queued, and no wait asked for
+				}
+				pollfd pReadable = { m_nFd, POLLIN, 0 };
+				if ((poll(&pReadable, 1, -1) < 0) && (errno != EINTR))
+				{
+					m_nLastError = errno;
+					return -1;
+				}
+				continue;
+			}
+			if (errno != EINTR)
+			{
+				m_nLastError = errno;
+				return -1;
+			}
+		}
+	}
+
+	virtual int Write(const void* pBuffer, int nLength) override
+	{
+		const CSerialTransportSpan pSpan = { static_cast<const char*>(pBuffer), static_cast<size_t>(nLength) };
+		return WriteGather(&pSpan, 1, []() { return true; }) ? nLength : -1;
+	}
+
+	virtual bool WriteGather(const CSerialTransportSpan* pSpans, int nCount, const std::function<bool()>& pfnContinue) override
+	{
+		iovec pBuffers[SERIAL_TRANSPORT_MAX_GATHER];
+		while (nCount > 0)
+		{
+			const int nBatch = (nCount < SERIAL_TRANSPORT_MAX_GATHER) ? nCount : SERIAL_TRANSPORT_MAX_GATHER;
+			for (int nIndex = 0; nIndex < nBatch; nIndex++)
+			{
+				pBuffers[nIndex].iov_base = const_cast<char*>(pSpans[nIndex].pData);
+				pBuffers[nIndex].iov_len = pSpans[nIndex].nLength;
+			}
+			int nFirst = 0;
+			while (nFirst < nBatch)
+			{
+				const ssize_t nResult = writev(m_nFd, pBuffers + nFirst, nBatch - nFirst);
+				if (nResult < 0)
+				{
+					if (errno == EINTR)
+					{
+						continue;
+					}
+					if ((errno != EAGAIN) && (errno != EWOULDBLOCK))
+					{
+						m_nLastError = errno;
+						return false;
+					}
+					// The transmit queue is full: wait for room in 100 ms steps
+					pollfd pWritable = { m_nFd, POLLOUT, 0 };
+					if ((poll(&pWritable, 1, 100) == 0) && !pfnContinue())
+					{
+						m_nLastError = ECANCELED;
+						return false;
+					}
+					continue;
+				}
+				size_t nSent = static_cast<size_t>(nResult);
+				while ((nFirst < nBatch) && (nSent >= pBuffers[nFirst].iov_len))
+				{
+					nSent -= pBuffers[nFirst++].iov_len;
+				}
+				if (nFirst < nBatch)
+				{
+					pBuffers[nFirst].iov_base = static_cast<char*>(pBuffers[nFirst].iov_base) + nSent;
+					pBuffers[nFirst].iov_len -= nSent;
+				}
+			}
+			pSpans += nBatch;
+			nCount -= nBatch;
+		}
+		return true;
+	}
+
+	virtual bool SetReadLatency(int nMinBytes, int nIntervalMs) override
+	{
+		struct termios2 tio;
+		if (ioctl(m_nFd, TCGETS2, &tio) < 0)
+		{
+			m_nLastError = errno;
+			return false;
+		}
+		// VMIN is at most 255 bytes and VTIME counts tenths of a second
+		tio.c_cc[VMIN] = static_cast<cc_t>((nMinBytes < 0) ? 0 : (nMinBytes > 255) ? 255 : nMinBytes);
+		const int nDeciseconds = (nIntervalMs + 99) / 100;
+		tio.c_cc[VTIME] = static_cast<cc_t>((nDeciseconds < 0) ? 0 : (nDeciseconds > 255) ? 255 : nDeciseconds);
+		if (!Check(ioctl(m_nFd, TCSETS2, &tio)))
+		{
+			return false;
+		}
+		m_nMinBytes = tio.c_cc[VMIN];
+		return true;
+	}
+
+	virtual bool SetLowLatency(bool bLowLatency) override
+	{
+		struct serial_struct serial;
+		if (ioctl(m_nFd, TIOCGSERIAL, &serial) < 0)
+		{
+			// Pseudo terminals and some USB drivers have no serial_struct: nothing to tune
+			return (errno == ENOTTY) || (errno == EINVAL);
+		}
+		if (bLowLatency)
+		{
+			serial.flags |= ASYNC_LOW_LATENCY;
+		}
+		else
+		{
+			serial.flags &= ~ASYNC_LOW_LATENCY;
+		}
+		return Check(ioctl(m_nFd, TIOCSSERIAL, &serial));
+	}
+
+	virtual int GetInQueue() override
+	{
+		int nBytes = 0;
+		return Check(ioctl(m_nFd, FIONREAD, &nBytes)) ? nBytes : -1;
+	}
+
+	virtual int GetOutQueue() override
+	{
+		int nBytes = 0;
+		return Check(ioctl(m_nFd, TIOCOUTQ, &nBytes)) ? nBytes : -1;
+	}
+
+	virtual bool Purge() override
+	{
+		return Check(ioctl(m_nFd, TCFLSH, TCIOFLUSH));
+	}
+
+	virtual unsigned long GetLastErrorCode() const override
+	{
+		return static_cast<unsigned long>(m_nLastError);
+	}
+
+	/**
+	 * @brief Returns the file descriptor (e.g. for CSerialReader::Attach).
+	 */
+	int GetFd() const
+	{
+		return m_nFd;
+	}
+
+protected:
+	bool Check(int nResult)
+	{
+		if (nResult < 0)
+		{
+			m_nLastError = errno;
+			return false;
+		}
+		return true;
+	}
+
+	/**
+	 * @brief Switches the device to raw mode and applies the line settings.
+	 */
+	bool Configure(const CSerialTransportSettings& settings)
+	{
+		struct termios2 tio;
+		if (!Check(ioctl(m_nFd, TCGETS2, &tio)))
+		{
+			return false;
+		}
+
+		// Raw mode: no line editing, echo, signals or character translation
+		tio.c_iflag &= ~(IGNBRK | BRKINT | PARMRK | ISTRIP | INLCR | IGNCR | ICRNL | IXON | IXOFF | IXANY);
+		tio.c_oflag &= ~OPOST;
+		tio.c_lflag &= ~(ECHO | ECHONL | ICANON | ISIG | IEXTEN);
+		tio.c_cflag &= ~(CSIZE | PARENB | PARODD | CMSPAR | CSTOPB | CRTSCTS);
+		tio.c_cflag |= CREAD | CLOCAL;
+
+		switch (settings.nDataBits)
+		{
+			case 5: tio.c_cflag |= CS5; break;
+			case 6: tio.c_cflag |= CS6; break;
+			case 7: tio.c_cflag |= CS7; break;
+			default: tio.c_cflag |= CS8; break;
+		}
+		switch (settings.nParity)
+		{
+			case 1: tio.c_cflag |= PARENB | PARODD; break;
+			case 2: tio.c_cflag |= PARENB; break;
+			case 3: tio.c_cflag |= PARENB | CMSPAR | PARODD; break;
+			case 4: tio.c_cflag |= PARENB | CMSPAR; break;
+			default: break;
+		}
+		if (settings.nStopBits != 0)
+		{
+			tio.c_cflag |= CSTOPB; // 1.5 stop bits maps to 2, as on most UARTs
+		}
+		if ((settings.nFlowControl >= 1) && (settings.nFlowControl <= 4))
+		{
+			tio.c_cflag |= CRTSCTS;
+		}
+		else if (settings.nFlowControl == 5)
+		{
+			tio.c_iflag |= IXON | IXOFF;
+		}
+
+		// Arbitrary baud rate for both directions
+		tio.c_cflag &= ~(CBAUD | (CBAUD << IBSHIFT));
+		tio.c_cflag |= BOTHER | (BOTHER << IBSHIFT);
+		tio.c_ispeed = settings.nBaudRate;
+		tio.c_ospeed = settings.nBaudRate;
+
+		// Read waits until at least one byte is available
+		tio.c_cc[VMIN] = 1;
+		tio.c_cc[VTIME] = 0;
+		m_nMinBytes = 1;
+		return Check(ioctl(m_nFd, TCSETS2, &tio));
+	}
+
+	int m_nFd;
+	int m_nMinBytes;  // VMIN: 0 makes Read return at once when nothing is queued
+	int m_nLastError;
+};
+
+#endif
+
+/**
+ * @brief The serial transport of the platform being built for.
+ */
+#ifdef _WIN32
+typedef CWin32SerialTransport CSerialTransport;
+#else
+typedef CTermiosSerialTransport CSerialTransport;
+#endif
@@ -919,52 +919,67 @@ int CWSocket::SendTo(_In_reads_bytes_(nBufLen) const void* pBuf, _In_ int nBufLe
 #pragma warning(suppress: 26477)
 	ATLASSERT(IsCreated()); //must have been created first
 
-	//Do the address lookup
-	ATL::CSocketAddr lookup;
-	ATL::CAtlString sPort;
-	sPort.Format(_T("%u"), nHostPort);
-	const int nError{ lookup.FindAddr(pszHostAddress, sPort, 0, 0, 0, 0) };
-	if (nError != 0)
-		ThrowWSocketException(nError);
+	//Do the address lookup only when the destination changes (and every 30 seconds, see the other SendTo), not for every datagram
+	if (!m_SendToEndpoint.IsResolved() || !m_SendToEndpoint.Matches(pszHostAddress, nHostPort))
+	{
+		const int nError{ m_SendToEndpoint.Resolve(pszHostAddress, nHostPort, AF_UNSPEC, 30) };
+		if (nError != 0)
+			ThrowWSocketException(nError);
+	}
 
-	//Iterate through the list of addresses trying to send to
-	bool bSuccess{ false };
+	return SendTo(pBuf, nBufLen, m_SendToEndpoint, nFlags);
+}
+
+int CWSocket::SendTo(_In_reads_bytes_(nBufLen) const void* pBuf, _In_ int nBufLen, _Inout_ CUdpEndpoint& endpoint, _In_ int nFlags)
+{
+	//Validate our parameters
+#pragma warning(suppress: 26477)
+	ATLASSERT(IsCreated()); //must have been created first
+
+	//Look the destination up again once its time to live has passed, a failed lookup keeps the old addresses
+	if (endpoint.IsStale())
+		endpoint.Refresh();
+	if (!endpoint.IsResolved())
+		ThrowWSocketException(WSAEDESTADDRREQ);
+
+	//Iterate through the list of addresses trying to send to, starting with the one which worked last time
 	int nLastError{ 0 };
-	ADDRINFOT* const pAddress{ lookup.GetAddrInfoList() };
-	ADDRINFOT* pCurrentAddress{ pAddress };
-	int nSent{ 0 };
-	while ((pCurrentAddress != nullptr) && !bSuccess)
+	const size_t nCount{ endpoint.GetCount() };
+	for (size_t nAttempt = 0; nAttempt < nCount; nAttempt++)
 	{
-		try
-		{
-			//Call the other version of send to which does the actual work
-#pragma warning(suppress: 26472 26486)
-			nSent = SendTo(pBuf, nBufLen, pCurrentAddress->ai_addr, static_cast<int>(pCurrentAddress->ai_addrlen), nFlags);
-			bSuccess = true;
-		}
-#ifdef CWSOCKET_MFC_EXTENSIONS
-#pragma warning(suppress: 26429 26462)
-		catch (CWSocketException* pEx)
-		{
-			//Prepare for the next time around
-			nLastError = pEx->m_nError;
-			pEx->Delete();
-			pCurrentAddress = pCurrentAddress->ai_next;
-		}
-#else
-#pragma warning(suppress: 26496)
-		catch (CWSocketException& e)
+		const size_t nIndex{ (endpoint.GetCurrent() + nAttempt) % nCount };
+		const int nSent{ sendto(m_hSocket, static_cast<const char*>(pBuf), nBufLen, nFlags, endpoint.GetAddress(nIndex), endpoint.GetLength(nIndex)) };
+		if (nSent != SOCKET_ERROR)
 		{
-			//Prepare for the next time around
-			nLastError = e.m_nError;
-			pCurrentAddress = pCurrentAddress->ai_next;
+			endpoint.SetCurrent(nIndex);
+			return nSent;
 		}
-#endif //#ifdef CWSOCKET_MFC_EXTENSIONS
+		nLastError = WSAGetLastError();
 	}
-	if (!bSuccess)
-		ThrowWSocketException(nLastError);
+	ThrowWSocketException(nLastError);
 
-	return nSent;
+	return 0;
+}
+
+int CWSocket::SendToMany(_In_reads_(nCount) const CUdpDatagram* pDatagrams, _In_ int nCount, _Inout_ CUdpEndpoint& endpoint, _In_ int nFlags)
+{
+	//Validate our parameters
+#pragma warning(suppress: 26477)
+	ATLASSERT(IsCreated()); //must have been created first
+
+	if (nCount <= 0)
+		return 0;
+
+	//The first datagram picks the address which works, the rest follow it in batches
+#pragma warning(suppress: 26481)
+	SendTo(pDatagrams[0].pData, static_cast<int>(pDatagrams[0].nLength), endpoint, nFlags);
+	const size_t nIndex{ endpoint.GetCurrent() };
+#pragma warning(suppress: 26481)
+	const int nSent{ UdpSendMany(m_hSocket, pDatagrams + 1, nCount - 1, endpoint.GetAddress(nIndex), endpoint.GetLength(nIndex), nFlags) };
+	if (nSent < nCount - 1)
+		ThrowWSocketException();
+
+	return nCount;
 }
 
 void CWSocket::IOCtl(_In_ long lCommand, _Inout_ DWORD* pArgument)
@@ -66,6 +66,8 @@ __if_not_exists(SOCKADDR_INET)
 
 #endif //#ifndef CWSOCKET_MFC_EXTENSIONS
 
+#include "UdpEndpoint.h"
+
 
 //////////////////// Classes //////////////////////////////////////////////////
 
@@ -159,6 +161,8 @@ public:
 	int Send(_In_reads_bytes_(nBufLen) const void* pBuffer, _In_ int nBufLen, _In_ int nFlags = 0);
 	int SendTo(_In_reads_bytes_(nBufLen) const void* pBuf, _In_ int nBufLen, _In_reads_bytes_(nSockAddrLen) const SOCKADDR* pSockAddr, _In_ int nSockAddrLen, _In_ int nFlags = 0);
 	int SendTo(_In_reads_bytes_(nBufLen) const void* pBuf, _In_ int nBufLen, _In_ UINT nHostPort, _In_z_ LPCTSTR pszHostAddress = nullptr, _In_ int nFlags = 0);
+	int SendTo(_In_reads_bytes_(nBufLen) const void* pBuf, _In_ int nBufLen, _Inout_ CUdpEndpoint& endpoint, _In_ int nFlags = 0);
+	int SendToMany(_In_reads_(nCount) const CUdpDatagram* pDatagrams, _In_ int nCount, _Inout_ CUdpEndpoint& endpoint, _In_ int nFlags = 0);
 	void ShutDown(_In_ int nHow = SD_SEND);
 
 	//Operators
@@ -177,6 +181,7 @@ protected:
 	//Member variables
 	SOCKET m_hSocket;
 	String m_sBindAddress;
+	CUdpEndpoint m_SendToEndpoint; //The destination of the last SendTo by host and port
 };
 
 #endif //#ifndef __SOCMFC_H__
@@ -0,0 +1,160 @@
+/* Copyright (C) 2014-2026 Stefan-Mihai MOGA
+This file is part of IntelliPort application developed by Stefan-Mihai MOGA.
+IntelliPort is an alternative Windows version to the famous HyperTerminal!
+
+IntelliPort is free software: you can redistribute it and/or modify it
+under the terms of the GNU General Public License as published by the Open
+Source Initiative, either version 3 of the License, or any later version.
+
+IntelliPort is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+IntelliPort. If not, see <http://www.opensource.org/licenses/gpl-3.0.html>*/
+
+// SocketOutbox.h : bounded per-connection send queue flushed without blocking
+//
+
+#pragma once
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+
+#ifdef _WIN32
+#include <winsock2.h>
+typedef SOCKET SocketOutboxSocket;
+#else
+#include <cerrno>
+#include <sys/socket.h>
+typedef int SocketOutboxSocket;
+#endif
+
+/**
+ * @brief Result of CSocketOutbox::Flush.
+ */
+enum SocketOutboxStatus
+{
+	SOCKET_OUTBOX_EMPTY = 0,        // everything queued has been sent
+	SOCKET_OUTBOX_PENDING = 1,      // the socket takes no more now: flush again once it is writable
+	SOCKET_OUTBOX_FAILED = 2,       // the send failed or the bound was exceeded: close the connection
+};
+
+/**
+ * @brief Bytes waiting to be sent on one stream socket, up to a bound.
+ *
+ * Append() may be called from any thread and only copies: it never touches the
+ * socket, so a producer feeding many connections is not held up by a client
+ * that stops reading. Flush() sends what the socket takes without blocking and
+ * is meant for the socket reactor's thread, which calls it again when the
+ * socket becomes writable (see CSocketReactor::WatchWritable). A connection
+ * with more than the bound waiting is marked as overflowed; its owner is
+ * expected to disconnect it rather than let the queue grow.
+ */
+class CSocketOutbox
+{
+public:
+	explicit CSocketOutbox(size_t nLimit) : m_nLimit(nLimit), m_nOffset(0), m_nBytesQueued(0), m_nBytesSent(0), m_bOverflowed(false)
+	{
+	}
+
+	CSocketOutbox(const CSocketOutbox&) = delete;
+	CSocketOutbox& operator=(const CSocketOutbox&) = delete;
+
+	/**
+	 * @brief Queues a copy of the bytes.
+	 * @return false if they would exceed the bound; nothing is queued then and the outbox stays overflowed.
+	 */
+	bool Append(const void* pBuffer, size_t nLength)
+	{
+		std::lock_guard<std::mutex> lock(m_pLock);
+		if (m_bOverflowed || (m_strData.size() - m_nOffset + nLength > m_nLimit))
+		{
+			m_bOverflowed = true;
+			return false;
+		}
+		m_strData.append(static_cast<const char*>(pBuffer), nLength);
+		m_nBytesQueued += nLength;
+		return true;
+	}
+
+	/**
+	 * @brief Sends queued bytes until the socket would block.
+	 */
+	SocketOutboxStatus Flush(SocketOutboxSocket hSocket)
+	{
+		std::lock_guard<std::mutex> lock(m_pLock);
+		if (m_bOverflowed)
+		{
+			return SOCKET_OUTBOX_FAILED;
+		}
+		while (m_nOffset < m_strData.size())
+		{
+			const size_t nLength = m_strData.size() - m_nOffset;
+#ifdef _WIN32
+			// The socket must be non-blocking; Windows has no per-call flag for it
+			const int nResult = send(hSocket, m_strData.data() + m_nOffset, (nLength < 0x100000) ? static_cast<int>(nLength) : 0x100000, 0);
+			if (nResult == SOCKET_ERROR)
+			{
+				return (WSAGetLastError() == WSAEWOULDBLOCK) ? SOCKET_OUTBOX_PENDING : SOCKET_OUTBOX_FAILED;
+			}
+#else
+			const ssize_t nResult = send(hSocket, m_strData.data() + m_nOffset, nLength, MSG_DONTWAIT | MSG_NOSIGNAL);
+			if (nResult < 0)
+			{
+				if (errno == EINTR)
+				{
+					continue;
+				}
+				return ((errno == EAGAIN) || (errno == EWOULDBLOCK)) ? SOCKET_OUTBOX_PENDING : SOCKET_OUTBOX_FAILED;
+			}
+#endif
+			m_nOffset += static_cast<size_t>(nResult);
+			m_nBytesSent += static_cast<uint64_t>(nResult);
+			// Drop the sent front once it outweighs what is left, so appends stay cheap
+			if (m_nOffset >= m_strData.size() - m_nOffset)
+			{
+				m_strData.erase(0, m_nOffset);
+				m_nOffset = 0;
+			}
+		}
+		return SOCKET_OUTBOX_EMPTY;
+	}
+
+	/**
+	 * @brief Returns the number of bytes waiting.
+	 */
+	size_t GetPending()
+	{
+		std::lock_guard<std::mutex> lock(m_pLock);
+		return m_strData.size() - m_nOffset;
+	}
+
+	bool IsOverflowed()
+	{
+		std::lock_guard<std::mutex> lock(m_pLock);
+		return m_bOverflowed;
+	}
+
+	uint64_t GetBytesQueued()
+	{
+		std::lock_guard<std::mutex> lock(m_pLock);
+		return m_nBytesQueued;
+	}
+
+	uint64_t GetBytesSent()
+	{
+		std::lock_guard<std::mutex> lock(m_pLock);
+		return m_nBytesSent;
+	}
+
+protected:
+	std::mutex m_pLock;
+	std::string m_strData;
+	size_t m_nLimit;
+	size_t m_nOffset;               // bytes at the front of m_strData already sent
+	uint64_t m_nBytesQueued;
+	uint64_t m_nBytesSent;
+	bool m_bOverflowed;
+};
@@ -0,0 +1,739 @@
+/* Copyright (C) 2014-2026 Stefan-Mihai MOGA
+This file is part of IntelliPort application developed by Stefan-Mihai MOGA.
+IntelliPort is an alternative Windows version to the famous HyperTerminal!
+
+IntelliPort is free software: you can redistribute it and/or modify it
+under the terms of the GNU General Public License as published by the Open
+Source Initiative, either version 3 of the License, or any later version.
+
+IntelliPort is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+IntelliPort. If not, see <http://www.opensource.org/licenses/gpl-3.0.html>*/
+
+// SocketReactor.h : readiness dispatcher for many sockets (epoll on Linux, IOCP on Windows)
+//
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#ifdef _WIN32
+#include <winsock2.h>
+#else
+#include <cerrno>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+#endif
+
+/**
+ * @brief Dispatches socket readiness to per-socket handlers on one thread.
+ *
+ * Replaces a select() call before every receive: the reactor thread sleeps in a
+ * single kernel wait for all registered sockets and calls the handler of each
+ * socket that has data (or a pending connection, or an error) waiting. Stop()
+ * wakes the wait at once from any thread, so shutdown needs no timeouts.
+ *
+ * Add(), Remove() and WatchWritable() must be called from the reactor thread
+ * (typically from a handler) or while Run() is not executing; other threads hand
+ * work to the reactor thread with Post(). A handler returns false to have its
+ * socket removed; closing the socket is left to the owner.
+ *
+ * Linux: level-triggered epoll, woken for Stop() and Post() through an eventfd.
+ *
+ * Windows: an I/O completion port. Readiness is signalled by a zero-byte
+ * overlapped WSARecv, which completes when data arrives without consuming it;
+ * datagram sockets use MSG_PEEK so the datagram stays queued. A listening socket
+ * cannot post such a read: its FD_ACCEPT event is watched by the thread pool
+ * instead, which posts the completion packet (this also makes the socket, and
+ * the sockets accepted from it, non-blocking). Writability is watched the same
+ * way, through FD_WRITE. Stop() and Post() post a completion packet with a null
+ * key.
+ */
+class CSocketReactor
+{
+public:
+#ifdef _WIN32
+	typedef DWORD ErrorCode;
+	typedef SOCKET Socket;
+#else
+	typedef int ErrorCode;
+	typedef int Socket;
+#endif
+	typedef std::function<bool()> Handler;
+	typedef std::function<void()> Task;
+
+	static constexpr int SOCKET_REACTOR_MAX_EVENTS = 64;
+
+	CSocketReactor()
+	{
+#ifdef _WIN32
+		m_hPort = nullptr;
+#else
+		m_nEpollFd = -1;
+		m_nStopFd = -1;
+#endif
+		m_bStopRequested = false;
+		m_nWaitCount = 0;
+		m_nDispatchCount = 0;
+	}
+
+	~CSocketReactor()
+	{
+		Destroy();
+	}
+
+	CSocketReactor(const CSocketReactor&) = delete;
+	CSocketReactor& operator=(const CSocketReactor&) = delete;
+
+	/**
+	 * @brief Creates the kernel objects used for waiting.
+	 * @return true on success, otherwise false (see GetLastError / errno).
+	 */
+	bool Create()
+	{
+		Destroy();
+#ifdef _WIN32
+		m_hPort = CreateIoCompletionPort(INVALID_HANDLE_VALUE, nullptr, 0, 1);
+		return (m_hPort != nullptr);
+#else
+		m_nEpollFd = epoll_create1(EPOLL_CLOEXEC);
+		m_nStopFd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+		if ((m_nEpollFd < 0) || (m_nStopFd < 0))
+		{
+			Destroy();
+			return false;
+		}
+		epoll_event event = {};
+		event.events = EPOLLIN;
+		event.data.fd = m_nStopFd;
+		return (epoll_ctl(m_nEpollFd, EPOLL_CTL_ADD, m_nStopFd, &event) == 0);
+#endif
+	}
+
+	/**
+	 * @brief Unregisters every socket and releases the kernel objects.
+	 */
+	void Destroy()
+	{
+#ifdef _WIN32
+		if (m_hPort != nullptr)
+		{
+			// Cancel the outstanding readiness reads and collect their completions
+			for (auto& pItem : m_mapEntries)
+			{
+				if (pItem.second->bPending)
+				{
+					Cancel(*pItem.second);
+				}
+				if (pItem.second->bWritePending)
+				{
+					CancelWritable(*pItem.second);
+				}
+			}
+			while (HasPendingEntries())
+			{
+				DWORD dwBytes = 0;
+				ULONG_PTR nKey = 0;
+				LPOVERLAPPED pOverlapped = nullptr;
+				GetQueuedCompletionStatus(m_hPort, &dwBytes, &nKey, &pOverlapped, INFINITE);
+				if (pOverlapped != nullptr)
+				{
+					CSocketReactorEntry* pEntry = reinterpret_cast<CSocketReactorEntry*>(nKey);
+					if (pOverlapped == &pEntry->writeOverlapped)
+					{
+						pEntry->bWritePending = false;
+					}
+					else
+					{
+						pEntry->bPending = false;
+					}
+				}
+			}
+			CloseHandle(m_hPort);
+			m_hPort = nullptr;
+		}
+		m_lstRetired.clear();
+#else
+		if (m_nEpollFd >= 0)
+		{
+			close(m_nEpollFd);
+			m_nEpollFd = -1;
+		}
+		if (m_nStopFd >= 0)
+		{
+			close(m_nStopFd);
+			m_nStopFd = -1;
+		}
+#endif
+		m_mapEntries.clear();
+		std::lock_guard<std::mutex> lock(m_pTaskLock);
+		m_vecTasks.clear();
+		m_bStopRequested = false;
+	}
+
+	/**
+	 * @brief Registers a socket and the handler called when it becomes readable.
+	 * @param hSocket A socket opened by the caller; it must outlive its registration.
+	 * @param pfnHandler Called on the reactor thread; returns false to unregister.
+	 * @return true on success, otherwise false.
+	 */
+	bool Add(Socket hSocket, Handler pfnHandler)
+	{
+		if (m_mapEntries.find(hSocket) != m_mapEntries.end())
+		{
+			return false;
+		}
+		std::unique_ptr<CSocketReactorEntry> pEntry(new CSocketReactorEntry());
+		pEntry->hSocket = hSocket;
+		pEntry->pfnHandler = std::move(pfnHandler);
+#ifdef _WIN32
+		int nType = 0;
+		int nTypeLength = sizeof(nType);
+		getsockopt(hSocket, SOL_SOCKET, SO_TYPE, reinterpret_cast<char*>(&nType), &nTypeLength);
+		pEntry->bDatagram = (nType == SOCK_DGRAM);
+		BOOL bListening = FALSE;
+		int nListeningLength = sizeof(bListening);
+		getsockopt(hSocket, SOL_SOCKET, SO_ACCEPTCONN, reinterpret_cast<char*>(&bListening), &nListeningLength);
+		pEntry->hPort = m_hPort;
+		if (bListening)
+		{
+			pEntry->hAcceptEvent = WSACreateEvent();
+			if ((pEntry->hAcceptEvent == WSA_INVALID_EVENT) || (WSAEventSelect(hSocket, pEntry->hAcceptEvent, FD_ACCEPT) != 0))
+			{
+				return false;
+			}
+		}
+		else if (CreateIoCompletionPort(reinterpret_cast<HANDLE>(hSocket), m_hPort, reinterpret_cast<ULONG_PTR>(pEntry.get()), 0) == nullptr)
+		{
+			return false;
+		}
+		if (!Arm(*pEntry))
+		{
+			return false;
+		}
+#else
+		epoll_event event = {};
+		event.events = EPOLLIN | EPOLLRDHUP;
+		event.data.fd = hSocket;
+		if (epoll_ctl(m_nEpollFd, EPOLL_CTL_ADD, hSocket, &event) != 0)
+		{
+			return false;
+		}
+#endif
+		m_mapEntries[hSocket] = std::move(pEntry);
+		return true;
+	}
+
+	/**
+	 * @brief Unregisters a socket. Its handler is not called afterwards.
+	 */
+	void Remove(Socket hSocket)
+	{
+		auto pItem = m_mapEntries.find(hSocket);
+		if (pItem == m_mapEntries.end())
+		{
+			return;
+		}
+#ifdef _WIN32
+		const bool bReadPending = pItem->second->bPending && Cancel(*pItem->second);
+		const bool bWritePending = pItem->second->bWritePending && CancelWritable(*pItem->second);
+		if (bReadPending || bWritePending)
+		{
+			// The kernel still owns an OVERLAPPED: keep it until its completion packet arrives
+			pItem->second->bRemoved = true;
+			m_lstRetired.push_back(std::move(pItem->second));
+		}
+#else
+		epoll_ctl(m_nEpollFd, EPOLL_CTL_DEL, hSocket, nullptr);
+#endif
+		m_mapEntries.erase(pItem);
+	}
+
+	/**
+	 * @brief Calls a handler once, when a registered socket can take more data.
+	 *
+	 * Meant for a send that would block: the handler sends the rest and, if the
+	 * socket fills up again, watches it again. It may occasionally be called
+	 * while the socket is still full, so it must expect the send to block once
+	 * more. A later call replaces a handler that has not run yet.
+	 *
+	 * @param hSocket A socket registered with Add().
+	 * @param pfnHandler Called on the reactor thread; returns false to unregister the socket.
+	 * @return true on success, otherwise false.
+	 */
+	bool WatchWritable(Socket hSocket, Handler pfnHandler)
+	{
+		auto pItem = m_mapEntries.find(hSocket);
+		if (pItem == m_mapEntries.end())
+		{
+			return false;
+		}
+		CSocketReactorEntry& pEntry = *pItem->second;
+		pEntry.pfnWritable = std::move(pfnHandler);
+#ifdef _WIN32
+		if (pEntry.bWritePending)
+		{
+			return true;
+		}
+		if (pEntry.hWriteEvent == WSA_INVALID_EVENT)
+		{
+			pEntry.hWriteEvent = WSACreateEvent();
+			if ((pEntry.hWriteEvent == WSA_INVALID_EVENT) || (WSAEventSelect(hSocket, pEntry.hWriteEvent, FD_WRITE) != 0))
+			{
+				return false;
+			}
+			// The send that would block came before FD_WRITE was selected, so its FD_WRITE may be lost: look once now
+			pEntry.bWritePending = true;
+			pEntry.bWritePosted = true;
+			return (PostQueuedCompletionStatus(m_hPort, 0, reinterpret_cast<ULONG_PTR>(&pEntry), &pEntry.writeOverlapped) != FALSE);
+		}
+		return ArmWritable(pEntry);
+#else
+		epoll_event event = {};
+		event.events = EPOLLIN | EPOLLRDHUP | EPOLLOUT;
+		event.data.fd = hSocket;
+		return (epoll_ctl(m_nEpollFd, EPOLL_CTL_MOD, hSocket, &event) == 0);
+#endif
+	}
+
+	/**
+	 * @brief Returns the number of registered sockets.
+	 */
+	size_t GetCount() const
+	{
+		return m_mapEntries.size();
+	}
+
+	/**
+	 * @brief Asks a running Run() to return. Safe to call from any thread.
+	 */
+	void Stop()
+	{
+		m_bStopRequested = true;
+		Wake();
+	}
+
+	/**
+	 * @brief Runs a task on the reactor thread, before it waits again. Safe to call from any thread.
+	 *
+	 * Tasks run in the order they were posted and may use Add(), Remove() and
+	 * WatchWritable(). Tasks still queued when the reactor is destroyed are dropped.
+	 */
+	void Post(Task pfnTask)
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_pTaskLock);
+			m_vecTasks.push_back(std::move(pfnTask));
+		}
+		Wake();
+	}
+
+	/**
+	 * @brief Waits for readiness and dispatches handlers until stopped.
+	 * @return 0 when stopped by Stop(), otherwise the OS error that ended the loop.
+	 */
+	ErrorCode Run()
+	{
+#ifdef _WIN32
+		for (;;)
+		{
+			OVERLAPPED_ENTRY pEvents[SOCKET_REACTOR_MAX_EVENTS];
+			ULONG nCount = 0;
+			m_nWaitCount++;
+			if (!GetQueuedCompletionStatusEx(m_hPort, pEvents, SOCKET_REACTOR_MAX_EVENTS, &nCount, INFINITE, FALSE))
+			{
+				return GetLastError();
+			}
+			bool bStopped = false;
+			for (ULONG nIndex = 0; nIndex < nCount; nIndex++)
+			{
+				if (pEvents[nIndex].lpCompletionKey == 0)
+				{
+					// Posted by Stop() or Post()
+					bStopped = RunTasks() || bStopped;
+					continue;
+				}
+				CSocketReactorEntry* pEntry = reinterpret_cast<CSocketReactorEntry*>(pEvents[nIndex].lpCompletionKey);
+				if (pEvents[nIndex].lpOverlapped == &pEntry->writeOverlapped)
+				{
+					pEntry->bWritePending = false;
+					if (pEntry->hWriteWait != nullptr)
+					{
+						UnregisterWaitEx(pEntry->hWriteWait, nullptr);
+						pEntry->hWriteWait = nullptr;
+					}
+					if (pEntry->bRemoved)
+					{
+						if (!pEntry->bPending)
+						{
+							ReleaseRetired(pEntry);
+						}
+						continue;
+					}
+					DispatchWritable(*pEntry);
+					continue;
+				}
+				pEntry->bPending = false;
+				if (pEntry->hAcceptWait != nullptr)
+				{
+					// The one-shot wait has fired; release it before arming a new one
+					UnregisterWaitEx(pEntry->hAcceptWait, nullptr);
+					pEntry->hAcceptWait = nullptr;
+				}
+				if (pEntry->bRemoved)
+				{
+					if (!pEntry->bWritePending)
+					{
+						ReleaseRetired(pEntry);
+					}
+					continue;
+				}
+				Dispatch(*pEntry);
+			}
+			if (bStopped)
+			{
+				return 0;
+			}
+		}
+#else
+		for (;;)
+		{
+			epoll_event pEvents[SOCKET_REACTOR_MAX_EVENTS];
+			m_nWaitCount++;
+			const int nCount = epoll_wait(m_nEpollFd, pEvents, SOCKET_REACTOR_MAX_EVENTS, -1);
+			if (nCount < 0)
+			{
+				if (errno == EINTR)
+				{
+					continue;
+				}
+				return errno;
+			}
+			bool bStopped = false;
+			for (int nIndex = 0; nIndex < nCount; nIndex++)
+			{
+				if (pEvents[nIndex].data.fd == m_nStopFd)
+				{
+					eventfd_t nValue = 0;
+					eventfd_read(m_nStopFd, &nValue);
+					bStopped = RunTasks() || bStopped;
+					continue;
+				}
+				// An earlier handler in this batch may have removed the socket
+				auto pItem = m_mapEntries.find(pEvents[nIndex].data.fd);
+				if ((pItem != m_mapEntries.end()) && ((pEvents[nIndex].events & EPOLLOUT) != 0))
+				{
+					// One-shot: stop watching before the handler may ask again
+					epoll_event event = {};
+					event.events = EPOLLIN | EPOLLRDHUP;
+					event.data.fd = pItem->first;
+					epoll_ctl(m_nEpollFd, EPOLL_CTL_MOD, pItem->first, &event);
+					DispatchWritable(*pItem->second);
+					pItem = m_mapEntries.find(pEvents[nIndex].data.fd);
+				}
+				if ((pItem != m_mapEntries.end()) && ((pEvents[nIndex].events & ~EPOLLOUT) != 0))
+				{
+					Dispatch(*pItem->second);
+				}
+			}
+			if (bStopped)
+			{
+				return 0;
+			}
+		}
+#endif
+	}
+
+	/**
+	 * @brief Returns how many times Run() entered the kernel wait.
+	 */
+	uint64_t GetWaitCount() const
+	{
+		return m_nWaitCount;
+	}
+
+	/**
+	 * @brief Returns how many handler calls Run() made.
+	 */
+	uint64_t GetDispatchCount() const
+	{
+		return m_nDispatchCount;
+	}
+
+protected:
+	struct CSocketReactorEntry
+	{
+		Socket hSocket;
+		Handler pfnHandler;
+		Handler pfnWritable;
+#ifdef _WIN32
+		~CSocketReactorEntry()
+		{
+			if (hAcceptEvent != WSA_INVALID_EVENT)
+			{
+				WSACloseEvent(hAcceptEvent);
+			}
+			if (hWriteEvent != WSA_INVALID_EVENT)
+			{
+				WSACloseEvent(hWriteEvent);
+			}
+		}
+
+		WSAOVERLAPPED overlapped = {};
+		HANDLE hPort = nullptr;
+		WSAEVENT hAcceptEvent = WSA_INVALID_EVENT;
+		HANDLE hAcceptWait = nullptr;
+		std::atomic<bool> bAcceptPosted{ false };
+		bool bDatagram = false;
+		bool bPending = false;
+		bool bRemoved = false;
+		WSAOVERLAPPED writeOverlapped = {};
+		WSAEVENT hWriteEvent = WSA_INVALID_EVENT;
+		HANDLE hWriteWait = nullptr;
+		std::atomic<bool> bWritePosted{ false };
+		bool bWritePending = false;
+#endif
+	};
+
+	/**
+	 * @brief Wakes Run() to look at the stop request and the posted tasks.
+	 */
+	void Wake()
+	{
+#ifdef _WIN32
+		PostQueuedCompletionStatus(m_hPort, 0, 0, nullptr);
+#else
+		eventfd_write(m_nStopFd, 1);
+#endif
+	}
+
+	/**
+	 * @brief Runs the posted tasks.
+	 * @return true if Stop() was called.
+	 */
+	bool RunTasks()
+	{
+		std::vector<Task> vecTasks;
+		{
+			std::lock_guard<std::mutex> lock(m_pTaskLock);
+			vecTasks.swap(m_vecTasks);
+		}
+		for (Task& pfnTask : vecTasks)
+		{
+			pfnTask();
+		}
+		return m_bStopRequested.exchange(false);
+	}
+
+	/**
+	 * @brief Calls the one-shot writability handler of a socket.
+	 */
+	void DispatchWritable(CSocketReactorEntry& pEntry)
+	{
+		Handler pfnHandler;
+		pfnHandler.swap(pEntry.pfnWritable);
+		if (!pfnHandler)
+		{
+			return;
+		}
+		m_nDispatchCount++;
+		const Socket hSocket = pEntry.hSocket;
+		if (!pfnHandler())
+		{
+			Remove(hSocket);
+		}
+	}
+
+	/**
+	 * @brief Calls the handler of a ready socket and unregisters it if asked to.
+	 */
+	void Dispatch(CSocketReactorEntry& pEntry)
+	{
+		m_nDispatchCount++;
+		const Socket hSocket = pEntry.hSocket;
+		if (!pEntry.pfnHandler())
+		{
+			Remove(hSocket);
+			return;
+		}
+#ifdef _WIN32
+		// The handler may have removed the socket itself
+		auto pItem = m_mapEntries.find(hSocket);
+		if ((pItem != m_mapEntries.end()) && !pItem->second->bPending && !Arm(*pItem->second))
+		{
+			// The socket cannot be waited on any more: give the handler a last call to see the error
+			m_nDispatchCount++;
+			pItem->second->pfnHandler();
+			Remove(hSocket);
+		}
+#endif
+	}
+
+#ifdef _WIN32
+	/**
+	 * @brief Posts the zero-byte read that completes when the socket becomes readable.
+	 */
+	bool Arm(CSocketReactorEntry& pEntry)
+	{
+		memset(&pEntry.overlapped, 0, sizeof(pEntry.overlapped));
+		if (pEntry.hAcceptEvent != WSA_INVALID_EVENT)
+		{
+			// Consume the recorded FD_ACCEPT; Winsock records it again while connections are queued
+			WSANETWORKEVENTS events = {};
+			WSAEnumNetworkEvents(pEntry.hSocket, pEntry.hAcceptEvent, &events);
+			pEntry.bAcceptPosted = false;
+			if (!RegisterWaitForSingleObject(&pEntry.hAcceptWait, pEntry.hAcceptEvent, OnAcceptEvent, &pEntry, INFINITE, WT_EXECUTEONLYONCE))
+			{
+				return false;
+			}
+			pEntry.bPending = true;
+			return true;
+		}
+		WSABUF pBuffer = { 0, nullptr };
+		DWORD dwFlags = pEntry.bDatagram ? MSG_PEEK : 0;
+		if (WSARecv(pEntry.hSocket, &pBuffer, 1, nullptr, &dwFlags, &pEntry.overlapped, nullptr) != 0)
+		{
+			const int nError = WSAGetLastError();
+			if ((nError != WSA_IO_PENDING) && (nError != WSAEMSGSIZE))
+			{
+				return false;
+			}
+		}
+		// Even an immediate completion queues a packet, so both cases are collected alike
+		pEntry.bPending = true;
+		return true;
+	}
+
+	/**
+	 * @brief Thread pool callback: a listening socket has a connection to accept.
+	 */
+	static VOID CALLBACK OnAcceptEvent(PVOID pContext, BOOLEAN /*bTimedOut*/)
+	{
+		CSocketReactorEntry* pEntry = static_cast<CSocketReactorEntry*>(pContext);
+		pEntry->bAcceptPosted = true;
+		PostQueuedCompletionStatus(pEntry->hPort, 0, reinterpret_cast<ULONG_PTR>(pEntry), &pEntry->overlapped);
+	}
+
+	/**
+	 * @brief Cancels the pending readiness wait of an entry.
+	 * @return true if a completion packet is still to come, false if the entry is idle.
+	 */
+	bool Cancel(CSocketReactorEntry& pEntry)
+	{
+		if (pEntry.hAcceptEvent != WSA_INVALID_EVENT)
+		{
+			// Wait for a running callback to finish, then check whether it posted a packet
+			if (pEntry.hAcceptWait != nullptr)
+			{
+				UnregisterWaitEx(pEntry.hAcceptWait, INVALID_HANDLE_VALUE);
+				pEntry.hAcceptWait = nullptr;
+			}
+			pEntry.bPending = pEntry.bAcceptPosted;
+			return pEntry.bPending;
+		}
+		CancelIoEx(reinterpret_cast<HANDLE>(pEntry.hSocket), &pEntry.overlapped);
+		return true;
+	}
+
+	/**
+	 * @brief Waits in the thread pool for FD_WRITE, which Winsock records once a send that would block can go on.
+	 */
+	bool ArmWritable(CSocketReactorEntry& pEntry)
+	{
+		WSANETWORKEVENTS events = {};
+		WSAEnumNetworkEvents(pEntry.hSocket, pEntry.hWriteEvent, &events);
+		pEntry.bWritePosted = false;
+		pEntry.bWritePending = true;
+		if ((events.lNetworkEvents & FD_WRITE) != 0)
+		{
+			// Recorded since the last wait and reset by the call above: report it now
+			pEntry.bWritePosted = true;
+			return (PostQueuedCompletionStatus(m_hPort, 0, reinterpret_cast<ULONG_PTR>(&pEntry), &pEntry.writeOverlapped) != FALSE);
+		}
+		if (!RegisterWaitForSingleObject(&pEntry.hWriteWait, pEntry.hWriteEvent, OnWriteEvent, &pEntry, INFINITE, WT_EXECUTEONLYONCE))
+		{
+			pEntry.bWritePending = false;
+			return false;
+		}
+		return true;
+	}
+
+	/**
+	 * @brief Thread pool callback: a watched socket can take more data.
+	 */
+	static VOID CALLBACK OnWriteEvent(PVOID pContext, BOOLEAN /*bTimedOut*/)
+	{
+		CSocketReactorEntry* pEntry = static_cast<CSocketReactorEntry*>(pContext);
+		pEntry->bWritePosted = true;
+		PostQueuedCompletionStatus(pEntry->hPort, 0, reinterpret_cast<ULONG_PTR>(pEntry), &pEntry->writeOverlapped);
+	}
+
+	/**
+	 * @brief Cancels the pending writability wait of an entry.
+	 * @return true if a completion packet is still to come, false if the entry is idle.
+	 */
+	bool CancelWritable(CSocketReactorEntry& pEntry)
+	{
+		if (pEntry.hWriteWait != nullptr)
+		{
+			UnregisterWaitEx(pEntry.hWriteWait, INVALID_HANDLE_VALUE);
+			pEntry.hWriteWait = nullptr;
+		}
+		pEntry.bWritePending = pEntry.bWritePosted;
+		return pEntry.bWritePending;
+	}
+
+	bool HasPendingEntries() const
+	{
+		for (const auto& pItem : m_mapEntries)
+		{
+			if (pItem.second->bPending || pItem.second->bWritePending)
+			{
+				return true;
+			}
+		}
+		for (const auto& pEntry : m_lstRetired)
+		{
+			if (pEntry->bPending || pEntry->bWritePending)
+			{
+				return true;
+			}
+		}
+		return false;
+	}
+
+	void ReleaseRetired(CSocketReactorEntry* pEntry)
+	{
+		for (auto pItem = m_lstRetired.begin(); pItem != m_lstRetired.end(); ++pItem)
+		{
+			if (pItem->get() == pEntry)
+			{
+				m_lstRetired.erase(pItem);
+				return;
+			}
+		}
+	}
+
+	HANDLE m_hPort;
+	std::vector<std::unique_ptr<CSocketReactorEntry>> m_lstRetired;
+#else
+	int m_nEpollFd;
+	int m_nStopFd;
+#endif
+	std::map<Socket, std::unique_ptr<CSocketReactorEntry>> m_mapEntries;
+	std::mutex m_pTaskLock;
+	std::vector<Task> m_vecTasks;
+	std::atomic<bool> m_bStopRequested;
+	uint64_t m_nWaitCount;
+	uint64_t m_nDispatchCount;
+};
@@ -0,0 +1,134 @@
+/* Copyright (C) 2014-2026 Stefan-Mihai MOGA
+This file is part of IntelliPort application developed by Stefan-Mihai MOGA.
+IntelliPort is an alternative Windows version to the famous HyperTerminal!
+
+IntelliPort is free software: you can redistribute it and/or modify it
+under the terms of the GNU General Public License as published by the Open
+Source Initiative, either version 3 of the License, or any later version.
+
+IntelliPort is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+IntelliPort. If not, see <http://www.opensource.org/licenses/gpl-3.0.html>*/
+
+// TcpServer.cpp : implementation of the CTcpServer class
+//
+
+#include "stdafx.h"
+#include "IntelliPort.h"
+#include "MainFrame.h"
+#include "TcpServer.h"
+
+#ifdef _DEBUG
+#define new DEBUG_NEW
+#endif
+
+CTcpServer::CTcpServer()
+{
+	m_pMainFrame = nullptr;
+}
+
+CTcpServer::~CTcpServer()
+{
+	Close();
+}
+
+/**
+ * @brief Creates the listening socket.
+ *
+ * @param strBindAddress Local IP address to listen on.
+ * @param nPort Local TCP port to listen on.
+ */
+void CTcpServer::Open(const CString& strBindAddress, UINT nPort)
+{
+	m_pListener.SetBindAddress(strBindAddress);
+	m_pListener.CreateAndBind(nPort, SOCK_STREAM, AF_INET);
+	m_pListener.Listen();
+}
+
+/**
+ * @brief Starts accepting clients on the reactor thread.
+ *
+ * @param pMainFrame The main frame owning the ring buffer and caption bar.
+ * @param pReactor The reactor run by the socket thread.
+ * @return true if the listening socket was registered, otherwise false.
+ */
+bool CTcpServer::Attach(CMainFrame* pMainFrame, CSocketReactor& pReactor)
+{
+	m_pMainFrame = pMainFrame;
+	return AttachListener(pReactor, m_pListener);
+}
+
+/**
+ * @brief Closes all client connections and the listening socket.
+ */
+void CTcpServer::Close()
+{
+	CloseSessions();
+	m_pListener.Close();
+}
+
+/**
+ * @brief Copies bytes into the receive buffer, applying its overflow policy.
+ * @return true unless the connection is being closed.
+ */
+bool CTcpServer::WriteText(const char* pData, size_t nLength)
+{
+	// No lock needed: the reactor thread is the ring buffer's only producer
+	CMainFrame* pMainFrame = m_pMainFrame;
+	pMainFrame->m_pReceiveBuffer.Write(pData, static_cast<int>(nLength), [pMainFrame]() { return pMainFrame->WaitForReceiveBuffer(); });
+	return pMainFrame->m_nThreadRunning;
+}
+
+/**
+ * @brief Wakes the UI thread for the line just written.
+ */
+void CTcpServer::TextReady()
+{
+	m_pMainFrame->NotifyDataReady();
+}
+
+/**
+ * @brief Records bytes queued for a client in the capture.
+ */
+void CTcpServer::RecordSent(const CTcpSession& pSession, const void* pData, size_t nLength)
+{
+	m_pMainFrame->m_pCapture.Append(CAPTURE_SENT, static_cast<uint16_t>(pSession.m_nID), pData, nLength);
+}
+
+/**
+ * @brief Records bytes received from a client in the capture.
+ */
+void CTcpServer::RecordReceived(const CTcpSession& pSession, const void* pData, size_t nLength)
+{
+	m_pMainFrame->m_pCapture.Append(CAPTURE_RECEIVED, static_cast<uint16_t>(pSession.m_nID), pData, nLength);
+}
+
+/**
+ * @brief Shows a session event in the caption bar.
+ */
+void CTcpServer::OnSessionEvent(TcpSessionEvent nEvent, CTcpSession& pSession)
+{
+	CString strFormat, strMessage;
+	switch (nEvent)
+	{
+		case TCP_SESSION_CONNECTED:
+		{
+			const CString strAddress(pSession.m_strAddress.c_str());
+			VERIFY(strFormat.LoadString(IDS_CLIENT_CONNECTED));
+			strMessage.Format(strFormat, pSession.m_nID, static_cast<LPCWSTR>(strAddress), pSession.m_nPort);
+			break;
+		}
+		case TCP_SESSION_DISCONNECTED:
+			VERIFY(strFormat.LoadString(IDS_CLIENT_DISCONNECTED));
+			strMessage.Format(strFormat, pSession.m_nID, pSession.m_nBytesReceived.load(), pSession.m_pOutbox.GetBytesSent());
+			break;
+		case TCP_SESSION_TOO_SLOW:
+			VERIFY(strFormat.LoadString(IDS_CLIENT_TOO_SLOW));
+			strMessage.Format(strFormat, pSession.m_nID, static_cast<UINT>(m_nMaxQueued / 1024));
+			break;
+	}
+	m_pMainFrame->PostCaptionBarText(strMessage, false);
+}
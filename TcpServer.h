@@ -0,0 +1,67 @@
+/* Copyright (C) 2014-2026 Stefan-Mihai MOGA
+This file is part of IntelliPort application developed by Stefan-Mihai MOGA.
+IntelliPort is an alternative Windows version to the famous HyperTerminal!
+
+IntelliPort is free software: you can redistribute it and/or modify it
+under the terms of the GNU General Public License as published by the Open
+Source Initiative, either version 3 of the License, or any later version.
+
+IntelliPort is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+IntelliPort. If not, see <http://www.opensource.org/licenses/gpl-3.0.html>*/
+
+// TcpServer.h : multi-client TCP server feeding the shared ring buffer
+//
+
+#pragma once
+
+#include "SocMFC.h"
+#include "TcpSessionHost.h"
+
+class CMainFrame;
+
+/**
+ * @brief TCP server serving any number of concurrent clients.
+ *
+ * Owns the listening socket and hands the sessions to CTcpSessionHost, which
+ * runs them on the socket thread's reactor. Complete lines are written into
+ * the shared ring buffer tagged with "[#id] ", both directions are recorded in
+ * the capture, and session events are shown in the caption bar. A client with
+ * more than TCP_SERVER_MAX_QUEUED bytes waiting is disconnected.
+ */
+class CTcpServer : public CTcpSessionHost
+{
+public:
+	CTcpServer();
+	virtual ~CTcpServer();
+
+	/**
+	 * @brief Binds and listens on the given local address. Throws CWSocketException*.
+	 */
+	void Open(const CString& strBindAddress, UINT nPort);
+	/**
+	 * @brief Registers the listening socket with the reactor that will run the server.
+	 */
+	bool Attach(CMainFrame* pMainFrame, CSocketReactor& pReactor);
+	/**
+	 * @brief Closes every session and the listening socket. Call after the reactor stopped.
+	 */
+	void Close();
+	bool IsOpen() const
+	{
+		return m_pListener.IsCreated();
+	}
+
+protected:
+	bool WriteText(const char* pData, size_t nLength) override;
+	void TextReady() override;
+	void RecordSent(const CTcpSession& pSession, const void* pData, size_t nLength) override;
+	void RecordReceived(const CTcpSession& pSession, const void* pData, size_t nLength) override;
+	void OnSessionEvent(TcpSessionEvent nEvent, CTcpSession& pSession) override;
+
+	CMainFrame* m_pMainFrame;
+	CWSocket m_pListener;
+};
@@ -0,0 +1,444 @@
+/* Copyright (C) 2014-2026 Stefan-Mihai MOGA
+This file is part of IntelliPort application developed by Stefan-Mihai MOGA.
+IntelliPort is an alternative Windows version to the famous HyperTerminal!
+
+IntelliPort is free software: you can redistribute it and/or modify it
+under the terms of the GNU General Public License as published by the Open
+Source Initiative, either version 3 of the License, or any later version.
+
+IntelliPort is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+IntelliPort. If not, see <http://www.opensource.org/licenses/gpl-3.0.html>*/
+
+// TcpSessionHost.h : client sessions of the TCP server: accepting, tagged lines and broadcast outboxes
+//
+
+#pragma once
+
+#include "SocketOutbox.h"
+#include "SocketReactor.h"
+#include <atomic>
+#include <cstdio>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#include <ws2tcpip.h>
+#else
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#endif
+
+/**
+ * @brief What happened to a session, reported through CTcpSessionHost::OnSessionEvent.
+ */
+enum TcpSessionEvent
+{
+	TCP_SESSION_CONNECTED = 0,
+	TCP_SESSION_DISCONNECTED = 1,   // the client left, failed or was disconnected
+	TCP_SESSION_TOO_SLOW = 2,       // more than the outbox bound was waiting: it is disconnected next
+};
+
+/**
+ * @brief One client connection accepted by CTcpSessionHost.
+ */
+class CTcpSession
+{
+public:
+	CTcpSession(unsigned int nID, CSocketReactor::Socket hSocket, size_t nMaxQueued) :
+		m_nID(nID), m_hSocket(hSocket), m_nPort(0), m_nBytesReceived(0), m_pOutbox(nMaxQueued)
+	{
+	}
+
+	unsigned int m_nID;           // shown as the "[#id]" tag of every line
+	CSocketReactor::Socket m_hSocket;
+	std::string m_strAddress;
+	unsigned int m_nPort;
+	std::string m_strPending;     // received bytes not yet terminated by a new line
+	std::atomic<uint64_t> m_nBytesReceived;
+	CSocketOutbox m_pOutbox;      // broadcast bytes the client has not taken yet
+};
+
+/**
+ * @brief The sessions of a TCP server, served on the socket reactor's thread.
+ *
+ * The listening socket and every accepted connection are registered with the
+ * reactor, so accepting never blocks and idle clients cost nothing. Each
+ * session keeps its own receive buffer and hands complete lines to WriteText()
+ * tagged with "[#id] ", so output from different clients does not interleave
+ * mid-line; a line longer than TCP_SERVER_MAX_LINE is split, and a partial
+ * line is written when its session closes.
+ *
+ * Sessions are created and destroyed on the reactor thread; Broadcast() may be
+ * called from any thread. It only queues the bytes in every session's outbox
+ * and has the reactor thread send them, with non-blocking sends that resume
+ * when a socket becomes writable, so a client that stops reading cannot stall
+ * the caller or the other clients. A client with more than the bound waiting is
+ * disconnected.
+ *
+ * Only plain sockets are used, so the same code runs in the application and in
+ * the Linux tests; the owner supplies where the text goes, what is recorded and
+ * how events are shown by overriding the protected hooks.
+ */
+class CTcpSessionHost
+{
+public:
+	static constexpr size_t TCP_SERVER_MAX_LINE = 0x1000; // longer lines are split
+	static constexpr size_t TCP_SERVER_MAX_QUEUED = 0x400000; // per client
+
+	explicit CTcpSessionHost(size_t nMaxQueued = TCP_SERVER_MAX_QUEUED) :
+		m_pReactor(nullptr), m_hListener(0), m_nMaxQueued(nMaxQueued), m_nNextID(1), m_bFlushPosted(false)
+	{
+	}
+
+	virtual ~CTcpSessionHost()
+	{
+		CloseSessions();
+	}
+
+	CTcpSessionHost(const CTcpSessionHost&) = delete;
+	CTcpSessionHost& operator=(const CTcpSessionHost&) = delete;
+
+	/**
+	 * @brief Starts accepting clients on a listening socket, on the reactor's thread.
+	 *
+	 * Call while the reactor is not running. Session ids start again at 1.
+	 *
+	 * @return true if the listening socket was registered, otherwise false.
+	 */
+	bool AttachListener(CSocketReactor& pReactor, CSocketReactor::Socket hListener)
+	{
+		m_pReactor = &pReactor;
+		m_hListener = hListener;
+		m_nNextID = 1;
+		return pReactor.Add(hListener, [this]() { return OnAccept(); });
+	}
+
+	/**
+	 * @brief Closes every client connection. Call after the reactor stopped.
+	 */
+	void CloseSessions()
+	{
+		std::lock_guard<std::mutex> lock(m_pSessionLock);
+		for (auto& pItem : m_mapSessions)
+		{
+			CloseSocket(pItem.second->m_hSocket);
+		}
+		m_mapSessions.clear();
+		m_bFlushPosted = false;
+	}
+
+	/**
+	 * @brief Queues the same bytes for every connected client. Never blocks.
+	 *
+	 * Only copies the bytes into each session's outbox, so the session lock is
+	 * held for no socket call; the reactor thread sends them (see FlushSessions).
+	 * A client whose outbox is full is disconnected there.
+	 *
+	 * @return The number of clients the data was queued for.
+	 */
+	int Broadcast(const void* pBuffer, size_t nLength)
+	{
+		int nCount = 0;
+		bool bOverflowed = false;
+		{
+			std::lock_guard<std::mutex> lock(m_pSessionLock);
+			for (auto& pItem : m_mapSessions)
+			{
+				CTcpSession& pSession = *pItem.second;
+				if (!pSession.m_pOutbox.Append(pBuffer, nLength))
+				{
+					bOverflowed = true;
+					continue;
+				}
+				RecordSent(pSession, pBuffer, nLength);
+				nCount++;
+			}
+		}
+		if (((nCount > 0) || bOverflowed) && (m_pReactor != nullptr) && !m_bFlushPosted.exchange(true))
+		{
+			m_pReactor->Post([this]() { FlushSessions(); });
+		}
+		return nCount;
+	}
+
+	/**
+	 * @brief Returns the number of connected clients.
+	 */
+	size_t GetSessionCount()
+	{
+		std::lock_guard<std::mutex> lock(m_pSessionLock);
+		return m_mapSessions.size();
+	}
+
+protected:
+	/**
+	 * @brief Takes received text; called on the reactor thread only.
+	 * @return false if the connection is being closed, to stop writing.
+	 */
+	virtual bool WriteText(const char* pData, size_t nLength) = 0;
+	/**
+	 * @brief Called after a complete line was written.
+	 */
+	virtual void TextReady()
+	{
+	}
+	/**
+	 * @brief Called for the bytes queued for a session, under the session lock.
+	 */
+	virtual void RecordSent(const CTcpSession& /*pSession*/, const void* /*pData*/, size_t /*nLength*/)
+	{
+	}
+	/**
+	 * @brief Called for the bytes received from a session, on the reactor thread.
+	 */
+	virtual void RecordReceived(const CTcpSession& /*pSession*/, const void* /*pData*/, size_t /*nLength*/)
+	{
+	}
+	/**
+	 * @brief Called on the reactor thread when a session connects, falls behind or closes.
+	 */
+	virtual void OnSessionEvent(TcpSessionEvent /*nEvent*/, CTcpSession& /*pSession*/)
+	{
+	}
+
+	/**
+	 * @brief Accepts a pending connection and registers it with the reactor.
+	 * @return true to keep listening, false if the listening socket failed.
+	 */
+	bool OnAccept()
+	{
+		sockaddr_storage address = {};
+		socklen_t nAddressLength = sizeof(address);
+#ifdef _WIN32
+		const SOCKET hSocket = accept(m_hListener, reinterpret_cast<sockaddr*>(&address), &nAddressLength);
+		if (hSocket == INVALID_SOCKET)
+		{
+			const int nError = WSAGetLastError();
+			// The client may have given up between the notification and the accept
+			return (nError == WSAEWOULDBLOCK) || (nError == WSAECONNRESET);
+		}
+		// An accepted socket inherits the listener's event selection; keep it non-blocking for the outbox
+		u_long nNonBlocking = 1;
+		WSAEventSelect(hSocket, nullptr, 0);
+		ioctlsocket(hSocket, FIONBIO, &nNonBlocking);
+#else
+		const int hSocket = accept4(m_hListener, reinterpret_cast<sockaddr*>(&address), &nAddressLength, SOCK_NONBLOCK | SOCK_CLOEXEC);
+		if (hSocket < 0)
+		{
+			// The client may have given up between the notification and the accept
+			return (errno == EAGAIN) || (errno == EWOULDBLOCK) || (errno == ECONNABORTED) || (errno == EINTR);
+		}
+#endif
+		std::unique_ptr<CTcpSession> pSession(new CTcpSession(m_nNextID, hSocket, m_nMaxQueued));
+		char lpszAddress[INET6_ADDRSTRLEN] = { 0, };
+		if (address.ss_family == AF_INET)
+		{
+			const sockaddr_in& pAddress = reinterpret_cast<const sockaddr_in&>(address);
+			inet_ntop(AF_INET, const_cast<in_addr*>(&pAddress.sin_addr), lpszAddress, sizeof(lpszAddress));
+			pSession->m_nPort = ntohs(pAddress.sin_port);
+		}
+		else if (address.ss_family == AF_INET6)
+		{
+			const sockaddr_in6& pAddress = reinterpret_cast<const sockaddr_in6&>(address);
+			inet_ntop(AF_INET6, const_cast<in6_addr*>(&pAddress.sin6_addr), lpszAddress, sizeof(lpszAddress));
+			pSession->m_nPort = ntohs(pAddress.sin6_port);
+		}
+		pSession->m_strAddress = lpszAddress;
+
+		CTcpSession& pNewSession = *pSession;
+		if (!m_pReactor->Add(hSocket, [this, &pNewSession]() { return OnReceive(pNewSession); }))
+		{
+			CloseSocket(hSocket);
+			return true; // drop this client, keep listening
+		}
+		m_nNextID++;
+		{
+			std::lock_guard<std::mutex> lock(m_pSessionLock);
+			m_mapSessions[pNewSession.m_nID] = std::move(pSession);
+		}
+		OnSessionEvent(TCP_SESSION_CONNECTED, pNewSession);
+		return true;
+	}
+
+	/**
+	 * @brief Receives data from a client and writes its complete lines.
+	 *
+	 * Called on the reactor thread when the client's socket is readable. Closes
+	 * the session when the client disconnects or the connection fails.
+	 *
+	 * @return true to keep the session, false once it has been closed.
+	 */
+	bool OnReceive(CTcpSession& pSession)
+	{
+		char pBuffer[0x1000];
+#ifdef _WIN32
+		const int nLength = recv(pSession.m_hSocket, pBuffer, sizeof(pBuffer), 0);
+		if ((nLength == SOCKET_ERROR) && (WSAGetLastError() == WSAEWOULDBLOCK))
+		{
+			return true; // the readiness read completed, but another call took the data
+		}
+#else
+		const ssize_t nLength = recv(pSession.m_hSocket, pBuffer, sizeof(pBuffer), MSG_DONTWAIT);
+		if ((nLength < 0) && ((errno == EAGAIN) || (errno == EWOULDBLOCK) || (errno == EINTR)))
+		{
+			return true;
+		}
+#endif
+		if (nLength <= 0)
+		{
+			CloseSession(pSession);
+			return false;
+		}
+		pSession.m_nBytesReceived += nLength;
+		RecordReceived(pSession, pBuffer, static_cast<size_t>(nLength));
+
+		// Write every complete line; keep the rest for the next receive
+		std::string& strPending = pSession.m_strPending;
+		strPending.append(pBuffer, static_cast<size_t>(nLength));
+		size_t nStart = 0;
+		for (;;)
+		{
+			const size_t nEnd = strPending.find('\n', nStart);
+			if (nEnd == std::string::npos)
+			{
+				break;
+			}
+			if (!WriteTagged(pSession, strPending.data() + nStart, nEnd + 1 - nStart, false))
+			{
+				return true; // closing: the session is released by CloseSessions()
+			}
+			nStart = nEnd + 1;
+		}
+		strPending.erase(0, nStart);
+		if (strPending.size() >= TCP_SERVER_MAX_LINE)
+		{
+			// A client that never sends a new line must not grow the buffer forever
+			WriteTagged(pSession, strPending.data(), strPending.size(), true);
+			strPending.clear();
+		}
+		return true;
+	}
+
+	/**
+	 * @brief Writes a session's partial line, reports it closed and releases it.
+	 *
+	 * The socket must already be removed from the reactor, or be removed by the
+	 * handler returning false.
+	 */
+	void CloseSession(CTcpSession& pSession)
+	{
+		if (!pSession.m_strPending.empty())
+		{
+			WriteTagged(pSession, pSession.m_strPending.data(), pSession.m_strPending.size(), true);
+			pSession.m_strPending.clear();
+		}
+		OnSessionEvent(TCP_SESSION_DISCONNECTED, pSession);
+
+		std::lock_guard<std::mutex> lock(m_pSessionLock);
+		CloseSocket(pSession.m_hSocket);
+		m_mapSessions.erase(pSession.m_nID);
+	}
+
+	/**
+	 * @brief Sends what Broadcast() queued and closes the sessions that fell too far behind.
+	 *
+	 * Runs on the reactor thread, posted by Broadcast(). Only this thread changes
+	 * the session map, so it is read here without the session lock.
+	 */
+	void FlushSessions()
+	{
+		// Clear first: a broadcast from now on posts another flush
+		m_bFlushPosted = false;
+		std::vector<CTcpSession*> vecClosing;
+		for (auto& pItem : m_mapSessions)
+		{
+			if (!OnWritable(*pItem.second))
+			{
+				vecClosing.push_back(pItem.second.get());
+			}
+		}
+		for (CTcpSession* pSession : vecClosing)
+		{
+			if (pSession->m_pOutbox.IsOverflowed())
+			{
+				OnSessionEvent(TCP_SESSION_TOO_SLOW, *pSession);
+			}
+			m_pReactor->Remove(pSession->m_hSocket);
+			CloseSession(*pSession);
+		}
+	}
+
+	/**
+	 * @brief Sends the queued bytes of a session until its socket is full.
+	 *
+	 * When the socket takes no more, asks the reactor to call again once it is
+	 * writable.
+	 *
+	 * @return true to keep the session, false if it must be closed.
+	 */
+	bool OnWritable(CTcpSession& pSession)
+	{
+		switch (pSession.m_pOutbox.Flush(pSession.m_hSocket))
+		{
+			case SOCKET_OUTBOX_EMPTY:
+				return true;
+			case SOCKET_OUTBOX_PENDING:
+				return m_pReactor->WatchWritable(pSession.m_hSocket, [this, &pSession]()
+				{
+					if (OnWritable(pSession))
+					{
+						return true;
+					}
+					if (pSession.m_pOutbox.IsOverflowed())
+					{
+						OnSessionEvent(TCP_SESSION_TOO_SLOW, pSession);
+					}
+					CloseSession(pSession);
+					return false;
+				});
+			default:
+				return false;
+		}
+	}
+
+	/**
+	 * @brief Writes one line of a session, prefixed by its tag.
+	 * @param bNewLine true to end a line that has no new line of its own.
+	 * @return true on success, false if the connection is being closed.
+	 */
+	bool WriteTagged(const CTcpSession& pSession, const char* pData, size_t nLength, bool bNewLine)
+	{
+		char pTag[16] = { 0, };
+		const int nTagLength = snprintf(pTag, sizeof(pTag), "[#%u] ", pSession.m_nID);
+		if (!WriteText(pTag, static_cast<size_t>(nTagLength)) || !WriteText(pData, nLength) || (bNewLine && !WriteText("\n", 1)))
+		{
+			return false;
+		}
+		TextReady();
+		return true;
+	}
+
+	static void CloseSocket(CSocketReactor::Socket hSocket)
+	{
+#ifdef _WIN32
+		closesocket(hSocket);
+#else
+		close(hSocket);
+#endif
+	}
+
+	CSocketReactor* m_pReactor;
+	CSocketReactor::Socket m_hListener;
+	size_t m_nMaxQueued;
+	std::mutex m_pSessionLock;
+	std::map<unsigned int, std::unique_ptr<CTcpSession>> m_mapSessions;
+	unsigned int m_nNextID;
+	std::atomic<bool> m_bFlushPosted; // a FlushSessions() task is waiting to run
+};
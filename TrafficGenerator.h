@@ -0,0 +1,620 @@
+/* Copyright (C) 2014-2026 Stefan-Mihai MOGA
+This file is part of IntelliPort application developed by Stefan-Mihai MOGA.
+IntelliPort is an alternative Windows version to the famous HyperTerminal!
+
+IntelliPort is free software: you can redistribute it and/or modify it
+under the terms of the GNU General Public License as published by the Open
+Source Initiative, either version 3 of the License, or any later version.
+
+IntelliPort is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+IntelliPort. If not, see <http://www.opensource.org/licenses/gpl-3.0.html>*/
+
+// TrafficGenerator.h : sequence-numbered test frames, their generator and their checker
+//
+
+#pragma once
+
+#include "LatencyHistogram.h"
+#include "PrecisionTimer.h"
+#include <cstddef>
+#include <cstring>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <vector>
+
+/*
+ * Test frame layout (all integers little-endian):
+ *
+ *   CTrafficFrameHeader                      32 bytes
+ *   payload                                  nPayloadLength bytes
+ *   CRC-32 of the payload                    4 bytes
+ *
+ * The header carries its own CRC-32, so the checker can trust the payload
+ * length before waiting for the payload; after noise or a lost byte it skips
+ * ahead to the next header that checks out. The timestamp is CLatencyClock
+ * time in nanoseconds: it gives the round-trip time of a frame echoed back to
+ * its sender, and the one-way time when sender and checker share a clock (two
+ * instances on one machine, a pty pair, a loopback socket).
+ */
+
+static constexpr size_t TRAFFIC_MAX_PAYLOAD = 0x10000;
+
+struct CTrafficFrameHeader
+{
+	char nMagic[4];                 // TRAFFIC_FRAME_MAGIC
+	uint32_t nSession;              // chosen by the generator for each run
+	uint64_t nSequence;             // 0 for the first frame of the session
+	uint64_t nTimestamp;            // CLatencyClock time of the send, in nanoseconds
+	uint32_t nPayloadLength;
+	uint32_t nHeaderCrc;            // CRC-32 of the 28 bytes above
+};
+
+static_assert(sizeof(CTrafficFrameHeader) == 32, "test frame header layout");
+
+static constexpr char TRAFFIC_FRAME_MAGIC[4] = { 'I', 'P', 'T', 'F' };
+static constexpr size_t TRAFFIC_FRAME_OVERHEAD = sizeof(CTrafficFrameHeader) + sizeof(uint32_t);
+
+/**
+ * @brief Returns the CRC-32 (IEEE 802.3, as used by zip) of a block, continuing from nCrc.
+ *
+ * Slicing-by-8: eight table lookups per eight bytes.
+ */
+inline uint32_t Crc32(const void* pData, size_t nLength, uint32_t nCrc = 0)
+{
+	static const struct CCrc32Table
+	{
+		uint32_t nTable[8][256];
+		CCrc32Table()
+		{
+			for (uint32_t nByte = 0; nByte < 256; nByte++)
+			{
+				uint32_t nValue = nByte;
+				for (int nBit = 0; nBit < 8; nBit++)
+				{
+					nValue = (nValue >> 1) ^ ((nValue & 1) ? 0xEDB88320u : 0);
+				}
+				nTable[0][nByte] = nValue;
+			}
+			for (uint32_t nByte = 0; nByte < 256; nByte++)
+			{
+				for (int nSlice = 1; nSlice < 8; nSlice++)
+				{
+					nTable[nSlice][nByte] = (nTable[nSlice - 1][nByte] >> 8) ^ nTable[0][nTable[nSlice - 1][nByte] & 0xFF];
+				}
+			}
+		}
+	} pTable;
+
+	const uint8_t* pInput = static_cast<const uint8_t*>(pData);
+	nCrc = ~nCrc;
+	while (nLength >= 8)
+	{
+		uint32_t nLow, nHigh;
+		memcpy(&nLow, pInput, 4);
+		memcpy(&nHigh, pInput + 4, 4);
+		nLow ^= nCrc;
+		nCrc = pTable.nTable[7][nLow & 0xFF] ^ pTable.nTable[6][(nLow >> 8) & 0xFF] ^
+			pTable.nTable[5][(nLow >> 16) & 0xFF] ^ pTable.nTable[4][nLow >> 24] ^
+			pTable.nTable[3][nHigh & 0xFF] ^ pTable.nTable[2][(nHigh >> 8) & 0xFF] ^
+			pTable.nTable[1][(nHigh >> 16) & 0xFF] ^ pTable.nTable[0][nHigh >> 24];
+		pInput += 8;
+		nLength -= 8;
+	}
+	while (nLength-- > 0)
+	{
+		nCrc = (nCrc >> 8) ^ pTable.nTable[0][(nCrc ^ *pInput++) & 0xFF];
+	}
+	return ~nCrc;
+}
+
+/**
+ * @brief Statistics of a generator run.
+ */
+struct CTrafficGeneratorStats
+{
+	uint64_t nFrames;               // frames sent
+	uint64_t nBytes;                // bytes sent, frame overhead included
+	uint64_t nElapsed;              // ns since the start
+	bool bFailed;                   // the transport refused a write
+};
+
+/**
+ * @brief Sends test frames through a transport at a fixed rate or as fast as it takes them.
+ *
+ * Like CCaptureReplay, the generator runs on its own thread and hands bytes to
+ * a send function, so it works over any transport and can run without a
+ * window. At a fixed rate every frame is scheduled against the start of the
+ * run and waited for with a CPrecisionTimer; at line rate (a rate of 0) stream
+ * transports get up to TRAFFIC_BATCH_SIZE bytes of frames per send, so a
+ * blocking serial write or a TCP send is never starved, while datagram
+ * transports always get one frame per send.
+ */
+class CTrafficGenerator
+{
+public:
+	static constexpr size_t TRAFFIC_BATCH_SIZE = 0x4000;
+
+	typedef std::function<bool(const char* pData, size_t nLength)> SendFunction;
+
+	CTrafficGenerator() : m_bStop(false), m_bRunning(false), m_nSession(0), m_nPayloadLength(0),
+		m_nFramesPerSecond(0), m_nFrameCount(0), m_bDatagrams(false), m_nFrames(0), m_nBytes(0),
+		m_nElapsed(0), m_bFailed(false)
+	{
+	}
+
+	~CTrafficGenerator()
+	{
+		Stop();
+	}
+
+	CTrafficGenerator(const CTrafficGenerator&) = delete;
+	CTrafficGenerator& operator=(const CTrafficGenerator&) = delete;
+
+	/**
+	 * @brief Starts sending frames on the generator's thread.
+	 *
+	 * @param nSession Session id written in every frame.
+	 * @param nPayloadLength Payload bytes per frame, at most TRAFFIC_MAX_PAYLOAD.
+	 * @param nFramesPerSecond Frame rate, or 0 for line rate.
+	 * @param nFrameCount Frames to send, or 0 to send until Stop().
+	 * @param bDatagrams true to send every frame on its own (UDP).
+	 * @param pfnSend Called on the generator's thread.
+	 * @param pfnFinished Called on the generator's thread when the run ends, also after Stop().
+	 */
+	void Start(uint32_t nSession, size_t nPayloadLength, uint64_t nFramesPerSecond, uint64_t nFrameCount,
+		bool bDatagrams, SendFunction pfnSend, std::function<void()> pfnFinished)
+	{
+		Stop();
+		m_nSession = nSession;
+		m_nPayloadLength = (nPayloadLength < TRAFFIC_MAX_PAYLOAD) ? nPayloadLength : TRAFFIC_MAX_PAYLOAD;
+		m_nFramesPerSecond = nFramesPerSecond;
+		m_nFrameCount = nFrameCount;
+		m_bDatagrams = bDatagrams;
+		m_pfnSend = std::move(pfnSend);
+		m_pfnFinished = std::move(pfnFinished);
+		m_nFrames = 0;
+		m_nBytes = 0;
+		m_nElapsed = 0;
+		m_bFailed = false;
+		m_bStop = false;
+		m_bRunning = true;
+		m_pThread = std::thread(&CTrafficGenerator::Run, this);
+	}
+
+	/**
+	 * @brief Stops sending and waits for the generator's thread to end.
+	 */
+	void Stop()
+	{
+		if (m_pThread.joinable())
+		{
+			m_bStop = true;
+			m_pThread.join();
+		}
+	}
+
+	/**
+	 * @brief Returns true once Stop() was called; a send function waiting for
+	 * the connection polls this to give up.
+	 */
+	bool IsStopping() const
+	{
+		return m_bStop.load(std::memory_order_relaxed);
+	}
+
+	bool IsRunning() const
+	{
+		return m_bRunning.load(std::memory_order_acquire);
+	}
+
+	/**
+	 * @brief Returns a snapshot of the statistics. Safe to call from any thread.
+	 */
+	CTrafficGeneratorStats GetStats() const
+	{
+		CTrafficGeneratorStats pStats;
+		pStats.nFrames = m_nFrames.load(std::memory_order_relaxed);
+		pStats.nBytes = m_nBytes.load(std::memory_order_relaxed);
+		pStats.nElapsed = m_nElapsed.load(std::memory_order_relaxed);
+		pStats.bFailed = m_bFailed.load(std::memory_order_relaxed);
+		return pStats;
+	}
+
+	/**
+	 * @brief Builds frame nSequence at pFrame, which must hold nPayloadLength + TRAFFIC_FRAME_OVERHEAD bytes.
+	 */
+	static void BuildFrame(char* pFrame, uint32_t nSession, uint64_t nSequence, uint64_t nTimestamp, size_t nPayloadLength)
+	{
+		CTrafficFrameHeader pHeader;
+		memcpy(pHeader.nMagic, TRAFFIC_FRAME_MAGIC, sizeof(pHeader.nMagic));
+		pHeader.nSession = nSession;
+		pHeader.nSequence = nSequence;
+		pHeader.nTimestamp = nTimestamp;
+		pHeader.nPayloadLength = static_cast<uint32_t>(nPayloadLength);
+		pHeader.nHeaderCrc = Crc32(&pHeader, offsetof(CTrafficFrameHeader, nHeaderCrc));
+		memcpy(pFrame, &pHeader, sizeof(pHeader));
+
+		// A payload that changes with the sequence, so a stale buffer does not pass
+		char* pPayload = pFrame + sizeof(pHeader);
+		const uint8_t nSeed = static_cast<uint8_t>(nSequence * 131);
+		for (size_t nIndex = 0; nIndex < nPayloadLength; nIndex++)
+		{
+			pPayload[nIndex] = static_cast<char>(nSeed + nIndex);
+		}
+		const uint32_t nCrc = Crc32(pPayload, nPayloadLength);
+		memcpy(pPayload + nPayloadLength, &nCrc, sizeof(nCrc));
+	}
+
+	static uint64_t GetTimestamp()
+	{
+		return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+			CLatencyClock::now().time_since_epoch()).count());
+	}
+
+protected:
+	void Run()
+	{
+		const size_t nFrameLength = m_nPayloadLength + TRAFFIC_FRAME_OVERHEAD;
+		const size_t nBatch = (m_bDatagrams || (m_nFramesPerSecond != 0) || (nFrameLength >= TRAFFIC_BATCH_SIZE)) ?
+			1 : (TRAFFIC_BATCH_SIZE / nFrameLength);
+		std::vector<char> vecBuffer(nBatch * nFrameLength);
+		const std::chrono::steady_clock::time_point tStart = std::chrono::steady_clock::now();
+		uint64_t nSequence = 0;
+		while (!m_bStop.load(std::memory_order_relaxed) && ((m_nFrameCount == 0) || (nSequence < m_nFrameCount)))
+		{
+			if (m_nFramesPerSecond != 0)
+			{
+				const std::chrono::steady_clock::time_point tDeadline = tStart + std::chrono::nanoseconds(
+					static_cast<int64_t>(static_cast<double>(nSequence) * 1e9 / static_cast<double>(m_nFramesPerSecond)));
+				if (!m_pTimer.WaitUntil(tDeadline, m_bStop))
+				{
+					break;
+				}
+			}
+			size_t nFrames = nBatch;
+			if ((m_nFrameCount != 0) && (m_nFrameCount - nSequence < nFrames))
+			{
+				nFrames = static_cast<size_t>(m_nFrameCount - nSequence);
+			}
+			const uint64_t nTimestamp = GetTimestamp();
+			for (size_t nFrame = 0; nFrame < nFrames; nFrame++)
+			{
+				BuildFrame(vecBuffer.data() + nFrame * nFrameLength, m_nSession, nSequence + nFrame, nTimestamp, m_nPayloadLength);
+			}
+			if (!m_pfnSend(vecBuffer.data(), nFrames * nFrameLength))
+			{
+				m_bFailed.store(true, std::memory_order_relaxed);
+				break;
+			}
+			nSequence += nFrames;
+			m_nFrames.store(nSequence, std::memory_order_relaxed);
+			m_nBytes.fetch_add(nFrames * nFrameLength, std::memory_order_relaxed);
+			m_nElapsed.store(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+				std::chrono::steady_clock::now() - tStart).count()), std::memory_order_relaxed);
+		}
+		m_bRunning.store(false, std::memory_order_release);
+		if (m_pfnFinished)
+		{
+			m_pfnFinished();
+		}
+	}
+
+	std::thread m_pThread;
+	std::atomic<bool> m_bStop;
+	std::atomic<bool> m_bRunning;
+	uint32_t m_nSession;
+	size_t m_nPayloadLength;
+	uint64_t m_nFramesPerSecond;
+	uint64_t m_nFrameCount;
+	bool m_bDatagrams;
+	SendFunction m_pfnSend;
+	std::function<void()> m_pfnFinished;
+	CPrecisionTimer m_pTimer;
+	std::atomic<uint64_t> m_nFrames;
+	std::atomic<uint64_t> m_nBytes;
+	std::atomic<uint64_t> m_nElapsed;
+	std::atomic<bool> m_bFailed;
+};
+
+/**
+ * @brief Statistics of the frames seen by a CTrafficChecker.
+ */
+struct CTrafficCheckerStats
+{
+	uint64_t nFrames;               // distinct frames received intact
+	uint64_t nBytes;                // bytes of those frames, overhead included
+	uint64_t nElapsed;              // ns from the first to the last of them
+	uint64_t nLost;                 // sequence numbers skipped and not received since
+	uint64_t nReordered;            // frames received after a later one
+	uint64_t nDuplicates;           // frames received more than once
+	uint64_t nStale;                // frames too far behind to classify (see TRAFFIC_REORDER_WINDOW)
+	uint64_t nCorrupt;              // frames with a valid header and a wrong payload CRC
+	uint64_t nSkipped;              // bytes skipped looking for a header
+	CLatencyHistogram pOneWay;      // us, frames from another session
+	CLatencyHistogram pRoundTrip;   // us, frames of the local session echoed back
+};
+
+/**
+ * @brief Sequence number accounting of one session seen by a CTrafficChecker.
+ */
+struct CTrafficSessionStats
+{
+	uint64_t nFrames;               // distinct frames received intact
+	uint64_t nLost;                 // sequence numbers skipped and not received since
+	uint64_t nReordered;            // frames received after a later one
+	uint64_t nDuplicates;           // frames received more than once
+	uint64_t nStale;                // frames too far behind to classify
+};
+
+/**
+ * @brief Finds test frames in a byte stream and accounts for their sequence numbers.
+ *
+ * Feed() takes the received bytes in pieces of any size. Sequence numbers are
+ * tracked for each session on its own, so several generators may feed one
+ * checker: the first frame of a session is the baseline, a jump ahead counts
+ * the frames skipped as lost, and a frame behind the highest one seen is either
+ * a reordered frame or a duplicate, told apart by a bitmap of the last
+ * TRAFFIC_REORDER_WINDOW sequence numbers. A reordered frame is no longer lost
+ * only if a second bitmap has it as skipped: one from before the baseline was
+ * never counted. GetStats() adds up all sessions; the least recently seen
+ * session is forgotten beyond TRAFFIC_MAX_SESSIONS. Feed() and the other
+ * methods may be called from different threads.
+ */
+class CTrafficChecker
+{
+public:
+	static constexpr uint64_t TRAFFIC_REORDER_WINDOW = 0x10000;
+	static constexpr size_t TRAFFIC_MAX_SESSIONS = 64;
+
+	CTrafficChecker()
+	{
+		Reset(0);
+	}
+
+	CTrafficChecker(const CTrafficChecker&) = delete;
+	CTrafficChecker& operator=(const CTrafficChecker&) = delete;
+
+	/**
+	 * @brief Clears the statistics and the partial frame.
+	 * @param nLocalSession Session id of the local generator, whose frames measure round trips.
+	 */
+	void Reset(uint32_t nLocalSession)
+	{
+		std::lock_guard<std::mutex> lock(m_pLock);
+		m_nLocalSession = nLocalSession;
+		m_mapSessions.clear();
+		m_vecPending.clear();
+		m_nFirstArrival = 0;
+		m_nStats = CTrafficCheckerStats();
+	}
+
+	/**
+	 * @brief Scans received bytes for frames.
+	 */
+	void Feed(const void* pData, size_t nLength)
+	{
+		if (nLength == 0)
+		{
+			return;
+		}
+		std::lock_guard<std::mutex> lock(m_pLock);
+		const char* pInput = static_cast<const char*>(pData);
+		m_vecPending.insert(m_vecPending.end(), pInput, pInput + nLength);
+
+		const char* pBuffer = m_vecPending.data();
+		const size_t nSize = m_vecPending.size();
+		size_t nPos = 0;
+		while (nSize - nPos >= sizeof(CTrafficFrameHeader))
+		{
+			const char* pFound = static_cast<const char*>(memchr(pBuffer + nPos, TRAFFIC_FRAME_MAGIC[0], nSize - nPos));
+			if (pFound == nullptr)
+			{
+				m_nStats.nSkipped += nSize - nPos;
+				nPos = nSize;
+				break;
+			}
+			m_nStats.nSkipped += (pFound - pBuffer) - nPos;
+			nPos = pFound - pBuffer;
+			if (nSize - nPos < sizeof(CTrafficFrameHeader))
+			{
+				break;
+			}
+			CTrafficFrameHeader pHeader;
+			memcpy(&pHeader, pBuffer + nPos, sizeof(pHeader));
+			if ((memcmp(pHeader.nMagic, TRAFFIC_FRAME_MAGIC, sizeof(pHeader.nMagic)) != 0) ||
+				(pHeader.nPayloadLength > TRAFFIC_MAX_PAYLOAD) ||
+				(Crc32(&pHeader, offsetof(CTrafficFrameHeader, nHeaderCrc)) != pHeader.nHeaderCrc))
+			{
+				m_nStats.nSkipped++;
+				nPos++;
+				continue;
+			}
+			const size_t nFrameLength = pHeader.nPayloadLength + TRAFFIC_FRAME_OVERHEAD;
+			if (nSize - nPos < nFrameLength)
+			{
+				break;
+			}
+			const char* pPayload = pBuffer + nPos + sizeof(pHeader);
+			uint32_t nCrc;
+			memcpy(&nCrc, pPayload + pHeader.nPayloadLength, sizeof(nCrc));
+			if (Crc32(pPayload, pHeader.nPayloadLength) != nCrc)
+			{
+				// Bytes were lost or damaged inside the frame: the next header may start in it
+				m_nStats.nCorrupt++;
+				m_nStats.nSkipped++;
+				nPos++;
+				continue;
+			}
+			Account(pHeader, nFrameLength);
+			nPos += nFrameLength;
+		}
+		m_vecPending.erase(m_vecPending.begin(), m_vecPending.begin() + nPos);
+	}
+
+	/**
+	 * @brief Returns a snapshot of the statistics of all sessions.
+	 */
+	CTrafficCheckerStats GetStats()
+	{
+		std::lock_guard<std::mutex> lock(m_pLock);
+		return m_nStats;
+	}
+
+	/**
+	 * @brief Returns the sequence number accounting of one session.
+	 * @return false if no frame of the session was seen, or it was forgotten.
+	 */
+	bool GetSessionStats(uint32_t nSession, CTrafficSessionStats& pStats)
+	{
+		std::lock_guard<std::mutex> lock(m_pLock);
+		const auto it = m_mapSessions.find(nSession);
+		if (it == m_mapSessions.end())
+		{
+			return false;
+		}
+		pStats = it->second.nStats;
+		return true;
+	}
+
+protected:
+	struct CTrafficSession
+	{
+		uint64_t nHighest;                  // highest sequence number seen
+		uint64_t nLastArrival;              // of the last frame, to forget the oldest session
+		std::vector<uint64_t> vecSeen;      // bit per sequence number received, modulo TRAFFIC_REORDER_WINDOW
+		std::vector<uint64_t> vecMissing;   // bit per sequence number counted as lost
+		CTrafficSessionStats nStats;
+	};
+
+	void Account(const CTrafficFrameHeader& pHeader, size_t nFrameLength)
+	{
+		const uint64_t nNow = CTrafficGenerator::GetTimestamp();
+		const uint64_t nSequence = pHeader.nSequence;
+		auto it = m_mapSessions.find(pHeader.nSession);
+		if (it == m_mapSessions.end())
+		{
+			// A new run: its first frame is the baseline
+			if (m_mapSessions.size() >= TRAFFIC_MAX_SESSIONS)
+			{
+				auto itOldest = m_mapSessions.begin();
+				for (auto itSession = m_mapSessions.begin(); itSession != m_mapSessions.end(); ++itSession)
+				{
+					if (itSession->second.nLastArrival < itOldest->second.nLastArrival)
+					{
+						itOldest = itSession;
+					}
+				}
+				m_mapSessions.erase(itOldest);
+			}
+			it = m_mapSessions.emplace(pHeader.nSession, CTrafficSession()).first;
+			it->second.nHighest = nSequence;
+			it->second.vecSeen.assign(TRAFFIC_REORDER_WINDOW / 64, 0);
+			it->second.vecMissing.assign(TRAFFIC_REORDER_WINDOW / 64, 0);
+			it->second.nStats = CTrafficSessionStats();
+			SetBit(it->second.vecSeen, nSequence, true);
+		}
+		else
+		{
+			CTrafficSession& pSession = it->second;
+			if (nSequence > pSession.nHighest)
+			{
+				const uint64_t nGap = nSequence - pSession.nHighest - 1;
+				pSession.nStats.nLost += nGap;
+				m_nStats.nLost += nGap;
+				if (nGap >= TRAFFIC_REORDER_WINDOW)
+				{
+					std::fill(pSession.vecSeen.begin(), pSession.vecSeen.end(), 0);
+					std::fill(pSession.vecMissing.begin(), pSession.vecMissing.end(), ~uint64_t(0));
+				}
+				else
+				{
+					for (uint64_t nSkipped = pSession.nHighest + 1; nSkipped < nSequence; nSkipped++)
+					{
+						SetBit(pSession.vecSeen, nSkipped, false);
+						SetBit(pSession.vecMissing, nSkipped, true);
+					}
+				}
+				pSession.nHighest = nSequence;
+				SetBit(pSession.vecSeen, nSequence, true);
+				SetBit(pSession.vecMissing, nSequence, false);
+			}
+			else if (pSession.nHighest - nSequence >= TRAFFIC_REORDER_WINDOW)
+			{
+				pSession.nStats.nStale++;
+				m_nStats.nStale++;
+				return;
+			}
+			else if (GetBit(pSession.vecSeen, nSequence))
+			{
+				pSession.nStats.nDuplicates++;
+				m_nStats.nDuplicates++;
+				return;
+			}
+			else
+			{
+				SetBit(pSession.vecSeen, nSequence, true);
+				pSession.nStats.nReordered++;
+				m_nStats.nReordered++;
+				if (GetBit(pSession.vecMissing, nSequence) && (pSession.nStats.nLost != 0))
+				{
+					SetBit(pSession.vecMissing, nSequence, false);
+					pSession.nStats.nLost--;
+					m_nStats.nLost--;
+				}
+			}
+		}
+		it->second.nLastArrival = nNow;
+		it->second.nStats.nFrames++;
+
+		if (m_nStats.nFrames == 0)
+		{
+			m_nFirstArrival = nNow;
+		}
+		m_nStats.nFrames++;
+		m_nStats.nBytes += nFrameLength;
+		m_nStats.nElapsed = nNow - m_nFirstArrival;
+		if (nNow >= pHeader.nTimestamp)
+		{
+			const uint64_t nLatency = (nNow - pHeader.nTimestamp) / 1000;
+			if ((m_nLocalSession != 0) && (pHeader.nSession == m_nLocalSession))
+			{
+				m_nStats.pRoundTrip.Record(nLatency);
+			}
+			else
+			{
+				m_nStats.pOneWay.Record(nLatency);
+			}
+		}
+	}
+
+	static bool GetBit(const std::vector<uint64_t>& vecBits, uint64_t nSequence)
+	{
+		const uint64_t nBit = nSequence % TRAFFIC_REORDER_WINDOW;
+		return (vecBits[nBit / 64] >> (nBit % 64)) & 1;
+	}
+
+	static void SetBit(std::vector<uint64_t>& vecBits, uint64_t nSequence, bool bValue)
+	{
+		const uint64_t nBit = nSequence % TRAFFIC_REORDER_WINDOW;
+		if (bValue)
+		{
+			vecBits[nBit / 64] |= uint64_t(1) << (nBit % 64);
+		}
+		else
+		{
+			vecBits[nBit / 64] &= ~(uint64_t(1) << (nBit % 64));
+		}
+	}
+
+	std::mutex m_pLock;
+	uint32_t m_nLocalSession;
+	std::map<uint32_t, CTrafficSession> m_mapSessions;
+	std::vector<char> m_vecPending; // bytes not yet scanned or holding a partial frame
+	uint64_t m_nFirstArrival;
+	CTrafficCheckerStats m_nStats;
+};
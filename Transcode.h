@@ -0,0 +1,269 @@
+/* Copyright (C) 2014-2026 Stefan-Mihai MOGA
+This file is part of IntelliPort application developed by Stefan-Mihai MOGA.
+IntelliPort is an alternative Windows version to the famous HyperTerminal!
+
+IntelliPort is free software: you can redistribute it and/or modify it
+under the terms of the GNU General Public License as published by the Open
+Source Initiative, either version 3 of the License, or any later version.
+
+IntelliPort is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+IntelliPort. If not, see <http://www.opensource.org/licenses/gpl-3.0.html>*/
+
+// Transcode.h : vectorized UTF-16 byte swapping, UTF-16 to UTF-8 and UTF-8 validation
+//
+
+#pragma once
+
+#include "DelimiterScanner.h"
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+/**
+ * @brief Swaps the bytes of UTF-16 code units, converting UTF-16BE to UTF-16LE and back.
+ *
+ * Swaps 16 code units per step with AVX2 or 8 with SSE2. pSource and pOutput
+ * may be the same buffer, for swapping in place.
+ *
+ * @param pSource Code units to swap.
+ * @param nLength Number of code units.
+ * @param pOutput Buffer of at least nLength code units.
+ */
+inline void SwapUtf16Bytes(const uint16_t* pSource, size_t nLength, uint16_t* pOutput)
+{
+	size_t nIndex = 0;
+#if defined(DELIMITER_SCANNER_AVX2)
+	for (; nIndex + 16 <= nLength; nIndex += 16)
+	{
+		const __m256i vData = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pSource + nIndex));
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(pOutput + nIndex), _mm256_or_si256(_mm256_slli_epi16(vData, 8), _mm256_srli_epi16(vData, 8)));
+	}
+#endif
+#if defined(DELIMITER_SCANNER_SSE2)
+	for (; nIndex + 8 <= nLength; nIndex += 8)
+	{
+		const __m128i vData = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pSource + nIndex));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(pOutput + nIndex), _mm_or_si128(_mm_slli_epi16(vData, 8), _mm_srli_epi16(vData, 8)));
+	}
+#endif
+	for (; nIndex < nLength; nIndex++)
+	{
+		pOutput[nIndex] = static_cast<uint16_t>((pSource[nIndex] << 8) | (pSource[nIndex] >> 8));
+	}
+}
+
+/**
+ * @brief Returns the most UTF-8 bytes Utf16ToUtf8() can write for nLength code units.
+ */
+inline size_t GetUtf8MaxLength(size_t nLength)
+{
+	return 3 * nLength;
+}
+
+/**
+ * @brief Converts UTF-16 to UTF-8.
+ *
+ * Runs of ASCII are narrowed 16 code units per step with AVX2 or 8 with SSE2;
+ * other characters are encoded one at a time. A surrogate pair becomes one 4-byte
+ * sequence, and an unpaired surrogate becomes U+FFFD, as WideCharToMultiByte
+ * does. A pair split between two calls is therefore replaced: callers that
+ * convert in blocks should not end a block on a high surrogate.
+ *
+ * @param pSource UTF-16 code units.
+ * @param nLength Number of code units.
+ * @param bSwap true if the code units are in the opposite byte order (UTF-16BE).
+ * @param pOutput Buffer of at least GetUtf8MaxLength(nLength) bytes.
+ * @return Number of bytes written.
+ */
+inline size_t Utf16ToUtf8(const uint16_t* pSource, size_t nLength, bool bSwap, char* pOutput)
+{
+	unsigned char* pTarget = reinterpret_cast<unsigned char*>(pOutput);
+	size_t nIndex = 0;
+	while (nIndex < nLength)
+	{
+		uint32_t nCodePoint = bSwap ? static_cast<uint16_t>((pSource[nIndex] << 8) | (pSource[nIndex] >> 8)) : pSource[nIndex];
+#if defined(DELIMITER_SCANNER_AVX2)
+		// Probe only at the start of an ASCII run, so text without ASCII is not slowed down;
+		// the output always has room for 16 more bytes while 16 code units remain
+		if ((nCodePoint < 0x80) && (nIndex + 16 <= nLength))
+		{
+			__m256i vData = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pSource + nIndex));
+			if (bSwap)
+			{
+				vData = _mm256_or_si256(_mm256_slli_epi16(vData, 8), _mm256_srli_epi16(vData, 8));
+			}
+			const __m256i vHigh = _mm256_and_si256(vData, _mm256_set1_epi16(static_cast<short>(0xFF80)));
+			const uint32_t nMask = ~static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi16(vHigh, _mm256_setzero_si256())));
+			// The pack works per 128-bit lane: gather both lanes' low halves into the first 16 bytes
+			const __m256i vPacked = _mm256_permute4x64_epi64(_mm256_packus_epi16(vData, vData), 0xD8);
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(pTarget), _mm256_castsi256_si128(vPacked));
+			if (nMask == 0)
+			{
+				pTarget += 16;
+				nIndex += 16;
+				continue;
+			}
+			const unsigned int nPrefix = DelimiterScannerLowestBit(nMask) / 2;
+			pTarget += nPrefix;
+			nIndex += nPrefix;
+			continue;
+		}
+#endif
+#if defined(DELIMITER_SCANNER_SSE2)
+		// The output always has room for 8 more bytes while 8 code units remain
+		if ((nCodePoint < 0x80) && (nIndex + 8 <= nLength))
+		{
+			__m128i vData = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pSource + nIndex));
+			if (bSwap)
+			{
+				vData = _mm_or_si128(_mm_slli_epi16(vData, 8), _mm_srli_epi16(vData, 8));
+			}
+			const __m128i vHigh = _mm_and_si128(vData, _mm_set1_epi16(static_cast<short>(0xFF80)));
+			const uint32_t nMask = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi16(vHigh, _mm_setzero_si128()))) ^ 0xFFFF;
+			_mm_storel_epi64(reinterpret_cast<__m128i*>(pTarget), _mm_packus_epi16(vData, vData));
+			if (nMask == 0)
+			{
+				pTarget += 8;
+				nIndex += 8;
+				continue;
+			}
+			// Keep the ASCII prefix; the scalar encoder takes the next character
+			const unsigned int nPrefix = DelimiterScannerLowestBit(nMask) / 2;
+			pTarget += nPrefix;
+			nIndex += nPrefix;
+			continue;
+		}
+#endif
+		nIndex++;
+		if (nCodePoint < 0x80)
+		{
+			*pTarget++ = static_cast<unsigned char>(nCodePoint);
+			continue;
+		}
+		if (nCodePoint < 0x800)
+		{
+			*pTarget++ = static_cast<unsigned char>(0xC0 | (nCodePoint >> 6));
+			*pTarget++ = static_cast<unsigned char>(0x80 | (nCodePoint & 0x3F));
+			continue;
+		}
+		if ((nCodePoint >= 0xD800) && (nCodePoint <= 0xDFFF))
+		{
+			const uint32_t nNext = (nIndex < nLength) ?
+				(bSwap ? static_cast<uint16_t>((pSource[nIndex] << 8) | (pSource[nIndex] >> 8)) : pSource[nIndex]) : 0;
+			if ((nCodePoint <= 0xDBFF) && (nNext >= 0xDC00) && (nNext <= 0xDFFF))
+			{
+				nCodePoint = 0x10000 + ((nCodePoint - 0xD800) << 10) + (nNext - 0xDC00);
+				nIndex++;
+				*pTarget++ = static_cast<unsigned char>(0xF0 | (nCodePoint >> 18));
+				*pTarget++ = static_cast<unsigned char>(0x80 | ((nCodePoint >> 12) & 0x3F));
+				*pTarget++ = static_cast<unsigned char>(0x80 | ((nCodePoint >> 6) & 0x3F));
+				*pTarget++ = static_cast<unsigned char>(0x80 | (nCodePoint & 0x3F));
+				continue;
+			}
+			nCodePoint = 0xFFFD; // unpaired surrogate
+		}
+		*pTarget++ = static_cast<unsigned char>(0xE0 | (nCodePoint >> 12));
+		*pTarget++ = static_cast<unsigned char>(0x80 | ((nCodePoint >> 6) & 0x3F));
+		*pTarget++ = static_cast<unsigned char>(0x80 | (nCodePoint & 0x3F));
+	}
+	return static_cast<size_t>(pTarget - reinterpret_cast<unsigned char*>(pOutput));
+}
+
+/**
+ * @brief Checks that a buffer holds well-formed UTF-8.
+ *
+ * Skips ASCII 32 bytes per step with AVX2 or 16 with SSE2 and checks every other sequence
+ * against the ranges of the Unicode standard, rejecting overlong forms,
+ * surrogates and code points above U+10FFFF.
+ *
+ * @param pData Bytes to check.
+ * @param nLength Number of bytes.
+ * @return Length of the longest well-formed prefix: nLength if all of it is
+ * valid, otherwise the offset of the first invalid or truncated sequence.
+ */
+inline size_t ValidateUtf8(const char* pData, size_t nLength)
+{
+	const unsigned char* pInput = reinterpret_cast<const unsigned char*>(pData);
+	size_t nIndex = 0;
+	while (nIndex < nLength)
+	{
+#if defined(DELIMITER_SCANNER_AVX2)
+		// Probe only at the start of an ASCII run, so text without ASCII is not slowed down
+		while ((nIndex + 32 <= nLength) && (pInput[nIndex] < 0x80))
+		{
+			const uint32_t nMask = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(pInput + nIndex))));
+			if (nMask != 0)
+			{
+				nIndex += DelimiterScannerLowestBit(nMask);
+				break;
+			}
+			nIndex += 32;
+		}
+#endif
+#if defined(DELIMITER_SCANNER_SSE2)
+		while ((nIndex + 16 <= nLength) && (pInput[nIndex] < 0x80))
+		{
+			const uint32_t nMask = static_cast<uint32_t>(_mm_movemask_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(pInput + nIndex))));
+			if (nMask != 0)
+			{
+				nIndex += DelimiterScannerLowestBit(nMask);
+				break;
+			}
+			nIndex += 16;
+		}
+		if (nIndex >= nLength)
+		{
+			break;
+		}
+#endif
+		const unsigned char nByte = pInput[nIndex];
+		if (nByte < 0x80)
+		{
+			nIndex++;
+			continue;
+		}
+		size_t nRemaining = 0;
+		unsigned char nLower = 0x80, nUpper = 0xBF;
+		if ((nByte >= 0xC2) && (nByte <= 0xDF))
+		{
+			nRemaining = 1;
+		}
+		else if ((nByte >= 0xE0) && (nByte <= 0xEF))
+		{
+			nLower = (nByte == 0xE0) ? 0xA0 : 0x80;
+			nUpper = (nByte == 0xED) ? 0x9F : 0xBF;
+			nRemaining = 2;
+		}
+		else if ((nByte >= 0xF0) && (nByte <= 0xF4))
+		{
+			nLower = (nByte == 0xF0) ? 0x90 : 0x80;
+			nUpper = (nByte == 0xF4) ? 0x8F : 0xBF;
+			nRemaining = 3;
+		}
+		else
+		{
+			return nIndex;
+		}
+		if (nLength - nIndex <= nRemaining)
+		{
+			return nIndex; // truncated at the end of the buffer
+		}
+		if ((pInput[nIndex + 1] < nLower) || (pInput[nIndex + 1] > nUpper))
+		{
+			return nIndex;
+		}
+		for (size_t nByteIndex = 2; nByteIndex <= nRemaining; nByteIndex++)
+		{
+			if ((pInput[nIndex + nByteIndex] & 0xC0) != 0x80)
+			{
+				return nIndex;
+			}
+		}
+		nIndex += nRemaining + 1;
+	}
+	return nLength;
+}
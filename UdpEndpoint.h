@@ -0,0 +1,276 @@
+/* Copyright (C) 2014-2026 Stefan-Mihai MOGA
+This file is part of IntelliPort application developed by Stefan-Mihai MOGA.
+IntelliPort is an alternative Windows version to the famous HyperTerminal!
+
+IntelliPort is free software: you can redistribute it and/or modify it
+under the terms of the GNU General Public License as published by the Open
+Source Initiative, either version 3 of the License, or any later version.
+
+IntelliPort is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+IntelliPort. If not, see <http://www.opensource.org/licenses/gpl-3.0.html>*/
+
+// UdpEndpoint.h : UDP destination resolved once and batched datagram sends
+//
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#include <ws2tcpip.h>
+typedef TCHAR UdpChar;
+typedef SOCKET UdpSocket;
+typedef ADDRINFOT UdpAddrInfo;
+#else
+#include <cerrno>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+typedef char UdpChar;
+typedef int UdpSocket;
+typedef addrinfo UdpAddrInfo;
+#endif
+
+/**
+ * @brief One datagram handed to UdpSendMany().
+ */
+struct CUdpDatagram
+{
+	const char* pData;
+	size_t nLength;
+};
+
+/**
+ * @brief A UDP destination whose host name is looked up once and then reused.
+ *
+ * Resolve() runs getaddrinfo for a host and port and keeps every address it
+ * returns as a ready-made sockaddr, so a send costs no resolver call and no
+ * port formatting. The address that last worked is tried first (see
+ * CWSocket::SendTo). With a time to live the endpoint turns stale that many
+ * seconds after a lookup, and the sender refreshes it; a failed refresh keeps
+ * the previous addresses, so a resolver outage does not stop the session.
+ * Not thread-safe: guard it with the lock of the socket it is used with.
+ */
+class CUdpEndpoint
+{
+public:
+	struct CUdpAddress
+	{
+		sockaddr_storage pAddress;
+		int nLength;
+	};
+
+	CUdpEndpoint() : m_nPort(0), m_nFamily(AF_UNSPEC), m_nTimeToLive(0), m_nCurrent(0)
+	{
+	}
+
+	/**
+	 * @brief Looks up a destination and replaces the cached addresses.
+	 *
+	 * @param lpszHost Host name or numeric address; nullptr or empty for the loopback address.
+	 * @param nPort Destination port.
+	 * @param nFamily AF_INET, AF_INET6 or AF_UNSPEC for both.
+	 * @param nTimeToLive Seconds before the addresses are looked up again; 0 keeps them for good.
+	 * @return 0, or the getaddrinfo error code.
+	 */
+	int Resolve(const UdpChar* lpszHost, unsigned int nPort, int nFamily = AF_UNSPEC, uint32_t nTimeToLive = 0)
+	{
+		m_strHost = (lpszHost != nullptr) ? lpszHost : std::basic_string<UdpChar>();
+		m_nPort = nPort;
+		m_nFamily = nFamily;
+		m_nTimeToLive = nTimeToLive;
+		m_vecAddresses.clear();
+		m_nCurrent = 0;
+		return Refresh();
+	}
+
+	/**
+	 * @brief Looks up the same destination again.
+	 * @return 0, or the getaddrinfo error code; on an error the previous addresses are kept.
+	 */
+	int Refresh()
+	{
+		static const UdpChar lpszAnyService[] = { '0', 0 }; // the port is patched into every address
+		UdpAddrInfo hints = {};
+		hints.ai_family = m_nFamily;
+		hints.ai_socktype = SOCK_DGRAM;
+		hints.ai_protocol = IPPROTO_UDP;
+		UdpAddrInfo* pList = nullptr;
+#ifdef _WIN32
+		const int nError = GetAddrInfo(m_strHost.empty() ? nullptr : m_strHost.c_str(), lpszAnyService, &hints, &pList);
+#else
+		const int nError = getaddrinfo(m_strHost.empty() ? nullptr : m_strHost.c_str(), lpszAnyService, &hints, &pList);
+#endif
+		// A failed lookup is not retried before the time to live ends either
+		m_tResolved = std::chrono::steady_clock::now();
+		if (nError != 0)
+		{
+			return nError;
+		}
+
+		std::vector<CUdpAddress> vecAddresses;
+		for (const UdpAddrInfo* pAddress = pList; pAddress != nullptr; pAddress = pAddress->ai_next)
+		{
+			if ((pAddress->ai_addr == nullptr) || (pAddress->ai_addrlen > sizeof(sockaddr_storage)))
+			{
+				continue;
+			}
+			CUdpAddress address = {};
+			memcpy(&address.pAddress, pAddress->ai_addr, pAddress->ai_addrlen);
+			address.nLength = static_cast<int>(pAddress->ai_addrlen);
+			if (address.pAddress.ss_family == AF_INET)
+			{
+				reinterpret_cast<sockaddr_in*>(&address.pAddress)->sin_port = htons(static_cast<uint16_t>(m_nPort));
+			}
+			else if (address.pAddress.ss_family == AF_INET6)
+			{
+				reinterpret_cast<sockaddr_in6*>(&address.pAddress)->sin6_port = htons(static_cast<uint16_t>(m_nPort));
+			}
+			else
+			{
+				continue;
+			}
+			vecAddresses.push_back(address);
+		}
+#ifdef _WIN32
+		FreeAddrInfo(pList);
+#else
+		freeaddrinfo(pList);
+#endif
+		if (vecAddresses.empty())
+		{
+			return EAI_NONAME;
+		}
+		m_vecAddresses.swap(vecAddresses);
+		m_nCurrent = 0;
+		return 0;
+	}
+
+	/**
+	 * @brief Returns true if the endpoint was looked up for this host and port.
+	 */
+	bool Matches(const UdpChar* lpszHost, unsigned int nPort) const
+	{
+		return (m_nPort == nPort) && (m_strHost.compare((lpszHost != nullptr) ? lpszHost : std::basic_string<UdpChar>()) == 0);
+	}
+
+	/**
+	 * @brief Returns true if at least one address is known.
+	 */
+	bool IsResolved() const
+	{
+		return !m_vecAddresses.empty();
+	}
+
+	/**
+	 * @brief Returns true once the time to live has passed since the last lookup.
+	 */
+	bool IsStale() const
+	{
+		return (m_nTimeToLive != 0) &&
+			(std::chrono::steady_clock::now() - m_tResolved >= std::chrono::seconds(m_nTimeToLive));
+	}
+
+	size_t GetCount() const
+	{
+		return m_vecAddresses.size();
+	}
+
+	/**
+	 * @brief Index of the address tried first.
+	 */
+	size_t GetCurrent() const
+	{
+		return m_nCurrent;
+	}
+
+	void SetCurrent(size_t nIndex)
+	{
+		m_nCurrent = nIndex;
+	}
+
+	const sockaddr* GetAddress(size_t nIndex) const
+	{
+		return reinterpret_cast<const sockaddr*>(&m_vecAddresses[nIndex].pAddress);
+	}
+
+	int GetLength(size_t nIndex) const
+	{
+		return m_vecAddresses[nIndex].nLength;
+	}
+
+protected:
+	std::basic_string<UdpChar> m_strHost;
+	unsigned int m_nPort;
+	int m_nFamily;
+	uint32_t m_nTimeToLive;         // seconds, 0 = never stale
+	std::chrono::steady_clock::time_point m_tResolved;
+	std::vector<CUdpAddress> m_vecAddresses;
+	size_t m_nCurrent;
+};
+
+/**
+ * @brief Datagrams submitted to the kernel by one call of UdpSendMany().
+ */
+static constexpr int UDP_SEND_BATCH = 64;
+
+/**
+ * @brief Sends each datagram to the same address, many per system call.
+ *
+ * Linux: sendmmsg with up to UDP_SEND_BATCH datagrams a call. Elsewhere one
+ * sendto per datagram, as Windows has no multiple-datagram send for a
+ * regular socket. Datagram boundaries are kept.
+ *
+ * @return The number of datagrams sent; fewer than nCount (or -1 if none was
+ * sent) on an error, see WSAGetLastError / errno.
+ */
+inline int UdpSendMany(UdpSocket hSocket, const CUdpDatagram* pDatagrams, int nCount, const sockaddr* pAddress, int nAddressLength, int nFlags)
+{
+	int nSent = 0;
+#ifdef __linux__
+	mmsghdr pMessages[UDP_SEND_BATCH];
+	iovec pBuffers[UDP_SEND_BATCH];
+	while (nSent < nCount)
+	{
+		const int nBatch = ((nCount - nSent) < UDP_SEND_BATCH) ? (nCount - nSent) : UDP_SEND_BATCH;
+		for (int nIndex = 0; nIndex < nBatch; nIndex++)
+		{
+			pBuffers[nIndex].iov_base = const_cast<char*>(pDatagrams[nSent + nIndex].pData);
+			pBuffers[nIndex].iov_len = pDatagrams[nSent + nIndex].nLength;
+			memset(&pMessages[nIndex], 0, sizeof(mmsghdr));
+			pMessages[nIndex].msg_hdr.msg_name = const_cast<sockaddr*>(pAddress);
+			pMessages[nIndex].msg_hdr.msg_namelen = static_cast<socklen_t>(nAddressLength);
+			pMessages[nIndex].msg_hdr.msg_iov = &pBuffers[nIndex];
+			pMessages[nIndex].msg_hdr.msg_iovlen = 1;
+		}
+		const int nResult = sendmmsg(hSocket, pMessages, static_cast<unsigned int>(nBatch), nFlags);
+		if (nResult <= 0)
+		{
+			if ((nResult < 0) && (errno == EINTR))
+			{
+				continue;
+			}
+			break;
+		}
+		nSent += nResult;
+	}
+#else
+	for (; nSent < nCount; nSent++)
+	{
+		if (sendto(hSocket, pDatagrams[nSent].pData, static_cast<int>(pDatagrams[nSent].nLength), nFlags, pAddress, nAddressLength) < 0)
+		{
+			break;
+		}
+	}
+#endif
+	return ((nSent == 0) && (nCount > 0)) ? -1 : nSent;
+}
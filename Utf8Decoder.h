@@ -0,0 +1,264 @@
+/* Copyright (C) 2014-2026 Stefan-Mihai MOGA
+This file is part of IntelliPort application developed by Stefan-Mihai MOGA.
+IntelliPort is an alternative Windows version to the famous HyperTerminal!
+
+IntelliPort is free software: you can redistribute it and/or modify it
+under the terms of the GNU General Public License as published by the Open
+Source Initiative, either version 3 of the License, or any later version.
+
+IntelliPort is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+IntelliPort. If not, see <http://www.opensource.org/licenses/gpl-3.0.html>*/
+
+// Utf8Decoder.h : streaming UTF-8 to wide character decoder
+//
+
+#pragma once
+
+#include "DelimiterScanner.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/**
+ * @brief Incremental UTF-8 decoder for data that arrives in arbitrary chunks.
+ *
+ * A character split across two calls to Decode() is carried over and completed
+ * by the next call, so chunk boundaries never corrupt text. Invalid input
+ * (stray continuation bytes, overlong forms, surrogates, code points above
+ * U+10FFFF, truncated sequences) is replaced by U+FFFD, one per maximal invalid
+ * subpart as recommended by the Unicode standard. A NUL byte is shown as the
+ * U+2400 control picture, since the edit control would stop at a real one.
+ *
+ * Runs of ASCII are widened 16 bytes per step with SSE2 when the compiler
+ * targets it. Output is appended to a caller-owned std::wstring, which can be
+ * cleared and reused so a steady stream does not allocate. The output is UTF-16
+ * where wchar_t is 16 bits wide (Windows) and UTF-32 otherwise.
+ */
+class CUtf8Decoder
+{
+public:
+	static constexpr wchar_t UTF8_REPLACEMENT_CHAR = 0xFFFD;
+	static constexpr wchar_t UTF8_NUL_SYMBOL = 0x2400;
+
+	CUtf8Decoder()
+	{
+		Reset();
+	}
+
+	/**
+	 * @brief Discards a partially received character.
+	 */
+	void Reset()
+	{
+		m_nCodePoint = 0;
+		m_nRemaining = 0;
+		m_nLower = 0x80;
+		m_nUpper = 0xBF;
+	}
+
+	/**
+	 * @brief Returns true while a character is waiting for its continuation bytes.
+	 */
+	bool HasPending() const
+	{
+		return m_nRemaining != 0;
+	}
+
+	/**
+	 * @brief Returns the most wide characters Decode() can append for nLength bytes.
+	 */
+	static size_t GetMaxOutput(size_t nLength)
+	{
+		return nLength + 1;
+	}
+
+	/**
+	 * @brief Decodes a chunk of UTF-8 and appends the text to strOutput.
+	 *
+	 * @param pData Pointer to the UTF-8 bytes (need not be null-terminated).
+	 * @param nLength Number of bytes to decode.
+	 * @param strOutput String receiving the decoded text.
+	 * @return Number of wide characters appended.
+	 */
+	size_t Decode(const char* pData, size_t nLength, std::wstring& strOutput)
+	{
+		const size_t nStart = strOutput.size();
+		strOutput.resize(nStart + GetMaxOutput(nLength));
+		const size_t nCount = Decode(pData, nLength, &strOutput[nStart]);
+		strOutput.resize(nStart + nCount);
+		return nCount;
+	}
+
+	/**
+	 * @brief Decodes a chunk of UTF-8 into a caller-provided buffer.
+	 *
+	 * @param pData Pointer to the UTF-8 bytes.
+	 * @param nLength Number of bytes to decode.
+	 * @param pOutput Buffer of at least GetMaxOutput(nLength) wide characters.
+	 * @return Number of wide characters written.
+	 */
+	size_t Decode(const char* pData, size_t nLength, wchar_t* pOutput)
+	{
+		const unsigned char* pInput = reinterpret_cast<const unsigned char*>(pData);
+		const unsigned char* pEnd = pInput + nLength;
+		wchar_t* pTarget = pOutput;
+
+		while (pInput < pEnd)
+		{
+			if (m_nRemaining == 0)
+			{
+				const unsigned char nByte = *pInput++;
+				if (nByte < 0x80)
+				{
+					*pTarget++ = (nByte != 0) ? static_cast<wchar_t>(nByte) : UTF8_NUL_SYMBOL;
+#if defined(DELIMITER_SCANNER_SSE2)
+					pInput = WidenAscii(pInput, pEnd, pTarget);
+#endif
+				}
+				else if ((nByte >= 0xC2) && (nByte <= 0xDF))
+				{
+					if ((pInput < pEnd) && ((*pInput & 0xC0) == 0x80))
+					{
+						// Complete two-byte character: skip the state machine
+						*pTarget++ = static_cast<wchar_t>(((nByte & 0x1F) << 6) | (*pInput++ & 0x3F));
+						continue;
+					}
+					m_nCodePoint = nByte & 0x1F;
+					m_nRemaining = 1;
+				}
+				else if ((nByte >= 0xE1) && (nByte <= 0xEC) && (pEnd - pInput >= 2) &&
+					((pInput[0] & 0xC0) == 0x80) && ((pInput[1] & 0xC0) == 0x80))
+				{
+					// Complete three-byte character with no overlong or surrogate form possible
+					*pTarget++ = static_cast<wchar_t>(((nByte & 0x0F) << 12) | ((pInput[0] & 0x3F) << 6) | (pInput[1] & 0x3F));
+					pInput += 2;
+				}
+				else if ((nByte >= 0xE0) && (nByte <= 0xEF))
+				{
+					// Reject overlong forms (E0) and UTF-16 surrogates (ED)
+					m_nLower = (nByte == 0xE0) ? 0xA0 : 0x80;
+					m_nUpper = (nByte == 0xED) ? 0x9F : 0xBF;
+					m_nCodePoint = nByte & 0x0F;
+					m_nRemaining = 2;
+				}
+				else if ((nByte >= 0xF0) && (nByte <= 0xF4))
+				{
+					// Reject overlong forms (F0) and code points above U+10FFFF (F4)
+					m_nLower = (nByte == 0xF0) ? 0x90 : 0x80;
+					m_nUpper = (nByte == 0xF4) ? 0x8F : 0xBF;
+					m_nCodePoint = nByte & 0x07;
+					m_nRemaining = 3;
+				}
+				else
+				{
+					// Continuation byte without a lead byte, or a lead byte never valid in UTF-8
+					*pTarget++ = UTF8_REPLACEMENT_CHAR;
+				}
+			}
+			else
+			{
+				const unsigned char nByte = *pInput;
+				if ((nByte < m_nLower) || (nByte > m_nUpper))
+				{
+					// Truncated sequence: replace it and decode this byte afresh
+					Reset();
+					*pTarget++ = UTF8_REPLACEMENT_CHAR;
+					continue;
+				}
+				pInput++;
+				m_nLower = 0x80;
+				m_nUpper = 0xBF;
+				m_nCodePoint = (m_nCodePoint << 6) | (nByte & 0x3F);
+				if (--m_nRemaining == 0)
+				{
+					pTarget = Emit(pTarget, m_nCodePoint);
+				}
+			}
+		}
+		return static_cast<size_t>(pTarget - pOutput);
+	}
+
+	/**
+	 * @brief Ends the stream, replacing a pending incomplete character by U+FFFD.
+	 * @return Number of wide characters appended (0 or 1).
+	 */
+	size_t Flush(std::wstring& strOutput)
+	{
+		if (m_nRemaining == 0)
+		{
+			return 0;
+		}
+		Reset();
+		strOutput.push_back(UTF8_REPLACEMENT_CHAR);
+		return 1;
+	}
+
+protected:
+	static wchar_t* Emit(wchar_t* pTarget, uint32_t nCodePoint)
+	{
+		if ((sizeof(wchar_t) == 2) && (nCodePoint >= 0x10000))
+		{
+			nCodePoint -= 0x10000;
+			*pTarget++ = static_cast<wchar_t>(0xD800 + (nCodePoint >> 10));
+			*pTarget++ = static_cast<wchar_t>(0xDC00 + (nCodePoint & 0x3FF));
+		}
+		else
+		{
+			*pTarget++ = static_cast<wchar_t>(nCodePoint);
+		}
+		return pTarget;
+	}
+
+#if defined(DELIMITER_SCANNER_SSE2)
+	/**
+	 * @brief Widens the leading run of printable ASCII, 16 bytes per step.
+	 * @return Pointer to the first byte that still has to be decoded.
+	 */
+	static const unsigned char* WidenAscii(const unsigned char* pInput, const unsigned char* pEnd, wchar_t*& pTarget)
+	{
+		const __m128i vZero = _mm_setzero_si128();
+		while (pEnd - pInput >= 16)
+		{
+			const __m128i vData = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pInput));
+			// The sign bit marks non-ASCII bytes; NUL bytes are flagged by the compare
+			const uint32_t nMask = static_cast<uint32_t>(_mm_movemask_epi8(_mm_or_si128(vData, _mm_cmpeq_epi8(vData, vZero))));
+			if (nMask != 0)
+			{
+				// Copy the ASCII prefix; the scalar decoder takes the rest
+				const unsigned int nPrefix = DelimiterScannerLowestBit(nMask);
+				for (unsigned int nIndex = 0; nIndex < nPrefix; nIndex++)
+				{
+					*pTarget++ = static_cast<wchar_t>(pInput[nIndex]);
+				}
+				return pInput + nPrefix;
+			}
+			const __m128i vLow = _mm_unpacklo_epi8(vData, vZero);
+			const __m128i vHigh = _mm_unpackhi_epi8(vData, vZero);
+			if (sizeof(wchar_t) == 2)
+			{
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(pTarget), vLow);
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(pTarget + 8), vHigh);
+			}
+			else
+			{
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(pTarget), _mm_unpacklo_epi16(vLow, vZero));
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(pTarget + 4), _mm_unpackhi_epi16(vLow, vZero));
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(pTarget + 8), _mm_unpacklo_epi16(vHigh, vZero));
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(pTarget + 12), _mm_unpackhi_epi16(vHigh, vZero));
+			}
+			pTarget += 16;
+			pInput += 16;
+		}
+		return pInput;
+	}
+#endif
+
+	uint32_t m_nCodePoint;  // bits gathered so far
+	int m_nRemaining;       // continuation bytes still expected
+	unsigned char m_nLower; // valid range of the next continuation byte
+	unsigned char m_nUpper;
+};
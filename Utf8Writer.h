@@ -0,0 +1,192 @@
+/* Copyright (C) 2014-2026 Stefan-Mihai MOGA
+This file is part of IntelliPort application developed by Stefan-Mihai MOGA.
+IntelliPort is an alternative Windows version to the famous HyperTerminal!
+
+IntelliPort is free software: you can redistribute it and/or modify it
+under the terms of the GNU General Public License as published by the Open
+Source Initiative, either version 3 of the License, or any later version.
+
+IntelliPort is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+IntelliPort. If not, see <http://www.opensource.org/licenses/gpl-3.0.html>*/
+
+// Utf8Writer.h : buffered UTF-8 output for saving large documents
+//
+
+#pragma once
+
+#include "Transcode.h"
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <memory>
+
+/**
+ * @brief Writes text as UTF-8 through one large aligned buffer.
+ *
+ * UTF-16 text is transcoded straight into the buffer UTF8_WRITER_WINDOW_SIZE
+ * code units at a time and the buffer is handed to the sink when it is full,
+ * so saving takes the same memory whatever the size of the text and the sink
+ * sees few, large, page-aligned writes. A high surrogate at the end of one
+ * call is held back until the next, so text can be written in any pieces.
+ * Errors are the sink's business: CFile::Write throws, which unwinds through
+ * the writer.
+ */
+class CUtf8Writer
+{
+public:
+	static constexpr size_t UTF8_WRITER_BUFFER_SIZE = 0x400000; // bytes handed to the sink at once
+	static constexpr size_t UTF8_WRITER_WINDOW_SIZE = 0x10000;  // code units transcoded at once
+	static constexpr size_t UTF8_WRITER_ALIGNMENT = 0x1000;
+
+	typedef std::function<void(const uint8_t* pData, size_t nLength)> WriteFunction;
+
+	/**
+	 * @param pfnWrite Receives each full buffer, and the rest from Finish().
+	 */
+	explicit CUtf8Writer(WriteFunction pfnWrite) :
+		m_pfnWrite(std::move(pfnWrite)),
+		m_pStorage(new uint8_t[UTF8_WRITER_BUFFER_SIZE + UTF8_WRITER_ALIGNMENT]),
+		m_nUsed(0), m_nPending(0), m_nTotalWritten(0)
+	{
+		const uintptr_t nAddress = reinterpret_cast<uintptr_t>(m_pStorage.get());
+		m_pBuffer = m_pStorage.get() + ((UTF8_WRITER_ALIGNMENT - (nAddress % UTF8_WRITER_ALIGNMENT)) % UTF8_WRITER_ALIGNMENT);
+	}
+
+	CUtf8Writer(const CUtf8Writer&) = delete;
+	CUtf8Writer& operator=(const CUtf8Writer&) = delete;
+
+	/**
+	 * @brief Writes bytes that are already UTF-8 (or a byte order mark).
+	 */
+	void WriteBytes(const void* pData, size_t nLength)
+	{
+		FlushPending();
+		const uint8_t* pInput = static_cast<const uint8_t*>(pData);
+		if (nLength >= UTF8_WRITER_BUFFER_SIZE)
+		{
+			// Too large to be worth copying: hand it to the sink as it is
+			Flush();
+			m_pfnWrite(pInput, nLength);
+			m_nTotalWritten += nLength;
+			return;
+		}
+		if (nLength > UTF8_WRITER_BUFFER_SIZE - m_nUsed)
+		{
+			Flush();
+		}
+		memcpy(m_pBuffer + m_nUsed, pInput, nLength);
+		m_nUsed += nLength;
+	}
+
+	/**
+	 * @brief Transcodes UTF-16 text to UTF-8.
+	 *
+	 * @param pText UTF-16 code units.
+	 * @param nLength Number of code units.
+	 * @param bSwap true if the code units are big-endian.
+	 */
+	void WriteUtf16(const uint16_t* pText, size_t nLength, bool bSwap = false)
+	{
+		if ((nLength > 0) && (m_nPending != 0))
+		{
+			// Complete the pair held back by the previous call
+			const uint16_t nNext = bSwap ? static_cast<uint16_t>((pText[0] << 8) | (pText[0] >> 8)) : pText[0];
+			const uint16_t pPair[2] = { m_nPending, nNext };
+			const bool bPaired = (nNext >= 0xDC00) && (nNext <= 0xDFFF);
+			m_nPending = 0;
+			Transcode(pPair, bPaired ? 2 : 1, false);
+			if (bPaired)
+			{
+				pText++;
+				nLength--;
+			}
+		}
+		while (nLength > 0)
+		{
+			size_t nCount = (nLength < UTF8_WRITER_WINDOW_SIZE) ? nLength : UTF8_WRITER_WINDOW_SIZE;
+			const uint16_t nLast = bSwap ? static_cast<uint16_t>((pText[nCount - 1] << 8) | (pText[nCount - 1] >> 8)) : pText[nCount - 1];
+			if ((nLast >= 0xD800) && (nLast <= 0xDBFF))
+			{
+				// Keep a surrogate pair together: in the next window, or in the next call
+				nCount--;
+				if (nCount == nLength - 1)
+				{
+					m_nPending = nLast;
+				}
+				else if (nCount == 0)
+				{
+					nCount = 1; // a window of one high surrogate followed by more text
+				}
+			}
+			Transcode(pText, nCount, bSwap);
+			if (m_nPending != 0)
+			{
+				break;
+			}
+			pText += nCount;
+			nLength -= nCount;
+		}
+	}
+
+	/**
+	 * @brief Hands the buffered bytes to the sink.
+	 */
+	void Flush()
+	{
+		if (m_nUsed != 0)
+		{
+			m_pfnWrite(m_pBuffer, m_nUsed);
+			m_nTotalWritten += m_nUsed;
+			m_nUsed = 0;
+		}
+	}
+
+	/**
+	 * @brief Ends the text: an unpaired high surrogate becomes U+FFFD, then everything is flushed.
+	 */
+	void Finish()
+	{
+		FlushPending();
+		Flush();
+	}
+
+	/**
+	 * @brief Returns the number of bytes handed to the sink so far.
+	 */
+	uint64_t GetBytesWritten() const
+	{
+		return m_nTotalWritten;
+	}
+
+protected:
+	void Transcode(const uint16_t* pText, size_t nLength, bool bSwap)
+	{
+		if (GetUtf8MaxLength(nLength) > UTF8_WRITER_BUFFER_SIZE - m_nUsed)
+		{
+			Flush();
+		}
+		m_nUsed += Utf16ToUtf8(pText, nLength, bSwap, reinterpret_cast<char*>(m_pBuffer + m_nUsed));
+	}
+
+	void FlushPending()
+	{
+		if (m_nPending != 0)
+		{
+			const uint16_t nPending = m_nPending;
+			m_nPending = 0;
+			Transcode(&nPending, 1, false);
+		}
+	}
+
+	WriteFunction m_pfnWrite;
+	std::unique_ptr<uint8_t[]> m_pStorage;
+	uint8_t* m_pBuffer;         // m_pStorage rounded up to UTF8_WRITER_ALIGNMENT
+	size_t m_nUsed;
+	uint16_t m_nPending;        // high surrogate that ended the previous call, 0 if none
+	uint64_t m_nTotalWritten;
+};
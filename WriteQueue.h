@@ -0,0 +1,487 @@
+/* Copyright (C) 2014-2026 Stefan-Mihai MOGA
+This file is part of IntelliPort application developed by Stefan-Mihai MOGA.
+IntelliPort is an alternative Windows version to the famous HyperTerminal!
+
+IntelliPort is free software: you can redistribute it and/or modify it
+under the terms of the GNU General Public License as published by the Open
+Source Initiative, either version 3 of the License, or any later version.
+
+IntelliPort is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+IntelliPort. If not, see <http://www.opensource.org/licenses/gpl-3.0.html>*/
+
+// WriteQueue.h : bounded send queue drained by a writer thread with gather writes
+//
+
+#pragma once
+
+#include "LatencyHistogram.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#ifndef _WIN32
+#include <cerrno>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#endif
+
+/**
+ * @brief A block of bytes handed to a gather write.
+ */
+struct CWriteSpan
+{
+	const char* pData;
+	size_t nLength;
+};
+
+/**
+ * @brief Result of CWriteQueue::Enqueue; the call never blocks.
+ */
+enum WriteQueueStatus
+{
+	WRITE_QUEUED = 0,               // the writer thread will send the bytes
+	WRITE_QUEUE_FULL = 1,           // back-pressure: the bytes were not taken, try again later
+	WRITE_QUEUE_CLOSED = 2,         // no connection, or a write failed
+};
+
+/**
+ * @brief Counters of a CWriteQueue since Start().
+ */
+struct CWriteQueueStats
+{
+	uint64_t nDepth;                // messages waiting
+	uint64_t nBytesQueued;          // bytes waiting
+	uint64_t nBytesInFlight;        // bytes handed to the write in progress
+	uint64_t nMessagesWritten;
+	uint64_t nBytesWritten;
+	uint64_t nWrites;               // calls of the write function
+	uint64_t nRejected;             // messages refused with WRITE_QUEUE_FULL
+	uint64_t nDiscarded;            // messages dropped by a failed write or by Stop(false)
+	CLatencyHistogram pWriteLatency; // us from enqueueing to the end of the write, oldest message of each segment
+};
+
+/**
+ * @brief Bounded multi-producer, single-consumer send queue with a writer thread.
+ *
+ * Any thread hands bytes to Enqueue(), which copies them and returns at once:
+ * when more than the capacity is waiting it refuses them with WRITE_QUEUE_FULL
+ * instead of blocking, so the UI thread never waits for a slow device or a full
+ * TCP window. The writer thread takes up to WRITE_QUEUE_MAX_GATHER segments at a
+ * time and hands them to the write function as one gather write (writev,
+ * WSASend with several buffers, or back-to-back overlapped writes).
+ *
+ * On stream transports, small messages are copied together into segments of
+ * up to WRITE_QUEUE_COALESCE_SIZE bytes, so a burst of small sends costs one
+ * system call. On datagram transports every message keeps its own segment and
+ * every span must be sent as one datagram. Segment buffers are recycled.
+ */
+class CWriteQueue
+{
+public:
+	static constexpr size_t WRITE_QUEUE_CAPACITY = 0x400000;
+	static constexpr size_t WRITE_QUEUE_COALESCE_SIZE = 0x10000;
+	static constexpr int WRITE_QUEUE_MAX_GATHER = 64;
+	static constexpr size_t WRITE_QUEUE_MAX_FREE = 16;  // recycled segment buffers kept
+
+	/**
+	 * @brief Writes every byte of the spans in order (each span is one datagram
+	 * in datagram mode); returns false on an error, which closes the queue.
+	 * Called on the writer thread only.
+	 */
+	typedef std::function<bool(const CWriteSpan* pSpans, int nCount)> WriteFunction;
+
+	CWriteQueue() : m_bOpen(false), m_bStopping(false), m_bFlush(false), m_bDatagrams(false),
+		m_nCapacity(WRITE_QUEUE_CAPACITY), m_nStats()
+	{
+	}
+
+	~CWriteQueue()
+	{
+		Stop(false);
+	}
+
+	CWriteQueue(const CWriteQueue&) = delete;
+	CWriteQueue& operator=(const CWriteQueue&) = delete;
+
+	/**
+	 * @brief Starts the writer thread and clears the counters.
+	 *
+	 * @param pfnWrite Called on the writer thread.
+	 * @param bDatagrams true to keep message boundaries (UDP).
+	 * @param nCapacity Most bytes waiting before Enqueue() reports WRITE_QUEUE_FULL.
+	 */
+	void Start(WriteFunction pfnWrite, bool bDatagrams, size_t nCapacity = WRITE_QUEUE_CAPACITY)
+	{
+		Stop(false);
+		std::lock_guard<std::mutex> lock(m_pLock);
+		m_pfnWrite = std::move(pfnWrite);
+		m_bDatagrams = bDatagrams;
+		m_nCapacity = nCapacity;
+		m_nStats = CWriteQueueStats();
+		m_bStopping = false;
+		m_bFlush = false;
+		m_bOpen = true;
+		m_pThread = std::thread(&CWriteQueue::Run, this);
+	}
+
+	/**
+	 * @brief Closes the queue and waits for the writer thread to end.
+	 * @param bFlush true to write what is waiting first, false to discard it.
+	 */
+	void Stop(bool bFlush)
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_pLock);
+			m_bOpen = false;
+			m_bStopping = true;
+			m_bFlush = bFlush;
+		}
+		m_pWakeUp.notify_all();
+		m_pRoom.notify_all();
+		if (m_pThread.joinable())
+		{
+			m_pThread.join();
+		}
+	}
+
+	/**
+	 * @brief Returns true while Stop() is waiting for the writer thread.
+	 *
+	 * A write function stuck on a slow device polls this to give up.
+	 */
+	bool IsStopping() const
+	{
+		return m_bStopping.load(std::memory_order_relaxed);
+	}
+
+	/**
+	 * @brief Queues a copy of the bytes for the writer thread. Never blocks.
+	 *
+	 * A message larger than the capacity is accepted when nothing else is
+	 * waiting, so it is not refused forever.
+	 */
+	WriteQueueStatus Enqueue(const void* pData, size_t nLength)
+	{
+		return EnqueueWait(pData, nLength, nullptr);
+	}
+
+	/**
+	 * @brief Queues a copy of the bytes, waiting for room instead of refusing them.
+	 *
+	 * For worker threads that produce faster than the connection sends (the
+	 * capture replay, the traffic generator): while the queue is full, waits in
+	 * 100 ms steps and asks pfnContinue whether to keep waiting. The wait also
+	 * ends when the queue is stopped, so it never outlasts Stop().
+	 *
+	 * @param pfnContinue Returns false to give up; empty to not wait at all.
+	 * @return WRITE_QUEUE_FULL if pfnContinue gave up.
+	 */
+	WriteQueueStatus EnqueueWait(const void* pData, size_t nLength, const std::function<bool()>& pfnContinue)
+	{
+		if (nLength == 0)
+		{
+			return WRITE_QUEUED;
+		}
+		std::unique_lock<std::mutex> lock(m_pLock);
+		while (m_bOpen && (m_nStats.nBytesQueued != 0) && (m_nStats.nBytesQueued + nLength > m_nCapacity))
+		{
+			if (!pfnContinue || !pfnContinue())
+			{
+				m_nStats.nRejected++;
+				return WRITE_QUEUE_FULL;
+			}
+			m_pRoom.wait_for(lock, std::chrono::milliseconds(100));
+		}
+		if (!m_bOpen)
+		{
+			return WRITE_QUEUE_CLOSED;
+		}
+		const bool bWasEmpty = m_queuePending.empty();
+		if (!m_bDatagrams && !bWasEmpty && (m_queuePending.back().vecData.size() < WRITE_QUEUE_COALESCE_SIZE) &&
+			(nLength <= WRITE_QUEUE_COALESCE_SIZE - m_queuePending.back().vecData.size()))
+		{
+			// Coalesce with the segment still waiting
+			std::vector<char>& vecData = m_queuePending.back().vecData;
+			vecData.insert(vecData.end(), static_cast<const char*>(pData), static_cast<const char*>(pData) + nLength);
+			m_queuePending.back().nMessages++;
+		}
+		else
+		{
+			CSegment pSegment;
+			if (!m_vecFree.empty())
+			{
+				pSegment.vecData.swap(m_vecFree.back());
+				m_vecFree.pop_back();
+			}
+			pSegment.vecData.assign(static_cast<const char*>(pData), static_cast<const char*>(pData) + nLength);
+			pSegment.nMessages = 1;
+			pSegment.tEnqueued = std::chrono::steady_clock::now();
+			m_queuePending.push_back(std::move(pSegment));
+		}
+		m_nStats.nDepth++;
+		m_nStats.nBytesQueued += nLength;
+		lock.unlock();
+		if (bWasEmpty)
+		{
+			m_pWakeUp.notify_one();
+		}
+		return WRITE_QUEUED;
+	}
+
+	/**
+	 * @brief Returns a snapshot of the counters. Safe to call from any thread.
+	 */
+	CWriteQueueStats GetStats()
+	{
+		std::lock_guard<std::mutex> lock(m_pLock);
+		return m_nStats;
+	}
+
+protected:
+	struct CSegment
+	{
+		std::vector<char> vecData;
+		uint64_t nMessages;
+		std::chrono::steady_clock::time_point tEnqueued; // of the first message
+	};
+
+	void Run()
+	{
+		std::vector<CSegment> vecWriting;
+		std::vector<CWriteSpan> vecSpans;
+		std::unique_lock<std::mutex> lock(m_pLock);
+		for (;;)
+		{
+			m_pWakeUp.wait(lock, [this]() { return !m_queuePending.empty() || m_bStopping; });
+			if (m_queuePending.empty() || (m_bStopping && !m_bFlush))
+			{
+				break;
+			}
+
+			uint64_t nBytes = 0, nMessages = 0;
+			while (!m_queuePending.empty() && (vecWriting.size() < WRITE_QUEUE_MAX_GATHER))
+			{
+				nBytes += m_queuePending.front().vecData.size();
+				nMessages += m_queuePending.front().nMessages;
+				vecWriting.push_back(std::move(m_queuePending.front()));
+				m_queuePending.pop_front();
+			}
+			m_nStats.nDepth -= nMessages;
+			m_nStats.nBytesQueued -= nBytes;
+			m_nStats.nBytesInFlight = nBytes;
+			lock.unlock();
+			m_pRoom.notify_all();
+
+			vecSpans.clear();
+			for (const CSegment& pSegment : vecWriting)
+			{
+				vecSpans.push_back(CWriteSpan{ pSegment.vecData.data(), pSegment.vecData.size() });
+			}
+			const bool bWritten = m_pfnWrite(vecSpans.data(), static_cast<int>(vecSpans.size()));
+			const std::chrono::steady_clock::time_point tNow = std::chrono::steady_clock::now();
+
+			lock.lock();
+			m_nStats.nBytesInFlight = 0;
+			m_nStats.nWrites++;
+			if (bWritten)
+			{
+				m_nStats.nMessagesWritten += nMessages;
+				m_nStats.nBytesWritten += nBytes;
+				for (const CSegment& pSegment : vecWriting)
+				{
+					m_nStats.pWriteLatency.Record(static_cast<uint64_t>(
+						std::chrono::duration_cast<std::chrono::microseconds>(tNow - pSegment.tEnqueued).count()));
+				}
+			}
+			else
+			{
+				m_nStats.nDiscarded += nMessages;
+				m_bOpen = false;
+			}
+			for (CSegment& pSegment : vecWriting)
+			{
+				if ((m_vecFree.size() < WRITE_QUEUE_MAX_FREE) && (pSegment.vecData.capacity() <= 2 * WRITE_QUEUE_COALESCE_SIZE))
+				{
+					pSegment.vecData.clear();
+					m_vecFree.push_back(std::move(pSegment.vecData));
+				}
+			}
+			vecWriting.clear();
+			if (!bWritten)
+			{
+				break;
+			}
+		}
+		// Whatever is left will not be written
+		for (const CSegment& pSegment : m_queuePending)
+		{
+			m_nStats.nDiscarded += pSegment.nMessages;
+		}
+		m_queuePending.clear();
+		m_nStats.nDepth = 0;
+		m_nStats.nBytesQueued = 0;
+		lock.unlock();
+		m_pRoom.notify_all();
+	}
+
+	std::thread m_pThread;
+	std::mutex m_pLock;
+	std::condition_variable m_pWakeUp;
+	std::condition_variable m_pRoom; // EnqueueWait() waits on it for the writer thread to take bytes
+	bool m_bOpen;                   // Enqueue() accepts bytes
+	std::atomic<bool> m_bStopping;
+	bool m_bFlush;
+	bool m_bDatagrams;
+	size_t m_nCapacity;
+	WriteFunction m_pfnWrite;
+	std::deque<CSegment> m_queuePending;
+	std::vector<std::vector<char>> m_vecFree;
+	CWriteQueueStats m_nStats;
+};
+
+#ifdef _WIN32
+typedef SOCKET WriteQueueSocket;
+#else
+typedef int WriteQueueSocket;
+#endif
+
+/**
+ * @brief Writes every byte of the spans to a stream socket with gather writes.
+ *
+ * Windows: overlapped WSASend with one WSABUF per span. The completion event
+ * has its low bit set, so the completion is not queued to an I/O completion
+ * port the socket is associated with (the socket reactor's). Elsewhere:
+ * sendmsg with one iovec per span and MSG_DONTWAIT, or writev for a descriptor
+ * that is not a socket (a pty in a test). Partial writes are resumed where they
+ * stopped. While the socket takes no more, waits in 100 ms steps and asks
+ * pfnContinue whether to keep waiting; a send still pending when it gives up
+ * is cancelled.
+ *
+ * @return false on an error (see WSAGetLastError / errno) or when pfnContinue gave up.
+ */
+inline bool WriteGather(WriteQueueSocket hSocket, const CWriteSpan* pSpans, int nCount, const std::function<bool()>& pfnContinue)
+{
+#ifdef _WIN32
+	WSABUF pBuffers[CWriteQueue::WRITE_QUEUE_MAX_GATHER];
+	const WSAEVENT hEvent = WSACreateEvent();
+	if (hEvent == WSA_INVALID_EVENT)
+	{
+		return false;
+	}
+#else
+	iovec pBuffers[CWriteQueue::WRITE_QUEUE_MAX_GATHER];
+#endif
+	bool bResult = true;
+	while (bResult && (nCount > 0))
+	{
+		const int nBatch = (nCount < CWriteQueue::WRITE_QUEUE_MAX_GATHER) ? nCount : CWriteQueue::WRITE_QUEUE_MAX_GATHER;
+		for (int nIndex = 0; nIndex < nBatch; nIndex++)
+		{
+#ifdef _WIN32
+			pBuffers[nIndex].buf = const_cast<char*>(pSpans[nIndex].pData);
+			pBuffers[nIndex].len = static_cast<ULONG>(pSpans[nIndex].nLength);
+#else
+			pBuffers[nIndex].iov_base = const_cast<char*>(pSpans[nIndex].pData);
+			pBuffers[nIndex].iov_len = pSpans[nIndex].nLength;
+#endif
+		}
+		int nFirst = 0;
+		while (bResult && (nFirst < nBatch))
+		{
+			size_t nSent = 0;
+#ifdef _WIN32
+			WSAOVERLAPPED overlapped = {};
+			overlapped.hEvent = reinterpret_cast<WSAEVENT>(reinterpret_cast<ULONG_PTR>(hEvent) | 1);
+			WSAResetEvent(hEvent);
+			DWORD dwSent = 0, dwFlags = 0;
+			if (WSASend(hSocket, pBuffers + nFirst, nBatch - nFirst, &dwSent, 0, &overlapped, nullptr) == SOCKET_ERROR)
+			{
+				if (WSAGetLastError() != WSA_IO_PENDING)
+				{
+					bResult = false;
+					break;
+				}
+				while (WaitForSingleObject(hEvent, 100) == WAIT_TIMEOUT)
+				{
+					if (!pfnContinue())
+					{
+						CancelIoEx(reinterpret_cast<HANDLE>(hSocket), &overlapped);
+						bResult = false;
+						break;
+					}
+				}
+				// Also waits for a cancelled send, which must end before its buffers go
+				if (!WSAGetOverlappedResult(hSocket, &overlapped, &dwSent, TRUE, &dwFlags))
+				{
+					bResult = false;
+				}
+				if (!bResult)
+				{
+					break;
+				}
+			}
+			nSent = dwSent;
+			while ((nFirst < nBatch) && (nSent >= pBuffers[nFirst].len))
+			{
+				nSent -= pBuffers[nFirst++].len;
+			}
+			if (nFirst < nBatch)
+			{
+				pBuffers[nFirst].buf += nSent;
+				pBuffers[nFirst].len -= static_cast<ULONG>(nSent);
+			}
+#else
+			msghdr pMessage = {};
+			pMessage.msg_iov = pBuffers + nFirst;
+			pMessage.msg_iovlen = nBatch - nFirst;
+			ssize_t nResult = sendmsg(hSocket, &pMessage, MSG_DONTWAIT | MSG_NOSIGNAL);
+			if ((nResult < 0) && (errno == ENOTSOCK))
+			{
+				nResult = writev(hSocket, pBuffers + nFirst, nBatch - nFirst);
+			}
+			if (nResult < 0)
+			{
+				if ((errno == EAGAIN) || (errno == EWOULDBLOCK) || (errno == EINTR))
+				{
+					pollfd pWritable = { hSocket, POLLOUT, 0 };
+					if ((poll(&pWritable, 1, 100) == 0) && !pfnContinue())
+					{
+						bResult = false;
+					}
+					continue;
+				}
+				bResult = false;
+				break;
+			}
+			nSent = static_cast<size_t>(nResult);
+			while ((nFirst < nBatch) && (nSent >= pBuffers[nFirst].iov_len))
+			{
+				nSent -= pBuffers[nFirst++].iov_len;
+			}
+			if (nFirst < nBatch)
+			{
+				pBuffers[nFirst].iov_base = static_cast<char*>(pBuffers[nFirst].iov_base) + nSent;
+				pBuffers[nFirst].iov_len -= nSent;
+			}
+#endif
+		}
+		pSpans += nBatch;
+		nCount -= nBatch;
+	}
+#ifdef _WIN32
+	WSACloseEvent(hEvent);
+#endif
+	return bResult;
+}
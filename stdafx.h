@@ -82,6 +82,7 @@ IntelliPort. If not, see <http://www.opensource.org/licenses/gpl-3.0.html>*/
 #include <fstream>
 #include <algorithm>
 #include <cctype>
+#include <random>
 #include <msports.h>
 
 #define NO_CENUMERATESERIAL_USING_SETUPAPI1
@@ -0,0 +1,290 @@
+/* Copyright (C) 2014-2026 Stefan-Mihai MOGA
+This file is part of IntelliPort application developed by Stefan-Mihai MOGA.
+IntelliPort is an alternative Windows version to the famous HyperTerminal!
+
+IntelliPort is free software: you can redistribute it and/or modify it
+under the terms of the GNU General Public License as published by the Open
+Source Initiative, either version 3 of the License, or any later version.
+
+IntelliPort is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+IntelliPort. If not, see <http://www.opensource.org/licenses/gpl-3.0.html>*/
+
+// CaptureFileTest.cpp : capture records written and read back, index rebuild and seeking by time
+//
+
+#include "CaptureFile.h"
+#include "UnitTest.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Where a record was written, and when.
+ */
+struct CRecordInfo
+{
+	uint64_t nOffset;
+	uint64_t nTimestamp;
+};
+
+static char Pattern(uint64_t nRecord, size_t nByte)
+{
+	return static_cast<char>((nRecord * 31) ^ (nByte * 7) ^ (nByte >> 8));
+}
+
+/**
+ * @brief Returns the path of a new empty file in /tmp.
+ */
+static std::string MakeTempPath()
+{
+	char lpszPath[] = "/tmp/IntelliPortCaptureXXXXXX";
+	const int nFd = mkstemp(lpszPath);
+	if (nFd >= 0)
+	{
+		close(nFd);
+	}
+	return lpszPath;
+}
+
+static void RemoveCapture(const std::string& strPath)
+{
+	unlink(strPath.c_str());
+	unlink((strPath + CAPTURE_INDEX_SUFFIX).c_str());
+}
+
+/**
+ * @brief Size of record nRecord of the round trip capture: mostly small, now
+ * and then larger than CCaptureReader::CAPTURE_READ_SIZE.
+ */
+static size_t GetRecordLength(uint64_t nRecord)
+{
+	return ((nRecord % 1000) == 999) ? (CCaptureReader::CAPTURE_READ_SIZE + 12345) : static_cast<size_t>(1 + (nRecord * 2654435761u) % 3000);
+}
+
+/**
+ * @brief Reads every record from the start, checking it against what was appended.
+ * @return Offset and timestamp of every record read.
+ */
+static std::vector<CRecordInfo> ReadBack(CCaptureReader& pReader, uint64_t nRecords)
+{
+	std::vector<CRecordInfo> vecRecords;
+	std::vector<char> vecData;
+	CCaptureRecord record;
+	uint64_t nOffset = pReader.GetDataOffset(), nMismatches = 0;
+	for (uint64_t nRecord = 0; ; nRecord++)
+	{
+		const uint64_t nStart = nOffset;
+		if (!pReader.ReadRecord(nOffset, record, vecData))
+		{
+			break;
+		}
+		vecRecords.push_back(CRecordInfo{ nStart, record.nTimestamp });
+		if ((nRecord >= nRecords) || (record.nLength != GetRecordLength(nRecord)) || (vecData.size() != record.nLength) ||
+			(record.nDirection != nRecord % 2) || (record.nSource != nRecord % 5) ||
+			((nRecord > 0) && (record.nTimestamp < vecRecords[nRecord - 1].nTimestamp)))
+		{
+			nMismatches++;
+			continue;
+		}
+		for (size_t nByte = 0; nByte < vecData.size(); nByte++)
+		{
+			if (vecData[nByte] != Pattern(nRecord, nByte))
+			{
+				nMismatches++;
+				break;
+			}
+		}
+	}
+	TEST_CHECK(nMismatches == 0);
+	TEST_CHECK(nOffset == pReader.GetSize());
+	return vecRecords;
+}
+
+/**
+ * @brief Checks Seek() at, just after and between the timestamps of the records read.
+ */
+static void CheckSeek(CCaptureReader& pReader, const std::vector<CRecordInfo>& vecRecords)
+{
+	uint64_t nMismatches = 0;
+	const auto pfnExpected = [&](uint64_t nTimestamp)
+	{
+		const auto pRecord = std::lower_bound(vecRecords.begin(), vecRecords.end(), nTimestamp,
+			[](const CRecordInfo& info, uint64_t nValue) { return info.nTimestamp < nValue; });
+		return (pRecord == vecRecords.end()) ? pReader.GetSize() : pRecord->nOffset;
+	};
+	for (size_t nIndex = 0; nIndex < vecRecords.size(); nIndex += 7)
+	{
+		const uint64_t nTimestamp = vecRecords[nIndex].nTimestamp;
+		nMismatches += (pReader.Seek(nTimestamp) != pfnExpected(nTimestamp)) ? 1 : 0;
+		nMismatches += (pReader.Seek(nTimestamp + 1) != pfnExpected(nTimestamp + 1)) ? 1 : 0;
+	}
+	TEST_CHECK(nMismatches == 0);
+	TEST_CHECK(pReader.Seek(0) == pReader.GetDataOffset());
+	TEST_CHECK(pReader.Seek(vecRecords.back().nTimestamp + 1) == pReader.GetSize());
+}
+
+/**
+ * @brief Records of every size, from two directions and several sources, read
+ * back in order through CCaptureReader; then the index is lost or cut short and
+ * rebuilt, and the capture itself is cut in the middle of a record.
+ */
+static void TestRoundTripAndIndex()
+{
+	const uint64_t nRecords = 5000;
+	const std::string strPath = MakeTempPath();
+	CCaptureWriter pWriter;
+	TEST_CHECK(pWriter.Open(strPath.c_str()));
+	std::vector<char> vecPayload;
+	for (uint64_t nRecord = 0; nRecord < nRecords; nRecord++)
+	{
+		vecPayload.resize(GetRecordLength(nRecord));
+		for (size_t nByte = 0; nByte < vecPayload.size(); nByte++)
+		{
+			vecPayload[nByte] = Pattern(nRecord, nByte);
+		}
+		pWriter.Append(static_cast<CaptureDirection>(nRecord % 2), static_cast<uint16_t>(nRecord % 5), vecPayload.data(), vecPayload.size());
+	}
+	pWriter.Close();
+	const CCaptureStats stats = pWriter.GetStats();
+	TEST_CHECK(stats.nRecords == nRecords);
+	TEST_CHECK(stats.nRecordsDropped == 0);
+
+	CCaptureReader pReader;
+	TEST_CHECK(pReader.Open(strPath.c_str()));
+	TEST_CHECK(pReader.GetSize() == stats.nBytesWritten);
+	TEST_CHECK(pReader.GetWallClock() > 0);
+	const std::vector<CRecordInfo> vecRecords = ReadBack(pReader, nRecords);
+	TEST_CHECK(vecRecords.size() == nRecords);
+	TEST_CHECK(pReader.GetLastTimestamp() == vecRecords.back().nTimestamp);
+	const size_t nIndexSize = pReader.GetIndexSize();
+	TEST_CHECK((nIndexSize > 1) && (nIndexSize <= stats.nBytesWritten / CAPTURE_INDEX_INTERVAL + 1));
+	CheckSeek(pReader, vecRecords);
+	printf("%llu records, %.1f MB, %zu index entries\n", static_cast<unsigned long long>(nRecords), stats.nBytesWritten / 1048576.0, nIndexSize);
+
+	// The index cut after a few entries, in the middle of one, then only part of its header, then gone
+	const std::string strIndexPath = strPath + CAPTURE_INDEX_SUFFIX;
+	const off_t nIndexCuts[] = { static_cast<off_t>(sizeof(CCaptureIndexHeader) + 3 * sizeof(CCaptureIndexEntry) + 7), 5 };
+	for (const off_t nCut : nIndexCuts)
+	{
+		TEST_CHECK(truncate(strIndexPath.c_str(), nCut) == 0);
+		TEST_CHECK(pReader.Open(strPath.c_str()));
+		TEST_CHECK(pReader.GetIndexSize() == nIndexSize);
+		TEST_CHECK(pReader.GetSize() == stats.nBytesWritten);
+		CheckSeek(pReader, vecRecords);
+	}
+	TEST_CHECK(unlink(strIndexPath.c_str()) == 0);
+	TEST_CHECK(pReader.Open(strPath.c_str()));
+	TEST_CHECK(pReader.GetIndexSize() == nIndexSize);
+	CheckSeek(pReader, vecRecords);
+
+	// A record cut short by a crash is left out, the ones before it are kept
+	TEST_CHECK(truncate(strPath.c_str(), static_cast<off_t>(vecRecords.back().nOffset + sizeof(CCaptureRecord) + 1)) == 0);
+	TEST_CHECK(pReader.Open(strPath.c_str()));
+	TEST_CHECK(pReader.GetSize() == vecRecords.back().nOffset);
+	TEST_CHECK(ReadBack(pReader, nRecords).size() == nRecords - 1);
+	TEST_CHECK(pReader.Seek(vecRecords.back().nTimestamp) == pReader.GetSize());
+
+	// Not a capture file at all
+	TEST_CHECK(truncate(strPath.c_str(), 16) == 0);
+	TEST_CHECK(!pReader.Open(strPath.c_str()));
+	pReader.Close();
+	RemoveCapture(strPath);
+}
+
+/**
+ * @brief A 256 MB synthetic capture, one 128 byte record per microsecond of
+ * capture time, indexed the way CCaptureWriter does: every Seek() must land on
+ * the first record at or after the instant, in well under a millisecond.
+ */
+static void TestSeekLatency()
+{
+	const uint64_t nRecords = 2 << 20;
+	const uint64_t nRecordSize = 128;
+	const uint64_t nInterval = 1000; // nanoseconds between records
+	const std::string strPath = MakeTempPath();
+	{
+		CCaptureStream pFile, pIndexFile;
+		TEST_CHECK(pFile.Create(strPath.c_str()) && pIndexFile.Create((strPath + CAPTURE_INDEX_SUFFIX).c_str()));
+		CCaptureFileHeader header = {};
+		memcpy(header.pMagic, CAPTURE_FILE_MAGIC, sizeof(header.pMagic));
+		header.nVersion = CAPTURE_VERSION;
+		header.nHeaderSize = sizeof(header);
+		CCaptureIndexHeader indexHeader = {};
+		memcpy(indexHeader.pMagic, CAPTURE_INDEX_MAGIC, sizeof(indexHeader.pMagic));
+		indexHeader.nVersion = CAPTURE_VERSION;
+		TEST_CHECK(pFile.Write(&header, sizeof(header)) && pIndexFile.Write(&indexHeader, sizeof(indexHeader)));
+
+		std::vector<char> vecBatch;
+		std::vector<CCaptureIndexEntry> vecIndex;
+		uint64_t nNextIndex = sizeof(header);
+		for (uint64_t nRecord = 0; nRecord < nRecords; nRecord++)
+		{
+			const uint64_t nOffset = sizeof(header) + nRecord * nRecordSize;
+			CCaptureRecord record = {};
+			record.nTimestamp = nRecord * nInterval;
+			record.nLength = static_cast<uint32_t>(nRecordSize - sizeof(record));
+			if (nOffset >= nNextIndex)
+			{
+				vecIndex.push_back(CCaptureIndexEntry{ record.nTimestamp, nOffset });
+				nNextIndex = nOffset + CAPTURE_INDEX_INTERVAL;
+			}
+			const size_t nPosition = vecBatch.size();
+			vecBatch.resize(nPosition + nRecordSize, static_cast<char>(nRecord));
+			memcpy(vecBatch.data() + nPosition, &record, sizeof(record));
+			if ((vecBatch.size() >= 0x100000) || (nRecord + 1 == nRecords))
+			{
+				TEST_CHECK(pFile.Write(vecBatch.data(), vecBatch.size()));
+				vecBatch.clear();
+			}
+		}
+		TEST_CHECK(pIndexFile.Write(vecIndex.data(), vecIndex.size() * sizeof(CCaptureIndexEntry)));
+	}
+
+	CCaptureReader pReader;
+	CTestStopwatch pOpen;
+	TEST_CHECK(pReader.Open(strPath.c_str()));
+	const double fOpen = pOpen.GetSeconds();
+	TEST_CHECK(pReader.GetSize() == sizeof(CCaptureFileHeader) + nRecords * nRecordSize);
+	TEST_CHECK(pReader.GetLastTimestamp() == (nRecords - 1) * nInterval);
+
+	// Random instants, most of them between two records
+	const int nSeeks = 20000;
+	CTestRandom pRandom(19);
+	uint64_t nMismatches = 0;
+	CTestStopwatch pStopwatch;
+	for (int nSeek = 0; nSeek < nSeeks; nSeek++)
+	{
+		const uint64_t nTimestamp = pRandom.Range(0, nRecords * nInterval);
+		const uint64_t nRecord = (nTimestamp + nInterval - 1) / nInterval;
+		const uint64_t nExpected = (nRecord < nRecords) ? sizeof(CCaptureFileHeader) + nRecord * nRecordSize : pReader.GetSize();
+		nMismatches += (pReader.Seek(nTimestamp) != nExpected) ? 1 : 0;
+	}
+	const double fSeek = pStopwatch.GetSeconds() / nSeeks;
+
+	// Without the index, Open() rebuilds it by scanning the whole capture once
+	unlink((strPath + CAPTURE_INDEX_SUFFIX).c_str());
+	CTestStopwatch pRebuild;
+	TEST_CHECK(pReader.Open(strPath.c_str()));
+	const double fRebuild = pRebuild.GetSeconds();
+	nMismatches += (pReader.Seek(nInterval * nRecords / 2) != sizeof(CCaptureFileHeader) + nRecords / 2 * nRecordSize) ? 1 : 0;
+	printf("%llu MB capture: open %.2f ms, seek %.1f us, index rebuild %.0f ms\n", static_cast<unsigned long long>((nRecords * nRecordSize) >> 20),
+		fOpen * 1e3, fSeek * 1e6, fRebuild * 1e3);
+	TEST_CHECK(nMismatches == 0);
+	TEST_CHECK(fSeek < 1e-3);
+	pReader.Close();
+	RemoveCapture(strPath);
+}
+
+int main()
+{
+	setvbuf(stdout, nullptr, _IONBF, 0);
+	TestRoundTripAndIndex();
+	TestSeekLatency();
+	return TEST_RESULT();
+}
@@ -0,0 +1,306 @@
+/* Copyright (C) 2014-2026 Stefan-Mihai MOGA
+This file is part of IntelliPort application developed by Stefan-Mihai MOGA.
+IntelliPort is an alternative Windows version to the famous HyperTerminal!
+
+IntelliPort is free software: you can redistribute it and/or modify it
+under the terms of the GNU General Public License as published by the Open
+Source Initiative, either version 3 of the License, or any later version.
+
+IntelliPort is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+IntelliPort. If not, see <http://www.opensource.org/licenses/gpl-3.0.html>*/
+
+// CaptureReplayTest.cpp : capture replay through a loopback TCP connection, at full and scaled speed
+//
+
+#include "CaptureReplay.h"
+#include "UnitTest.h"
+
+#include <arpa/inet.h>
+#include <cstdlib>
+#include <netinet/in.h>
+#include <string>
+#include <sys/socket.h>
+#include <vector>
+
+/**
+ * @brief One record of a synthetic capture.
+ */
+struct CTestRecord
+{
+	uint64_t nTimestamp;
+	CaptureDirection nDirection;
+	std::string strData;
+};
+
+/**
+ * @brief Writes a capture file with the given records and no index; returns its path.
+ */
+static std::string WriteCapture(const std::vector<CTestRecord>& vecRecords)
+{
+	char lpszPath[] = "/tmp/IntelliPortReplayXXXXXX";
+	const int nFd = mkstemp(lpszPath);
+	if (nFd >= 0)
+	{
+		close(nFd);
+	}
+	CCaptureStream pFile;
+	TEST_CHECK(pFile.Create(lpszPath));
+	CCaptureFileHeader header = {};
+	memcpy(header.pMagic, CAPTURE_FILE_MAGIC, sizeof(header.pMagic));
+	header.nVersion = CAPTURE_VERSION;
+	header.nHeaderSize = sizeof(header);
+	TEST_CHECK(pFile.Write(&header, sizeof(header)));
+	for (const CTestRecord& pRecord : vecRecords)
+	{
+		CCaptureRecord record = {};
+		record.nTimestamp = pRecord.nTimestamp;
+		record.nLength = static_cast<uint32_t>(pRecord.strData.size());
+		record.nDirection = pRecord.nDirection;
+		TEST_CHECK(pFile.Write(&record, sizeof(record)) && pFile.Write(pRecord.strData.data(), pRecord.strData.size()));
+	}
+	return lpszPath;
+}
+
+/**
+ * @brief 60 records 2 ms apart, alternately received and sent, of varying length.
+ */
+static std::vector<CTestRecord> MakeRecords()
+{
+	std::vector<CTestRecord> vecRecords;
+	for (uint64_t nRecord = 0; nRecord < 60; nRecord++)
+	{
+		char lpszData[32] = { 0, };
+		snprintf(lpszData, sizeof(lpszData), "record %02u|", static_cast<unsigned>(nRecord));
+		const std::string strData = std::string(lpszData) + std::string(static_cast<size_t>(nRecord % 17), static_cast<char>('a' + nRecord % 26));
+		vecRecords.push_back(CTestRecord{ 1000000 + nRecord * 2000000, static_cast<CaptureDirection>(nRecord % 2), strData });
+	}
+	return vecRecords;
+}
+
+/**
+ * @brief A connected pair of loopback TCP sockets: the replay writes to the first.
+ */
+static bool ConnectLoopback(int pSockets[2])
+{
+	const int hListener = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+	sockaddr_in address = {};
+	address.sin_family = AF_INET;
+	address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+	socklen_t nLength = sizeof(address);
+	bool bConnected = (bind(hListener, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0) && (listen(hListener, 1) == 0) &&
+		(getsockname(hListener, reinterpret_cast<sockaddr*>(&address), &nLength) == 0);
+	pSockets[0] = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+	bConnected = bConnected && (connect(pSockets[0], reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0);
+	pSockets[1] = bConnected ? accept(hListener, nullptr, nullptr) : -1;
+	close(hListener);
+	timeval timeout = { 5, 0 };
+	setsockopt(pSockets[1], SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+	return pSockets[1] >= 0;
+}
+
+/**
+ * @brief Sends a record's bytes over the socket, as the application's send functions do.
+ */
+static bool SendAll(int hSocket, const char* pData, size_t nLength)
+{
+	while (nLength > 0)
+	{
+		const ssize_t nSent = send(hSocket, pData, nLength, MSG_NOSIGNAL);
+		if (nSent <= 0)
+		{
+			return false;
+		}
+		pData += nSent;
+		nLength -= nSent;
+	}
+	return true;
+}
+
+/**
+ * @brief Reads exactly nLength bytes from the other end, or what arrives within the timeout.
+ */
+static std::string ReceiveAll(int hSocket, size_t nLength)
+{
+	std::string strReceived;
+	char pBuffer[0x1000];
+	while (strReceived.size() < nLength)
+	{
+		const ssize_t nRead = recv(hSocket, pBuffer, std::min(sizeof(pBuffer), nLength - strReceived.size()), 0);
+		if (nRead <= 0)
+		{
+			break;
+		}
+		strReceived.append(pBuffer, static_cast<size_t>(nRead));
+	}
+	return strReceived;
+}
+
+/**
+ * @brief Waits for the replay's finished callback, for up to five seconds.
+ */
+static bool WaitFinished(const std::atomic<int>& nFinished)
+{
+	for (int nWait = 0; (nWait < 5000) && (nFinished == 0); nWait++)
+	{
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+	return nFinished == 1;
+}
+
+/**
+ * @brief REPLAY_MAX_SPEED, every direction, then from an instant in the middle.
+ */
+static void TestMaxSpeed()
+{
+	const std::vector<CTestRecord> vecRecords = MakeRecords();
+	const std::string strPath = WriteCapture(vecRecords);
+	int pSockets[2];
+	TEST_CHECK(ConnectLoopback(pSockets));
+	std::string strExpected;
+	for (const CTestRecord& pRecord : vecRecords)
+	{
+		strExpected += pRecord.strData;
+	}
+
+	CCaptureReplay pReplay;
+	std::atomic<int> nFinished(0);
+	TEST_CHECK(pReplay.Start(strPath.c_str(), CCaptureReplay::REPLAY_MAX_SPEED, 1.0, CCaptureReplay::REPLAY_DIRECTION_ALL, 0,
+		[&](const char* pData, size_t nLength) { return SendAll(pSockets[0], pData, nLength); }, [&]() { nFinished++; }));
+	TEST_CHECK(WaitFinished(nFinished));
+	TEST_CHECK(!pReplay.IsRunning());
+	TEST_CHECK(ReceiveAll(pSockets[1], strExpected.size()) == strExpected);
+	CCaptureReplayStats stats = pReplay.GetStats();
+	TEST_CHECK(stats.nRecords == vecRecords.size());
+	TEST_CHECK(stats.nBytes == strExpected.size());
+	TEST_CHECK(stats.nCaptureDuration == vecRecords.back().nTimestamp - vecRecords.front().nTimestamp);
+	TEST_CHECK(stats.nElapsed < stats.nCaptureDuration / 4);
+	TEST_CHECK(stats.pTimingError.GetCount() == 0);
+	TEST_CHECK(!stats.bFailed);
+
+	// From the first record at or after an instant between records 40 and 41
+	nFinished = 0;
+	TEST_CHECK(pReplay.Start(strPath.c_str(), CCaptureReplay::REPLAY_MAX_SPEED, 1.0, CCaptureReplay::REPLAY_DIRECTION_ALL,
+		vecRecords[40].nTimestamp + 1, [&](const char* pData, size_t nLength) { return SendAll(pSockets[0], pData, nLength); },
+		[&]() { nFinished++; }));
+	TEST_CHECK(WaitFinished(nFinished));
+	strExpected.clear();
+	for (size_t nRecord = 41; nRecord < vecRecords.size(); nRecord++)
+	{
+		strExpected += vecRecords[nRecord].strData;
+	}
+	TEST_CHECK(ReceiveAll(pSockets[1], strExpected.size()) == strExpected);
+	stats = pReplay.GetStats();
+	TEST_CHECK(stats.nRecords == vecRecords.size() - 41);
+	TEST_CHECK(stats.nCaptureDuration == vecRecords.back().nTimestamp - vecRecords[41].nTimestamp);
+
+	pReplay.Stop();
+	close(pSockets[0]);
+	close(pSockets[1]);
+	unlink(strPath.c_str());
+}
+
+/**
+ * @brief REPLAY_SCALED at four times the original speed, received records only:
+ * the replay takes a quarter of the capture time, and every send is on time.
+ */
+static void TestScaled()
+{
+	const std::vector<CTestRecord> vecRecords = MakeRecords();
+	const std::string strPath = WriteCapture(vecRecords);
+	int pSockets[2];
+	TEST_CHECK(ConnectLoopback(pSockets));
+	std::string strExpected;
+	size_t nExpected = 0;
+	for (const CTestRecord& pRecord : vecRecords)
+	{
+		if (pRecord.nDirection == CAPTURE_RECEIVED)
+		{
+			strExpected += pRecord.strData;
+			nExpected++;
+		}
+	}
+
+	CCaptureReplay pReplay;
+	std::atomic<int> nFinished(0);
+	const double dSpeed = 4.0;
+	TEST_CHECK(pReplay.Start(strPath.c_str(), CCaptureReplay::REPLAY_SCALED, dSpeed, CAPTURE_RECEIVED, 0,
+		[&](const char* pData, size_t nLength) { return SendAll(pSockets[0], pData, nLength); }, [&]() { nFinished++; }));
+	TEST_CHECK(WaitFinished(nFinished));
+	TEST_CHECK(ReceiveAll(pSockets[1], strExpected.size()) == strExpected);
+	const CCaptureReplayStats stats = pReplay.GetStats();
+	const uint64_t nScaled = static_cast<uint64_t>(stats.nCaptureDuration / dSpeed);
+	printf("scaled x%.0f: %llu records, %.2f ms for %.2f ms of capture, timing error p50 %llu us, p99 %llu us, max %llu us\n", dSpeed,
+		static_cast<unsigned long long>(stats.nRecords), stats.nElapsed / 1e6, stats.nCaptureDuration / 1e6,
+		static_cast<unsigned long long>(stats.pTimingError.GetPercentile(50)), static_cast<unsigned long long>(stats.pTimingError.GetPercentile(99)),
+		static_cast<unsigned long long>(stats.pTimingError.GetMaximum()));
+	TEST_CHECK(stats.nRecords == nExpected);
+	TEST_CHECK(stats.nBytes == strExpected.size());
+	TEST_CHECK(stats.nCaptureDuration == vecRecords[vecRecords.size() - 2].nTimestamp - vecRecords.front().nTimestamp);
+	// Never early; late by no more than a loaded machine's scheduling delay
+	TEST_CHECK(stats.nElapsed >= nScaled);
+	TEST_CHECK(stats.nElapsed < nScaled + 20000000);
+	TEST_CHECK(stats.pTimingError.GetCount() == nExpected);
+	TEST_CHECK(stats.pTimingError.GetPercentile(50) < 1000);
+	TEST_CHECK(!stats.bFailed);
+
+	pReplay.Stop();
+	close(pSockets[0]);
+	close(pSockets[1]);
+	unlink(strPath.c_str());
+}
+
+/**
+ * @brief Stop() during a minute-long wait returns at once, and a refused write ends the replay.
+ */
+static void TestStopAndFailure()
+{
+	std::vector<CTestRecord> vecRecords;
+	vecRecords.push_back(CTestRecord{ 0, CAPTURE_RECEIVED, "first" });
+	vecRecords.push_back(CTestRecord{ 60000000000ull, CAPTURE_RECEIVED, "a minute later" });
+	const std::string strPath = WriteCapture(vecRecords);
+
+	CCaptureReplay pReplay;
+	std::atomic<int> nFinished(0), nSent(0);
+	TEST_CHECK(pReplay.Start(strPath.c_str(), CCaptureReplay::REPLAY_ORIGINAL, 1.0, CAPTURE_RECEIVED, 0,
+		[&](const char*, size_t) { nSent++; return true; }, [&]() { nFinished++; }));
+	for (int nWait = 0; (nWait < 5000) && (nSent == 0); nWait++)
+	{
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+	std::this_thread::sleep_for(std::chrono::milliseconds(50));
+	TEST_CHECK(pReplay.IsRunning());
+	CTestStopwatch pStopwatch;
+	pReplay.Stop();
+	const double fStop = pStopwatch.GetSeconds();
+	printf("Stop() during a 60 s wait returned in %.2f ms\n", fStop * 1e3);
+	TEST_CHECK(fStop < 0.1);
+	TEST_CHECK(!pReplay.IsRunning());
+	TEST_CHECK(pReplay.IsStopping());
+	TEST_CHECK(nFinished == 1);
+	TEST_CHECK(nSent == 1);
+	TEST_CHECK(pReplay.GetStats().nRecords == 1);
+
+	// The transport refuses the first write
+	nFinished = 0;
+	TEST_CHECK(pReplay.Start(strPath.c_str(), CCaptureReplay::REPLAY_MAX_SPEED, 1.0, CAPTURE_RECEIVED, 0,
+		[](const char*, size_t) { return false; }, [&]() { nFinished++; }));
+	TEST_CHECK(WaitFinished(nFinished));
+	const CCaptureReplayStats stats = pReplay.GetStats();
+	TEST_CHECK(stats.bFailed);
+	TEST_CHECK(stats.nRecords == 0);
+	pReplay.Stop();
+	unlink(strPath.c_str());
+}
+
+int main()
+{
+	setvbuf(stdout, nullptr, _IONBF, 0);
+	TestMaxSpeed();
+	TestScaled();
+	TestStopAndFailure();
+	return TEST_RESULT();
+}
@@ -0,0 +1,317 @@
+/* Copyright (C) 2014-2026 Stefan-Mihai MOGA
+This file is part of IntelliPort application developed by Stefan-Mihai MOGA.
+IntelliPort is an alternative Windows version to the famous HyperTerminal!
+
+IntelliPort is free software: you can redistribute it and/or modify it
+under the terms of the GNU General Public License as published by the Open
+Source Initiative, either version 3 of the License, or any later version.
+
+IntelliPort is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+IntelliPort. If not, see <http://www.opensource.org/licenses/gpl-3.0.html>*/
+
+// DatagramQueueTest.cpp : wrap-around records, drops when full and a producer/consumer run of the datagram queue
+//
+
+#include "DatagramQueue.h"
+#include "UnitTest.h"
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief A CDatagramQueue whose slab and positions can be inspected.
+ */
+class CTestQueue : public CDatagramQueue
+{
+public:
+	using CDatagramQueue::GetRecordSize;
+
+	/** @brief Producer position, bytes since Reset(). Producer side. */
+	uint64_t GetWritePosition() const
+	{
+		return m_nWrite.load(std::memory_order_relaxed);
+	}
+
+	/** @brief Bytes of the slab in use. Producer side. */
+	uint64_t GetUsed() const
+	{
+		return m_nWrite.load(std::memory_order_relaxed) - m_nRead.load(std::memory_order_acquire);
+	}
+
+	/** @brief Reads the record header at a slab offset. */
+	void GetHeader(size_t nOffset, uint32_t& nFlags, uint32_t& nSize) const
+	{
+		CDatagramHeader pHeader;
+		memcpy(&pHeader, m_vecSlab.data() + nOffset, sizeof(pHeader));
+		nFlags = pHeader.nFlags;
+		nSize = pHeader.nSize;
+	}
+
+	const char* GetSlab() const
+	{
+		return m_vecSlab.data();
+	}
+
+	static constexpr size_t HEADER_SIZE = sizeof(CDatagramHeader);
+};
+
+/**
+ * @brief The payload byte nIndex of the datagram numbered nSequence.
+ */
+static char GetPayloadByte(uint64_t nSequence, size_t nIndex)
+{
+	return static_cast<char>((nSequence * 131 + nIndex * 7) ^ (nIndex >> 8));
+}
+
+/**
+ * @brief A datagram numbered nSequence: its payload, its sender and its arrival time follow from the number.
+ */
+static CReceivedDatagram MakeDatagram(uint64_t nSequence, std::vector<char>& vecPayload, uint32_t nLength)
+{
+	vecPayload.resize(nLength);
+	for (uint32_t nIndex = 0; nIndex < nLength; nIndex++)
+	{
+		vecPayload[nIndex] = GetPayloadByte(nSequence, nIndex);
+	}
+	CReceivedDatagram pDatagram = {};
+	pDatagram.pData = vecPayload.data();
+	pDatagram.nLength = nLength;
+	pDatagram.nEndpoint = static_cast<uint32_t>(nSequence % CEndpointTable::ENDPOINT_TABLE_SIZE) + 1;
+	pDatagram.nTimestamp = nSequence;
+	pDatagram.bTruncated = (nSequence % 13 == 0);
+	return pDatagram;
+}
+
+/**
+ * @brief Returns true if a queued entry is the datagram numbered nSequence, whole.
+ */
+static bool IsDatagram(const CDatagramEntry& pEntry, uint64_t nSequence, uint32_t nLength)
+{
+	if ((pEntry.nTimestamp != nSequence) || (pEntry.nLength != nLength) ||
+		(pEntry.nEndpoint != static_cast<uint32_t>(nSequence % CEndpointTable::ENDPOINT_TABLE_SIZE) + 1) ||
+		(pEntry.bTruncated != (nSequence % 13 == 0)))
+	{
+		return false;
+	}
+	for (uint32_t nIndex = 0; nIndex < nLength; nIndex++)
+	{
+		if (pEntry.pData[nIndex] != GetPayloadByte(nSequence, nIndex))
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+/**
+ * @brief A record that does not fit before the end of the slab: a padding
+ * record when the tail holds a header, nothing when it does not, and a
+ * datagram refused whole when the slab is full.
+ */
+static void TestWrapAndDrop()
+{
+	const uint32_t nLargest = static_cast<uint32_t>(CDatagramReceiver::DATAGRAM_SLOT_SIZE);
+	const size_t nLargestRecord = CTestQueue::GetRecordSize(nLargest);
+	const size_t nCapacity = 2 * nLargestRecord;
+	CTestQueue pQueue;
+	std::vector<char> vecPayload;
+	CDatagramEntry pEntries[8];
+
+	// Not created, or too small for the largest datagram: everything is dropped
+	TEST_CHECK(!pQueue.Push(MakeDatagram(0, vecPayload, 10)));
+	TEST_CHECK(pQueue.GetStats().nDropped == 1);
+	TEST_CHECK(!pQueue.Create(nCapacity - 8));
+	TEST_CHECK(pQueue.Create(nCapacity + 7)); // rounded down to 8
+	TEST_CHECK(pQueue.GetStats().nDropped == 0);
+	TEST_CHECK(pQueue.IsEmpty());
+	TEST_CHECK(pQueue.Peek(pEntries, 8) == 0);
+
+	// Two records leaving a 40-byte tail, then one of 128 bytes: padded
+	uint64_t nSequence = 1;
+	TEST_CHECK(pQueue.Push(MakeDatagram(nSequence++, vecPayload, nLargest)));
+	const uint32_t nSecond = static_cast<uint32_t>(nCapacity - 40 - nLargestRecord - CTestQueue::HEADER_SIZE);
+	TEST_CHECK(pQueue.Push(MakeDatagram(nSequence++, vecPayload, nSecond)));
+	TEST_CHECK(pQueue.GetWritePosition() == nCapacity - 40);
+	TEST_CHECK(pQueue.Peek(pEntries, 8) == 2);
+	TEST_CHECK(IsDatagram(pEntries[0], 1, nLargest) && IsDatagram(pEntries[1], 2, nSecond));
+	TEST_CHECK(pQueue.Peek(pEntries, 8) == 2); // not consumed yet: the same two
+	pQueue.Consume();
+	TEST_CHECK(pQueue.IsEmpty());
+	TEST_CHECK(pQueue.Push(MakeDatagram(nSequence++, vecPayload, 100)));
+	uint32_t nFlags = 0, nSize = 0;
+	pQueue.GetHeader(nCapacity - 40, nFlags, nSize);
+	TEST_CHECK((nFlags == CDatagramQueue::DATAGRAM_PADDING) && (nSize == 40));
+	pQueue.GetHeader(0, nFlags, nSize);
+	TEST_CHECK((nFlags == 0) && (nSize == CTestQueue::GetRecordSize(100)));
+	TEST_CHECK(pQueue.GetWritePosition() == nCapacity + CTestQueue::GetRecordSize(100));
+	TEST_CHECK(pQueue.Peek(pEntries, 8) == 1);
+	TEST_CHECK(IsDatagram(pEntries[0], 3, 100));
+	pQueue.Consume();
+
+	// Two records leaving a 16-byte tail, shorter than a header: skipped without a padding record
+	TEST_CHECK(pQueue.Push(MakeDatagram(nSequence++, vecPayload, nLargest)));
+	const uint32_t nFourth = static_cast<uint32_t>(nCapacity - 16 - CTestQueue::GetRecordSize(100) - nLargestRecord - CTestQueue::HEADER_SIZE);
+	TEST_CHECK(pQueue.Push(MakeDatagram(nSequence++, vecPayload, nFourth)));
+	TEST_CHECK(pQueue.GetWritePosition() % nCapacity == nCapacity - 16);
+	TEST_CHECK(pQueue.Peek(pEntries, 8) == 2);
+	TEST_CHECK(IsDatagram(pEntries[0], 4, nLargest) && IsDatagram(pEntries[1], 5, nFourth));
+	pQueue.Consume();
+	const std::string strTail(pQueue.GetSlab() + nCapacity - 16, 16);
+	TEST_CHECK(pQueue.Push(MakeDatagram(nSequence++, vecPayload, 8)));
+	TEST_CHECK(std::string(pQueue.GetSlab() + nCapacity - 16, 16) == strTail);
+	TEST_CHECK(pQueue.GetUsed() == 16 + CTestQueue::GetRecordSize(8));
+	TEST_CHECK(pQueue.Peek(pEntries, 8) == 1);
+	TEST_CHECK(IsDatagram(pEntries[0], 6, 8));
+
+	// Full: a datagram that finds no room is dropped whole, a smaller one still fits
+	TEST_CHECK(pQueue.Push(MakeDatagram(nSequence++, vecPayload, nLargest)));
+	const uint64_t nWrite = pQueue.GetWritePosition();
+	TEST_CHECK(!pQueue.Push(MakeDatagram(nSequence++, vecPayload, nLargest)));
+	TEST_CHECK(pQueue.GetWritePosition() == nWrite);
+	TEST_CHECK(pQueue.Push(MakeDatagram(nSequence++, vecPayload, 100)));
+	CDatagramQueueStats stats = pQueue.GetStats();
+	TEST_CHECK(stats.nDropped == 1);
+	TEST_CHECK(stats.nDroppedBytes == nLargest);
+	TEST_CHECK(stats.nDatagrams == 8);
+	TEST_CHECK(stats.nBytes == 3ull * nLargest + nSecond + nFourth + 100 + 8 + 100);
+	TEST_CHECK(stats.nTruncated == 0);
+	TEST_CHECK(stats.nHighWaterMark == nCapacity - 40); // the first two records, the fullest the slab was
+
+	// Emptied, the room comes back
+	TEST_CHECK(pQueue.Peek(pEntries, 8) == 3);
+	TEST_CHECK(IsDatagram(pEntries[0], 6, 8) && IsDatagram(pEntries[1], 7, nLargest) && IsDatagram(pEntries[2], 9, 100));
+	pQueue.Consume();
+	TEST_CHECK(pQueue.IsEmpty());
+	TEST_CHECK(pQueue.Push(MakeDatagram(nSequence++, vecPayload, nLargest)));
+
+	pQueue.Reset();
+	TEST_CHECK(pQueue.IsEmpty());
+	stats = pQueue.GetStats();
+	TEST_CHECK((stats.nDatagrams == 0) && (stats.nDropped == 0) && (stats.nHighWaterMark == 0));
+	pQueue.Destroy();
+	TEST_CHECK(!pQueue.Push(MakeDatagram(nSequence++, vecPayload, 10)));
+}
+
+/**
+ * @brief A producer thread pushes datagrams of random sizes through the
+ * smallest slab, wrapping thousands of times, while the consumer checks
+ * every one: nothing is lost but what was dropped, nothing is reordered.
+ */
+static void TestProducerConsumer()
+{
+	const uint64_t nCount = 300000;
+	const uint32_t nLargest = static_cast<uint32_t>(CDatagramReceiver::DATAGRAM_SLOT_SIZE);
+	CTestQueue pQueue;
+	const size_t nCapacity = 2 * CTestQueue::GetRecordSize(nLargest);
+	TEST_CHECK(pQueue.Create(nCapacity));
+
+	// Mostly short datagrams so that records end close to the end of the slab often
+	std::vector<uint32_t> vecLengths(nCount);
+	CTestRandom pRandom(25);
+	for (uint64_t nSequence = 0; nSequence < nCount; nSequence++)
+	{
+		const uint64_t nKind = pRandom.Range(0, 999);
+		vecLengths[nSequence] = static_cast<uint32_t>((nKind < 600) ? pRandom.Range(0, 64) :
+			((nKind < 995) ? pRandom.Range(65, 3000) : pRandom.Range(3001, nLargest)));
+	}
+
+	std::vector<uint64_t> vecAccepted;
+	uint64_t nPaddings = 0, nShortTails = 0, nAcceptedBytes = 0, nDroppedBytes = 0, nTruncated = 0;
+	std::atomic<bool> bDone(false);
+	std::thread pProducer([&]()
+	{
+		std::vector<char> vecPayload;
+		for (uint64_t nSequence = 0; nSequence < nCount; nSequence++)
+		{
+			if (nSequence % CDatagramReceiver::DATAGRAM_RECEIVE_BATCH == 0)
+			{
+				std::this_thread::yield(); // the socket thread waits for the next batch
+			}
+			const uint64_t nBefore = pQueue.GetWritePosition();
+			if (!pQueue.Push(MakeDatagram(nSequence, vecPayload, vecLengths[nSequence])))
+			{
+				nDroppedBytes += vecLengths[nSequence];
+				continue;
+			}
+			vecAccepted.push_back(nSequence);
+			nAcceptedBytes += vecLengths[nSequence];
+			nTruncated += (nSequence % 13 == 0) ? 1 : 0;
+			const uint64_t nSkipped = pQueue.GetWritePosition() - nBefore - CTestQueue::GetRecordSize(vecLengths[nSequence]);
+			if (nSkipped >= CTestQueue::HEADER_SIZE)
+			{
+				nPaddings++;
+			}
+			else if (nSkipped > 0)
+			{
+				nShortTails++;
+			}
+		}
+		bDone.store(true, std::memory_order_release);
+	});
+
+	std::vector<uint64_t> vecReceived;
+	vecReceived.reserve(nCount);
+	uint64_t nMismatches = 0, nRounds = 0;
+	CDatagramEntry pEntries[64];
+	for (;;)
+	{
+		const bool bFinished = bDone.load(std::memory_order_acquire);
+		const int nEntries = pQueue.Peek(pEntries, 64);
+		for (int nIndex = 0; nIndex < nEntries; nIndex++)
+		{
+			const uint64_t nSequence = pEntries[nIndex].nTimestamp;
+			if ((nSequence >= nCount) || !IsDatagram(pEntries[nIndex], nSequence, vecLengths[nSequence]) ||
+				(!vecReceived.empty() && (nSequence <= vecReceived.back())))
+			{
+				nMismatches++;
+			}
+			vecReceived.push_back(nSequence);
+		}
+		pQueue.Consume();
+		if (bFinished && pQueue.IsEmpty())
+		{
+			break;
+		}
+		if (++nRounds % 1024 == 0)
+		{
+			std::this_thread::sleep_for(std::chrono::milliseconds(2)); // a busy display: the producer has to drop some
+		}
+		else if ((nEntries == 0) || (nRounds % 16 == 0))
+		{
+			std::this_thread::yield();
+		}
+	}
+	pProducer.join();
+
+	TEST_CHECK(nMismatches == 0);
+	TEST_CHECK(vecReceived == vecAccepted);
+	const CDatagramQueueStats stats = pQueue.GetStats();
+	TEST_CHECK(stats.nDatagrams == vecAccepted.size());
+	TEST_CHECK(stats.nDatagrams + stats.nDropped == nCount);
+	TEST_CHECK(stats.nBytes == nAcceptedBytes);
+	TEST_CHECK(stats.nDroppedBytes == nDroppedBytes);
+	TEST_CHECK(stats.nTruncated == nTruncated);
+	TEST_CHECK((stats.nHighWaterMark > 0) && (stats.nHighWaterMark <= nCapacity));
+	// Every path of a wrap was taken, and the queue did fill up
+	TEST_CHECK(nPaddings > 0);
+	TEST_CHECK(nShortTails > 0);
+	TEST_CHECK(stats.nDropped > 0);
+	printf("%zu of %llu datagrams queued, %llu dropped, %llu padding records, %llu short tails, high-water mark %llu of %zu bytes\n",
+		vecAccepted.size(), static_cast<unsigned long long>(nCount), static_cast<unsigned long long>(stats.nDropped),
+		static_cast<unsigned long long>(nPaddings), static_cast<unsigned long long>(nShortTails),
+		static_cast<unsigned long long>(stats.nHighWaterMark), nCapacity);
+}
+
+int main()
+{
+	setvbuf(stdout, nullptr, _IONBF, 0);
+	TestWrapAndDrop();
+	TestProducerConsumer();
+	return TEST_RESULT();
+}
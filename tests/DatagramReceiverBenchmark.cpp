@@ -0,0 +1,143 @@
+/* Copyright (C) 2014-2026 Stefan-Mihai MOGA
+This file is part of IntelliPort application developed by Stefan-Mihai MOGA.
+IntelliPort is an alternative Windows version to the famous HyperTerminal!
+
+IntelliPort is free software: you can redistribute it and/or modify it
+under the terms of the GNU General Public License as published by the Open
+Source Initiative, either version 3 of the License, or any later version.
+
+IntelliPort is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+IntelliPort. If not, see <http://www.opensource.org/licenses/gpl-3.0.html>*/
+
+// DatagramReceiverBenchmark.cpp : loopback datagrams/s received one recvfrom at a time and in CDatagramReceiver batches
+//
+
+#include "DatagramReceiver.h"
+#include "UdpEndpoint.h"
+#include "UnitTest.h"
+
+#include <arpa/inet.h>
+#include <functional>
+#include <unistd.h>
+#include <vector>
+
+/**
+ * @brief Queues nCount datagrams of nSize bytes on the receiver; returns how
+ * many the kernel accepted to send.
+ */
+static int Fill(int hSender, const sockaddr_in& address, const std::vector<CUdpDatagram>& vecDatagrams, int nCount)
+{
+	int nSent = 0;
+	while (nSent < nCount)
+	{
+		const int nBatch = UdpSendMany(hSender, vecDatagrams.data(), std::min(nCount - nSent, static_cast<int>(vecDatagrams.size())),
+			reinterpret_cast<const sockaddr*>(&address), sizeof(address), 0);
+		if (nBatch <= 0)
+		{
+			break;
+		}
+		nSent += nBatch;
+	}
+	return nSent;
+}
+
+/**
+ * @brief Fills the receiver and times only the draining, for about half a
+ * second of draining; returns datagrams/s. pfnDrain receives everything
+ * waiting and returns how many datagrams it got.
+ */
+static double Measure(const std::function<void()>& pfnFill, const std::function<uint64_t()>& pfnDrain)
+{
+	uint64_t nReceived = 0;
+	double fSeconds = 0;
+	do
+	{
+		pfnFill();
+		CTestStopwatch pStopwatch;
+		nReceived += pfnDrain();
+		fSeconds += pStopwatch.GetSeconds();
+	} while (fSeconds < 0.5);
+	return static_cast<double>(nReceived) / fSeconds;
+}
+
+int main()
+{
+	setvbuf(stdout, nullptr, _IONBF, 0);
+
+	const int hReceiver = socket(AF_INET, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+	// As deep a queue as the system allows, so that a drain is long enough to time
+	const int nBuffer = 64 << 20;
+	if (setsockopt(hReceiver, SOL_SOCKET, SO_RCVBUFFORCE, &nBuffer, sizeof(nBuffer)) != 0)
+	{
+		setsockopt(hReceiver, SOL_SOCKET, SO_RCVBUF, &nBuffer, sizeof(nBuffer));
+	}
+	sockaddr_in address = {};
+	address.sin_family = AF_INET;
+	address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+	socklen_t nAddressLength = sizeof(address);
+	if ((bind(hReceiver, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) ||
+		(getsockname(hReceiver, reinterpret_cast<sockaddr*>(&address), &nAddressLength) != 0))
+	{
+		printf("cannot bind a loopback receiver\n");
+		return 1;
+	}
+	const int hSender = socket(AF_INET, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+	CDatagramReceiver pReceiver;
+	CEndpointTable pEndpoints;
+	const bool bKernelTimestamps = pReceiver.Attach(hReceiver);
+	std::vector<char> vecBuffer(CDatagramReceiver::DATAGRAM_SLOT_SIZE);
+
+	printf("datagrams/s received from a full loopback socket (kernel timestamps %s), target 1000000\n", bKernelTimestamps ? "on" : "off");
+	printf("%8s %18s %18s %10s\n", "size", "recvfrom", "CDatagramReceiver", "speedup");
+	const size_t nSizes[] = { 16, 64, 512, 1400 };
+	for (const size_t nSize : nSizes)
+	{
+		const std::vector<char> vecPayload(nSize, 'r');
+		const std::vector<CUdpDatagram> vecDatagrams(UDP_SEND_BATCH, CUdpDatagram{ vecPayload.data(), nSize });
+		const std::function<void()> pfnFill = [&]()
+		{
+			Fill(hSender, address, vecDatagrams, 20000);
+		};
+
+		// Before CDatagramReceiver: a recvfrom per datagram, a sockaddr each, a clock read each
+		const double fSingle = Measure(pfnFill, [&]()
+		{
+			uint64_t nReceived = 0;
+			sockaddr_storage source;
+			for (;;)
+			{
+				socklen_t nSourceLength = sizeof(source);
+				if (recvfrom(hReceiver, vecBuffer.data(), vecBuffer.size(), MSG_DONTWAIT, reinterpret_cast<sockaddr*>(&source), &nSourceLength) < 0)
+				{
+					break;
+				}
+				volatile CLatencyClock::rep nArrival = CLatencyClock::now().time_since_epoch().count();
+				(void)nArrival;
+				nReceived++;
+			}
+			return nReceived;
+		});
+		const double fBatched = Measure(pfnFill, [&]()
+		{
+			uint64_t nReceived = 0;
+			for (;;)
+			{
+				const int nCount = pReceiver.Receive(hReceiver, pEndpoints);
+				if (nCount <= 0)
+				{
+					break;
+				}
+				nReceived += static_cast<uint64_t>(nCount);
+			}
+			return nReceived;
+		});
+		printf("%8zu %18.0f %18.0f %9.1fx\n", nSize, fSingle, fBatched, fBatched / fSingle);
+	}
+	close(hSender);
+	close(hReceiver);
+	return 0;
+}
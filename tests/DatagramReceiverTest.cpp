@@ -0,0 +1,373 @@
+/* Copyright (C) 2014-2026 Stefan-Mihai MOGA
+This file is part of IntelliPort application developed by Stefan-Mihai MOGA.
+IntelliPort is an alternative Windows version to the famous HyperTerminal!
+
+IntelliPort is free software: you can redistribute it and/or modify it
+under the terms of the GNU General Public License as published by the Open
+Source Initiative, either version 3 of the License, or any later version.
+
+IntelliPort is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+IntelliPort. If not, see <http://www.opensource.org/licenses/gpl-3.0.html>*/
+
+// DatagramReceiverTest.cpp : batched receive, truncation, arrival times and sender ids over loopback
+//
+
+#include "DatagramReceiver.h"
+#include "UnitTest.h"
+
+#include <arpa/inet.h>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+/**
+ * @brief The CLatencyClock time now, in nanoseconds, as CReceivedDatagram::nTimestamp.
+ */
+static uint64_t GetNow()
+{
+	return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+		CLatencyClock::now().time_since_epoch()).count());
+}
+
+/**
+ * @brief A UDP socket bound to a loopback port (0 for a free one).
+ */
+static int BindLoopback(uint16_t& nPort)
+{
+	const int hSocket = socket(AF_INET, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+	sockaddr_in address = {};
+	address.sin_family = AF_INET;
+	address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+	address.sin_port = htons(nPort);
+	socklen_t nLength = sizeof(address);
+	const int nBuffer = 4 << 20;
+	setsockopt(hSocket, SOL_SOCKET, SO_RCVBUF, &nBuffer, sizeof(nBuffer));
+	if ((bind(hSocket, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) ||
+		(getsockname(hSocket, reinterpret_cast<sockaddr*>(&address), &nLength) != 0))
+	{
+		close(hSocket);
+		return -1;
+	}
+	nPort = ntohs(address.sin_port);
+	return hSocket;
+}
+
+/**
+ * @brief Sends a datagram to a loopback port.
+ */
+static bool SendTo(int hSocket, uint16_t nPort, const std::string& strPayload)
+{
+	sockaddr_in address = {};
+	address.sin_family = AF_INET;
+	address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+	address.sin_port = htons(nPort);
+	return sendto(hSocket, strPayload.data(), strPayload.size(), 0,
+		reinterpret_cast<const sockaddr*>(&address), sizeof(address)) == static_cast<ssize_t>(strPayload.size());
+}
+
+/**
+ * @brief The payload of the nIndex-th datagram of a test: numbered, of varied length.
+ */
+static std::string MakePayload(int nIndex)
+{
+	return "datagram " + std::to_string(nIndex) + " " + std::string(static_cast<size_t>(nIndex * 37 % 1400), static_cast<char>('a' + nIndex % 26));
+}
+
+/**
+ * @brief More datagrams than DATAGRAM_RECEIVE_BATCH come back in full batches
+ * then a partial one, in order, whole and from the same sender id.
+ */
+static void TestBatches()
+{
+	uint16_t nPort = 0;
+	const int hReceiver = BindLoopback(nPort);
+	TEST_CHECK(hReceiver >= 0);
+	const int hSender = socket(AF_INET, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+	CDatagramReceiver pReceiver;
+	CEndpointTable pEndpoints;
+	TEST_CHECK(pReceiver.Receive(hReceiver, pEndpoints) == 0); // nothing waiting, no wait
+
+	const int nCount = 2 * CDatagramReceiver::DATAGRAM_RECEIVE_BATCH + 22;
+	for (int nIndex = 0; nIndex < nCount; nIndex++)
+	{
+		TEST_CHECK(SendTo(hSender, nPort, MakePayload(nIndex)));
+	}
+	std::vector<int> vecBatches;
+	int nReceived = 0, nMismatches = 0;
+	uint64_t nBytes = 0;
+	for (int nRound = 0; (nRound < 100) && (nReceived < nCount); nRound++)
+	{
+		const int nBatch = pReceiver.Receive(hReceiver, pEndpoints);
+		TEST_CHECK(nBatch >= 0);
+		if (nBatch <= 0)
+		{
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+			continue;
+		}
+		vecBatches.push_back(nBatch);
+		for (int nIndex = 0; nIndex < nBatch; nIndex++, nReceived++)
+		{
+			const CReceivedDatagram& pDatagram = pReceiver.GetDatagram(nIndex);
+			const std::string strExpected = MakePayload(nReceived);
+			nMismatches += (std::string(pDatagram.pData, pDatagram.nLength) != strExpected) ? 1 : 0;
+			nMismatches += (pDatagram.nEndpoint != 1) ? 1 : 0;
+			nMismatches += pDatagram.bTruncated ? 1 : 0;
+			nMismatches += (pDatagram.pSource->sa_family != AF_INET) ? 1 : 0;
+			nMismatches += (pDatagram.nSourceLength != static_cast<int>(sizeof(sockaddr_in))) ? 1 : 0;
+			nBytes += strExpected.size();
+		}
+	}
+	TEST_CHECK(nReceived == nCount);
+	TEST_CHECK(nMismatches == 0);
+	// Everything was waiting before the first call: full batches, then the rest
+	TEST_CHECK(vecBatches.size() == 3);
+	TEST_CHECK((vecBatches.size() == 3) && (vecBatches[0] == CDatagramReceiver::DATAGRAM_RECEIVE_BATCH) &&
+		(vecBatches[1] == CDatagramReceiver::DATAGRAM_RECEIVE_BATCH) && (vecBatches[2] == 22));
+	TEST_CHECK(pReceiver.Receive(hReceiver, pEndpoints) == 0);
+
+	const CDatagramReceiverStats& stats = pReceiver.GetStats();
+	TEST_CHECK(stats.nDatagrams == static_cast<uint64_t>(nCount));
+	TEST_CHECK(stats.nBytes == nBytes);
+	TEST_CHECK(stats.nBatches == 3);
+	TEST_CHECK(stats.nTruncated == 0);
+	TEST_CHECK(pEndpoints.GetCount() == 1);
+
+	// A closed socket is an error, not an empty batch
+	TEST_CHECK(pReceiver.Receive(-1, pEndpoints) == -1);
+	close(hSender);
+	close(hReceiver);
+}
+
+/**
+ * @brief A datagram longer than DATAGRAM_SLOT_SIZE keeps its first slot's
+ * worth and is flagged, without disturbing the datagrams around it.
+ *
+ * UDP cannot carry that much, so a local datagram socket pair stands in.
+ */
+static void TestTruncation()
+{
+	int hSockets[2] = { -1, -1 };
+	TEST_CHECK(socketpair(AF_UNIX, SOCK_DGRAM | SOCK_CLOEXEC, 0, hSockets) == 0);
+	const int nBuffer = 1 << 20;
+	setsockopt(hSockets[0], SOL_SOCKET, SO_SNDBUF, &nBuffer, sizeof(nBuffer));
+	setsockopt(hSockets[1], SOL_SOCKET, SO_RCVBUF, &nBuffer, sizeof(nBuffer));
+
+	const size_t nSlot = CDatagramReceiver::DATAGRAM_SLOT_SIZE;
+	std::string strLong(nSlot + 5000, '\0');
+	for (size_t nIndex = 0; nIndex < strLong.size(); nIndex++)
+	{
+		strLong[nIndex] = static_cast<char>(nIndex * 131 >> 3);
+	}
+	const std::string strExact(nSlot, 'e');
+	TEST_CHECK(send(hSockets[0], "before", 6, 0) == 6);
+	TEST_CHECK(send(hSockets[0], strLong.data(), strLong.size(), 0) == static_cast<ssize_t>(strLong.size()));
+	TEST_CHECK(send(hSockets[0], strExact.data(), strExact.size(), 0) == static_cast<ssize_t>(strExact.size()));
+	TEST_CHECK(send(hSockets[0], "after", 5, 0) == 5);
+
+	CDatagramReceiver pReceiver;
+	CEndpointTable pEndpoints;
+	TEST_CHECK(pReceiver.Receive(hSockets[1], pEndpoints) == 4);
+	TEST_CHECK(std::string(pReceiver.GetDatagram(0).pData, pReceiver.GetDatagram(0).nLength) == "before");
+	TEST_CHECK(!pReceiver.GetDatagram(0).bTruncated);
+	const CReceivedDatagram& pLong = pReceiver.GetDatagram(1);
+	TEST_CHECK(pLong.bTruncated);
+	TEST_CHECK(pLong.nLength == nSlot);
+	TEST_CHECK(memcmp(pLong.pData, strLong.data(), nSlot) == 0);
+	// Exactly one slot fits: not truncated
+	TEST_CHECK(!pReceiver.GetDatagram(2).bTruncated);
+	TEST_CHECK((pReceiver.GetDatagram(2).nLength == nSlot) && (memcmp(pReceiver.GetDatagram(2).pData, strExact.data(), nSlot) == 0));
+	TEST_CHECK(std::string(pReceiver.GetDatagram(3).pData, pReceiver.GetDatagram(3).nLength) == "after");
+	TEST_CHECK(!pReceiver.GetDatagram(3).bTruncated);
+	// An unnamed local sender has no address to intern
+	TEST_CHECK(pReceiver.GetDatagram(0).nEndpoint == CEndpointTable::ENDPOINT_UNKNOWN);
+
+	const CDatagramReceiverStats& stats = pReceiver.GetStats();
+	TEST_CHECK(stats.nTruncated == 1);
+	TEST_CHECK(stats.nDatagrams == 4);
+	TEST_CHECK(stats.nBytes == 6 + nSlot + nSlot + 5);
+	close(hSockets[0]);
+	close(hSockets[1]);
+}
+
+/**
+ * @brief With SO_TIMESTAMPNS the arrival time is when the datagram reached
+ * the socket, moved to CLatencyClock, not when Receive() ran.
+ */
+static void TestTimestamps()
+{
+	uint16_t nPort = 0;
+	const int hReceiver = BindLoopback(nPort);
+	TEST_CHECK(hReceiver >= 0);
+	const int hSender = socket(AF_INET, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+
+	// Without Attach() the batch time is used
+	CDatagramReceiver pReceiver;
+	CEndpointTable pEndpoints;
+	TEST_CHECK(!pReceiver.GetStats().bKernelTimestamps);
+	TEST_CHECK(SendTo(hSender, nPort, "late"));
+	std::this_thread::sleep_for(std::chrono::milliseconds(30));
+	uint64_t nBefore = GetNow();
+	TEST_CHECK(pReceiver.Receive(hReceiver, pEndpoints) == 1);
+	uint64_t nAfter = GetNow();
+	TEST_CHECK((pReceiver.GetDatagram(0).nTimestamp >= nBefore) && (pReceiver.GetDatagram(0).nTimestamp <= nAfter));
+
+	// Attached: the time of arrival, 30 ms before the receive
+	TEST_CHECK(pReceiver.Attach(hReceiver));
+	TEST_CHECK(pReceiver.GetStats().bKernelTimestamps);
+	// Linux turns timestamping on a moment after the first socket asks for it
+	std::this_thread::sleep_for(std::chrono::milliseconds(20));
+	const int nCount = 3;
+	std::vector<uint64_t> vecSent;
+	for (int nIndex = 0; nIndex < nCount; nIndex++)
+	{
+		vecSent.push_back(GetNow());
+		TEST_CHECK(SendTo(hSender, nPort, MakePayload(nIndex)));
+		std::this_thread::sleep_for(std::chrono::milliseconds(10));
+	}
+	std::this_thread::sleep_for(std::chrono::milliseconds(30));
+	nBefore = GetNow();
+	TEST_CHECK(pReceiver.Receive(hReceiver, pEndpoints) == nCount);
+	nAfter = GetNow();
+	// The realtime clock is read apart from the monotonic one: allow a little skew
+	const uint64_t nSkew = 2000000;
+	uint64_t nPrevious = 0;
+	for (int nIndex = 0; nIndex < nCount; nIndex++)
+	{
+		const uint64_t nTimestamp = pReceiver.GetDatagram(nIndex).nTimestamp;
+		TEST_CHECK(nTimestamp + nSkew >= vecSent[nIndex]);
+		TEST_CHECK(nTimestamp <= vecSent[nIndex] + nSkew + 5000000);
+		TEST_CHECK(nTimestamp + 25000000 <= nBefore);
+		TEST_CHECK(nTimestamp > nPrevious);
+		nPrevious = nTimestamp;
+	}
+	// Each datagram keeps its own time: 10 ms apart, not the batch's
+	TEST_CHECK(pReceiver.GetDatagram(nCount - 1).nTimestamp - pReceiver.GetDatagram(0).nTimestamp >= 15000000);
+	TEST_CHECK(nAfter >= nBefore);
+	close(hSender);
+	close(hReceiver);
+}
+
+/**
+ * @brief Senders are told apart by port and address; the table gives ids in
+ * order of first appearance and stops at ENDPOINT_TABLE_SIZE.
+ */
+static void TestEndpoints()
+{
+	uint16_t nPort = 0;
+	const int hReceiver = BindLoopback(nPort);
+	TEST_CHECK(hReceiver >= 0);
+	std::vector<int> vecSenders;
+	std::vector<uint16_t> vecPorts;
+	for (int nIndex = 0; nIndex < 3; nIndex++)
+	{
+		uint16_t nSenderPort = 0;
+		vecSenders.push_back(BindLoopback(nSenderPort));
+		vecPorts.push_back(nSenderPort);
+	}
+
+	// Interleaved senders: 0 1 0 2 1 0 ...
+	const int nOrder[] = { 0, 1, 0, 2, 1, 0, 2, 2, 1, 0 };
+	for (const int nSender : nOrder)
+	{
+		TEST_CHECK(SendTo(vecSenders[nSender], nPort, "from " + std::to_string(nSender)));
+	}
+	CDatagramReceiver pReceiver;
+	CEndpointTable pEndpoints;
+	TEST_CHECK(pReceiver.Receive(hReceiver, pEndpoints) == 10);
+	const uint32_t nIds[] = { 1, 2, 1, 3, 2, 1, 3, 3, 2, 1 };
+	for (int nIndex = 0; nIndex < 10; nIndex++)
+	{
+		TEST_CHECK(pReceiver.GetDatagram(nIndex).nEndpoint == nIds[nIndex]);
+	}
+	TEST_CHECK(pEndpoints.GetCount() == 3);
+	for (uint32_t nId = 1; nId <= 3; nId++)
+	{
+		sockaddr_storage address;
+		int nLength = 0;
+		TEST_CHECK(pEndpoints.GetAddress(nId, address, nLength));
+		TEST_CHECK(nLength == static_cast<int>(sizeof(sockaddr_in)));
+		const sockaddr_in* pAddress = reinterpret_cast<const sockaddr_in*>(&address);
+		TEST_CHECK((pAddress->sin_family == AF_INET) && (ntohs(pAddress->sin_port) == vecPorts[nId - 1]));
+	}
+	sockaddr_storage address;
+	int nLength = 0;
+	TEST_CHECK(!pEndpoints.GetAddress(CEndpointTable::ENDPOINT_UNKNOWN, address, nLength));
+	TEST_CHECK(!pEndpoints.GetAddress(4, address, nLength));
+
+	// Fill the table: ids up to ENDPOINT_TABLE_SIZE, then ENDPOINT_UNKNOWN for a new sender
+	sockaddr_in synthetic = {};
+	synthetic.sin_family = AF_INET;
+	uint32_t nExpected = pEndpoints.GetCount() + 1;
+	int nWrongIds = 0;
+	for (uint32_t nIndex = 0; pEndpoints.GetCount() < CEndpointTable::ENDPOINT_TABLE_SIZE; nIndex++, nExpected++)
+	{
+		synthetic.sin_addr.s_addr = htonl(0x0A000000 + nIndex);
+		synthetic.sin_port = htons(static_cast<uint16_t>(1000 + nIndex % 7));
+		nWrongIds += (pEndpoints.Intern(reinterpret_cast<const sockaddr*>(&synthetic), sizeof(synthetic)) != nExpected) ? 1 : 0;
+	}
+	TEST_CHECK(nWrongIds == 0);
+	TEST_CHECK(pEndpoints.GetCount() == CEndpointTable::ENDPOINT_TABLE_SIZE);
+	synthetic.sin_addr.s_addr = htonl(0x0B000000);
+	TEST_CHECK(pEndpoints.Intern(reinterpret_cast<const sockaddr*>(&synthetic), sizeof(synthetic)) == CEndpointTable::ENDPOINT_UNKNOWN);
+	// Known addresses are still found, through the hash as well as the last sender
+	synthetic.sin_addr.s_addr = htonl(0x0A000000 + 100);
+	synthetic.sin_port = htons(1000 + 100 % 7);
+	TEST_CHECK(pEndpoints.Intern(reinterpret_cast<const sockaddr*>(&synthetic), sizeof(synthetic)) == 3 + 100 + 1);
+	TEST_CHECK(pEndpoints.Intern(reinterpret_cast<const sockaddr*>(&synthetic), sizeof(synthetic)) == 3 + 100 + 1);
+
+	// Through Receive(): known senders keep their ids, a new one gets none
+	uint16_t nLatePort = 0;
+	const int hLate = BindLoopback(nLatePort);
+	TEST_CHECK(SendTo(vecSenders[2], nPort, "known"));
+	TEST_CHECK(SendTo(hLate, nPort, "unknown"));
+	TEST_CHECK(SendTo(vecSenders[0], nPort, "known"));
+	TEST_CHECK(pReceiver.Receive(hReceiver, pEndpoints) == 3);
+	TEST_CHECK(pReceiver.GetDatagram(0).nEndpoint == 3);
+	TEST_CHECK(pReceiver.GetDatagram(1).nEndpoint == CEndpointTable::ENDPOINT_UNKNOWN);
+	TEST_CHECK(ntohs(reinterpret_cast<const sockaddr_in*>(pReceiver.GetDatagram(1).pSource)->sin_port) == nLatePort);
+	TEST_CHECK(pReceiver.GetDatagram(2).nEndpoint == 1);
+
+	// IPv6: the scope tells two link-local senders apart; other families get no id
+	sockaddr_in6 synthetic6 = {};
+	synthetic6.sin6_family = AF_INET6;
+	synthetic6.sin6_port = htons(4000);
+	synthetic6.sin6_addr.s6_addr[0] = 0xFE;
+	synthetic6.sin6_addr.s6_addr[1] = 0x80;
+	synthetic6.sin6_addr.s6_addr[15] = 1;
+	pEndpoints.Reset();
+	TEST_CHECK(pEndpoints.GetCount() == 0);
+	TEST_CHECK(!pEndpoints.GetAddress(1, address, nLength));
+	synthetic6.sin6_scope_id = 1;
+	TEST_CHECK(pEndpoints.Intern(reinterpret_cast<const sockaddr*>(&synthetic6), sizeof(synthetic6)) == 1);
+	synthetic6.sin6_scope_id = 2;
+	TEST_CHECK(pEndpoints.Intern(reinterpret_cast<const sockaddr*>(&synthetic6), sizeof(synthetic6)) == 2);
+	synthetic6.sin6_scope_id = 1;
+	TEST_CHECK(pEndpoints.Intern(reinterpret_cast<const sockaddr*>(&synthetic6), sizeof(synthetic6)) == 1);
+	TEST_CHECK(pEndpoints.Intern(reinterpret_cast<const sockaddr*>(&synthetic6), sizeof(sockaddr_in)) == CEndpointTable::ENDPOINT_UNKNOWN);
+	sockaddr local = {};
+	local.sa_family = AF_UNIX;
+	TEST_CHECK(pEndpoints.Intern(&local, sizeof(local)) == CEndpointTable::ENDPOINT_UNKNOWN);
+	TEST_CHECK(pEndpoints.GetCount() == 2);
+
+	close(hLate);
+	for (const int hSender : vecSenders)
+	{
+		close(hSender);
+	}
+	close(hReceiver);
+}
+
+int main()
+{
+	setvbuf(stdout, nullptr, _IONBF, 0);
+	TestBatches();
+	TestTruncation();
+	TestTimestamps();
+	TestEndpoints();
+	return TEST_RESULT();
+}
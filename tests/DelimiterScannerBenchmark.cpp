@@ -0,0 +1,111 @@
+/* Copyright (C) 2014-2026 Stefan-Mihai MOGA
+This file is part of IntelliPort application developed by Stefan-Mihai MOGA.
+IntelliPort is an alternative Windows version to the famous HyperTerminal!
+
+IntelliPort is free software: you can redistribute it and/or modify it
+under the terms of the GNU General Public License as published by the Open
+Source Initiative, either version 3 of the License, or any later version.
+
+IntelliPort is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+IntelliPort. If not, see <http://www.opensource.org/licenses/gpl-3.0.html>*/
+
+// DelimiterScannerBenchmark.cpp : line scanning speed for line sizes from 8 B to 64 KB
+//
+
+#include "DelimiterScanner.h"
+#include "RingBuffer.h"
+#include "UnitTest.h"
+
+#include <string>
+#include <vector>
+
+/**
+ * @brief The line search as it was before the scanner: PeekChar for every
+ * byte, starting over from the oldest byte on every call.
+ */
+class CPerByteRing : public CRingBuffer
+{
+public:
+	bool ReadTextLinePerByte(std::string& strLine)
+	{
+		const int nSize = GetMaxReadSize();
+		for (int nIndex = 0; nIndex < nSize; nIndex++)
+		{
+			char ch = 0;
+			if (PeekChar(nIndex, ch) && (ch == '\n'))
+			{
+				if (!ReadBinary(m_pTmpBuf, nIndex + 1))
+					return false;
+				strLine.assign(m_pTmpBuf, nIndex + 1);
+				return true;
+			}
+		}
+		return false;
+	}
+};
+
+/**
+ * @brief Feeds nTotal bytes of nLineSize-byte lines in nPiece-byte writes and
+ * reads every line as soon as it completes; returns MB/s.
+ */
+static double MeasureLines(bool bPerByte, size_t nLineSize, size_t nPiece, size_t nTotal)
+{
+	std::string strLine(nLineSize - 1, 'x');
+	strLine += '\n';
+	std::string strStream;
+	while (strStream.size() < (1 << 20))
+		strStream += strLine;
+	strStream.resize(strStream.size() - (strStream.size() % nLineSize));
+
+	CPerByteRing pRing;
+	pRing.Create(0x20000);
+	size_t nLines = 0, nFed = 0;
+	CTestStopwatch pStopwatch;
+	while (nFed < nTotal)
+	{
+		for (size_t nOffset = 0; nOffset < strStream.size(); nOffset += nPiece)
+		{
+			const size_t nLength = (nPiece < strStream.size() - nOffset) ? nPiece : strStream.size() - nOffset;
+			pRing.WriteBinary(strStream.data() + nOffset, static_cast<int>(nLength));
+			std::string strRead;
+			while (bPerByte ? pRing.ReadTextLinePerByte(strRead) : pRing.ReadTextLine(strRead))
+				nLines++;
+		}
+		nFed += strStream.size();
+	}
+	const double fSeconds = pStopwatch.GetSeconds();
+	if (nLines != nFed / nLineSize)
+		printf("line count mismatch: %zu, expected %zu\n", nLines, nFed / nLineSize);
+	return nFed / fSeconds / 1e6;
+}
+
+int main(int argc, char* argv[])
+{
+	setvbuf(stdout, nullptr, _IONBF, 0);
+	const size_t nTotal = static_cast<size_t>((argc > 1) ? atoi(argv[1]) : 64) << 20;
+
+	// raw scanner speed over data without a delimiter
+	std::vector<char> vecPlain(1 << 20, 'x');
+	CTestStopwatch pStopwatch;
+	size_t nChecksum = 0;
+	for (int nRound = 0; nRound < 2000; nRound++)
+		nChecksum += FindFirstDelimiter(vecPlain.data(), vecPlain.size() - (nRound & 1), '\n', '\r', '\x03');
+	printf("FindFirstDelimiter: %.2f GB/s (%zu)\n", 2000.0 * vecPlain.size() / pStopwatch.GetSeconds() / 1e9, nChecksum);
+
+	printf("%10s %10s %14s %14s\n", "line size", "piece", "scanner MB/s", "per-byte MB/s");
+	for (size_t nLineSize : { 8, 64, 512, 4096, 65536 })
+	{
+		for (size_t nPiece : { 64, 4096 })
+		{
+			// the per-byte scan is quadratic in the pieces per line, keep its volume down
+			const size_t nPerByteTotal = ((nLineSize / nPiece) > 8) ? (nTotal / 16) : nTotal;
+			printf("%10zu %10zu %14.1f %14.1f\n", nLineSize, nPiece,
+				MeasureLines(false, nLineSize, nPiece, nTotal), MeasureLines(true, nLineSize, nPiece, nPerByteTotal));
+		}
+	}
+	return 0;
+}
@@ -0,0 +1,160 @@
+/* Copyright (C) 2014-2026 Stefan-Mihai MOGA
+This file is part of IntelliPort application developed by Stefan-Mihai MOGA.
+IntelliPort is an alternative Windows version to the famous HyperTerminal!
+
+IntelliPort is free software: you can redistribute it and/or modify it
+under the terms of the GNU General Public License as published by the Open
+Source Initiative, either version 3 of the License, or any later version.
+
+IntelliPort is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+IntelliPort. If not, see <http://www.opensource.org/licenses/gpl-3.0.html>*/
+
+// DelimiterScannerTest.cpp : fuzz of FindFirstDelimiter and ReadTextLine against scalar references
+//
+
+#include "DelimiterScanner.h"
+#include "RingBuffer.h"
+#include "UnitTest.h"
+
+#include <string>
+#include <vector>
+
+static size_t ReferenceFind(const char* pData, size_t nLength, char chFirst, char chSecond, char chThird)
+{
+	for (size_t nIndex = 0; nIndex < nLength; nIndex++)
+	{
+		if ((pData[nIndex] == chFirst) || (pData[nIndex] == chSecond) || (pData[nIndex] == chThird))
+			return nIndex;
+	}
+	return nLength;
+}
+
+/**
+ * @brief Splits a whole stream the way FindLineEnd does: LF, CR LF, lone CR or
+ * the frame delimiter end a line, and a CR at the very end is not complete yet.
+ */
+static std::vector<std::string> ReferenceLines(const std::string& strStream, char chDelimiter)
+{
+	std::vector<std::string> vecLines;
+	size_t nStart = 0;
+	for (;;)
+	{
+		const size_t nFound = ReferenceFind(strStream.data() + nStart, strStream.size() - nStart, '\n', '\r', chDelimiter);
+		if (nStart + nFound == strStream.size())
+			break;
+		size_t nSize = nFound + 1;
+		if (strStream[nStart + nFound] == '\r')
+		{
+			if (nStart + nFound + 1 == strStream.size())
+				break;
+			if (strStream[nStart + nFound + 1] == '\n')
+				nSize++;
+		}
+		vecLines.push_back(strStream.substr(nStart, nSize));
+		nStart += nSize;
+	}
+	return vecLines;
+}
+
+/**
+ * @brief Random buffers, lengths and alignments; delimiters are rare, frequent or absent.
+ */
+static void TestFindFirstDelimiter()
+{
+	CTestRandom pRandom(1);
+	std::vector<char> vecBuffer(1024 + 64);
+	const char pDelimiters[] = { '\n', '\r', '\0', '\x03', '\xFF', 'a' };
+	for (int nRound = 0; nRound < 200000; nRound++)
+	{
+		const size_t nOffset = pRandom.Range(0, 63);
+		const size_t nLength = pRandom.Range(0, 1024);
+		const uint64_t nDensity = pRandom.Range(0, 600);
+		const char chFirst = pDelimiters[pRandom.Range(0, 5)];
+		const char chSecond = (pRandom.Next() & 1) ? chFirst : pDelimiters[pRandom.Range(0, 5)];
+		const char chThird = (pRandom.Next() & 1) ? chSecond : pDelimiters[pRandom.Range(0, 5)];
+		char* pData = vecBuffer.data() + nOffset;
+		for (size_t nIndex = 0; nIndex < nLength; nIndex++)
+		{
+			// printable filler that never equals a delimiter, unless this byte is chosen as one
+			pData[nIndex] = ((nDensity != 0) && (pRandom.Range(1, nDensity) == 1)) ?
+				pDelimiters[pRandom.Range(0, 5)] : static_cast<char>('b' + pRandom.Range(0, 20));
+		}
+		const size_t nExpected = ReferenceFind(pData, nLength, chFirst, chSecond, chThird);
+		const size_t nFound = FindFirstDelimiter(pData, nLength, chFirst, chSecond, chThird);
+		TEST_CHECK(nFound == nExpected);
+		if (nFound != nExpected)
+			return;
+	}
+}
+
+/**
+ * @brief Feeds a random stream in random pieces and reads lines as they complete,
+ * so scans resume across pieces, CR LF pairs split and lines wrap the ring.
+ */
+static void TestReadTextLine(bool bMirrored, char chDelimiter)
+{
+	CTestRandom pRandom(bMirrored ? 5 : 9);
+	const char pAlphabet[] = { 'x', 'y', 'z', '\n', '\r', '\x03' };
+	std::string strStream;
+	while (strStream.size() < (4 << 20))
+	{
+		// mostly short lines, sometimes long ones
+		const size_t nRun = (pRandom.Range(0, 15) == 0) ? pRandom.Range(0, 6000) : pRandom.Range(0, 40);
+		strStream.append(nRun, pAlphabet[pRandom.Range(0, 2)]);
+		strStream += pAlphabet[pRandom.Range(3, 5)];
+	}
+	const std::vector<std::string> vecExpected = ReferenceLines(strStream, chDelimiter);
+
+	CRingBuffer pRing;
+	TEST_CHECK(pRing.Create(0x10000, bMirrored));
+	pRing.SetFrameDelimiter(chDelimiter);
+	size_t nFed = 0, nLine = 0;
+	bool bMatch = true;
+	while (nFed < strStream.size())
+	{
+		size_t nPiece = pRandom.Range(1, 700);
+		if (nPiece > strStream.size() - nFed)
+			nPiece = strStream.size() - nFed;
+		if (nPiece > static_cast<size_t>(pRing.GetMaxWriteSize()))
+		{
+			// a line longer than the ring never completes; drop what is buffered
+			std::vector<char> vecDiscard(pRing.GetMaxReadSize());
+			pRing.ReadBinary(vecDiscard.data(), static_cast<int>(vecDiscard.size()));
+			bMatch = false;
+			break;
+		}
+		pRing.WriteBinary(strStream.data() + nFed, static_cast<int>(nPiece));
+		nFed += nPiece;
+		std::string strLine;
+		while (pRing.ReadTextLine(strLine))
+		{
+			if ((nLine >= vecExpected.size()) || (strLine != vecExpected[nLine]))
+				bMatch = false;
+			nLine++;
+		}
+	}
+	TEST_CHECK(bMatch);
+	TEST_CHECK(nLine == vecExpected.size());
+	printf("%s ring, delimiter 0x%02X: %zu lines\n", bMirrored ? "mirrored" : "plain", static_cast<unsigned char>(chDelimiter), nLine);
+}
+
+int main()
+{
+	setvbuf(stdout, nullptr, _IONBF, 0);
+#if defined(DELIMITER_SCANNER_AVX2)
+	printf("scanner: AVX2\n");
+#elif defined(DELIMITER_SCANNER_SSE2)
+	printf("scanner: SSE2\n");
+#else
+	printf("scanner: scalar\n");
+#endif
+	TestFindFirstDelimiter();
+	TestReadTextLine(false, '\n');
+	TestReadTextLine(false, '\x03');
+	TestReadTextLine(true, '\x03');
+	return TEST_RESULT();
+}
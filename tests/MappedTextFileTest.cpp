@@ -0,0 +1,389 @@
+/* Copyright (C) 2014-2026 Stefan-Mihai MOGA
+This file is part of IntelliPort application developed by Stefan-Mihai MOGA.
+IntelliPort is an alternative Windows version to the famous HyperTerminal!
+
+IntelliPort is free software: you can redistribute it and/or modify it
+under the terms of the GNU General Public License as published by the Open
+Source Initiative, either version 3 of the License, or any later version.
+
+IntelliPort is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+IntelliPort. If not, see <http://www.opensource.org/licenses/gpl-3.0.html>*/
+
+// MappedTextFileTest.cpp : line index of files larger than an indexing chunk, in UTF-8 and UTF-16, against a plain split
+//
+
+#include "MappedTextFile.h"
+#include "UnitTest.h"
+
+#include <fcntl.h>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+static const size_t CHUNK = CMappedTextFile::MAPPED_TEXT_CHUNK_SIZE;
+
+/**
+ * @brief Writes bytes to a new file in /tmp; returns its path.
+ */
+static std::string WriteTempFile(const std::vector<uint8_t>& vecBytes)
+{
+	char lpszPath[] = "/tmp/IntelliPortMappedXXXXXX";
+	const int nFd = mkstemp(lpszPath);
+	if (nFd >= 0)
+	{
+		for (size_t nOffset = 0; nOffset < vecBytes.size(); )
+		{
+			const ssize_t nWritten = write(nFd, vecBytes.data() + nOffset, vecBytes.size() - nOffset);
+			if (nWritten <= 0)
+			{
+				break;
+			}
+			nOffset += static_cast<size_t>(nWritten);
+		}
+		close(nFd);
+	}
+	return lpszPath;
+}
+
+/**
+ * @brief Maps a file; the descriptor is closed at once, the mapping keeps the file.
+ */
+static bool OpenMapped(CMappedTextFile& pFile, const std::string& strPath)
+{
+	const int nFd = open(strPath.c_str(), O_RDONLY | O_CLOEXEC);
+	const bool bOpen = (nFd >= 0) && pFile.Open(nFd);
+	if (nFd >= 0)
+	{
+		close(nFd);
+	}
+	return bOpen;
+}
+
+/**
+ * @brief Waits for the background index to be complete.
+ */
+static bool WaitIndexed(const CMappedTextFile& pFile)
+{
+	for (int nWait = 0; (nWait < 6000) && !pFile.IsIndexed(); nWait++)
+	{
+		std::this_thread::sleep_for(std::chrono::milliseconds(10));
+	}
+	return pFile.IsIndexed();
+}
+
+/**
+ * @brief The expected lines of a file and where each starts, in bytes from the start of the text.
+ */
+struct CExpectedLines
+{
+	std::vector<std::wstring> vecLines;
+	std::vector<size_t> vecStarts;
+};
+
+/**
+ * @brief Checks the line count, the longest line and the lines around every
+ * chunk boundary, at the start and end of the file and at random.
+ */
+static void CheckLines(const CMappedTextFile& pFile, const CExpectedLines& pExpected, uint64_t nLongest, uint64_t nSeed)
+{
+	const std::vector<std::wstring>& vecLines = pExpected.vecLines;
+	TEST_CHECK(pFile.GetLineCount() == vecLines.size());
+	// The longest line counts a CR before its LF
+	TEST_CHECK((pFile.GetMaxLineLength() >= nLongest) && (pFile.GetMaxLineLength() <= nLongest + 1));
+
+	std::vector<uint64_t> vecToCheck;
+	for (uint64_t nLine = 0; (nLine < 1000) && (nLine < vecLines.size()); nLine++)
+	{
+		vecToCheck.push_back(nLine);
+		vecToCheck.push_back(vecLines.size() - 1 - nLine);
+	}
+	for (size_t nLine = 0; nLine < vecLines.size(); nLine++)
+	{
+		const size_t nStart = pExpected.vecStarts[nLine];
+		const size_t nNext = (nLine + 1 < vecLines.size()) ? pExpected.vecStarts[nLine + 1] : SIZE_MAX;
+		for (size_t nBoundary = CHUNK; nBoundary < pFile.GetTextSize(); nBoundary += CHUNK)
+		{
+			// Lines starting near a boundary, and the one running across it
+			if (((nStart + 4096 >= nBoundary) && (nStart <= nBoundary + 4096)) || ((nStart < nBoundary) && (nNext > nBoundary)))
+			{
+				vecToCheck.push_back(nLine);
+			}
+		}
+	}
+	CTestRandom pRandom(nSeed);
+	for (int nRound = 0; nRound < 2000; nRound++)
+	{
+		vecToCheck.push_back(pRandom.Range(0, vecLines.size() - 1));
+	}
+
+	std::wstring strLine;
+	size_t nMismatches = 0;
+	for (const uint64_t nLine : vecToCheck)
+	{
+		const uint64_t nLength = pFile.GetLine(nLine, strLine, 100000);
+		const std::wstring& strExpected = vecLines[static_cast<size_t>(nLine)];
+		nMismatches += ((nLength != strExpected.size()) || (strLine != strExpected.substr(0, 100000))) ? 1 : 0;
+	}
+	TEST_CHECK(nMismatches == 0);
+	TEST_CHECK(pFile.GetLine(vecLines.size(), strLine) == 0);
+}
+
+/**
+ * @brief Log lines with a few accented, Cyrillic and symbol characters, ended by CRLF or LF.
+ */
+static void AppendRandomLine(CTestRandom& pRandom, std::string& strText)
+{
+	static const char* const lpszWords[] = { "temp=", "23.5", " OK ", "ERROR ", "sensor", "\xC3\xA9t\xC3\xA9 ", "\xD0\xB4\xD0\xB0 ", "\xE2\x82\xAC ", "\t" };
+	for (uint64_t nWord = pRandom.Range(0, 12); nWord > 0; nWord--)
+	{
+		strText += lpszWords[pRandom.Range(0, 8)];
+	}
+	strText += (pRandom.Range(0, 1) == 0) ? "\r\n" : "\n";
+}
+
+/**
+ * @brief Splits UTF-8 text into lines the way the file does.
+ */
+static CExpectedLines SplitUtf8(const std::string& strText)
+{
+	CExpectedLines pExpected;
+	size_t nStart = 0;
+	for (;;)
+	{
+		const size_t nBreak = strText.find('\n', nStart);
+		size_t nEnd = (nBreak == std::string::npos) ? strText.size() : nBreak;
+		if ((nEnd > nStart) && (strText[nEnd - 1] == '\r'))
+		{
+			nEnd--;
+		}
+		std::wstring strLine;
+		CUtf8Decoder pDecoder;
+		pDecoder.Decode(strText.data() + nStart, nEnd - nStart, strLine);
+		pExpected.vecLines.push_back(strLine);
+		pExpected.vecStarts.push_back(nStart);
+		if ((nBreak == std::string::npos) || (nBreak + 1 == strText.size()))
+		{
+			break;
+		}
+		nStart = nBreak + 1;
+	}
+	return pExpected;
+}
+
+/**
+ * @brief A UTF-8 file of three chunks and a bit: a CRLF split by the first
+ * chunk boundary, an LF as the last byte of the second chunk, a line longer
+ * than the third chunk (which holds no LF at all), and no final line break.
+ */
+static void TestUtf8()
+{
+	CTestRandom pRandom(16);
+	std::string strText;
+	while (strText.size() < CHUNK - 200)
+	{
+		AppendRandomLine(pRandom, strText);
+	}
+	strText.append(CHUNK - 1 - strText.size(), 'x');
+	strText += "\r\n"; // CR last of chunk 0, LF first of chunk 1
+	while (strText.size() < 2 * CHUNK - 200)
+	{
+		AppendRandomLine(pRandom, strText);
+	}
+	strText.append(2 * CHUNK - 1 - strText.size(), 'y');
+	strText += '\n'; // last byte of chunk 1
+	const size_t nLongest = CHUNK + 1000;
+	strText.append(nLongest, 'z');
+	strText += '\n';
+	for (int nLine = 0; nLine < 1000; nLine++)
+	{
+		AppendRandomLine(pRandom, strText);
+	}
+	strText += "the last line, without a line break \xE2\x82\xAC";
+	TEST_CHECK((strText[CHUNK - 1] == '\r') && (strText[CHUNK] == '\n') && (strText[2 * CHUNK - 1] == '\n'));
+
+	const std::string strPath = WriteTempFile(std::vector<uint8_t>(strText.begin(), strText.end()));
+	const CExpectedLines pExpected = SplitUtf8(strText);
+	CMappedTextFile pFile;
+	TEST_CHECK(OpenMapped(pFile, strPath));
+	TEST_CHECK(pFile.GetSize() == strText.size());
+	std::atomic<int> nProgress(0);
+	pFile.StartIndexing(CMappedTextFile::MAPPED_TEXT_UTF8, 0, [&]() { nProgress++; });
+	TEST_CHECK(WaitIndexed(pFile));
+	TEST_CHECK(nProgress.load() >= 1);
+	TEST_CHECK(!pFile.EndsWithLineBreak());
+	CheckLines(pFile, pExpected, nLongest, 1);
+
+	// The line longer than a chunk: a clipped copy costs little and reports the whole length
+	size_t nLong = 0;
+	while (pExpected.vecLines[nLong].size() != nLongest)
+	{
+		nLong++;
+	}
+	std::wstring strLine;
+	TEST_CHECK(pFile.GetLine(nLong, strLine, 80) == nLongest);
+	TEST_CHECK(strLine == std::wstring(80, L'z'));
+	TEST_CHECK(pFile.GetLine(nLong, strLine) == nLongest);
+	TEST_CHECK(strLine.size() == nLongest);
+	pFile.Close();
+	unlink(strPath.c_str());
+}
+
+/**
+ * @brief A UTF-16 file a little over a chunk, in either byte order, with
+ * code units whose other half is 0x0A or 0x0D (U+0A41, U+410A, U+0D0A,
+ * U+0A0D, U+0A0A) and a CRLF split by the chunk boundary.
+ */
+static void TestUtf16(bool bBigEndian)
+{
+	static const uint16_t nTricky[] = { 0x0A41, 0x410A, 0x0D0A, 0x0A0D, 0x0A0A, 0x0D00, 0x0A00 };
+	CTestRandom pRandom(bBigEndian ? 17 : 18);
+	std::vector<uint16_t> vecUnits;
+	const auto pfnAppendLine = [&]()
+	{
+		for (uint64_t nUnit = pRandom.Range(0, 60); nUnit > 0; nUnit--)
+		{
+			vecUnits.push_back((pRandom.Range(0, 3) == 0) ? nTricky[pRandom.Range(0, 6)] : static_cast<uint16_t>(pRandom.Range('a', 'z')));
+		}
+		if (pRandom.Range(0, 1) == 0)
+		{
+			vecUnits.push_back('\r');
+		}
+		vecUnits.push_back('\n');
+	};
+	const size_t nBoundary = CHUNK / 2; // in code units
+	while (vecUnits.size() < nBoundary - 100)
+	{
+		pfnAppendLine();
+	}
+	vecUnits.insert(vecUnits.end(), nBoundary - 1 - vecUnits.size(), 'w');
+	vecUnits.push_back('\r'); // last unit of chunk 0
+	vecUnits.push_back('\n'); // first unit of chunk 1
+	while (vecUnits.size() < nBoundary + (1 << 19))
+	{
+		pfnAppendLine();
+	}
+	TEST_CHECK((vecUnits[nBoundary - 1] == '\r') && (vecUnits[nBoundary] == '\n'));
+
+	// Byte order mark, the text, and an odd byte that is not a character
+	std::vector<uint8_t> vecBytes;
+	vecBytes.push_back(bBigEndian ? 0xFE : 0xFF);
+	vecBytes.push_back(bBigEndian ? 0xFF : 0xFE);
+	for (const uint16_t nUnit : vecUnits)
+	{
+		vecBytes.push_back(static_cast<uint8_t>(bBigEndian ? (nUnit >> 8) : nUnit));
+		vecBytes.push_back(static_cast<uint8_t>(bBigEndian ? nUnit : (nUnit >> 8)));
+	}
+	vecBytes.push_back('\n');
+
+	// Split on the 0x000A code unit only
+	CExpectedLines pExpected;
+	uint64_t nLongest = 0;
+	std::wstring strLine;
+	size_t nStart = 0;
+	for (size_t nIndex = 0; nIndex < vecUnits.size(); nIndex++)
+	{
+		if (vecUnits[nIndex] != '\n')
+		{
+			strLine += static_cast<wchar_t>(vecUnits[nIndex]);
+			continue;
+		}
+		nLongest = std::max<uint64_t>(nLongest, nIndex - nStart);
+		if (!strLine.empty() && (strLine.back() == L'\r'))
+		{
+			strLine.pop_back();
+		}
+		pExpected.vecLines.push_back(strLine);
+		pExpected.vecStarts.push_back(2 * nStart);
+		strLine.clear();
+		nStart = nIndex + 1;
+	}
+
+	const std::string strPath = WriteTempFile(vecBytes);
+	CMappedTextFile pFile;
+	TEST_CHECK(OpenMapped(pFile, strPath));
+	pFile.StartIndexing(bBigEndian ? CMappedTextFile::MAPPED_TEXT_UTF16BE : CMappedTextFile::MAPPED_TEXT_UTF16LE, 2, nullptr);
+	TEST_CHECK(WaitIndexed(pFile));
+	TEST_CHECK(pFile.GetTextSize() == 2 * vecUnits.size());
+	// A line break at the very end does not start another line
+	TEST_CHECK(pFile.EndsWithLineBreak());
+	CheckLines(pFile, pExpected, nLongest, bBigEndian ? 3 : 2);
+	pFile.Close();
+	unlink(strPath.c_str());
+}
+
+/**
+ * @brief Close() while the index is being built stops the threads between
+ * chunks; the object can then open and index a file again.
+ */
+static void TestCloseWhileIndexing()
+{
+	std::vector<uint8_t> vecBytes;
+	const char* lpszLine = "2026-10-17 12:00:00 sensor 4: temp=21.5 C, status OK\r\n";
+	while (vecBytes.size() < 4 * CHUNK)
+	{
+		vecBytes.insert(vecBytes.end(), lpszLine, lpszLine + strlen(lpszLine));
+	}
+	const uint64_t nLines = vecBytes.size() / strlen(lpszLine);
+	const std::string strPath = WriteTempFile(vecBytes);
+
+	CMappedTextFile pFile;
+	TEST_CHECK(OpenMapped(pFile, strPath));
+	std::atomic<int> nProgress(0);
+	// A slow consumer of the progress: the UI thread is busy
+	pFile.StartIndexing(CMappedTextFile::MAPPED_TEXT_UTF8, 0, [&]()
+	{
+		nProgress++;
+		std::this_thread::sleep_for(std::chrono::milliseconds(100));
+	});
+	std::this_thread::sleep_for(std::chrono::milliseconds(5));
+	CTestStopwatch pStopwatch;
+	pFile.Close();
+	const double fClose = pStopwatch.GetSeconds();
+	printf("Close() during indexing returned in %.0f ms after %d of 5 chunks\n", fClose * 1e3, nProgress.load());
+	TEST_CHECK(fClose < 2.0);
+	TEST_CHECK(nProgress.load() < 5);
+	const int nProgressAtClose = nProgress.load();
+	std::this_thread::sleep_for(std::chrono::milliseconds(50));
+	TEST_CHECK(nProgress.load() == nProgressAtClose);
+	TEST_CHECK(!pFile.IsOpen());
+	TEST_CHECK(pFile.GetLineCount() == 1);
+	std::wstring strLine;
+	TEST_CHECK(pFile.GetLine(0, strLine) == 0);
+	pFile.Close(); // twice is harmless
+
+	// Reopened, the whole file is indexed
+	TEST_CHECK(OpenMapped(pFile, strPath));
+	pFile.StartIndexing(CMappedTextFile::MAPPED_TEXT_UTF8, 0, nullptr);
+	TEST_CHECK(WaitIndexed(pFile));
+	TEST_CHECK(pFile.GetLineCount() == nLines);
+	TEST_CHECK(pFile.GetLine(nLines - 1, strLine) == strlen(lpszLine) - 2);
+
+	// Destroyed while indexing: the destructor closes
+	{
+		CMappedTextFile pOther;
+		TEST_CHECK(OpenMapped(pOther, strPath));
+		pOther.StartIndexing(CMappedTextFile::MAPPED_TEXT_UTF8, 0, nullptr);
+	}
+	pFile.Close();
+	unlink(strPath.c_str());
+
+	// An empty file is not mapped
+	const std::string strEmpty = WriteTempFile(std::vector<uint8_t>());
+	TEST_CHECK(!OpenMapped(pFile, strEmpty));
+	unlink(strEmpty.c_str());
+}
+
+int main()
+{
+	setvbuf(stdout, nullptr, _IONBF, 0);
+	TestUtf8();
+	TestUtf16(false);
+	TestUtf16(true);
+	TestCloseWhileIndexing();
+	return TEST_RESULT();
+}
@@ -0,0 +1,220 @@
+/* Copyright (C) 2014-2026 Stefan-Mihai MOGA
+This file is part of IntelliPort application developed by Stefan-Mihai MOGA.
+IntelliPort is an alternative Windows version to the famous HyperTerminal!
+
+IntelliPort is free software: you can redistribute it and/or modify it
+under the terms of the GNU General Public License as published by the Open
+Source Initiative, either version 3 of the License, or any later version.
+
+IntelliPort is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+IntelliPort. If not, see <http://www.opensource.org/licenses/gpl-3.0.html>*/
+
+// ReceiveBufferSpillTest.cpp : bursts larger than the ring buffer spilled to disk, against a slow consumer
+//
+
+#include "ReceiveBuffer.h"
+#include "UnitTest.h"
+
+#include <algorithm>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+static char Pattern(uint64_t nOffset)
+{
+	return static_cast<char>((nOffset * 13) ^ (nOffset >> 12));
+}
+
+/**
+ * @brief Reads everything through PeekReadable/Consume, checking each byte against the pattern.
+ * @param nPause Microseconds to sleep after every nPauseEvery bytes, to make the consumer slow.
+ */
+static void Consume(CReceiveBuffer& pBuffer, uint64_t nTotal, uint64_t& nRead, uint64_t& nMismatches, int nPause, uint64_t nPauseEvery)
+{
+	uint64_t nNextPause = nPauseEvery;
+	while (nRead < nTotal)
+	{
+		CRingBufferSpan pSpans[2];
+		const int nLength = pBuffer.PeekReadable(pSpans);
+		if (nLength == 0)
+		{
+			std::this_thread::yield();
+			continue;
+		}
+		uint64_t nOffset = nRead;
+		for (const CRingBufferSpan& span : pSpans)
+		{
+			for (int nByte = 0; nByte < span.nLength; nByte++)
+			{
+				nMismatches += (span.pData[nByte] != Pattern(nOffset + nByte)) ? 1 : 0;
+			}
+			nOffset += span.nLength;
+		}
+		pBuffer.Consume(nLength);
+		nRead += nLength;
+		if ((nPause > 0) && (nRead >= nNextPause))
+		{
+			nNextPause += nPauseEvery;
+			std::this_thread::sleep_for(std::chrono::microseconds(nPause));
+		}
+	}
+}
+
+/**
+ * @brief A 100 MB burst into a 1 MB ring buffer with a consumer that keeps falling behind.
+ *
+ * The producer must never wait and nothing may be lost: every byte arrives, in
+ * order, and the counters add up to the burst.
+ */
+static void TestBurstNoLoss()
+{
+	const uint64_t nTotal = 100 << 20;
+	CReceiveBuffer pBuffer;
+	TEST_CHECK(pBuffer.Create(0x100000));
+	pBuffer.SetPolicy(CReceiveBuffer::OVERFLOW_SPILL);
+
+	uint64_t nRead = 0, nMismatches = 0;
+	std::thread pConsumer([&]() { Consume(pBuffer, nTotal, nRead, nMismatches, 200, 256 << 10); });
+
+	// Chunks of uneven sizes, like reads from a socket
+	CTestRandom pRandom(11);
+	std::vector<char> vecChunk(0x10000);
+	int nWaits = 0;
+	bool bStored = true;
+	CTestStopwatch pStopwatch;
+	for (uint64_t nOffset = 0; nOffset < nTotal; )
+	{
+		const int nLength = static_cast<int>(std::min<uint64_t>(pRandom.Range(1, 0x10000), nTotal - nOffset));
+		for (int nByte = 0; nByte < nLength; nByte++)
+		{
+			vecChunk[nByte] = Pattern(nOffset + nByte);
+		}
+		bStored = pBuffer.Write(vecChunk.data(), nLength, [&nWaits]() { nWaits++; return true; }) && bStored;
+		nOffset += nLength;
+	}
+	const double fProducer = pStopwatch.GetSeconds();
+	pConsumer.join();
+	const double fConsumer = pStopwatch.GetSeconds();
+
+	const CReceiveBufferStats stats = pBuffer.GetStats();
+	printf("100 MB burst: produced in %.2f s, consumed in %.2f s, %.1f MB spilled, high water %.2f MB\n",
+		fProducer, fConsumer, stats.nBytesSpilled / 1048576.0, stats.nHighWaterMark / 1048576.0);
+	TEST_CHECK(bStored);
+	TEST_CHECK(nWaits == 0);
+	TEST_CHECK(nRead == nTotal);
+	TEST_CHECK(nMismatches == 0);
+	TEST_CHECK(stats.nBytesReceived == nTotal);
+	TEST_CHECK(stats.nBytesDropped == 0);
+	TEST_CHECK(stats.nBytesSpilled > nTotal / 2);
+	TEST_CHECK(stats.nHighWaterMark <= 0x100000);
+	TEST_CHECK(pBuffer.GetTotalWritten() == nTotal);
+	TEST_CHECK(pBuffer.GetTotalRead() == nTotal);
+
+	// Once the segment is drained the producer is back on the ring buffer
+	const char pTail[] = "tail";
+	TEST_CHECK(pBuffer.Write(pTail, 4, []() { return true; }));
+	TEST_CHECK(pBuffer.GetStats().nBytesSpilled == stats.nBytesSpilled);
+	CRingBufferSpan pSpans[2];
+	TEST_CHECK((pBuffer.PeekReadable(pSpans) == 4) && (memcmp(pSpans[0].pData, pTail, 4) == 0));
+	pBuffer.Consume(4);
+}
+
+/**
+ * @brief With a spill limit, exactly the bytes past the ring buffer and the limit are dropped,
+ * and the consumer still reads an unbroken prefix.
+ */
+static void TestSpillLimit()
+{
+	const uint64_t nTotal = 32 << 20;
+	const uint64_t nLimit = 8 << 20;
+	CReceiveBuffer pBuffer;
+	TEST_CHECK(pBuffer.Create(0x100000));
+	pBuffer.SetPolicy(CReceiveBuffer::OVERFLOW_SPILL, nLimit);
+	const uint64_t nCapacity = static_cast<uint64_t>(pBuffer.GetCapacity());
+
+	// Nobody reads during the burst
+	std::vector<char> vecChunk(0x8000);
+	for (uint64_t nOffset = 0; nOffset < nTotal; nOffset += vecChunk.size())
+	{
+		for (size_t nByte = 0; nByte < vecChunk.size(); nByte++)
+		{
+			vecChunk[nByte] = Pattern(nOffset + nByte);
+		}
+		pBuffer.Write(vecChunk.data(), static_cast<int>(vecChunk.size()), []() { return true; });
+	}
+	const CReceiveBufferStats stats = pBuffer.GetStats();
+	TEST_CHECK(stats.nBytesReceived == nTotal);
+	TEST_CHECK(stats.nBytesSpilled == nLimit);
+	TEST_CHECK(stats.nBytesDropped == nTotal - nCapacity - nLimit);
+
+	uint64_t nRead = 0, nMismatches = 0;
+	Consume(pBuffer, nCapacity + nLimit, nRead, nMismatches, 0, 1);
+	TEST_CHECK(nRead == nCapacity + nLimit);
+	TEST_CHECK(nMismatches == 0);
+	CRingBufferSpan pSpans[2];
+	TEST_CHECK(pBuffer.PeekReadable(pSpans) == 0);
+}
+
+/**
+ * @brief A spilled backlog left behind by a producer that went quiet is read by
+ * Drain() in full, a frame's limit at a time, each call saying whether more is left.
+ */
+static void TestDrainAfterProducerStops()
+{
+	const uint64_t nTotal = 8 << 20;
+	const size_t nFrameLimit = 1 << 20;
+	CReceiveBuffer pBuffer;
+	TEST_CHECK(pBuffer.Create(0x10000));
+	pBuffer.SetPolicy(CReceiveBuffer::OVERFLOW_SPILL);
+
+	// Far more than the ring buffer and one stage of the spill segment, then silence
+	std::vector<char> vecChunk(0x8000);
+	for (uint64_t nOffset = 0; nOffset < nTotal; nOffset += vecChunk.size())
+	{
+		for (size_t nByte = 0; nByte < vecChunk.size(); nByte++)
+		{
+			vecChunk[nByte] = Pattern(nOffset + nByte);
+		}
+		pBuffer.Write(vecChunk.data(), static_cast<int>(vecChunk.size()), []() { return true; });
+	}
+	TEST_CHECK(pBuffer.GetStats().nBytesSpilled > nTotal - 0x10000 - 1);
+
+	// As the UI thread does: one Drain() per wakeup, woken again while it returns true
+	uint64_t nRead = 0, nMismatches = 0;
+	int nWakeups = 0;
+	bool bMore = true;
+	while (bMore && (nWakeups < 100))
+	{
+		const uint64_t nStart = nRead;
+		bMore = pBuffer.Drain(nFrameLimit, [&](const char* pData, int nLength)
+		{
+			for (int nByte = 0; nByte < nLength; nByte++)
+			{
+				nMismatches += (pData[nByte] != Pattern(nRead + nByte)) ? 1 : 0;
+			}
+			nRead += nLength;
+		});
+		nWakeups++;
+		TEST_CHECK(nRead - nStart <= nFrameLimit + CReceiveBuffer::RECEIVE_BUFFER_STAGE_SIZE);
+		TEST_CHECK(bMore == (nRead < nTotal));
+	}
+	printf("%llu MB spilled backlog drained in %d frames\n", static_cast<unsigned long long>(nTotal >> 20), nWakeups);
+	TEST_CHECK(nRead == nTotal);
+	TEST_CHECK(nMismatches == 0);
+	TEST_CHECK(nWakeups == static_cast<int>(nTotal / nFrameLimit));
+	TEST_CHECK(pBuffer.GetTotalRead() == nTotal);
+	TEST_CHECK(!pBuffer.Drain(nFrameLimit, [](const char*, int) {}));
+}
+
+int main()
+{
+	setvbuf(stdout, nullptr, _IONBF, 0);
+	TestBurstNoLoss();
+	TestSpillLimit();
+	TestDrainAfterProducerStops();
+	return TEST_RESULT();
+}
@@ -0,0 +1,141 @@
+/* Copyright (C) 2014-2026 Stefan-Mihai MOGA
+This file is part of IntelliPort application developed by Stefan-Mihai MOGA.
+IntelliPort is an alternative Windows version to the famous HyperTerminal!
+
+IntelliPort is free software: you can redistribute it and/or modify it
+under the terms of the GNU General Public License as published by the Open
+Source Initiative, either version 3 of the License, or any later version.
+
+IntelliPort is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+IntelliPort. If not, see <http://www.opensource.org/licenses/gpl-3.0.html>*/
+
+// RingBufferBenchmark.cpp : throughput and latency of CRingBuffer, lock-free against mutex-guarded
+//
+
+#include "RingBuffer.h"
+#include "UnitTest.h"
+
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief The ring as the reader threads used it before it was lock-free:
+ * every WriteBinary and ReadBinary under one shared mutex.
+ */
+class CLockedRing
+{
+public:
+	bool Create(int nSize) { return m_pRing.Create(nSize); }
+	bool WriteBinary(const char* pBuf, int nBufLen)
+	{
+		std::lock_guard<std::mutex> pLock(m_pMutex);
+		return m_pRing.WriteBinary(pBuf, nBufLen);
+	}
+	bool ReadBinary(char* pBuf, int nBufLen)
+	{
+		std::lock_guard<std::mutex> pLock(m_pMutex);
+		return m_pRing.ReadBinary(pBuf, nBufLen);
+	}
+	int GetMaxReadSize()
+	{
+		std::lock_guard<std::mutex> pLock(m_pMutex);
+		return m_pRing.GetMaxReadSize();
+	}
+
+protected:
+	std::mutex m_pMutex;
+	CRingBuffer m_pRing;
+};
+
+/**
+ * @brief Producer writes nChunk-byte blocks, consumer reads whatever is there; returns MB/s.
+ */
+template <class Ring>
+static double MeasureThroughput(Ring& pRing, int nChunk, size_t nTotal)
+{
+	std::vector<char> vecSource(nChunk, 'x');
+	CTestStopwatch pStopwatch;
+	std::thread pProducer([&]() {
+		for (size_t nWritten = 0; nWritten < nTotal; )
+		{
+			if (pRing.WriteBinary(vecSource.data(), nChunk))
+				nWritten += nChunk;
+			else
+				std::this_thread::yield();
+		}
+	});
+	std::vector<char> vecTarget(0x10000);
+	for (size_t nRead = 0; nRead < nTotal; )
+	{
+		const int nUsed = pRing.GetMaxReadSize();
+		if ((nUsed > 0) && pRing.ReadBinary(vecTarget.data(), nUsed))
+			nRead += nUsed;
+		else
+			std::this_thread::yield();
+	}
+	pProducer.join();
+	return nTotal / pStopwatch.GetSeconds() / 1e6;
+}
+
+/**
+ * @brief Ping-pong of an 8-byte message through two rings; returns the mean round trip in microseconds.
+ */
+template <class Ring>
+static double MeasureRoundTrip(Ring& pRequest, Ring& pReply, int nRounds)
+{
+	std::thread pEcho([&]() {
+		uint64_t nValue = 0;
+		for (int nRound = 0; nRound < nRounds; nRound++)
+		{
+			while (!pRequest.ReadBinary(reinterpret_cast<char*>(&nValue), sizeof(nValue)))
+				std::this_thread::yield();
+			while (!pReply.WriteBinary(reinterpret_cast<const char*>(&nValue), sizeof(nValue)))
+				std::this_thread::yield();
+		}
+	});
+	CTestStopwatch pStopwatch;
+	for (uint64_t nRound = 0; nRound < static_cast<uint64_t>(nRounds); nRound++)
+	{
+		uint64_t nValue = nRound;
+		while (!pRequest.WriteBinary(reinterpret_cast<const char*>(&nValue), sizeof(nValue)))
+			std::this_thread::yield();
+		while (!pReply.ReadBinary(reinterpret_cast<char*>(&nValue), sizeof(nValue)))
+			std::this_thread::yield();
+	}
+	const double fSeconds = pStopwatch.GetSeconds();
+	pEcho.join();
+	return fSeconds * 1e6 / nRounds;
+}
+
+int main(int argc, char* argv[])
+{
+	setvbuf(stdout, nullptr, _IONBF, 0);
+	const size_t nTotal = static_cast<size_t>((argc > 1) ? atoi(argv[1]) : 512) << 20;
+	const int nRounds = 200000;
+	printf("%-10s %8s %14s %14s\n", "ring", "chunk", "MB/s", "round trip us");
+	for (int nChunk : { 16, 256, 4096 })
+	{
+		CRingBuffer pLockFree;
+		pLockFree.Create(0x10000);
+		CLockedRing pLocked;
+		pLocked.Create(0x10000);
+		printf("%-10s %8d %14.1f\n", "lock-free", nChunk, MeasureThroughput(pLockFree, nChunk, nTotal));
+		printf("%-10s %8d %14.1f\n", "mutex", nChunk, MeasureThroughput(pLocked, nChunk, nTotal));
+	}
+	{
+		CRingBuffer pRequest, pReply;
+		pRequest.Create(4096);
+		pReply.Create(4096);
+		printf("%-10s %8d %14s %14.2f\n", "lock-free", 8, "", MeasureRoundTrip(pRequest, pReply, nRounds));
+		CLockedRing pLockedRequest, pLockedReply;
+		pLockedRequest.Create(4096);
+		pLockedReply.Create(4096);
+		printf("%-10s %8d %14s %14.2f\n", "mutex", 8, "", MeasureRoundTrip(pLockedRequest, pLockedReply, nRounds));
+	}
+	return 0;
+}
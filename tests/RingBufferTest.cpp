@@ -0,0 +1,164 @@
+/* Copyright (C) 2014-2026 Stefan-Mihai MOGA
+This file is part of IntelliPort application developed by Stefan-Mihai MOGA.
+IntelliPort is an alternative Windows version to the famous HyperTerminal!
+
+IntelliPort is free software: you can redistribute it and/or modify it
+under the terms of the GNU General Public License as published by the Open
+Source Initiative, either version 3 of the License, or any later version.
+
+IntelliPort is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+IntelliPort. If not, see <http://www.opensource.org/licenses/gpl-3.0.html>*/
+
+// RingBufferTest.cpp : single-producer/single-consumer stress test of CRingBuffer
+//
+
+#include "RingBuffer.h"
+#include "UnitTest.h"
+
+#include <thread>
+#include <vector>
+
+// Byte at a given stream position; not a power-of-two period, so a slot
+// that is read at the wrong offset does not match by accident.
+static inline char StreamByte(size_t nPosition)
+{
+	return static_cast<char>((nPosition * 131) ^ (nPosition / 251));
+}
+
+/**
+ * @brief Writes and reads random amounts on one thread, through both the copy and the span API.
+ */
+static void TestWrapAround(bool bMirrored)
+{
+	CRingBuffer pRing;
+	TEST_CHECK(pRing.Create(4096, bMirrored));
+	CTestRandom pRandom(bMirrored ? 7 : 3);
+	std::vector<char> vecBuffer(pRing.GetBufferSize());
+	size_t nWritten = 0, nRead = 0;
+
+	for (int nRound = 0; nRound < 20000; nRound++)
+	{
+		int nLength = static_cast<int>(pRandom.Range(0, pRing.GetMaxWriteSize()));
+		if (pRandom.Next() & 1)
+		{
+			for (int nIndex = 0; nIndex < nLength; nIndex++)
+				vecBuffer[nIndex] = StreamByte(nWritten + nIndex);
+			TEST_CHECK(pRing.WriteBinary(vecBuffer.data(), nLength));
+		}
+		else
+		{
+			CRingBufferSpan pSpans[2];
+			TEST_CHECK(pRing.PrepareWrite(pSpans) >= nLength);
+			TEST_CHECK(!bMirrored || (pSpans[1].nLength == 0));
+			for (int nIndex = 0; nIndex < nLength; nIndex++)
+			{
+				char* pSlot = (nIndex < pSpans[0].nLength) ? &pSpans[0].pData[nIndex] : &pSpans[1].pData[nIndex - pSpans[0].nLength];
+				*pSlot = StreamByte(nWritten + nIndex);
+			}
+			pRing.CommitWrite(nLength);
+		}
+		nWritten += nLength;
+		TEST_CHECK(!pRing.WriteBinary(vecBuffer.data(), pRing.GetMaxWriteSize() + 1));
+
+		nLength = static_cast<int>(pRandom.Range(0, pRing.GetMaxReadSize()));
+		if (pRandom.Next() & 1)
+		{
+			TEST_CHECK(pRing.ReadBinary(vecBuffer.data(), nLength));
+			for (int nIndex = 0; nIndex < nLength; nIndex++)
+				TEST_CHECK(vecBuffer[nIndex] == StreamByte(nRead + nIndex));
+		}
+		else
+		{
+			CRingBufferSpan pSpans[2];
+			TEST_CHECK(pRing.PeekReadable(pSpans) >= nLength);
+			for (int nIndex = 0; nIndex < nLength; nIndex++)
+			{
+				const char* pSlot = (nIndex < pSpans[0].nLength) ? &pSpans[0].pData[nIndex] : &pSpans[1].pData[nIndex - pSpans[0].nLength];
+				TEST_CHECK(*pSlot == StreamByte(nRead + nIndex));
+			}
+			pRing.Consume(nLength);
+		}
+		nRead += nLength;
+		TEST_CHECK(pRing.GetTotalWritten() == nWritten);
+		TEST_CHECK(pRing.GetTotalRead() == nRead);
+	}
+}
+
+/**
+ * @brief Moves nTotal bytes from a producer thread to a consumer thread and checks every byte.
+ */
+static void TestProducerConsumer(bool bMirrored, size_t nTotal)
+{
+	CRingBuffer pRing;
+	TEST_CHECK(pRing.Create(0x10000, bMirrored));
+
+	std::thread pProducer([&pRing, nTotal]() {
+		CTestRandom pRandom(11);
+		size_t nWritten = 0;
+		while (nWritten < nTotal)
+		{
+			CRingBufferSpan pSpans[2];
+			const int nFree = pRing.PrepareWrite(pSpans);
+			if (nFree == 0)
+			{
+				std::this_thread::yield();
+				continue;
+			}
+			// random chunk sizes, so the wrap point moves around
+			int nLength = static_cast<int>(pRandom.Range(1, 3000));
+			if (nLength > nFree)
+				nLength = nFree;
+			if (static_cast<size_t>(nLength) > nTotal - nWritten)
+				nLength = static_cast<int>(nTotal - nWritten);
+			for (int nIndex = 0; nIndex < nLength; nIndex++)
+			{
+				char* pSlot = (nIndex < pSpans[0].nLength) ? &pSpans[0].pData[nIndex] : &pSpans[1].pData[nIndex - pSpans[0].nLength];
+				*pSlot = StreamByte(nWritten + nIndex);
+			}
+			pRing.CommitWrite(nLength);
+			nWritten += nLength;
+		}
+	});
+
+	size_t nRead = 0, nMismatches = 0;
+	while (nRead < nTotal)
+	{
+		CRingBufferSpan pSpans[2];
+		const int nUsed = pRing.PeekReadable(pSpans);
+		if (nUsed == 0)
+		{
+			std::this_thread::yield();
+			continue;
+		}
+		for (int nSpan = 0; nSpan < 2; nSpan++)
+		{
+			for (int nIndex = 0; nIndex < pSpans[nSpan].nLength; nIndex++)
+			{
+				if (pSpans[nSpan].pData[nIndex] != StreamByte(nRead))
+					nMismatches++;
+				nRead++;
+			}
+		}
+		pRing.Consume(nUsed);
+	}
+	pProducer.join();
+
+	TEST_CHECK(nMismatches == 0);
+	TEST_CHECK(nRead == nTotal);
+	TEST_CHECK(pRing.GetMaxReadSize() == 0);
+	printf("%s ring: %zu bytes passed between threads, %zu mismatches\n", bMirrored ? "mirrored" : "plain", nRead, nMismatches);
+}
+
+int main()
+{
+	setvbuf(stdout, nullptr, _IONBF, 0);
+	TestWrapAround(false);
+	TestWrapAround(true);
+	TestProducerConsumer(false, 64 << 20);
+	TestProducerConsumer(true, 64 << 20);
+	return TEST_RESULT();
+}
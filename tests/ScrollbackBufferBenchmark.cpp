@@ -0,0 +1,105 @@
+/* Copyright (C) 2014-2026 Stefan-Mihai MOGA
+This file is part of IntelliPort application developed by Stefan-Mihai MOGA.
+IntelliPort is an alternative Windows version to the famous HyperTerminal!
+
+IntelliPort is free software: you can redistribute it and/or modify it
+under the terms of the GNU General Public License as published by the Open
+Source Initiative, either version 3 of the License, or any later version.
+
+IntelliPort is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+IntelliPort. If not, see <http://www.opensource.org/licenses/gpl-3.0.html>*/
+
+// ScrollbackBufferBenchmark.cpp : append rate, memory per line and line lookup time of the scrollback store
+//
+
+#include "ScrollbackBuffer.h"
+#include "UnitTest.h"
+
+#include <algorithm>
+#include <cwchar>
+#include <string>
+
+/**
+ * @brief Appends nLines log lines in 4 KB pieces, like the view's append path, then looks lines up at random.
+ */
+static void Measure(uint64_t nLines, uint64_t nMaxLines)
+{
+	// A few hundred distinct lines, cycled: compresses like a real device log
+	CTestRandom pRandom(9);
+	std::wstring strPattern;
+	for (int nLine = 0; nLine < 512; nLine++)
+	{
+		wchar_t lpszLine[128];
+		const int nLength = swprintf(lpszLine, 128, L"%08llu sensor %u: temp=%u.%u C, status %ls\r\n",
+			static_cast<unsigned long long>(pRandom.Next() % 100000000), static_cast<unsigned>(pRandom.Range(0, 15)),
+			static_cast<unsigned>(pRandom.Range(15, 40)), static_cast<unsigned>(pRandom.Range(0, 9)),
+			(pRandom.Range(0, 9) == 0) ? L"ERROR" : L"OK");
+		strPattern.append(lpszLine, nLength);
+	}
+	const uint64_t nPatternLines = 512;
+
+	CScrollbackBuffer pBuffer;
+	pBuffer.SetLimits(nMaxLines, 0);
+	const size_t nPiece = 4096;
+	uint64_t nChars = 0;
+	size_t nOffset = 0;
+	CTestStopwatch pStopwatch;
+	for (uint64_t nLine = 0; nLine < nLines; nLine += nPatternLines)
+	{
+		for (nOffset = 0; nOffset < strPattern.size(); nOffset += nPiece)
+		{
+			const size_t nLength = std::min(nPiece, strPattern.size() - nOffset);
+			pBuffer.Append(strPattern.data() + nOffset, nLength);
+			nChars += nLength;
+		}
+	}
+	const double fAppend = pStopwatch.GetSeconds();
+
+	// Random lines, as when dragging the scroll box
+	std::wstring strLine;
+	const int nLookups = 10000;
+	uint64_t nCopied = 0;
+	pStopwatch = CTestStopwatch();
+	for (int nLookup = 0; nLookup < nLookups; nLookup++)
+	{
+		nCopied += pBuffer.GetLine(pRandom.Range(0, pBuffer.GetLineCount() - 1), strLine, 200);
+	}
+	const double fLookup = pStopwatch.GetSeconds();
+
+	// One screen of 60 lines at the end, as when following new output
+	const int nScreens = 10000;
+	pStopwatch = CTestStopwatch();
+	for (int nScreen = 0; nScreen < nScreens; nScreen++)
+	{
+		for (uint64_t nLine = pBuffer.GetLineCount() - 60; nLine < pBuffer.GetLineCount(); nLine++)
+		{
+			nCopied += pBuffer.GetLine(nLine, strLine, 200);
+		}
+	}
+	const double fScreen = pStopwatch.GetSeconds();
+
+	printf("%12llu %10llu %10.1f %12.1f %10.1f %12.2f %12.2f %10.2f\n",
+		static_cast<unsigned long long>(nLines), static_cast<unsigned long long>(nMaxLines),
+		nChars / fAppend / 1e6, nLines / fAppend / 1e6, pBuffer.GetMemoryUsage() / 1048576.0,
+		static_cast<double>(pBuffer.GetMemoryUsage()) / pBuffer.GetLineCount(), fLookup / nLookups * 1e6, fScreen / nScreens * 1e6);
+	if (nCopied == 0)
+	{
+		printf("nothing copied\n");
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	setvbuf(stdout, nullptr, _IONBF, 0);
+	// Pass 100 for the 100 million line target
+	const uint64_t nMillions = (argc > 1) ? static_cast<uint64_t>(atoi(argv[1])) : 10;
+	printf("wchar_t: %zu bytes, page: %zu characters\n", sizeof(wchar_t), CScrollbackBuffer::SCROLLBACK_PAGE_SIZE);
+	printf("%12s %10s %10s %12s %10s %12s %12s %10s\n", "lines", "cap", "Mchar/s", "Mlines/s", "MB held", "bytes/line", "us/lookup", "us/screen");
+	Measure(nMillions * 1000000, 0);
+	Measure(nMillions * 1000000, 1000000);
+	return 0;
+}
@@ -0,0 +1,483 @@
+/* Copyright (C) 2014-2026 Stefan-Mihai MOGA
+This file is part of IntelliPort application developed by Stefan-Mihai MOGA.
+IntelliPort is an alternative Windows version to the famous HyperTerminal!
+
+IntelliPort is free software: you can redistribute it and/or modify it
+under the terms of the GNU General Public License as published by the Open
+Source Initiative, either version 3 of the License, or any later version.
+
+IntelliPort is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+IntelliPort. If not, see <http://www.opensource.org/licenses/gpl-3.0.html>*/
+
+// ScrollbackBufferTest.cpp : line index, eviction, compression and a capped soak against a plain string; block codec round trips
+//
+
+#include "ScrollbackBuffer.h"
+#include "UnitTest.h"
+
+#include <algorithm>
+#include <vector>
+
+static const size_t PAGE = CScrollbackBuffer::SCROLLBACK_PAGE_SIZE;
+
+/**
+ * @brief A CScrollbackBuffer that tells where its text starts and how many of its pages are held uncompressed.
+ */
+class CTestScrollback : public CScrollbackBuffer
+{
+public:
+	using CScrollbackBuffer::GetFirstOffset;
+
+	size_t GetPageCount() const
+	{
+		return m_vecPages.size();
+	}
+
+	size_t GetPlainPageCount() const
+	{
+		return static_cast<size_t>(std::count_if(m_vecPages.begin(), m_vecPages.end(),
+			[](const CScrollbackPage& pPage) { return pPage.pText != nullptr; }));
+	}
+};
+
+/**
+ * @brief Text like a device log: repetitive words, CRLF or LF, now and then a CR alone,
+ * and a few lines longer than a page.
+ */
+static std::wstring RandomText(CTestRandom& pRandom, size_t nLength)
+{
+	static const wchar_t* const lpszWords[] = { L"temp=", L"23.5", L" OK ", L"ERROR ", L"sensor", L"\x00E9t\x00E9 ", L"\x0434\x0430 ", L"0x7F3A ", L"\t" };
+	std::wstring strText;
+	while (strText.size() < nLength)
+	{
+		const uint64_t nKind = pRandom.Range(0, 99);
+		if (nKind < 70)
+		{
+			strText += lpszWords[pRandom.Range(0, 8)];
+		}
+		else if (nKind < 85)
+		{
+			strText += L"\r\n";
+		}
+		else if (nKind < 97)
+		{
+			strText += L'\n';
+		}
+		else if (nKind < 99)
+		{
+			strText += L'\r';
+		}
+		else
+		{
+			strText.append(static_cast<size_t>(pRandom.Range(1, 3 * PAGE)), L'=');
+		}
+	}
+	strText.resize(nLength);
+	return strText;
+}
+
+/**
+ * @brief Splits text into lines the way the buffer does: LF ends a line, a CR just before it is dropped.
+ */
+static std::vector<std::wstring> ReferenceLines(const std::wstring& strText)
+{
+	std::vector<std::wstring> vecLines(1);
+	for (wchar_t nChar : strText)
+	{
+		if (nChar == L'\n')
+		{
+			if (!vecLines.back().empty() && (vecLines.back().back() == L'\r'))
+			{
+				vecLines.back().pop_back();
+			}
+			vecLines.emplace_back();
+			continue;
+		}
+		vecLines.back() += nChar;
+	}
+	if (!vecLines.back().empty() && (vecLines.back().back() == L'\r'))
+	{
+		vecLines.back().pop_back();
+	}
+	return vecLines;
+}
+
+/**
+ * @brief Appends text in chunks of random sizes.
+ */
+static void AppendInPieces(CScrollbackBuffer& pBuffer, CTestRandom& pRandom, const std::wstring& strText)
+{
+	for (size_t nOffset = 0; nOffset < strText.size(); )
+	{
+		const size_t nLength = std::min<size_t>(static_cast<size_t>(pRandom.Range(1, 3000)), strText.size() - nOffset);
+		pBuffer.Append(strText.data() + nOffset, nLength);
+		nOffset += nLength;
+	}
+}
+
+/**
+ * @brief Checks every line and random ranges of text against the reference, over hot and compressed pages.
+ */
+static void TestIndexAndText()
+{
+	CTestRandom pRandom(14);
+	const std::wstring strText = RandomText(pRandom, 40 * PAGE + 1234);
+	const std::vector<std::wstring> vecLines = ReferenceLines(strText);
+	CScrollbackBuffer pBuffer;
+	AppendInPieces(pBuffer, pRandom, strText);
+
+	TEST_CHECK(pBuffer.GetLength() == strText.size());
+	TEST_CHECK(pBuffer.GetLineCount() == vecLines.size());
+	TEST_CHECK(pBuffer.GetDiscardedLines() == 0);
+	size_t nLongest = 0;
+	std::wstring strLine;
+	size_t nMismatches = 0, nStart = 0;
+	for (size_t nLine = 0; nLine < vecLines.size(); nLine++)
+	{
+		const uint64_t nLength = pBuffer.GetLine(nLine, strLine);
+		nMismatches += ((nLength != vecLines[nLine].size()) || (strLine != vecLines[nLine])) ? 1 : 0;
+		nMismatches += (pBuffer.GetLineStart(nLine) != nStart) ? 1 : 0;
+		nStart = strText.find(L'\n', nStart) + 1;
+		nLongest = std::max(nLongest, vecLines[nLine].size());
+	}
+	TEST_CHECK(nMismatches == 0);
+	TEST_CHECK(pBuffer.GetLineStart(vecLines.size()) == strText.size());
+	// The longest line counts a CR before its LF
+	TEST_CHECK((pBuffer.GetMaxLineLength() >= nLongest) && (pBuffer.GetMaxLineLength() <= nLongest + 1));
+
+	// A clipped copy still reports the whole length
+	for (size_t nLine = 0; nLine < vecLines.size(); nLine++)
+	{
+		if (vecLines[nLine].size() > 10)
+		{
+			TEST_CHECK(pBuffer.GetLine(nLine, strLine, 10) == vecLines[nLine].size());
+			TEST_CHECK(strLine == vecLines[nLine].substr(0, 10));
+			break;
+		}
+	}
+
+	// Random ranges, in random order, so cold pages go through the cache again and again
+	std::vector<wchar_t> vecOutput(3 * PAGE);
+	nMismatches = 0;
+	for (int nRound = 0; nRound < 500; nRound++)
+	{
+		const uint64_t nOffset = pRandom.Range(0, strText.size() - 1);
+		const size_t nLength = static_cast<size_t>(pRandom.Range(1, vecOutput.size()));
+		const size_t nCopied = pBuffer.GetText(nOffset, nLength, vecOutput.data());
+		nMismatches += (nCopied != std::min<size_t>(nLength, strText.size() - nOffset)) ? 1 : 0;
+		nMismatches += (strText.compare(static_cast<size_t>(nOffset), nCopied, vecOutput.data(), nCopied) != 0) ? 1 : 0;
+	}
+	TEST_CHECK(nMismatches == 0);
+	TEST_CHECK(pBuffer.GetText(strText.size(), 10, vecOutput.data()) == 0);
+
+	pBuffer.Clear();
+	TEST_CHECK((pBuffer.GetLength() == 0) && (pBuffer.GetLineCount() == 1));
+	TEST_CHECK(pBuffer.GetLine(0, strLine) == 0);
+}
+
+/**
+ * @brief The caps drop whole pages from the front; what is left is the tail of the text.
+ */
+static void TestEviction()
+{
+	CTestRandom pRandom(15);
+	const std::wstring strText = RandomText(pRandom, 30 * PAGE + 77);
+	const std::vector<std::wstring> vecLines = ReferenceLines(strText);
+
+	for (int nCase = 0; nCase < 2; nCase++)
+	{
+		const uint64_t nMaxLines = (nCase == 0) ? vecLines.size() / 5 : 0;
+		const uint64_t nMaxBytes = (nCase == 1) ? 7 * PAGE * sizeof(wchar_t) + 100 : 0;
+		CScrollbackBuffer pBuffer;
+		pBuffer.SetLimits(nMaxLines, nMaxBytes);
+		AppendInPieces(pBuffer, pRandom, strText);
+
+		const uint64_t nHeld = pBuffer.GetLength();
+		const uint64_t nFirst = strText.size() - nHeld;
+		TEST_CHECK(nFirst % PAGE == 0);
+		if (nMaxLines != 0)
+		{
+			TEST_CHECK(pBuffer.GetLineCount() <= nMaxLines);
+			// Within one page of the cap
+			TEST_CHECK(pBuffer.GetLineCount() + std::count(strText.begin() + (nFirst - PAGE), strText.begin() + nFirst, L'\n') > nMaxLines);
+		}
+		else
+		{
+			TEST_CHECK(nHeld * sizeof(wchar_t) <= nMaxBytes);
+			TEST_CHECK((nHeld + PAGE) * sizeof(wchar_t) > nMaxBytes);
+		}
+		const uint64_t nDropped = std::count(strText.begin(), strText.begin() + nFirst, L'\n');
+		TEST_CHECK(pBuffer.GetDiscardedLines() == nDropped);
+		TEST_CHECK(pBuffer.GetLineCount() == vecLines.size() - nDropped);
+
+		// Line 0 may start mid-line; the others are whole
+		std::wstring strLine;
+		size_t nMismatches = 0;
+		for (uint64_t nLine = 1; nLine < pBuffer.GetLineCount(); nLine++)
+		{
+			pBuffer.GetLine(nLine, strLine);
+			nMismatches += (strLine != vecLines[static_cast<size_t>(nDropped + nLine)]) ? 1 : 0;
+		}
+		TEST_CHECK(nMismatches == 0);
+		pBuffer.GetLine(0, strLine);
+		const std::wstring& strFirst = vecLines[static_cast<size_t>(nDropped)];
+		TEST_CHECK((strLine.size() <= strFirst.size()) && (strFirst.compare(strFirst.size() - strLine.size(), strLine.size(), strLine) == 0));
+		std::vector<wchar_t> vecOutput(static_cast<size_t>(nHeld));
+		TEST_CHECK(pBuffer.GetText(0, vecOutput.size(), vecOutput.data()) == nHeld);
+		TEST_CHECK(strText.compare(static_cast<size_t>(nFirst), static_cast<size_t>(nHeld), vecOutput.data(), static_cast<size_t>(nHeld)) == 0);
+
+		// Tightening the caps later drops more; appending after that keeps the numbering straight
+		pBuffer.SetLimits(0, 2 * PAGE * sizeof(wchar_t));
+		TEST_CHECK(pBuffer.GetLength() <= 2 * PAGE);
+		pBuffer.Append(L"\nlast", 5);
+		TEST_CHECK(pBuffer.GetLine(pBuffer.GetLineCount() - 1, strLine) == 4);
+		TEST_CHECK(strLine == L"last");
+	}
+}
+
+/**
+ * @brief Cold pages of repetitive text are compressed; random text is left as it is.
+ */
+static void TestCompression()
+{
+	const uint64_t nPageBytes = PAGE * sizeof(wchar_t);
+	CTestRandom pRandom(16);
+	CScrollbackBuffer pBuffer;
+	const std::wstring strText = RandomText(pRandom, 64 * PAGE);
+	AppendInPieces(pBuffer, pRandom, strText);
+	const uint64_t nRaw = strText.size() * sizeof(wchar_t);
+	const uint64_t nUsage = pBuffer.GetMemoryUsage();
+	printf("log text: %.1f MB held in %.2f MB (%.1f%%)\n", nRaw / 1048576.0, nUsage / 1048576.0, 100.0 * nUsage / nRaw);
+	TEST_CHECK(nUsage < nRaw / 3);
+	TEST_CHECK(nUsage >= CScrollbackBuffer::SCROLLBACK_HOT_PAGES * nPageBytes);
+
+	// Reading cold pages fills the cache, which never holds more than its pages
+	std::vector<wchar_t> vecOutput(PAGE);
+	size_t nMismatches = 0;
+	for (size_t nPage = 0; nPage < 20; nPage++)
+	{
+		TEST_CHECK(pBuffer.GetText(nPage * PAGE, PAGE, vecOutput.data()) == PAGE);
+		nMismatches += (strText.compare(nPage * PAGE, PAGE, vecOutput.data(), PAGE) != 0) ? 1 : 0;
+	}
+	TEST_CHECK(nMismatches == 0);
+	TEST_CHECK(pBuffer.GetMemoryUsage() == nUsage + CScrollbackBuffer::SCROLLBACK_CACHE_PAGES * nPageBytes);
+
+	// The run of a cached page stays valid while fewer than the cache's pages are read
+	const wchar_t* pSegment = nullptr;
+	TEST_CHECK(pBuffer.GetSegment(3 * PAGE + 5, pSegment) == PAGE - 5);
+	const wchar_t* pKept = pSegment;
+	for (size_t nPage = 4; nPage < 4 + CScrollbackBuffer::SCROLLBACK_CACHE_PAGES - 1; nPage++)
+	{
+		pBuffer.GetSegment(nPage * PAGE, pSegment);
+	}
+	TEST_CHECK(strText.compare(3 * PAGE + 5, PAGE - 5, pKept, PAGE - 5) == 0);
+
+	// Text that does not compress stays in plain pages
+	CScrollbackBuffer pRandomBuffer;
+	std::wstring strNoise(16 * PAGE, L' ');
+	for (wchar_t& nChar : strNoise)
+	{
+		nChar = static_cast<wchar_t>(pRandom.Next()); // every bit random, whatever the size of wchar_t
+	}
+	pRandomBuffer.Append(strNoise.data(), strNoise.size());
+	TEST_CHECK(pRandomBuffer.GetMemoryUsage() >= 16 * nPageBytes);
+	TEST_CHECK(pRandomBuffer.GetText(0, PAGE, vecOutput.data()) == PAGE);
+	TEST_CHECK(strNoise.compare(0, PAGE, vecOutput.data(), PAGE) == 0);
+}
+
+/**
+ * @brief A long session, time-compressed: about an hour and a half of a
+ * 115200 baud link appended under both caps while old lines are scrolled back
+ * into view. The text held, the pages held uncompressed and the memory used
+ * never grow past what the caps allow.
+ */
+static void TestSoak()
+{
+	const uint64_t nPageBytes = PAGE * sizeof(wchar_t);
+	const size_t nBlocks = 250;
+	CTestRandom pRandom(17);
+	CTestScrollback pBuffer;
+	// The line cap binds for the first half, the byte cap for the second
+	uint64_t nMaxLines = 1000;
+	uint64_t nMaxBytes = 48 * nPageBytes;
+	pBuffer.SetLimits(nMaxLines, nMaxBytes);
+	bool bLinesCapped = false, bBytesCapped = false;
+
+	std::wstring strRecent;                 // the tail of the text, longer than what the caps keep
+	uint64_t nAppended = 0, nLineBreaks = 0, nMostUsage = 0;
+	size_t nMostPlain = 0, nMismatches = 0, nOverCap = 0;
+	std::vector<wchar_t> vecOutput(2 * PAGE);
+	std::wstring strLine;
+	for (size_t nBlock = 0; nBlock < nBlocks; nBlock++)
+	{
+		if (nBlock == nBlocks / 2)
+		{
+			nMaxLines = 1000000;
+			nMaxBytes = 12 * nPageBytes;
+			pBuffer.SetLimits(nMaxLines, nMaxBytes);
+		}
+		const std::wstring strBlock = RandomText(pRandom, 4 * PAGE + static_cast<size_t>(pRandom.Range(0, PAGE)));
+		AppendInPieces(pBuffer, pRandom, strBlock);
+		nAppended += strBlock.size();
+		nLineBreaks += std::count(strBlock.begin(), strBlock.end(), L'\n');
+		strRecent += strBlock;
+		if (strRecent.size() > 64 * PAGE)
+		{
+			strRecent.erase(0, strRecent.size() - 64 * PAGE);
+		}
+
+		// Within the caps after every append, and so is the memory
+		const uint64_t nHeld = pBuffer.GetLength();
+		const uint64_t nBound = nMaxBytes + (1 + CScrollbackBuffer::SCROLLBACK_CACHE_PAGES) * nPageBytes +
+			(pBuffer.GetLineCount() / CScrollbackBuffer::SCROLLBACK_INDEX_STRIDE + 2) * sizeof(uint64_t);
+		nOverCap += (pBuffer.GetLineCount() > nMaxLines) ? 1 : 0;
+		nOverCap += (nHeld * sizeof(wchar_t) > nMaxBytes) ? 1 : 0;
+		nOverCap += (pBuffer.GetPlainPageCount() > CScrollbackBuffer::SCROLLBACK_HOT_PAGES) ? 1 : 0;
+		nOverCap += (pBuffer.GetMemoryUsage() > nBound) ? 1 : 0;
+		nMismatches += (pBuffer.GetDiscardedLines() + pBuffer.GetLineCount() != nLineBreaks + 1) ? 1 : 0;
+		nMismatches += (nAppended - nHeld != pBuffer.GetFirstOffset()) ? 1 : 0;
+		bLinesCapped = bLinesCapped || (pBuffer.GetLineCount() > nMaxLines / 2);
+		bBytesCapped = bBytesCapped || ((nBlock >= nBlocks / 2) && (nHeld * sizeof(wchar_t) > nMaxBytes / 2));
+		nMostUsage = std::max(nMostUsage, pBuffer.GetMemoryUsage());
+		nMostPlain = std::max(nMostPlain, pBuffer.GetPlainPageCount());
+
+		// Scroll back: random ranges of the text held, compressed pages included
+		for (int nRound = 0; nRound < 8; nRound++)
+		{
+			const uint64_t nOffset = pRandom.Range(0, nHeld - 1);
+			const size_t nCopied = pBuffer.GetText(nOffset, static_cast<size_t>(pRandom.Range(1, vecOutput.size())), vecOutput.data());
+			const size_t nRecent = static_cast<size_t>(strRecent.size() - nHeld + nOffset);
+			nMismatches += (strRecent.compare(nRecent, nCopied, vecOutput.data(), nCopied) != 0) ? 1 : 0;
+			pBuffer.GetLine(pRandom.Range(0, pBuffer.GetLineCount() - 1), strLine, 200);
+		}
+	}
+	TEST_CHECK(nOverCap == 0);
+	TEST_CHECK(nMismatches == 0);
+	TEST_CHECK(bLinesCapped && bBytesCapped);
+	TEST_CHECK(pBuffer.GetDiscardedLines() > 0);
+	TEST_CHECK(pBuffer.GetPageCount() > CScrollbackBuffer::SCROLLBACK_HOT_PAGES);
+	printf("soak: %.0f MB appended, at most %.1f MB held in memory and %zu plain pages\n",
+		nAppended * sizeof(wchar_t) / 1048576.0, nMostUsage / 1048576.0, nMostPlain);
+
+	// The newest line is whole
+	const size_t nLastBreak = strRecent.rfind(L'\n');
+	TEST_CHECK(nLastBreak != std::wstring::npos);
+	pBuffer.GetLine(pBuffer.GetLineCount() - 1, strLine);
+	TEST_CHECK(strLine == ReferenceLines(strRecent.substr(nLastBreak + 1)).back());
+}
+
+/**
+ * @brief Compress() and Decompress() round-trip blocks of every kind and size:
+ * incompressible noise, long runs, short periods whose matches overlap what
+ * they produce, and repeats at the largest offset. A block decoded to the
+ * wrong size, or corrupted, is refused.
+ */
+static void TestBlockCodec()
+{
+	CTestRandom pRandom(18);
+	std::vector<uint8_t> vecCompressed, vecOutput;
+	size_t nMismatches = 0, nOversized = 0;
+	uint64_t nNoiseRaw = 0, nNoisePacked = 0, nRepeatRaw = 0, nRepeatPacked = 0;
+	for (int nRound = 0; nRound < 400; nRound++)
+	{
+		const int nKind = nRound % 5;
+		const size_t nLength = (nRound < 20) ? static_cast<size_t>(nRound) : static_cast<size_t>(pRandom.Range(0, 300000));
+		std::vector<uint8_t> vecSource(nLength);
+		if (nKind == 0)
+		{
+			for (uint8_t& nByte : vecSource)
+			{
+				nByte = static_cast<uint8_t>(pRandom.Next() >> 56); // noise
+			}
+		}
+		else if (nKind == 1)
+		{
+			std::fill(vecSource.begin(), vecSource.end(), static_cast<uint8_t>(nRound)); // one long run
+		}
+		else if (nKind == 2)
+		{
+			const size_t nPeriod = static_cast<size_t>(pRandom.Range(1, 7));
+			for (size_t nIndex = 0; nIndex < nLength; nIndex++)
+			{
+				vecSource[nIndex] = static_cast<uint8_t>(nIndex % nPeriod + 'a');
+			}
+		}
+		else if (nKind == 3)
+		{
+			// Noise repeated at the largest offset, then just beyond it
+			const size_t nPeriod = CBlockCodec::BLOCK_CODEC_MAX_OFFSET + pRandom.Range(0, 1);
+			for (size_t nIndex = 0; nIndex < nLength; nIndex++)
+			{
+				vecSource[nIndex] = (nIndex < nPeriod) ? static_cast<uint8_t>(pRandom.Next() >> 56) : vecSource[nIndex - nPeriod];
+			}
+		}
+		else
+		{
+			// UTF-16 log text, as the scrollback pages hold
+			const std::wstring strText = RandomText(pRandom, nLength / 2);
+			for (size_t nIndex = 0; nIndex < strText.size(); nIndex++)
+			{
+				vecSource[2 * nIndex] = static_cast<uint8_t>(strText[nIndex]);
+				vecSource[2 * nIndex + 1] = static_cast<uint8_t>(strText[nIndex] >> 8);
+			}
+		}
+
+		const size_t nPacked = CBlockCodec::Compress(vecSource.data(), nLength, vecCompressed);
+		nOversized += (nPacked > CBlockCodec::GetMaxCompressedSize(nLength)) ? 1 : 0;
+		vecOutput.assign(nLength + 1, 0xCC);
+		nMismatches += !CBlockCodec::Decompress(vecCompressed.data(), nPacked, vecOutput.data(), nLength) ? 1 : 0;
+		nMismatches += !std::equal(vecSource.begin(), vecSource.end(), vecOutput.begin()) ? 1 : 0;
+		nMismatches += (vecOutput[nLength] != 0xCC) ? 1 : 0; // nothing written past the block
+		if (nLength > 0)
+		{
+			nMismatches += CBlockCodec::Decompress(vecCompressed.data(), nPacked, vecOutput.data(), nLength - 1) ? 1 : 0;
+		}
+		nMismatches += CBlockCodec::Decompress(vecCompressed.data(), nPacked, vecOutput.data(), nLength + 1) ? 1 : 0;
+		if (nKind == 0)
+		{
+			nNoiseRaw += nLength;
+			nNoisePacked += nPacked;
+		}
+		else if ((nKind == 1) || (nKind == 2))
+		{
+			nRepeatRaw += nLength;
+			nRepeatPacked += nPacked;
+		}
+
+		// Corrupted blocks decode to something or are refused, always within the output
+		if (nPacked > 0)
+		{
+			for (int nFlip = 0; nFlip < 4; nFlip++)
+			{
+				std::vector<uint8_t> vecCorrupt(vecCompressed.begin(), vecCompressed.begin() + nPacked);
+				vecCorrupt[static_cast<size_t>(pRandom.Range(0, nPacked - 1))] ^= static_cast<uint8_t>(pRandom.Range(1, 255));
+				vecCorrupt.resize(static_cast<size_t>(pRandom.Range(0, nPacked)));
+				vecOutput.assign(nLength + 1, 0xCC);
+				CBlockCodec::Decompress(vecCorrupt.data(), vecCorrupt.size(), vecOutput.data(), nLength);
+				nMismatches += (vecOutput[nLength] != 0xCC) ? 1 : 0;
+			}
+		}
+	}
+	TEST_CHECK(nMismatches == 0);
+	TEST_CHECK(nOversized == 0);
+	// Noise grows by under 1%; runs and short periods shrink to almost nothing
+	TEST_CHECK(nNoisePacked * 100 < nNoiseRaw * 101);
+	TEST_CHECK(nRepeatPacked * 100 < nRepeatRaw);
+	printf("block codec: noise %.3f, repeats %.4f of their size\n",
+		static_cast<double>(nNoisePacked) / nNoiseRaw, static_cast<double>(nRepeatPacked) / nRepeatRaw);
+}
+
+int main()
+{
+	setvbuf(stdout, nullptr, _IONBF, 0);
+	TestIndexAndText();
+	TestEviction();
+	TestCompression();
+	TestSoak();
+	TestBlockCodec();
+	return TEST_RESULT();
+}
@@ -0,0 +1,246 @@
+/* Copyright (C) 2014-2026 Stefan-Mihai MOGA
+This file is part of IntelliPort application developed by Stefan-Mihai MOGA.
+IntelliPort is an alternative Windows version to the famous HyperTerminal!
+
+IntelliPort is free software: you can redistribute it and/or modify it
+under the terms of the GNU General Public License as published by the Open
+Source Initiative, either version 3 of the License, or any later version.
+
+IntelliPort is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+IntelliPort. If not, see <http://www.opensource.org/licenses/gpl-3.0.html>*/
+
+// SerialReaderTest.cpp : CTermiosSerialTransport and CSerialReader against a pseudo terminal pair
+//
+
+#include "SerialReader.h"
+#include "SerialTransport.h"
+#include "UnitTest.h"
+
+#include <thread>
+#include <vector>
+
+// <pty.h> would pull in <termios.h>, which clashes with the <asm/termbits.h> the transport uses
+struct winsize;
+extern "C" int openpty(int* pMaster, int* pSlave, char* pszName, const struct termios* pTermios, const struct winsize* pWindowSize);
+
+static inline char StreamByte(size_t nPosition)
+{
+	return static_cast<char>((nPosition * 131) ^ (nPosition / 251));
+}
+
+/**
+ * @brief Opens a pty pair; the slave end is configured through the transport like a serial port.
+ */
+static bool OpenPair(int& nMaster, CTermiosSerialTransport& pTransport)
+{
+	int nSlave = -1;
+	if (openpty(&nMaster, &nSlave, nullptr, nullptr, nullptr) < 0)
+	{
+		return false;
+	}
+	CSerialTransportSettings pSettings;
+	pSettings.nBaudRate = 115200;
+	return pTransport.Attach(nSlave, pSettings);
+}
+
+static bool WriteAll(int nFd, const char* pData, size_t nLength)
+{
+	while (nLength > 0)
+	{
+		const ssize_t nResult = write(nFd, pData, nLength);
+		if ((nResult < 0) && (errno == EINTR))
+			continue;
+		if (nResult <= 0)
+			return false;
+		pData += nResult;
+		nLength -= static_cast<size_t>(nResult);
+	}
+	return true;
+}
+
+/**
+ * @brief Bytes written to the master arrive in the receive buffer in order, through a ring smaller than the burst.
+ */
+static void TestReceive()
+{
+	int nMaster = -1;
+	CTermiosSerialTransport pTransport;
+	TEST_CHECK(OpenPair(nMaster, pTransport));
+	CReceiveBuffer pReceiveBuffer;
+	TEST_CHECK(pReceiveBuffer.Create(0x4000));
+	CSerialReader pReader;
+	pReader.Attach(pTransport);
+	pReader.SetLatencyProfile(true, 115200);
+	// a pty has no serial_struct: the request succeeds without anything to tune
+	TEST_CHECK(pTransport.SetLowLatency(true));
+
+	std::atomic<int> nNotifications(0);
+	CSerialReader::ErrorCode nResult = -1;
+	std::thread pReaderThread([&]() { nResult = pReader.Run(pReceiveBuffer, [&]() { nNotifications++; }); });
+
+	const size_t nTotal = 8 << 20;
+	std::thread pSender([nMaster, nTotal]() {
+		std::vector<char> vecChunk(3000);
+		for (size_t nSent = 0; nSent < nTotal; )
+		{
+			const size_t nLength = (vecChunk.size() < nTotal - nSent) ? vecChunk.size() : nTotal - nSent;
+			for (size_t nIndex = 0; nIndex < nLength; nIndex++)
+				vecChunk[nIndex] = StreamByte(nSent + nIndex);
+			if (!WriteAll(nMaster, vecChunk.data(), nLength))
+				break;
+			nSent += nLength;
+		}
+	});
+
+	size_t nReceived = 0, nMismatches = 0;
+	CTestStopwatch pStopwatch;
+	while ((nReceived < nTotal) && (pStopwatch.GetSeconds() < 60))
+	{
+		CRingBufferSpan pSpans[2];
+		const int nReadable = pReceiveBuffer.PeekReadable(pSpans);
+		if (nReadable == 0)
+		{
+			std::this_thread::yield();
+			continue;
+		}
+		for (int nSpan = 0; nSpan < 2; nSpan++)
+		{
+			for (int nIndex = 0; nIndex < pSpans[nSpan].nLength; nIndex++)
+			{
+				if (pSpans[nSpan].pData[nIndex] != StreamByte(nReceived))
+					nMismatches++;
+				nReceived++;
+			}
+		}
+		pReceiveBuffer.Consume(nReadable);
+	}
+	pSender.join();
+	pReader.Stop();
+	pReaderThread.join();
+
+	TEST_CHECK(nReceived == nTotal);
+	TEST_CHECK(nMismatches == 0);
+	TEST_CHECK(nResult == 0);
+	TEST_CHECK(nNotifications > 0);
+	TEST_CHECK(pReceiveBuffer.GetStats().nBytesDropped == 0);
+	printf("received %zu bytes in %.2f s, %d notifications\n", nReceived, pStopwatch.GetSeconds(), nNotifications.load());
+	close(nMaster);
+}
+
+/**
+ * @brief WriteGather sends every span in order while a reader thread is attached to the same transport.
+ */
+static void TestWriteGather()
+{
+	int nMaster = -1;
+	CTermiosSerialTransport pTransport;
+	TEST_CHECK(OpenPair(nMaster, pTransport));
+	CReceiveBuffer pReceiveBuffer;
+	TEST_CHECK(pReceiveBuffer.Create(0x4000));
+	CSerialReader pReader;
+	pReader.Attach(pTransport);
+	std::thread pReaderThread([&]() { pReader.Run(pReceiveBuffer, []() {}); });
+
+	const size_t nTotal = 2 << 20;
+	std::vector<char> vecData(nTotal);
+	for (size_t nIndex = 0; nIndex < nTotal; nIndex++)
+		vecData[nIndex] = StreamByte(nIndex);
+	std::vector<char> vecReceived;
+	std::thread pDrain([nMaster, nTotal, &vecReceived]() {
+		char pBuffer[4096];
+		while (vecReceived.size() < nTotal)
+		{
+			const ssize_t nLength = read(nMaster, pBuffer, sizeof(pBuffer));
+			if (nLength <= 0)
+				break;
+			vecReceived.insert(vecReceived.end(), pBuffer, pBuffer + nLength);
+		}
+	});
+
+	// uneven spans, more of them than one gather takes
+	CTestRandom pRandom(4);
+	std::vector<CSerialTransportSpan> vecSpans;
+	for (size_t nOffset = 0; nOffset < nTotal; )
+	{
+		size_t nLength = pRandom.Range(1, 20000);
+		if (nLength > nTotal - nOffset)
+			nLength = nTotal - nOffset;
+		vecSpans.push_back(CSerialTransportSpan{ vecData.data() + nOffset, nLength });
+		nOffset += nLength;
+	}
+	TEST_CHECK(vecSpans.size() > ISerialTransport::SERIAL_TRANSPORT_MAX_GATHER);
+	TEST_CHECK(pTransport.WriteGather(vecSpans.data(), static_cast<int>(vecSpans.size()), []() { return true; }));
+	TEST_CHECK(pTransport.Write("\x01\x02", 2) == 2);
+	pDrain.join();
+	TEST_CHECK(vecReceived.size() >= nTotal);
+	TEST_CHECK(memcmp(vecReceived.data(), vecData.data(), nTotal) == 0);
+
+	pReader.Stop();
+	pReaderThread.join();
+	close(nMaster);
+}
+
+/**
+ * @brief A write the other end never takes gives up once asked to, instead of blocking.
+ */
+static void TestWriteCancel()
+{
+	int nMaster = -1;
+	CTermiosSerialTransport pTransport;
+	TEST_CHECK(OpenPair(nMaster, pTransport));
+	std::vector<char> vecData(4 << 20, 'x');
+	const CSerialTransportSpan pSpan = { vecData.data(), vecData.size() };
+	int nPolls = 0;
+	CTestStopwatch pStopwatch;
+	TEST_CHECK(!pTransport.WriteGather(&pSpan, 1, [&nPolls]() { return ++nPolls < 3; }));
+	TEST_CHECK(pTransport.GetLastErrorCode() == ECANCELED);
+	TEST_CHECK(nPolls == 3);
+	TEST_CHECK(pStopwatch.GetSeconds() < 2.0);
+	close(nMaster);
+}
+
+/**
+ * @brief Stop() ends an idle reader at once, and a hang-up ends it with an error.
+ */
+static void TestStopAndHangUp()
+{
+	int nMaster = -1;
+	CTermiosSerialTransport pTransport;
+	TEST_CHECK(OpenPair(nMaster, pTransport));
+	CReceiveBuffer pReceiveBuffer;
+	TEST_CHECK(pReceiveBuffer.Create(0x4000));
+	CSerialReader pReader;
+
+	pReader.Attach(pTransport);
+	CSerialReader::ErrorCode nResult = -1;
+	std::thread pIdle([&]() { nResult = pReader.Run(pReceiveBuffer, []() {}); });
+	std::this_thread::sleep_for(std::chrono::milliseconds(50));
+	CTestStopwatch pStopwatch;
+	pReader.Stop();
+	pIdle.join();
+	TEST_CHECK(nResult == 0);
+	TEST_CHECK(pStopwatch.GetSeconds() < 1.0);
+
+	// Attach re-arms the reader; closing the master is a hang-up
+	pReader.Attach(pTransport);
+	nResult = 0;
+	std::thread pHangUp([&]() { nResult = pReader.Run(pReceiveBuffer, []() {}); });
+	std::this_thread::sleep_for(std::chrono::milliseconds(50));
+	close(nMaster);
+	pHangUp.join();
+	TEST_CHECK(nResult != 0);
+}
+
+int main()
+{
+	setvbuf(stdout, nullptr, _IONBF, 0);
+	TestReceive();
+	TestWriteGather();
+	TestWriteCancel();
+	TestStopAndHangUp();
+	return TEST_RESULT();
+}
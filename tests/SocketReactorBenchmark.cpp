@@ -0,0 +1,128 @@
+/* Copyright (C) 2014-2026 Stefan-Mihai MOGA
+This file is part of IntelliPort application developed by Stefan-Mihai MOGA.
+IntelliPort is an alternative Windows version to the famous HyperTerminal!
+
+IntelliPort is free software: you can redistribute it and/or modify it
+under the terms of the GNU General Public License as published by the Open
+Source Initiative, either version 3 of the License, or any later version.
+
+IntelliPort is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+IntelliPort. If not, see <http://www.opensource.org/licenses/gpl-3.0.html>*/
+
+// SocketReactorBenchmark.cpp : loopback receive rate and syscalls per MB, reactor against select() per read
+//
+
+#include "SocketReactor.h"
+#include "UnitTest.h"
+
+#include <fcntl.h>
+#include <sys/select.h>
+#include <sys/socket.h>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Streams nTotal bytes over a socket pair in nChunk-byte sends.
+ */
+static std::thread StartSender(int hSocket, size_t nTotal, size_t nChunk)
+{
+	return std::thread([hSocket, nTotal, nChunk]() {
+		std::vector<char> vecData(nChunk, 'x');
+		for (size_t nSent = 0; nSent < nTotal; )
+		{
+			const ssize_t nResult = send(hSocket, vecData.data(), (nChunk < nTotal - nSent) ? nChunk : nTotal - nSent, MSG_NOSIGNAL);
+			if (nResult <= 0)
+				break;
+			nSent += static_cast<size_t>(nResult);
+		}
+	});
+}
+
+/**
+ * @brief The socket thread before the reactor: a select() with a timeout before every recv.
+ */
+static void MeasureSelect(size_t nTotal, size_t nChunk)
+{
+	int pPair[2];
+	socketpair(AF_UNIX, SOCK_STREAM, 0, pPair);
+	std::thread pSender = StartSender(pPair[1], nTotal, nChunk);
+	std::vector<char> vecBuffer(0x10000);
+	uint64_t nSyscalls = 0;
+	size_t nReceived = 0;
+	CTestStopwatch pStopwatch;
+	while (nReceived < nTotal)
+	{
+		fd_set readable;
+		FD_ZERO(&readable);
+		FD_SET(pPair[0], &readable);
+		timeval timeout = { 1, 0 };
+		nSyscalls++;
+		if (select(pPair[0] + 1, &readable, nullptr, nullptr, &timeout) <= 0)
+			continue;
+		nSyscalls++;
+		const ssize_t nLength = recv(pPair[0], vecBuffer.data(), vecBuffer.size(), 0);
+		if (nLength <= 0)
+			break;
+		nReceived += static_cast<size_t>(nLength);
+	}
+	const double fSeconds = pStopwatch.GetSeconds();
+	pSender.join();
+	printf("%-8s %8zu %10.1f %14.2f\n", "select", nChunk, nReceived / fSeconds / 1e6, nSyscalls / (nReceived / 1e6));
+	close(pPair[0]);
+	close(pPair[1]);
+}
+
+/**
+ * @brief The reactor: one epoll_wait for whatever is ready, then receive until the socket is drained.
+ */
+static void MeasureReactor(size_t nTotal, size_t nChunk)
+{
+	int pPair[2];
+	socketpair(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0, pPair);
+	int nFlags = fcntl(pPair[1], F_GETFL);
+	fcntl(pPair[1], F_SETFL, nFlags & ~O_NONBLOCK);
+	std::thread pSender = StartSender(pPair[1], nTotal, nChunk);
+	std::vector<char> vecBuffer(0x10000);
+	uint64_t nReceives = 0;
+	size_t nReceived = 0;
+	CSocketReactor pReactor;
+	pReactor.Create();
+	pReactor.Add(pPair[0], [&]() {
+		for (;;)
+		{
+			nReceives++;
+			const ssize_t nLength = recv(pPair[0], vecBuffer.data(), vecBuffer.size(), 0);
+			if (nLength <= 0)
+				break;
+			nReceived += static_cast<size_t>(nLength);
+		}
+		if (nReceived >= nTotal)
+			pReactor.Stop();
+		return true;
+	});
+	CTestStopwatch pStopwatch;
+	pReactor.Run();
+	const double fSeconds = pStopwatch.GetSeconds();
+	pSender.join();
+	printf("%-8s %8zu %10.1f %14.2f\n", "reactor", nChunk, nReceived / fSeconds / 1e6, (pReactor.GetWaitCount() + nReceives) / (nReceived / 1e6));
+	close(pPair[0]);
+	close(pPair[1]);
+}
+
+int main(int argc, char* argv[])
+{
+	setvbuf(stdout, nullptr, _IONBF, 0);
+	const size_t nTotal = static_cast<size_t>((argc > 1) ? atoi(argv[1]) : 1024) << 20;
+	printf("%-8s %8s %10s %14s\n", "path", "send", "MB/s", "syscalls/MB");
+	for (size_t nChunk : { 64, 1024, 65536 })
+	{
+		const size_t nVolume = (nChunk < 1024) ? nTotal / 16 : nTotal;
+		MeasureSelect(nVolume, nChunk);
+		MeasureReactor(nVolume, nChunk);
+	}
+	return 0;
+}
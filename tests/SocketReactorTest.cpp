@@ -0,0 +1,209 @@
+/* Copyright (C) 2014-2026 Stefan-Mihai MOGA
+This file is part of IntelliPort application developed by Stefan-Mihai MOGA.
+IntelliPort is an alternative Windows version to the famous HyperTerminal!
+
+IntelliPort is free software: you can redistribute it and/or modify it
+under the terms of the GNU General Public License as published by the Open
+Source Initiative, either version 3 of the License, or any later version.
+
+IntelliPort is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+IntelliPort. If not, see <http://www.opensource.org/licenses/gpl-3.0.html>*/
+
+// SocketReactorTest.cpp : accept and read many loopback connections through CSocketReactor
+//
+
+#include "SocketReactor.h"
+#include "UnitTest.h"
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Opens a listening TCP socket on an ephemeral loopback port.
+ */
+static int Listen(uint16_t& nPort)
+{
+	const int hListener = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC | SOCK_NONBLOCK, 0);
+	sockaddr_in address = {};
+	address.sin_family = AF_INET;
+	address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+	socklen_t nLength = sizeof(address);
+	if ((bind(hListener, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) || (listen(hListener, SOMAXCONN) != 0) ||
+		(getsockname(hListener, reinterpret_cast<sockaddr*>(&address), &nLength) != 0))
+	{
+		close(hListener);
+		return -1;
+	}
+	nPort = ntohs(address.sin_port);
+	return hListener;
+}
+
+static int Connect(uint16_t nPort)
+{
+	const int hSocket = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+	sockaddr_in address = {};
+	address.sin_family = AF_INET;
+	address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+	address.sin_port = htons(nPort);
+	if (connect(hSocket, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0)
+	{
+		close(hSocket);
+		return -1;
+	}
+	return hSocket;
+}
+
+/**
+ * @brief Clients connect, each sends its own byte pattern and closes; the reactor
+ * thread accepts every connection, reads every byte and drops sockets at EOF.
+ */
+static void TestAcceptAndRead()
+{
+	const int nClients = 200;
+	const size_t nPerClient = 64 << 10;
+	uint16_t nPort = 0;
+	const int hListener = Listen(nPort);
+	TEST_CHECK(hListener >= 0);
+
+	CSocketReactor pReactor;
+	TEST_CHECK(pReactor.Create());
+	int nAccepted = 0, nClosed = 0;
+	size_t nReceived = 0, nMismatches = 0;
+	std::vector<size_t> vecPosition(nClients, 0);
+	TEST_CHECK(pReactor.Add(hListener, [&]() {
+		for (;;)
+		{
+			const int hSocket = accept4(hListener, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+			if (hSocket < 0)
+				return true;
+			nAccepted++;
+			// the first byte names the client, so its stream can be checked
+			pReactor.Add(hSocket, [&, hSocket, nClient = -1]() mutable {
+				char pBuffer[8192];
+				const ssize_t nLength = recv(hSocket, pBuffer, sizeof(pBuffer), 0);
+				if (nLength > 0)
+				{
+					ssize_t nIndex = 0;
+					if (nClient < 0)
+						nClient = static_cast<unsigned char>(pBuffer[nIndex++]);
+					for (; nIndex < nLength; nIndex++)
+					{
+						if (pBuffer[nIndex] != static_cast<char>(nClient + vecPosition[nClient]++))
+							nMismatches++;
+					}
+					nReceived += nLength;
+					return true;
+				}
+				if ((nLength < 0) && (errno == EAGAIN))
+					return true;
+				close(hSocket);
+				nClosed++;
+				if (nClosed == nClients)
+					pReactor.Stop();
+				return false;
+			});
+		}
+	}));
+
+	CSocketReactor::ErrorCode nResult = -1;
+	std::thread pReactorThread([&]() { nResult = pReactor.Run(); });
+	std::vector<std::thread> vecSenders;
+	for (int nGroup = 0; nGroup < 4; nGroup++)
+	{
+		vecSenders.emplace_back([nGroup, nPort, nPerClient]() {
+			std::vector<char> vecData(nPerClient + 1);
+			for (int nClient = nGroup; nClient < nClients; nClient += 4)
+			{
+				const int hSocket = Connect(nPort);
+				if (hSocket < 0)
+					continue;
+				vecData[0] = static_cast<char>(nClient);
+				for (size_t nIndex = 0; nIndex < nPerClient; nIndex++)
+					vecData[nIndex + 1] = static_cast<char>(nClient + nIndex);
+				send(hSocket, vecData.data(), vecData.size(), MSG_NOSIGNAL);
+				close(hSocket);
+			}
+		});
+	}
+	for (auto& pSender : vecSenders)
+		pSender.join();
+	pReactorThread.join();
+
+	TEST_CHECK(nResult == 0);
+	TEST_CHECK(nAccepted == nClients);
+	TEST_CHECK(nClosed == nClients);
+	TEST_CHECK(nReceived == nClients * (nPerClient + 1));
+	TEST_CHECK(nMismatches == 0);
+	TEST_CHECK(pReactor.GetCount() == 1); // only the listener is left
+	printf("%d connections, %zu bytes, %llu waits, %llu dispatches\n", nAccepted, nReceived,
+		static_cast<unsigned long long>(pReactor.GetWaitCount()), static_cast<unsigned long long>(pReactor.GetDispatchCount()));
+	close(hListener);
+}
+
+/**
+ * @brief Stop() wakes an idle Run() at once, and Run() can be started again afterwards.
+ */
+static void TestStop()
+{
+	CSocketReactor pReactor;
+	TEST_CHECK(pReactor.Create());
+	for (int nRound = 0; nRound < 3; nRound++)
+	{
+		CSocketReactor::ErrorCode nResult = -1;
+		std::thread pReactorThread([&]() { nResult = pReactor.Run(); });
+		std::this_thread::sleep_for(std::chrono::milliseconds(20));
+		CTestStopwatch pStopwatch;
+		pReactor.Stop();
+		pReactorThread.join();
+		TEST_CHECK(nResult == 0);
+		TEST_CHECK(pStopwatch.GetSeconds() < 0.5);
+	}
+}
+
+/**
+ * @brief A handler may remove another socket that is ready in the same batch; it is not called afterwards.
+ */
+static void TestRemoveFromHandler()
+{
+	int pFirst[2], pSecond[2];
+	TEST_CHECK(socketpair(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0, pFirst) == 0);
+	TEST_CHECK(socketpair(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0, pSecond) == 0);
+	CSocketReactor pReactor;
+	TEST_CHECK(pReactor.Create());
+	int nCalls = 0;
+	auto pfnHandler = [&](int hSocket, int hOther) {
+		nCalls++;
+		char pBuffer[16];
+		recv(hSocket, pBuffer, sizeof(pBuffer), 0);
+		pReactor.Remove(hOther);
+		pReactor.Stop();
+		return false;
+	};
+	TEST_CHECK(pReactor.Add(pFirst[0], [&]() { return pfnHandler(pFirst[0], pSecond[0]); }));
+	TEST_CHECK(pReactor.Add(pSecond[0], [&]() { return pfnHandler(pSecond[0], pFirst[0]); }));
+	TEST_CHECK(!pReactor.Add(pFirst[0], []() { return true; }));
+	send(pFirst[1], "a", 1, 0);
+	send(pSecond[1], "b", 1, 0);
+	TEST_CHECK(pReactor.Run() == 0);
+	TEST_CHECK(nCalls == 1);
+	TEST_CHECK(pReactor.GetCount() == 0);
+	for (int hSocket : { pFirst[0], pFirst[1], pSecond[0], pSecond[1] })
+		close(hSocket);
+}
+
+int main()
+{
+	setvbuf(stdout, nullptr, _IONBF, 0);
+	TestAcceptAndRead();
+	TestStop();
+	TestRemoveFromHandler();
+	return TEST_RESULT();
+}
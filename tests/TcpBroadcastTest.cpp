@@ -0,0 +1,450 @@
+/* Copyright (C) 2014-2026 Stefan-Mihai MOGA
+This file is part of IntelliPort application developed by Stefan-Mihai MOGA.
+IntelliPort is an alternative Windows version to the famous HyperTerminal!
+
+IntelliPort is free software: you can redistribute it and/or modify it
+under the terms of the GNU General Public License as published by the Open
+Source Initiative, either version 3 of the License, or any later version.
+
+IntelliPort is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+IntelliPort. If not, see <http://www.opensource.org/licenses/gpl-3.0.html>*/
+
+// TcpBroadcastTest.cpp : TCP server sessions: tagged lines, and broadcast to 1,000 loopback clients
+//
+
+#include "TcpSessionHost.h"
+#include "UnitTest.h"
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <functional>
+#include <netinet/in.h>
+#include <string>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <thread>
+#include <vector>
+
+static char Pattern(size_t nOffset)
+{
+	return static_cast<char>((nOffset * 7) ^ (nOffset >> 10));
+}
+
+/**
+ * @brief The sessions of CTcpServer, writing into a string instead of the ring buffer.
+ */
+class CTestServer : public CTcpSessionHost
+{
+public:
+	explicit CTestServer(size_t nMaxQueued) :
+		CTcpSessionHost(nMaxQueued), m_nAccepted(0), m_nOverflowed(0), m_nDisconnected(0), m_nLines(0)
+	{
+	}
+
+	std::string GetText()
+	{
+		std::lock_guard<std::mutex> lock(m_pTextLock);
+		return m_strText;
+	}
+
+	std::atomic<int> m_nAccepted;
+	std::atomic<int> m_nOverflowed;
+	std::atomic<int> m_nDisconnected;
+	std::atomic<int> m_nLines;
+	std::vector<std::string> m_vecAddresses;     // of the connected sessions, in order
+	std::vector<uint64_t> m_vecBytesReceived;    // of the disconnected sessions, in order
+
+protected:
+	bool WriteText(const char* pData, size_t nLength) override
+	{
+		std::lock_guard<std::mutex> lock(m_pTextLock);
+		m_strText.append(pData, nLength);
+		return true;
+	}
+
+	void TextReady() override
+	{
+		m_nLines++;
+	}
+
+	void OnSessionEvent(TcpSessionEvent nEvent, CTcpSession& pSession) override
+	{
+		std::lock_guard<std::mutex> lock(m_pTextLock);
+		switch (nEvent)
+		{
+			case TCP_SESSION_CONNECTED:
+				m_vecAddresses.push_back(pSession.m_strAddress);
+				m_nAccepted++;
+				break;
+			case TCP_SESSION_DISCONNECTED:
+				m_vecBytesReceived.push_back(pSession.m_nBytesReceived);
+				m_nDisconnected++;
+				break;
+			case TCP_SESSION_TOO_SLOW:
+				m_nOverflowed++;
+				break;
+		}
+	}
+
+	std::mutex m_pTextLock;
+	std::string m_strText;
+};
+
+static int Listen(uint16_t& nPort, int nSendBuffer)
+{
+	const int hListener = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC | SOCK_NONBLOCK, 0);
+	// Inherited by the accepted sockets: small buffers make the outboxes do the queueing
+	if (nSendBuffer > 0)
+	{
+		setsockopt(hListener, SOL_SOCKET, SO_SNDBUF, &nSendBuffer, sizeof(nSendBuffer));
+	}
+	sockaddr_in address = {};
+	address.sin_family = AF_INET;
+	address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+	socklen_t nLength = sizeof(address);
+	if ((bind(hListener, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) || (listen(hListener, SOMAXCONN) != 0) ||
+		(getsockname(hListener, reinterpret_cast<sockaddr*>(&address), &nLength) != 0))
+	{
+		close(hListener);
+		return -1;
+	}
+	nPort = ntohs(address.sin_port);
+	return hListener;
+}
+
+static int Connect(uint16_t nPort, int nReceiveBuffer)
+{
+	const int hSocket = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+	if (nReceiveBuffer > 0)
+	{
+		setsockopt(hSocket, SOL_SOCKET, SO_RCVBUF, &nReceiveBuffer, sizeof(nReceiveBuffer));
+	}
+	sockaddr_in address = {};
+	address.sin_family = AF_INET;
+	address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+	address.sin_port = htons(nPort);
+	if (connect(hSocket, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0)
+	{
+		close(hSocket);
+		return -1;
+	}
+	return hSocket;
+}
+
+/**
+ * @brief Polls pfnDone for up to five seconds.
+ */
+static bool WaitFor(const std::function<bool()>& pfnDone)
+{
+	for (int nWait = 0; nWait < 5000; nWait++)
+	{
+		if (pfnDone())
+		{
+			return true;
+		}
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+	return pfnDone();
+}
+
+/**
+ * @brief Two clients: complete lines are tagged with their session id, a line
+ * of TCP_SERVER_MAX_LINE bytes without a new line is split off, and a partial
+ * line is written when its client disconnects.
+ */
+static void TestLines()
+{
+	uint16_t nPort = 0;
+	const int hListener = Listen(nPort, 0);
+	TEST_CHECK(hListener >= 0);
+	CSocketReactor pReactor;
+	TEST_CHECK(pReactor.Create());
+	CTestServer pServer(CTcpSessionHost::TCP_SERVER_MAX_QUEUED);
+	TEST_CHECK(pServer.AttachListener(pReactor, hListener));
+	std::thread pThread([&]() { pReactor.Run(); });
+
+	// Connected one after the other, so that the ids are known
+	const int hFirst = Connect(nPort, 0);
+	TEST_CHECK(WaitFor([&]() { return pServer.m_nAccepted == 1; }));
+	const int hSecond = Connect(nPort, 0);
+	TEST_CHECK(WaitFor([&]() { return pServer.m_nAccepted == 2; }));
+	TEST_CHECK(pServer.GetSessionCount() == 2);
+	TEST_CHECK((pServer.m_vecAddresses.size() == 2) && (pServer.m_vecAddresses[0] == "127.0.0.1"));
+
+	const std::string strLong(CTcpSessionHost::TCP_SERVER_MAX_LINE, 'x');
+	const struct
+	{
+		int hSocket;
+		std::string strData;
+		int nLines; // written once the server took the data
+	} steps[] = {
+		{ hFirst, "alpha\nbe", 1 },
+		{ hSecond, "two\n", 2 },
+		{ hFirst, "ta\n", 3 },
+		{ hFirst, strLong, 4 },
+		{ hFirst, "tail", 4 },
+	};
+	for (const auto& pStep : steps)
+	{
+		TEST_CHECK(send(pStep.hSocket, pStep.strData.data(), pStep.strData.size(), 0) == static_cast<ssize_t>(pStep.strData.size()));
+		TEST_CHECK(WaitFor([&]() { return pServer.m_nLines == pStep.nLines; }));
+	}
+	// The partial line of the first client is written when it leaves; the second has none
+	close(hFirst);
+	TEST_CHECK(WaitFor([&]() { return pServer.m_nDisconnected == 1; }));
+	close(hSecond);
+	TEST_CHECK(WaitFor([&]() { return pServer.m_nDisconnected == 2; }));
+	TEST_CHECK(pServer.m_nLines == 5);
+	TEST_CHECK(pServer.GetSessionCount() == 0);
+	TEST_CHECK(pServer.GetText() == "[#1] alpha\n[#2] two\n[#1] beta\n[#1] " + strLong + "\n[#1] tail\n");
+	TEST_CHECK((pServer.m_vecBytesReceived.size() == 2) && (pServer.m_vecBytesReceived[0] == 15 + strLong.size()) &&
+		(pServer.m_vecBytesReceived[1] == 4));
+
+	pReactor.Stop();
+	pThread.join();
+	close(hListener);
+}
+
+/**
+ * @brief 1,000 clients, one of which never reads.
+ *
+ * Every reading client must get the whole stream intact, the client that does
+ * not read must be disconnected once its outbox passes the bound, and no
+ * Broadcast() call may wait for it.
+ */
+static void TestThousandClients()
+{
+	const int nClients = 1000;
+	const size_t nMaxQueued = 64 << 10;
+	const size_t nMessage = 1024;
+	const size_t nTotal = 512 << 10;
+
+	// Two descriptors per connection
+	rlimit limit = {};
+	getrlimit(RLIMIT_NOFILE, &limit);
+	if (limit.rlim_cur < 4 * nClients)
+	{
+		limit.rlim_cur = (limit.rlim_max < 4 * nClients) ? limit.rlim_max : 4 * nClients;
+		setrlimit(RLIMIT_NOFILE, &limit);
+	}
+
+	uint16_t nPort = 0;
+	const int hListener = Listen(nPort, 16 << 10);
+	TEST_CHECK(hListener >= 0);
+	CSocketReactor pServerReactor;
+	TEST_CHECK(pServerReactor.Create());
+	CTestServer pServer(nMaxQueued);
+	TEST_CHECK(pServer.AttachListener(pServerReactor, hListener));
+	std::thread pServerThread([&]() { pServerReactor.Run(); });
+
+	// Client 0 keeps a tiny receive window and never reads
+	std::vector<int> vecSockets;
+	for (int nIndex = 0; nIndex < nClients; nIndex++)
+	{
+		vecSockets.push_back(Connect(nPort, (nIndex == 0) ? 4096 : 0));
+		TEST_CHECK(vecSockets.back() >= 0);
+	}
+	for (int nWait = 0; (nWait < 5000) && (pServer.m_nAccepted < nClients); nWait++)
+	{
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+	TEST_CHECK(pServer.m_nAccepted == nClients);
+
+	// The readers verify every byte on a reactor of their own
+	CSocketReactor pClientReactor;
+	TEST_CHECK(pClientReactor.Create());
+	std::vector<std::atomic<size_t>> vecReceived(nClients);
+	std::atomic<size_t> nMismatches(0);
+	std::atomic<int> nComplete(0);
+	for (int nIndex = 1; nIndex < nClients; nIndex++)
+	{
+		vecReceived[nIndex] = 0;
+		const int hSocket = vecSockets[nIndex];
+		pClientReactor.Add(hSocket, [&, nIndex, hSocket]()
+		{
+			char pBuffer[0x4000];
+			const ssize_t nLength = recv(hSocket, pBuffer, sizeof(pBuffer), MSG_DONTWAIT);
+			if (nLength <= 0)
+			{
+				return (nLength < 0) && (errno == EAGAIN);
+			}
+			const size_t nStart = vecReceived[nIndex];
+			for (ssize_t nByte = 0; nByte < nLength; nByte++)
+			{
+				if (pBuffer[nByte] != Pattern(nStart + nByte))
+				{
+					nMismatches++;
+					break;
+				}
+			}
+			vecReceived[nIndex] = nStart + nLength;
+			if (nStart + nLength >= nTotal)
+			{
+				nComplete++;
+			}
+			return true;
+		});
+	}
+	std::thread pClientThread([&]() { pClientReactor.Run(); });
+
+	// Paced so that the reading clients stay well inside the bound, as a real
+	// producer is paced by the writer thread; the client that does not read is not waited for
+	std::vector<char> vecMessage(nMessage);
+	double fLongestBroadcast = 0;
+	CTestStopwatch pStopwatch;
+	for (size_t nOffset = 0; nOffset < nTotal; nOffset += nMessage)
+	{
+		for (size_t nByte = 0; nByte < nMessage; nByte++)
+		{
+			vecMessage[nByte] = Pattern(nOffset + nByte);
+		}
+		CTestStopwatch pBroadcast;
+		pServer.Broadcast(vecMessage.data(), nMessage);
+		const double fSeconds = pBroadcast.GetSeconds();
+		fLongestBroadcast = (fSeconds > fLongestBroadcast) ? fSeconds : fLongestBroadcast;
+		for (int nIndex = 1; (nIndex < nClients) && (pStopwatch.GetSeconds() < 60); )
+		{
+			if (vecReceived[nIndex] + nMaxQueued / 2 >= nOffset + nMessage)
+			{
+				nIndex++;
+				continue;
+			}
+			std::this_thread::yield();
+		}
+	}
+	for (int nWait = 0; (nWait < 10000) && (nComplete < nClients - 1); nWait++)
+	{
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+	const double fSeconds = pStopwatch.GetSeconds();
+	printf("%d clients, %zu KB each, %.2f s (%.1f MB/s), longest Broadcast() %.3f ms, %d over the bound\n",
+		nClients, nTotal >> 10, fSeconds, (nClients - 1) * static_cast<double>(nTotal) / fSeconds / 1e6, fLongestBroadcast * 1e3,
+		pServer.m_nOverflowed.load());
+	TEST_CHECK(nComplete == nClients - 1);
+	TEST_CHECK(nMismatches == 0);
+	for (int nIndex = 1; nIndex < nClients; nIndex++)
+	{
+		TEST_CHECK(vecReceived[nIndex] == nTotal);
+	}
+	TEST_CHECK(pServer.m_nOverflowed == 1);
+	TEST_CHECK(pServer.m_nDisconnected == 1);
+	TEST_CHECK(pServer.GetSessionCount() == static_cast<size_t>(nClients - 1));
+	TEST_CHECK(fLongestBroadcast < 0.25);
+
+	// The slow client gets what was sent before the disconnect, then the end of the stream
+	timeval timeout = { 5, 0 };
+	setsockopt(vecSockets[0], SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+	size_t nSlowReceived = 0, nSlowMismatches = 0;
+	ssize_t nLength = 0;
+	char pBuffer[0x4000];
+	while ((nLength = recv(vecSockets[0], pBuffer, sizeof(pBuffer), 0)) > 0)
+	{
+		for (ssize_t nByte = 0; nByte < nLength; nByte++)
+		{
+			nSlowMismatches += (pBuffer[nByte] != Pattern(nSlowReceived + nByte)) ? 1 : 0;
+		}
+		nSlowReceived += nLength;
+	}
+	TEST_CHECK((nLength == 0) || (errno == ECONNRESET));
+	TEST_CHECK(nSlowReceived < nTotal);
+	TEST_CHECK(nSlowMismatches == 0);
+
+	pClientReactor.Stop();
+	pClientThread.join();
+	pServerReactor.Stop();
+	pServerThread.join();
+	for (const int hSocket : vecSockets)
+	{
+		close(hSocket);
+	}
+	close(hListener);
+}
+
+/**
+ * @brief A watched socket is reported once when it drains, and not again without a new watch.
+ */
+static void TestWatchWritable()
+{
+	int pPair[2];
+	TEST_CHECK(socketpair(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0, pPair) == 0);
+	CSocketReactor pReactor;
+	TEST_CHECK(pReactor.Create());
+	TEST_CHECK(pReactor.Add(pPair[0], []() { return true; }));
+
+	// Fill the socket, then watch it
+	CSocketOutbox pOutbox(16 << 20);
+	std::vector<char> vecData(4 << 20, 'x');
+	TEST_CHECK(pOutbox.Append(vecData.data(), vecData.size()));
+	TEST_CHECK(pOutbox.Flush(pPair[0]) == SOCKET_OUTBOX_PENDING);
+	const size_t nPending = pOutbox.GetPending();
+	TEST_CHECK((nPending > 0) && (nPending < vecData.size()));
+	int nCalls = 0;
+	TEST_CHECK(pReactor.WatchWritable(pPair[0], [&]() { nCalls++; return true; }));
+	TEST_CHECK(!pReactor.WatchWritable(pPair[1], [&]() { return true; }));
+
+	std::thread pReader([&]() {
+		char pBuffer[0x10000];
+		size_t nRead = 0;
+		while (nRead < vecData.size() - nPending)
+		{
+			const ssize_t nLength = recv(pPair[1], pBuffer, sizeof(pBuffer), 0);
+			if (nLength > 0)
+			{
+				nRead += static_cast<size_t>(nLength);
+			}
+			else
+			{
+				std::this_thread::yield();
+			}
+		}
+		std::this_thread::sleep_for(std::chrono::milliseconds(50));
+		pReactor.Stop();
+	});
+	pReactor.Run();
+	pReader.join();
+	TEST_CHECK(nCalls == 1);
+
+	// Posted tasks run on the reactor thread, in order, and Stop() still ends Run()
+	std::vector<int> vecOrder;
+	pReactor.Post([&]() { vecOrder.push_back(1); });
+	pReactor.Post([&]() { vecOrder.push_back(2); pReactor.Stop(); });
+	pReactor.Run();
+	TEST_CHECK((vecOrder.size() == 2) && (vecOrder[0] == 1) && (vecOrder[1] == 2));
+
+	pReactor.Destroy();
+	close(pPair[0]);
+	close(pPair[1]);
+}
+
+/**
+ * @brief Appends past the bound are refused for good; the bytes already queued are unchanged.
+ */
+static void TestOutboxBound()
+{
+	CSocketOutbox pOutbox(100);
+	TEST_CHECK(pOutbox.Append("0123456789", 10));
+	TEST_CHECK(!pOutbox.Append(std::string(91, 'x').data(), 91));
+	TEST_CHECK(pOutbox.IsOverflowed());
+	TEST_CHECK(!pOutbox.Append("a", 1));
+	TEST_CHECK(pOutbox.GetPending() == 10);
+	TEST_CHECK(pOutbox.GetBytesQueued() == 10);
+	int pPair[2];
+	TEST_CHECK(socketpair(AF_UNIX, SOCK_STREAM, 0, pPair) == 0);
+	TEST_CHECK(pOutbox.Flush(pPair[0]) == SOCKET_OUTBOX_FAILED);
+	close(pPair[0]);
+	close(pPair[1]);
+}
+
+int main()
+{
+	setvbuf(stdout, nullptr, _IONBF, 0);
+	TestOutboxBound();
+	TestWatchWritable();
+	TestLines();
+	TestThousandClients();
+	return TEST_RESULT();
+}
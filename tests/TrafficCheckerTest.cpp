@@ -0,0 +1,187 @@
+/* Copyright (C) 2014-2026 Stefan-Mihai MOGA
+This file is part of IntelliPort application developed by Stefan-Mihai MOGA.
+IntelliPort is an alternative Windows version to the famous HyperTerminal!
+
+IntelliPort is free software: you can redistribute it and/or modify it
+under the terms of the GNU General Public License as published by the Open
+Source Initiative, either version 3 of the License, or any later version.
+
+IntelliPort is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+IntelliPort. If not, see <http://www.opensource.org/licenses/gpl-3.0.html>*/
+
+// TrafficCheckerTest.cpp : loss, reordering and duplicate accounting of the traffic test checker
+//
+
+#include "TrafficGenerator.h"
+#include "UnitTest.h"
+
+#include <algorithm>
+#include <vector>
+
+static void FeedFrame(CTrafficChecker& pChecker, uint32_t nSession, uint64_t nSequence)
+{
+	const size_t nPayloadLength = 16;
+	std::vector<char> vecFrame(nPayloadLength + TRAFFIC_FRAME_OVERHEAD);
+	CTrafficGenerator::BuildFrame(vecFrame.data(), nSession, nSequence, CTrafficGenerator::GetTimestamp(), nPayloadLength);
+	pChecker.Feed(vecFrame.data(), vecFrame.size());
+}
+
+/**
+ * @brief Two generators feeding one checker, frame by frame, plus one frame sent twice.
+ */
+static void TestInterleavedSessions()
+{
+	CTrafficChecker pChecker;
+	pChecker.Reset(1);
+	for (uint64_t nSequence = 0; nSequence < 100; nSequence++)
+	{
+		FeedFrame(pChecker, 1, nSequence);
+		FeedFrame(pChecker, 2, nSequence);
+	}
+	FeedFrame(pChecker, 2, 57);
+	const CTrafficCheckerStats stats = pChecker.GetStats();
+	TEST_CHECK(stats.nFrames + stats.nDuplicates == 201);
+	TEST_CHECK(stats.nFrames == 200);
+	TEST_CHECK(stats.nDuplicates == 1);
+	TEST_CHECK(stats.nLost == 0);
+	TEST_CHECK(stats.nReordered == 0);
+	TEST_CHECK(stats.nStale == 0);
+	TEST_CHECK(stats.pRoundTrip.GetCount() == 100);
+	TEST_CHECK(stats.pOneWay.GetCount() == 100);
+
+	CTrafficSessionStats pSession = {};
+	TEST_CHECK(pChecker.GetSessionStats(1, pSession) && (pSession.nFrames == 100) && (pSession.nDuplicates == 0));
+	TEST_CHECK(pChecker.GetSessionStats(2, pSession) && (pSession.nFrames == 100) && (pSession.nDuplicates == 1));
+	TEST_CHECK(!pChecker.GetSessionStats(3, pSession));
+}
+
+/**
+ * @brief Frames before the baseline are reordered but were never lost: the loss
+ * counter must not wrap around.
+ */
+static void TestReorderBeforeBaseline()
+{
+	CTrafficChecker pChecker;
+	pChecker.Reset(0);
+	FeedFrame(pChecker, 7, 5);
+	for (uint64_t nSequence = 0; nSequence < 5; nSequence++)
+	{
+		FeedFrame(pChecker, 7, nSequence);
+	}
+	FeedFrame(pChecker, 7, 3);
+	const CTrafficCheckerStats stats = pChecker.GetStats();
+	TEST_CHECK(stats.nLost == 0);
+	TEST_CHECK(stats.nReordered == 5);
+	TEST_CHECK(stats.nDuplicates == 1);
+	TEST_CHECK(stats.nFrames == 6);
+}
+
+/**
+ * @brief Gaps count as lost, and a late frame of a gap takes back exactly one loss.
+ */
+static void TestLossAndLateFrames()
+{
+	CTrafficChecker pChecker;
+	pChecker.Reset(0);
+	FeedFrame(pChecker, 9, 0);
+	FeedFrame(pChecker, 9, 10);         // 1..9 lost
+	FeedFrame(pChecker, 9, 4);          // late
+	FeedFrame(pChecker, 9, 4);          // and again
+	CTrafficCheckerStats stats = pChecker.GetStats();
+	TEST_CHECK(stats.nLost == 8);
+	TEST_CHECK(stats.nReordered == 1);
+	TEST_CHECK(stats.nDuplicates == 1);
+
+	// A jump past the window: the whole window is missing, older frames are stale
+	FeedFrame(pChecker, 9, 10 + 2 * CTrafficChecker::TRAFFIC_REORDER_WINDOW);
+	FeedFrame(pChecker, 9, 11 + CTrafficChecker::TRAFFIC_REORDER_WINDOW);
+	FeedFrame(pChecker, 9, 5);
+	stats = pChecker.GetStats();
+	TEST_CHECK(stats.nLost == 8 + 2 * CTrafficChecker::TRAFFIC_REORDER_WINDOW - 2);
+	TEST_CHECK(stats.nReordered == 2);
+	TEST_CHECK(stats.nStale == 1);
+
+	// Another session in between changes nothing of this one
+	FeedFrame(pChecker, 10, 0);
+	FeedFrame(pChecker, 9, 11 + 2 * CTrafficChecker::TRAFFIC_REORDER_WINDOW);
+	CTrafficSessionStats pSession = {};
+	TEST_CHECK(pChecker.GetSessionStats(9, pSession));
+	TEST_CHECK(pSession.nLost == stats.nLost);
+	TEST_CHECK(pChecker.GetStats().nLost == stats.nLost);
+}
+
+/**
+ * @brief Random arrival order with losses and duplicates, checked against counting by hand.
+ */
+static void TestRandomOrder()
+{
+	CTrafficChecker pChecker;
+	pChecker.Reset(0);
+	CTestRandom pRandom(21);
+	const uint64_t nFrames = 20000;
+	std::vector<uint64_t> vecOrder;
+	for (uint64_t nSequence = 0; nSequence < nFrames; nSequence++)
+	{
+		if (pRandom.Range(0, 19) != 0)
+		{
+			vecOrder.push_back(nSequence);
+		}
+		if (pRandom.Range(0, 49) == 0)
+		{
+			vecOrder.push_back(nSequence);
+		}
+	}
+	// Swap neighbours within a short distance, as a network path would
+	for (size_t nIndex = 0; nIndex + 8 < vecOrder.size(); nIndex++)
+	{
+		if (pRandom.Range(0, 9) == 0)
+		{
+			std::swap(vecOrder[nIndex], vecOrder[nIndex + static_cast<size_t>(pRandom.Range(1, 8))]);
+		}
+	}
+	std::vector<bool> vecReceived(nFrames, false);
+	uint64_t nDistinct = 0, nDuplicates = 0;
+	for (uint64_t nSequence : vecOrder)
+	{
+		FeedFrame(pChecker, 3, nSequence);
+		nDuplicates += vecReceived[nSequence] ? 1 : 0;
+		nDistinct += vecReceived[nSequence] ? 0 : 1;
+		vecReceived[nSequence] = true;
+	}
+	uint64_t nHigh = 0;
+	for (uint64_t nSequence = 0; nSequence < nFrames; nSequence++)
+	{
+		if (vecReceived[nSequence])
+		{
+			nHigh = std::max(nHigh, nSequence);
+		}
+	}
+	// Lost: the holes between the first frame that arrived and the highest
+	uint64_t nMissing = 0;
+	for (uint64_t nSequence = vecOrder.front(); nSequence <= nHigh; nSequence++)
+	{
+		nMissing += vecReceived[nSequence] ? 0 : 1;
+	}
+	const CTrafficCheckerStats stats = pChecker.GetStats();
+	printf("%llu frames, %llu lost, %llu reordered, %llu duplicates\n", static_cast<unsigned long long>(stats.nFrames),
+		static_cast<unsigned long long>(stats.nLost), static_cast<unsigned long long>(stats.nReordered),
+		static_cast<unsigned long long>(stats.nDuplicates));
+	TEST_CHECK(stats.nFrames == nDistinct);
+	TEST_CHECK(stats.nDuplicates == nDuplicates);
+	TEST_CHECK(stats.nLost == nMissing);
+	TEST_CHECK(stats.nLost < nFrames);
+}
+
+int main()
+{
+	setvbuf(stdout, nullptr, _IONBF, 0);
+	TestInterleavedSessions();
+	TestReorderBeforeBaseline();
+	TestLossAndLateFrames();
+	TestRandomOrder();
+	return TEST_RESULT();
+}
@@ -0,0 +1,209 @@
+/* Copyright (C) 2014-2026 Stefan-Mihai MOGA
+This file is part of IntelliPort application developed by Stefan-Mihai MOGA.
+IntelliPort is an alternative Windows version to the famous HyperTerminal!
+
+IntelliPort is free software: you can redistribute it and/or modify it
+under the terms of the GNU General Public License as published by the Open
+Source Initiative, either version 3 of the License, or any later version.
+
+IntelliPort is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+IntelliPort. If not, see <http://www.opensource.org/licenses/gpl-3.0.html>*/
+
+// TranscodeBenchmark.cpp : byte swap, UTF-16 to UTF-8 and UTF-8 validation speed against one code unit at a time
+//
+
+#include "Transcode.h"
+#include "UnitTest.h"
+
+#include <functional>
+#include <string>
+#include <vector>
+
+/**
+ * @brief The conversion before the vector kernels: one code unit per iteration.
+ */
+static size_t ScalarUtf16ToUtf8(const uint16_t* pSource, size_t nLength, bool bSwap, char* pOutput)
+{
+	char* pTarget = pOutput;
+	for (size_t nIndex = 0; nIndex < nLength; nIndex++)
+	{
+		uint32_t nCodePoint = bSwap ? static_cast<uint16_t>((pSource[nIndex] << 8) | (pSource[nIndex] >> 8)) : pSource[nIndex];
+		if ((nCodePoint >= 0xD800) && (nCodePoint <= 0xDBFF) && (nIndex + 1 < nLength))
+		{
+			const uint32_t nLow = bSwap ? static_cast<uint16_t>((pSource[nIndex + 1] << 8) | (pSource[nIndex + 1] >> 8)) : pSource[nIndex + 1];
+			if ((nLow >= 0xDC00) && (nLow <= 0xDFFF))
+			{
+				nCodePoint = 0x10000 + ((nCodePoint - 0xD800) << 10) + (nLow - 0xDC00);
+				nIndex++;
+			}
+		}
+		if ((nCodePoint >= 0xD800) && (nCodePoint <= 0xDFFF))
+			nCodePoint = 0xFFFD;
+		if (nCodePoint < 0x80)
+		{
+			*pTarget++ = static_cast<char>(nCodePoint);
+		}
+		else if (nCodePoint < 0x800)
+		{
+			*pTarget++ = static_cast<char>(0xC0 | (nCodePoint >> 6));
+			*pTarget++ = static_cast<char>(0x80 | (nCodePoint & 0x3F));
+		}
+		else if (nCodePoint < 0x10000)
+		{
+			*pTarget++ = static_cast<char>(0xE0 | (nCodePoint >> 12));
+			*pTarget++ = static_cast<char>(0x80 | ((nCodePoint >> 6) & 0x3F));
+			*pTarget++ = static_cast<char>(0x80 | (nCodePoint & 0x3F));
+		}
+		else
+		{
+			*pTarget++ = static_cast<char>(0xF0 | (nCodePoint >> 18));
+			*pTarget++ = static_cast<char>(0x80 | ((nCodePoint >> 12) & 0x3F));
+			*pTarget++ = static_cast<char>(0x80 | ((nCodePoint >> 6) & 0x3F));
+			*pTarget++ = static_cast<char>(0x80 | (nCodePoint & 0x3F));
+		}
+	}
+	return static_cast<size_t>(pTarget - pOutput);
+}
+
+/**
+ * @brief Byte-at-a-time validation, with the same rules as ValidateUtf8().
+ */
+static size_t ScalarValidateUtf8(const char* pData, size_t nLength)
+{
+	const unsigned char* pBytes = reinterpret_cast<const unsigned char*>(pData);
+	size_t nIndex = 0;
+	while (nIndex < nLength)
+	{
+		const unsigned char nLead = pBytes[nIndex];
+		if (nLead < 0x80)
+		{
+			nIndex++;
+			continue;
+		}
+		size_t nSize = 0;
+		unsigned char nLow = 0x80, nHigh = 0xBF;
+		if ((nLead >= 0xC2) && (nLead <= 0xDF))
+			nSize = 2;
+		else if ((nLead >= 0xE0) && (nLead <= 0xEF))
+		{
+			nSize = 3;
+			nLow = (nLead == 0xE0) ? 0xA0 : 0x80;
+			nHigh = (nLead == 0xED) ? 0x9F : 0xBF;
+		}
+		else if ((nLead >= 0xF0) && (nLead <= 0xF4))
+		{
+			nSize = 4;
+			nLow = (nLead == 0xF0) ? 0x90 : 0x80;
+			nHigh = (nLead == 0xF4) ? 0x8F : 0xBF;
+		}
+		if ((nSize == 0) || (nIndex + nSize > nLength) || (pBytes[nIndex + 1] < nLow) || (pBytes[nIndex + 1] > nHigh))
+			return nIndex;
+		for (size_t nByte = 2; nByte < nSize; nByte++)
+		{
+			if ((pBytes[nIndex + nByte] & 0xC0) != 0x80)
+				return nIndex;
+		}
+		nIndex += nSize;
+	}
+	return nLength;
+}
+
+/**
+ * @brief 1 MB worth of code units: log text, log text with some accented and
+ * Cyrillic words, or CJK with the odd emoji.
+ */
+static std::vector<uint16_t> MakeText(int nKind)
+{
+	CTestRandom pRandom(17);
+	std::vector<uint16_t> vecUnits;
+	while (vecUnits.size() < (1 << 19))
+	{
+		if (nKind == 0)
+		{
+			for (const char* lpszText = "2026-10-17 12:00:00 sensor 4: temp=21.5 C, status OK\r\n"; *lpszText != '\0'; lpszText++)
+				vecUnits.push_back(static_cast<uint16_t>(*lpszText));
+		}
+		else if (nKind == 1)
+		{
+			for (const char* lpszText = "status OK, port "; *lpszText != '\0'; lpszText++)
+				vecUnits.push_back(static_cast<uint16_t>(*lpszText));
+			for (uint64_t nUnit = pRandom.Range(3, 8); nUnit > 0; nUnit--)
+				vecUnits.push_back(static_cast<uint16_t>(pRandom.Range(0xC0, 0x45F)));
+			vecUnits.push_back('\n');
+		}
+		else
+		{
+			for (uint64_t nUnit = pRandom.Range(10, 30); nUnit > 0; nUnit--)
+				vecUnits.push_back(static_cast<uint16_t>(pRandom.Range(0x4E00, 0x9FFF)));
+			vecUnits.push_back(0xD83D);
+			vecUnits.push_back(static_cast<uint16_t>(pRandom.Range(0xDE00, 0xDE4F)));
+		}
+	}
+	vecUnits.resize(1 << 19);
+	return vecUnits;
+}
+
+/**
+ * @brief Runs pfnRun until about half a second has passed; returns GB/s of nBytes per run.
+ */
+static double Measure(size_t nBytes, const std::function<size_t()>& pfnRun)
+{
+	size_t nChecksum = 0, nRounds = 0;
+	CTestStopwatch pStopwatch;
+	double fSeconds = 0;
+	do
+	{
+		for (int nRound = 0; nRound < 16; nRound++, nRounds++)
+			nChecksum += pfnRun();
+		fSeconds = pStopwatch.GetSeconds();
+	} while (fSeconds < 0.5);
+	if (nChecksum == 0)
+		printf("nothing converted\n");
+	return static_cast<double>(nBytes) * nRounds / fSeconds / 1e9;
+}
+
+int main()
+{
+	setvbuf(stdout, nullptr, _IONBF, 0);
+#if defined(DELIMITER_SCANNER_AVX2)
+	printf("kernels: AVX2 and SSE2\n");
+#elif defined(DELIMITER_SCANNER_SSE2)
+	printf("kernels: SSE2\n");
+#else
+	printf("kernels: scalar\n");
+#endif
+	printf("GB/s of input, %s\n", "vector kernel / one unit at a time");
+	printf("%8s %18s %18s %18s %18s\n", "text", "swap", "UTF-16LE>UTF-8", "UTF-16BE>UTF-8", "validate UTF-8");
+	const char* lpszKinds[] = { "ASCII", "mixed", "CJK" };
+	for (int nKind = 0; nKind < 3; nKind++)
+	{
+		const std::vector<uint16_t> vecText = MakeText(nKind);
+		std::vector<uint16_t> vecSwapped(vecText.size());
+		SwapUtf16Bytes(vecText.data(), vecText.size(), vecSwapped.data());
+		std::vector<char> vecOutput(GetUtf8MaxLength(vecText.size()));
+		const std::string strUtf8(vecOutput.data(), Utf16ToUtf8(vecText.data(), vecText.size(), false, vecOutput.data()));
+		const size_t nBytes = vecText.size() * sizeof(uint16_t);
+		std::vector<uint16_t> vecTarget(vecText.size());
+
+		const double fSwap = Measure(nBytes, [&]() {
+			SwapUtf16Bytes(vecText.data(), vecText.size(), vecTarget.data());
+			return static_cast<size_t>(vecTarget[vecTarget.size() / 2]) + 1; });
+		const double fSwapScalar = Measure(nBytes, [&]() {
+			for (size_t nIndex = 0; nIndex < vecText.size(); nIndex++)
+				vecTarget[nIndex] = static_cast<uint16_t>((vecText[nIndex] << 8) | (vecText[nIndex] >> 8));
+			return static_cast<size_t>(vecTarget[vecTarget.size() / 2]) + 1; });
+		const double fLittle = Measure(nBytes, [&]() { return Utf16ToUtf8(vecText.data(), vecText.size(), false, vecOutput.data()); });
+		const double fLittleScalar = Measure(nBytes, [&]() { return ScalarUtf16ToUtf8(vecText.data(), vecText.size(), false, vecOutput.data()); });
+		const double fBig = Measure(nBytes, [&]() { return Utf16ToUtf8(vecSwapped.data(), vecSwapped.size(), true, vecOutput.data()); });
+		const double fBigScalar = Measure(nBytes, [&]() { return ScalarUtf16ToUtf8(vecSwapped.data(), vecSwapped.size(), true, vecOutput.data()); });
+		const double fValidate = Measure(strUtf8.size(), [&]() { return ValidateUtf8(strUtf8.data(), strUtf8.size()); });
+		const double fValidateScalar = Measure(strUtf8.size(), [&]() { return ScalarValidateUtf8(strUtf8.data(), strUtf8.size()); });
+		printf("%8s %8.2f / %7.2f %8.2f / %7.2f %8.2f / %7.2f %8.2f / %7.2f\n", lpszKinds[nKind],
+			fSwap, fSwapScalar, fLittle, fLittleScalar, fBig, fBigScalar, fValidate, fValidateScalar);
+	}
+	return 0;
+}
@@ -0,0 +1,331 @@
+/* Copyright (C) 2014-2026 Stefan-Mihai MOGA
+This file is part of IntelliPort application developed by Stefan-Mihai MOGA.
+IntelliPort is an alternative Windows version to the famous HyperTerminal!
+
+IntelliPort is free software: you can redistribute it and/or modify it
+under the terms of the GNU General Public License as published by the Open
+Source Initiative, either version 3 of the License, or any later version.
+
+IntelliPort is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+IntelliPort. If not, see <http://www.opensource.org/licenses/gpl-3.0.html>*/
+
+// TranscodeTest.cpp : vectorized byte swap, UTF-16 to UTF-8 and UTF-8 validation against scalar references
+//
+
+#include "Transcode.h"
+#include "UnitTest.h"
+
+#include <string>
+#include <vector>
+
+/**
+ * @brief One code unit at a time, as the document used to convert.
+ */
+static std::string ReferenceUtf16ToUtf8(const std::vector<uint16_t>& vecSource, bool bSwap)
+{
+	std::string strOutput;
+	auto pfnUnit = [&](size_t nIndex) {
+		const uint16_t nUnit = vecSource[nIndex];
+		return bSwap ? static_cast<uint16_t>((nUnit >> 8) | (nUnit << 8)) : nUnit;
+	};
+	for (size_t nIndex = 0; nIndex < vecSource.size(); nIndex++)
+	{
+		uint32_t nCodePoint = pfnUnit(nIndex);
+		if ((nCodePoint >= 0xD800) && (nCodePoint <= 0xDBFF) && (nIndex + 1 < vecSource.size()) &&
+			(pfnUnit(nIndex + 1) >= 0xDC00) && (pfnUnit(nIndex + 1) <= 0xDFFF))
+		{
+			nCodePoint = 0x10000 + ((nCodePoint - 0xD800) << 10) + (pfnUnit(++nIndex) - 0xDC00);
+		}
+		else if ((nCodePoint >= 0xD800) && (nCodePoint <= 0xDFFF))
+		{
+			nCodePoint = 0xFFFD;
+		}
+		if (nCodePoint < 0x80)
+		{
+			strOutput += static_cast<char>(nCodePoint);
+		}
+		else if (nCodePoint < 0x800)
+		{
+			strOutput += static_cast<char>(0xC0 | (nCodePoint >> 6));
+			strOutput += static_cast<char>(0x80 | (nCodePoint & 0x3F));
+		}
+		else if (nCodePoint < 0x10000)
+		{
+			strOutput += static_cast<char>(0xE0 | (nCodePoint >> 12));
+			strOutput += static_cast<char>(0x80 | ((nCodePoint >> 6) & 0x3F));
+			strOutput += static_cast<char>(0x80 | (nCodePoint & 0x3F));
+		}
+		else
+		{
+			strOutput += static_cast<char>(0xF0 | (nCodePoint >> 18));
+			strOutput += static_cast<char>(0x80 | ((nCodePoint >> 12) & 0x3F));
+			strOutput += static_cast<char>(0x80 | ((nCodePoint >> 6) & 0x3F));
+			strOutput += static_cast<char>(0x80 | (nCodePoint & 0x3F));
+		}
+	}
+	return strOutput;
+}
+
+/**
+ * @brief Decodes each sequence to its code point and rejects it by value: overlong,
+ * surrogate or past U+10FFFF.
+ * @return Offset of the first sequence that is not well-formed, or the length.
+ */
+static size_t ReferenceValidateUtf8(const std::string& strData)
+{
+	for (size_t nIndex = 0; nIndex < strData.size(); )
+	{
+		const unsigned char nLead = static_cast<unsigned char>(strData[nIndex]);
+		size_t nLength = 0;
+		uint32_t nCodePoint = 0;
+		if (nLead < 0x80)
+		{
+			nIndex++;
+			continue;
+		}
+		else if ((nLead & 0xE0) == 0xC0)
+		{
+			nLength = 2;
+			nCodePoint = nLead & 0x1F;
+		}
+		else if ((nLead & 0xF0) == 0xE0)
+		{
+			nLength = 3;
+			nCodePoint = nLead & 0x0F;
+		}
+		else if ((nLead & 0xF8) == 0xF0)
+		{
+			nLength = 4;
+			nCodePoint = nLead & 0x07;
+		}
+		else
+		{
+			return nIndex;
+		}
+		if (nIndex + nLength > strData.size())
+		{
+			return nIndex;
+		}
+		for (size_t nByte = 1; nByte < nLength; nByte++)
+		{
+			const unsigned char nNext = static_cast<unsigned char>(strData[nIndex + nByte]);
+			if ((nNext & 0xC0) != 0x80)
+			{
+				return nIndex;
+			}
+			nCodePoint = (nCodePoint << 6) | (nNext & 0x3F);
+		}
+		static const uint32_t nMinimum[5] = { 0, 0, 0x80, 0x800, 0x10000 };
+		if ((nCodePoint < nMinimum[nLength]) || (nCodePoint > 0x10FFFF) || ((nCodePoint >= 0xD800) && (nCodePoint <= 0xDFFF)))
+		{
+			return nIndex;
+		}
+		nIndex += nLength;
+	}
+	return strData.size();
+}
+
+/**
+ * @brief Code units mixing ASCII runs of every length around the vector widths with
+ * 2- and 3-byte characters, surrogate pairs and unpaired surrogates.
+ */
+static std::vector<uint16_t> RandomUtf16(CTestRandom& pRandom, size_t nLength)
+{
+	std::vector<uint16_t> vecUnits;
+	while (vecUnits.size() < nLength)
+	{
+		switch (pRandom.Range(0, 7))
+		{
+			case 0:
+			case 1:
+			case 2:
+			{
+				for (uint64_t nRun = pRandom.Range(0, 40); nRun > 0; nRun--)
+				{
+					vecUnits.push_back(static_cast<uint16_t>(pRandom.Range(0, 0x7F)));
+				}
+				break;
+			}
+			case 3:
+				vecUnits.push_back(static_cast<uint16_t>(pRandom.Range(0x80, 0x7FF)));
+				break;
+			case 4:
+			{
+				uint16_t nUnit = static_cast<uint16_t>(pRandom.Range(0x800, 0xFFFF));
+				vecUnits.push_back(((nUnit >= 0xD800) && (nUnit <= 0xDFFF)) ? 0xFFFE : nUnit);
+				break;
+			}
+			case 5:
+			case 6:
+				vecUnits.push_back(static_cast<uint16_t>(pRandom.Range(0xD800, 0xDBFF)));
+				vecUnits.push_back(static_cast<uint16_t>(pRandom.Range(0xDC00, 0xDFFF)));
+				break;
+			default:
+				vecUnits.push_back(static_cast<uint16_t>(pRandom.Range(0xD800, 0xDFFF)));
+				break;
+		}
+	}
+	vecUnits.resize(nLength);
+	return vecUnits;
+}
+
+static std::vector<uint16_t> Swapped(const std::vector<uint16_t>& vecUnits)
+{
+	std::vector<uint16_t> vecSwapped(vecUnits.size());
+	for (size_t nIndex = 0; nIndex < vecUnits.size(); nIndex++)
+	{
+		vecSwapped[nIndex] = static_cast<uint16_t>((vecUnits[nIndex] >> 8) | (vecUnits[nIndex] << 8));
+	}
+	return vecSwapped;
+}
+
+/**
+ * @brief Every length up to a few vectors, at every alignment, copied and in place.
+ */
+static void TestSwap()
+{
+	CTestRandom pRandom(17);
+	size_t nMismatches = 0;
+	for (size_t nLength = 0; nLength < 100; nLength++)
+	{
+		for (size_t nAlign = 0; nAlign < 8; nAlign++)
+		{
+			std::vector<uint16_t> vecBuffer(nAlign + nLength + 8, 0xAAAA);
+			for (size_t nIndex = 0; nIndex < nLength; nIndex++)
+			{
+				vecBuffer[nAlign + nIndex] = static_cast<uint16_t>(pRandom.Next());
+			}
+			const std::vector<uint16_t> vecSource(vecBuffer.begin() + nAlign, vecBuffer.begin() + nAlign + nLength);
+			std::vector<uint16_t> vecOutput(nLength + 8, 0x5555);
+			SwapUtf16Bytes(vecBuffer.data() + nAlign, nLength, vecOutput.data());
+			const std::vector<uint16_t> vecExpected = Swapped(vecSource);
+			nMismatches += (memcmp(vecOutput.data(), vecExpected.data(), nLength * sizeof(uint16_t)) != 0) ? 1 : 0;
+			nMismatches += (vecOutput[nLength] != 0x5555) ? 1 : 0;
+			SwapUtf16Bytes(vecBuffer.data() + nAlign, nLength, vecBuffer.data() + nAlign);
+			nMismatches += (memcmp(vecBuffer.data() + nAlign, vecExpected.data(), nLength * sizeof(uint16_t)) != 0) ? 1 : 0;
+			nMismatches += (vecBuffer[nAlign + nLength] != 0xAAAA) ? 1 : 0;
+		}
+	}
+	TEST_CHECK(nMismatches == 0);
+}
+
+/**
+ * @brief Random UTF-16 in both byte orders against the scalar encoder; the output is always valid UTF-8.
+ */
+static void TestUtf16ToUtf8()
+{
+	CTestRandom pRandom(18);
+	size_t nMismatches = 0, nInvalid = 0;
+	for (int nRound = 0; nRound < 20000; nRound++)
+	{
+		const std::vector<uint16_t> vecUnits = RandomUtf16(pRandom, static_cast<size_t>(pRandom.Range(0, (nRound < 19000) ? 80 : 5000)));
+		const std::string strExpected = ReferenceUtf16ToUtf8(vecUnits, false);
+		for (int nOrder = 0; nOrder < 2; nOrder++)
+		{
+			const bool bSwap = (nOrder == 1);
+			const std::vector<uint16_t> vecSource = bSwap ? Swapped(vecUnits) : vecUnits;
+			std::vector<char> vecOutput(GetUtf8MaxLength(vecSource.size()) + 1, '\x55');
+			const size_t nWritten = Utf16ToUtf8(vecSource.data(), vecSource.size(), bSwap, vecOutput.data());
+			nMismatches += ((nWritten != strExpected.size()) || (memcmp(vecOutput.data(), strExpected.data(), nWritten) != 0)) ? 1 : 0;
+			nMismatches += (vecOutput.back() != '\x55') ? 1 : 0;
+			nInvalid += (ValidateUtf8(vecOutput.data(), nWritten) != nWritten) ? 1 : 0;
+		}
+	}
+	TEST_CHECK(nMismatches == 0);
+	TEST_CHECK(nInvalid == 0);
+
+	// Every code unit on its own and after a run that ends just inside a vector
+	nMismatches = 0;
+	for (uint32_t nUnit = 0; nUnit <= 0xFFFF; nUnit++)
+	{
+		std::vector<uint16_t> vecUnits(static_cast<size_t>(nUnit % 37), 'a');
+		vecUnits.push_back(static_cast<uint16_t>(nUnit));
+		vecUnits.push_back(0xDC00);
+		vecUnits.push_back('z');
+		std::vector<char> vecOutput(GetUtf8MaxLength(vecUnits.size()));
+		const size_t nWritten = Utf16ToUtf8(vecUnits.data(), vecUnits.size(), false, vecOutput.data());
+		nMismatches += (std::string(vecOutput.data(), nWritten) != ReferenceUtf16ToUtf8(vecUnits, false)) ? 1 : 0;
+	}
+	TEST_CHECK(nMismatches == 0);
+}
+
+/**
+ * @brief Valid text with random damage, and every lead byte with every second byte,
+ * after ASCII runs that put them at each position of a vector.
+ */
+static void TestValidateUtf8()
+{
+	CTestRandom pRandom(19);
+	size_t nMismatches = 0, nValid = 0;
+	for (int nRound = 0; nRound < 30000; nRound++)
+	{
+		const std::vector<uint16_t> vecUnits = RandomUtf16(pRandom, static_cast<size_t>(pRandom.Range(0, 120)));
+		std::string strData = ReferenceUtf16ToUtf8(vecUnits, false);
+		const uint64_t nDamage = pRandom.Range(0, 3);
+		for (uint64_t nStep = 0; (nStep < nDamage) && !strData.empty(); nStep++)
+		{
+			const size_t nAt = static_cast<size_t>(pRandom.Range(0, strData.size() - 1));
+			switch (pRandom.Range(0, 3))
+			{
+				case 0:
+					strData[nAt] = static_cast<char>(pRandom.Next());
+					break;
+				case 1:
+					strData[nAt] = static_cast<char>(strData[nAt] ^ (1 << pRandom.Range(0, 7)));
+					break;
+				case 2:
+					strData.erase(nAt, 1);
+					break;
+				default:
+					strData.resize(nAt);
+					break;
+			}
+		}
+		const size_t nExpected = ReferenceValidateUtf8(strData);
+		nValid += (nExpected == strData.size()) ? 1 : 0;
+		nMismatches += (ValidateUtf8(strData.data(), strData.size()) != nExpected) ? 1 : 0;
+	}
+	TEST_CHECK(nMismatches == 0);
+	TEST_CHECK((nValid > 3000) && (nValid < 27000));
+
+	nMismatches = 0;
+	for (size_t nRun = 0; nRun < 40; nRun += 13)
+	{
+		for (uint32_t nLead = 0x80; nLead <= 0xFF; nLead++)
+		{
+			for (uint32_t nSecond = 0; nSecond <= 0xFF; nSecond++)
+			{
+				std::string strData(nRun, 'a');
+				strData += static_cast<char>(nLead);
+				strData += static_cast<char>(nSecond);
+				strData += "\x80\x80";
+				for (size_t nCut = nRun; nCut <= strData.size(); nCut++)
+				{
+					const std::string strPart = strData.substr(0, nCut);
+					nMismatches += (ValidateUtf8(strPart.data(), strPart.size()) != ReferenceValidateUtf8(strPart)) ? 1 : 0;
+				}
+			}
+		}
+	}
+	TEST_CHECK(nMismatches == 0);
+}
+
+int main()
+{
+	setvbuf(stdout, nullptr, _IONBF, 0);
+#if defined(DELIMITER_SCANNER_AVX2)
+	printf("kernels: AVX2 and SSE2\n");
+#elif defined(DELIMITER_SCANNER_SSE2)
+	printf("kernels: SSE2\n");
+#else
+	printf("kernels: scalar\n");
+#endif
+	TestSwap();
+	TestUtf16ToUtf8();
+	TestValidateUtf8();
+	return TEST_RESULT();
+}
@@ -0,0 +1,208 @@
+/* Copyright (C) 2014-2026 Stefan-Mihai MOGA
+This file is part of IntelliPort application developed by Stefan-Mihai MOGA.
+IntelliPort is an alternative Windows version to the famous HyperTerminal!
+
+IntelliPort is free software: you can redistribute it and/or modify it
+under the terms of the GNU General Public License as published by the Open
+Source Initiative, either version 3 of the License, or any later version.
+
+IntelliPort is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+IntelliPort. If not, see <http://www.opensource.org/licenses/gpl-3.0.html>*/
+
+// UdpEndpointTest.cpp : UDP destination lookup, time to live and batched datagram sends over loopback
+//
+
+#include "UdpEndpoint.h"
+#include "UnitTest.h"
+
+#include <arpa/inet.h>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+/**
+ * @brief A CUdpEndpoint whose next lookups can be made to fail.
+ */
+class CTestEndpoint : public CUdpEndpoint
+{
+public:
+	/**
+	 * @brief Every lookup from now on fails, as during a resolver outage.
+	 */
+	void BreakLookups()
+	{
+		m_nFamily = AF_UNIX; // getaddrinfo refuses the family at once
+	}
+};
+
+/**
+ * @brief A UDP socket bound to a free loopback port, with a receive timeout.
+ */
+static int BindReceiver(uint16_t& nPort)
+{
+	const int hSocket = socket(AF_INET, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+	sockaddr_in address = {};
+	address.sin_family = AF_INET;
+	address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+	socklen_t nLength = sizeof(address);
+	const int nBuffer = 4 << 20;
+	setsockopt(hSocket, SOL_SOCKET, SO_RCVBUF, &nBuffer, sizeof(nBuffer));
+	timeval timeout = { 2, 0 };
+	setsockopt(hSocket, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+	if ((bind(hSocket, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) ||
+		(getsockname(hSocket, reinterpret_cast<sockaddr*>(&address), &nLength) != 0))
+	{
+		close(hSocket);
+		return -1;
+	}
+	nPort = ntohs(address.sin_port);
+	return hSocket;
+}
+
+/**
+ * @brief Resolve() keeps ready-made addresses with the port patched in;
+ * Matches() and IsStale() follow the host, the port and the time to live.
+ */
+static void TestResolve()
+{
+	CTestEndpoint pEndpoint;
+	TEST_CHECK(!pEndpoint.IsResolved());
+	TEST_CHECK(pEndpoint.Resolve("127.0.0.1", 5555, AF_INET) == 0);
+	TEST_CHECK(pEndpoint.IsResolved());
+	TEST_CHECK(pEndpoint.GetCount() == 1);
+	TEST_CHECK(pEndpoint.GetCurrent() == 0);
+	const sockaddr_in* pAddress = reinterpret_cast<const sockaddr_in*>(pEndpoint.GetAddress(0));
+	TEST_CHECK(pAddress->sin_family == AF_INET);
+	TEST_CHECK(ntohs(pAddress->sin_port) == 5555);
+	TEST_CHECK(ntohl(pAddress->sin_addr.s_addr) == INADDR_LOOPBACK);
+	TEST_CHECK(pEndpoint.GetLength(0) == static_cast<int>(sizeof(sockaddr_in)));
+	TEST_CHECK(pEndpoint.Matches("127.0.0.1", 5555));
+	TEST_CHECK(!pEndpoint.Matches("127.0.0.1", 5556));
+	TEST_CHECK(!pEndpoint.Matches("127.0.0.2", 5555));
+	TEST_CHECK(!pEndpoint.IsStale()); // no time to live: never stale
+
+	// No host: the loopback address, in both families if the system has both
+	TEST_CHECK(pEndpoint.Resolve(nullptr, 7, AF_UNSPEC) == 0);
+	TEST_CHECK(pEndpoint.GetCount() >= 1);
+	TEST_CHECK(pEndpoint.Matches("", 7));
+	for (size_t nIndex = 0; nIndex < pEndpoint.GetCount(); nIndex++)
+	{
+		const sockaddr* pAny = pEndpoint.GetAddress(nIndex);
+		TEST_CHECK((pAny->sa_family == AF_INET) || (pAny->sa_family == AF_INET6));
+		const uint16_t nPort = (pAny->sa_family == AF_INET) ? reinterpret_cast<const sockaddr_in*>(pAny)->sin_port :
+			reinterpret_cast<const sockaddr_in6*>(pAny)->sin6_port;
+		TEST_CHECK(ntohs(nPort) == 7);
+	}
+}
+
+/**
+ * @brief A failed lookup keeps the addresses that worked, and is not retried
+ * before the time to live has passed again.
+ */
+static void TestRefresh()
+{
+	CTestEndpoint pEndpoint;
+	TEST_CHECK(pEndpoint.Resolve("127.0.0.1", 6000, AF_INET, 1) == 0);
+	TEST_CHECK(!pEndpoint.IsStale());
+	std::this_thread::sleep_for(std::chrono::milliseconds(1100));
+	TEST_CHECK(pEndpoint.IsStale());
+
+	// A lookup that works starts the time to live again
+	TEST_CHECK(pEndpoint.Refresh() == 0);
+	TEST_CHECK(!pEndpoint.IsStale());
+	TEST_CHECK(pEndpoint.GetCount() == 1);
+
+	// The resolver goes away: the old address stays, and so does the session
+	std::this_thread::sleep_for(std::chrono::milliseconds(1100));
+	TEST_CHECK(pEndpoint.IsStale());
+	pEndpoint.BreakLookups();
+	TEST_CHECK(pEndpoint.Refresh() != 0);
+	TEST_CHECK(pEndpoint.IsResolved());
+	TEST_CHECK(pEndpoint.GetCount() == 1);
+	const sockaddr_in* pAddress = reinterpret_cast<const sockaddr_in*>(pEndpoint.GetAddress(0));
+	TEST_CHECK((ntohs(pAddress->sin_port) == 6000) && (ntohl(pAddress->sin_addr.s_addr) == INADDR_LOOPBACK));
+	TEST_CHECK(!pEndpoint.IsStale());
+
+	// A failed first lookup leaves nothing to send to
+	CTestEndpoint pBroken;
+	TEST_CHECK(pBroken.Resolve("127.0.0.1", 6000, AF_UNIX) != 0);
+	TEST_CHECK(!pBroken.IsResolved());
+}
+
+/**
+ * @brief Batches longer than UDP_SEND_BATCH arrive whole, in order and with
+ * their boundaries; a datagram that cannot be sent ends the batch at it.
+ */
+static void TestSendMany()
+{
+	uint16_t nPort = 0;
+	const int hReceiver = BindReceiver(nPort);
+	TEST_CHECK(hReceiver >= 0);
+	const int hSender = socket(AF_INET, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+	CUdpEndpoint pEndpoint;
+	TEST_CHECK(pEndpoint.Resolve("127.0.0.1", nPort, AF_INET) == 0);
+
+	// Resolved once, sent many times: two full batches and a partial one
+	const int nCount = 2 * UDP_SEND_BATCH + 22;
+	std::vector<std::string> vecPayloads;
+	std::vector<CUdpDatagram> vecDatagrams;
+	for (int nIndex = 0; nIndex < nCount; nIndex++)
+	{
+		vecPayloads.push_back("datagram " + std::to_string(nIndex) + std::string(static_cast<size_t>(nIndex * 7 % 300), 'x'));
+	}
+	for (const std::string& strPayload : vecPayloads)
+	{
+		vecDatagrams.push_back(CUdpDatagram{ strPayload.data(), strPayload.size() });
+	}
+	TEST_CHECK(UdpSendMany(hSender, vecDatagrams.data(), nCount, pEndpoint.GetAddress(0), pEndpoint.GetLength(0), 0) == nCount);
+	int nReceived = 0, nMismatches = 0;
+	char pBuffer[0x10000];
+	for (; nReceived < nCount; nReceived++)
+	{
+		const ssize_t nLength = recv(hReceiver, pBuffer, sizeof(pBuffer), 0);
+		if (nLength < 0)
+		{
+			break;
+		}
+		nMismatches += (std::string(pBuffer, static_cast<size_t>(nLength)) != vecPayloads[nReceived]) ? 1 : 0;
+	}
+	TEST_CHECK(nReceived == nCount);
+	TEST_CHECK(nMismatches == 0);
+
+	// Too large for UDP in the middle of a batch: the ones before it are sent
+	const std::string strTooLarge(70000, 'y');
+	vecDatagrams[5] = CUdpDatagram{ strTooLarge.data(), strTooLarge.size() };
+	TEST_CHECK(UdpSendMany(hSender, vecDatagrams.data(), 10, pEndpoint.GetAddress(0), pEndpoint.GetLength(0), 0) == 5);
+	for (nReceived = 0, nMismatches = 0; nReceived < 5; nReceived++)
+	{
+		const ssize_t nLength = recv(hReceiver, pBuffer, sizeof(pBuffer), 0);
+		if (nLength < 0)
+		{
+			break;
+		}
+		nMismatches += (std::string(pBuffer, static_cast<size_t>(nLength)) != vecPayloads[nReceived]) ? 1 : 0;
+	}
+	TEST_CHECK(nReceived == 5);
+	TEST_CHECK(nMismatches == 0);
+	TEST_CHECK(recv(hReceiver, pBuffer, sizeof(pBuffer), MSG_DONTWAIT) < 0);
+
+	// Nothing to send, and nothing sent at all
+	TEST_CHECK(UdpSendMany(hSender, vecDatagrams.data(), 0, pEndpoint.GetAddress(0), pEndpoint.GetLength(0), 0) == 0);
+	TEST_CHECK(UdpSendMany(-1, vecDatagrams.data(), 3, pEndpoint.GetAddress(0), pEndpoint.GetLength(0), 0) == -1);
+	close(hSender);
+	close(hReceiver);
+}
+
+int main()
+{
+	setvbuf(stdout, nullptr, _IONBF, 0);
+	TestResolve();
+	TestRefresh();
+	TestSendMany();
+	return TEST_RESULT();
+}
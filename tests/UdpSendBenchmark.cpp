@@ -0,0 +1,133 @@
+/* Copyright (C) 2014-2026 Stefan-Mihai MOGA
+This file is part of IntelliPort application developed by Stefan-Mihai MOGA.
+IntelliPort is an alternative Windows version to the famous HyperTerminal!
+
+IntelliPort is free software: you can redistribute it and/or modify it
+under the terms of the GNU General Public License as published by the Open
+Source Initiative, either version 3 of the License, or any later version.
+
+IntelliPort is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+IntelliPort. If not, see <http://www.opensource.org/licenses/gpl-3.0.html>*/
+
+// UdpSendBenchmark.cpp : loopback datagrams/s, a lookup per datagram against a resolved endpoint and batched sends
+//
+
+#include "UdpEndpoint.h"
+#include "UnitTest.h"
+
+#include <arpa/inet.h>
+#include <functional>
+#include <unistd.h>
+#include <vector>
+
+/**
+ * @brief The send before CUdpEndpoint: format the port, getaddrinfo, sendto
+ * the first address that takes the datagram, freeaddrinfo.
+ */
+static bool SendToLookingUp(int hSocket, const char* pData, size_t nLength, const char* lpszHost, unsigned int nPort)
+{
+	char lpszPort[16] = { 0, };
+	snprintf(lpszPort, sizeof(lpszPort), "%u", nPort);
+	addrinfo hints = {};
+	hints.ai_family = AF_UNSPEC;
+	hints.ai_socktype = SOCK_DGRAM;
+	hints.ai_protocol = IPPROTO_UDP;
+	addrinfo* pList = nullptr;
+	if (getaddrinfo(lpszHost, lpszPort, &hints, &pList) != 0)
+	{
+		return false;
+	}
+	bool bSent = false;
+	for (const addrinfo* pAddress = pList; (pAddress != nullptr) && !bSent; pAddress = pAddress->ai_next)
+	{
+		bSent = (sendto(hSocket, pData, nLength, 0, pAddress->ai_addr, pAddress->ai_addrlen) >= 0);
+	}
+	freeaddrinfo(pList);
+	return bSent;
+}
+
+/**
+ * @brief Sends for about half a second; returns datagrams/s. pfnSend sends
+ * nBatch datagrams and returns how many were sent.
+ */
+static double Measure(const std::function<int()>& pfnSend)
+{
+	uint64_t nSent = 0;
+	CTestStopwatch pStopwatch;
+	double fSeconds = 0;
+	do
+	{
+		for (int nRound = 0; nRound < 16; nRound++)
+		{
+			nSent += static_cast<uint64_t>(pfnSend());
+		}
+		fSeconds = pStopwatch.GetSeconds();
+	} while (fSeconds < 0.5);
+	return static_cast<double>(nSent) / fSeconds;
+}
+
+int main()
+{
+	setvbuf(stdout, nullptr, _IONBF, 0);
+
+	// A receiver that never reads: the kernel drops what does not fit, the sends still succeed
+	const int hReceiver = socket(AF_INET, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+	sockaddr_in address = {};
+	address.sin_family = AF_INET;
+	address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+	socklen_t nAddressLength = sizeof(address);
+	if ((bind(hReceiver, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) ||
+		(getsockname(hReceiver, reinterpret_cast<sockaddr*>(&address), &nAddressLength) != 0))
+	{
+		printf("cannot bind a loopback receiver\n");
+		return 1;
+	}
+	const unsigned int nPort = ntohs(address.sin_port);
+	const int hSender = socket(AF_INET, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+
+	printf("datagrams/s to %s:%u\n", "localhost", nPort);
+	printf("%8s %18s %18s %18s %10s\n", "size", "getaddrinfo+sendto", "resolved+sendto", "resolved+sendmmsg", "speedup");
+	const size_t nSizes[] = { 16, 64, 512, 1400 };
+	for (const size_t nSize : nSizes)
+	{
+		const std::vector<char> vecPayload(nSize, 'u');
+		std::vector<CUdpDatagram> vecDatagrams(UDP_SEND_BATCH, CUdpDatagram{ vecPayload.data(), nSize });
+		CUdpEndpoint pEndpoint;
+		if (pEndpoint.Resolve("localhost", nPort, AF_INET) != 0)
+		{
+			printf("cannot resolve localhost\n");
+			return 1;
+		}
+
+		const double fLookingUp = Measure([&]()
+		{
+			int nSent = 0;
+			for (int nIndex = 0; nIndex < UDP_SEND_BATCH; nIndex++)
+			{
+				nSent += SendToLookingUp(hSender, vecPayload.data(), nSize, "localhost", nPort) ? 1 : 0;
+			}
+			return nSent;
+		});
+		const double fResolved = Measure([&]()
+		{
+			int nSent = 0;
+			for (int nIndex = 0; nIndex < UDP_SEND_BATCH; nIndex++)
+			{
+				nSent += (sendto(hSender, vecPayload.data(), nSize, 0, pEndpoint.GetAddress(0), pEndpoint.GetLength(0)) >= 0) ? 1 : 0;
+			}
+			return nSent;
+		});
+		const double fBatched = Measure([&]()
+		{
+			return UdpSendMany(hSender, vecDatagrams.data(), UDP_SEND_BATCH, pEndpoint.GetAddress(0), pEndpoint.GetLength(0), 0);
+		});
+		printf("%8zu %18.0f %18.0f %18.0f %9.1fx\n", nSize, fLookingUp, fResolved, fBatched, fBatched / fLookingUp);
+	}
+	close(hSender);
+	close(hReceiver);
+	return 0;
+}
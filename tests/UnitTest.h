@@ -0,0 +1,86 @@
+/* Copyright (C) 2014-2026 Stefan-Mihai MOGA
+This file is part of IntelliPort application developed by Stefan-Mihai MOGA.
+IntelliPort is an alternative Windows version to the famous HyperTerminal!
+
+IntelliPort is free software: you can redistribute it and/or modify it
+under the terms of the GNU General Public License as published by the Open
+Source Initiative, either version 3 of the License, or any later version.
+
+IntelliPort is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+IntelliPort. If not, see <http://www.opensource.org/licenses/gpl-3.0.html>*/
+
+// UnitTest.h : minimal checks and timing shared by the tests and benchmarks
+//
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+
+/**
+ * @brief Number of failed checks; a test returns TEST_RESULT() from main.
+ */
+inline int g_nFailedChecks = 0;
+
+#define TEST_CHECK(expr) \
+	do { \
+		if (!(expr)) { \
+			fprintf(stderr, "%s(%d): check failed: %s\n", __FILE__, __LINE__, #expr); \
+			g_nFailedChecks++; \
+		} \
+	} while (0)
+
+#define TEST_RESULT() \
+	((g_nFailedChecks == 0) ? (printf("all checks passed\n"), 0) : (printf("%d check(s) failed\n", g_nFailedChecks), 1))
+
+/**
+ * @brief Deterministic pseudo-random numbers (xorshift64*), so a failure can be replayed.
+ */
+class CTestRandom
+{
+public:
+	explicit CTestRandom(uint64_t nSeed = 0x9E3779B97F4A7C15ull) : m_nState(nSeed | 1)
+	{
+	}
+
+	uint64_t Next()
+	{
+		m_nState ^= m_nState >> 12;
+		m_nState ^= m_nState << 25;
+		m_nState ^= m_nState >> 27;
+		return m_nState * 0x2545F4914F6CDD1Dull;
+	}
+
+	/** @brief Returns a number in [nLow, nHigh]. */
+	uint64_t Range(uint64_t nLow, uint64_t nHigh)
+	{
+		return nLow + (Next() % (nHigh - nLow + 1));
+	}
+
+protected:
+	uint64_t m_nState;
+};
+
+/**
+ * @brief Seconds elapsed since construction.
+ */
+class CTestStopwatch
+{
+public:
+	CTestStopwatch() : m_tStart(std::chrono::steady_clock::now())
+	{
+	}
+
+	double GetSeconds() const
+	{
+		return std::chrono::duration<double>(std::chrono::steady_clock::now() - m_tStart).count();
+	}
+
+protected:
+	std::chrono::steady_clock::time_point m_tStart;
+};
@@ -0,0 +1,274 @@
+/* Copyright (C) 2014-2026 Stefan-Mihai MOGA
+This file is part of IntelliPort application developed by Stefan-Mihai MOGA.
+IntelliPort is an alternative Windows version to the famous HyperTerminal!
+
+IntelliPort is free software: you can redistribute it and/or modify it
+under the terms of the GNU General Public License as published by the Open
+Source Initiative, either version 3 of the License, or any later version.
+
+IntelliPort is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+IntelliPort. If not, see <http://www.opensource.org/licenses/gpl-3.0.html>*/
+
+// Utf8DecoderBenchmark.cpp : received text to display text, the streaming decoder and normalizer against the two-pass conversion and three Replace passes
+//
+
+#include "Utf8Decoder.h"
+#include "LineEndingNormalizer.h"
+#include "UnitTest.h"
+
+#include <algorithm>
+#include <functional>
+#include <string>
+#include <vector>
+
+/**
+ * @brief One pass of MultiByteToWideChar(CP_UTF8): counts the characters when
+ * pOutput is nullptr, converts otherwise. Invalid bytes become U+FFFD.
+ */
+static size_t ConvertUtf8(const char* pData, size_t nLength, wchar_t* pOutput)
+{
+	const unsigned char* pBytes = reinterpret_cast<const unsigned char*>(pData);
+	size_t nCount = 0;
+	size_t nIndex = 0;
+	while (nIndex < nLength)
+	{
+		const unsigned char nLead = pBytes[nIndex];
+		uint32_t nCodePoint = nLead;
+		size_t nSize = 1;
+		if (nLead >= 0x80)
+		{
+			nSize = ((nLead >= 0xC2) && (nLead <= 0xDF)) ? 2 : (((nLead >= 0xE0) && (nLead <= 0xEF)) ? 3 : (((nLead >= 0xF0) && (nLead <= 0xF4)) ? 4 : 0));
+			nCodePoint = nLead & (0x7F >> nSize);
+			for (size_t nByte = 1; (nSize != 0) && (nByte < nSize); nByte++)
+			{
+				if ((nIndex + nByte >= nLength) || ((pBytes[nIndex + nByte] & 0xC0) != 0x80))
+					nSize = 0;
+				else
+					nCodePoint = (nCodePoint << 6) | (pBytes[nIndex + nByte] & 0x3F);
+			}
+			if (nSize == 0)
+			{
+				nSize = 1;
+				nCodePoint = 0xFFFD;
+			}
+		}
+		if ((sizeof(wchar_t) == 2) && (nCodePoint >= 0x10000))
+		{
+			if (pOutput != nullptr)
+			{
+				pOutput[nCount] = static_cast<wchar_t>(0xD800 + ((nCodePoint - 0x10000) >> 10));
+				pOutput[nCount + 1] = static_cast<wchar_t>(0xDC00 + ((nCodePoint - 0x10000) & 0x3FF));
+			}
+			nCount += 2;
+		}
+		else
+		{
+			if (pOutput != nullptr)
+				pOutput[nCount] = static_cast<wchar_t>(nCodePoint);
+			nCount++;
+		}
+		nIndex += nSize;
+	}
+	return nCount;
+}
+
+/**
+ * @brief The conversion before CUtf8Decoder: utf8_to_wstring sized the
+ * result with a first pass, allocated it and converted with a second, and the
+ * caller copied it into a CString.
+ */
+static std::wstring TwoPassUtf8ToWString(const char* pData, size_t nLength)
+{
+	const size_t nNeeded = ConvertUtf8(pData, nLength, nullptr);
+	std::wstring strResult(nNeeded, 0);
+	ConvertUtf8(pData, nLength, &strResult[0]);
+	return std::wstring(strResult.c_str());
+}
+
+/**
+ * @brief CString::Replace: counts the matches, then rebuilds the string
+ * into a new buffer when there is any.
+ */
+static void ReplaceAll(std::wstring& strText, const wchar_t* lpszOld, const wchar_t* lpszNew)
+{
+	const std::wstring strOld(lpszOld), strNew(lpszNew);
+	size_t nMatches = 0;
+	for (size_t nFound = strText.find(strOld); nFound != std::wstring::npos; nFound = strText.find(strOld, nFound + strOld.size()))
+		nMatches++;
+	if (nMatches == 0)
+		return;
+	std::wstring strResult;
+	strResult.reserve(strText.size() + nMatches * strNew.size() - nMatches * strOld.size());
+	size_t nStart = 0;
+	for (size_t nFound = strText.find(strOld); nFound != std::wstring::npos; nFound = strText.find(strOld, nStart))
+	{
+		strResult.append(strText, nStart, nFound - nStart);
+		strResult.append(strNew);
+		nStart = nFound + strOld.size();
+	}
+	strResult.append(strText, nStart, std::wstring::npos);
+	strText.swap(strResult);
+}
+
+/**
+ * @brief The line ending conversion before CLineEndingNormalizer: three Replace passes.
+ */
+static void ReplaceLineEndings(std::wstring& strText)
+{
+	ReplaceAll(strText, L"\r\n", L"\n");
+	ReplaceAll(strText, L"\r", L"\n");
+	ReplaceAll(strText, L"\n", L"\r\n");
+}
+
+/**
+ * @brief 1 MB of UTF-8 received text: log lines, log lines with accented and
+ * Cyrillic words, or CJK with the odd emoji; line endings CRLF, LF or CR.
+ */
+static std::string MakeText(int nKind)
+{
+	CTestRandom pRandom(12);
+	std::string strText;
+	const char* lpszEndings[] = { "\r\n", "\n", "\r" };
+	while (strText.size() < (1 << 20))
+	{
+		if (nKind == 0)
+		{
+			strText += "2026-10-17 12:00:00 sensor 4: temp=21.5 C, status OK";
+		}
+		else if (nKind == 1)
+		{
+			strText += "status OK, port ";
+			for (uint64_t nCount = pRandom.Range(3, 8); nCount > 0; nCount--)
+			{
+				const uint32_t nCodePoint = static_cast<uint32_t>(pRandom.Range(0xC0, 0x45F));
+				strText += static_cast<char>(0xC0 | (nCodePoint >> 6));
+				strText += static_cast<char>(0x80 | (nCodePoint & 0x3F));
+			}
+		}
+		else
+		{
+			for (uint64_t nCount = pRandom.Range(10, 30); nCount > 0; nCount--)
+			{
+				const uint32_t nCodePoint = static_cast<uint32_t>(pRandom.Range(0x4E00, 0x9FFF));
+				strText += static_cast<char>(0xE0 | (nCodePoint >> 12));
+				strText += static_cast<char>(0x80 | ((nCodePoint >> 6) & 0x3F));
+				strText += static_cast<char>(0x80 | (nCodePoint & 0x3F));
+			}
+			strText += "\xF0\x9F\x98\x80";
+		}
+		strText += lpszEndings[pRandom.Range(0, 9) == 0 ? pRandom.Range(1, 2) : 0];
+	}
+	return strText;
+}
+
+/**
+ * @brief Runs pfnRun until about half a second has passed; returns MB/s of nBytes per run.
+ */
+static double Measure(size_t nBytes, const std::function<size_t()>& pfnRun)
+{
+	size_t nChecksum = 0, nRounds = 0;
+	CTestStopwatch pStopwatch;
+	double fSeconds = 0;
+	do
+	{
+		for (int nRound = 0; nRound < 4; nRound++, nRounds++)
+			nChecksum += pfnRun();
+		fSeconds = pStopwatch.GetSeconds();
+	} while (fSeconds < 0.5);
+	if (nChecksum == 0)
+		printf("nothing converted\n");
+	return static_cast<double>(nBytes) * nRounds / fSeconds / 1e6;
+}
+
+int main()
+{
+	setvbuf(stdout, nullptr, _IONBF, 0);
+	const size_t nChunk = 2048; // bytes received per frame
+	printf("MB/s of UTF-8 input in %zu-byte chunks, %s\n", nChunk, "before / after");
+	printf("%8s %24s %24s %24s\n", "text", "decode", "line endings", "both");
+	const char* lpszKinds[] = { "ASCII", "mixed", "CJK" };
+	for (int nKind = 0; nKind < 3; nKind++)
+	{
+		const std::string strText = MakeText(nKind);
+		const size_t nBytes = strText.size();
+		CUtf8Decoder pDecoder;
+		CLineEndingNormalizer<wchar_t> pLineEnding;
+		std::wstring strDecoded, strDisplay;
+
+		// The same characters both ways, on the text as a whole
+		std::wstring strExpected = TwoPassUtf8ToWString(strText.data(), nBytes);
+		pDecoder.Decode(strText.data(), nBytes, strDecoded);
+		if (strDecoded != strExpected)
+			printf("%s: the decoders differ\n", lpszKinds[nKind]);
+		ReplaceLineEndings(strExpected);
+		pLineEnding.Normalize(strDecoded.data(), strDecoded.size(), strDisplay);
+		if (strDisplay != strExpected)
+			printf("%s: the line endings differ\n", lpszKinds[nKind]);
+
+		// Decoded chunks for the line ending passes, as each frame hands them over
+		std::vector<std::wstring> vecDecoded;
+		for (size_t nOffset = 0; nOffset < nBytes; nOffset += nChunk)
+		{
+			strDecoded.clear();
+			pDecoder.Decode(strText.data() + nOffset, std::min(nChunk, nBytes - nOffset), strDecoded);
+			vecDecoded.push_back(strDecoded);
+		}
+
+		const double fTwoPass = Measure(nBytes, [&]() {
+			size_t nCount = 0;
+			for (size_t nOffset = 0; nOffset < nBytes; nOffset += nChunk)
+				nCount += TwoPassUtf8ToWString(strText.data() + nOffset, std::min(nChunk, nBytes - nOffset)).size();
+			return nCount; });
+		const double fDecoder = Measure(nBytes, [&]() {
+			size_t nCount = 0;
+			for (size_t nOffset = 0; nOffset < nBytes; nOffset += nChunk)
+			{
+				strDecoded.clear();
+				nCount += pDecoder.Decode(strText.data() + nOffset, std::min(nChunk, nBytes - nOffset), strDecoded);
+			}
+			return nCount; });
+		const double fReplace = Measure(nBytes, [&]() {
+			size_t nCount = 0;
+			for (const std::wstring& strChunk : vecDecoded)
+			{
+				std::wstring strChunkText(strChunk);
+				ReplaceLineEndings(strChunkText);
+				nCount += strChunkText.size();
+			}
+			return nCount; });
+		const double fNormalizer = Measure(nBytes, [&]() {
+			size_t nCount = 0;
+			for (const std::wstring& strChunk : vecDecoded)
+			{
+				strDisplay.clear();
+				nCount += pLineEnding.Normalize(strChunk.data(), strChunk.size(), strDisplay);
+			}
+			return nCount; });
+		const double fBefore = Measure(nBytes, [&]() {
+			size_t nCount = 0;
+			for (size_t nOffset = 0; nOffset < nBytes; nOffset += nChunk)
+			{
+				std::wstring strChunkText(TwoPassUtf8ToWString(strText.data() + nOffset, std::min(nChunk, nBytes - nOffset)));
+				ReplaceLineEndings(strChunkText);
+				nCount += strChunkText.size();
+			}
+			return nCount; });
+		const double fAfter = Measure(nBytes, [&]() {
+			size_t nCount = 0;
+			for (size_t nOffset = 0; nOffset < nBytes; nOffset += nChunk)
+			{
+				strDecoded.clear();
+				strDisplay.clear();
+				pDecoder.Decode(strText.data() + nOffset, std::min(nChunk, nBytes - nOffset), strDecoded);
+				nCount += pLineEnding.Normalize(strDecoded.data(), strDecoded.size(), strDisplay);
+			}
+			return nCount; });
+		printf("%8s %11.0f / %10.0f %11.0f / %10.0f %11.0f / %10.0f\n", lpszKinds[nKind],
+			fTwoPass, fDecoder, fReplace, fNormalizer, fBefore, fAfter);
+	}
+	return 0;
+}
@@ -0,0 +1,284 @@
+/* Copyright (C) 2014-2026 Stefan-Mihai MOGA
+This file is part of IntelliPort application developed by Stefan-Mihai MOGA.
+IntelliPort is an alternative Windows version to the famous HyperTerminal!
+
+IntelliPort is free software: you can redistribute it and/or modify it
+under the terms of the GNU General Public License as published by the Open
+Source Initiative, either version 3 of the License, or any later version.
+
+IntelliPort is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+IntelliPort. If not, see <http://www.opensource.org/licenses/gpl-3.0.html>*/
+
+// Utf8DecoderTest.cpp : split-boundary fuzz of CUtf8Decoder and CLineEndingNormalizer
+//
+
+#include "LineEndingNormalizer.h"
+#include "Utf8Decoder.h"
+#include "UnitTest.h"
+
+#include <string>
+#include <vector>
+
+/**
+ * @brief Straightforward decoder of a whole string, one U+FFFD per maximal
+ * invalid subpart, used as the reference for CUtf8Decoder.
+ */
+static std::wstring ReferenceDecode(const std::string& strInput)
+{
+	std::wstring strOutput;
+	const size_t nLength = strInput.size();
+	size_t nIndex = 0;
+	while (nIndex < nLength)
+	{
+		const unsigned char nByte = static_cast<unsigned char>(strInput[nIndex]);
+		int nNeed = 0;
+		unsigned char nLower = 0x80, nUpper = 0xBF;
+		uint32_t nCodePoint = 0;
+		if (nByte < 0x80)
+		{
+			strOutput.push_back((nByte != 0) ? static_cast<wchar_t>(nByte) : CUtf8Decoder::UTF8_NUL_SYMBOL);
+			nIndex++;
+			continue;
+		}
+		else if ((nByte >= 0xC2) && (nByte <= 0xDF))
+			nNeed = 1, nCodePoint = nByte & 0x1F;
+		else if ((nByte >= 0xE0) && (nByte <= 0xEF))
+			nNeed = 2, nCodePoint = nByte & 0x0F, nLower = (nByte == 0xE0) ? 0xA0 : 0x80, nUpper = (nByte == 0xED) ? 0x9F : 0xBF;
+		else if ((nByte >= 0xF0) && (nByte <= 0xF4))
+			nNeed = 3, nCodePoint = nByte & 0x07, nLower = (nByte == 0xF0) ? 0x90 : 0x80, nUpper = (nByte == 0xF4) ? 0x8F : 0xBF;
+		else
+		{
+			strOutput.push_back(CUtf8Decoder::UTF8_REPLACEMENT_CHAR);
+			nIndex++;
+			continue;
+		}
+
+		size_t nNext = nIndex + 1;
+		bool bComplete = true;
+		for (int nCount = 0; nCount < nNeed; nCount++, nNext++)
+		{
+			if (nNext == nLength)
+			{
+				bComplete = false;
+				break;
+			}
+			const unsigned char nContinuation = static_cast<unsigned char>(strInput[nNext]);
+			if ((nContinuation < nLower) || (nContinuation > nUpper))
+			{
+				bComplete = false;
+				break;
+			}
+			nCodePoint = (nCodePoint << 6) | (nContinuation & 0x3F);
+			nLower = 0x80;
+			nUpper = 0xBF;
+		}
+		if (!bComplete)
+		{
+			strOutput.push_back(CUtf8Decoder::UTF8_REPLACEMENT_CHAR);
+		}
+		else if ((sizeof(wchar_t) == 2) && (nCodePoint >= 0x10000))
+		{
+			strOutput.push_back(static_cast<wchar_t>(0xD800 + ((nCodePoint - 0x10000) >> 10)));
+			strOutput.push_back(static_cast<wchar_t>(0xDC00 + ((nCodePoint - 0x10000) & 0x3FF)));
+		}
+		else
+		{
+			strOutput.push_back(static_cast<wchar_t>(nCodePoint));
+		}
+		nIndex = nNext;
+	}
+	return strOutput;
+}
+
+static void AppendUtf8(std::string& strOutput, uint32_t nCodePoint)
+{
+	if (nCodePoint < 0x80)
+		strOutput += static_cast<char>(nCodePoint);
+	else if (nCodePoint < 0x800)
+		strOutput += static_cast<char>(0xC0 | (nCodePoint >> 6)), strOutput += static_cast<char>(0x80 | (nCodePoint & 0x3F));
+	else if (nCodePoint < 0x10000)
+		strOutput += static_cast<char>(0xE0 | (nCodePoint >> 12)), strOutput += static_cast<char>(0x80 | ((nCodePoint >> 6) & 0x3F)),
+		strOutput += static_cast<char>(0x80 | (nCodePoint & 0x3F));
+	else
+		strOutput += static_cast<char>(0xF0 | (nCodePoint >> 18)), strOutput += static_cast<char>(0x80 | ((nCodePoint >> 12) & 0x3F)),
+		strOutput += static_cast<char>(0x80 | ((nCodePoint >> 6) & 0x3F)), strOutput += static_cast<char>(0x80 | (nCodePoint & 0x3F));
+}
+
+/**
+ * @brief Random text: long ASCII runs for the vector path, characters of
+ * every length, and (unless bValid) truncated sequences and stray bytes.
+ */
+static std::string RandomUtf8(CTestRandom& pRandom, size_t nLength, bool bValid)
+{
+	std::string strOutput;
+	while (strOutput.size() < nLength)
+	{
+		switch (pRandom.Range(0, bValid ? 4 : 6))
+		{
+		case 0:
+			strOutput.append(pRandom.Range(1, 40), static_cast<char>('A' + pRandom.Range(0, 25)));
+			break;
+		case 1:
+			AppendUtf8(strOutput, static_cast<uint32_t>(pRandom.Range(0x80, 0x7FF)));
+			break;
+		case 2:
+		{
+			uint32_t nCodePoint = static_cast<uint32_t>(pRandom.Range(0x800, 0xFFFF));
+			if ((nCodePoint >= 0xD800) && (nCodePoint <= 0xDFFF))
+				nCodePoint = 0xE000;
+			AppendUtf8(strOutput, nCodePoint);
+			break;
+		}
+		case 3:
+			AppendUtf8(strOutput, static_cast<uint32_t>(pRandom.Range(0x10000, 0x10FFFF)));
+			break;
+		case 4:
+			strOutput += static_cast<char>(pRandom.Range(0, 0x7F));
+			break;
+		case 5:
+			// any byte at all: stray continuations, C0/C1/F5-FF, surrogate and overlong leads
+			strOutput += static_cast<char>(pRandom.Range(0x80, 0xFF));
+			break;
+		default:
+		{
+			// the start of a valid character, cut short
+			std::string strCharacter;
+			AppendUtf8(strCharacter, static_cast<uint32_t>(pRandom.Range(0x800, 0x10FFFF)));
+			strOutput.append(strCharacter, 0, pRandom.Range(1, strCharacter.size() - 1));
+			break;
+		}
+		}
+	}
+	return strOutput;
+}
+
+/**
+ * @brief Decodes the same text whole and split at random points; both must match the reference.
+ */
+static void TestDecoderSplits()
+{
+	CTestRandom pRandom(21);
+	size_t nFailures = 0;
+	for (int nRound = 0; nRound < 20000; nRound++)
+	{
+		const std::string strInput = RandomUtf8(pRandom, pRandom.Range(0, 300), (nRound & 3) == 0);
+		const std::wstring strExpected = ReferenceDecode(strInput);
+
+		CUtf8Decoder pDecoder;
+		std::wstring strWhole;
+		pDecoder.Decode(strInput.data(), strInput.size(), strWhole);
+		pDecoder.Flush(strWhole);
+
+		std::wstring strSplit;
+		for (size_t nOffset = 0; nOffset < strInput.size(); )
+		{
+			// pieces of 1 to 4 bytes cut every multi-byte character somewhere
+			const size_t nPiece = (pRandom.Next() & 1) ? pRandom.Range(1, 4) : pRandom.Range(1, 64);
+			const size_t nLength = (nPiece < strInput.size() - nOffset) ? nPiece : strInput.size() - nOffset;
+			pDecoder.Decode(strInput.data() + nOffset, nLength, strSplit);
+			nOffset += nLength;
+		}
+		pDecoder.Flush(strSplit);
+		TEST_CHECK(!pDecoder.HasPending());
+		if ((strWhole != strExpected) || (strSplit != strExpected))
+			nFailures++;
+	}
+	TEST_CHECK(nFailures == 0);
+}
+
+/**
+ * @brief Every valid code point decodes back to itself, whichever byte it is split at.
+ */
+static void TestDecoderAllCodePoints()
+{
+	CUtf8Decoder pDecoder;
+	size_t nFailures = 0;
+	for (uint32_t nCodePoint = 1; nCodePoint <= 0x10FFFF; nCodePoint++)
+	{
+		if ((nCodePoint >= 0xD800) && (nCodePoint <= 0xDFFF))
+			continue;
+		std::string strInput;
+		AppendUtf8(strInput, nCodePoint);
+		std::wstring strOutput;
+		const size_t nSplit = nCodePoint % strInput.size();
+		pDecoder.Decode(strInput.data(), nSplit, strOutput);
+		pDecoder.Decode(strInput.data() + nSplit, strInput.size() - nSplit, strOutput);
+		if (strOutput != ReferenceDecode(strInput))
+			nFailures++;
+	}
+	TEST_CHECK(nFailures == 0);
+}
+
+template <typename TChar>
+static std::basic_string<TChar> ReferenceNormalize(const std::basic_string<TChar>& strInput, int nMode)
+{
+	std::basic_string<TChar> strOutput;
+	for (size_t nIndex = 0; nIndex < strInput.size(); nIndex++)
+	{
+		const TChar ch = strInput[nIndex];
+		if ((nMode == 2) || ((ch != '\r') && (ch != '\n')))
+		{
+			strOutput += ch;
+			continue;
+		}
+		if ((ch == '\r') && (nIndex + 1 < strInput.size()) && (strInput[nIndex + 1] == '\n'))
+			nIndex++;
+		if (nMode == 0)
+			strOutput += static_cast<TChar>('\r');
+		strOutput += static_cast<TChar>('\n');
+	}
+	return strOutput;
+}
+
+/**
+ * @brief Normalizes text dense in CR and LF in random pieces, so CR LF pairs are split.
+ */
+template <typename TChar>
+static void TestNormalizerSplits()
+{
+	typedef CLineEndingNormalizer<TChar> CNormalizer;
+	CTestRandom pRandom(sizeof(TChar));
+	const TChar pAlphabet[] = { 'a', 'b', '\r', '\n', '\r', '\n' };
+	size_t nFailures = 0;
+	for (int nRound = 0; nRound < 6000; nRound++)
+	{
+		const int nMode = nRound % 3;
+		std::basic_string<TChar> strInput;
+		const size_t nLength = pRandom.Range(0, 200);
+		while (strInput.size() < nLength)
+		{
+			if (pRandom.Range(0, 7) == 0)
+				strInput.append(pRandom.Range(1, 40), 'x');
+			else
+				strInput += pAlphabet[pRandom.Range(0, 5)];
+		}
+
+		CNormalizer pNormalizer;
+		pNormalizer.SetMode(static_cast<typename CNormalizer::LineEndingMode>(nMode));
+		std::basic_string<TChar> strOutput;
+		for (size_t nOffset = 0; nOffset < strInput.size(); )
+		{
+			const size_t nPiece = pRandom.Range(1, 24);
+			const size_t nCount = (nPiece < strInput.size() - nOffset) ? nPiece : strInput.size() - nOffset;
+			pNormalizer.Normalize(strInput.data() + nOffset, nCount, strOutput);
+			nOffset += nCount;
+		}
+		if (strOutput != ReferenceNormalize(strInput, nMode))
+			nFailures++;
+	}
+	TEST_CHECK(nFailures == 0);
+}
+
+int main()
+{
+	setvbuf(stdout, nullptr, _IONBF, 0);
+	TestDecoderSplits();
+	TestDecoderAllCodePoints();
+	TestNormalizerSplits<char>();
+	TestNormalizerSplits<wchar_t>();
+	return TEST_RESULT();
+}
@@ -0,0 +1,132 @@
+/* Copyright (C) 2014-2026 Stefan-Mihai MOGA
+This file is part of IntelliPort application developed by Stefan-Mihai MOGA.
+IntelliPort is an alternative Windows version to the famous HyperTerminal!
+
+IntelliPort is free software: you can redistribute it and/or modify it
+under the terms of the GNU General Public License as published by the Open
+Source Initiative, either version 3 of the License, or any later version.
+
+IntelliPort is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+IntelliPort. If not, see <http://www.opensource.org/licenses/gpl-3.0.html>*/
+
+// WriteQueueTest.cpp : waiting for room in the write queue, and giving up on it
+//
+
+#include "WriteQueue.h"
+#include "UnitTest.h"
+
+#include <string>
+
+/**
+ * @brief A connection that takes nothing until released, like a device that
+ * stopped reading; it gives up when the queue is stopped.
+ */
+class CStuckConnection
+{
+public:
+	CStuckConnection(CWriteQueue& pQueue) : m_pQueue(pQueue), m_bRelease(false), m_nBytes(0)
+	{
+	}
+
+	bool Write(const CWriteSpan* pSpans, int nCount)
+	{
+		while (!m_bRelease.load() && !m_pQueue.IsStopping())
+		{
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+		for (int nIndex = 0; nIndex < nCount; nIndex++)
+		{
+			m_nBytes += pSpans[nIndex].nLength;
+		}
+		return !m_pQueue.IsStopping();
+	}
+
+	CWriteQueue& m_pQueue;
+	std::atomic<bool> m_bRelease;
+	std::atomic<size_t> m_nBytes;
+};
+
+/**
+ * @brief Fills the queue behind a stuck write: Enqueue refuses at once, EnqueueWait
+ * waits and goes through when the connection takes the bytes.
+ */
+static void TestWaitForRoom()
+{
+	CWriteQueue pQueue;
+	CStuckConnection pConnection(pQueue);
+	pQueue.Start([&pConnection](const CWriteSpan* pSpans, int nCount) { return pConnection.Write(pSpans, nCount); }, false, 1024);
+	const std::string strData(1024, 'x');
+	TEST_CHECK(pQueue.Enqueue(strData.data(), strData.size()) == WRITE_QUEUED);
+	while (pQueue.GetStats().nBytesInFlight == 0)
+	{
+		std::this_thread::yield();
+	}
+	TEST_CHECK(pQueue.Enqueue(strData.data(), strData.size()) == WRITE_QUEUED);
+	TEST_CHECK(pQueue.Enqueue(strData.data(), strData.size()) == WRITE_QUEUE_FULL);
+
+	std::atomic<int> nResult(-1);
+	std::thread pProducer([&]() { nResult = pQueue.EnqueueWait(strData.data(), strData.size(), []() { return true; }); });
+	std::this_thread::sleep_for(std::chrono::milliseconds(250));
+	TEST_CHECK(nResult.load() == -1);
+	pConnection.m_bRelease = true;
+	pProducer.join();
+	TEST_CHECK(nResult.load() == WRITE_QUEUED);
+	pQueue.Stop(true);
+	TEST_CHECK(pConnection.m_nBytes.load() == 3 * strData.size());
+	TEST_CHECK(pQueue.GetStats().nRejected == 1);
+}
+
+/**
+ * @brief A producer being stopped leaves the wait within one 100 ms step,
+ * and Stop() of the queue ends every wait with WRITE_QUEUE_CLOSED.
+ */
+static void TestGiveUp()
+{
+	CWriteQueue pQueue;
+	CStuckConnection pConnection(pQueue);
+	pQueue.Start([&pConnection](const CWriteSpan* pSpans, int nCount) { return pConnection.Write(pSpans, nCount); }, false, 1024);
+	const std::string strData(1024, 'x');
+	TEST_CHECK(pQueue.Enqueue(strData.data(), strData.size()) == WRITE_QUEUED);
+	while (pQueue.GetStats().nBytesInFlight == 0)
+	{
+		std::this_thread::yield();
+	}
+	TEST_CHECK(pQueue.Enqueue(strData.data(), strData.size()) == WRITE_QUEUED);
+
+	std::atomic<bool> bStopping(false);
+	std::atomic<int> nResult(-1);
+	CTestStopwatch pStopwatch;
+	std::thread pProducer([&]() { nResult = pQueue.EnqueueWait(strData.data(), strData.size(), [&bStopping]() { return !bStopping.load(); }); });
+	std::this_thread::sleep_for(std::chrono::milliseconds(150));
+	bStopping = true;
+	const double fStopped = pStopwatch.GetSeconds();
+	pProducer.join();
+	const double fWaited = pStopwatch.GetSeconds() - fStopped;
+	printf("producer gave up %.1f ms after being stopped\n", fWaited * 1e3);
+	TEST_CHECK(nResult.load() == WRITE_QUEUE_FULL);
+	TEST_CHECK(fWaited < 0.2);
+
+	nResult = -1;
+	pProducer = std::thread([&]() { nResult = pQueue.EnqueueWait(strData.data(), strData.size(), []() { return true; }); });
+	std::this_thread::sleep_for(std::chrono::milliseconds(150));
+	TEST_CHECK(nResult.load() == -1);
+	pStopwatch = CTestStopwatch();
+	pQueue.Stop(false);
+	pProducer.join();
+	printf("queue stopped in %.1f ms\n", pStopwatch.GetSeconds() * 1e3);
+	TEST_CHECK(nResult.load() == WRITE_QUEUE_CLOSED);
+	TEST_CHECK(pStopwatch.GetSeconds() < 0.2);
+	TEST_CHECK(pQueue.EnqueueWait(strData.data(), strData.size(), []() { return true; }) == WRITE_QUEUE_CLOSED);
+}
+
+int main()
+{
+	setvbuf(stdout, nullptr, _IONBF, 0);
+	TestWaitForRoom();
+	TestGiveUp();
+	return TEST_RESULT();
+}